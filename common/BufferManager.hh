@@ -25,50 +25,140 @@
 #include "common/Namespace.hh"
 #include "common/Logging.hh"
 #include "common/StringConversion.hh"
+#include <sys/mman.h>
+#include <cstdlib>
+#include <algorithm>
+#include <functional>
+#include <list>
 #include <memory>
 #include <mutex>
+#include <new>
+#include <thread>
 #include <vector>
-#include <list>
 #include <atomic>
 
 EOSCOMMONNAMESPACE_BEGIN
 
 //------------------------------------------------------------------------------
-//! Class Buffer
+//! Class Buffer - page aligned memory which is NOT initialised on allocation.
+//! Buffers of at least one huge page can be backed by transparent huge pages
+//! or by the hugetlbfs pool. Users must never rely on the content of a newly
+//! obtained buffer - this was already the case for recycled buffers.
 //------------------------------------------------------------------------------
 class Buffer
 {
   friend class BufferManager;
 public:
+  //! Huge page size on x86_64 and aarch64 with 4KB base pages
+  static constexpr uint64_t sHugePageSize = 2 * 1024 * 1024;
+  static constexpr uint64_t sPageSize = 4096;
+
+  //----------------------------------------------------------------------------
+  //! Type of memory backing the buffer
+  //----------------------------------------------------------------------------
+  enum class Backing {
+    Pages, ///< normal pages
+    Thp, ///< transparent huge pages if size is a multiple of a huge page
+    HugeTlb ///< explicit huge pages, fall back to Thp if the pool is empty
+  };
+
   //----------------------------------------------------------------------------
   //! Constructor
+  //!
+  //! @param size buffer size
+  //! @param backing type of memory backing the buffer
   //----------------------------------------------------------------------------
-  Buffer(uint64_t size):
-    mCapacity(size),
-    mData(size, '\0')
-  {}
+  Buffer(uint64_t size, Backing backing = Backing::Pages):
+    mCapacity(size), mLength(0), mData(nullptr), mMapLen(0)
+  {
+    if ((backing != Backing::Pages) && size &&
+        (size % sHugePageSize == 0)) {
+      if (backing == Backing::HugeTlb) {
+        void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+
+        if (ptr != MAP_FAILED) {
+          mData = static_cast<char*>(ptr);
+          mMapLen = size;
+          return;
+        }
+      }
+
+      void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+      if (ptr == MAP_FAILED) {
+        throw std::bad_alloc();
+      }
+
+      (void) madvise(ptr, size, MADV_HUGEPAGE);
+      mData = static_cast<char*>(ptr);
+      mMapLen = size;
+      return;
+    }
+
+    void* ptr = nullptr;
+
+    if (posix_memalign(&ptr, sPageSize, size ? size : 1)) {
+      throw std::bad_alloc();
+    }
+
+    mData = static_cast<char*>(ptr);
+  }
 
   //----------------------------------------------------------------------------
   //! Get pointer to underlying data
   //----------------------------------------------------------------------------
   inline char* GetDataPtr()
   {
-    return &mData.front();
+    return mData;
   }
 
   //----------------------------------------------------------------------------
   //! Destructor
   //----------------------------------------------------------------------------
-  ~Buffer() = default;
+  ~Buffer()
+  {
+    if (mMapLen) {
+      (void) munmap(mData, mMapLen);
+    } else {
+      free(mData);
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  //! Disable copy/move assign/constructor operators
+  //----------------------------------------------------------------------------
+  Buffer(const Buffer&) = delete;
+  Buffer& operator =(const Buffer&) = delete;
+  Buffer(Buffer&&) = delete;
+  Buffer& operator =(Buffer&&) = delete;
 
   uint64_t mCapacity; ///< Available size of the buffer
   uint64_t mLength; ///< Length of the useful data
-  std::vector<char> mData; ///< Buffer holding the data
+  char* mData; ///< Memory holding the data
+
+private:
+  uint64_t mMapLen; ///< Length of the mapping if memory was mmap-ed
 };
 
+//------------------------------------------------------------------------------
+//! Allocation and reuse statistics of buffers
+//------------------------------------------------------------------------------
+struct BufferStats {
+  uint64_t mAllocated {0}; ///< Number of newly allocated buffers
+  uint64_t mReused {0}; ///< Number of requests served from the cache
+  uint64_t mRecycled {0}; ///< Number of buffers returned to the cache
+  uint64_t mFreed {0}; ///< Number of buffers released to the system
+  uint64_t mInUseBytes {0}; ///< Total size of buffers handed out
+  uint64_t mCachedBytes {0}; ///< Total size of buffers kept in the cache
+};
 
 //------------------------------------------------------------------------------
-//! Class BufferSlot
+//! Class BufferSlot - cache of buffers of the same size. The free buffers are
+//! kept in per-thread free lists: every thread works on the list selected by
+//! its thread id and only steals from the other lists if its own is empty,
+//! so threads don't contend on a common mutex.
 //------------------------------------------------------------------------------
 class BufferSlot
 {
@@ -78,19 +168,17 @@ public:
   //! Constructor
   //!
   //! @param size size of buffers allocated by the current slot
+  //! @param backing type of memory backing the buffers
   //----------------------------------------------------------------------------
-  BufferSlot(uint64_t size):
-    mBuffSize(size), mNumBuffers(0)
+  BufferSlot(uint64_t size, Buffer::Backing backing = Buffer::Backing::Pages):
+    mBuffSize(size), mBacking(backing), mNumBuffers(0), mNumCached(0),
+    mFreeLists(new FreeList[sNumFreeLists])
   {}
 
   //----------------------------------------------------------------------------
   //! Destructor
   //----------------------------------------------------------------------------
-  ~BufferSlot()
-  {
-    std::unique_lock<std::mutex> lock(mSlotMutex);
-    mAvailableBuffers.clear();
-  }
+  ~BufferSlot() = default;
 
   //----------------------------------------------------------------------------
   //! Move assignment operator
@@ -99,9 +187,12 @@ public:
   {
     if (this != &other) {
       mBuffSize = other.mBuffSize;
+      mBacking = other.mBacking;
       mNumBuffers.store(other.mNumBuffers);
-      mAvailableBuffers = other.mAvailableBuffers;
-      other.mAvailableBuffers.clear();
+      mNumCached.store(other.mNumCached);
+      mFreeLists = std::move(other.mFreeLists);
+      other.mNumBuffers = 0;
+      other.mNumCached = 0;
     }
 
     return *this;
@@ -120,16 +211,25 @@ public:
   //----------------------------------------------------------------------------
   std::shared_ptr<Buffer> GetBuffer()
   {
-    std::unique_lock<std::mutex> lock(mSlotMutex);
-
-    if (!mAvailableBuffers.empty()) {
-      auto buff =  mAvailableBuffers.front();
-      mAvailableBuffers.pop_front();
-      return buff;
+    const size_t index = GetFreeListIndex();
+
+    for (size_t i = 0; i < sNumFreeLists; ++i) {
+      FreeList& lst = mFreeLists[(index + i) % sNumFreeLists];
+      std::unique_lock<std::mutex> lock(lst.mMutex);
+
+      if (!lst.mBuffers.empty()) {
+        auto buff = std::move(lst.mBuffers.back());
+        lst.mBuffers.pop_back();
+        lock.unlock();
+        --mNumCached;
+        ++mStats.mReused;
+        return buff;
+      }
     }
 
     ++mNumBuffers;
-    return std::make_shared<Buffer>(mBuffSize);
+    ++mStats.mAllocated;
+    return std::make_shared<Buffer>(mBuffSize, mBacking);
   }
 
   //----------------------------------------------------------------------------
@@ -141,10 +241,16 @@ public:
   void Recycle(std::shared_ptr<Buffer> buffer, bool keep)
   {
     if (keep) {
-      std::unique_lock<std::mutex> lock(mSlotMutex);
-      mAvailableBuffers.push_back(buffer);
+      FreeList& lst = mFreeLists[GetFreeListIndex()];
+      {
+        std::unique_lock<std::mutex> lock(lst.mMutex);
+        lst.mBuffers.push_back(std::move(buffer));
+      }
+      ++mNumCached;
+      ++mStats.mRecycled;
     } else {
       --mNumBuffers;
+      ++mStats.mFreed;
     }
   }
 
@@ -153,19 +259,61 @@ public:
   //----------------------------------------------------------------------------
   void Pop()
   {
-    std::unique_lock<std::mutex> lock(mSlotMutex);
-
-    if (!mAvailableBuffers.empty()) {
-      mAvailableBuffers.pop_front();
-      --mNumBuffers;
+    const size_t index = GetFreeListIndex();
+
+    for (size_t i = 0; i < sNumFreeLists; ++i) {
+      FreeList& lst = mFreeLists[(index + i) % sNumFreeLists];
+      std::unique_lock<std::mutex> lock(lst.mMutex);
+
+      if (!lst.mBuffers.empty()) {
+        lst.mBuffers.pop_back();
+        lock.unlock();
+        --mNumCached;
+        --mNumBuffers;
+        ++mStats.mFreed;
+        return;
+      }
     }
   }
 
 private:
-  std::mutex mSlotMutex;
-  std::list<std::shared_ptr<Buffer>> mAvailableBuffers;
-  std::atomic<uint64_t> mNumBuffers;
+  //! Number of free lists per slot
+  static constexpr size_t sNumFreeLists = 16;
+
+  //----------------------------------------------------------------------------
+  //! Free list protected by its own mutex
+  //----------------------------------------------------------------------------
+  struct FreeList {
+    std::mutex mMutex;
+    std::vector<std::shared_ptr<Buffer>> mBuffers;
+  };
+
+  //----------------------------------------------------------------------------
+  //! Counters of the slot
+  //----------------------------------------------------------------------------
+  struct Counters {
+    std::atomic<uint64_t> mAllocated {0};
+    std::atomic<uint64_t> mReused {0};
+    std::atomic<uint64_t> mRecycled {0};
+    std::atomic<uint64_t> mFreed {0};
+  };
+
+  //----------------------------------------------------------------------------
+  //! Get index of the free list used by the calling thread
+  //----------------------------------------------------------------------------
+  static size_t GetFreeListIndex()
+  {
+    static thread_local size_t index =
+      std::hash<std::thread::id>()(std::this_thread::get_id()) % sNumFreeLists;
+    return index;
+  }
+
   uint64_t mBuffSize;
+  Buffer::Backing mBacking;
+  std::atomic<uint64_t> mNumBuffers; ///< Buffers allocated, in use or cached
+  std::atomic<uint64_t> mNumCached; ///< Buffers kept in the free lists
+  std::unique_ptr<FreeList[]> mFreeLists;
+  Counters mStats;
 };
 
 
@@ -185,13 +333,15 @@ public:
   //!        slot 1 -> 2MB
   //!        slot 2 -> 4MB
   //! @param slot_base_sz size of the blocks in the first slot
+  //! @param backing type of memory backing the buffers
   //----------------------------------------------------------------------------
   BufferManager(uint64_t max_size = 256 * 1024 * 1024 , uint32_t slots = 2,
-                uint64_t slot_base_sz = 1024 * 1024):
-    mMaxSize(max_size), mNumSlots(slots)
+                uint64_t slot_base_sz = 1024 * 1024,
+                Buffer::Backing backing = Buffer::Backing::Pages):
+    mMaxSize(max_size), mNumSlots(slots), mSlotBaseSz(slot_base_sz)
   {
     for (uint32_t i = 0u; i <= mNumSlots; ++i) {
-      mSlots.emplace_back((1 << i) * slot_base_sz);
+      mSlots.emplace_back((1ull << i) * slot_base_sz, backing);
     }
   }
 
@@ -213,7 +363,7 @@ public:
 
     // Find appropriate slot for the given size
     for (uint32_t i = 0; i <= mNumSlots; ++i) {
-      if (size <= (1 << (i + 20))) {
+      if (size <= (mSlotBaseSz << i)) {
         slot = i;
         break;
       }
@@ -242,7 +392,7 @@ public:
 
     // Find appropriate slot for given buffer
     for (uint32_t i = 0; i <= mNumSlots; ++i) {
-      if (buffer->mCapacity == (1 << (i + 20))) {
+      if (buffer->mCapacity == (mSlotBaseSz << i)) {
         slot = i;
         break;
       }
@@ -282,7 +432,7 @@ public:
       }
     }
 
-    mSlots[slot].Recycle(buffer, keep);
+    mSlots[slot].Recycle(std::move(buffer), keep);
   }
 
   //----------------------------------------------------------------------------
@@ -300,8 +450,8 @@ public:
     total_size = 0ull;
 
     for (uint32_t i = 0; i <= mNumSlots; ++i) {
-      elem.push_back(std::make_pair(i,
-                                    (mSlots[i].mNumBuffers * (1 << i) * 1024 * 1024)));
+      elem.push_back(std::make_pair(i, (mSlots[i].mNumBuffers *
+                                        mSlots[i].mBuffSize)));
       total_size += elem.rbegin()->second;
     }
 
@@ -313,6 +463,28 @@ public:
     return elem;
   }
 
+  //----------------------------------------------------------------------------
+  //! Get allocation and reuse statistics summed over all slots
+  //----------------------------------------------------------------------------
+  BufferStats GetStats() const
+  {
+    BufferStats stats;
+
+    for (uint32_t i = 0; i <= mNumSlots; ++i) {
+      const BufferSlot& slot = mSlots[i];
+      uint64_t cached = slot.mNumCached;
+      uint64_t total = slot.mNumBuffers;
+      stats.mAllocated += slot.mStats.mAllocated;
+      stats.mReused += slot.mStats.mReused;
+      stats.mRecycled += slot.mStats.mRecycled;
+      stats.mFreed += slot.mStats.mFreed;
+      stats.mCachedBytes += cached * slot.mBuffSize;
+      stats.mInUseBytes += (total > cached ? total - cached : 0) * slot.mBuffSize;
+    }
+
+    return stats;
+  }
+
   //----------------------------------------------------------------------------
   //! Get number of slots handled by the current buffer manager
   //----------------------------------------------------------------------------
@@ -332,6 +504,7 @@ public:
 private:
   std::atomic<uint64_t> mMaxSize;
   std::atomic<uint32_t> mNumSlots;
+  uint64_t mSlotBaseSz; ///< Size of the buffers in the first slot
   std::vector<BufferSlot> mSlots;
 };
 
@@ -0,0 +1,319 @@
+//------------------------------------------------------------------------------
+// File: LogRecord.hh
+//------------------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2023 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+//------------------------------------------------------------------------------
+//! @file LogRecord.hh
+//! @brief Binary log records and per-thread record rings used by the deferred
+//!        formatting mode of the Logging class
+//------------------------------------------------------------------------------
+
+#pragma once
+#include "common/Namespace.hh"
+#include <sys/time.h>
+#include <sys/types.h>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+
+EOSCOMMONNAMESPACE_BEGIN
+
+//------------------------------------------------------------------------------
+//! Static description of a logging call site, one per log macro expansion
+//------------------------------------------------------------------------------
+struct LogCallSite {
+  const char* func;
+  const char* file;
+  int line;
+};
+
+class LogRecordReader;
+
+//------------------------------------------------------------------------------
+//! Log message captured on the calling thread, formatted later by the
+//! deferred logging thread
+//------------------------------------------------------------------------------
+struct LogRecord {
+  const LogCallSite* site;
+  //! Decodes the arguments and formats the message, instantiated for the
+  //! argument types of the call
+  void (*format)(const char* fmt, LogRecordReader& reader, char* out,
+                 size_t len);
+  struct timeval tv;
+  unsigned long tid;
+  int priority;
+  uid_t uid;
+  gid_t gid;
+  //! Context strings (logid, cident, prot, name, geo, format) followed by
+  //! the encoded arguments
+  char data[960];
+};
+
+//------------------------------------------------------------------------------
+//! Sequential writer into the data of a log record
+//------------------------------------------------------------------------------
+class LogRecordWriter
+{
+public:
+  LogRecordWriter(char* data, size_t size):
+    mData(data), mSize(size)
+  {}
+
+  //----------------------------------------------------------------------------
+  //! Append raw bytes
+  //!
+  //! @return false if the record is full
+  //----------------------------------------------------------------------------
+  bool Put(const void* ptr, size_t len)
+  {
+    if (mUsed + len > mSize) {
+      return false;
+    }
+
+    memcpy(mData + mUsed, ptr, len);
+    mUsed += len;
+    return true;
+  }
+
+  //----------------------------------------------------------------------------
+  //! Append a null terminated string, null pointers are stored as ""
+  //----------------------------------------------------------------------------
+  bool PutString(const char* str)
+  {
+    return str ? Put(str, strlen(str) + 1) : Put("", 1);
+  }
+
+private:
+  char* mData;
+  size_t mSize;
+  size_t mUsed = 0;
+};
+
+//------------------------------------------------------------------------------
+//! Sequential reader of the data of a log record
+//------------------------------------------------------------------------------
+class LogRecordReader
+{
+public:
+  LogRecordReader(const char* data):
+    mPos(data)
+  {}
+
+  void Get(void* ptr, size_t len)
+  {
+    memcpy(ptr, mPos, len);
+    mPos += len;
+  }
+
+  const char* GetString()
+  {
+    const char* str = mPos;
+    mPos += strlen(str) + 1;
+    return str;
+  }
+
+private:
+  const char* mPos;
+};
+
+//------------------------------------------------------------------------------
+//! Single producer, single consumer ring of log records. The owning thread
+//! appends, the deferred logging thread consumes.
+//------------------------------------------------------------------------------
+class LogRing
+{
+public:
+  static constexpr uint64_t sNumSlots = 64;
+
+  LogRing():
+    mSlots(new LogRecord[sNumSlots])
+  {}
+
+  //----------------------------------------------------------------------------
+  //! Get the next free slot (producer side)
+  //!
+  //! @return slot to fill, nullptr if the ring is full
+  //----------------------------------------------------------------------------
+  LogRecord* Acquire()
+  {
+    uint64_t head = mHead.load(std::memory_order_relaxed);
+
+    if (head - mTail.load(std::memory_order_acquire) >= sNumSlots) {
+      return nullptr;
+    }
+
+    return &mSlots[head % sNumSlots];
+  }
+
+  //----------------------------------------------------------------------------
+  //! Make the slot obtained by Acquire visible to the consumer
+  //!
+  //! @return true if the consumer may have found the ring empty and has to be
+  //!         woken up
+  //----------------------------------------------------------------------------
+  bool Publish()
+  {
+    const uint64_t head = mHead.load(std::memory_order_relaxed);
+    mHead.store(head + 1, std::memory_order_release);
+    // Pairs with the fence in Pop: either the consumer sees the new record
+    // or we see that it drained all the previous ones
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return (mTail.load(std::memory_order_relaxed) == head);
+  }
+
+  //----------------------------------------------------------------------------
+  //! Get the oldest record (consumer side)
+  //!
+  //! @return record, nullptr if the ring is empty
+  //----------------------------------------------------------------------------
+  LogRecord* Front()
+  {
+    uint64_t tail = mTail.load(std::memory_order_relaxed);
+
+    if (tail == mHead.load(std::memory_order_acquire)) {
+      return nullptr;
+    }
+
+    return &mSlots[tail % sNumSlots];
+  }
+
+  //----------------------------------------------------------------------------
+  //! Release the record obtained by Front
+  //----------------------------------------------------------------------------
+  void Pop()
+  {
+    mTail.store(mTail.load(std::memory_order_relaxed) + 1,
+                std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+  }
+
+  //! Set once the owning thread exited, the ring is dropped once drained
+  std::atomic<bool> mOrphaned {false};
+  //! Set by the owning thread while it fills a record
+  std::atomic<bool> mBusy {false};
+
+private:
+  alignas(64) std::atomic<uint64_t> mHead {0};
+  alignas(64) std::atomic<uint64_t> mTail {0};
+  std::unique_ptr<LogRecord[]> mSlots;
+};
+
+namespace log_detail
+{
+//! Argument types whose value can be captured in a log record
+template<typename T>
+constexpr bool IsDeferrable = std::is_arithmetic_v<T> || std::is_enum_v<T> ||
+                              std::is_pointer_v<T> || std::is_null_pointer_v<T>;
+
+//! Argument types which may point to a string to be copied
+template<typename T>
+constexpr bool IsCharPtr = std::is_pointer_v<T> &&
+                           std::is_same_v<std::remove_cv_t<std::remove_pointer_t<T>>, char>;
+
+//------------------------------------------------------------------------------
+//! Find the arguments consumed by a printf format string
+//!
+//! @param fmt format string
+//! @param kinds filled with 's' for string arguments, 'v' for the others
+//! @param max max number of arguments
+//!
+//! @return number of arguments, -1 if the format can not be deferred
+//------------------------------------------------------------------------------
+int ScanFormat(const char* fmt, char* kinds, int max);
+
+//------------------------------------------------------------------------------
+//! vsnprintf wrapper used to format decoded arguments
+//------------------------------------------------------------------------------
+void FormatMessage(char* out, size_t len, const char* fmt, ...);
+
+//------------------------------------------------------------------------------
+//! Encode an argument, strings are copied as the caller's buffers are gone by
+//! the time the message gets formatted
+//------------------------------------------------------------------------------
+template<typename T>
+bool EncodeArg(LogRecordWriter& writer, char kind, T arg)
+{
+  if constexpr(IsCharPtr<T>) {
+    char tag = (kind != 's') ? 2 : (arg ? 1 : 0);
+
+    if (!writer.Put(&tag, 1)) {
+      return false;
+    }
+
+    if (tag == 1) {
+      return writer.PutString(arg);
+    } else if (tag == 2) {
+      return writer.Put(&arg, sizeof(arg));
+    }
+
+    return true;
+  } else {
+    // A string conversion for something else than a C string
+    if (kind == 's') {
+      return false;
+    }
+
+    return writer.Put(&arg, sizeof(arg));
+  }
+}
+
+//------------------------------------------------------------------------------
+//! Decode an argument encoded by EncodeArg
+//------------------------------------------------------------------------------
+template<typename T>
+T DecodeArg(LogRecordReader& reader)
+{
+  T arg;
+
+  if constexpr(IsCharPtr<T>) {
+    char tag;
+    reader.Get(&tag, 1);
+
+    if (tag == 0) {
+      return nullptr;
+    } else if (tag == 1) {
+      return const_cast<T>(reader.GetString());
+    }
+  }
+
+  reader.Get(&arg, sizeof(arg));
+  return arg;
+}
+
+//------------------------------------------------------------------------------
+//! Format a message from the encoded arguments
+//------------------------------------------------------------------------------
+template<typename... Args>
+void FormatRecord(const char* fmt, LogRecordReader& reader, char* out,
+                  size_t len)
+{
+  // Braced initialization decodes in order
+  std::tuple<Args...> args {DecodeArg<Args>(reader)...};
+  std::apply([&](auto... arg) {
+    FormatMessage(out, len, fmt, arg...);
+  }, args);
+}
+}
+
+EOSCOMMONNAMESPACE_END
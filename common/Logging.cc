@@ -27,6 +27,8 @@
 #include <new>
 #include <type_traits>
 #include <atomic>
+#include <algorithm>
+#include <cstdarg>
 
 EOSCOMMONNAMESPACE_BEGIN
 
@@ -51,7 +53,7 @@ LoggingInitializer::LoggingInitializer()
 LoggingInitializer::~LoggingInitializer()
 {
   if (--sCounter == 0) {
-    gLogging.LB->shutDown();
+    gLogging.shutDown();
     (&gLogging)->~Logging();
   }
 }
@@ -70,7 +72,7 @@ Logging::GetInstance()
 //------------------------------------------------------------------------------
 Logging::Logging():
   gLogMask(0), gPriorityLevel(0), gToSysLog(false),  gUnit("none"),
-  gShortFormat(0), gRateLimiter(false)
+  gShortFormat(0), gRateLimiter(false), gDeferred(false)
 {
 
   LB = new LogBuffer;
@@ -96,6 +98,10 @@ Logging::Logging():
       gToSysLog = true;
     }
   }
+
+  if (getenv("EOS_LOG_DEFERRED") && !strcmp(getenv("EOS_LOG_DEFERRED"), "1")) {
+    gDeferred = true;
+  }
 }
 
 //------------------------------------------------------------------------------
@@ -126,6 +132,30 @@ Logging::shouldlog(const char* func, int priority)
   return true;
 }
 
+//------------------------------------------------------------------------------
+// Check if messages of the given function are filtered out
+//------------------------------------------------------------------------------
+bool
+Logging::IsFiltered(const char* func, int priority)
+{
+  // apply filter to avoid message flooding for debug messages
+  if (priority >= LOG_INFO) {
+    if (gAllowFilter.Num()) {
+      // if this is a pass-through filter e.g. we want to see exactly this messages
+      if (!gAllowFilter.Find(func)) {
+        return true;
+      }
+    } else if (gDenyFilter.Num()) {
+      // this is a normal filter by function name
+      if (gDenyFilter.Find(func)) {
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
 
 #if LOG_BUFFER_DBG 
 
@@ -483,21 +513,55 @@ Logging::log(const char* func, const char* file, int line, const char* logid,
     return "";
   }
 
-  // apply filter to avoid message flooding for debug messages
-  if (!silent && priority >= LOG_INFO) {
-    if (gAllowFilter.Num()) {
-      // if this is a pass-through filter e.g. we want to see exactly this messages
-      if (!gAllowFilter.Find(func)) {
-        return "";
-      }
-    } else if (gDenyFilter.Num()) {
-      // this is a normal filter by function name
-      if (gDenyFilter.Find(func)) {
-        return "";
-      }
-    }
+  if (!silent && IsFiltered(func, priority)) {
+    return "";
   }
 
+  LogContext ctx;
+  ctx.func = func;
+  ctx.file = file;
+  ctx.line = line;
+  ctx.logid = logid;
+  ctx.cident = cident;
+  ctx.prot = vid.prot.c_str();
+  ctx.name = vid.name.c_str();
+  ctx.geolocation = vid.geolocation.c_str();
+  ctx.uid = vid.uid;
+  ctx.gid = vid.gid;
+  ctx.priority = priority;
+  gettimeofday(&ctx.tv, NULL);
+  ctx.tid = (unsigned long) XrdSysThread::ID();
+  va_list args;
+  va_start(args, msg);
+  const char* rptr = Emit(ctx, msg, args);
+  va_end(args);
+  return rptr;
+}
+
+//------------------------------------------------------------------------------
+// Varargs wrapper of Emit
+//------------------------------------------------------------------------------
+const char*
+Logging::Emitf(const LogContext& ctx, const char* msg, ...)
+{
+  va_list args;
+  va_start(args, msg);
+  const char* rptr = Emit(ctx, msg, args);
+  va_end(args);
+  return rptr;
+}
+
+//------------------------------------------------------------------------------
+// Format a message, store it in the log memory and queue it for output
+//------------------------------------------------------------------------------
+const char*
+Logging::Emit(const LogContext& ctx, const char* msg, va_list args)
+{
+  int priority = ctx.priority;
+  bool silent = (priority == LOG_SILENT);
+  const char* func = ctx.func;
+  const char* file = ctx.file;
+  const char* logid = ctx.logid;
   struct LogBuffer::log_buffer *logBuffer = LB->log_alloc_buffer();
   if (logBuffer == NULL) return "";                     /* log object being destroyed */
 
@@ -509,19 +573,14 @@ Logging::log(const char* func, const char* file, int line, const char* logid,
   File.erase(0, File.rfind("/") + 1);
   File.erase(File.length() - 3);
   time_t current_time;
-  struct timeval tv;
-  struct timezone tz;
+  struct timeval tv = ctx.tv;
   tm tm;
-  va_list args;
-  va_start(args, msg);
-
-  gettimeofday(&tv, &tz);
   current_time = tv.tv_sec;
 
   char linen[16];
-  sprintf(linen, "%d", line);
+  sprintf(linen, "%d", ctx.line);
   char fcident[1024];
-  XrdOucString truncname = vid.name;
+  XrdOucString truncname = ctx.name;
 
   // we show only the last 16 bytes of the name
   if (truncname.length() > 16) {
@@ -548,12 +607,11 @@ Logging::log(const char* func, const char* file, int line, const char* logid,
               "%02d%02d%02d %02d:%02d:%02d t=%lu.%06lu f=%-16s l=%s tid=%016lx s=%-24s ",
               tm.tm_year - 100, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour,
               tm.tm_min, tm.tm_sec, current_time, (unsigned long) tv.tv_usec,
-              func, GetPriorityString(priority), (unsigned long) XrdSysThread::ID(),
-              sourceline);
+              func, GetPriorityString(priority), ctx.tid, sourceline);
     }
   } else {
-    sprintf(fcident, "tident=%s sec=%-5s uid=%d gid=%d name=%s geo=\"%s\"", cident,
-            vid.prot.c_str(), vid.uid, vid.gid, truncname.c_str(), vid.geolocation.c_str());
+    sprintf(fcident, "tident=%s sec=%-5s uid=%d gid=%d name=%s geo=\"%s\"", ctx.cident,
+            ctx.prot, ctx.uid, ctx.gid, truncname.c_str(), ctx.geolocation);
     localtime_r(&current_time, &tm);
     snprintf(sourceline, sizeof(sourceline) - 1, "%s:%s", File.c_str(), linen);
     sprintf(buffer,
@@ -561,7 +619,7 @@ Logging::log(const char* func, const char* file, int line, const char* logid,
             tm.tm_year - 100, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min,
             tm.tm_sec, current_time, (unsigned long) tv.tv_usec, func,
             GetPriorityString(priority), logid, gUnit.c_str(),
-            (unsigned long) XrdSysThread::ID(), sourceline, fcident);
+            ctx.tid, sourceline, fcident);
   }
 
   char* ptr = buffer + strlen(buffer);
@@ -570,9 +628,8 @@ Logging::log(const char* func, const char* file, int line, const char* logid,
 
   if (!silent) {
     XrdSysMutexHelper scope_lock(gMutex);         
-    if (rate_limit(tv, priority, file, line)) {
+    if (rate_limit(tv, priority, file, ctx.line)) {
         LB->log_return_buffers(logBuffer);
-        va_end(args);
         return "";
       }
   }
@@ -615,8 +672,8 @@ Logging::log(const char* func, const char* file, int line, const char* logid,
                   GetLogColour(GetPriorityString(priority)),
                   GetPriorityString(priority),
                   EOS_TEXTNORMAL,
-                  vid.uid,
-                  vid.gid,
+                  ctx.uid,
+                  ctx.gid,
                   truncname.c_str(),
                   func,
                   logBuffer->h.ptr
@@ -629,7 +686,6 @@ Logging::log(const char* func, const char* file, int line, const char* logid,
 
   }
 
-  va_end(args);
   const char* rptr;
 
   if (silent) {
@@ -703,4 +759,308 @@ Logging::rate_limit(struct timeval& tv, int priority, const char* file,
   return do_limit;
 }
 
+namespace
+{
+//------------------------------------------------------------------------------
+//! Log ring of the current thread, orphaned when the thread exits
+//------------------------------------------------------------------------------
+struct ThreadLogRing {
+  std::shared_ptr<LogRing> ring;
+
+  ~ThreadLogRing()
+  {
+    if (ring) {
+      ring->mOrphaned = true;
+    }
+  }
+};
+
+thread_local ThreadLogRing tlLogRing;
+}
+
+//------------------------------------------------------------------------------
+// Get the log ring of the calling thread
+//------------------------------------------------------------------------------
+LogRing*
+Logging::GetThreadRing()
+{
+  if (mDeferredStop) {
+    return nullptr;
+  }
+
+  if (!tlLogRing.ring) {
+    std::unique_lock<std::mutex> lock(mRingsMutex);
+
+    if (mDeferredStop) {
+      return nullptr;
+    }
+
+    tlLogRing.ring = std::make_shared<LogRing>();
+    mRings.push_back(tlLogRing.ring);
+    ++mRingsVersion;
+
+    if (!mDeferredThread.joinable()) {
+      mDeferredThread = std::thread(&Logging::DeferredLoop, this);
+    }
+  }
+
+  return tlLogRing.ring.get();
+}
+
+//------------------------------------------------------------------------------
+// Start capturing a message into the ring of the calling thread
+//------------------------------------------------------------------------------
+LogRing*
+Logging::BeginDeferred()
+{
+  LogRing* ring = GetThreadRing();
+
+  if (ring == nullptr) {
+    return nullptr;
+  }
+
+  // Pairs with StopDeferred: either we see the stop flag or it waits for us
+  // to publish before doing the final drain
+  ring->mBusy = true;
+
+  if (mDeferredStop) {
+    ring->mBusy = false;
+    return nullptr;
+  }
+
+  return ring;
+}
+
+//------------------------------------------------------------------------------
+// Finish capturing a message
+//------------------------------------------------------------------------------
+void
+Logging::EndDeferred(LogRing* ring, bool publish)
+{
+  if (publish && ring->Publish() && !mDeferredPending.exchange(true)) {
+    {
+      // Don't notify between the predicate check and the wait of the consumer
+      std::unique_lock<std::mutex> lock(mDeferredMutex);
+    }
+    mDeferredCondVar.notify_one();
+  }
+
+  ring->mBusy.store(false, std::memory_order_release);
+}
+
+//------------------------------------------------------------------------------
+// Loop of the deferred logging thread
+//------------------------------------------------------------------------------
+void
+Logging::DeferredLoop()
+{
+  std::vector<std::shared_ptr<LogRing>> rings;
+  uint64_t version = 0;
+  bool prune = true;
+
+  while (true) {
+    if (prune || (version != mRingsVersion)) {
+      std::unique_lock<std::mutex> lock(mRingsMutex);
+
+      if (prune) {
+        // Drop the rings of exited threads once drained
+        mRings.erase(std::remove_if(mRings.begin(), mRings.end(),
+        [](const std::shared_ptr<LogRing>& ring) {
+          return ring->mOrphaned && !ring->Front();
+        }), mRings.end());
+      }
+
+      version = mRingsVersion;
+      rings = mRings;
+      prune = false;
+    }
+
+    for (const auto& ring : rings) {
+      LogRecord* rec;
+
+      while ((rec = ring->Front())) {
+        EmitRecord(*rec);
+        ring->Pop();
+      }
+
+      if (ring->mOrphaned) {
+        prune = true;
+      }
+    }
+
+    if (prune) {
+      continue;
+    }
+
+    // Producers signal only when a ring goes from empty to non-empty
+    std::unique_lock<std::mutex> lock(mDeferredMutex);
+    mDeferredCondVar.wait(lock, [&] {
+      return mDeferredStop || mDeferredPending;
+    });
+
+    if (mDeferredStop) {
+      break;
+    }
+
+    mDeferredPending = false;
+  }
+}
+
+//------------------------------------------------------------------------------
+// Enable/disable the deferred formatting mode
+//------------------------------------------------------------------------------
+void
+Logging::SetDeferred(bool onoff)
+{
+  if (onoff) {
+    std::unique_lock<std::mutex> lock(mRingsMutex);
+
+    if (mDeferredStop) {
+      // Restart after StopDeferred, the threads keep their rings
+      mDeferredStop = false;
+
+      if (!mRings.empty() && !mDeferredThread.joinable()) {
+        mDeferredThread = std::thread(&Logging::DeferredLoop, this);
+      }
+    }
+  }
+
+  gDeferred = onoff;
+}
+
+//------------------------------------------------------------------------------
+// Stop the deferred logging thread
+//------------------------------------------------------------------------------
+void
+Logging::StopDeferred()
+{
+  gDeferred = false;
+  {
+    std::unique_lock<std::mutex> lock(mRingsMutex);
+    std::unique_lock<std::mutex> wake_lock(mDeferredMutex);
+    mDeferredStop = true;
+  }
+  mDeferredCondVar.notify_one();
+
+  if (mDeferredThread.joinable()) {
+    mDeferredThread.join();
+  }
+
+  // Format what was captured in the meantime
+  std::unique_lock<std::mutex> lock(mRingsMutex);
+
+  for (const auto& ring : mRings) {
+    // A producer which got past the stop check publishes its last record
+    while (ring->mBusy.load(std::memory_order_acquire)) {
+      std::this_thread::yield();
+    }
+
+    LogRecord* rec;
+
+    while ((rec = ring->Front())) {
+      EmitRecord(*rec);
+      ring->Pop();
+    }
+  }
+
+  mDeferredPending = false;
+  // Keep the rings of the running threads, they are used again if the
+  // deferred mode is re-enabled
+  mRings.erase(std::remove_if(mRings.begin(), mRings.end(),
+  [](const std::shared_ptr<LogRing>& ring) {
+    return ring->mOrphaned;
+  }), mRings.end());
+}
+
+//------------------------------------------------------------------------------
+// Format a captured message
+//------------------------------------------------------------------------------
+void
+Logging::EmitRecord(const LogRecord& rec)
+{
+  LogRecordReader reader(rec.data);
+  LogContext ctx;
+  ctx.func = rec.site->func;
+  ctx.file = rec.site->file;
+  ctx.line = rec.site->line;
+  ctx.logid = reader.GetString();
+  ctx.cident = reader.GetString();
+  ctx.prot = reader.GetString();
+  ctx.name = reader.GetString();
+  ctx.geolocation = reader.GetString();
+  ctx.uid = rec.uid;
+  ctx.gid = rec.gid;
+  ctx.priority = rec.priority;
+  ctx.tv = rec.tv;
+  ctx.tid = rec.tid;
+  const char* fmt = reader.GetString();
+  char body[sizeof(LogBuffer::log_buffer::buffer)];
+  rec.format(fmt, reader, body, sizeof(body));
+  Emitf(ctx, "%s", body);
+}
+
+namespace log_detail
+{
+//------------------------------------------------------------------------------
+// Find the arguments consumed by a printf format string
+//------------------------------------------------------------------------------
+int
+ScanFormat(const char* fmt, char* kinds, int max)
+{
+  int num = 0;
+
+  for (const char* ptr = fmt; *ptr; ++ptr) {
+    if (*ptr != '%') {
+      continue;
+    }
+
+    ++ptr;
+
+    if (*ptr == '%') {
+      continue;
+    }
+
+    bool precision = false;
+
+    // flags, width, precision and length modifiers
+    while (*ptr && strchr("-+ #0'123456789.*hlLqjzt", *ptr)) {
+      if (*ptr == '.') {
+        precision = true;
+      } else if (*ptr == '*') {
+        if (num == max) {
+          return -1;
+        }
+
+        kinds[num++] = 'v';
+      }
+
+      ++ptr;
+    }
+
+    // Positional arguments, errno based and writing conversions as well as
+    // strings which may not be null terminated are not deferred
+    if (!*ptr || (*ptr == '$') || (*ptr == 'm') || (*ptr == 'n') ||
+        ((*ptr == 's') && precision) || (num == max)) {
+      return -1;
+    }
+
+    kinds[num++] = ((*ptr == 's') ? 's' : 'v');
+  }
+
+  return num;
+}
+
+//------------------------------------------------------------------------------
+// vsnprintf wrapper used to format decoded arguments
+//------------------------------------------------------------------------------
+void
+FormatMessage(char* out, size_t len, const char* fmt, ...)
+{
+  va_list args;
+  va_start(args, fmt);
+  vsnprintf(out, len, fmt, args);
+  va_end(args);
+}
+}
+
 EOSCOMMONNAMESPACE_END
@@ -48,9 +48,11 @@
 
 #include "common/Namespace.hh"
 #include "common/Mapping.hh"
+#include "common/LogRecord.hh"
 #include "XrdOuc/XrdOucString.hh"
 #include "XrdSys/XrdSysPthread.hh"
 #include "XrdSec/XrdSecEntity.hh"
+#include <stdarg.h>
 #include <string.h>
 #include <sys/syslog.h>
 #include <sys/time.h>
@@ -62,6 +64,8 @@
 #include <chrono>
 #include <mutex>
 #include <condition_variable>
+#include <atomic>
+#include <memory>
 
 #define SSTR(message) static_cast<std::ostringstream&>(std::ostringstream().flush() << message).str()
 
@@ -79,6 +83,15 @@ EOSCOMMONNAMESPACE_BEGIN
 #define EOS_TEXTUNBOLD "\033[0m"
 #define LOG_SILENT 0xffff
 
+//------------------------------------------------------------------------------
+//! Log through a static call site description, which allows the formatting of
+//! the message to be deferred to the background thread (see SetDeferred)
+//------------------------------------------------------------------------------
+#define EOSCOMMON_LOG_DEFERRABLE(__LOGID__, __VID__, __CIDENT__, __PRIORITY__, ...) \
+  static const eos::common::LogCallSite eos_log_call_site {__FUNCTION__, __FILE__, __LINE__}; \
+  eos::common::Logging::GetInstance().logd(eos_log_call_site, (__LOGID__), (__VID__), \
+                                           (__CIDENT__), (__PRIORITY__), __VA_ARGS__)
+
 //------------------------------------------------------------------------------
 //! Log Macros usable in objects inheriting from the logId Class
 //------------------------------------------------------------------------------
@@ -87,48 +100,39 @@ EOSCOMMONNAMESPACE_BEGIN
                                           vid, this->cident, __EOSCOMMON_LOG_PRIORITY__, __VA_ARGS__)
 #define eos_debug(...) \
   if ((LOG_MASK(LOG_DEBUG) & eos::common::Logging::GetInstance().GetLogMask()) != 0) { \
-    eos::common::Logging::GetInstance().log(__FUNCTION__,__FILE__, __LINE__, this->logId, \
-                                            vid, this->cident, (LOG_DEBUG), __VA_ARGS__); \
+    EOSCOMMON_LOG_DEFERRABLE(this->logId, vid, this->cident, (LOG_DEBUG), __VA_ARGS__); \
   }
 #define eos_info(...) \
   if ((LOG_MASK(LOG_INFO) & eos::common::Logging::GetInstance().GetLogMask()) != 0) { \
-  eos::common::Logging::GetInstance().log(__FUNCTION__,__FILE__, __LINE__, this->logId, \
-                                          vid, this->cident, (LOG_INFO), __VA_ARGS__); \
+  EOSCOMMON_LOG_DEFERRABLE(this->logId, vid, this->cident, (LOG_INFO), __VA_ARGS__); \
   }
 #define eos_notice(...) \
   if ((LOG_MASK(LOG_NOTICE) & eos::common::Logging::GetInstance().GetLogMask()) != 0) { \
-  eos::common::Logging::GetInstance().log(__FUNCTION__,__FILE__, __LINE__, this->logId, \
-                                          vid, this->cident, (LOG_NOTICE), __VA_ARGS__); \
+  EOSCOMMON_LOG_DEFERRABLE(this->logId, vid, this->cident, (LOG_NOTICE), __VA_ARGS__); \
   }
 #define eos_warning(...) \
   if ((LOG_MASK(LOG_WARNING) & eos::common::Logging::GetInstance().GetLogMask()) != 0) { \
-    eos::common::Logging::GetInstance().log(__FUNCTION__,__FILE__, __LINE__, this->logId, \
-                                            vid, this->cident, (LOG_WARNING), __VA_ARGS__); \
+    EOSCOMMON_LOG_DEFERRABLE(this->logId, vid, this->cident, (LOG_WARNING), __VA_ARGS__); \
   }
 #define eos_err(...)                                                    \
   if ((LOG_MASK(LOG_ERR) & eos::common::Logging::GetInstance().GetLogMask()) != 0) { \
-    eos::common::Logging::GetInstance().log(__FUNCTION__,__FILE__, __LINE__, this->logId, \
-                                            vid, this->cident, (LOG_ERR) , __VA_ARGS__); \
+    EOSCOMMON_LOG_DEFERRABLE(this->logId, vid, this->cident, (LOG_ERR) , __VA_ARGS__); \
   }
 #define eos_crit(...) \
   if ((LOG_MASK(LOG_CRIT) & eos::common::Logging::GetInstance().GetLogMask()) != 0) { \
-    eos::common::Logging::GetInstance().log(__FUNCTION__,__FILE__, __LINE__, this->logId, \
-                                            vid, this->cident, (LOG_CRIT), __VA_ARGS__); \
+    EOSCOMMON_LOG_DEFERRABLE(this->logId, vid, this->cident, (LOG_CRIT), __VA_ARGS__); \
   }
 #define eos_alert(...) \
   if ((LOG_MASK(LOG_ALERT) & eos::common::Logging::GetInstance().GetLogMask()) != 0) { \
-    eos::common::Logging::GetInstance().log(__FUNCTION__,__FILE__, __LINE__, this->logId, \
-                                            vid, this->cident, (LOG_ALERT)  , __VA_ARGS__); \
+    EOSCOMMON_LOG_DEFERRABLE(this->logId, vid, this->cident, (LOG_ALERT)  , __VA_ARGS__); \
   }
 #define eos_emerg(...) \
   if ((LOG_MASK(LOG_EMERG) & eos::common::Logging::GetInstance().GetLogMask()) != 0) { \
-    eos::common::Logging::GetInstance().log(__FUNCTION__,__FILE__, __LINE__, this->logId, \
-                                            vid, this->cident, (LOG_EMERG)  , __VA_ARGS__); \
+    EOSCOMMON_LOG_DEFERRABLE(this->logId, vid, this->cident, (LOG_EMERG)  , __VA_ARGS__); \
   }
 #define eos_silent(...) \
   if ((LOG_MASK(LOG_SILENT) & eos::common::Logging::GetInstance().GetLogMask()) != 0) { \
-    eos::common::Logging::GetInstance().log(__FUNCTION__,__FILE__, __LINE__, this->logId, \
-                                            vid, this->cident, (LOG_SILENT)  , __VA_ARGS__); \
+    EOSCOMMON_LOG_DEFERRABLE(this->logId, vid, this->cident, (LOG_SILENT)  , __VA_ARGS__); \
   }
 
 //------------------------------------------------------------------------------
@@ -171,45 +175,44 @@ EOSCOMMONNAMESPACE_BEGIN
                                           __VA_ARGS__)
 #define eos_static_debug(...)                                           \
   if ((LOG_MASK(LOG_DEBUG) & eos::common::Logging::GetInstance().GetLogMask()) != 0) { \
-    eos::common::Logging::GetInstance().log(__FUNCTION__,__FILE__, __LINE__, \
-                                            "static..............................", \
-                                            eos::common::gLogging.gZeroVid, "", \
-                                            (LOG_DEBUG), __VA_ARGS__);  \
+    EOSCOMMON_LOG_DEFERRABLE("static..............................", \
+                             eos::common::gLogging.gZeroVid, "", \
+                             (LOG_DEBUG), __VA_ARGS__); \
   }
 #define eos_static_info(...) \
   if ((LOG_MASK(LOG_INFO) & eos::common::Logging::GetInstance().GetLogMask()) != 0) { \
-    eos::common::Logging::GetInstance().log(__FUNCTION__,__FILE__, __LINE__, "static..............................", \
-                                            eos::common::gLogging.gZeroVid, "", (LOG_INFO), __VA_ARGS__); \
+    EOSCOMMON_LOG_DEFERRABLE("static..............................", \
+                             eos::common::gLogging.gZeroVid, "", (LOG_INFO), __VA_ARGS__); \
   }
 #define eos_static_notice(...) \
   if ((LOG_MASK(LOG_NOTICE) & eos::common::Logging::GetInstance().GetLogMask()) != 0) { \
-    eos::common::Logging::GetInstance().log(__FUNCTION__,__FILE__, __LINE__, "static..............................", \
-                                            eos::common::gLogging.gZeroVid, "", (LOG_NOTICE), __VA_ARGS__); \
+    EOSCOMMON_LOG_DEFERRABLE("static..............................", \
+                             eos::common::gLogging.gZeroVid, "", (LOG_NOTICE), __VA_ARGS__); \
   }
 #define eos_static_warning(...) \
   if ((LOG_MASK(LOG_WARNING) & eos::common::Logging::GetInstance().GetLogMask()) != 0) { \
-    eos::common::Logging::GetInstance().log(__FUNCTION__,__FILE__, __LINE__, "static..............................", \
-                                            eos::common::gLogging.gZeroVid, "", (LOG_WARNING), __VA_ARGS__); \
+    EOSCOMMON_LOG_DEFERRABLE("static..............................", \
+                             eos::common::gLogging.gZeroVid, "", (LOG_WARNING), __VA_ARGS__); \
   }
 #define eos_static_err(...) \
    if ((LOG_MASK(LOG_ERR) & eos::common::Logging::GetInstance().GetLogMask()) != 0) { \
-     eos::common::Logging::GetInstance().log(__FUNCTION__,__FILE__, __LINE__, "static..............................", \
-                                             eos::common::gLogging.gZeroVid, "", (LOG_ERR), __VA_ARGS__); \
+     EOSCOMMON_LOG_DEFERRABLE("static..............................", \
+                              eos::common::gLogging.gZeroVid, "", (LOG_ERR), __VA_ARGS__); \
    }
 #define eos_static_crit(...)                                            \
   if ((LOG_MASK(LOG_CRIT) & eos::common::Logging::GetInstance().GetLogMask()) != 0) { \
-    eos::common::Logging::GetInstance().log(__FUNCTION__,__FILE__, __LINE__, "static..............................", \
-                                            eos::common::gLogging.gZeroVid, "", (LOG_CRIT), __VA_ARGS__); \
+    EOSCOMMON_LOG_DEFERRABLE("static..............................", \
+                             eos::common::gLogging.gZeroVid, "", (LOG_CRIT), __VA_ARGS__); \
   }
 #define eos_static_alert(...)                                           \
   if ((LOG_MASK(LOG_ALERT) & eos::common::Logging::GetInstance().GetLogMask()) != 0) { \
-    eos::common::Logging::GetInstance().log(__FUNCTION__,__FILE__, __LINE__, "static..............................", \
-                                            eos::common::gLogging.gZeroVid, "", (LOG_ALERT)  , __VA_ARGS__); \
+    EOSCOMMON_LOG_DEFERRABLE("static..............................", \
+                             eos::common::gLogging.gZeroVid, "", (LOG_ALERT)  , __VA_ARGS__); \
   }
 #define eos_static_emerg(...) \
   if ((LOG_MASK(LOG_EMERG) & eos::common::Logging::GetInstance().GetLogMask()) != 0) { \
-    eos::common::Logging::GetInstance().log(__FUNCTION__,__FILE__, __LINE__, "static..............................", \
-                                            eos::common::gLogging.gZeroVid,"", (LOG_EMERG)  , __VA_ARGS__); \
+    EOSCOMMON_LOG_DEFERRABLE("static..............................", \
+                             eos::common::gLogging.gZeroVid,"", (LOG_EMERG)  , __VA_ARGS__); \
   }
 #define eos_static_silent(...) \
   eos::common::Logging::GetInstance().log(__FUNCTION__,__FILE__, __LINE__, "static..............................", \
@@ -526,6 +529,9 @@ public:
 
   LogBuffer *LB;
 
+  //! Deferred formatting mode, see SetDeferred
+  std::atomic<bool> gDeferred;
+
   //----------------------------------------------------------------------------
   //! Get singleton instance
   //----------------------------------------------------------------------------
@@ -544,9 +550,26 @@ public:
 
   void
   shutDown(bool gracefully=false) {
+      StopDeferred();
       if (LB) LB->shutDown(gracefully);
   }
 
+  //----------------------------------------------------------------------------
+  //! Enable/disable the deferred formatting mode. In this mode the log macros
+  //! only capture the timestamp, the call site and the raw arguments into a
+  //! per-thread ring, the message is formatted, stored in the log memory and
+  //! handed to the output by a background thread. Messages which can not be
+  //! captured (ring full, too long, unsupported arguments) are formatted
+  //! synchronously as before. Can also be enabled with EOS_LOG_DEFERRED=1.
+  //! Enabling it after StopDeferred restarts the background thread.
+  //----------------------------------------------------------------------------
+  void SetDeferred(bool onoff);
+
+  //----------------------------------------------------------------------------
+  //! Stop the deferred logging thread after formatting all captured messages
+  //----------------------------------------------------------------------------
+  void StopDeferred();
+
 
   //----------------------------------------------------------------------------
   //! Get current loglevel
@@ -819,6 +842,17 @@ public:
                   const char* logid, const VirtualIdentity& vid,
                   const char* cident, int priority, const char* msg, ...);
 
+  //----------------------------------------------------------------------------
+  //! Log a message from a static call site, formatted by the background
+  //! thread in deferred mode, otherwise same as log
+  //!
+  //! @return pointer to the log message, "" if deferred
+  //----------------------------------------------------------------------------
+  template<typename... Args>
+  const char* logd(const LogCallSite& site, const char* logid,
+                   const VirtualIdentity& vid, const char* cident,
+                   int priority, const char* msg, Args... args);
+
 
   //----------------------------------------------------------------------------
   //! estimates log message distance and similiary to suppress log messages
@@ -832,8 +866,148 @@ public:
   //---------------------------------------------------------------------------
 
   bool rate_limit(struct timeval& tv, int priority, const char* file, int line);
+
+private:
+  //----------------------------------------------------------------------------
+  //! Context of a log message
+  //----------------------------------------------------------------------------
+  struct LogContext {
+    const char* func;
+    const char* file;
+    int line;
+    const char* logid;
+    const char* cident;
+    const char* prot;
+    const char* name;
+    const char* geolocation;
+    uid_t uid;
+    gid_t gid;
+    int priority;
+    struct timeval tv;
+    unsigned long tid;
+  };
+
+  //----------------------------------------------------------------------------
+  //! Check if messages of the given function are filtered out
+  //----------------------------------------------------------------------------
+  bool IsFiltered(const char* func, int priority);
+
+  //----------------------------------------------------------------------------
+  //! Format a message, store it in the log memory and queue it for output
+  //!
+  //! @return pointer to the log message
+  //----------------------------------------------------------------------------
+  const char* Emit(const LogContext& ctx, const char* msg, va_list args);
+
+  //----------------------------------------------------------------------------
+  //! Varargs wrapper of Emit
+  //----------------------------------------------------------------------------
+  const char* Emitf(const LogContext& ctx, const char* msg, ...);
+
+  //----------------------------------------------------------------------------
+  //! Get the log ring of the calling thread, registering it if needed
+  //!
+  //! @return ring, nullptr if the deferred logging is shutting down
+  //----------------------------------------------------------------------------
+  LogRing* GetThreadRing();
+
+  //----------------------------------------------------------------------------
+  //! Start capturing a message into the ring of the calling thread, must be
+  //! followed by EndDeferred if successful
+  //!
+  //! @return ring, nullptr if the deferred logging is stopped
+  //----------------------------------------------------------------------------
+  LogRing* BeginDeferred();
+
+  //----------------------------------------------------------------------------
+  //! Finish capturing a message, waking up the deferred logging thread if
+  //! needed
+  //!
+  //! @param ring ring returned by BeginDeferred
+  //! @param publish if true the acquired record was filled and is published
+  //----------------------------------------------------------------------------
+  void EndDeferred(LogRing* ring, bool publish);
+
+  //----------------------------------------------------------------------------
+  //! Loop of the deferred logging thread formatting the captured messages
+  //----------------------------------------------------------------------------
+  void DeferredLoop();
+
+  //----------------------------------------------------------------------------
+  //! Format a captured message
+  //----------------------------------------------------------------------------
+  void EmitRecord(const LogRecord& rec);
+
+  std::mutex mRingsMutex; ///< Protects the members below
+  std::vector<std::shared_ptr<LogRing>> mRings; ///< Rings of all threads
+  std::atomic<uint64_t> mRingsVersion {0}; ///< Incremented when rings are added
+  std::thread mDeferredThread;
+  std::atomic<bool> mDeferredStop {false};
+  //! Wakes up the deferred logging thread when a ring gets its first record
+  std::mutex mDeferredMutex;
+  std::condition_variable mDeferredCondVar;
+  std::atomic<bool> mDeferredPending {false};
 };
 
+//------------------------------------------------------------------------------
+// Log a message from a static call site
+//------------------------------------------------------------------------------
+template<typename... Args>
+const char*
+Logging::logd(const LogCallSite& site, const char* logid,
+              const VirtualIdentity& vid, const char* cident, int priority,
+              const char* msg, Args... args)
+{
+  if constexpr((log_detail::IsDeferrable<Args> && ...)) {
+    if (gDeferred.load(std::memory_order_relaxed) && (priority != LOG_SILENT)) {
+      if (!((LOG_MASK(priority) & gLogMask)) || IsFiltered(site.func, priority)) {
+        return "";
+      }
+
+      char kinds[sizeof...(Args) + 1];
+      LogRing* ring = nullptr;
+
+      if ((log_detail::ScanFormat(msg, kinds, sizeof...(Args)) ==
+           (int) sizeof...(Args)) && (ring = BeginDeferred())) {
+        LogRecord* rec = ring->Acquire();
+        bool ok = (rec != nullptr);
+
+        if (ok) {
+          LogRecordWriter writer(rec->data, sizeof(rec->data));
+          ok = writer.PutString(logid) && writer.PutString(cident) &&
+               writer.PutString(vid.prot.c_str()) &&
+               writer.PutString(vid.name.c_str()) &&
+               writer.PutString(vid.geolocation.c_str()) &&
+               writer.PutString(msg);
+          size_t i = 0;
+          ((ok = ok && log_detail::EncodeArg(writer, kinds[i++], args)), ...);
+          (void) i;
+        }
+
+        if (ok) {
+          rec->site = &site;
+          rec->format = &log_detail::FormatRecord<Args...>;
+          gettimeofday(&rec->tv, nullptr);
+          rec->tid = (unsigned long) XrdSysThread::ID();
+          rec->priority = priority;
+          rec->uid = vid.uid;
+          rec->gid = vid.gid;
+        }
+
+        EndDeferred(ring, ok);
+
+        if (ok) {
+          return "";
+        }
+      }
+    }
+  }
+
+  // Arguments which can not be captured or deferred mode disabled
+  return log(site.func, site.file, site.line, logid, vid, cident, priority, msg,
+             args...);
+}
+
 extern Logging& gLogging; ///< Global logging object
 
 //------------------------------------------------------------------------------
@@ -69,6 +69,12 @@ std::map<std::string, gid_t> Mapping::gPhysicalGroupIdCache;
 
 Mapping::ip_cache Mapping::gIpCache(300);
 
+std::shared_ptr<const Mapping::VidCacheEntry>
+Mapping::gVidCache[Mapping::sVidCacheSize];
+std::atomic<uint64_t> Mapping::gVidCacheGeneration {0};
+std::atomic<uint64_t> Mapping::gVidCacheHits {0};
+std::atomic<uint64_t> Mapping::gVidCacheMisses {0};
+
 OAuth Mapping::gOAuth;
 
 
@@ -118,6 +124,7 @@ Mapping::Reset()
     XrdSysMutexHelper mLock(ActiveLock);
     ActiveTidents.clear();
   }
+  InvalidateVidCache();
 }
 
 
@@ -176,11 +183,126 @@ Mapping::IdMap(const XrdSecEntity* client, const char* env, const char* tident,
     return;
   }
 
+  XrdOucEnv Env(env);
+  XrdOucString mytident = "";
+  std::string key;
+  bool cacheable = VidCacheKey(client, Env, tident, key);
+  std::shared_ptr<const VidCacheEntry> entry;
+  size_t slot = 0;
+  // Taken before mapping, any concurrent mapping change discards the result
+  uint64_t generation = gVidCacheGeneration.load();
+  time_t now = time(NULL);
+
+  if (cacheable) {
+    slot = std::hash<std::string> {}(key) % sVidCacheSize;
+    entry = std::atomic_load(&gVidCache[slot]);
+  }
+
+  if (entry && (entry->generation == generation) && (entry->expires > now) &&
+      (entry->key == key)) {
+    ++gVidCacheHits;
+    vid = entry->vid;
+    mytident = entry->mytident.c_str();
+  } else {
+    if (cacheable) {
+      ++gVidCacheMisses;
+    }
+
+    cacheable &= IdMapInternal(client, Env, tident, vid, mytident);
+
+    if (cacheable) {
+      auto new_entry = std::make_shared<VidCacheEntry>();
+      new_entry->key = std::move(key);
+      new_entry->generation = generation;
+      new_entry->expires = now + sVidCacheLifetime;
+      new_entry->vid = vid;
+      new_entry->mytident = mytident.c_str();
+      std::atomic_store(&gVidCache[slot],
+                        std::shared_ptr<const VidCacheEntry>(std::move(new_entry)));
+    }
+  }
+
+  // Maintain the active client map and expire old entries
+  ActiveLock.Lock();
+
+  // Safety measures not to exceed memory by 'nasty' clients
+  if (ActiveTidents.size() > 25000) {
+    ActiveExpire();
+  }
+
+  if (ActiveTidents.size() < 60000) {
+    char actident[1024];
+    snprintf(actident, sizeof(actident) - 1, "%d^%s^%s^%s^%s", vid.uid,
+             mytident.c_str(), vid.prot.c_str(), vid.host.c_str(), vid.app.c_str());
+    std::string intident = actident;
+    ActiveTidents[intident] = now;
+  }
+
+  ActiveLock.UnLock();
+
+  if (log) {
+    eos_static_info("%s sec.tident=\"%s\" vid.uid=%d vid.gid=%d",
+                    eos::common::SecEntity::ToString(client, Env.Get("eos.app")).c_str(),
+                    tident, vid.uid, vid.gid);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Build the vid cache key of a client
+//------------------------------------------------------------------------------
+bool
+Mapping::VidCacheKey(const XrdSecEntity* client, XrdOucEnv& env,
+                     const char* tident, std::string& key)
+{
+  // Tokens are validated on every request
+  if (env.Get("authz")) {
+    return false;
+  }
+
+  // SSS and GRPC keys may carry tokens or OAuth2 credentials
+  if (client->endorsements && strlen(client->endorsements) &&
+      (!strcmp(client->prot, "sss") || !strcmp(client->prot, "grpc"))) {
+    return false;
+  }
+
+  const char* fields[] = {
+    client->prot, client->name, client->host, client->role, client->grps,
+    client->endorsements, client->tident, tident, env.Get("eos.ruid"),
+    env.Get("eos.rgid"), env.Get("eos.app")
+  };
+
+  for (const char* field : fields) {
+    if (field) {
+      key += field;
+    }
+
+    key += '\0';
+  }
+
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// Invalidate all cached virtual identities
+//------------------------------------------------------------------------------
+void
+Mapping::InvalidateVidCache()
+{
+  ++gVidCacheGeneration;
+}
+
+//------------------------------------------------------------------------------
+// Map a client to its virtual identity without using the vid cache
+//------------------------------------------------------------------------------
+bool
+Mapping::IdMapInternal(const XrdSecEntity* client, XrdOucEnv& Env,
+                       const char* tident, VirtualIdentity& vid,
+                       XrdOucString& mytident)
+{
   eos_static_debug("name:%s role:%s group:%s tident:%s", client->name,
                    client->role, client->grps, client->tident);
   // you first are 'nobody'
   vid = VirtualIdentity::Nobody();
-  XrdOucEnv Env(env);
   std::string authz = (Env.Get("authz") ? Env.Get("authz") : "");
   vid.name = client->name;
   vid.tident = tident;
@@ -392,7 +514,7 @@ Mapping::IdMap(const XrdSecEntity* client, const char* env, const char* tident,
   }
 
   // tident mapping
-  XrdOucString mytident = "";
+  mytident = "";
   XrdOucString myrole = "";
   XrdOucString wildcardtident = "";
   XrdOucString host = "";
@@ -931,8 +1053,6 @@ Mapping::IdMap(const XrdSecEntity* client, const char* env, const char* tident,
     vid.app = rapp.c_str();
   }
 
-  time_t now = time(NULL);
-
   // Check the Geo Location
   if ((!vid.geolocation.length()) && (gGeoMap.size())) {
     // if the geo location was not set externally and we have some recipe we try
@@ -967,31 +1087,10 @@ Mapping::IdMap(const XrdSecEntity* client, const char* env, const char* tident,
     }
   }
 
-  // Maintain the active client map and expire old entries
-  ActiveLock.Lock();
-
-  // Safety measures not to exceed memory by 'nasty' clients
-  if (ActiveTidents.size() > 25000) {
-    ActiveExpire();
-  }
-
-  if (ActiveTidents.size() < 60000) {
-    char actident[1024];
-    snprintf(actident, sizeof(actident) - 1, "%d^%s^%s^%s^%s", vid.uid,
-             mytident.c_str(), vid.prot.c_str(), vid.host.c_str(), vid.app.c_str());
-    std::string intident = actident;
-    ActiveTidents[intident] = now;
-  }
-
-  ActiveLock.UnLock();
   eos_static_debug("selected %d %d [%s %s]", vid.uid, vid.gid, ruid.c_str(),
                    rgid.c_str());
-
-  if (log) {
-    eos_static_info("%s sec.tident=\"%s\" vid.uid=%d vid.gid=%d",
-                    eos::common::SecEntity::ToString(client, Env.Get("eos.app")).c_str(),
-                    tident, vid.uid, vid.gid);
-  }
+  // Token based identities are validated on every request
+  return (authz.empty() && !vid.token);
 }
 
 //------------------------------------------------------------------------------
@@ -29,13 +29,16 @@
 #include "common/VirtualIdentity.hh"
 #include "XrdOuc/XrdOucString.hh"
 #include "XrdOuc/XrdOucHash.hh"
+#include <atomic>
 #include <map>
+#include <memory>
 #include <set>
 #include <string>
 #include <google/dense_hash_map>
 
 //! Forward declaration
 class XrdSecEntity;
+class XrdOucEnv;
 
 EOSCOMMONNAMESPACE_BEGIN
 
@@ -123,6 +126,24 @@ public:
   static void IdMap(const XrdSecEntity* client, const char* env,
                     const char* tident, VirtualIdentity& vid, bool log = true);
 
+  //----------------------------------------------------------------------------
+  //! Invalidate all cached virtual identities, needs to be called with the
+  //! gMapMutex write-locked whenever the mapping tables are modified
+  //----------------------------------------------------------------------------
+  static void InvalidateVidCache();
+
+  //----------------------------------------------------------------------------
+  //! Get the vid cache statistics
+  //!
+  //! @param hits number of identities served from the cache
+  //! @param misses number of cacheable identities which had to be mapped
+  //----------------------------------------------------------------------------
+  static void GetVidCacheStats(uint64_t& hits, uint64_t& misses)
+  {
+    hits = gVidCacheHits;
+    misses = gVidCacheMisses;
+  }
+
   // ---------------------------------------------------------------------------
   //! Map describing which virtual user roles a user with a given uid has
   // ---------------------------------------------------------------------------
@@ -342,6 +363,55 @@ public:
   static bool IsOAuth2Resource(const std::string& resource);
 
 private:
+  //----------------------------------------------------------------------------
+  //! Memoised result of the mapping of a client identity
+  //----------------------------------------------------------------------------
+  struct VidCacheEntry {
+    std::string key; ///< Client fields the mapping depends on
+    uint64_t generation; ///< Mapping generation the entry was computed with
+    time_t expires; ///< Expiration time, bounds the lifetime of physical ids
+    VirtualIdentity vid;
+    std::string mytident; ///< Reduced trace identifier of the client
+  };
+
+  //! Number of slots of the vid cache, colliding keys replace each other
+  static constexpr size_t sVidCacheSize = 4096;
+  //! Lifetime in seconds of the vid cache entries
+  static constexpr time_t sVidCacheLifetime = 300;
+  //! Vid cache slots, only accessed with std::atomic_load/store
+  static std::shared_ptr<const VidCacheEntry> gVidCache[sVidCacheSize];
+  //! Mapping generation, incremented on every mapping change
+  static std::atomic<uint64_t> gVidCacheGeneration;
+  static std::atomic<uint64_t> gVidCacheHits;
+  static std::atomic<uint64_t> gVidCacheMisses;
+
+  //----------------------------------------------------------------------------
+  //! Build the vid cache key of a client
+  //!
+  //! @param client XrdSecEntity object
+  //! @param env opaque information of the request
+  //! @param tident trace identifier of the client
+  //! @param key returned key
+  //!
+  //! @return true if the identity can be cached, otherwise false
+  //----------------------------------------------------------------------------
+  static bool VidCacheKey(const XrdSecEntity* client, XrdOucEnv& env,
+                          const char* tident, std::string& key);
+
+  //----------------------------------------------------------------------------
+  //! Map a client to its virtual identity without using the vid cache
+  //!
+  //! @param client XrdSecEntity object
+  //! @param Env opaque information of the request
+  //! @param tident trace identifier of the client
+  //! @param vid returned virtual identity
+  //! @param mytident returned reduced trace identifier
+  //!
+  //! @return true if the identity can be cached, otherwise false
+  //----------------------------------------------------------------------------
+  static bool IdMapInternal(const XrdSecEntity* client, XrdOucEnv& Env,
+                            const char* tident, VirtualIdentity& vid,
+                            XrdOucString& mytident);
 
   //----------------------------------------------------------------------------
   //! Handle VOMS mapping
@@ -281,6 +281,79 @@ FmdDbMapHandler::GetNumFileSystems() const
   return mDbMap.size();
 }
 
+//------------------------------------------------------------------------------
+// Enable the group commit of the Fmd records
+//------------------------------------------------------------------------------
+void
+FmdDbMapHandler::EnableGroupCommit(std::chrono::milliseconds max_delay,
+                                   size_t max_batch)
+{
+  eos_info("msg=\"enable fmd group commit\" max_delay_ms=%lld max_batch=%zu",
+           (long long) max_delay.count(), max_batch);
+  mCommitQueue.reset(new FmdCommitQueue(
+  [this](eos::common::FileSystem::fsid_t fsid,
+         const FmdCommitQueue::Batch & batch) {
+    return WriteBatch(fsid, batch);
+  }, max_delay, max_batch));
+}
+
+//------------------------------------------------------------------------------
+// Get group commit queue and flush statistics
+//------------------------------------------------------------------------------
+FmdCommitQueue::Stats
+FmdDbMapHandler::GetCommitStats() const
+{
+  return (mCommitQueue ? mCommitQueue->GetStats() : FmdCommitQueue::Stats());
+}
+
+//------------------------------------------------------------------------------
+// Write a batch of queued records to the DB of a file system
+//------------------------------------------------------------------------------
+bool
+FmdDbMapHandler::WriteBatch(eos::common::FileSystem::fsid_t fsid,
+                            const FmdCommitQueue::Batch& batch)
+{
+  eos::common::RWMutexReadLock map_rd_lock(mMapMutex);
+  FsWriteLock fs_wr_lock(fsid);
+  return LocalWriteBatch(fsid, batch);
+}
+
+//------------------------------------------------------------------------------
+// Write a batch of queued records with the locks held
+//------------------------------------------------------------------------------
+bool
+FmdDbMapHandler::LocalWriteBatch(eos::common::FileSystem::fsid_t fsid,
+                                 const FmdCommitQueue::Batch& batch)
+{
+  // Batch taken over by ShutdownDB
+  if (batch.empty()) {
+    return true;
+  }
+
+  auto it = mDbMap.find(fsid);
+
+  if (it == mDbMap.end()) {
+    eos_crit("msg=\"db not open, cannot write queued records\" fsid=%lu "
+             "num=%zu", fsid, batch.size());
+    return false;
+  }
+
+  // All the updates go to the DB in a single write batch
+  it->second->beginSetSequence();
+
+  for (const auto& elem : batch) {
+    eos::common::Slice key((const char*)&elem.first, sizeof(elem.first));
+
+    if (elem.second.mDeleted) {
+      (void) it->second->remove(key);
+    } else {
+      (void) it->second->set(key, elem.second.mValue, "");
+    }
+  }
+
+  return (it->second->endSetSequence() == batch.size());
+}
+
 //------------------------------------------------------------------------------
 // Set a new DB file for a filesystem id
 //------------------------------------------------------------------------------
@@ -355,6 +428,20 @@ FmdDbMapHandler::ShutdownDB(eos::common::FileSystem::fsid_t fsid, bool do_lock)
   }
 
   if (mDbMap.count(fsid)) {
+    // Nothing can be queued while the lock is held, write the queued records
+    // right before detaching
+    if (mCommitQueue) {
+      auto write = [this](eos::common::FileSystem::fsid_t id,
+      const FmdCommitQueue::Batch & batch) {
+        return LocalWriteBatch(id, batch);
+      };
+
+      if (!mCommitQueue->FlushLocked(fsid, write)) {
+        eos_err("msg=\"failed to write queued records before DB shutdown\" "
+                "fsid=%lu", fsid);
+      }
+    }
+
     if (mDbMap[fsid]->detachDb()) {
       delete mDbMap[fsid];
       mDbMap.erase(fsid);
@@ -514,7 +601,12 @@ FmdDbMapHandler::LocalDeleteFmd(eos::common::FileId::fileid_t fid,
   auto it = mDbMap.find(fsid);
 
   if (it != mDbMap.end()) {
-    (void) mDbMap[fsid]->remove(eos::common::Slice((const char*)&fid, sizeof(fid)));
+    if (mCommitQueue) {
+      mCommitQueue->Delete(fsid, fid);
+    } else {
+      (void) mDbMap[fsid]->remove(eos::common::Slice((const char*)&fid,
+                                  sizeof(fid)));
+    }
   }
 }
 
@@ -717,6 +809,7 @@ FmdDbMapHandler::UpdateWithScanInfo(eos::common::FileId::fileid_t fid,
 bool
 FmdDbMapHandler::ResetDiskInformation(eos::common::FileSystem::fsid_t fsid)
 {
+  FlushCommits(fsid);
   eos::common::RWMutexReadLock lock(mMapMutex);
   FsWriteLock wlock(fsid);
 
@@ -761,6 +854,7 @@ FmdDbMapHandler::ResetDiskInformation(eos::common::FileSystem::fsid_t fsid)
 bool
 FmdDbMapHandler::ResetMgmInformation(eos::common::FileSystem::fsid_t fsid)
 {
+  FlushCommits(fsid);
   eos::common::RWMutexReadLock lock(mMapMutex);
   FsWriteLock vlock(fsid);
 
@@ -1362,6 +1456,7 @@ FmdDbMapHandler::RemoveGhostEntries(const char* fs_root,
   std::vector<eos::common::FileId::fileid_t> to_delete;
 
   if (!IsSyncing(fsid)) {
+    FlushCommits(fsid);
     {
       eos::common::RWMutexReadLock rd_lock(mMapMutex);
       FsReadLock fs_rd_lock(fsid);
@@ -1425,6 +1520,7 @@ FmdDbMapHandler::GetInconsistencyStatistics(eos::common::FileSystem::fsid_t
     std::map<std::string, std::set < eos::common::FileId::fileid_t> >& fidset)
 {
   using eos::common::LayoutId;
+  FlushCommits(fsid);
   eos::common::RWMutexReadLock map_rd_lock(mMapMutex);
 
   if (!mDbMap.count(fsid)) {
@@ -1550,6 +1646,7 @@ bool
 FmdDbMapHandler::ResetDB(eos::common::FileSystem::fsid_t fsid)
 {
   bool rc = true;
+  FlushCommits(fsid);
   eos::common::RWMutexWriteLock lock(mMapMutex);
 
   // Erase the hash entry
@@ -1597,6 +1694,7 @@ FmdDbMapHandler::TrimDB()
 long long
 FmdDbMapHandler::GetNumFiles(eos::common::FileSystem::fsid_t fsid)
 {
+  FlushCommits(fsid);
   eos::common::RWMutexReadLock lock(mMapMutex);
   FsReadLock fs_rd_lock(fsid);
 
@@ -23,6 +23,7 @@
 
 #pragma once
 #include "fst/Namespace.hh"
+#include "fst/utils/FmdCommitQueue.hh"
 #include "common/Fmd.hh"
 #include "common/DbMap.hh"
 #include "common/FileId.hh"
@@ -140,6 +141,22 @@ public:
   //----------------------------------------------------------------------------
   bool SetDBFile(const char* dbfile, int fsid);
 
+  //----------------------------------------------------------------------------
+  //! Enable the group commit of the Fmd records i.e. commits are queued and
+  //! written in batches by a background thread. Must be called before any
+  //! DB file is attached.
+  //!
+  //! @param max_delay maximum time a commit stays in the queue
+  //! @param max_batch number of queued records triggering a write
+  //----------------------------------------------------------------------------
+  void EnableGroupCommit(std::chrono::milliseconds max_delay,
+                         size_t max_batch);
+
+  //----------------------------------------------------------------------------
+  //! Get group commit queue and flush statistics, all zero if disabled
+  //----------------------------------------------------------------------------
+  FmdCommitQueue::Stats GetCommitStats() const;
+
   //----------------------------------------------------------------------------
   //! Shutdown an open DB file
   //!
@@ -432,6 +449,10 @@ public:
   void
   Shutdown()
   {
+    if (mCommitQueue) {
+      mCommitQueue->FlushAll();
+    }
+
     while (!mDbMap.empty()) {
       ShutdownDB(mDbMap.begin()->first, true);
     }
@@ -465,6 +486,46 @@ private:
   google::dense_hash_map<eos::common::FileSystem::fsid_t, eos::common::RWMutex*>
   mFsMtxMap;
   eos::common::RWMutex mFsMtxMapMutex; ///< Mutex protecting the previous map
+  //! Queue of records waiting to be written, null if commits are synchronous
+  std::unique_ptr<FmdCommitQueue> mCommitQueue;
+
+  //----------------------------------------------------------------------------
+  //! Write a batch of queued records to the DB of a file system
+  //!
+  //! @param fsid file system id
+  //! @param batch records to write
+  //!
+  //! @return true if successful, otherwise false
+  //----------------------------------------------------------------------------
+  bool WriteBatch(eos::common::FileSystem::fsid_t fsid,
+                  const FmdCommitQueue::Batch& batch);
+
+  //----------------------------------------------------------------------------
+  //! Write a batch of queued records to the DB of a file system
+  //!
+  //! @param fsid file system id
+  //! @param batch records to write
+  //!
+  //! @return true if successful, otherwise false
+  //! @note this function must be called with the mMapMutex locked and also the
+  //! mutex corresponding to the filesystem locked, or the mMapMutex write
+  //! locked
+  //----------------------------------------------------------------------------
+  bool LocalWriteBatch(eos::common::FileSystem::fsid_t fsid,
+                       const FmdCommitQueue::Batch& batch);
+
+  //----------------------------------------------------------------------------
+  //! Write the queued records of a file system before accessing the DB
+  //! directly, must be called without holding the mMapMutex or fs mutex
+  //!
+  //! @param fsid file system id
+  //----------------------------------------------------------------------------
+  inline void FlushCommits(eos::common::FileSystem::fsid_t fsid)
+  {
+    if (mCommitQueue) {
+      mCommitQueue->Flush(fsid);
+    }
+  }
 
   //----------------------------------------------------------------------------
   //! Move given file to orphans directory and also set its extended attribute
@@ -572,6 +633,17 @@ private:
       return false;
     }
 
+    FmdCommitQueue::Update update;
+
+    if (mCommitQueue && mCommitQueue->Get(fsid, fid, update)) {
+      if (update.mDeleted) {
+        return false;
+      }
+
+      fmd.mProtoFmd.ParseFromString(update.mValue);
+      return true;
+    }
+
     eos::common::DbMap::Tval val;
 
     if (it->second->get(eos::common::Slice((const char*)&fid, sizeof(fid)), &val)) {
@@ -583,7 +655,8 @@ private:
   }
 
   //----------------------------------------------------------------------------
-  //! Store Fmd structure in the local database
+  //! Store Fmd structure in the local database or queue it for the group
+  //! commit if enabled
   //!
   //! @param fid file id
   //! @param fsid filesystem id
@@ -601,12 +674,17 @@ private:
     fmd.mProtoFmd.SerializePartialToString(&sval);
     auto it_db = mDbMap.find(fsid);
 
-    if (it_db != mDbMap.end()) {
-      return it_db->second->set(eos::common::Slice((const char*)&fid, sizeof(fid)),
-                                sval, "") == 0;
-    } else {
+    if (it_db == mDbMap.end()) {
       return false;
     }
+
+    if (mCommitQueue) {
+      mCommitQueue->Put(fsid, fid, std::move(sval));
+      return true;
+    }
+
+    return it_db->second->set(eos::common::Slice((const char*)&fid, sizeof(fid)),
+                              sval, "") == 0;
   }
 };
 
@@ -46,7 +46,13 @@ DiskHealth::getHealth(const std::string& devpath)
 
   // RAID setups
   if (dev[0] == 'm') {
-    return parse_mdstat(dev);
+    std::lock_guard<std::mutex> lock(mMdstatMutex);
+
+    if (!mMdstat.Refresh()) {
+      return {{"summary", "no mdstat"}};
+    }
+
+    return parse_mdstat_content(dev, mMdstat.GetContent());
   }
 
   // Remove partition digits, we need the actual device name for smartctl...
@@ -90,13 +96,31 @@ std::map<std::string, std::string>
 DiskHealth::parse_mdstat(const std::string& device,
                          const std::string& mdstat_path)
 {
-  std::string line, buffer;
+  std::string content;
+
+  if (!ProcFile::ReadFile(mdstat_path, content)) {
+    return {{"summary", "no mdstat"}};
+  }
+
+  return parse_mdstat_content(device, content);
+}
+
+//------------------------------------------------------------------------------
+// Parse the content of /proc/mdstat to obtain raid health
+//------------------------------------------------------------------------------
+std::map<std::string, std::string>
+DiskHealth::parse_mdstat_content(const std::string& device,
+                                 std::string_view mdstat)
+{
+  std::string_view line;
+  std::string buffer;
   std::map<std::string, std::string> health;
-  std::ifstream file(mdstat_path.c_str());
+  const std::string tag = device + " : ";
+  size_t line_pos = 0;
   health["summary"] = "no mdstat";
 
-  while (std::getline(file, line)) {
-    auto pos = line.find(device + " : ");
+  while (ProcFile::NextLine(mdstat, line_pos, line)) {
+    auto pos = line.find(tag);
 
     if (pos == std::string::npos) {
       continue;
@@ -105,10 +129,10 @@ DiskHealth::parse_mdstat(const std::string& device,
     buffer = line;
 
     // Read in also the next lines until empty
-    while (std::getline(file, line)) {
+    while (ProcFile::NextLine(mdstat, line_pos, line)) {
       // Trim whitespaces
       while (!line.empty() && line.back() == ' ') {
-        line.pop_back();
+        line.remove_suffix(1);
       }
 
       if (line.empty()) {
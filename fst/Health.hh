@@ -25,6 +25,7 @@
 #define __EOSFST_HEALTH_HH__
 
 #include "fst/Namespace.hh"
+#include "fst/utils/ProcMetrics.hh"
 #include <mutex>
 #include <map>
 #include <atomic>
@@ -68,6 +69,9 @@ private:
   //! Map holding the smartclt results
   std::map<std::string, std::map<std::string, std::string>> smartctl_results;
   std::mutex mMutex; ///< Protect acces to the smartctl_results map
+  //! Content of /proc/mdstat shared by all the raid devices
+  ProcFile mMdstat {"/proc/mdstat", std::chrono::seconds(10)};
+  std::mutex mMdstatMutex; ///< Protect access to the mdstat content
 
 #ifdef IN_TEST_HARNESS
 public:
@@ -85,6 +89,17 @@ public:
   parse_mdstat(const std::string& device,
                const std::string& mdstat_path = "/proc/mdstat");
 
+  //----------------------------------------------------------------------------
+  //! Parse the content of /proc/mdstat to obtain raid health
+  //!
+  //! @param device targeted device
+  //! @param mdstat content of the mdstat file
+  //!
+  //! @return map of health parameters and values
+  //----------------------------------------------------------------------------
+  static std::map<std::string, std::string>
+  parse_mdstat_content(const std::string& device, std::string_view mdstat);
+
 };
 
 //------------------------------------------------------------------------------
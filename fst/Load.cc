@@ -24,12 +24,87 @@
 #include "fst/Load.hh"
 #include <cstdio>
 #include <cstdlib>
+#include <algorithm>
 #include <errno.h>
 #include <sys/stat.h>
 #include "XrdOuc/XrdOucString.hh"
 
 EOSFSTNAMESPACE_BEGIN
 
+namespace
+{
+//------------------------------------------------------------------------------
+//! Take the timestamp of a measurement
+//------------------------------------------------------------------------------
+void
+UpdateTimestamp(struct timespec& ts)
+{
+#ifdef __APPLE__
+  struct timeval tv;
+  gettimeofday(&tv, 0);
+  ts.tv_sec = tv.tv_sec;
+  ts.tv_nsec = tv.tv_usec * 1000;
+#else
+  clock_gettime(CLOCK_REALTIME, &ts);
+#endif
+}
+
+//------------------------------------------------------------------------------
+//! Update the rates of a device from its current counters
+//!
+//! @param dev_name device name
+//! @param first_tag index of the first counter tag
+//! @param fields fields of the device line
+//! @param tags counter names
+//! @param t1 timestamp of the previous measurement, 0 if none
+//! @param t2 timestamp of the current measurement
+//! @param values counters of the previous measurement, updated
+//! @param rates rates per device and counter, updated
+//! @param field_offset offset between the tag index and the field index
+//------------------------------------------------------------------------------
+template <typename ValuesT, typename RatesT>
+void
+UpdateRates(std::string_view dev_name, size_t first_tag,
+            const std::vector<std::string_view>& fields,
+            const std::vector<std::string>& tags,
+            const struct timespec& t1, const struct timespec& t2,
+            ValuesT& values, RatesT& rates, size_t field_offset = 0)
+{
+  auto it_val = values.find(dev_name);
+
+  if (it_val == values.end()) {
+    it_val = values.emplace(std::string(dev_name),
+                            std::vector<unsigned long long>()).first;
+  }
+
+  auto it_rate = rates.find(dev_name);
+
+  if (it_rate == rates.end()) {
+    it_rate = rates.emplace(std::string(dev_name),
+                            std::map<std::string, double>()).first;
+  }
+
+  // Rates are only computed if the device was already there last time
+  const bool has_previous = (t1.tv_sec != 0) && !it_val->second.empty();
+  const float tdif = ((t2.tv_sec - t1.tv_sec) * 1000.0) +
+                     ((t2.tv_nsec - t1.tv_nsec) / 1000000.0);
+  it_val->second.resize(tags.size());
+
+  for (size_t i = first_tag; i < tags.size(); ++i) {
+    unsigned long long value = ProcFile::ToUInt(fields[i - field_offset]);
+
+    if (has_previous && (tdif > 0)) {
+      it_rate->second[tags[i]] = 1000.0 * ((double) value -
+                                           (double) it_val->second[i]) / tdif;
+    } else {
+      it_rate->second[tags[i]] = 0.0;
+    }
+
+    it_val->second[i] = value;
+  }
+}
+}
+
 //------------------------------------------------------------------------------
 //                              Load Class
 //------------------------------------------------------------------------------
@@ -207,7 +282,8 @@ Load::Monitor()
 //------------------------------------------------------------------------------
 // Constructor
 //------------------------------------------------------------------------------
-DiskStat::DiskStat()
+DiskStat::DiskStat():
+  mProcFile("/proc/diskstats", std::chrono::milliseconds(0))
 {
   mTags.push_back("type");
   mTags.push_back("number");
@@ -252,79 +328,34 @@ DiskStat::GetRate(const char* dev, const char* key)
 bool
 DiskStat::Measure()
 {
-  FILE* fd = fopen("/proc/diskstats", "r");
-
-  if (fd != 0) {
-    XrdSysRWLockHelper wr_lock(&mMutexRW, false);
-    int items = 0;
-    char val[14][1024];
-    bool scanned = false;
-
-    do {
-      items = fscanf(fd, "%1023s %1023s %1023s %1023s %1023s %1023s %1023s "
-                     "%1023s %1023s %1023s %1023s %1023s %1023s %1023s\n",
-                     val[0], val[1], val[2], val[3], val[4], val[5], val[6],
-                     val[7], val[8], val[9], val[10], val[11], val[12], val[13]);
-
-      if (items == 14) {
-        scanned = true;
-#ifdef __APPLE__
-        struct timeval tv;
-        gettimeofday(&tv, 0);
-        t2.tv_sec = tv.tv_sec;
-        t2.tv_nsec = tv.tv_usec * 1000;
-#else
-        clock_gettime(CLOCK_REALTIME, &t2);
-#endif
-        std::string dev_name = val[2];
-
-        for (unsigned int i = 3; i < mTags.size(); i++) {
-          values_t2[dev_name][mTags[i]] = val[i];
-        }
-
-        if (t1.tv_sec != 0) {
-          float tdif = ((t2.tv_sec - t1.tv_sec) * 1000.0) +
-                       ((t2.tv_nsec - t1.tv_nsec) / 1000000.0);
-
-          for (unsigned int i = 3; i < mTags.size(); i++) {
-            if (tdif > 0) {
-              mRates[dev_name][mTags[i]] =
-                1000.0 * (strtoll(values_t2[dev_name][mTags[i]].c_str(), 0, 10) -
-                          strtoll(values_t1[dev_name][mTags[i]].c_str(), 0, 10)) / tdif;
-            } else {
-              mRates[dev_name][mTags[i]] = 0.0;
-            }
-          }
+  if (!mProcFile.Refresh(true)) {
+    return false;
+  }
 
-          for (unsigned int i = 3; i < mTags.size(); i++) {
-            values_t1[dev_name][mTags[i]] = values_t2[dev_name][mTags[i]];
-          }
-        } else {
-          for (auto it = mTags.begin(); it != mTags.end(); it++) {
-            mRates[dev_name][*it] = 0.0;
-          }
+  XrdSysRWLockHelper wr_lock(&mMutexRW, false);
+  UpdateTimestamp(t2);
+  const std::string_view content = mProcFile.GetContent();
+  std::string_view line;
+  size_t pos = 0;
+  bool scanned = false;
 
-          for (unsigned int i = 3; i < mTags.size(); i++) {
-            values_t1[dev_name][mTags[i]] = values_t2[dev_name][mTags[i]];
-          }
-        }
+  while (ProcFile::NextLine(content, pos, line)) {
+    ProcFile::SplitFields(line, mFields);
 
-        continue;
-      }
+    // Newer kernels append the discard and flush counters
+    if (mFields.size() < mTags.size()) {
+      continue;
+    }
 
-      fclose(fd);
+    scanned = true;
+    UpdateRates(mFields[2], 3, mFields, mTags, t1, t2, mValues, mRates);
+  }
 
-      if (scanned) {
-        t1.tv_sec = t2.tv_sec;
-        t1.tv_nsec = t2.tv_nsec;
-        return true;
-      } else {
-        return false;
-      }
-    } while (1);
-  } else {
-    return false;
+  if (scanned) {
+    t1 = t2;
   }
+
+  return scanned;
 }
 
 //------------------------------------------------------------------------------
@@ -334,7 +365,8 @@ DiskStat::Measure()
 //------------------------------------------------------------------------------
 // Constructor
 //------------------------------------------------------------------------------
-NetStat::NetStat()
+NetStat::NetStat():
+  mProcFile("/proc/net/dev", std::chrono::milliseconds(0))
 {
   mTags.push_back("face");
   mTags.push_back("rxbytes");
@@ -382,99 +414,39 @@ NetStat::GetRate(const char* dev, const char* key)
 bool
 NetStat::Measure()
 {
-  FILE* fd = fopen("/proc/net/dev", "r");
-
-  if (fd != 0) {
-    XrdSysRWLockHelper wr_lock(&mMutexRW, false);
-    int items = 0;
-    char val[18][1024];
-    char garbage[4096];
-    errno = 0;
-    int n = 0;
-
-    do {
-      garbage[0] = 0;
-
-      if (fgets(garbage, 1024, fd)) {
-        char* dpos = 0;
-
-        if ((dpos = strchr(garbage, ':'))) {
-          *dpos = ' ';
-        }
-      }
-
-      if (n >= 2) {
-        items = sscanf(garbage, "%1023s %1023s %1023s %1023s %1023s %1023s "
-                       "%1023s %1023s %1023s %1023s %1023s %1023s %1023s "
-                       "%1023s %1023s %1023s %1023s\n",
-                       val[0], val[1], val[2], val[3], val[4], val[5], val[6],
-                       val[7], val[8], val[9], val[10], val[11], val[12],
-                       val[13], val[14], val[15], val[16]);
-      } else {
-        items = 0;
-      }
-
-      if (items == 17) {
-	size_t dev_len = strlen(val[0]);
-	if (dev_len && (val[0][dev_len-1] == ':')) {
-	  // newer kernel use <device-name>: in this field ... sigh ...
-	  val[0][dev_len-1] = 0;
-	}
+  if (!mProcFile.Refresh(true)) {
+    return false;
+  }
 
-#ifdef __APPLE__
-        struct timeval tv;
-        gettimeofday(&tv, 0);
-        t2.tv_sec = tv.tv_sec;
-        t2.tv_nsec = tv.tv_usec * 1000;
-#else
-        clock_gettime(CLOCK_REALTIME, &t2);
-#endif
-        std::string dev_name = val[0];
+  XrdSysRWLockHelper wr_lock(&mMutexRW, false);
+  UpdateTimestamp(t2);
+  const std::string_view content = mProcFile.GetContent();
+  std::string_view line;
+  size_t pos = 0;
 
-        for (unsigned int i = 1; i < mTags.size(); i++) {
-          values_t2[dev_name][mTags[i]] = val[i];
-        }
+  while (ProcFile::NextLine(content, pos, line)) {
+    // The two header lines have no colon, older kernels don't put a space
+    // between the colon and the first counter e.g. "eth0:1234 ..."
+    size_t colon = line.find(':');
 
-        if (t1.tv_sec != 0) {
-          float tdif = ((t2.tv_sec - t1.tv_sec) * 1000.0) +
-                       ((t2.tv_nsec - t1.tv_nsec) / 1000000.0);
-
-          for (unsigned int i = 1; i < mTags.size(); i++) {
-            if (tdif > 0) {
-              mRates[dev_name][mTags[i]] =
-                1000.0 * (strtoll(values_t2[dev_name][mTags[i]].c_str(), 0, 10) -
-                          strtoll(values_t1[dev_name][mTags[i]].c_str(), 0, 10)) / tdif;
-            } else {
-              mRates[dev_name][mTags[i]] = 0.0;
-            }
-          }
+    if (colon == std::string_view::npos) {
+      continue;
+    }
 
-          for (unsigned int i = 1; i < mTags.size(); i++) {
-            values_t1[dev_name][mTags[i]] = values_t2[dev_name][mTags[i]];
-          }
-        } else {
-          for (auto it = mTags.begin(); it != mTags.end(); it++) {
-            mRates[dev_name][*it] = 0.0;
-          }
+    std::string_view dev_name = line.substr(0, colon);
+    dev_name.remove_prefix(std::min(dev_name.find_first_not_of(' '),
+                                    dev_name.length()));
+    ProcFile::SplitFields(line.substr(colon + 1), mFields);
 
-          for (unsigned int i = 1; i < mTags.size(); i++) {
-            values_t1[dev_name][mTags[i]] = values_t2[dev_name][mTags[i]];
-          }
-        }
-      } else {
-        if (items < 0) {
-          fclose(fd);
-          t1.tv_sec = t2.tv_sec;
-          t1.tv_nsec = t2.tv_nsec;
-          return true;
-        }
-      }
+    if (dev_name.empty() || (mFields.size() < mTags.size() - 1)) {
+      continue;
+    }
 
-      n++;
-    } while (1);
-  } else {
-    return false;
+    UpdateRates(dev_name, 1, mFields, mTags, t1, t2, mValues, mRates, 1);
   }
+
+  t1 = t2;
+  return true;
 }
 
 EOSFSTNAMESPACE_END
@@ -25,6 +25,7 @@
 #define __EOSFST_LOAD_HH__
 
 #include "fst/Namespace.hh"
+#include "fst/utils/ProcMetrics.hh"
 #include "XrdSys/XrdSysPthread.hh"
 #include <vector>
 #include <map>
@@ -67,10 +68,12 @@ public:
   double GetRate(const char* dev, const char* key);
 
 private:
-  //! Map from device name to map of key/values
-  std::map<std::string, std::map<std::string, std::string > > values_t2;
-  std::map<std::string, std::map<std::string, std::string > > values_t1;
-  std::map<std::string, std::map<std::string, double > > mRates;
+  ProcFile mProcFile; ///< Content of /proc/diskstats
+  std::vector<std::string_view> mFields; ///< Fields of the line being parsed
+  //! Map from device name to the counters of the last measurement
+  std::map<std::string, std::vector<unsigned long long>, std::less<>> mValues;
+  //! Map from device name to map of key/rates
+  std::map<std::string, std::map<std::string, double >, std::less<>> mRates;
   struct timespec t1; ///< Timestamp 1
   struct timespec t2; ///< Timestamp 2 for calculating the rates
   std::vector<std::string> mTags; ///< Network statistics tags
@@ -111,10 +114,12 @@ public:
   double GetRate(const char* dev, const char* key);
 
 private:
-  //! Map from device name to map of key/values
-  std::map<std::string, std::map<std::string, std::string > > values_t2;
-  std::map<std::string, std::map<std::string, std::string > > values_t1;
-  std::map<std::string, std::map<std::string, double > > mRates;
+  ProcFile mProcFile; ///< Content of /proc/net/dev
+  std::vector<std::string_view> mFields; ///< Fields of the line being parsed
+  //! Map from device name to the counters of the last measurement
+  std::map<std::string, std::vector<unsigned long long>, std::less<>> mValues;
+  //! Map from device name to map of key/rates
+  std::map<std::string, std::map<std::string, double >, std::less<>> mRates;
   struct timespec t1; ///< Timestamp 1
   struct timespec t2; ///< Timestamp 2 for calculating the rates
   std::vector<std::string> mTags; ///< Disk statistics tags
@@ -110,26 +110,33 @@ ScanDir::ScanDir(const char* dirpath, eos::common::FileSystem::fsid_t fsid,
   mNumScannedFiles(0), mNumCorruptedFiles(0),
   mNumHWCorruptedFiles(0),  mTotalScanSize(0), mNumTotalFiles(0),
   mNumSkippedFiles(0), mBuffer(nullptr),
-  mBufferSize(0), mBgThread(bgthread), mClock(fake_clock), mRateLimit(nullptr)
+  mBufferSize(0), mDirectIo(false), mBgThread(bgthread), mClock(fake_clock),
+  mRateLimit(nullptr)
 {
   long alignment = pathconf((mDirPath[0] != '/') ? "/" : mDirPath.c_str(),
                             _PC_REC_XFER_ALIGN);
 
+  // Allocate two buffers so that one can be filled while the other one is
+  // checksummed
   if (alignment > 0) {
-    mBufferSize = 256 * alignment;
+    mBufferSize = std::max(sReadBlockSize / alignment, 1l) * alignment;
 
-    if (posix_memalign((void**) &mBuffer, alignment, mBufferSize)) {
+    if (posix_memalign((void**) &mBuffer, alignment, 2 * mBufferSize)) {
       fprintf(stderr, "error: error calling posix_memaling on dirpath=%s. \n",
               mDirPath.c_str());
       std::abort();
     }
+
+    mDirectIo = true;
   } else {
-    mBufferSize = 256 * 1024;
-    mBuffer = (char*) malloc(mBufferSize);
+    mBufferSize = sReadBlockSize;
+    mBuffer = (char*) malloc(2 * mBufferSize);
     fprintf(stderr,
             "error: OS does not provide alignment or path does not exist\n");
   }
 
+  mReadThread = std::thread(&ScanDir::ReadAheadLoop, this);
+
   if (mBgThread) {
     openlog("scandir", LOG_PID | LOG_NDELAY, LOG_USER);
     mDiskThread.reset(&ScanDir::RunDiskScan, this);
@@ -152,6 +159,14 @@ ScanDir::~ScanDir()
     closelog();
   }
 
+  {
+    std::unique_lock<std::mutex> lock(mReadMutex);
+    mReadStop = true;
+  }
+
+  mReadCondVar.notify_all();
+  mReadThread.join();
+
   if (mBuffer) {
     free(mBuffer);
   }
@@ -585,7 +600,12 @@ ScanDir::CheckFile(const std::string& fpath)
   struct stat buf1;
   struct stat buf2;
 
-  if ((io->fileOpen(0, 0)) || io->fileStat(&buf1)) {
+  // Local files are read with O_DIRECT so that we verify what is on disk and
+  // don't evict the page cache, fall back to buffered reads if not supported
+  bool opened = (mDirectIo && (io->GetIoType() == "FsIo") &&
+                 (io->fileOpen(O_RDONLY | O_DIRECT, 0) == 0));
+
+  if ((!opened && io->fileOpen(0, 0)) || io->fileStat(&buf1)) {
     LogMsg(LOG_ERR, "msg=\"open/stat failed\" path=%s\"", fpath.c_str());
     return;
   }
@@ -826,14 +846,14 @@ ScanDir::ScanFileLoadAware(const std::unique_ptr<eos::fst::FileIo>& io,
     comp_file_xs->Reset();
   }
 
-  int64_t nread = 0;
   off_t offset = 0;
   uint64_t open_ts_sec = std::chrono::duration_cast<std::chrono::seconds>
                          (mClock.getTime().time_since_epoch()).count();
+  char* buffers[2] = {mBuffer, mBuffer + mBufferSize};
+  int current = 0;
+  int64_t nread = io->fileRead(offset, buffers[current], mBufferSize);
 
-  do {
-    nread = io->fileRead(offset, mBuffer, mBufferSize);
-
+  while (true) {
     if (nread < 0) {
       if (blockXS) {
         blockXS->CloseMap();
@@ -844,27 +864,48 @@ ScanDir::ScanFileLoadAware(const std::unique_ptr<eos::fst::FileIo>& io,
       return false;
     }
 
-    if (nread) {
-      if (nread > mBufferSize) {
-        eos_err("msg=\"read returned more than the buffer size\" buff_sz=%llu "
-                "nread=%lli\"", mBufferSize, nread);
-        return false;
+    if (nread > mBufferSize) {
+      eos_err("msg=\"read returned more than the buffer size\" buff_sz=%llu "
+              "nread=%lli\"", mBufferSize, nread);
+
+      if (blockXS) {
+        blockXS->CloseMap();
       }
 
+      return false;
+    }
+
+    // Read the next block in the background while checksumming this one
+    const bool read_ahead = (nread == mBufferSize);
+
+    if (read_ahead) {
+      StartReadAhead(io.get(), offset + nread, buffers[1 - current]);
+    }
+
+    if (nread) {
+      char* buffer = buffers[current];
+
       if (blockXS && (blockxs_err == false)) {
-        if (!blockXS->CheckBlockSum(offset, mBuffer, nread)) {
+        if (!blockXS->CheckBlockSum(offset, buffer, nread)) {
           blockxs_err = true;
         }
       }
 
       if (comp_file_xs) {
-        comp_file_xs->Add(mBuffer, nread, offset);
+        comp_file_xs->Add(buffer, nread, offset);
       }
 
       offset += nread;
       EnforceAndAdjustScanRate(offset, open_ts_sec, scan_rate);
     }
-  } while (nread == mBufferSize);
+
+    if (!read_ahead) {
+      break;
+    }
+
+    nread = WaitReadAhead();
+    current = 1 - current;
+  }
 
   scan_size = (unsigned long long) offset;
 
@@ -907,6 +948,66 @@ ScanDir::ScanFileLoadAware(const std::unique_ptr<eos::fst::FileIo>& io,
   return true;
 }
 
+//------------------------------------------------------------------------------
+// Loop of the read-ahead thread
+//------------------------------------------------------------------------------
+void
+ScanDir::ReadAheadLoop()
+{
+  std::unique_lock<std::mutex> lock(mReadMutex);
+
+  while (true) {
+    mReadCondVar.wait(lock, [this] {
+      return mReadStop || mReadPending;
+    });
+
+    if (mReadStop) {
+      break;
+    }
+
+    // The request is not modified until its result is collected
+    mReadPending = false;
+    lock.unlock();
+    int64_t nread = mReadIo->fileRead(mReadOffset, mReadBuffer, mBufferSize);
+    lock.lock();
+    mReadResult = nread;
+    mReadDone = true;
+    mReadCondVar.notify_all();
+  }
+}
+
+//------------------------------------------------------------------------------
+// Hand over the read of the next block to the read-ahead thread
+//------------------------------------------------------------------------------
+void
+ScanDir::StartReadAhead(eos::fst::FileIo* io, off_t offset, char* buffer)
+{
+  {
+    std::unique_lock<std::mutex> lock(mReadMutex);
+    mReadIo = io;
+    mReadOffset = offset;
+    mReadBuffer = buffer;
+    mReadDone = false;
+    mReadPending = true;
+  }
+
+  mReadCondVar.notify_all();
+}
+
+//------------------------------------------------------------------------------
+// Wait for the read started by StartReadAhead
+//------------------------------------------------------------------------------
+int64_t
+ScanDir::WaitReadAhead()
+{
+  std::unique_lock<std::mutex> lock(mReadMutex);
+  mReadCondVar.wait(lock, [this] {
+    return mReadDone;
+  });
+  mReadDone = false;
+  return mReadResult;
+}
+
 //------------------------------------------------------------------------------
 // Enforce the scan rate by throttling the current thread and also adjust it
 // depending on the IO load on the mountpoint
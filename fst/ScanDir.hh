@@ -31,7 +31,10 @@
 #include "common/RateLimit.hh"
 #include "namespace/interface/IFileMD.hh"
 #include "namespace/ns_quarkdb/persistency/MetadataFetcher.hh"
+#include <condition_variable>
 #include <deque>
+#include <mutex>
+#include <thread>
 
 EOSFSTNAMESPACE_BEGIN
 
@@ -170,6 +173,28 @@ public:
   void EnforceAndAdjustScanRate(const off_t offset, const uint64_t open_ts_sec,
                                 int& scan_rate);
 
+  //----------------------------------------------------------------------------
+  //! Loop of the read-ahead thread filling one buffer while the scanner
+  //! checksums the other one
+  //----------------------------------------------------------------------------
+  void ReadAheadLoop();
+
+  //----------------------------------------------------------------------------
+  //! Hand over the read of the next block to the read-ahead thread
+  //!
+  //! @param io io object attached to the file
+  //! @param offset offset of the block
+  //! @param buffer buffer of mBufferSize to fill
+  //----------------------------------------------------------------------------
+  void StartReadAhead(eos::fst::FileIo* io, off_t offset, char* buffer);
+
+  //----------------------------------------------------------------------------
+  //! Wait for the read started by StartReadAhead
+  //!
+  //! @return number of bytes read or -1 if error
+  //----------------------------------------------------------------------------
+  int64_t WaitReadAhead();
+
 #ifndef _NOOFS
   //----------------------------------------------------------------------------
   //! Collect all file ids present on the current file system from the NS view
@@ -259,11 +284,25 @@ public:
   long long int mTotalScanSize;
   long int mNumTotalFiles;
   long int mNumSkippedFiles;
-  char* mBuffer; ///< Buffer used for reading
-  uint32_t mBufferSize; ///< Size of the reading buffer
+  //! Block size used for reading, large enough to keep a disk streaming
+  static constexpr long sReadBlockSize {4 * 1024 * 1024};
+  char* mBuffer; ///< Two consecutive buffers of mBufferSize used for reading
+  uint32_t mBufferSize; ///< Size of one reading buffer
+  bool mDirectIo; ///< Buffers are aligned for O_DIRECT reads
   bool mBgThread; ///< If true running as background thread inside the FST
   AssistedThread mDiskThread; ///< Thread doing the scanning of the disk
   AssistedThread mNsThread; ///< Thread doing the scanning of NS entries
+  //! Read-ahead of the next block, one request in flight at a time
+  std::mutex mReadMutex;
+  std::condition_variable mReadCondVar;
+  eos::fst::FileIo* mReadIo {nullptr}; ///< File of the pending read
+  off_t mReadOffset {0}; ///< Offset of the pending read
+  char* mReadBuffer {nullptr}; ///< Buffer of the pending read
+  int64_t mReadResult {0}; ///< Result of the last read
+  bool mReadPending {false}; ///< A read is waiting for the thread
+  bool mReadDone {false}; ///< The result of the last read is available
+  bool mReadStop {false};
+  std::thread mReadThread; ///< Thread doing the read-ahead
   eos::common::SteadyClock mClock; ///< Clock wrapper also used for testing
   //! Rate limiter for ns scanning which actually limits the number of stat
   //! requests send across the disks in one FSTs.
@@ -312,7 +312,8 @@ XrdFstOfs::xrdfstofs_graceful_shutdown(int sig)
 // Constructor
 //------------------------------------------------------------------------------
 XrdFstOfs::XrdFstOfs() :
-  eos::common::LogId(), mHostName(NULL), mMqOnQdb(false), mHttpd(nullptr),
+  eos::common::LogId(), mHostName(NULL), mMqOnQdb(false),
+  mZeroCopyRead(false), mHttpd(nullptr),
   mGeoTag("nogeotag"),
   mXrdBuffPool(eos::common::KB, 32 * eos::common::MB),
   mCloseThreadPool(8, 64, 5, 6, 5, "async_close"),
@@ -429,6 +430,13 @@ XrdFstOfs::Configure(XrdSysError& Eroute, XrdOucEnv* envP)
                " clients - make sure MGM enforces sss for this FST!");
   }
 
+  // Zero-copy reads also need sendfile enabled in the protocol i.e. no "nosf"
+  // in the xrootd.async directive
+  if (getenv("EOS_FST_ZERO_COPY_READ")) {
+    mZeroCopyRead = true;
+    Eroute.Say("=====> fstofs serves plain layout reads with sendfile");
+  }
+
   // Get the hostname
   const char* errtext = 0;
   mHostName = XrdNetUtils::MyHostName(0, &errtext);
@@ -766,6 +774,14 @@ XrdFstOfs::Configure(XrdSysError& Eroute, XrdOucEnv* envP)
   ObjectManager.SetAutoReplyQueue("/eos/*/mgm");
   ObjectManager.SetDebug(false);
 
+  // Publish the shared hash updates as binary deltas, requires MGMs which
+  // understand the encoding. A value of "zlib" also compresses large deltas.
+  if (getenv("EOS_FST_MQ_BINARY_DELTA")) {
+    bool compress = (strcmp(getenv("EOS_FST_MQ_BINARY_DELTA"), "zlib") == 0);
+    ObjectManager.EnableBinaryDelta(true, compress);
+    Eroute.Say("=====> fstofs.mq.binarydelta : ", compress ? "zlib" : "on");
+  }
+
   // Enable experimental MQ on QDB? Note that any functionality not supported
   // will fallback to regular MQ, which is still required.
   if (getenv("EOS_USE_MQ_ON_QDB")) {
@@ -800,6 +816,24 @@ XrdFstOfs::Configure(XrdSysError& Eroute, XrdOucEnv* envP)
     Eroute.Say("=====> fstofs.authdir : ",
                eos::fst::Config::gConfig.FstAuthDir.c_str());
   }
+  // Group commit of the file metadata records, the value is the maximum delay
+  // in milliseconds before a record is written to the local database
+  if (getenv("EOS_FST_FMD_COMMIT_DELAY_MS")) {
+    try {
+      long delay_ms = std::stol(getenv("EOS_FST_FMD_COMMIT_DELAY_MS"));
+
+      if (delay_ms > 0) {
+        gFmdDbMapHandler.EnableGroupCommit(std::chrono::milliseconds(delay_ms),
+                                           1024);
+        Eroute.Say("=====> fstofs.fmd.commitdelay : ",
+                   std::to_string(delay_ms).c_str(), " ms");
+      }
+    } catch (...) {
+      Eroute.Emsg("Config", "invalid EOS_FST_FMD_COMMIT_DELAY_MS value");
+      return 1;
+    }
+  }
+
   // Attach Storage to the meta log dir
   Storage = eos::fst::Storage::Create(
               eos::fst::Config::gConfig.FstMetaLogDir.c_str());
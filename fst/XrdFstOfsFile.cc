@@ -34,6 +34,7 @@
 #include "fst/checksum/ChecksumPlugins.hh"
 #include "fst/storage/FileSystem.hh"
 #include "XrdOss/XrdOssApi.hh"
+#include "XrdSfs/XrdSfsDio.hh"
 #include "fst/io/FileIoPluginCommon.hh"
 #include "namespace/utils/Etag.hh"
 
@@ -58,7 +59,8 @@ XrdFstOfsFile::XrdFstOfsFile(const char* user, int MonID) :
   mHasWrite(false), hasWriteError(false), hasReadError(false), mIsRW(false),
   mIsDevNull(false), isCreation(false), isReplication(false),
   noAtomicVersioning(false),
-  mIsInjection(false), mRainReconstruct(false), deleteOnClose(false),
+  mIsInjection(false), mRainReconstruct(false), mZeroCopy(false),
+  deleteOnClose(false),
   repairOnClose(false), mIsOCchunk(false), writeErrorFlag(false),
   mEventOnClose(false), mEventWorkflow(""),
   mSyncEventOnClose(false), mFmd(nullptr), mCheckSum(nullptr),
@@ -762,12 +764,10 @@ XrdFstOfsFile::write(XrdSfsFileOffset fileOffset, const char* buffer,
     return buffer_size;
   }
 
-  // if the write position moves the checksum is dirty
+  // Out-of-order writes don't make the checksum dirty, the checksum objects
+  // either combine the pieces or flag the need for a rescan themselves. The
+  // coverage of an existing file is checked when verifying the checksum.
   if (mCheckSum) {
-    if (mWritePosition != (unsigned long long)fileOffset) {
-      mCheckSum->SetDirty();
-    }
-
     // store next write position
     mWritePosition = fileOffset + buffer_size;
   }
@@ -1856,6 +1856,111 @@ XrdFstOfsFile::fctl(const int cmd, int alen, const char* args,
   return SFS_ERROR;
 }
 
+//------------------------------------------------------------------------------
+// Implementation dependant commands (version 1)
+//------------------------------------------------------------------------------
+int
+XrdFstOfsFile::fctl(const int cmd, const char* args, XrdOucErrInfo& out_error)
+{
+  if (cmd == SFS_FCTL_GETFD) {
+    if (IsZeroCopyCandidate()) {
+      // The data is never seen by us so the checksum can not be verified on
+      // read, same as for the "nochecksum" command
+      mZeroCopy = true;
+      mCheckSum.reset(nullptr);
+      eos_debug("msg=\"serving reads with sendfile\" fxid=%08llx", mFileId);
+      out_error.setErrCode(SFS_SFIO_FDVAL);
+    } else {
+      out_error.setErrCode(-1);
+    }
+
+    return SFS_OK;
+  }
+
+  return XrdOfsFile::fctl(cmd, args, out_error);
+}
+
+//------------------------------------------------------------------------------
+// Send file data to the client using sendfile
+//------------------------------------------------------------------------------
+int
+XrdFstOfsFile::SendData(XrdSfsDio* sfDio, XrdSfsFileOffset offset,
+                        XrdSfsXferSize size)
+{
+  // Returning without sending anything makes XRootD fall back to read
+  if (!mZeroCopy || gOFS.mSimIoReadErr || (offset < 0) || (size <= 0)) {
+    return SFS_OK;
+  }
+
+  XrdOucErrInfo fd_error;
+
+  if (XrdOfsFile::fctl(SFS_FCTL_GETFD, 0, fd_error) ||
+      (fd_error.getErrInfo() < 0)) {
+    return SFS_OK;
+  }
+
+  int fd = fd_error.getErrInfo();
+  struct stat buf;
+
+  if (fstat(fd, &buf)) {
+    return SFS_OK;
+  }
+
+  // Reads starting at or past the end of the file use the regular read path
+  if (offset >= buf.st_size) {
+    return SFS_OK;
+  }
+
+  if (offset + size > buf.st_size) {
+    size = buf.st_size - offset;
+  }
+
+  if (mFsId && !gOFS.Storage->mFsMap.count(mFsId)) {
+    return gOFS.Emsg("SendData", error, EBADF,
+                     "read file - filesystem has been unregistered");
+  }
+
+  gettimeofday(&cTime, &tz);
+  rCalls++;
+  // The first element of the vector is reserved for the protocol
+  XrdOucSFVec sfv[2];
+  sfv[1].offset = offset;
+  sfv[1].sendsz = size;
+  sfv[1].fdnum = fd;
+
+  if (sfDio->SendFile(sfv, 2)) {
+    eos_err("msg=\"sendfile failed\" fxid=%08llx off=%lld len=%i",
+            mFileId, offset, size);
+    return gOFS.Emsg("SendData", error, EIO, "send file data fn=",
+                     mNsPath.c_str());
+  }
+
+  eos_debug("sendfile %llu %llu %i", this, offset, size);
+  AccountReadOfs(offset, size);
+  gettimeofday(&lrTime, &tz);
+  AddReadTime();
+  return SFS_OK;
+}
+
+//------------------------------------------------------------------------------
+// Check if reads of the file can be served with sendfile
+//------------------------------------------------------------------------------
+bool
+XrdFstOfsFile::IsZeroCopyCandidate() const
+{
+  using eos::common::LayoutId;
+
+  // Only a file on a local file system has a descriptor usable by sendfile
+  if (LayoutId::GetIoType(mFstPath.c_str()) != LayoutId::kLocal) {
+    return false;
+  }
+
+  return (gOFS.mZeroCopyRead && mOpened && !mIsRW && !mIsDevNull &&
+          !mRainReconstruct && (mTpcFlag == kTpcNone) &&
+          (LayoutId::GetLayoutType(mLid) == LayoutId::kPlain) &&
+          (LayoutId::GetBlockChecksum(mLid) == LayoutId::kNone));
+}
+
 //------------------------------------------------------------------------------
 // Low-level open calling the default XrdOfs plugin
 //------------------------------------------------------------------------------
@@ -1905,6 +2010,19 @@ XrdFstOfsFile::readofs(XrdSfsFileOffset fileOffset, char* buffer,
     }
   }
 
+  AccountReadOfs(fileOffset, rc);
+  gettimeofday(&lrTime, &tz);
+  AddReadTime();
+  return rc;
+}
+
+//------------------------------------------------------------------------------
+// Account a read done on the physical file for monitoring
+//------------------------------------------------------------------------------
+void
+XrdFstOfsFile::AccountReadOfs(XrdSfsFileOffset fileOffset,
+                              XrdSfsXferSize nread)
+{
   // Account seeks for monitoring
   if (rOffset != static_cast<unsigned long long>(fileOffset)) {
     if (rOffset < static_cast<unsigned long long>(fileOffset)) {
@@ -1929,18 +2047,14 @@ XrdFstOfsFile::readofs(XrdSfsFileOffset fileOffset, char* buffer,
     }
   }
 
-  if (rc > 0) {
+  if (nread > 0) {
     if (mLayout->IsEntryServer() || eos::common::LayoutId::IsRain(mLid)) {
       XrdSysMutexHelper vecLock(vecMutex);
-      rvec.push_back(rc);
+      rvec.push_back(nread);
     }
 
-    rOffset = fileOffset + rc;
+    rOffset = fileOffset + nread;
   }
-
-  gettimeofday(&lrTime, &tz);
-  AddReadTime();
-  return rc;
 }
 
 //------------------------------------------------------------------------------
@@ -2982,14 +3096,14 @@ XrdFstOfsFile::VerifyChecksum()
 
     // -------------------------------------------------------------------------------------------------------------------
     // !!! CAUTION !!!
-    // be carefule with adler checksum - finalize can remove the dirty flag if all pieces of a file until the max checksum
-    // offset were written - however if the file size is diffrent from the max checksum offset, the checksum is dirty
-    // because the ending part of a file was not written
+    // finalize clears the recalculation flag if all pieces of a file until the max checksum offset were written - however
+    // if the file size is diffrent from the max checksum offset, the checksum is dirty because the ending part of a file
+    // was not written
     // -------------------------------------------------------------------------------------------------------------------
     if ((mIsRW) && mCheckSum->GetMaxOffset() &&
-	(mCheckSum->GetMaxOffset() != (off_t)mMaxOffsetWritten)) {
-      // If there was a write which was not extending the file the checksum
-      // is dirty!
+        !ChecksumCoversFile(*mCheckSum, openSize, mMaxOffsetWritten)) {
+      // If there was a write which was not extending the file or the file
+      // was only partially overwritten the checksum is dirty!
       mCheckSum->SetDirty();
     }
 
@@ -3602,6 +3716,17 @@ int XrdFstOfsFile::SendArchiveFailedToManager(const uint64_t fid,
                           errorReportOpaque, nullptr, 30, mSyncEventOnClose, false);
 }
 
+//------------------------------------------------------------------------------
+// Check if the checksum pieces cover the whole file
+//------------------------------------------------------------------------------
+bool
+XrdFstOfsFile::ChecksumCoversFile(CheckSum& xs, off_t open_size,
+                                  unsigned long long max_written)
+{
+  const off_t max_offset = xs.GetMaxOffset();
+  return ((max_offset == (off_t) max_written) && (max_offset >= open_size));
+}
+
 //------------------------------------------------------------------------------
 // Get hostname from tident
 //------------------------------------------------------------------------------
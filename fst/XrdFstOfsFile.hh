@@ -203,6 +203,34 @@ public:
   int fctl(const int cmd, int alen, const char* args,
            const XrdSecEntity* client = 0) override;
 
+  //----------------------------------------------------------------------------
+  //! Execute special operation on the file (version 1). The physical file
+  //! descriptor is never handed out for SFS_FCTL_GETFD since the data seen by
+  //! the client is produced by the layout. Reads that can be served directly
+  //! from the physical file get SFS_SFIO_FDVAL so that XRootD calls SendData.
+  //!
+  //! @param cmd operation to be performed
+  //! @param args data sent with the request
+  //! @param out_error error object, holds the file descriptor for GETFD
+  //!
+  //! @return SFS_OK if successful, otherwise SFS_ERROR
+  //----------------------------------------------------------------------------
+  int fctl(const int cmd, const char* args, XrdOucErrInfo& out_error) override;
+
+  //----------------------------------------------------------------------------
+  //! Send file data to the client using sendfile from the physical file
+  //! without copying it through a user space buffer
+  //!
+  //! @param sfDio pointer to the direct I/O interface of the protocol
+  //! @param offset file offset
+  //! @param size number of bytes to send
+  //!
+  //! @return SFS_OK if the data was sent or if no data was sent and a normal
+  //!         read should be issued instead, otherwise SFS_ERROR
+  //----------------------------------------------------------------------------
+  int SendData(XrdSfsDio* sfDio, XrdSfsFileOffset offset,
+               XrdSfsXferSize size) override;
+
   //----------------------------------------------------------------------------
   //! Return logical path
   //----------------------------------------------------------------------------
@@ -261,6 +289,7 @@ public:
   //! checksum must match
   bool mIsInjection;
   bool mRainReconstruct; ///< indicator that the opened file is in a RAIN reconstruction process
+  bool mZeroCopy; ///< Reads are served with sendfile from the physical file
   bool deleteOnClose; ///< indicator that the file has to be cleaned on close
   bool repairOnClose; ///< indicator that the file should get repaired on close
   bool mIsOCchunk; //! indicator this is an OC chunk upload
@@ -392,6 +421,21 @@ public:
   static void FilterTagsInPlace(std::string& opaque,
                                 const std::set<std::string> tags);
 
+  //----------------------------------------------------------------------------
+  //! Check if the pieces added to the checksum of a file opened for update
+  //! cover the whole file. The checksum is not seeded with the content the
+  //! file had when opened, so an in-place update that doesn't reach the
+  //! original size e.g. overwriting a prefix needs a rescan.
+  //!
+  //! @param xs checksum object
+  //! @param open_size file size when the file was opened
+  //! @param max_written max offset written
+  //!
+  //! @return true if covered, otherwise false
+  //----------------------------------------------------------------------------
+  static bool ChecksumCoversFile(CheckSum& xs, off_t open_size,
+                                 unsigned long long max_written);
+
   //----------------------------------------------------------------------------
   //! Close internal method that can be called synchronously (from XRootD) or
   //! asynchronously from the thread pool for long running close operations.
@@ -414,6 +458,21 @@ public:
   XrdSfsXferSize readofs(XrdSfsFileOffset fileOffset, char* buffer,
                          XrdSfsXferSize buffer_size);
 
+  //----------------------------------------------------------------------------
+  //! Account a read done on the physical file for monitoring
+  //!
+  //! @param fileOffset offset of the read
+  //! @param nread number of bytes read
+  //----------------------------------------------------------------------------
+  void AccountReadOfs(XrdSfsFileOffset fileOffset, XrdSfsXferSize nread);
+
+  //----------------------------------------------------------------------------
+  //! Check if reads of the file can be served with sendfile i.e. the file is
+  //! opened read-only with a plain layout and the data needs no processing
+  //! like block or file checksum verification, reconstruction or TPC
+  //----------------------------------------------------------------------------
+  bool IsZeroCopyCandidate() const;
+
   //----------------------------------------------------------------------------
   //! Low-level vector read calling the default XrdOfs plugin
   //----------------------------------------------------------------------------
@@ -27,13 +27,22 @@
 #include "common/BufferManager.hh"
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 #include <fcntl.h>
+#include <limits.h>
 #include <algorithm>
 
 namespace
 {
 eos::common::BufferManager gOssBuffMgr(16 * eos::common::MB, 1,
                                        4  * eos::common::KB);
+//! Buffers for the vector read extents, from 4KB up to 1MB
+eos::common::BufferManager gOssReadVBuffMgr(64 * eos::common::MB, 8,
+    4  * eos::common::KB);
+//! Max gap between two chunks of a vector read which are read in one go
+const size_t sReadVMaxGap = 16 * eos::common::KB;
+//! Max length of an extent of merged vector read chunks
+const size_t sReadVMaxExtent = 1 * eos::common::MB;
 }
 
 EOSFSTNAMESPACE_BEGIN
@@ -363,6 +372,11 @@ XrdFstOssFile::ReadV(XrdOucIOVec* readV, int n)
 {
   ssize_t rdsz;
   ssize_t totBytes = 0;
+
+  if (fd < 0) {
+    return static_cast<ssize_t>(-EBADF);
+  }
+
 #if defined(__linux__)
   long long begOff, endOff, begLst = -1, endLst = -1;
   int nPR = n;
@@ -393,40 +407,59 @@ XrdFstOssFile::ReadV(XrdOucIOVec* readV, int n)
 
 #endif
 
-  // Read in the vector and do a pre-advise if we support that
-  for (int i = 0; i < n; i++) {
-    // Use normal block read since it also does the blockxs and we have the
-    // guarantee that the previous advice was issued for the full block to
-    // be read even with the 4K alignment since fadvice does this on its own
-    rdsz = Read(readV[i].data, readV[i].offset, readV[i].size);
+  // Merge nearby chunks and read every extent with a single request, with
+  // blockxs the extents are aligned to the checksum blocks
+  const uint64_t align = (mBlockXs ? eos::common::LayoutId::OssXsBlockSize : 1);
+  std::vector<ReadVExtent> extents = MergeReadV(readV, n, sReadVMaxGap,
+                                     sReadVMaxExtent, IOV_MAX / 2, align);
+  std::shared_ptr<eos::common::Buffer> scratch;
+
+  if (!mBlockXs) {
+    scratch = gOssReadVBuffMgr.GetBuffer(sReadVMaxGap);
+
+    if (scratch == nullptr) {
+      throw std::bad_alloc();
+    }
+  }
 
-    if (rdsz < 0 || rdsz != readV[i].size) {
-      totBytes = (rdsz < 0 ? -errno : -ESPIPE);
+  for (const auto& extent : extents) {
+    if (mBlockXs) {
+      rdsz = ReadExtentXs(readV, extent);
+    } else {
+      rdsz = ReadExtent(readV, extent, scratch->GetDataPtr());
+    }
+
+    if (rdsz < 0) {
+      totBytes = rdsz;
       break;
     }
 
     totBytes += rdsz;
 #if defined(__linux__)
 
-    if (nPR < n && readV[nPR].size > 0) {
-      begOff = XrdFstSS->mPrPMask &  readV[nPR].offset;
-      endOff = XrdFstSS->mPrPBits | (readV[nPR].offset + readV[nPR].size);
-      rdsz = endOff - begOff + 1;
+    // Keep the read-ahead advice going for the chunks still to come
+    for (size_t i = 0; i < extent.mChunks.size(); ++i, ++nPR) {
+      if (nPR < n && readV[nPR].size > 0) {
+        begOff = XrdFstSS->mPrPMask &  readV[nPR].offset;
+        endOff = XrdFstSS->mPrPBits | (readV[nPR].offset + readV[nPR].size);
+        rdsz = endOff - begOff + 1;
 
-      if ((begOff > endLst || endOff < begLst)
-          &&  rdsz <= XrdFstSS->mPrBytes) {
-        posix_fadvise(fd, begOff, rdsz, POSIX_FADV_WILLNEED);
-        eos_debug("fadvise fd=%i off=%lli len=%ji", fd, begOff, rdsz);
-      }
+        if ((begOff > endLst || endOff < begLst)
+            &&  rdsz <= XrdFstSS->mPrBytes) {
+          posix_fadvise(fd, begOff, rdsz, POSIX_FADV_WILLNEED);
+          eos_debug("fadvise fd=%i off=%lli len=%ji", fd, begOff, rdsz);
+        }
 
-      begLst = begOff;
-      endLst = endOff;
+        begLst = begOff;
+        endLst = endOff;
+      }
     }
 
-    nPR++;
 #endif
   }
 
+  gOssReadVBuffMgr.Recycle(scratch);
+
 // All done, return bytes read.
 #if defined(__linux__)
 
@@ -439,6 +472,146 @@ XrdFstOssFile::ReadV(XrdOucIOVec* readV, int n)
 }
 
 
+//------------------------------------------------------------------------------
+// Read an extent of a vector read with a single preadv
+//------------------------------------------------------------------------------
+ssize_t
+XrdFstOssFile::ReadExtent(XrdOucIOVec* readV, const ReadVExtent& extent,
+                          char* scratch)
+{
+  std::vector<struct iovec> iov;
+  iov.reserve(2 * extent.mChunks.size());
+  off_t pos = extent.mOffset;
+  ssize_t nchunk = 0;
+
+  for (int idx : extent.mChunks) {
+    if (readV[idx].offset > pos) {
+      iov.push_back({scratch, (size_t)(readV[idx].offset - pos)});
+    }
+
+    iov.push_back({readV[idx].data, (size_t) readV[idx].size});
+    pos = readV[idx].offset + readV[idx].size;
+    nchunk += readV[idx].size;
+  }
+
+  const size_t length = pos - extent.mOffset;
+  size_t done = 0;
+  size_t first = 0;
+  ssize_t nread;
+
+  while (done < length) {
+    do {
+      nread = preadv(fd, iov.data() + first, iov.size() - first,
+                     extent.mOffset + done);
+    } while ((nread < 0) && (errno == EINTR));
+
+    if (nread < 0) {
+      eos_err("msg=\"failed readv\" offset=%lld length=%zu errno=%d",
+              (long long) extent.mOffset, length, errno);
+      return -EIO;
+    }
+
+    if (nread == 0) {
+      eos_err("msg=\"readv past end of file\" offset=%lld length=%zu",
+              (long long) extent.mOffset, length);
+      return -ESPIPE;
+    }
+
+    done += nread;
+
+    // Skip what was read, a short read can stop in the middle of a vector
+    while ((first < iov.size()) && ((size_t) nread >= iov[first].iov_len)) {
+      nread -= iov[first].iov_len;
+      ++first;
+    }
+
+    if (nread) {
+      iov[first].iov_base = (char*) iov[first].iov_base + nread;
+      iov[first].iov_len -= nread;
+    }
+  }
+
+  eos_debug("msg=\"readv extent\" offset=%lld length=%zu chunks=%zu",
+            (long long) extent.mOffset, length, extent.mChunks.size());
+  return nchunk;
+}
+
+//------------------------------------------------------------------------------
+// Read a block aligned extent of a vector read and verify its checksums
+//------------------------------------------------------------------------------
+ssize_t
+XrdFstOssFile::ReadExtentXs(XrdOucIOVec* readV, const ReadVExtent& extent)
+{
+  auto buffer = gOssReadVBuffMgr.GetBuffer(extent.mLength);
+
+  if (buffer == nullptr) {
+    // Single chunk larger than the biggest buffer, regular block read
+    ssize_t nchunk = 0;
+
+    for (int idx : extent.mChunks) {
+      ssize_t nread = Read(readV[idx].data, readV[idx].offset, readV[idx].size);
+
+      if (nread != readV[idx].size) {
+        return (nread < 0 ? nread : -ESPIPE);
+      }
+
+      nchunk += nread;
+    }
+
+    return nchunk;
+  }
+
+  char* data = buffer->GetDataPtr();
+  size_t done = 0;
+  ssize_t nread;
+
+  while (done < extent.mLength) {
+    do {
+      nread = pread(fd, data + done, extent.mLength - done,
+                    extent.mOffset + done);
+    } while ((nread < 0) && (errno == EINTR));
+
+    if (nread <= 0) {
+      break;
+    }
+
+    done += nread;
+  }
+
+  ssize_t retc = 0;
+
+  if (nread < 0) {
+    eos_err("msg=\"failed read\" offset=%lld length=%zu errno=%d",
+            (long long) extent.mOffset, extent.mLength, errno);
+    retc = -EIO;
+  } else {
+    XrdSysRWLockHelper wr_lock(mRWLockXs, 0);
+
+    if (done && !mBlockXs->CheckBlockSum(extent.mOffset, data, done)) {
+      eos_err("error=read block-xs error offset=%lld, length=%zu",
+              (long long) extent.mOffset, done);
+      retc = -EIO;
+    }
+  }
+
+  for (auto it = extent.mChunks.begin();
+       (retc >= 0) && (it != extent.mChunks.end()); ++it) {
+    const XrdOucIOVec& chunk = readV[*it];
+
+    if (chunk.offset + chunk.size > (long long)(extent.mOffset + done)) {
+      // The file ends before the chunk
+      retc = -ESPIPE;
+      break;
+    }
+
+    memcpy(chunk.data, data + (chunk.offset - extent.mOffset), chunk.size);
+    retc += chunk.size;
+  }
+
+  gOssReadVBuffMgr.Recycle(buffer);
+  return retc;
+}
+
 //------------------------------------------------------------------------------
 // Vector write
 //------------------------------------------------------------------------------
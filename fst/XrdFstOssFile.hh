@@ -26,6 +26,7 @@
 #define __EOSFST_FSTOSSFILE_HH__
 
 #include "fst/Namespace.hh"
+#include "fst/utils/ReadVExtents.hh"
 #include "common/Logging.hh"
 #include "XrdOss/XrdOss.hh"
 #include <map>
@@ -200,6 +201,32 @@ public:
   AlignBuffer(void* buffer, off_t offset, size_t length,
               std::shared_ptr<eos::common::Buffer>& start_piece,
               std::shared_ptr<eos::common::Buffer>& end_piece);
+
+  //--------------------------------------------------------------------------
+  //! Read an extent of a vector read with a single preadv scattering the
+  //! data directly into the chunk buffers, the gaps go to a scratch buffer
+  //!
+  //! @param readV chunks of the vector read
+  //! @param extent extent to read
+  //! @param scratch buffer of at least the max gap size
+  //!
+  //! @return number of chunk bytes read, -ESPIPE if the file is too short,
+  //!         -EIO on error
+  //--------------------------------------------------------------------------
+  ssize_t ReadExtent(XrdOucIOVec* readV, const ReadVExtent& extent,
+                     char* scratch);
+
+  //--------------------------------------------------------------------------
+  //! Read a block aligned extent of a vector read into a bounce buffer,
+  //! verify its block checksums and copy out the chunks
+  //!
+  //! @param readV chunks of the vector read
+  //! @param extent extent to read
+  //!
+  //! @return number of chunk bytes read, -ESPIPE if the file is too short,
+  //!         -EIO on error
+  //--------------------------------------------------------------------------
+  ssize_t ReadExtentXs(XrdOucIOVec* readV, const ReadVExtent& extent);
 };
 
 EOSFSTNAMESPACE_END
@@ -34,58 +34,37 @@ EOSFSTNAMESPACE_BEGIN
 bool
 Adler::Add (const char* buffer, size_t length, off_t offset)
 {
-  if (offset != adleroffset)
-    needsRecalculation = true;
-
-  if (finalized)                /* handle read/append case, no problem in this case */
-      finalized = false;
-
-  adler = adler32(0L, Z_NULL, 0);
-  Chunk currChunk;
-
+  // pieces are combined when finalizing, this also handles read/append
+  finalized = false;
+  adleroffset = offset + length;
+  bool added = intervals.Add(offset, length, [&](const unsigned int* prev) {
+    unsigned int value = (prev ? *prev : adler32(0L, Z_NULL, 0));
 #ifdef ISAL_FOUND
-  adler = isal_adler32(adler, (const unsigned char*) buffer, length);
+    return isal_adler32(value, (const unsigned char*) buffer, length);
 #else
-  adler = adler32(adler, (const Bytef*) buffer, length);
+    return (unsigned int) adler32(value, (const Bytef*) buffer, length);
 #endif
-  adleroffset = offset + length;
-  if (adleroffset > maxoffset)
-  {
-    maxoffset = adleroffset;
-  }
-  currChunk.offset = offset;
-  currChunk.length = length;
-  currChunk.adler = adler;
-
-  map = AddElementToMap(map, currChunk);
+  });
 
-  return true;
-}
-
-/*----------------------------------------------------------------------------*/
-MapChunks&
-Adler::AddElementToMap (MapChunks& map, Chunk& chunk)
-{
-  off_t offEndChunk = chunk.offset + chunk.length;
-  IterMap iter = map.find(offEndChunk);
-
-  if (iter != map.end())
-  {
-    map.erase(iter);
-    map.insert(std::pair<off_t, Chunk > (offEndChunk, chunk));
-  }
-  else
+  if (!added)
   {
-    map.insert(std::pair<off_t, Chunk > (offEndChunk, chunk));
+    // overwrite of data already added, the pieces can not be combined
+    dirty = true;
   }
 
-  return map;
+  needsRecalculation = dirty || intervals.HasHoles();
+  return added;
 }
 
 /*----------------------------------------------------------------------------*/
 const char*
 Adler::GetHexChecksum ()
 {
+  if (!finalized)
+  {
+    Finalize();
+  }
+
   char sadler[1024];
   sprintf(sadler, "%08x", adler);
   Checksum = sadler;
@@ -96,113 +75,30 @@ Adler::GetHexChecksum ()
 const char*
 Adler::GetBinChecksum (int &len)
 {
+  if (!finalized)
+  {
+    Finalize();
+  }
+
   len = sizeof (unsigned int);
   return (char*) &adler;
 }
 
 /*----------------------------------------------------------------------------*/
 
-/* compute the adler value of the map if we have the full map
- * (starts from 0 and there are no holes)
+/* the adler value is known if the pieces cover the file from 0 without holes,
+ * adjacent pieces were already combined when added
  */
 void
-Adler::ValidateAdlerMap ()
+Adler::Finalize ()
 {
-  unsigned int value;
-  adler = adler32(0L, Z_NULL, 0);
-
-  if (map.begin() == map.end())
-  {
-    adler = adler32(0L, Z_NULL, 0);
-    return;
-  }
-
-  IterMap iter1 = map.begin();
-  IterMap iter2 = iter1;
-
-  value = iter1->second.adler;
-
-  IterMap iter3;
-  //  for (iter3= map.begin(); iter3!= map.end(); iter3++) {
-  //    fprintf(stderr,"ADLER VALIDATE %llu %llu %llu %x\n", iter3->first,iter3->second.offset, iter3->second.length, iter3->second.adler);
-  //  } 
-
-  if (iter1->second.offset != 0)
-  {
-    // the first chunk is not at the beginning
-    needsRecalculation = true;
-    adler = adler32(0L, Z_NULL, 0);
-    return;
-  }
-
-  if (map.begin() == map.end())
-  {
-    //we have no chunk
-    adler = adler32(0L, Z_NULL, 0);
-    return;
-  }
-
-  needsRecalculation = false;
-
-  iter2++;
-
-  if (iter2 == map.end())
-  {
-    if ((iter1->first) != maxoffset)
-    {
-      // there was probably some overwrite
-      needsRecalculation = true;
-    }
-    else
-    {
-      if (iter1->second.offset != 0)
-      {
-        needsRecalculation = true;
-      }
-    }
-    //we have one chunk
-    adler = value;
-    return;
-  }
-
-  off_t appliedoffset = 0;
-
-  for (; iter2 != map.end(); iter1++, iter2++)
-  {
-    appliedoffset = iter2->first;
-    value = adler32_combine(value, iter2->second.adler, iter2->second.length);
-    if (iter1->first != iter2->second.offset)
+  if (!finalized) {
+    if (!intervals.Get(adler))
     {
-      needsRecalculation = true;
-      break;
+      adler = adler32(0L, Z_NULL, 0);
     }
-  }
 
-  if (appliedoffset != maxoffset)
-  {
-    // there was probably some overwrite
-    needsRecalculation = true;
-  }
-
-  if (!needsRecalculation)
-  {
-    adler = value;
-  }
-  else
-  {
-    adler = adler32(0L, Z_NULL, 0);
-  }
-
-  fflush(stdout);
-  return;
-}
-
-/*----------------------------------------------------------------------------*/
-void
-Adler::Finalize ()
-{
-  if (!finalized) {
-    ValidateAdlerMap();
+    needsRecalculation = dirty || intervals.HasHoles();
     finalized = true;
   }
 }
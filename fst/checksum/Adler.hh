@@ -26,37 +26,20 @@
 
 #include "fst/Namespace.hh"
 #include "fst/checksum/CheckSum.hh"
+#include "fst/checksum/ChecksumIntervals.hh"
 #include "XrdOuc/XrdOucEnv.hh"
 #include "XrdOuc/XrdOucString.hh"
 #include <zlib.h>
-#include <map>
 
 EOSFSTNAMESPACE_BEGIN
 
-struct ltoff_t {
-
-  bool operator()(off_t s1, off_t s2) const
-  {
-    return (s1 < s2);
-  }
-};
-
-typedef struct {
-  off_t offset;
-  size_t length;
-  unsigned int adler;
-} Chunk;
-
-typedef std::map<off_t, Chunk, ltoff_t> MapChunks;
-typedef std::map<off_t, Chunk, ltoff_t>::iterator IterMap;
-
 class Adler : public CheckSum
 {
 private:
   off_t adleroffset;
-  off_t maxoffset;
   unsigned int adler;
-  MapChunks map;
+  bool dirty; ///< Overlapping pieces or marked dirty, needs a rescan
+  ChecksumIntervals<unsigned int> intervals {&Adler::Combine};
 
 public:
   Adler() : CheckSum("adler")
@@ -64,13 +47,18 @@ public:
     Reset();
   }
 
+  static unsigned int
+  Combine(unsigned int adler1, unsigned int adler2, uint64_t len2)
+  {
+    return adler32_combine(adler1, adler2, (z_off_t) len2);
+  }
+
   unsigned int GetAdler()
   {
     return adler;
   }
 
   bool Add(const char* buffer, size_t length, off_t offset);
-  MapChunks& AddElementToMap(MapChunks& map, Chunk& chunk);
 
   off_t
   GetLastOffset()
@@ -81,7 +69,7 @@ public:
   off_t
   GetMaxOffset()
   {
-    return maxoffset;
+    return intervals.GetMaxOffset();
   }
 
   int
@@ -89,7 +77,13 @@ public:
   {
     return sizeof(unsigned int);
   }
-  void ValidateAdlerMap();
+
+  void
+  SetDirty()
+  {
+    dirty = true;
+    needsRecalculation = true;
+  }
 
   const char* GetHexChecksum();
   const char* GetBinChecksum(int& len);
@@ -99,19 +93,18 @@ public:
   void
   Reset()
   {
-    map.clear();
+    intervals.Clear();
     adleroffset = 0;
     adler = adler32(0L, Z_NULL, 0);
     needsRecalculation = false;
-    maxoffset = 0;
+    dirty = false;
     finalized = false;
   }
 
   void
   ResetInit(off_t offsetInit, size_t lengthInit, const char* checksumInitHex)
   {
-    Chunk currChunk;
-    maxoffset = 0;
+    Reset();
     adleroffset = offsetInit + lengthInit;
 
     // Theck if this is actually a valid pointer or a filled string
@@ -119,23 +112,15 @@ public:
       return;
     }
 
-    int checksumInitBin = strtol(checksumInitHex, 0, 16);
-
-    // if a file is truncated we get 0,0,<some checksum => reset to 0
+    // if a file is truncated we get 0,0,<some checksum> => nothing to add
     if (lengthInit != 0) {
-      adler = checksumInitBin;
-    } else {
-      adler = adler32(0L, Z_NULL, 0);
+      unsigned int checksumInitBin = strtoul(checksumInitHex, 0, 16);
+      intervals.Add(offsetInit, lengthInit, [&](const unsigned int*) {
+        return checksumInitBin;
+      });
     }
 
-    fprintf(stderr, "adler is %x\n", adler);
-    currChunk.offset = offsetInit;
-    currChunk.length = lengthInit;
-    currChunk.adler = adler;
-    map.clear();
-    map = AddElementToMap(map, currChunk);
-    maxoffset = (offsetInit + lengthInit);
-    needsRecalculation = false;
+    needsRecalculation = dirty || intervals.HasHoles();
   }
 
   virtual
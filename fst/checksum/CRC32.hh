@@ -27,6 +27,7 @@
 /*----------------------------------------------------------------------------*/
 #include "fst/Namespace.hh"
 #include "fst/checksum/CheckSum.hh"
+#include "fst/checksum/ChecksumIntervals.hh"
 /*----------------------------------------------------------------------------*/
 #include "XrdOuc/XrdOucEnv.hh"
 #include "XrdOuc/XrdOucString.hh"
@@ -42,6 +43,8 @@ class CRC32 : public CheckSum
 private:
   off_t crc32offset;
   unsigned int crcsum;
+  bool dirty; ///< Overlapping pieces or marked dirty, needs a rescan
+  ChecksumIntervals<unsigned int> intervals {&CRC32::Combine};
 
 public:
 
@@ -50,28 +53,58 @@ public:
     Reset();
   }
 
+  static unsigned int
+  Combine (unsigned int crc1, unsigned int crc2, uint64_t len2)
+  {
+    return crc32_combine(crc1, crc2, (z_off_t) len2);
+  }
+
   off_t
   GetLastOffset ()
   {
     return crc32offset;
   }
 
+  off_t
+  GetMaxOffset ()
+  {
+    return intervals.GetMaxOffset();
+  }
+
   bool
   Add (const char* buffer, size_t length, off_t offset)
   {
-    if (offset != crc32offset)
+    finalized = false;
+    crc32offset = offset + length;
+    bool added = intervals.Add(offset, length, [&](const unsigned int* prev) {
+      return (unsigned int) crc32((prev ? *prev : crc32(0L, Z_NULL, 0)),
+                                  (const Bytef*) buffer, length);
+    });
+
+    if (!added)
     {
-      needsRecalculation = true;
-      return false;
+      dirty = true;
     }
-    crcsum = crc32(crcsum, (const Bytef*) buffer, length);
-    crc32offset += length;
-    return true;
+
+    needsRecalculation = dirty || intervals.HasHoles();
+    return added;
+  }
+
+  void
+  SetDirty ()
+  {
+    dirty = true;
+    needsRecalculation = true;
   }
 
   const char*
   GetHexChecksum ()
   {
+    if (!finalized)
+    {
+      Finalize();
+    }
+
     char scrc32[1024];
     sprintf(scrc32, "%08x", crcsum);
     Checksum = scrc32;
@@ -81,6 +114,11 @@ public:
   const char*
   GetBinChecksum (int &len)
   {
+    if (!finalized)
+    {
+      Finalize();
+    }
+
     len = sizeof (unsigned int);
     return (char*) &crcsum;
   }
@@ -94,12 +132,29 @@ public:
   void
   Reset ()
   {
+    intervals.Clear();
     crc32offset = 0;
     crcsum = crc32(0L, Z_NULL, 0);
     needsRecalculation = 0;
+    dirty = false;
     finalized = false;
   }
 
+  void
+  Finalize ()
+  {
+    if (!finalized)
+    {
+      if (!intervals.Get(crcsum))
+      {
+        crcsum = crc32(0L, Z_NULL, 0);
+      }
+
+      needsRecalculation = dirty || intervals.HasHoles();
+      finalized = true;
+    }
+  }
+
   virtual
   ~CRC32 () { };
 
@@ -27,6 +27,7 @@
 /*----------------------------------------------------------------------------*/
 #include "fst/Namespace.hh"
 #include "fst/checksum/CheckSum.hh"
+#include "fst/checksum/ChecksumIntervals.hh"
 #include "common/crc32c/crc32c.h"
 /*----------------------------------------------------------------------------*/
 #include "XrdOuc/XrdOucEnv.hh"
@@ -49,6 +50,33 @@ private:
   off_t crc32coffset;
   uint32_t crcsum;
   bool finalized;
+  bool dirty; ///< Overlapping pieces or marked dirty, needs a rescan
+  ChecksumIntervals<uint32_t> intervals {&CRC32C::Combine};
+
+  //----------------------------------------------------------------------------
+  //! Multiply two polynomials modulo the bit reflected Castagnoli polynomial
+  //----------------------------------------------------------------------------
+  static uint32_t
+  MultModP(uint32_t a, uint32_t b)
+  {
+    uint32_t m = 1u << 31;
+    uint32_t p = 0;
+
+    while (true) {
+      if (a & m) {
+        p ^= b;
+
+        if ((a & (m - 1)) == 0) {
+          break;
+        }
+      }
+
+      m >>= 1;
+      b = (b & 1) ? ((b >> 1) ^ 0x82f63b78) : (b >> 1);
+    }
+
+    return p;
+  }
 
 public:
 
@@ -57,33 +85,70 @@ public:
     Reset();
   }
 
+  //----------------------------------------------------------------------------
+  //! CRC32C of the concatenation of two pieces: the first CRC is multiplied
+  //! by x^(8 * len2) modulo P and added to the second one. The initial value
+  //! and the final xor cancel out like for zlib's crc32_combine.
+  //----------------------------------------------------------------------------
+  static uint32_t
+  Combine(uint32_t crc1, uint32_t crc2, uint64_t len2)
+  {
+    uint32_t xn = 1u << 31; // x^0
+    uint32_t sq = 1u << 23; // x^8, squared for every bit of len2
+
+    for (; len2; len2 >>= 1) {
+      if (len2 & 1) {
+        xn = MultModP(sq, xn);
+      }
+
+      sq = MultModP(sq, sq);
+    }
+
+    return MultModP(xn, crc1) ^ crc2;
+  }
+
   off_t
   GetLastOffset()
   {
     return crc32coffset;
   }
 
+  off_t
+  GetMaxOffset()
+  {
+    return intervals.GetMaxOffset();
+  }
+
   bool
   Add(const char* buffer, size_t length, off_t offset)
   {
-    if (offset != crc32coffset) {
-      needsRecalculation = true;
-      return false;
-    }
+    // pieces are combined when finalizing, this also handles read + append
+    finalized = false;
+    crc32coffset = offset + length;
+    bool added = intervals.Add(offset, length, [&](const uint32_t* prev) {
+      // continue the region before, undoing its final xor
+      uint32_t crc = (prev ? ~*prev : checksum::crc32cInit());
+#ifdef ISAL_FOUND
+      crc = crc32_iscsi((unsigned char*) buffer, length, crc);
+#else
+      crc = checksum::crc32c(crc, (const Bytef*) buffer, length);
+#endif
+      return checksum::crc32cFinish(crc);
+    });
 
-    if (finalized) {                /* handle read + append case, a little hackish. Alternative: set needsRecalculation */
-        crcsum = ~crcsum;           /* undo what Finalize did under the hood */
-        finalized = false;
+    if (!added) {
+      dirty = true;
     }
 
-#ifdef ISAL_FOUND
-    crcsum = crc32_iscsi( (unsigned char*) buffer, length, crcsum);
-#else 
-    crcsum = checksum::crc32c(crcsum, (const Bytef*) buffer, length);
-#endif
+    needsRecalculation = dirty || intervals.HasHoles();
+    return added;
+  }
 
-    crc32coffset += length;
-    return true;
+  void
+  SetDirty()
+  {
+    dirty = true;
+    needsRecalculation = true;
   }
 
   const char*
@@ -119,9 +184,11 @@ public:
   void
   Reset()
   {
-    crcsum = checksum::crc32cInit();
+    intervals.Clear();
+    crcsum = checksum::crc32cFinish(checksum::crc32cInit());
     crc32coffset = 0;
     needsRecalculation = 0;
+    dirty = false;
     finalized = false;
   }
 
@@ -129,7 +196,11 @@ public:
   Finalize()
   {
     if (!finalized) {
-      crcsum = checksum::crc32cFinish(crcsum);
+      if (!intervals.Get(crcsum)) {
+        crcsum = checksum::crc32cFinish(checksum::crc32cInit());
+      }
+
+      needsRecalculation = dirty || intervals.HasHoles();
       finalized = true;
     }
   }
@@ -27,6 +27,7 @@
 /*----------------------------------------------------------------------------*/
 #include "fst/Namespace.hh"
 #include "fst/checksum/CheckSum.hh"
+#include "fst/checksum/ChecksumIntervals.hh"
 #include "common/crc32c/crc32c.h"
 /*----------------------------------------------------------------------------*/
 #include "XrdOuc/XrdOucEnv.hh"
@@ -34,6 +35,9 @@
 #include "XrdSys/XrdSysPthread.hh"
 /*----------------------------------------------------------------------------*/
 #include <zlib.h>
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
 /*----------------------------------------------------------------------------*/
 
 EOSFSTNAMESPACE_BEGIN
@@ -175,6 +179,8 @@ private:
   off_t crc64offset;
   uint64_t crcsum;
   bool finalized;
+  bool dirty; ///< Overlapping pieces or marked dirty, needs a rescan
+  ChecksumIntervals<uint64_t> intervals {&CRC64::Combine};
 
 public:
 
@@ -183,7 +189,7 @@ public:
     Reset();
   }
 
-  uint64_t crc64(uint64_t crc, const unsigned char *s, uint64_t l) {
+  static uint64_t crc64_table(uint64_t crc, const unsigned char *s, uint64_t l) {
     while (l) {
       int i = ((int) (crc >> 56) ^ *s++) & 0xFF;
       crc = crc64_tab[i] ^ (crc << 8);
@@ -192,7 +198,193 @@ public:
     return crc;
   }
 
+#if defined(__x86_64__)
+  //----------------------------------------------------------------------------
+  //! Constants for the carry-less multiplication folding - x^n mod P for the
+  //! fold distances and floor(x^128 / P) for the final Barrett reduction
+  //----------------------------------------------------------------------------
+  struct ClmulConstants {
+    uint64_t fold512[2]; ///< x^576, x^512 mod P
+    uint64_t fold384[2]; ///< x^448, x^384 mod P
+    uint64_t fold256[2]; ///< x^320, x^256 mod P
+    uint64_t fold128[2]; ///< x^192, x^128 mod P
+    uint64_t mu; ///< floor(x^128 / P) without the x^64 term
+    uint64_t poly; ///< P without the x^64 term
+
+    ClmulConstants()
+    {
+      const uint64_t p = crc64_tab[1];
+      poly = p;
+      fold512[0] = xpow_mod(576, p);
+      fold512[1] = xpow_mod(512, p);
+      fold384[0] = xpow_mod(448, p);
+      fold384[1] = xpow_mod(384, p);
+      fold256[0] = xpow_mod(320, p);
+      fold256[1] = xpow_mod(256, p);
+      fold128[0] = xpow_mod(192, p);
+      fold128[1] = xpow_mod(128, p);
+      mu = barrett_mu(p);
+    }
+
+    static uint64_t xpow_mod(unsigned int n, uint64_t p)
+    {
+      // x^64 mod P is p, multiply by x one step at a time
+      uint64_t r = p;
+
+      for (unsigned int i = 64; i < n; ++i) {
+        r = (r << 1) ^ ((r >> 63) ? p : 0);
+      }
+
+      return r;
+    }
+
+    static uint64_t barrett_mu(uint64_t p)
+    {
+      // Quotient bits of x^128 / P from x^63 down to x^0, the x^64 bit is 1
+      uint64_t q = 0;
+      // Remainder after the x^64 term of the quotient, bit j stands for the
+      // coefficient of x^(64 + j) and the window moves down one degree per step
+      uint64_t rem = p;
+
+      for (int i = 63; i >= 0; --i) {
+        if (rem >> 63) {
+          q |= (1ull << i);
+          rem = (rem << 1) ^ p;
+        } else {
+          rem <<= 1;
+        }
+      }
+
+      return q;
+    }
+  };
+
+  //----------------------------------------------------------------------------
+  //! Load 16 bytes as a polynomial with the first byte as highest degree
+  //----------------------------------------------------------------------------
+  __attribute__((target("pclmul,sse4.1")))
+  static inline __m128i load_be(const unsigned char* s)
+  {
+    const __m128i swap = _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8,
+                                       7, 6, 5, 4, 3, 2, 1, 0);
+    return _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) s), swap);
+  }
+
+  //----------------------------------------------------------------------------
+  //! Multiply a 128 bit polynomial x by x^n modulo P, the constants k hold
+  //! x^(n + 64) mod P and x^n mod P
+  //----------------------------------------------------------------------------
+  __attribute__((target("pclmul,sse4.1")))
+  static inline __m128i fold(__m128i x, const uint64_t* k)
+  {
+    const __m128i kk = _mm_set_epi64x(k[0], k[1]);
+    return _mm_xor_si128(_mm_clmulepi64_si128(x, kk, 0x11),
+                         _mm_clmulepi64_si128(x, kk, 0x00));
+  }
+
+  //----------------------------------------------------------------------------
+  //! Compute the CRC using carry-less multiplication, folding 64 bytes per
+  //! iteration over four independent lanes
+  //----------------------------------------------------------------------------
+  __attribute__((target("pclmul,sse4.1")))
+  static uint64_t crc64_clmul(uint64_t crc, const unsigned char* s, uint64_t l)
+  {
+    static const ClmulConstants k;
+    // Continuing a previous CRC is the same as adding it to the first 64 bits
+    __m128i x0 = _mm_xor_si128(load_be(s), _mm_set_epi64x(crc, 0));
+    __m128i x1 = load_be(s + 16);
+    __m128i x2 = load_be(s + 32);
+    __m128i x3 = load_be(s + 48);
+    s += 64;
+    l -= 64;
+
+    while (l >= 64) {
+      x0 = _mm_xor_si128(fold(x0, k.fold512), load_be(s));
+      x1 = _mm_xor_si128(fold(x1, k.fold512), load_be(s + 16));
+      x2 = _mm_xor_si128(fold(x2, k.fold512), load_be(s + 32));
+      x3 = _mm_xor_si128(fold(x3, k.fold512), load_be(s + 48));
+      s += 64;
+      l -= 64;
+    }
+
+    __m128i x = _mm_xor_si128(_mm_xor_si128(fold(x0, k.fold384),
+                                            fold(x1, k.fold256)),
+                              _mm_xor_si128(fold(x2, k.fold128), x3));
+
+    while (l >= 16) {
+      x = _mm_xor_si128(fold(x, k.fold128), load_be(s));
+      s += 16;
+      l -= 16;
+    }
+
+    // CRC of the accumulated polynomial is x * x^64 mod P: fold the high
+    // half and add the low half shifted by 64, then Barrett reduce
+    const __m128i kk = _mm_set_epi64x(k.fold128[1], k.fold128[1]);
+    __m128i t = _mm_xor_si128(_mm_clmulepi64_si128(x, kk, 0x01),
+                              _mm_slli_si128(x, 8));
+    const __m128i mp = _mm_set_epi64x(k.poly, k.mu);
+    uint64_t t_hi = _mm_extract_epi64(t, 1);
+    __m128i q = _mm_clmulepi64_si128(_mm_srli_si128(t, 8), mp, 0x00);
+    q = _mm_set_epi64x(0, t_hi ^ (uint64_t) _mm_extract_epi64(q, 1));
+    __m128i r = _mm_clmulepi64_si128(q, mp, 0x10);
+    crc = (uint64_t) _mm_cvtsi128_si64(t) ^ (uint64_t) _mm_cvtsi128_si64(r);
+    return crc64_table(crc, s, l);
+  }
+#endif
+
+  //----------------------------------------------------------------------------
+  //! Compute the CRC using the fastest implementation available on the CPU
+  //----------------------------------------------------------------------------
+  static uint64_t crc64(uint64_t crc, const unsigned char *s, uint64_t l) {
+#if defined(__x86_64__)
+    static const bool has_clmul = __builtin_cpu_supports("pclmul") &&
+                                  __builtin_cpu_supports("sse4.1");
+
+    if (has_clmul && (l >= 64)) {
+      return crc64_clmul(crc, s, l);
+    }
+#endif
+    return crc64_table(crc, s, l);
+  }
+
+  //----------------------------------------------------------------------------
+  //! Multiply two polynomials modulo P, the highest bit is the x^63 term
+  //----------------------------------------------------------------------------
+  static uint64_t MultModP(uint64_t a, uint64_t b)
+  {
+    uint64_t p = 0;
+
+    for (int i = 63; i >= 0; --i) {
+      p = (p << 1) ^ ((p >> 63) ? crc64_tab[1] : 0);
+
+      if ((a >> i) & 1) {
+        p ^= b;
+      }
+    }
+
+    return p;
+  }
+
+  //----------------------------------------------------------------------------
+  //! CRC64 of the concatenation of two pieces: without initial value and
+  //! final xor it is the first CRC multiplied by x^(8 * len2) modulo P plus
+  //! the second one
+  //----------------------------------------------------------------------------
+  static uint64_t Combine(uint64_t crc1, uint64_t crc2, uint64_t len2)
+  {
+    uint64_t xn = 1; // x^0
+    uint64_t sq = 1ull << 8; // x^8, squared for every bit of len2
+
+    for (; len2; len2 >>= 1) {
+      if (len2 & 1) {
+        xn = MultModP(sq, xn);
+      }
 
+      sq = MultModP(sq, sq);
+    }
+
+    return MultModP(xn, crc1) ^ crc2;
+  }
 
   off_t
   GetLastOffset()
@@ -200,17 +392,34 @@ public:
     return crc64offset;
   }
 
+  off_t
+  GetMaxOffset()
+  {
+    return intervals.GetMaxOffset();
+  }
+
   bool
   Add(const char* buffer, size_t length, off_t offset)
   {
-    if (offset != crc64offset) {
-      needsRecalculation = true;
-      return false;
+    finalized = false;
+    crc64offset = offset + length;
+    bool added = intervals.Add(offset, length, [&](const uint64_t* prev) {
+      return crc64((prev ? *prev : 0), (unsigned char*) buffer, length);
+    });
+
+    if (!added) {
+      dirty = true;
     }
 
-    crcsum = crc64( crcsum, (unsigned char*) buffer, length);
-    crc64offset += length;
-    return true;
+    needsRecalculation = dirty || intervals.HasHoles();
+    return added;
+  }
+
+  void
+  SetDirty()
+  {
+    dirty = true;
+    needsRecalculation = true;
   }
 
   const char*
@@ -246,9 +455,11 @@ public:
   void
   Reset()
   {
+    intervals.Clear();
     crcsum = 0;
     crc64offset = 0;
     needsRecalculation = 0;
+    dirty = false;
     finalized = false;
   }
 
@@ -256,6 +467,11 @@ public:
   Finalize()
   {
     if (!finalized) {
+      if (!intervals.Get(crcsum)) {
+        crcsum = 0;
+      }
+
+      needsRecalculation = dirty || intervals.HasHoles();
       finalized = true;
     }
   }
@@ -0,0 +1,206 @@
+//------------------------------------------------------------------------------
+//! @file ChecksumIntervals.hh
+//! @brief Checksums of the disjoint file pieces seen so far, merged as soon
+//!        as they become contiguous
+//------------------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2023 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+#pragma once
+#include "fst/Namespace.hh"
+#include <sys/types.h>
+#include <cstdint>
+#include <iterator>
+#include <map>
+
+EOSFSTNAMESPACE_BEGIN
+
+//------------------------------------------------------------------------------
+//! Class ChecksumIntervals - keeps the checksum of every maximal contiguous
+//! region of a file added so far. A piece continuing a region extends its
+//! checksum directly, a piece closing the hole in front of the next region is
+//! joined with it using the combine function of the algorithm e.g.
+//! adler32_combine or the CRC combine. Sequential I/O therefore keeps a single
+//! region and the map only grows with the number of holes.
+//!
+//! Overlapping pieces can not be combined, they are rejected and the caller
+//! has to fall back to rescanning the file.
+//------------------------------------------------------------------------------
+template <typename T>
+class ChecksumIntervals
+{
+public:
+  //! Checksum of the concatenation of two regions given the checksum of
+  //! both of them and the length of the second one
+  using CombineT = T(*)(T, T, uint64_t);
+
+  //----------------------------------------------------------------------------
+  //! Constructor
+  //!
+  //! @param combine function combining the checksums of adjacent regions
+  //----------------------------------------------------------------------------
+  explicit ChecksumIntervals(CombineT combine):
+    mCombine(combine)
+  {}
+
+  //----------------------------------------------------------------------------
+  //! Add a piece of the file
+  //!
+  //! @param offset offset of the piece
+  //! @param length length of the piece
+  //! @param compute function returning the checksum of the piece when given
+  //!        a nullptr or the checksum of the region continued by the piece
+  //!        when given the checksum of the region ending at offset
+  //!
+  //! @return true if added, false if the piece overlaps a region
+  //----------------------------------------------------------------------------
+  template <typename ComputeT>
+  bool Add(off_t offset, uint64_t length, ComputeT&& compute)
+  {
+    if (length == 0) {
+      return true;
+    }
+
+    const off_t end = offset + length;
+    auto next = mRegions.lower_bound(offset);
+
+    if ((next != mRegions.end()) && (next->first < end)) {
+      return false;
+    }
+
+    auto cur = mRegions.end();
+
+    if (next != mRegions.begin()) {
+      auto prev = std::prev(next);
+
+      if (prev->second.mEnd > offset) {
+        return false;
+      }
+
+      if (prev->second.mEnd == offset) {
+        prev->second.mValue = compute(&prev->second.mValue);
+        prev->second.mEnd = end;
+        cur = prev;
+      }
+    }
+
+    if (cur == mRegions.end()) {
+      if (mSpare.empty()) {
+        cur = mRegions.emplace_hint(next, offset, Region{end, compute(nullptr)});
+      } else {
+        mSpare.key() = offset;
+        mSpare.mapped() = Region{end, compute(nullptr)};
+        cur = mRegions.insert(next, std::move(mSpare));
+      }
+    }
+
+    if ((next != mRegions.end()) && (next->first == end)) {
+      cur->second.mValue = mCombine(cur->second.mValue, next->second.mValue,
+                                    next->second.mEnd - next->first);
+      cur->second.mEnd = next->second.mEnd;
+      Drop(next);
+    }
+
+    return true;
+  }
+
+  //----------------------------------------------------------------------------
+  //! Get the checksum of the file if a single region covers it from the
+  //! beginning up to the max offset
+  //!
+  //! @param value checksum of the file
+  //!
+  //! @return true if the file is covered, false if there are holes
+  //----------------------------------------------------------------------------
+  bool Get(T& value) const
+  {
+    if ((mRegions.size() != 1) || (mRegions.begin()->first != 0)) {
+      return false;
+    }
+
+    value = mRegions.begin()->second.mValue;
+    return true;
+  }
+
+  //----------------------------------------------------------------------------
+  //! Check if the file is not covered from the beginning up to the max offset
+  //----------------------------------------------------------------------------
+  bool HasHoles() const
+  {
+    return ((mRegions.size() > 1) ||
+            (!mRegions.empty() && (mRegions.begin()->first != 0)));
+  }
+
+  //----------------------------------------------------------------------------
+  //! Get the end of the last region
+  //----------------------------------------------------------------------------
+  off_t GetMaxOffset() const
+  {
+    return (mRegions.empty() ? 0 : mRegions.rbegin()->second.mEnd);
+  }
+
+  //----------------------------------------------------------------------------
+  //! Get the number of disjoint regions
+  //----------------------------------------------------------------------------
+  size_t Size() const
+  {
+    return mRegions.size();
+  }
+
+  //----------------------------------------------------------------------------
+  //! Drop all regions
+  //----------------------------------------------------------------------------
+  void Clear()
+  {
+    if (!mRegions.empty()) {
+      Drop(mRegions.begin());
+    }
+
+    mRegions.clear();
+  }
+
+private:
+  //! Contiguous region of the file, keyed by its start offset
+  struct Region {
+    off_t mEnd;
+    T mValue;
+  };
+
+  using MapT = std::map<off_t, Region>;
+
+  //----------------------------------------------------------------------------
+  //! Remove a region, keeping its node for the next insertion. The block
+  //! checksums do a Reset and a single Add per block, so this avoids an
+  //! allocation per block.
+  //----------------------------------------------------------------------------
+  void Drop(typename MapT::iterator it)
+  {
+    if (mSpare.empty()) {
+      mSpare = mRegions.extract(it);
+    } else {
+      mRegions.erase(it);
+    }
+  }
+
+  CombineT mCombine;
+  MapT mRegions;
+  typename MapT::node_type mSpare; ///< Recycled node
+};
+
+EOSFSTNAMESPACE_END
@@ -0,0 +1,533 @@
+//------------------------------------------------------------------------------
+//! @file ParityEngine.cc
+//! @brief Vectorised XOR and GF(2^8) kernels used by the RAIN layouts
+//------------------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2023 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+#include "fst/layout/ParityEngine.hh"
+#include "fst/layout/jerasure/include/jerasure.h"
+#include <atomic>
+#include <cstring>
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+EOSFSTNAMESPACE_BEGIN
+
+namespace
+{
+typedef void (*XorFunc)(char*, const char* const*, size_t, size_t, size_t);
+typedef void (*GfMulAddFunc)(const uint8_t*, const uint8_t*, const char*,
+                             char*, size_t);
+
+//------------------------------------------------------------------------------
+// Portable XOR of nsrc blocks using 64-bit words, the bytes from off up to
+// len are computed
+//------------------------------------------------------------------------------
+void
+XorScalar(char* dst, const char* const* srcs, size_t nsrc, size_t off,
+           size_t len)
+{
+  size_t i = off;
+
+  for (; i + sizeof(uint64_t) <= len; i += sizeof(uint64_t)) {
+    uint64_t acc, val;
+    memcpy(&acc, srcs[0] + i, sizeof(acc));
+
+    for (size_t s = 1; s < nsrc; ++s) {
+      memcpy(&val, srcs[s] + i, sizeof(val));
+      acc ^= val;
+    }
+
+    memcpy(dst + i, &acc, sizeof(acc));
+  }
+
+  for (; i < len; ++i) {
+    char acc = srcs[0][i];
+
+    for (size_t s = 1; s < nsrc; ++s) {
+      acc ^= srcs[s][i];
+    }
+
+    dst[i] = acc;
+  }
+}
+
+//------------------------------------------------------------------------------
+// Portable GF(2^8) multiply-accumulate using the nibble tables - the tables
+// hold 16 entries replicated for every 128-bit lane of the vector kernels
+//------------------------------------------------------------------------------
+void
+GfMulAddScalar(const uint8_t* lo, const uint8_t* hi, const char* src,
+               char* dst, size_t len)
+{
+  const uint8_t* in = (const uint8_t*) src;
+  uint8_t* out = (uint8_t*) dst;
+
+  for (size_t i = 0; i < len; ++i) {
+    out[i] ^= lo[in[i] & 0x0f] ^ hi[in[i] >> 4];
+  }
+}
+
+#if defined(__x86_64__)
+//------------------------------------------------------------------------------
+// AVX2 XOR of nsrc blocks - 128 bytes per iteration kept in registers
+//------------------------------------------------------------------------------
+__attribute__((target("avx2"))) void
+XorAvx2(char* dst, const char* const* srcs, size_t nsrc, size_t off,
+         size_t len)
+{
+  size_t i = off;
+
+  for (; i + 128 <= len; i += 128) {
+    const char* p = srcs[0] + i;
+    __m256i a0 = _mm256_loadu_si256((const __m256i*)(p));
+    __m256i a1 = _mm256_loadu_si256((const __m256i*)(p + 32));
+    __m256i a2 = _mm256_loadu_si256((const __m256i*)(p + 64));
+    __m256i a3 = _mm256_loadu_si256((const __m256i*)(p + 96));
+
+    for (size_t s = 1; s < nsrc; ++s) {
+      p = srcs[s] + i;
+      a0 = _mm256_xor_si256(a0, _mm256_loadu_si256((const __m256i*)(p)));
+      a1 = _mm256_xor_si256(a1, _mm256_loadu_si256((const __m256i*)(p + 32)));
+      a2 = _mm256_xor_si256(a2, _mm256_loadu_si256((const __m256i*)(p + 64)));
+      a3 = _mm256_xor_si256(a3, _mm256_loadu_si256((const __m256i*)(p + 96)));
+    }
+
+    _mm256_storeu_si256((__m256i*)(dst + i), a0);
+    _mm256_storeu_si256((__m256i*)(dst + i + 32), a1);
+    _mm256_storeu_si256((__m256i*)(dst + i + 64), a2);
+    _mm256_storeu_si256((__m256i*)(dst + i + 96), a3);
+  }
+
+  for (; i + 32 <= len; i += 32) {
+    __m256i a0 = _mm256_loadu_si256((const __m256i*)(srcs[0] + i));
+
+    for (size_t s = 1; s < nsrc; ++s) {
+      a0 = _mm256_xor_si256(a0, _mm256_loadu_si256((const __m256i*)(srcs[s] + i)));
+    }
+
+    _mm256_storeu_si256((__m256i*)(dst + i), a0);
+  }
+
+  if (i < len) {
+    XorScalar(dst, srcs, nsrc, i, len);
+  }
+}
+
+//------------------------------------------------------------------------------
+// AVX-512 XOR of nsrc blocks - 256 bytes per iteration kept in registers
+//------------------------------------------------------------------------------
+__attribute__((target("avx512f"))) void
+XorAvx512(char* dst, const char* const* srcs, size_t nsrc, size_t off,
+           size_t len)
+{
+  size_t i = off;
+
+  for (; i + 256 <= len; i += 256) {
+    const char* p = srcs[0] + i;
+    __m512i a0 = _mm512_loadu_si512((const void*)(p));
+    __m512i a1 = _mm512_loadu_si512((const void*)(p + 64));
+    __m512i a2 = _mm512_loadu_si512((const void*)(p + 128));
+    __m512i a3 = _mm512_loadu_si512((const void*)(p + 192));
+
+    for (size_t s = 1; s < nsrc; ++s) {
+      p = srcs[s] + i;
+      a0 = _mm512_xor_si512(a0, _mm512_loadu_si512((const void*)(p)));
+      a1 = _mm512_xor_si512(a1, _mm512_loadu_si512((const void*)(p + 64)));
+      a2 = _mm512_xor_si512(a2, _mm512_loadu_si512((const void*)(p + 128)));
+      a3 = _mm512_xor_si512(a3, _mm512_loadu_si512((const void*)(p + 192)));
+    }
+
+    _mm512_storeu_si512((void*)(dst + i), a0);
+    _mm512_storeu_si512((void*)(dst + i + 64), a1);
+    _mm512_storeu_si512((void*)(dst + i + 128), a2);
+    _mm512_storeu_si512((void*)(dst + i + 192), a3);
+  }
+
+  if (i < len) {
+    XorAvx2(dst, srcs, nsrc, i, len);
+  }
+}
+
+//------------------------------------------------------------------------------
+// AVX2 GF(2^8) multiply-accumulate - the two 16 entry nibble tables are
+// looked up with one byte shuffle each
+//------------------------------------------------------------------------------
+__attribute__((target("avx2"))) void
+GfMulAddAvx2(const uint8_t* lo, const uint8_t* hi, const char* src,
+             char* dst, size_t len)
+{
+  const __m256i tlo = _mm256_loadu_si256((const __m256i*) lo);
+  const __m256i thi = _mm256_loadu_si256((const __m256i*) hi);
+  const __m256i mask = _mm256_set1_epi8(0x0f);
+  size_t i = 0;
+
+  for (; i + 32 <= len; i += 32) {
+    __m256i in = _mm256_loadu_si256((const __m256i*)(src + i));
+    __m256i out = _mm256_loadu_si256((const __m256i*)(dst + i));
+    __m256i l = _mm256_shuffle_epi8(tlo, _mm256_and_si256(in, mask));
+    __m256i h = _mm256_shuffle_epi8(thi, _mm256_and_si256(
+                                      _mm256_srli_epi16(in, 4), mask));
+    out = _mm256_xor_si256(out, _mm256_xor_si256(l, h));
+    _mm256_storeu_si256((__m256i*)(dst + i), out);
+  }
+
+  GfMulAddScalar(lo, hi, src + i, dst + i, len - i);
+}
+
+//------------------------------------------------------------------------------
+// AVX-512 GF(2^8) multiply-accumulate
+//------------------------------------------------------------------------------
+__attribute__((target("avx512f,avx512bw"))) void
+GfMulAddAvx512(const uint8_t* lo, const uint8_t* hi, const char* src,
+               char* dst, size_t len)
+{
+  const __m512i tlo = _mm512_loadu_si512((const void*) lo);
+  const __m512i thi = _mm512_loadu_si512((const void*) hi);
+  const __m512i mask = _mm512_set1_epi8(0x0f);
+  size_t i = 0;
+
+  for (; i + 64 <= len; i += 64) {
+    __m512i in = _mm512_loadu_si512((const void*)(src + i));
+    __m512i out = _mm512_loadu_si512((const void*)(dst + i));
+    __m512i l = _mm512_shuffle_epi8(tlo, _mm512_and_si512(in, mask));
+    __m512i h = _mm512_shuffle_epi8(thi, _mm512_and_si512(
+                                      _mm512_srli_epi16(in, 4), mask));
+    out = _mm512_xor_si512(out, _mm512_xor_si512(l, h));
+    _mm512_storeu_si512((void*)(dst + i), out);
+  }
+
+  GfMulAddAvx2(lo, hi, src + i, dst + i, len - i);
+}
+#endif
+
+//------------------------------------------------------------------------------
+// Best instruction set supported by the CPU
+//------------------------------------------------------------------------------
+ParityEngine::Isa
+DetectIsa()
+{
+#if defined(__x86_64__)
+  __builtin_cpu_init();
+
+  if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) {
+    return ParityEngine::Isa::Avx512;
+  }
+
+  if (__builtin_cpu_supports("avx2")) {
+    return ParityEngine::Isa::Avx2;
+  }
+
+#endif
+  return ParityEngine::Isa::Scalar;
+}
+
+//------------------------------------------------------------------------------
+// Currently selected instruction set
+//------------------------------------------------------------------------------
+std::atomic<ParityEngine::Isa>&
+CurrentIsa()
+{
+  static std::atomic<ParityEngine::Isa> sIsa {DetectIsa()};
+  return sIsa;
+}
+}
+
+//------------------------------------------------------------------------------
+// Get instruction set selected for the current CPU
+//------------------------------------------------------------------------------
+ParityEngine::Isa
+ParityEngine::GetIsa()
+{
+  return CurrentIsa().load(std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+// Get printable name of the instruction set
+//------------------------------------------------------------------------------
+const char*
+ParityEngine::GetIsaName()
+{
+  switch (GetIsa()) {
+  case Isa::Avx512:
+    return "avx512";
+
+  case Isa::Avx2:
+    return "avx2";
+
+  default:
+    return "scalar";
+  }
+}
+
+//------------------------------------------------------------------------------
+// Force the use of a given instruction set
+//------------------------------------------------------------------------------
+void
+ParityEngine::SetIsa(Isa isa)
+{
+  Isa best = DetectIsa();
+
+  if ((int) isa > (int) best) {
+    isa = best;
+  }
+
+  CurrentIsa().store(isa);
+}
+
+//------------------------------------------------------------------------------
+// XOR any number of source blocks in a single pass
+//------------------------------------------------------------------------------
+void
+ParityEngine::Xor(char* dst, const char* const* srcs, size_t nsrc, size_t len)
+{
+  if (nsrc == 0) {
+    memset(dst, 0, len);
+    return;
+  }
+
+  XorFunc func = XorScalar;
+#if defined(__x86_64__)
+
+  switch (GetIsa()) {
+  case Isa::Avx512:
+    func = XorAvx512;
+    break;
+
+  case Isa::Avx2:
+    func = XorAvx2;
+    break;
+
+  default:
+    break;
+  }
+
+#endif
+  func(dst, srcs, nsrc, 0, len);
+}
+
+//------------------------------------------------------------------------------
+// Multiply two elements of GF(2^8)
+//------------------------------------------------------------------------------
+uint8_t
+ParityEngine::GfMul(uint8_t a, uint8_t b)
+{
+  uint8_t res = 0;
+
+  while (b) {
+    if (b & 0x01) {
+      res ^= a;
+    }
+
+    a = (a & 0x80) ? ((a << 1) ^ 0x1d) : (a << 1);
+    b >>= 1;
+  }
+
+  return res;
+}
+
+//------------------------------------------------------------------------------
+// GF(2^8) multiply-accumulate
+//------------------------------------------------------------------------------
+void
+ParityEngine::GfMulAdd(uint8_t coeff, const char* src, char* dst, size_t len)
+{
+  if (coeff == 0) {
+    return;
+  }
+
+  if (coeff == 1) {
+    const char* srcs[2] = {dst, src};
+    Xor(dst, srcs, 2, len);
+    return;
+  }
+
+  // products of the coefficient with the low and the high nibble
+  alignas(64) uint8_t lo[64];
+  alignas(64) uint8_t hi[64];
+
+  for (uint8_t n = 0; n < 64; ++n) {
+    lo[n] = GfMul(coeff, n & 0x0f);
+    hi[n] = GfMul(coeff, (n & 0x0f) << 4);
+  }
+
+  GfMulAddFunc func = GfMulAddScalar;
+#if defined(__x86_64__)
+
+  switch (GetIsa()) {
+  case Isa::Avx512:
+    func = GfMulAddAvx512;
+    break;
+
+  case Isa::Avx2:
+    func = GfMulAddAvx2;
+    break;
+
+  default:
+    break;
+  }
+
+#endif
+  func(lo, hi, src, dst, len);
+}
+
+//------------------------------------------------------------------------------
+// BitmatrixCode constructor
+//------------------------------------------------------------------------------
+BitmatrixCode::BitmatrixCode(unsigned int k, unsigned int m, unsigned int w,
+                             const int* bitmatrix):
+  mK(k), mM(m), mW(w), mBitmatrix(bitmatrix, bitmatrix + k * m * w * w)
+{
+  std::vector<unsigned int> dev_ids;
+
+  for (unsigned int i = 0; i < mK; ++i) {
+    dev_ids.push_back(i);
+  }
+
+  for (unsigned int i = 0; i < mM; ++i) {
+    BuildRows(mBitmatrix.data() + i * mK * mW * mW, dev_ids, mEncRows);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Translate w consecutive rows of a bitmatrix into source lists
+//------------------------------------------------------------------------------
+void
+BitmatrixCode::BuildRows(const int* row,
+                         const std::vector<unsigned int>& dev_ids,
+                         RowList& rows) const
+{
+  const size_t row_len = mK * mW;
+
+  for (unsigned int r = 0; r < mW; ++r) {
+    std::vector<Source> srcs;
+
+    for (unsigned int x = 0; x < dev_ids.size(); ++x) {
+      for (unsigned int c = 0; c < mW; ++c) {
+        if (row[r * row_len + x * mW + c]) {
+          srcs.push_back({dev_ids[x], c});
+        }
+      }
+    }
+
+    rows.push_back(std::move(srcs));
+  }
+}
+
+//------------------------------------------------------------------------------
+// Produce the w packets of one output device for every packet group
+//------------------------------------------------------------------------------
+void
+BitmatrixCode::Run(const RowList& rows, size_t first, unsigned int out,
+                   char* const* ptrs, size_t size, size_t packet_sz) const
+{
+  std::vector<const char*> srcs;
+
+  for (size_t off = 0; off < size; off += mW * packet_sz) {
+    for (unsigned int r = 0; r < mW; ++r) {
+      const std::vector<Source>& row = rows[first + r];
+      srcs.clear();
+
+      for (const auto& src : row) {
+        srcs.push_back(ptrs[src.mDev] + off + src.mPacket * packet_sz);
+      }
+
+      ParityEngine::Xor(ptrs[out] + off + r * packet_sz, srcs.data(), srcs.size(),
+                        packet_sz);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// Compute the coding blocks
+//------------------------------------------------------------------------------
+void
+BitmatrixCode::Encode(char** data, char** coding, size_t size,
+                      size_t packet_sz) const
+{
+  std::vector<char*> ptrs(data, data + mK);
+  ptrs.insert(ptrs.end(), coding, coding + mM);
+
+  for (unsigned int i = 0; i < mM; ++i) {
+    Run(mEncRows, i * mW, mK + i, ptrs.data(), size, packet_sz);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Rebuild the erased data and coding blocks
+//------------------------------------------------------------------------------
+bool
+BitmatrixCode::Decode(const std::set<unsigned int>& erasures, char** data,
+                      char** coding, size_t size, size_t packet_sz) const
+{
+  if (erasures.size() > mM) {
+    return false;
+  }
+
+  std::vector<int> erased(mK + mM, 0);
+  bool data_erased = false;
+
+  for (auto id : erasures) {
+    if (id >= mK + mM) {
+      return false;
+    }
+
+    erased[id] = 1;
+    data_erased |= (id < mK);
+  }
+
+  std::vector<char*> ptrs(data, data + mK);
+  ptrs.insert(ptrs.end(), coding, coding + mM);
+
+  if (data_erased) {
+    // Invert the bitmatrix of k surviving devices and rebuild the data
+    std::vector<int> decoding(mK * mK * mW * mW);
+    std::vector<int> dm_ids(mK);
+
+    if (jerasure_make_decoding_bitmatrix(mK, mM, mW,
+                                         const_cast<int*>(mBitmatrix.data()),
+                                         erased.data(), decoding.data(),
+                                         dm_ids.data()) < 0) {
+      return false;
+    }
+
+    std::vector<unsigned int> src_ids(dm_ids.begin(), dm_ids.end());
+
+    for (unsigned int i = 0; i < mK; ++i) {
+      if (erased[i]) {
+        RowList rows;
+        BuildRows(decoding.data() + i * mK * mW * mW, src_ids, rows);
+        Run(rows, 0, i, ptrs.data(), size, packet_sz);
+      }
+    }
+  }
+
+  // The data is complete, re-encode the erased coding devices
+  for (unsigned int i = 0; i < mM; ++i) {
+    if (erased[mK + i]) {
+      Run(mEncRows, i * mW, mK + i, ptrs.data(), size, packet_sz);
+    }
+  }
+
+  return true;
+}
+
+EOSFSTNAMESPACE_END
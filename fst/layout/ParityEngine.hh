@@ -0,0 +1,184 @@
+//------------------------------------------------------------------------------
+//! @file ParityEngine.hh
+//! @brief Vectorised XOR and GF(2^8) kernels used by the RAIN layouts
+//------------------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2023 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+#pragma once
+#include "fst/Namespace.hh"
+#include <cstddef>
+#include <cstdint>
+#include <set>
+#include <vector>
+
+EOSFSTNAMESPACE_BEGIN
+
+//------------------------------------------------------------------------------
+//! Class ParityEngine - stateless parity kernels with runtime dispatch to the
+//! best instruction set available on the current CPU (AVX-512, AVX2 or
+//! portable 64-bit code).
+//------------------------------------------------------------------------------
+class ParityEngine
+{
+public:
+  //----------------------------------------------------------------------------
+  //! Instruction set used by the kernels
+  //----------------------------------------------------------------------------
+  enum class Isa {
+    Scalar, Avx2, Avx512
+  };
+
+  //----------------------------------------------------------------------------
+  //! Get instruction set selected for the current CPU
+  //----------------------------------------------------------------------------
+  static Isa GetIsa();
+
+  //----------------------------------------------------------------------------
+  //! Get printable name of the instruction set selected for the current CPU
+  //----------------------------------------------------------------------------
+  static const char* GetIsaName();
+
+  //----------------------------------------------------------------------------
+  //! Force the use of a given instruction set, only meant for testing and
+  //! benchmarking. Requests for instructions not supported by the CPU are
+  //! downgraded to the best supported one.
+  //!
+  //! @param isa instruction set
+  //----------------------------------------------------------------------------
+  static void SetIsa(Isa isa);
+
+  //----------------------------------------------------------------------------
+  //! XOR any number of source blocks in a single pass i.e.
+  //! dst = srcs[0] ^ srcs[1] ^ ... ^ srcs[nsrc - 1]. The destination can be
+  //! identical to any of the sources but must not partially overlap them.
+  //! With no sources the destination is zero-filled.
+  //!
+  //! @param dst destination buffer
+  //! @param srcs array of source buffers
+  //! @param nsrc number of source buffers
+  //! @param len length of the buffers
+  //----------------------------------------------------------------------------
+  static void Xor(char* dst, const char* const* srcs, size_t nsrc, size_t len);
+
+  //----------------------------------------------------------------------------
+  //! GF(2^8) multiply-accumulate: dst ^= coeff * src using the polynomial
+  //! 0x11d (identical to the Jerasure/gf-complete w=8 field)
+  //!
+  //! @param coeff constant factor
+  //! @param src source buffer
+  //! @param dst destination buffer
+  //! @param len length of the buffers
+  //----------------------------------------------------------------------------
+  static void GfMulAdd(uint8_t coeff, const char* src, char* dst, size_t len);
+
+  //----------------------------------------------------------------------------
+  //! Multiply two elements of GF(2^8)
+  //----------------------------------------------------------------------------
+  static uint8_t GfMul(uint8_t a, uint8_t b);
+};
+
+//------------------------------------------------------------------------------
+//! Class BitmatrixCode - executes a Jerasure Cauchy bitmatrix code with the
+//! multi-source XOR kernel. Each coding packet is the XOR of the data packets
+//! selected by one row of the bitmatrix, so every output packet is produced
+//! in one pass over its sources instead of one read-modify-write per term of
+//! a Jerasure schedule. The on-disk result is identical to
+//! jerasure_schedule_encode/jerasure_schedule_decode_lazy.
+//------------------------------------------------------------------------------
+class BitmatrixCode
+{
+public:
+  //----------------------------------------------------------------------------
+  //! Constructor
+  //!
+  //! @param k number of data devices
+  //! @param m number of coding devices
+  //! @param w word size
+  //! @param bitmatrix (m * w) x (k * w) encoding bitmatrix
+  //----------------------------------------------------------------------------
+  BitmatrixCode(unsigned int k, unsigned int m, unsigned int w,
+                const int* bitmatrix);
+
+  //----------------------------------------------------------------------------
+  //! Compute the coding blocks
+  //!
+  //! @param data array of k data blocks
+  //! @param coding array of m coding blocks
+  //! @param size size of each block, multiple of w * packet_sz
+  //! @param packet_sz packet size
+  //----------------------------------------------------------------------------
+  void Encode(char** data, char** coding, size_t size, size_t packet_sz) const;
+
+  //----------------------------------------------------------------------------
+  //! Rebuild the erased data and coding blocks
+  //!
+  //! @param erasures set of erased block indices, coding blocks are indexed
+  //!        starting from k
+  //! @param data array of k data blocks
+  //! @param coding array of m coding blocks
+  //! @param size size of each block, multiple of w * packet_sz
+  //! @param packet_sz packet size
+  //!
+  //! @return true if successful, otherwise false
+  //----------------------------------------------------------------------------
+  bool Decode(const std::set<unsigned int>& erasures, char** data,
+              char** coding, size_t size, size_t packet_sz) const;
+
+private:
+  //! Source packet of an output packet - device index and packet index
+  struct Source {
+    unsigned int mDev;
+    unsigned int mPacket;
+  };
+
+  //! Rows of a bitmatrix translated into list of sources per output packet
+  typedef std::vector<std::vector<Source>> RowList;
+
+  unsigned int mK; ///< Number of data devices
+  unsigned int mM; ///< Number of coding devices
+  unsigned int mW; ///< Word size
+  std::vector<int> mBitmatrix; ///< Copy of the encoding bitmatrix
+  RowList mEncRows; ///< Sources for each of the m * w coding packets
+
+  //----------------------------------------------------------------------------
+  //! Translate w consecutive rows of a bitmatrix into source lists
+  //!
+  //! @param row pointer to the first row
+  //! @param dev_ids device index of each group of w columns
+  //! @param rows output row list
+  //----------------------------------------------------------------------------
+  void BuildRows(const int* row, const std::vector<unsigned int>& dev_ids,
+                 RowList& rows) const;
+
+  //----------------------------------------------------------------------------
+  //! Produce the w packets of one output device for every packet group
+  //!
+  //! @param rows row list containing the sources of the output device
+  //! @param first index of the first of the w rows describing the device
+  //! @param out index of the output device
+  //! @param ptrs pointers to all k + m devices
+  //! @param size size of each block
+  //! @param packet_sz packet size
+  //----------------------------------------------------------------------------
+  void Run(const RowList& rows, size_t first, unsigned int out,
+           char* const* ptrs, size_t size, size_t packet_sz) const;
+};
+
+EOSFSTNAMESPACE_END
@@ -22,6 +22,7 @@
  ************************************************************************/
 
 #include "fst/layout/RaidDpLayout.hh"
+#include "fst/layout/ParityEngine.hh"
 #include "fst/io/AsyncMetaHandler.hh"
 #include <cmath>
 #include <map>
@@ -29,8 +30,6 @@
 
 EOSFSTNAMESPACE_BEGIN
 
-typedef long v2do __attribute__((vector_size(VECTOR_SIZE)));
-
 //------------------------------------------------------------------------------
 // Constructor
 //------------------------------------------------------------------------------
@@ -61,22 +60,20 @@ RaidDpLayout::ComputeParity(std::shared_ptr<eos::fst::RainGroup>& grp)
   eos::fst::RainGroup& data_blocks = *grp.get();
 
   // Compute simple parity
+  std::vector<const char*> srcs;
+
   for (unsigned int i = 0; i < mNbDataFiles; i++) {
     int index_pblock = (i + 1) * mNbDataFiles + 2 * i;
     int current_block = i * (mNbDataFiles + 2); //beginning of current line
-    OperationXOR(data_blocks[current_block](),
-                 data_blocks[current_block + 1](),
-                 data_blocks[index_pblock](),
-                 mStripeWidth);
-    current_block += 2;
+    srcs.clear();
 
     while (current_block < index_pblock) {
-      OperationXOR(data_blocks[index_pblock](),
-                   data_blocks[current_block](),
-                   data_blocks[index_pblock](),
-                   mStripeWidth);
+      srcs.push_back(data_blocks[current_block]());
       current_block++;
     }
+
+    ParityEngine::Xor(data_blocks[index_pblock](), srcs.data(), srcs.size(),
+                      mStripeWidth);
   }
 
   // Compute double parity
@@ -91,10 +88,9 @@ RaidDpLayout::ComputeParity(std::shared_ptr<eos::fst::RainGroup>& grp)
   for (unsigned int i = 0; i < mNbDataFiles; i++) {
     unsigned int index_dpblock = (i + 1) * (mNbDataFiles + 1) + i;
     unsigned int next_block = i + jump_blocks;
-    OperationXOR(data_blocks[i](),
-                 data_blocks[next_block](),
-                 data_blocks[index_dpblock](),
-                 mStripeWidth);
+    srcs.clear();
+    srcs.push_back(data_blocks[i]());
+    srcs.push_back(data_blocks[next_block]());
     used_blocks.push_back(i);
     used_blocks.push_back(next_block);
 
@@ -114,52 +110,15 @@ RaidDpLayout::ComputeParity(std::shared_ptr<eos::fst::RainGroup>& grp)
         }
       }
 
-      OperationXOR(data_blocks[index_dpblock](),
-                   data_blocks[next_block](),
-                   data_blocks[index_dpblock](),
-                   mStripeWidth);
+      srcs.push_back(data_blocks[next_block]());
       used_blocks.push_back(next_block);
     }
-  }
 
-  return true;
-}
-
-//------------------------------------------------------------------------------
-// XOR the two blocks using 128 bits and return the result
-//------------------------------------------------------------------------------
-void
-RaidDpLayout::OperationXOR(char* pBlock1, char* pBlock2, char* pResult,
-                           size_t totalBytes)
-{
-  v2do* xor_res;
-  v2do* idx1;
-  v2do* idx2;
-  char* byte_res;
-  char* byte_idx1;
-  char* byte_idx2;
-  long int noPices = -1;
-  idx1 = (v2do*) pBlock1;
-  idx2 = (v2do*) pBlock2;
-  xor_res = (v2do*) pResult;
-  noPices = totalBytes / sizeof(v2do);
-
-  for (unsigned int i = 0; i < noPices; idx1++, idx2++, xor_res++, i++) {
-    *xor_res = *idx1 ^ *idx2;
+    ParityEngine::Xor(data_blocks[index_dpblock](), srcs.data(), srcs.size(),
+                      mStripeWidth);
   }
 
-  // If the block does not devide perfectly to 128 ...
-  if (totalBytes % sizeof(v2do) != 0) {
-    byte_res = (char*) xor_res;
-    byte_idx1 = (char*) idx1;
-    byte_idx2 = (char*) idx2;
-
-    for (unsigned int i = noPices * sizeof(v2do);
-         i < totalBytes;
-         byte_res++, byte_idx1++, byte_idx2++, i++) {
-      *byte_res = *byte_idx1 ^ *byte_idx2;
-    }
-  }
+  return true;
 }
 
 //------------------------------------------------------------------------------
@@ -278,16 +237,17 @@ RaidDpLayout::RecoverPiecesInGroup(XrdCl::ChunkList& grp_errs)
 
     if (ValidHorizStripe(horizontal_stripe, status_blocks, id_corrupted)) {
       data_blocks[id_corrupted].FillWithZeros(true);
+      std::vector<const char*> srcs;
 
       for (unsigned int ind = 0; ind < horizontal_stripe.size(); ind++) {
         if (horizontal_stripe[ind] != id_corrupted) {
-          OperationXOR(data_blocks[id_corrupted](),
-                       data_blocks[horizontal_stripe[ind]](),
-                       data_blocks[id_corrupted](),
-                       mStripeWidth);
+          srcs.push_back(data_blocks[horizontal_stripe[ind]]());
         }
       }
 
+      ParityEngine::Xor(data_blocks[id_corrupted](), srcs.data(), srcs.size(),
+                        mStripeWidth);
+
       // Return recovered block and also write it to the file
       stripe_id = id_corrupted % mNbTotalFiles;
       physical_id = mapLP[stripe_id];
@@ -337,16 +297,17 @@ RaidDpLayout::RecoverPiecesInGroup(XrdCl::ChunkList& grp_errs)
       // Try to recover using double parity
       if (ValidDiagStripe(diagonal_stripe, status_blocks, id_corrupted)) {
         data_blocks[id_corrupted].FillWithZeros(true);
+        std::vector<const char*> srcs;
 
         for (unsigned int ind = 0; ind < diagonal_stripe.size(); ind++) {
           if (diagonal_stripe[ind] != id_corrupted) {
-            OperationXOR(data_blocks[id_corrupted](),
-                         data_blocks[diagonal_stripe[ind]](),
-                         data_blocks[id_corrupted](),
-                         mStripeWidth);
+            srcs.push_back(data_blocks[diagonal_stripe[ind]]());
           }
         }
 
+        ParityEngine::Xor(data_blocks[id_corrupted](), srcs.data(), srcs.size(),
+                          mStripeWidth);
+
         // Return recovered block and also write them to the files
         stripe_id = id_corrupted % mNbTotalFiles;
         physical_id = mapLP[stripe_id];
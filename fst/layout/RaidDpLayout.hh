@@ -28,10 +28,6 @@
 
 EOSFSTNAMESPACE_BEGIN
 
-//! Used for computing XOR or 128 bits = 8 * 16
-#define VECTOR_SIZE 16
-
-
 //------------------------------------------------------------------------------
 //! Implementation of the RAID-double parity layout
 //------------------------------------------------------------------------------
@@ -123,17 +119,6 @@ private:
   //----------------------------------------------------------------------------
   virtual int WriteParityToFiles(std::shared_ptr<eos::fst::RainGroup>& grp);
 
-  //----------------------------------------------------------------------------
-  //! Compute XOR operation for two blocks of any size
-  //!
-  //! @param pBlock1 first input block
-  //! @param pBlock2 second input block
-  //! @param pResult result of XOR operation
-  //! @param totalBytes size of input blocks
-  //----------------------------------------------------------------------------
-  void OperationXOR(char* pBlock1, char* pBlock2, char* pResult,
-                    size_t totalBytes);
-
   //----------------------------------------------------------------------------
   //! Recover corrupted chunks from the current group
   //!
@@ -26,8 +26,10 @@
 
 namespace
 {
-// Max 2GB of memory with blocks of at most 64MB each
-eos::common::BufferManager gRainBuffMgr(2 * eos::common::GB, 6);
+// Max 2GB of memory with blocks of at most 64MB each, blocks of at least 2MB
+// are backed by transparent huge pages to reduce page faults and TLB misses
+eos::common::BufferManager gRainBuffMgr(2 * eos::common::GB, 6, eos::common::MB,
+                                        eos::common::Buffer::Backing::Thp);
 }
 
 EOSFSTNAMESPACE_BEGIN
@@ -62,7 +64,12 @@ RainBlock::Write(const char* buffer, uint64_t offset, uint32_t length)
     return nullptr;
   }
 
+  char* ptr = mBuffer->GetDataPtr();
+
+  // The buffers are not initialised, zero the hole left in front of this
+  // piece. A later write into the hole overwrites the zeros.
   if (offset > mLastOffset) {
+    (void) memset(ptr + mLastOffset, '\0', offset - mLastOffset);
     mHasHoles = true;
   }
 
@@ -70,7 +77,6 @@ RainBlock::Write(const char* buffer, uint64_t offset, uint32_t length)
     mLastOffset = offset + length;
   }
 
-  char* ptr = mBuffer->GetDataPtr();
   ptr += offset;
   (void) memcpy(ptr, buffer, length);
   return ptr;
@@ -82,10 +88,6 @@ RainBlock::Write(const char* buffer, uint64_t offset, uint32_t length)
 bool
 RainBlock::FillWithZeros(bool force)
 {
-  if (mHasHoles) {
-    return false;
-  }
-
   uint64_t len = mCapacity;
   char* ptr = mBuffer->GetDataPtr();
 
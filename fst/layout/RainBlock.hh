@@ -115,7 +115,7 @@ public:
   uint32_t mCapacity; ///< Max size of the current block
   uint32_t mLastOffset; ///< Last written offset
   uint32_t mLength {0ull}; ///< Length of useful data, relevant if no holes
-  bool mHasHoles {false}; ///< Mark if block contains holes
+  bool mHasHoles {false}; ///< Mark if block was written with holes (zeroed)
   std::shared_ptr<eos::common::Buffer> mBuffer; ///< Actual data buffer
 };
 
@@ -54,7 +54,8 @@ RainGroup::FillWithZeros()
   bool ret = true;
 
   for (auto& block : mBlocks) {
-    ret = ret && block.FillWithZeros();
+    // Don't short-circuit, every block has to be padded
+    ret = block.FillWithZeros() && ret;
   }
 
   return ret;
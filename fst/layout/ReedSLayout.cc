@@ -50,7 +50,7 @@ ReedSLayout::ReedSLayout(XrdFstOfsFile* file,
                          std::string bookingOpaque) :
   RainMetaLayout(file, lid, client, outError, path, timeout,
                  storeRecovery, targetSize, bookingOpaque),
-  mPacketSize(0), matrix(0), bitmatrix(0), schedule(0)
+  mPacketSize(0), matrix(0), bitmatrix(0)
 {
   mNbDataBlocks = mNbDataFiles;
   mNbTotalBlocks = mNbDataFiles + mNbParityFiles;
@@ -94,14 +94,14 @@ ReedSLayout::InitialiseJerasure()
   matrix = cauchy_good_general_coding_matrix(mNbDataBlocks, mNbParityFiles, w);
   bitmatrix = jerasure_matrix_to_bitmatrix(mNbDataBlocks, mNbParityFiles, w,
               matrix);
-  schedule = jerasure_smart_bitmatrix_to_schedule(mNbDataBlocks, mNbParityFiles,
-             w, bitmatrix);
 
-  if ((matrix == nullptr) || (bitmatrix == nullptr) ||
-      (schedule == nullptr)) {
+  if ((matrix == nullptr) || (bitmatrix == nullptr)) {
     eos_crit("%s", "msg=\"Jerasure initialization failed\"");
     throw std::runtime_error("Jerasure initialization failed");
   }
+
+  mCode.reset(new eos::fst::BitmatrixCode(mNbDataBlocks, mNbParityFiles, w,
+                                          bitmatrix));
 }
 
 //------------------------------------------------------------------------------
@@ -124,29 +124,7 @@ ReedSLayout::FreeJerasure()
   free(matrix);
   free(bitmatrix);
   matrix = bitmatrix = nullptr;
-  // NOTE, based on an inspection of the jerasure code used to build the
-  // the schedule array, it appears that the sentinal used to signal the end
-  // of the array is a value of -1 in the first int field in the dereferenced
-  // value. We use this to determine when to stop free-ing elements. See the
-  // jerasure_smart_bitmatrix_to_schedule and
-  // jerasure_dumb_bitmatrix_to_schedule functions in jerasure.c for the
-  // details.
-  int i = 0;
-  bool end_of_array = false;
-
-  if (schedule != NULL) {
-    while (!end_of_array) {
-      if (schedule[i] == NULL || schedule[i][0] == -1) {
-        end_of_array = true;
-      }
-
-      free(schedule[i]);
-      i++;
-    }
-  }
-
-  free(schedule);
-  schedule = nullptr;
+  mCode.reset();
 }
 
 //------------------------------------------------------------------------------
@@ -170,8 +148,7 @@ ReedSLayout::ComputeParity(std::shared_ptr<eos::fst::RainGroup>& grp)
   }
 
   // Encode the blocks
-  jerasure_schedule_encode(mNbDataBlocks, mNbParityFiles, w, schedule, data,
-                           coding, mStripeWidth, mPacketSize);
+  mCode->Encode(data, coding, mStripeWidth, mPacketSize);
   return true;
 }
 
@@ -272,24 +249,11 @@ ReedSLayout::RecoverPiecesInGroup(XrdCl::ChunkList& grp_errs)
     coding[i] = data_blocks[mNbDataFiles + i]();
   }
 
-  // Array of ids of erased pieces (corrupted)
-  int* erasures = new int[invalid_ids.size() + 1];
-  int index = 0;
-
-  for (auto iter = invalid_ids.begin();
-       iter != invalid_ids.end(); ++iter, ++index) {
-    erasures[index] = *iter;
-  }
-
-  erasures[invalid_ids.size()] = -1;
   // ******* DECODE ******
-  int decode = jerasure_schedule_decode_lazy(mNbDataBlocks, mNbParityFiles, w,
-               bitmatrix, erasures, data, coding,
-               mStripeWidth, mPacketSize, 1);
-  // Free memory
-  delete[] erasures;
+  bool decode = mCode->Decode(invalid_ids, data, coding, mStripeWidth,
+                              mPacketSize);
 
-  if (decode == -1) {
+  if (!decode) {
     eos_err("msg=\"decoding was unsuccessful\"");
     RecycleGroup(grp);
     return false;
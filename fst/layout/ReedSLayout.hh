@@ -24,6 +24,7 @@
 
 #pragma once
 #include "fst/layout/RainMetaLayout.hh"
+#include "fst/layout/ParityEngine.hh"
 
 EOSFSTNAMESPACE_BEGIN
 
@@ -105,7 +106,8 @@ private:
   unsigned int mPacketSize; ///< packet size for Jerasure
   int* matrix;
   int* bitmatrix;
-  int** schedule;
+  //! Vectorised executor of the Cauchy bitmatrix
+  std::unique_ptr<eos::fst::BitmatrixCode> mCode;
   std::atomic<bool> mDoneInit {false}; ///< Mark Jerasure initialization
 
   //----------------------------------------------------------------------------
@@ -26,10 +26,10 @@
 #include "fst/txqueue/TransferQueue.hh"
 #include "fst/storage/FileSystem.hh"
 #include "fst/FmdDbMap.hh"
+#include "fst/utils/DeletionPipeline.hh"
 #include "namespace/ns_quarkdb/BackendClient.hh"
 #include "qclient/Formatting.hh"
 #include "common/LinuxStat.hh"
-#include "common/ShellCmd.hh"
 #include "common/Timing.hh"
 #include "common/IntervalStopwatch.hh"
 #include "XrdVersion.hh"
@@ -66,61 +66,28 @@ static std::string HotFilesToString(
 }
 
 //------------------------------------------------------------------------------
-// Retrieve net speed
+// Retrieve net speed of the default route interface
 //------------------------------------------------------------------------------
-static uint64_t GetNetSpeed(const std::string& tmpname)
+static uint64_t GetNetSpeed(ProcMetrics& metrics)
 {
   if (getenv("EOS_FST_NETWORK_SPEED")) {
     return strtoull(getenv("EOS_FST_NETWORK_SPEED"), nullptr, 10);
   }
 
-  std::string getNetspeedCommand = SSTR(
-                                     "ip route list | sed -ne '/^default/s/.*dev //p' | cut -d ' ' -f1 |"
-                                     " xargs -i ethtool {} 2>&1 | grep Speed | cut -d ' ' -f2 | cut -d 'M' -f1 > "
-                                     << tmpname);
-  eos::common::ShellCmd scmd1(getNetspeedCommand.c_str());
-  eos::common::cmd_status rc = scmd1.wait(5);
-  unsigned long long netspeed = 1000000000;
-
-  if (rc.exit_code) {
-    eos_static_err("ip route list call failed to get netspeed");
-    return netspeed;
-  }
-
-  FILE* fnetspeed = fopen(tmpname.c_str(), "r");
-
-  if (fnetspeed) {
-    if ((fscanf(fnetspeed, "%llu", &netspeed)) == 1) {
-      // we get MB as a number => convert into bytes
-      netspeed *= 1000000;
-      eos_static_info("ethtool:networkspeed=%.02f GB/s",
-                      1.0 * netspeed / 1000000000.0);
-    }
+  std::string iface = metrics.GetDefaultInterface();
+  uint64_t netspeed = metrics.GetLinkSpeed(iface);
 
-    fclose(fnetspeed);
+  if (netspeed == 0) {
+    eos_static_err("msg=\"failed to get link speed, assume 1 Gb/s\" "
+                   "iface=\"%s\"", iface.c_str());
+    return 1000000000;
   }
 
+  eos_static_info("msg=\"link speed\" iface=%s networkspeed=%.02f GB/s",
+                  iface.c_str(), 1.0 * netspeed / 1000000000.0);
   return netspeed;
 }
 
-//------------------------------------------------------------------------------
-// Retrieve uptime
-//------------------------------------------------------------------------------
-static std::string GetUptime(const std::string& tmpname)
-{
-  eos::common::ShellCmd cmd(SSTR("uptime | tr -d \"\n\" > " << tmpname));
-  eos::common::cmd_status rc = cmd.wait(5);
-
-  if (rc.exit_code) {
-    eos_static_err("retrieve uptime call failed");
-    return "N/A";
-  }
-
-  std::string retval;
-  eos::common::StringConversion::LoadFileIntoString(tmpname.c_str(), retval);
-  return retval;
-}
-
 //------------------------------------------------------------------------------
 // Retrieve xrootd version
 //------------------------------------------------------------------------------
@@ -156,32 +123,11 @@ static std::string GetNetworkInterface()
   return "eth0";
 }
 
-//------------------------------------------------------------------------------
-// Retrieve number of TCP sockets in the system
-// TODO: Change return value to integer..
-//------------------------------------------------------------------------------
-static std::string GetNumOfTcpSockets(const std::string& tmpname)
-{
-  std::string command = SSTR("cat /proc/net/tcp | wc -l | tr -d \"\n\" > " <<
-                             tmpname);
-  eos::common::ShellCmd cmd(command.c_str());
-  eos::common::cmd_status rc = cmd.wait(5);
-
-  if (rc.exit_code) {
-    eos_static_err("retrieve #socket call failed");
-  }
-
-  std::string retval;
-  eos::common::StringConversion::LoadFileIntoString(tmpname.c_str(), retval);
-  return retval;
-}
-
 //------------------------------------------------------------------------------
 // Get statistics about this FST, used for publishing
 //------------------------------------------------------------------------------
 std::map<std::string, std::string>
-Storage::GetFstStatistics(const std::string& tmpfile,
-                          unsigned long long netspeed)
+Storage::GetFstStatistics(unsigned long long netspeed)
 {
   eos::common::LinuxStat::linux_stat_t osstat;
 
@@ -205,9 +151,9 @@ Storage::GetFstStatistics(const std::string& tmpfile,
   // adler32 of keytab
   output["stat.sys.keytab"] = eos::fst::Config::gConfig.KeyTabAdler.c_str();
   // machine uptime
-  output["stat.sys.uptime"] = GetUptime(tmpfile);
+  output["stat.sys.uptime"] = mProcMetrics.GetUptime();
   // active TCP sockets
-  output["stat.sys.sockets"] = GetNumOfTcpSockets(tmpfile);
+  output["stat.sys.sockets"] = std::to_string(mProcMetrics.GetTcpSockets());
   // startup time of the FST daemon
   output["stat.sys.eos.start"] = eos::fst::Config::gConfig.StartDate.c_str();
   // FST geotag
@@ -227,31 +173,32 @@ Storage::GetFstStatistics(const std::string& tmpfile,
   output["stat.net.outratemib"] = SSTR(
                                     mFstLoad.GetNetRate(GetNetworkInterface().c_str(),
                                         "txbytes") / 1024.0 / 1024.0);
+  // fmd group commit queue depth and flush latency
+  FmdCommitQueue::Stats commit_stats = gFmdDbMapHandler.GetCommitStats();
+  output["stat.fmd.commit.queued"] = SSTR(commit_stats.mQueued);
+  output["stat.fmd.commit.flushms"] = SSTR(commit_stats.mAvgFlushMs);
+  output["stat.fmd.commit.maxflushms"] = SSTR(commit_stats.mMaxFlushMs);
+  // deletion backlog, totals and unlink rate since the previous publishing
+  DeletionPipeline::Stats del_stats = mDeletionPipeline->GetStats();
+  static uint64_t last_unlinked = 0;
+  static auto last_ts = std::chrono::steady_clock::now();
+  auto now = std::chrono::steady_clock::now();
+  double elapsed = std::chrono::duration<double>(now - last_ts).count();
+  output["stat.deletion.queued"] = SSTR(GetNumDeletions() + del_stats.mPending);
+  output["stat.deletion.unlinked"] = SSTR(del_stats.mUnlinked);
+  output["stat.deletion.failed"] = SSTR(del_stats.mFailed);
+  output["stat.deletion.dropped"] = SSTR(del_stats.mDropped);
+  output["stat.deletion.dropcalls"] = SSTR(del_stats.mDropCalls);
+  output["stat.deletion.rate"] = SSTR((elapsed > 0) ?
+                                      (del_stats.mUnlinked - last_unlinked) / elapsed : 0);
+  last_unlinked = del_stats.mUnlinked;
+  last_ts = now;
   // publish timestamp
   output["stat.publishtimestamp"] = SSTR(
                                       eos::common::getEpochInMilliseconds().count());
   return output;
 }
 
-//------------------------------------------------------------------------------
-// open random temporary file in /tmp/
-// Return value: string containing the temporary file. If opening it was
-// not possible, return empty string.
-//------------------------------------------------------------------------------
-std::string makeTemporaryFile()
-{
-  char tmp_name[] = "/tmp/fst.publish.XXXXXX";
-  int tmp_fd = mkstemp(tmp_name);
-
-  if (tmp_fd == -1) {
-    eos_static_crit("failed to create temporary file!");
-    return "";
-  }
-
-  (void) close(tmp_fd);
-  return tmp_name;
-}
-
 //------------------------------------------------------------------------------
 // Insert statfs info into the map
 //------------------------------------------------------------------------------
@@ -415,13 +362,7 @@ Storage::Publish(ThreadAssistant& assistant)
 {
   eos_static_info("%s", "msg=\"publisher activated\"");
   // Get our network speed
-  std::string tmp_name = makeTemporaryFile();
-
-  if (tmp_name.empty()) {
-    return;
-  }
-
-  unsigned long long netspeed = GetNetSpeed(tmp_name);
+  unsigned long long netspeed = GetNetSpeed(mProcMetrics);
   eos_static_info("msg=\"publish networkspeed=%.02f GB/s\"",
                   1.0 * netspeed / 1000000000.0);
   // The following line acts as a barrier that prevents progress
@@ -462,7 +403,7 @@ Storage::Publish(ThreadAssistant& assistant)
           }
         }
 
-        auto fstStats = GetFstStatistics(tmp_name, netspeed);
+        auto fstStats = GetFstStatistics(netspeed);
         // Set node status values
         common::SharedHashLocator locator =
           Config::gConfig.getNodeHashLocator("Publish");
@@ -488,8 +429,6 @@ Storage::Publish(ThreadAssistant& assistant)
       assistant.wait_for(sleepTime);
     }
   }
-
-  (void) unlink(tmp_name.c_str());
 }
 
 EOSFSTNAMESPACE_END
@@ -24,6 +24,8 @@
 #include "fst/storage/Storage.hh"
 #include "fst/XrdFstOfs.hh"
 #include "fst/Deletion.hh"
+#include "fst/utils/DeletionPipeline.hh"
+#include <cstring>
 
 EOSFSTNAMESPACE_BEGIN
 
@@ -56,43 +58,21 @@ Storage::Remover()
     eos_static_info("%s", "msg=\"mgm doesn't support query2delete\"");
   }
 
-  // Thread that unlinks stored files
+  // Thread handing the deletions over to the pipeline unlinking the files
   while (true) {
     num_deleted = 0ull;
     std::unique_ptr<Deletion> to_del;
 
     while ((to_del = GetDeletion())) {
-      for (unsigned int i = 0; i < to_del->mFidVect.size(); ++i) {
-        eos_static_debug("msg=\"delete file\" fxid=%08llx fsid=%u",
-                         to_del->mFidVect[i], to_del->mFsid);
-        ++num_deleted;
-        const std::string hex_fid = eos::common::FileId::Fid2Hex(to_del->mFidVect[i]);
-        XrdOucErrInfo error;
-        XrdOucString capOpaqueString = "/?mgm.pcmd=drop";
-        XrdOucString OpaqueString = "";
-        OpaqueString += "&mgm.fsid=";
-        OpaqueString += (int) to_del->mFsid;
-        OpaqueString += "&mgm.fid=";
-        OpaqueString += hex_fid.c_str();
-        OpaqueString += "&mgm.localprefix=";
-        OpaqueString += to_del->mLocalPrefix;
-        XrdOucEnv Opaque(OpaqueString.c_str());
-        capOpaqueString += OpaqueString;
-
-        // Delete local file
-        if ((gOFS._rem("/DELETION", error, (const XrdSecEntity*) 0, &Opaque,
-                       0, 0, 0, true) != SFS_OK)) {
-          eos_static_warning("msg=\"unable to remove local file\" fxid=%s "
-                             "fsid=%lu localprefix=%s", hex_fid.c_str(),
-                             to_del->mFsid, to_del->mLocalPrefix.c_str());
-        }
+      num_deleted += to_del->mFidVect.size();
+      mDeletionPipeline->Push(std::move(to_del));
+    }
 
-        // Update the manager
-        if (gOFS.CallManager(&error, 0, 0 , capOpaqueString)) {
-          eos_static_err("msg=\"unable to drop file\" fxid=\"%s\" fsid=\"%u\"",
-                         hex_fid.c_str(), to_del->mFsid);
-        }
-      }
+    // Wait for the round to be unlinked and confirmed before asking for more,
+    // otherwise the MGM sends again the files not yet dropped. Polling keeps
+    // the thread cancellable at shutdown.
+    while (num_deleted && mDeletionPipeline->GetStats().mPending) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
     }
 
     auto now_ts = system_clock::now();
@@ -144,4 +124,95 @@ Storage::Remover()
   }
 }
 
+//------------------------------------------------------------------------------
+// Unlink the local file of a deletion
+//------------------------------------------------------------------------------
+bool
+Storage::UnlinkDeletion(const Deletion& del, unsigned long long fid)
+{
+  XrdOucErrInfo error;
+  const std::string hex_fid = eos::common::FileId::Fid2Hex(fid);
+  const std::string fst_path = eos::common::FileId::FidPrefix2FullPath
+                               (hex_fid.c_str(), del.mLocalPrefix.c_str());
+
+  if (gOFS._rem("/DELETION", error, (const XrdSecEntity*) 0, nullptr,
+                fst_path.c_str(), fid, del.mFsid, true) != SFS_OK) {
+    eos_static_warning("msg=\"unable to remove local file\" fxid=%s "
+                       "fsid=%lu localprefix=%s", hex_fid.c_str(),
+                       del.mFsid, del.mLocalPrefix.c_str());
+    return false;
+  }
+
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// Confirm the deletion of the given files to the MGM
+//------------------------------------------------------------------------------
+bool
+Storage::DropDeletions(unsigned long fsid,
+                       const std::vector<unsigned long long>& fids)
+{
+  XrdOucErrInfo error;
+  std::vector<unsigned long long> single_fids;
+
+  if (mBulkDrop && (fids.size() > 1)) {
+    auto it = fids.begin();
+
+    while (it != fids.end()) {
+      // Split into several queries if the opaque would get too long
+      const auto first = it;
+      std::string query = "/?mgm.pcmd=drop&mgm.fsid=";
+      query += std::to_string(fsid);
+      query += "&mgm.fids=";
+
+      for (; (it != fids.end()) && (query.length() <= sMaxDropQueryLen); ++it) {
+        if (it != first) {
+          query += ',';
+        }
+
+        query += eos::common::FileId::Fid2Hex(*it);
+      }
+
+      XrdOucString capOpaqueString = query.c_str();
+
+      if (gOFS.CallManager(&error, 0, 0, capOpaqueString) == SFS_OK) {
+        continue;
+      }
+
+      if (strstr(error.getErrText(), "missing meta information")) {
+        // An MGM without bulk drop support only looks for the mgm.fid tag
+        eos_static_info("%s", "msg=\"mgm doesn't support bulk drop\"");
+        mBulkDrop = false;
+        single_fids.insert(single_fids.end(), first, fids.end());
+        break;
+      }
+
+      eos_static_warning("msg=\"bulk drop failed, dropping one by one\" "
+                         "fsid=%lu nfids=%lu", fsid, (unsigned long)(it - first));
+      single_fids.insert(single_fids.end(), first, it);
+    }
+  } else {
+    single_fids = fids;
+  }
+
+  size_t num_failed = 0;
+
+  for (const auto fid : single_fids) {
+    const std::string hex_fid = eos::common::FileId::Fid2Hex(fid);
+    XrdOucString capOpaqueString = "/?mgm.pcmd=drop&mgm.fsid=";
+    capOpaqueString += (int) fsid;
+    capOpaqueString += "&mgm.fid=";
+    capOpaqueString += hex_fid.c_str();
+
+    if (gOFS.CallManager(&error, 0, 0, capOpaqueString)) {
+      eos_static_err("msg=\"unable to drop file\" fxid=\"%s\" fsid=\"%lu\"",
+                     hex_fid.c_str(), fsid);
+      ++num_failed;
+    }
+  }
+
+  return (num_failed == 0);
+}
+
 EOSFSTNAMESPACE_END
@@ -27,6 +27,7 @@
 #include "fst/FmdDbMap.hh"
 #include "fst/Verify.hh"
 #include "fst/Deletion.hh"
+#include "fst/utils/DeletionPipeline.hh"
 #include "fst/txqueue/TransferQueue.hh"
 #include "common/FileSystem.hh"
 #include "common/Path.hh"
@@ -128,6 +129,35 @@ Storage::Storage(const char* meta_dir)
   }
 
   mThreadSet.insert(tid);
+  // Deletion workers, by default 4 unlinking threads and up to 256 files
+  // confirmed to the MGM per call
+  unsigned int num_workers = 4;
+  size_t drop_batch = 256;
+
+  if (getenv("EOS_FST_DELETE_WORKERS")) {
+    try {
+      num_workers = std::max(std::stoi(getenv("EOS_FST_DELETE_WORKERS")), 1);
+    } catch (...) {
+      eos_err("msg=\"invalid EOS_FST_DELETE_WORKERS value\"");
+    }
+  }
+
+  if (getenv("EOS_FST_DELETE_DROP_BATCH")) {
+    try {
+      drop_batch = std::max(std::stoi(getenv("EOS_FST_DELETE_DROP_BATCH")), 1);
+    } catch (...) {
+      eos_err("msg=\"invalid EOS_FST_DELETE_DROP_BATCH value\"");
+    }
+  }
+
+  eos_info("msg=\"starting deletion pipeline\" workers=%u drop_batch=%lu",
+           num_workers, drop_batch);
+  mDeletionPipeline = std::make_unique<DeletionPipeline>
+  ([this](const Deletion & del, unsigned long long fid) {
+    return UnlinkDeletion(del, fid);
+  }, [this](unsigned long fsid, const std::vector<unsigned long long>& fids) {
+    return DropDeletions(fsid, fids);
+  }, num_workers, drop_batch);
   eos_info("starting deletion thread");
 
   if ((rc = XrdSysThread::Run(&tid, Storage::StartFsRemover,
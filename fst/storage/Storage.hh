@@ -31,12 +31,14 @@
 #include "common/AssistedThread.hh"
 #include "namespace/ns_quarkdb/QdbContactDetails.hh"
 #include "fst/Load.hh"
+#include "fst/utils/ProcMetrics.hh"
 #include "fst/Health.hh"
 #include "fst/txqueue/TransferMultiplexer.hh"
 #include <vector>
 #include <list>
 #include <queue>
 #include <map>
+#include <atomic>
 
 namespace eos
 {
@@ -50,6 +52,7 @@ EOSFSTNAMESPACE_BEGIN
 
 class Verify;
 class Deletion;
+class DeletionPipeline;
 class FileSystem;
 
 //------------------------------------------------------------------------------
@@ -191,8 +194,16 @@ private:
   std::queue <eos::fst::Verify*> mVerifications;
   XrdSysMutex mDeletionsMutex; ///< Mutex protecting the list of deletions
   std::list< std::unique_ptr<Deletion> > mListDeletions; ///< List of deletions
+  //! Workers unlinking the deleted files and confirming them to the MGM
+  std::unique_ptr<DeletionPipeline> mDeletionPipeline;
+  //! The MGM accepts drop confirmations for many files in one call
+  std::atomic<bool> mBulkDrop {true};
+  //! Max length of a bulk drop query before the last fid is appended, the
+  //! MGM rejects opaque information of 16KB or more
+  static constexpr size_t sMaxDropQueryLen {16000};
   Load mFstLoad; ///< Net/IO load monitor
   Health mFstHealth; ///< Local disk S.M.A.R.T monitor
+  ProcMetrics mProcMetrics; ///< Node metrics read from /proc
 
   //! Struct BootThreadInfo
   struct BootThreadInfo {
@@ -225,7 +236,7 @@ private:
   //! Get statistics about this FST, used for publishing
   //----------------------------------------------------------------------------
   std::map<std::string, std::string> GetFstStatistics(
-    const std::string& tmpfile, unsigned long long netspeed);
+    unsigned long long netspeed);
 
   //----------------------------------------------------------------------------
   //! Publish statistics about the given filesystem
@@ -285,6 +296,28 @@ private:
   void Scrub();
   void Trim();
   void Remover();
+
+  //----------------------------------------------------------------------------
+  //! Unlink the local file of a deletion
+  //!
+  //! @param del deletion object
+  //! @param fid file id
+  //!
+  //! @return true if successful, otherwise false
+  //----------------------------------------------------------------------------
+  bool UnlinkDeletion(const Deletion& del, unsigned long long fid);
+
+  //----------------------------------------------------------------------------
+  //! Confirm the deletion of the given files to the MGM
+  //!
+  //! @param fsid file system id
+  //! @param fids file ids
+  //!
+  //! @return true if successful, otherwise false
+  //----------------------------------------------------------------------------
+  bool DropDeletions(unsigned long fsid,
+                     const std::vector<unsigned long long>& fids);
+
   void Report();
   void ErrorReport();
   void Verify();
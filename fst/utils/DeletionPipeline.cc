@@ -0,0 +1,204 @@
+//------------------------------------------------------------------------------
+//! @file DeletionPipeline.cc
+//------------------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2023 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+#include "fst/utils/DeletionPipeline.hh"
+#include "fst/Deletion.hh"
+#include "common/Logging.hh"
+#include <algorithm>
+
+EOSFSTNAMESPACE_BEGIN
+
+//------------------------------------------------------------------------------
+// Constructor
+//------------------------------------------------------------------------------
+DeletionPipeline::DeletionPipeline(UnlinkFunc unlink_func, DropFunc drop_func,
+                                   unsigned int num_workers, size_t drop_batch):
+  mUnlinkFunc(std::move(unlink_func)), mDropFunc(std::move(drop_func)),
+  mDropBatch(std::max(drop_batch, (size_t)1))
+{
+  for (unsigned int i = 0; i < std::max(num_workers, 1u); ++i) {
+    mWorkers.emplace_back(std::make_unique<Worker>());
+  }
+
+  for (auto& worker : mWorkers) {
+    worker->mThread = std::thread(&DeletionPipeline::WorkerLoop, this,
+                                  std::ref(*worker));
+  }
+}
+
+//------------------------------------------------------------------------------
+// Destructor
+//------------------------------------------------------------------------------
+DeletionPipeline::~DeletionPipeline()
+{
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStop = true;
+  }
+
+  for (auto& worker : mWorkers) {
+    worker->mCondVar.notify_all();
+  }
+
+  mCondVar.notify_all();
+
+  for (auto& worker : mWorkers) {
+    worker->mThread.join();
+  }
+}
+
+//------------------------------------------------------------------------------
+// Queue a deletion
+//------------------------------------------------------------------------------
+void
+DeletionPipeline::Push(std::unique_ptr<Deletion> del)
+{
+  const size_t num_fids = del->mFidVect.size();
+
+  if (num_fids == 0) {
+    return;
+  }
+
+  // All the deletions of a file system are handled by the same worker
+  Worker& worker = *mWorkers[del->mFsid % mWorkers.size()];
+  std::lock_guard<std::mutex> lock(mMutex);
+
+  if (mStop) {
+    return;
+  }
+
+  mStats.mQueued += num_fids;
+  mStats.mPending += num_fids;
+  worker.mQueue.push_back(std::move(del));
+  worker.mCondVar.notify_one();
+}
+
+//------------------------------------------------------------------------------
+// Wait until all the queued files are unlinked and confirmed
+//------------------------------------------------------------------------------
+void
+DeletionPipeline::WaitIdle()
+{
+  std::unique_lock<std::mutex> lock(mMutex);
+  mCondVar.wait(lock, [&]() {
+    return mStop || (mStats.mPending == 0);
+  });
+}
+
+//------------------------------------------------------------------------------
+// Get deletion statistics
+//------------------------------------------------------------------------------
+DeletionPipeline::Stats
+DeletionPipeline::GetStats() const
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  return mStats;
+}
+
+//------------------------------------------------------------------------------
+// Unlink the files of a deletion
+//------------------------------------------------------------------------------
+void
+DeletionPipeline::Process(const Deletion& del, DropBatches& batches)
+{
+  auto& fids = batches[del.mFsid];
+
+  for (const auto fid : del.mFidVect) {
+    eos_static_debug("msg=\"delete file\" fxid=%08llx fsid=%lu", fid,
+                     del.mFsid);
+    const bool ok = mUnlinkFunc(del, fid);
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      --mStats.mQueued;
+      ++(ok ? mStats.mUnlinked : mStats.mFailed);
+    }
+    // The MGM is updated also if the unlink failed, same as for the single
+    // file deletions
+    fids.push_back(fid);
+
+    if (fids.size() >= mDropBatch) {
+      Drop(del.mFsid, fids);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// Confirm a batch of files to the MGM
+//------------------------------------------------------------------------------
+void
+DeletionPipeline::Drop(unsigned long fsid, std::vector<unsigned long long>& fids)
+{
+  if (fids.empty()) {
+    return;
+  }
+
+  const bool ok = mDropFunc(fsid, fids);
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    ++mStats.mDropCalls;
+    (ok ? mStats.mDropped : mStats.mDropFailed) += fids.size();
+    mStats.mPending -= fids.size();
+  }
+  mCondVar.notify_all();
+  fids.clear();
+}
+
+//------------------------------------------------------------------------------
+// Worker thread loop
+//------------------------------------------------------------------------------
+void
+DeletionPipeline::WorkerLoop(Worker& worker)
+{
+  DropBatches batches;
+  std::unique_lock<std::mutex> lock(mMutex);
+
+  while (true) {
+    if (worker.mQueue.empty() || mStop) {
+      // Out of work, confirm the partial batches
+      lock.unlock();
+
+      for (auto& batch : batches) {
+        Drop(batch.first, batch.second);
+      }
+
+      batches.clear();
+      lock.lock();
+
+      if (mStop) {
+        break;
+      }
+
+      worker.mCondVar.wait(lock, [&]() {
+        return mStop || !worker.mQueue.empty();
+      });
+      continue;
+    }
+
+    std::unique_ptr<Deletion> del = std::move(worker.mQueue.front());
+    worker.mQueue.pop_front();
+    lock.unlock();
+    Process(*del, batches);
+    lock.lock();
+  }
+}
+
+EOSFSTNAMESPACE_END
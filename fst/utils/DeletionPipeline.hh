@@ -0,0 +1,148 @@
+//------------------------------------------------------------------------------
+//! @file DeletionPipeline.hh
+//! @brief Parallel unlinking of deleted files with batched drop confirmations
+//------------------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2023 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+#pragma once
+#include "fst/Namespace.hh"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+EOSFSTNAMESPACE_BEGIN
+
+class Deletion;
+
+//------------------------------------------------------------------------------
+//! Class DeletionPipeline - unlinks the files of the deletions handed over by
+//! the Remover using a pool of workers. All the deletions of a file system go
+//! to the same worker, so that the file systems are emptied in parallel
+//! without having several threads competing for the same disk. The unlinked
+//! file ids are confirmed to the MGM in batches of up to the configured size
+//! instead of one call per file. A worker flushes its partial batches as soon
+//! as it runs out of work.
+//------------------------------------------------------------------------------
+class DeletionPipeline
+{
+public:
+  //! Function unlinking a file of a deletion, returns true if successful
+  using UnlinkFunc = std::function<bool(const Deletion&, unsigned long long)>;
+
+  //! Function confirming the unlinked files of a file system to the MGM,
+  //! returns true if successful
+  using DropFunc = std::function<bool(unsigned long,
+                                      const std::vector<unsigned long long>&)>;
+
+  //! Deletion statistics, the counters are totals since the start
+  struct Stats {
+    uint64_t mQueued {0}; ///< Number of files waiting to be unlinked
+    uint64_t mPending {0}; ///< Number of files not yet confirmed to the MGM
+    uint64_t mUnlinked {0}; ///< Number of files unlinked
+    uint64_t mFailed {0}; ///< Number of files which could not be unlinked
+    uint64_t mDropped {0}; ///< Number of files confirmed to the MGM
+    uint64_t mDropCalls {0}; ///< Number of calls to the MGM
+    uint64_t mDropFailed {0}; ///< Number of files whose confirmation failed
+  };
+
+  //----------------------------------------------------------------------------
+  //! Constructor
+  //!
+  //! @param unlink_func function unlinking a file
+  //! @param drop_func function confirming a batch of files to the MGM
+  //! @param num_workers number of unlinking threads
+  //! @param drop_batch max number of files confirmed per call to the MGM
+  //----------------------------------------------------------------------------
+  DeletionPipeline(UnlinkFunc unlink_func, DropFunc drop_func,
+                   unsigned int num_workers = 4, size_t drop_batch = 256);
+
+  //----------------------------------------------------------------------------
+  //! Destructor - stops after the deletions being processed, confirming the
+  //! files already unlinked. The files still queued are dropped, the MGM
+  //! schedules them again.
+  //----------------------------------------------------------------------------
+  ~DeletionPipeline();
+
+  //----------------------------------------------------------------------------
+  //! Don't allow copy or move of these objects
+  //----------------------------------------------------------------------------
+  DeletionPipeline(const DeletionPipeline&) = delete;
+  DeletionPipeline& operator =(const DeletionPipeline&) = delete;
+
+  //----------------------------------------------------------------------------
+  //! Queue a deletion
+  //!
+  //! @param del deletion object
+  //----------------------------------------------------------------------------
+  void Push(std::unique_ptr<Deletion> del);
+
+  //----------------------------------------------------------------------------
+  //! Wait until all the queued files are unlinked and confirmed to the MGM
+  //----------------------------------------------------------------------------
+  void WaitIdle();
+
+  //----------------------------------------------------------------------------
+  //! Get deletion statistics
+  //----------------------------------------------------------------------------
+  Stats GetStats() const;
+
+private:
+  //! Per worker queue of deletions
+  struct Worker {
+    std::deque<std::unique_ptr<Deletion>> mQueue;
+    std::condition_variable mCondVar;
+    std::thread mThread;
+  };
+
+  //! Unlinked files waiting for the confirmation, per file system
+  using DropBatches = std::map<unsigned long, std::vector<unsigned long long>>;
+
+  UnlinkFunc mUnlinkFunc;
+  DropFunc mDropFunc;
+  const size_t mDropBatch;
+  mutable std::mutex mMutex; ///< Mutex protecting the queues and statistics
+  std::condition_variable mCondVar; ///< Wake up WaitIdle
+  std::vector<std::unique_ptr<Worker>> mWorkers;
+  bool mStop {false};
+  Stats mStats;
+
+  //----------------------------------------------------------------------------
+  //! Unlink the files of a deletion, confirming every full batch
+  //----------------------------------------------------------------------------
+  void Process(const Deletion& del, DropBatches& batches);
+
+  //----------------------------------------------------------------------------
+  //! Confirm a batch of files to the MGM and clear it
+  //----------------------------------------------------------------------------
+  void Drop(unsigned long fsid, std::vector<unsigned long long>& fids);
+
+  //----------------------------------------------------------------------------
+  //! Worker thread loop
+  //----------------------------------------------------------------------------
+  void WorkerLoop(Worker& worker);
+};
+
+EOSFSTNAMESPACE_END
@@ -0,0 +1,326 @@
+//------------------------------------------------------------------------------
+//! @file FmdCommitQueue.cc
+//! @brief Group commit of file metadata updates to the local database
+//------------------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2023 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+#include "fst/utils/FmdCommitQueue.hh"
+#include "common/Logging.hh"
+#include <algorithm>
+#include <vector>
+
+EOSFSTNAMESPACE_BEGIN
+
+//! Back-off range of the writer thread after failed flushes
+static constexpr std::chrono::milliseconds sMinRetryDelay {100};
+static constexpr std::chrono::milliseconds sMaxRetryDelay {10000};
+
+//------------------------------------------------------------------------------
+// Constructor
+//------------------------------------------------------------------------------
+FmdCommitQueue::FmdCommitQueue(FlushFunc flush_func,
+                               std::chrono::milliseconds max_delay,
+                               size_t max_batch):
+  mFlushFunc(flush_func), mMaxDelay(max_delay),
+  mMaxBatch(std::max(max_batch, (size_t)1))
+{
+  mThread = std::thread(&FmdCommitQueue::WriterLoop, this);
+}
+
+//------------------------------------------------------------------------------
+// Destructor
+//------------------------------------------------------------------------------
+FmdCommitQueue::~FmdCommitQueue()
+{
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStop = true;
+  }
+  mCondVar.notify_all();
+  mThread.join();
+  FlushAll();
+
+  if (mNumPending) {
+    eos_static_crit("msg=\"dropping fmd records which could not be written\" "
+                    "num=%zu", mNumPending);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Queue the new value of a record
+//------------------------------------------------------------------------------
+void
+FmdCommitQueue::Put(fsid_t fsid, uint64_t fid, std::string&& value)
+{
+  Queue(fsid, fid, Update {false, std::move(value)});
+}
+
+//------------------------------------------------------------------------------
+// Queue the deletion of a record
+//------------------------------------------------------------------------------
+void
+FmdCommitQueue::Delete(fsid_t fsid, uint64_t fid)
+{
+  Queue(fsid, fid, Update {true, ""});
+}
+
+//------------------------------------------------------------------------------
+// Add an update to the queue
+//------------------------------------------------------------------------------
+void
+FmdCommitQueue::Queue(fsid_t fsid, uint64_t fid, Update&& update)
+{
+  bool notify = false;
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    Batch& batch = mPending[fsid];
+    auto it = batch.find(fid);
+
+    // Coalesce with an update still waiting for a flush
+    if (it != batch.end()) {
+      it->second = std::move(update);
+    } else {
+      batch.emplace(fid, std::move(update));
+      notify = ((++mNumPending == 1) || (mNumPending >= mMaxBatch));
+    }
+  }
+
+  if (notify) {
+    mCondVar.notify_one();
+  }
+}
+
+//------------------------------------------------------------------------------
+// Get a record not yet written to the database
+//------------------------------------------------------------------------------
+bool
+FmdCommitQueue::Get(fsid_t fsid, uint64_t fid, Update& update) const
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+
+  // The pending updates are more recent than the ones being written
+  for (const auto* updates : {
+         &mPending, &mInFlight
+       }) {
+    auto it_fs = updates->find(fsid);
+
+    if (it_fs != updates->end()) {
+      auto it = it_fs->second.find(fid);
+
+      if (it != it_fs->second.end()) {
+        update = it->second;
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+//------------------------------------------------------------------------------
+// Write the pending updates of a file system
+//------------------------------------------------------------------------------
+void
+FmdCommitQueue::Flush(fsid_t fsid)
+{
+  std::lock_guard<std::mutex> flush_lock(mFlushMutex);
+  DoFlush(fsid);
+}
+
+//------------------------------------------------------------------------------
+// Write the pending updates of all file systems
+//------------------------------------------------------------------------------
+void
+FmdCommitQueue::FlushAll()
+{
+  std::lock_guard<std::mutex> flush_lock(mFlushMutex);
+  std::vector<fsid_t> fsids;
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    for (const auto& elem : mPending) {
+      fsids.push_back(elem.first);
+    }
+  }
+
+  for (auto fsid : fsids) {
+    DoFlush(fsid);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Write the pending updates of the given file system
+//------------------------------------------------------------------------------
+void
+FmdCommitQueue::DoFlush(fsid_t fsid)
+{
+  Batch* batch = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto it = mPending.find(fsid);
+
+    if ((it == mPending.end()) || it->second.empty()) {
+      return;
+    }
+
+    // Updates stay visible to readers through mInFlight while being written
+    mNumPending -= it->second.size();
+    batch = &mInFlight[fsid];
+    batch->swap(it->second);
+    mPending.erase(it);
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  bool done = mFlushFunc(fsid, *batch);
+  double duration = std::chrono::duration<double, std::milli>
+                    (std::chrono::steady_clock::now() - start).count();
+  std::lock_guard<std::mutex> lock(mMutex);
+  FinishFlush(fsid, *batch, done, duration);
+  mInFlight.erase(fsid);
+}
+
+//------------------------------------------------------------------------------
+// Write the pending updates of a file system while holding the caller's lock
+//------------------------------------------------------------------------------
+bool
+FmdCommitQueue::FlushLocked(fsid_t fsid, const FlushFunc& flush_func)
+{
+  Batch batch;
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto it = mInFlight.find(fsid);
+
+    // Take over the batch of the writer thread, it can only be waiting for
+    // the caller's lock
+    if (it != mInFlight.end()) {
+      batch.swap(it->second);
+    }
+
+    auto it_pending = mPending.find(fsid);
+
+    if (it_pending != mPending.end()) {
+      mNumPending -= it_pending->second.size();
+
+      // The pending updates are more recent than the ones being written
+      for (auto& elem : it_pending->second) {
+        batch[elem.first] = std::move(elem.second);
+      }
+
+      mPending.erase(it_pending);
+    }
+  }
+
+  if (batch.empty()) {
+    return true;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  bool done = flush_func(fsid, batch);
+  double duration = std::chrono::duration<double, std::milli>
+                    (std::chrono::steady_clock::now() - start).count();
+  std::lock_guard<std::mutex> lock(mMutex);
+  FinishFlush(fsid, batch, done, duration);
+  return done;
+}
+
+//------------------------------------------------------------------------------
+// Account for a written batch
+//------------------------------------------------------------------------------
+void
+FmdCommitQueue::FinishFlush(fsid_t fsid, Batch& batch, bool done,
+                            double duration)
+{
+  if (done) {
+    mStats.mFlushed += batch.size();
+    mRetryDelay = std::chrono::milliseconds(0);
+  } else {
+    eos_static_err("msg=\"failed to write fmd batch, requeue\" fsid=%u "
+                   "size=%zu", fsid, batch.size());
+    mStats.mFailed += batch.size();
+    mRetryDelay = std::min(std::max(2 * mRetryDelay, sMinRetryDelay),
+                           sMaxRetryDelay);
+    Batch& pending = mPending[fsid];
+
+    // Updates queued in the meantime are more recent, keep them
+    for (auto& elem : batch) {
+      if (pending.emplace(elem.first, std::move(elem.second)).second) {
+        ++mNumPending;
+      }
+    }
+  }
+
+  batch.clear();
+  ++mStats.mFlushes;
+  mStats.mLastFlushMs = duration;
+  mStats.mMaxFlushMs = std::max(mStats.mMaxFlushMs, duration);
+  mStats.mAvgFlushMs += (duration - mStats.mAvgFlushMs) / mStats.mFlushes;
+}
+
+//------------------------------------------------------------------------------
+// Get queue and flush statistics
+//------------------------------------------------------------------------------
+FmdCommitQueue::Stats
+FmdCommitQueue::GetStats() const
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  Stats stats = mStats;
+  stats.mQueued = mNumPending;
+  return stats;
+}
+
+//------------------------------------------------------------------------------
+// Writer thread loop
+//------------------------------------------------------------------------------
+void
+FmdCommitQueue::WriterLoop()
+{
+  std::unique_lock<std::mutex> lock(mMutex);
+
+  while (!mStop) {
+    mCondVar.wait(lock, [&]() {
+      return mStop || mNumPending;
+    });
+    // Give other updates the chance to join the batch
+    mCondVar.wait_for(lock, mMaxDelay, [&]() {
+      return mStop || (mNumPending >= mMaxBatch);
+    });
+
+    if (mStop) {
+      break;
+    }
+
+    if (mRetryDelay.count()) {
+      // The last flush failed, give the database time to recover
+      mCondVar.wait_for(lock, mRetryDelay, [&]() {
+        return mStop;
+      });
+
+      if (mStop) {
+        break;
+      }
+    }
+
+    lock.unlock();
+    FlushAll();
+    lock.lock();
+  }
+}
+
+EOSFSTNAMESPACE_END
@@ -0,0 +1,197 @@
+//------------------------------------------------------------------------------
+//! @file FmdCommitQueue.hh
+//! @brief Group commit of file metadata updates to the local database
+//------------------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2023 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+#pragma once
+#include "fst/Namespace.hh"
+#include "common/FileSystem.hh"
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+EOSFSTNAMESPACE_BEGIN
+
+//------------------------------------------------------------------------------
+//! Class FmdCommitQueue - coalesces the updates of the file metadata records
+//! per file system and file id and hands them over in batches to a flush
+//! function which writes them to the local database. A batch is flushed at
+//! the latest after the configured delay or as soon as the number of queued
+//! records reaches the configured batch size. Until a record is written it
+//! is served from the in-memory overlay so that readers always see their
+//! own writes. Records of a failed flush are queued again, unless updated
+//! in the meantime, and the writer thread backs off before the next try.
+//------------------------------------------------------------------------------
+class FmdCommitQueue
+{
+public:
+  using fsid_t = eos::common::FileSystem::fsid_t;
+
+  //! Queued update of a record, either a new serialized value or a deletion
+  struct Update {
+    bool mDeleted;
+    std::string mValue;
+  };
+
+  //! Updates of one file system ordered by file id
+  using Batch = std::map<uint64_t, Update>;
+
+  //! Function writing a batch to the database, returns true if successful
+  using FlushFunc = std::function<bool(fsid_t, const Batch&)>;
+
+  //! Queue and flush statistics
+  struct Stats {
+    uint64_t mQueued {0}; ///< Number of records waiting to be written
+    uint64_t mFlushes {0}; ///< Number of batches written
+    uint64_t mFlushed {0}; ///< Number of records written
+    uint64_t mFailed {0}; ///< Number of records requeued by failed flushes
+    double mLastFlushMs {0}; ///< Duration of the last flush
+    double mAvgFlushMs {0}; ///< Average duration of a flush
+    double mMaxFlushMs {0}; ///< Maximum duration of a flush
+  };
+
+  //----------------------------------------------------------------------------
+  //! Constructor
+  //!
+  //! @param flush_func function writing a batch to the database
+  //! @param max_delay maximum time an update stays in the queue
+  //! @param max_batch number of queued records triggering a flush
+  //----------------------------------------------------------------------------
+  FmdCommitQueue(FlushFunc flush_func, std::chrono::milliseconds max_delay,
+                 size_t max_batch = 1024);
+
+  //----------------------------------------------------------------------------
+  //! Destructor - writes all the pending updates
+  //----------------------------------------------------------------------------
+  ~FmdCommitQueue();
+
+  //----------------------------------------------------------------------------
+  //! Queue the new value of a record
+  //!
+  //! @param fsid file system id
+  //! @param fid file id
+  //! @param value serialized record
+  //----------------------------------------------------------------------------
+  void Put(fsid_t fsid, uint64_t fid, std::string&& value);
+
+  //----------------------------------------------------------------------------
+  //! Queue the deletion of a record
+  //!
+  //! @param fsid file system id
+  //! @param fid file id
+  //----------------------------------------------------------------------------
+  void Delete(fsid_t fsid, uint64_t fid);
+
+  //----------------------------------------------------------------------------
+  //! Get a record not yet written to the database
+  //!
+  //! @param fsid file system id
+  //! @param fid file id
+  //! @param update queued update of the record
+  //!
+  //! @return true if there is a queued update, otherwise false and the
+  //!         database holds the latest value of the record
+  //----------------------------------------------------------------------------
+  bool Get(fsid_t fsid, uint64_t fid, Update& update) const;
+
+  //----------------------------------------------------------------------------
+  //! Write the pending updates of a file system, must be called without
+  //! holding any lock taken by the flush function
+  //!
+  //! @param fsid file system id
+  //----------------------------------------------------------------------------
+  void Flush(fsid_t fsid);
+
+  //----------------------------------------------------------------------------
+  //! Write the pending updates of all file systems
+  //----------------------------------------------------------------------------
+  void FlushAll();
+
+  //----------------------------------------------------------------------------
+  //! Write the pending updates of a file system with the given function,
+  //! including the ones the writer thread is about to write. Must be called
+  //! while holding a lock which excludes both the queuing of new updates and
+  //! the flush function of the writer thread, the latter then writes an
+  //! empty batch.
+  //!
+  //! @param fsid file system id
+  //! @param flush_func function writing the batch while the lock is held
+  //!
+  //! @return true if successful, otherwise false and the updates stay queued
+  //----------------------------------------------------------------------------
+  bool FlushLocked(fsid_t fsid, const FlushFunc& flush_func);
+
+  //----------------------------------------------------------------------------
+  //! Get queue and flush statistics
+  //----------------------------------------------------------------------------
+  Stats GetStats() const;
+
+private:
+  FlushFunc mFlushFunc;
+  const std::chrono::milliseconds mMaxDelay;
+  const size_t mMaxBatch;
+  mutable std::mutex mMutex; ///< Mutex protecting the maps and statistics
+  std::condition_variable mCondVar; ///< Wake up the writer thread
+  std::unordered_map<fsid_t, Batch> mPending; ///< Updates waiting for a flush
+  std::unordered_map<fsid_t, Batch> mInFlight; ///< Updates being written
+  size_t mNumPending {0}; ///< Number of updates in mPending
+  bool mStop {false};
+  //! Back-off of the writer thread after a failed flush
+  std::chrono::milliseconds mRetryDelay {0};
+  Stats mStats;
+  std::mutex mFlushMutex; ///< Serialize the flushes
+  std::thread mThread;
+
+  //----------------------------------------------------------------------------
+  //! Add an update to the queue
+  //----------------------------------------------------------------------------
+  void Queue(fsid_t fsid, uint64_t fid, Update&& update);
+
+  //----------------------------------------------------------------------------
+  //! Write the pending updates of the given file system
+  //!
+  //! @note must be called with the mFlushMutex locked
+  //----------------------------------------------------------------------------
+  void DoFlush(fsid_t fsid);
+
+  //----------------------------------------------------------------------------
+  //! Account for a written batch, requeue its updates if the write failed.
+  //! Must be called with the mMutex locked.
+  //!
+  //! @param fsid file system id
+  //! @param batch written batch, emptied
+  //! @param done true if the write was successful
+  //! @param duration duration of the write in milliseconds
+  //----------------------------------------------------------------------------
+  void FinishFlush(fsid_t fsid, Batch& batch, bool done, double duration);
+
+  //----------------------------------------------------------------------------
+  //! Writer thread loop
+  //----------------------------------------------------------------------------
+  void WriterLoop();
+};
+
+EOSFSTNAMESPACE_END
@@ -0,0 +1,395 @@
+//------------------------------------------------------------------------------
+//! @file ProcMetrics.cc
+//------------------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2023 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+#include "fst/utils/ProcMetrics.hh"
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+
+EOSFSTNAMESPACE_BEGIN
+
+//------------------------------------------------------------------------------
+//                              ProcFile Class
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+// Constructor
+//------------------------------------------------------------------------------
+ProcFile::ProcFile(const std::string& path,
+                   std::chrono::milliseconds refresh):
+  mPath(path), mRefresh(refresh)
+{}
+
+//------------------------------------------------------------------------------
+// Read the file if the refresh interval elapsed since the last read
+//------------------------------------------------------------------------------
+bool
+ProcFile::Refresh(bool force)
+{
+  auto now = std::chrono::steady_clock::now();
+
+  if (mValid && !force && (now - mLastRead < mRefresh)) {
+    return true;
+  }
+
+  mValid = ReadFile(mPath, mBuffer);
+  mLastRead = now;
+  return mValid;
+}
+
+//------------------------------------------------------------------------------
+// Read a whole file into the given buffer, reusing its capacity
+//------------------------------------------------------------------------------
+bool
+ProcFile::ReadFile(const std::string& path, std::string& buffer)
+{
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+  if (fd < 0) {
+    buffer.clear();
+    return false;
+  }
+
+  // The /proc files report a size of 0, grow the buffer until the whole
+  // content fits. The capacity is kept for the next read.
+  size_t len = 0;
+  buffer.resize(std::max(buffer.capacity(), (size_t) 4096));
+
+  while (true) {
+    ssize_t nread = read(fd, &buffer[len], buffer.size() - len);
+
+    if (nread < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+
+      len = 0;
+      break;
+    }
+
+    if (nread == 0) {
+      break;
+    }
+
+    len += nread;
+
+    if (len == buffer.size()) {
+      buffer.resize(2 * buffer.size());
+    }
+  }
+
+  (void) close(fd);
+  buffer.resize(len);
+  return (len != 0);
+}
+
+//------------------------------------------------------------------------------
+// Split a line into its whitespace separated fields
+//------------------------------------------------------------------------------
+void
+ProcFile::SplitFields(std::string_view line,
+                      std::vector<std::string_view>& fields)
+{
+  fields.clear();
+  size_t pos = 0;
+
+  while (true) {
+    pos = line.find_first_not_of(" \t", pos);
+
+    if (pos == std::string_view::npos) {
+      break;
+    }
+
+    size_t end = line.find_first_of(" \t", pos);
+
+    if (end == std::string_view::npos) {
+      end = line.length();
+    }
+
+    fields.push_back(line.substr(pos, end - pos));
+    pos = end;
+  }
+}
+
+//------------------------------------------------------------------------------
+// Get the next line of the content
+//------------------------------------------------------------------------------
+bool
+ProcFile::NextLine(std::string_view content, size_t& pos,
+                   std::string_view& line)
+{
+  if (pos >= content.length()) {
+    return false;
+  }
+
+  size_t end = content.find('\n', pos);
+
+  if (end == std::string_view::npos) {
+    end = content.length();
+  }
+
+  line = content.substr(pos, end - pos);
+  pos = end + 1;
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// Convert a field to an unsigned integer
+//------------------------------------------------------------------------------
+uint64_t
+ProcFile::ToUInt(std::string_view field)
+{
+  uint64_t value = 0;
+
+  for (const char c : field) {
+    if ((c < '0') || (c > '9')) {
+      return 0;
+    }
+
+    value = value * 10 + (c - '0');
+  }
+
+  return value;
+}
+
+//------------------------------------------------------------------------------
+//                              ProcMetrics Class
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+// Constructor
+//------------------------------------------------------------------------------
+ProcMetrics::ProcMetrics(const std::string& proc_root,
+                         const std::string& sys_root):
+  mSysRoot(sys_root),
+  mUptime(proc_root + "/uptime", std::chrono::seconds(30)),
+  mLoadAvg(proc_root + "/loadavg", std::chrono::seconds(30)),
+  mSockstat(proc_root + "/net/sockstat", std::chrono::seconds(10)),
+  mRoute(proc_root + "/net/route", std::chrono::minutes(5))
+{}
+
+//------------------------------------------------------------------------------
+// Get the uptime and load
+//------------------------------------------------------------------------------
+std::string
+ProcMetrics::GetUptime()
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+
+  if (!mUptime.Refresh() || !mLoadAvg.Refresh()) {
+    return "N/A";
+  }
+
+  std::string uptime = FormatUptime(mUptime.GetContent(), mLoadAvg.GetContent(),
+                                    time(nullptr));
+  return (uptime.empty() ? "N/A" : uptime);
+}
+
+//------------------------------------------------------------------------------
+// Get the number of TCP sockets
+//------------------------------------------------------------------------------
+uint64_t
+ProcMetrics::GetTcpSockets()
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+
+  if (!mSockstat.Refresh()) {
+    return 0;
+  }
+
+  return ParseTcpSockets(mSockstat.GetContent());
+}
+
+//------------------------------------------------------------------------------
+// Get the interface of the default route
+//------------------------------------------------------------------------------
+std::string
+ProcMetrics::GetDefaultInterface()
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+
+  if (!mRoute.Refresh()) {
+    return "";
+  }
+
+  return ParseDefaultInterface(mRoute.GetContent());
+}
+
+//------------------------------------------------------------------------------
+// Get the link speed of a network interface
+//------------------------------------------------------------------------------
+uint64_t
+ProcMetrics::GetLinkSpeed(const std::string& iface)
+{
+  std::string content;
+
+  if (iface.empty() || (iface.find('/') != std::string::npos) ||
+      !ProcFile::ReadFile(mSysRoot + "/class/net/" + iface + "/speed",
+                          content)) {
+    return 0;
+  }
+
+  // Value in Mbit/s, -1 if the link is down or the speed not reported
+  while (!content.empty() && (content.back() == '\n')) {
+    content.pop_back();
+  }
+
+  return ProcFile::ToUInt(content) * 1000000;
+}
+
+//------------------------------------------------------------------------------
+// Format the uptime and load the same way as the uptime command
+//------------------------------------------------------------------------------
+std::string
+ProcMetrics::FormatUptime(std::string_view uptime, std::string_view loadavg,
+                          time_t now)
+{
+  std::vector<std::string_view> fields;
+  size_t pos = 0;
+  std::string_view line;
+
+  if (!ProcFile::NextLine(uptime, pos, line)) {
+    return "";
+  }
+
+  ProcFile::SplitFields(line, fields);
+
+  if (fields.empty()) {
+    return "";
+  }
+
+  // Seconds with a fractional part e.g. 350735.47
+  uint64_t up_secs = ProcFile::ToUInt(fields[0].substr(0, fields[0].find('.')));
+  pos = 0;
+
+  if (!ProcFile::NextLine(loadavg, pos, line)) {
+    return "";
+  }
+
+  ProcFile::SplitFields(line, fields);
+
+  if (fields.size() < 3) {
+    return "";
+  }
+
+  double load[3];
+
+  for (int i = 0; i < 3; ++i) {
+    std::string value(fields[i]);
+    load[i] = strtod(value.c_str(), nullptr);
+  }
+
+  struct tm tm_now;
+  localtime_r(&now, &tm_now);
+  char buf[256];
+  int len = snprintf(buf, sizeof(buf), " %02d:%02d:%02d up ", tm_now.tm_hour,
+                     tm_now.tm_min, tm_now.tm_sec);
+  const uint64_t up_days = up_secs / 86400;
+  const uint64_t up_hours = (up_secs / 3600) % 24;
+  const uint64_t up_mins = (up_secs / 60) % 60;
+
+  if (up_days) {
+    len += snprintf(buf + len, sizeof(buf) - len, "%llu day%s, ",
+                    (unsigned long long) up_days, (up_days != 1) ? "s" : "");
+  }
+
+  if (up_hours) {
+    len += snprintf(buf + len, sizeof(buf) - len, "%2llu:%02llu, ",
+                    (unsigned long long) up_hours, (unsigned long long) up_mins);
+  } else {
+    len += snprintf(buf + len, sizeof(buf) - len, "%llu min, ",
+                    (unsigned long long) up_mins);
+  }
+
+  snprintf(buf + len, sizeof(buf) - len, " load average: %.2f, %.2f, %.2f",
+           load[0], load[1], load[2]);
+  return buf;
+}
+
+//------------------------------------------------------------------------------
+// Get the number of TCP sockets from the content of /proc/net/sockstat
+//------------------------------------------------------------------------------
+uint64_t
+ProcMetrics::ParseTcpSockets(std::string_view sockstat)
+{
+  // TCP: inuse 27 orphan 0 tw 3 alloc 30 mem 2
+  std::vector<std::string_view> fields;
+  std::string_view line;
+  size_t pos = 0;
+
+  while (ProcFile::NextLine(sockstat, pos, line)) {
+    ProcFile::SplitFields(line, fields);
+
+    if (fields.empty() || (fields[0] != "TCP:")) {
+      continue;
+    }
+
+    uint64_t count = 0;
+
+    for (size_t i = 1; i + 1 < fields.size(); i += 2) {
+      if ((fields[i] == "inuse") || (fields[i] == "tw")) {
+        count += ProcFile::ToUInt(fields[i + 1]);
+      }
+    }
+
+    return count;
+  }
+
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+// Get the default route interface from the content of /proc/net/route
+//------------------------------------------------------------------------------
+std::string
+ProcMetrics::ParseDefaultInterface(std::string_view route)
+{
+  // Iface Destination Gateway Flags RefCnt Use Metric Mask ...
+  std::vector<std::string_view> fields;
+  std::string_view line;
+  std::string iface;
+  uint64_t min_metric = UINT64_MAX;
+  size_t pos = 0;
+
+  while (ProcFile::NextLine(route, pos, line)) {
+    ProcFile::SplitFields(line, fields);
+
+    if ((fields.size() < 8) || (fields[1] != "00000000") ||
+        (fields[7] != "00000000")) {
+      continue;
+    }
+
+    uint64_t metric = ProcFile::ToUInt(fields[6]);
+
+    if (metric < min_metric) {
+      min_metric = metric;
+      iface = fields[0];
+    }
+  }
+
+  return iface;
+}
+
+EOSFSTNAMESPACE_END
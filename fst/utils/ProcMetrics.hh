@@ -0,0 +1,189 @@
+//------------------------------------------------------------------------------
+//! @file ProcMetrics.hh
+//! @brief Node metrics parsed directly from /proc instead of shell commands
+//------------------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2023 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+#pragma once
+#include "fst/Namespace.hh"
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+EOSFSTNAMESPACE_BEGIN
+
+//------------------------------------------------------------------------------
+//! Class ProcFile - content of a /proc or /sys file read in one go into a
+//! buffer which is kept across the reads, so that refreshing it does not
+//! allocate once the buffer has grown to the size of the file. The content is
+//! read again only after the refresh interval elapsed.
+//------------------------------------------------------------------------------
+class ProcFile
+{
+public:
+  //----------------------------------------------------------------------------
+  //! Constructor
+  //!
+  //! @param path file path
+  //! @param refresh min interval between two reads of the file
+  //----------------------------------------------------------------------------
+  ProcFile(const std::string& path, std::chrono::milliseconds refresh);
+
+  //----------------------------------------------------------------------------
+  //! Read the file if the refresh interval elapsed since the last read
+  //!
+  //! @param force read the file anyway
+  //!
+  //! @return true if the content is available, otherwise false
+  //----------------------------------------------------------------------------
+  bool Refresh(bool force = false);
+
+  //----------------------------------------------------------------------------
+  //! Get the content of the last successful read
+  //----------------------------------------------------------------------------
+  const std::string& GetContent() const
+  {
+    return mBuffer;
+  }
+
+  //----------------------------------------------------------------------------
+  //! Read a whole file into the given buffer, reusing its capacity
+  //!
+  //! @param path file path
+  //! @param buffer filled with the file content
+  //!
+  //! @return true if successful, otherwise false
+  //----------------------------------------------------------------------------
+  static bool ReadFile(const std::string& path, std::string& buffer);
+
+  //----------------------------------------------------------------------------
+  //! Split a line into its whitespace separated fields
+  //!
+  //! @param line line to split
+  //! @param fields filled with views into the line, cleared first
+  //----------------------------------------------------------------------------
+  static void SplitFields(std::string_view line,
+                          std::vector<std::string_view>& fields);
+
+  //----------------------------------------------------------------------------
+  //! Get the next line of the content
+  //!
+  //! @param content file content
+  //! @param pos start of the line, moved to the start of the next one
+  //! @param line set to the line without the trailing newline
+  //!
+  //! @return true if there was a line left, otherwise false
+  //----------------------------------------------------------------------------
+  static bool NextLine(std::string_view content, size_t& pos,
+                       std::string_view& line);
+
+  //----------------------------------------------------------------------------
+  //! Convert a field to an unsigned integer, 0 if not a number
+  //----------------------------------------------------------------------------
+  static uint64_t ToUInt(std::string_view field);
+
+private:
+  std::string mPath;
+  std::chrono::milliseconds mRefresh;
+  std::chrono::steady_clock::time_point mLastRead;
+  bool mValid {false}; ///< Mark if the buffer holds the file content
+  std::string mBuffer;
+};
+
+//------------------------------------------------------------------------------
+//! Class ProcMetrics - node metrics published by the FST, collected from /proc
+//! and /sys. Every source has its own refresh interval so that publishing
+//! more often does not mean parsing more often.
+//------------------------------------------------------------------------------
+class ProcMetrics
+{
+public:
+  //----------------------------------------------------------------------------
+  //! Constructor
+  //!
+  //! @param proc_root mount point of procfs, changed only by the tests
+  //! @param sys_root mount point of sysfs, changed only by the tests
+  //----------------------------------------------------------------------------
+  ProcMetrics(const std::string& proc_root = "/proc",
+              const std::string& sys_root = "/sys");
+
+  //----------------------------------------------------------------------------
+  //! Get the uptime and load in the format of the uptime command without the
+  //! number of users e.g. " 21:54:52 up 2 days, 12:20,  load average: 0.00,
+  //! 0.01, 0.05"
+  //----------------------------------------------------------------------------
+  std::string GetUptime();
+
+  //----------------------------------------------------------------------------
+  //! Get the number of IPv4 TCP sockets, including the ones in TIME_WAIT
+  //! i.e. the entries of /proc/net/tcp
+  //----------------------------------------------------------------------------
+  uint64_t GetTcpSockets();
+
+  //----------------------------------------------------------------------------
+  //! Get the interface of the default route, empty if there is none
+  //----------------------------------------------------------------------------
+  std::string GetDefaultInterface();
+
+  //----------------------------------------------------------------------------
+  //! Get the link speed of a network interface
+  //!
+  //! @param iface interface name
+  //!
+  //! @return speed in bits per second, 0 if unknown
+  //----------------------------------------------------------------------------
+  uint64_t GetLinkSpeed(const std::string& iface);
+
+  //----------------------------------------------------------------------------
+  //! Format the uptime and load the same way as the uptime command
+  //!
+  //! @param uptime content of /proc/uptime
+  //! @param loadavg content of /proc/loadavg
+  //! @param now current time
+  //!
+  //! @return formatted string, empty if the input can not be parsed
+  //----------------------------------------------------------------------------
+  static std::string FormatUptime(std::string_view uptime,
+                                  std::string_view loadavg, time_t now);
+
+  //----------------------------------------------------------------------------
+  //! Get the number of TCP sockets from the content of /proc/net/sockstat
+  //----------------------------------------------------------------------------
+  static uint64_t ParseTcpSockets(std::string_view sockstat);
+
+  //----------------------------------------------------------------------------
+  //! Get the default route interface from the content of /proc/net/route
+  //----------------------------------------------------------------------------
+  static std::string ParseDefaultInterface(std::string_view route);
+
+private:
+  std::string mSysRoot;
+  std::mutex mMutex; ///< Mutex protecting the sources
+  ProcFile mUptime;
+  ProcFile mLoadAvg;
+  ProcFile mSockstat;
+  ProcFile mRoute;
+};
+
+EOSFSTNAMESPACE_END
@@ -0,0 +1,107 @@
+//------------------------------------------------------------------------------
+//! @file ReadVExtents.hh
+//! @brief Merge the chunks of a vector read into extents read in one go
+//------------------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2023 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+#pragma once
+#include "fst/Namespace.hh"
+#include "XrdOuc/XrdOucIOVec.hh"
+#include <sys/types.h>
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+EOSFSTNAMESPACE_BEGIN
+
+//------------------------------------------------------------------------------
+//! Contiguous file region covering one or more chunks of a vector read
+//------------------------------------------------------------------------------
+struct ReadVExtent {
+  off_t mOffset;
+  size_t mLength;
+  std::vector<int> mChunks; ///< Indices of the chunks, by increasing offset
+};
+
+//------------------------------------------------------------------------------
+//! Merge the chunks of a vector read into extents. Chunks are merged if the
+//! gap between them is small enough for reading it to be cheaper than an
+//! extra request. Overlapping chunks are never merged as they can not be
+//! scattered by a single preadv. Empty chunks are skipped.
+//!
+//! @param readV chunks of the vector read
+//! @param n number of chunks
+//! @param max_gap max number of bytes between merged chunks
+//! @param max_len max extent length, larger single chunks form their own
+//!        extent
+//! @param max_chunks max number of chunks per extent
+//! @param align extents are aligned to multiples of this value e.g. for the
+//!        block checksums
+//!
+//! @return extents by increasing offset
+//------------------------------------------------------------------------------
+inline std::vector<ReadVExtent>
+MergeReadV(const XrdOucIOVec* readV, int n, size_t max_gap, size_t max_len,
+           size_t max_chunks, uint64_t align = 1)
+{
+  std::vector<int> order;
+  order.reserve(n);
+
+  for (int i = 0; i < n; ++i) {
+    if (readV[i].size > 0) {
+      order.push_back(i);
+    }
+  }
+
+  std::stable_sort(order.begin(), order.end(), [&](int lhs, int rhs) {
+    return readV[lhs].offset < readV[rhs].offset;
+  });
+  std::vector<ReadVExtent> extents;
+  off_t last_end = 0; // end of the last chunk of the current extent
+
+  for (int idx : order) {
+    const off_t beg = readV[idx].offset;
+    const off_t end = beg + readV[idx].size;
+    const off_t align_beg = (beg / align) * align;
+    const off_t align_end = ((end + align - 1) / align) * align;
+
+    if (!extents.empty()) {
+      ReadVExtent& cur = extents.back();
+      const off_t cur_end = cur.mOffset + cur.mLength;
+
+      if ((beg >= last_end) &&
+          (align_beg <= cur_end + (off_t) max_gap) &&
+          (std::max(align_end, cur_end) - cur.mOffset <= (off_t) max_len) &&
+          (cur.mChunks.size() < max_chunks)) {
+        cur.mLength = std::max(align_end, cur_end) - cur.mOffset;
+        cur.mChunks.push_back(idx);
+        last_end = end;
+        continue;
+      }
+    }
+
+    extents.push_back({align_beg, (size_t)(align_end - align_beg), {idx}});
+    last_end = end;
+  }
+
+  return extents;
+}
+
+EOSFSTNAMESPACE_END
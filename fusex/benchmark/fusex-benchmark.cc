@@ -10,6 +10,8 @@
 #include <vector>
 #include <string>
 #include <set>
+#include <thread>
+#include <atomic>
 
 #include "common/Timing.hh"
 #include "common/ShellCmd.hh"
@@ -32,6 +34,8 @@
 #define LOOP_18 100
 #define LOOP_19 100
 #define LOOP_20 10
+#define LOOP_21 100
+#define FILES_21 1000
 
 int main(int argc, char* argv[])
 {
@@ -41,6 +45,8 @@ int main(int argc, char* argv[])
   int testno = 0;
   int test_start = (argc > 1) ? atoi(argv[1]) : 0;
   int test_stop = (argc > 2) ? atoi(argv[2]) : 999999;
+  size_t max_threads = (argc > 3) ? atoi(argv[3]) :
+                       std::thread::hardware_concurrency();
   // ------------------------------------------------------------------------ //
   testno = 1;
   COMMONTIMING("test-start", &tm);
@@ -886,6 +892,94 @@ int main(int argc, char* argv[])
     COMMONTIMING("version-rename-loop", &tm);
   }
 
+  // ------------------------------------------------------------------------ //
+  testno = 21;
+
+  if ((testno >= test_start) && (testno <= test_stop)) {
+    fprintf(stderr, ">>> test %04d\n", testno);
+
+    if (mkdir("test-md-scaling", S_IRWXU)) {
+      fprintf(stderr, "[test=%03d] mkdir failed errno=%d\n", testno, errno);
+      exit(testno);
+    }
+
+    for (size_t i = 0; i < FILES_21; i++) {
+      snprintf(name, sizeof(name), "test-md-scaling/f-%05lu", i);
+      int fd = creat(name, S_IRWXU);
+
+      if (fd < 0) {
+        fprintf(stderr, "[test=%03d] creat failed i=%lu\n", testno, i);
+        exit(testno);
+      }
+
+      close(fd);
+    }
+
+    // measure stat/opendir throughput with an increasing number of threads
+    for (size_t nthreads = 1; nthreads <= (max_threads ? max_threads : 1);
+         nthreads *= 2) {
+      std::atomic<size_t> errors {0};
+      std::vector<std::thread> workers;
+      eos::common::Timing ttm("md-scaling");
+      COMMONTIMING("start", &ttm);
+
+      for (size_t t = 0; t < nthreads; t++) {
+        workers.emplace_back([t, &errors]() {
+          char fname[1024];
+          struct stat sbuf;
+
+          for (size_t l = 0; l < LOOP_21; l++) {
+            for (size_t i = 0; i < FILES_21; i++) {
+              // every thread starts at a different offset
+              snprintf(fname, sizeof(fname), "test-md-scaling/f-%05lu",
+                       (i + t * 997) % FILES_21);
+
+              if (stat(fname, &sbuf)) {
+                errors++;
+              }
+            }
+
+            if (stat("test-md-scaling", &sbuf)) {
+              errors++;
+            }
+          }
+        });
+      }
+
+      for (auto& w : workers) {
+        w.join();
+      }
+
+      COMMONTIMING("stop", &ttm);
+
+      if (errors) {
+        fprintf(stderr, "[test=%03d] stat failed errors=%lu\n", testno,
+                errors.load());
+        exit(testno);
+      }
+
+      double ops = 1.0 * nthreads * LOOP_21 * (FILES_21 + 1);
+      fprintf(stdout, "md-scaling threads=%03lu ops=%.0f rate=%.02f ops/s\n",
+              nthreads, ops, ops / (ttm.RealTime() / 1000.0));
+    }
+
+    for (size_t i = 0; i < FILES_21; i++) {
+      snprintf(name, sizeof(name), "test-md-scaling/f-%05lu", i);
+
+      if (unlink(name)) {
+        fprintf(stderr, "[test=%03d] unlink failed i=%lu\n", testno, i);
+        exit(testno);
+      }
+    }
+
+    if (rmdir("test-md-scaling")) {
+      fprintf(stderr, "[test=%03d] rmdir failed errno=%d\n", testno, errno);
+      exit(testno);
+    }
+
+    COMMONTIMING("md-scaling-loop", &tm);
+  }
+
   tm.Print();
   fprintf(stdout, "realtime = %.02f\n", tm.RealTime());
 }
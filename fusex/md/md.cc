@@ -80,8 +80,9 @@ metad::init(backend* _mdbackend)
   std::string mdstream;
   // load the root node
   fuse_req_t req = 0;
-  XrdSysMutexHelper mLock(mdmap);
-  update(req, mdmap[1], "", true);
+  shared_md root;
+  mdmap.retrieveTS(1, root);
+  update(req, root, "", true);
   mdmap.init(EosFuse::Instance().getKV());
   dentrymessaging = false;
   writesizeflush = false;
@@ -1816,8 +1817,7 @@ metad::apply(fuse_req_t req, eos::fusex::container& cont, bool listing)
     md->Locker().UnLock();
 
     if (is_new) {
-      XrdSysMutexHelper mLock(mdmap);
-      mdmap[ino] = md;
+      mdmap.insertTS(ino, md);
       stat.inodes_inc();
       stat.inodes_ever_inc();
     }
@@ -2331,57 +2331,18 @@ metad::mdstackfree(ThreadAssistant& assistant)
 
     // do this ~every 128 seconds
     if (!(cnt % 256)) {
-      XrdSysMutexHelper mLock(mdmap);
+      size_t n_removed = mdmap.cleanTS([this](fuse_ino_t ino) {
+        return (has_flush(ino) || EosFuse::Instance().datas.has(ino));
+      });
 
-      for (auto it = mdmap.begin(); it != mdmap.end();) {
-        if (!it->second) {
-          it++;
-          continue;
-        }
-
-        // if the parent is gone, we can remove the child
-        if ((!mdmap.count(it->second->pid())) &&
-            (!S_ISDIR(it->second->mode()) || it->second->deleted())) {
-          eos_static_debug("removing orphaned inode from mdmap ino=%#lx path=%s",
-                           it->first, it->second->fullpath().c_str());
-          mdmap.lru_remove(it->first);
-          it = mdmap.erase(it);
-          stat.inodes_dec();
-        } else {
-          if (it->second->deleted()) {
-            if ( (!has_flush(it->first)) &&
-		 (!EosFuse::Instance().datas.has(it->first)) ) {
-              eos_static_debug("removing deleted inode from mdmap ino=%#lx path=%s",
-                               it->first, it->second->fullpath().c_str());
-              mdmap.lru_remove(it->first);
-              it = mdmap.erase(it);
-              stat.inodes_dec();
-            } else {
-              it++;
-            }
-          } else {
-            it++;
-          }
-        }
+      for (size_t i = 0; i < n_removed; ++i) {
+        stat.inodes_dec();
       }
     }
 
     if (!EosFuse::Instance().Config().mdcachedir.empty()) {
       // level the inodes stored in memory and eventually swap out into kv store
       int swap_out_inodes = 0 ;
-      size_t filled = 0;
-      size_t empty = 0;
-      {
-        XrdSysMutexHelper mLock(mdmap);
-
-        for (auto it = mdmap.begin(); it != mdmap.end(); ++it) {
-          if (it->second) {
-            filled++;
-          } else {
-            empty++;
-          }
-        }
-      }
 
       do {
         swap_out_inodes = mdmap.sizeTS() - max_inodes -
@@ -2389,51 +2350,12 @@ metad::mdstackfree(ThreadAssistant& assistant)
 
         if (swap_out_inodes > 0) {
           eos_static_info("swap-out %d inodes", swap_out_inodes);
-          // grab the last lru inode and swap out
-          mdmap.Lock();
-          mdmap.lru_dump();
-          uint64_t inode_to_swap = mdmap.lru_oldest();
-
-          if (!inode_to_swap) {
-            // nothing in the lru list anymore
-            mdmap.UnLock();
-            break;
-          }
 
-          if (mdmap.count(inode_to_swap)) {
-            shared_md md = mdmap[inode_to_swap];
-
-            if ((md.use_count() > 2) ||
-                (md && md->LockTable().size())) {
-              eos_static_info("swap-out skipping referenced ino=%#llx ref-count=%lu\n",
-                              inode_to_swap,
-                              md.use_count());
-
-              if (md) {
-                mdmap.lru_update(inode_to_swap, md);
-              }
-
-              mdmap.UnLock();
-              continue;
-            }
-
-            mdmap.lru_remove(inode_to_swap);
-
-            if (md) {
-              eos_static_info("swap-out lru-removed ino=%#llx oldest=%#llx", inode_to_swap,
-                              mdmap.lru_oldest());
-	      mdmap.lru_remove(inode_to_swap);
-              mdmap[inode_to_swap] = 0;
-
-              if (mdmap.swap_out(md)) {
-                eos_static_err("swap-out failed for ino=%#llx", inode_to_swap);
-              }
-            }
-          } else {
-            mdmap.lru_remove(inode_to_swap);
+          // grab the oldest lru inode of the next shard and swap out
+          if (mdmap.swap_out_lru() == pmap::SWAP_EMPTY) {
+            // nothing in the lru lists anymore
+            break;
           }
-
-          mdmap.UnLock();
         }
       } while ((swap_out_inodes > 0) &&
                (!assistant.terminationRequested()));
@@ -2764,119 +2686,136 @@ metad::mdcommunicate(ThreadAssistant& assistant)
             if (rsp.type() == rsp.DENTRY) {
               uint64_t md_ino = rsp.dentry_().md_ino();
               std::string authid = rsp.dentry_().authid();
-              std::string name = rsp.dentry_().name();
+              // a batched message carries further names of the same directory
+              std::vector<std::string> names {rsp.dentry_().name()};
+              names.insert(names.end(), rsp.dentry_().names().begin(),
+                           rsp.dentry_().names().end());
               uint64_t ino = inomap.forward(md_ino);
 
               if (rsp.dentry_().type() == rsp.dentry_().ADD) {
               } else if (rsp.dentry_().type() == rsp.dentry_().REMOVE) {
-                eos_static_notice("remove-dentry: remote-ino=%#lx ino=%#lx clientid=%s authid=%s name=%s",
-                                  md_ino, ino, rsp.lease_().clientid().c_str(), authid.c_str(), name.c_str());
+                for (const auto& name : names) {
+                  eos_static_notice("remove-dentry: remote-ino=%#lx ino=%#lx clientid=%s authid=%s name=%s",
+                                    md_ino, ino, rsp.lease_().clientid().c_str(), authid.c_str(), name.c_str());
 
-                // remove directory entry
-                if (EosFuse::Instance().Config().options.md_kernelcache) {
-                  kernelcache::inval_entry(ino, name);
-                }
+                  // remove directory entry
+                  if (EosFuse::Instance().Config().options.md_kernelcache) {
+                    kernelcache::inval_entry(ino, name);
+                  }
 
-                shared_md pmd;
+                  shared_md pmd;
 
-                if (ino && mdmap.retrieveTS(ino, pmd)) {
-                  XrdSysMutexHelper mLock(pmd->Locker());
+                  if (ino && mdmap.retrieveTS(ino, pmd)) {
+                    XrdSysMutexHelper mLock(pmd->Locker());
 
-                  if (pmd->local_children().count(
-                        eos::common::StringConversion::EncodeInvalidUTF8(name))) {
-                    pmd->local_children().erase(eos::common::StringConversion::EncodeInvalidUTF8(
+                    if (pmd->local_children().count(
+                          eos::common::StringConversion::EncodeInvalidUTF8(name))) {
+                      pmd->local_children().erase(eos::common::StringConversion::EncodeInvalidUTF8(
+                                                    name));
+                      pmd->get_todelete().erase(eos::common::StringConversion::EncodeInvalidUTF8(
                                                   name));
-                    pmd->get_todelete().erase(eos::common::StringConversion::EncodeInvalidUTF8(
-                                                name));
-                    pmd->set_nchildren(pmd->nchildren() - 1);
+                      pmd->set_nchildren(pmd->nchildren() - 1);
+                    }
                   }
                 }
               }
             }
 
             if (rsp.type() == rsp.REFRESH) {
-              uint64_t md_ino = rsp.refresh_().md_ino();
-              uint64_t ino = inomap.forward(md_ino);
-              mode_t mode = 0;
-              eos_static_notice("refresh-dentry: remote-ino=%#lx ino=%#lx",
-                                md_ino, ino);
-              shared_md md;
+              // a batched message carries further inodes
+              std::vector<uint64_t> md_inos {rsp.refresh_().md_ino()};
+              md_inos.insert(md_inos.end(), rsp.refresh_().md_inos().begin(),
+                             rsp.refresh_().md_inos().end());
+
+              for (uint64_t md_ino : md_inos) {
+                uint64_t ino = inomap.forward(md_ino);
+                mode_t mode = 0;
+                eos_static_notice("refresh-dentry: remote-ino=%#lx ino=%#lx",
+                                  md_ino, ino);
+                shared_md md;
 
-              // force meta data refresh
-              if (ino && mdmap.retrieveTS(ino, md)) {
-                XrdSysMutexHelper mLock(md->Locker());
-                md->force_refresh();
-                mode = md->mode();
-              }
+                // force meta data refresh
+                if (ino && mdmap.retrieveTS(ino, md)) {
+                  XrdSysMutexHelper mLock(md->Locker());
+                  md->force_refresh();
+                  mode = md->mode();
+                }
 
-              if (EOS_LOGS_DEBUG) {
-                eos_static_debug("%s", dump_md(md).c_str());
-              }
+                if (EOS_LOGS_DEBUG) {
+                  eos_static_debug("%s", dump_md(md).c_str());
+                }
 
-              if (EosFuse::Instance().Config().options.md_kernelcache) {
-                eos_static_info("invalidate metadata cache for ino=%#lx", ino);
-                kernelcache::inval_inode(ino, S_ISDIR(mode) ? false : true);
+                if (EosFuse::Instance().Config().options.md_kernelcache) {
+                  eos_static_info("invalidate metadata cache for ino=%#lx", ino);
+                  kernelcache::inval_inode(ino, S_ISDIR(mode) ? false : true);
+                }
               }
             }
 
             if (rsp.type() == rsp.LEASE) {
-              uint64_t md_ino = rsp.lease_().md_ino();
-              std::string authid = rsp.lease_().authid();
-              uint64_t ino = inomap.forward(md_ino);
-              eos_static_notice("lease: remote-ino=%#lx ino=%#lx clientid=%s authid=%s",
-                                md_ino, ino, rsp.lease_().clientid().c_str(), authid.c_str());
-              shared_md check_md;
-
-              if (ino && mdmap.retrieveTS(ino, check_md)) {
-                std::string capid = cap::capx::capid(ino, rsp.lease_().clientid());
-
-                // wait that the inode is flushed out of the mdqueue
-                do {
-                  mdflush.Lock();
-
-                  if (mdqueue.count(ino)) {
-                    mdflush.UnLock();
-                    eos_static_info("lease: delaying cap-release remote-ino=%#lx ino=%#lx clientid=%s authid=%s",
-                                    md_ino, ino, rsp.lease_().clientid().c_str(), authid.c_str());
-                    std::this_thread::sleep_for(std::chrono::milliseconds(25));
-
-                    if (assistant.terminationRequested()) {
-                      return;
+              // a batched message carries further inodes
+              std::vector<uint64_t> md_inos {rsp.lease_().md_ino()};
+              md_inos.insert(md_inos.end(), rsp.lease_().md_inos().begin(),
+                             rsp.lease_().md_inos().end());
+
+              for (uint64_t md_ino : md_inos) {
+                std::string authid = rsp.lease_().authid();
+                uint64_t ino = inomap.forward(md_ino);
+                eos_static_notice("lease: remote-ino=%#lx ino=%#lx clientid=%s authid=%s",
+                                  md_ino, ino, rsp.lease_().clientid().c_str(), authid.c_str());
+                shared_md check_md;
+
+                if (ino && mdmap.retrieveTS(ino, check_md)) {
+                  std::string capid = cap::capx::capid(ino, rsp.lease_().clientid());
+
+                  // wait that the inode is flushed out of the mdqueue
+                  do {
+                    mdflush.Lock();
+
+                    if (mdqueue.count(ino)) {
+                      mdflush.UnLock();
+                      eos_static_info("lease: delaying cap-release remote-ino=%#lx ino=%#lx clientid=%s authid=%s",
+                                      md_ino, ino, rsp.lease_().clientid().c_str(), authid.c_str());
+                      std::this_thread::sleep_for(std::chrono::milliseconds(25));
+
+                      if (assistant.terminationRequested()) {
+                        return;
+                      }
+                    } else {
+                      mdflush.UnLock();
+                      break;
                     }
-                  } else {
-                    mdflush.UnLock();
-                    break;
-                  }
-                } while (1);
+                  } while (1);
 
-                eos_static_debug("");
-                fuse_ino_t ino = EosFuse::Instance().getCap().forget(capid);
-                shared_md md;
+                  eos_static_debug("");
+                  fuse_ino_t ino = EosFuse::Instance().getCap().forget(capid);
+                  shared_md md;
 
-                if (mdmap.retrieveTS(ino, md)) {
-                  md->Locker().Lock();
-                }
+                  if (mdmap.retrieveTS(ino, md)) {
+                    md->Locker().Lock();
+                  }
 
-                // invalidate children
-                if (md) {
-                  if (md->id()) {
-                    // force an update of the metadata with next access
-                    eos_static_info("md=%16x", md->id());
-                    cleanup(md);
+                  // invalidate children
+                  if (md) {
+                    if (md->id()) {
+                      // force an update of the metadata with next access
+                      eos_static_info("md=%16x", md->id());
+                      cleanup(md);
 
-                    if (EOS_LOGS_DEBUG) {
-                      eos_static_debug("%s", dump_md(md).c_str());
+                      if (EOS_LOGS_DEBUG) {
+                        eos_static_debug("%s", dump_md(md).c_str());
+                      }
+                    } else {
+                      md->Locker().UnLock();
                     }
-                  } else {
-                    md->Locker().UnLock();
                   }
+                } else {
+                  // there might have been several caps and the first has wiped already the MD,
+                  // still we want to remove the cap entry
+                  std::string capid = cap::capx::capid(ino, rsp.lease_().clientid());
+                  eos_static_debug("");
+                  EosFuse::Instance().getCap().forget(capid);
                 }
-              } else {
-                // there might have been several caps and the first has wiped already the MD,
-                // still we want to remove the cap entry
-                std::string capid = cap::capx::capid(ino, rsp.lease_().clientid());
-                eos_static_debug("");
-                EosFuse::Instance().getCap().forget(capid);
               }
             }
 
@@ -3236,18 +3175,20 @@ metad::vmap::backward(fuse_ino_t lookup)
 
 
 /* -------------------------------------------------------------------------- */
-size_t
-metad::pmap::sizeTS()
+static metad::shared_md
+lru_entry(metad::pmap::shard& s, uint64_t ino)
 {
-  XrdSysMutexHelper mLock(this);
-  return size();
+  // lookup without creating an entry - needs the shard lock
+  auto it = s.map.find(ino);
+  return (it == s.map.end()) ? metad::shared_md() : it->second;
 }
 
 /* -------------------------------------------------------------------------- */
 bool
 metad::pmap::retrieveOrCreateTS(fuse_ino_t ino, shared_md& ret)
 {
-  XrdSysMutexHelper mLock(this);
+  shard& s = get_shard(ino);
+  XrdSysMutexHelper mLock(s);
 
   if (this->retrieve(ino, ret)) {
     return false;
@@ -3256,7 +3197,7 @@ metad::pmap::retrieveOrCreateTS(fuse_ino_t ino, shared_md& ret)
   ret = std::make_shared<mdx>();
 
   if (ino) {
-    (*this)[ino] = ret;
+    set(s, ino, ret);
   }
 
   return true;
@@ -3266,17 +3207,27 @@ metad::pmap::retrieveOrCreateTS(fuse_ino_t ino, shared_md& ret)
 bool
 metad::pmap::retrieveTS(fuse_ino_t ino, shared_md& ret)
 {
-  XrdSysMutexHelper mLock(this);
+  XrdSysMutexHelper mLock(get_shard(ino));
   return this->retrieve(ino, ret);
 }
 
+/* -------------------------------------------------------------------------- */
+bool
+metad::pmap::countTS(fuse_ino_t ino)
+{
+  shard& s = get_shard(ino);
+  XrdSysMutexHelper mLock(s);
+  return s.map.count(ino);
+}
+
 /* -------------------------------------------------------------------------- */
 bool
 metad::pmap::retrieve(fuse_ino_t ino, shared_md& ret)
 {
-  auto it = this->find(ino);
+  shard& s = get_shard(ino);
+  auto it = s.map.find(ino);
 
-  if (it == this->end()) {
+  if (it == s.map.end()) {
     if (!ret) {
       ret = std::make_shared<mdx>();
       ret->set_err(ENOENT);
@@ -3298,7 +3249,7 @@ metad::pmap::retrieve(fuse_ino_t ino, shared_md& ret)
     }
 
     // attach the new object
-    (*this)[ino] = ret;
+    it->second = ret;
     // add to the lru list
     lru_add(ino, ret);
   }
@@ -3308,11 +3259,150 @@ metad::pmap::retrieve(fuse_ino_t ino, shared_md& ret)
   return true;
 }
 
+/* -------------------------------------------------------------------------- */
+void
+metad::pmap::resetTS(fuse_ino_t keep_ino)
+{
+  // lock all shards in ascending order
+  for (size_t i = 0; i < kShards; ++i) {
+    mShards[i].Lock();
+  }
+
+  shard& ks = get_shard(keep_ino);
+  shared_md keep = lru_entry(ks, keep_ino);
+
+  for (size_t i = 0; i < kShards; ++i) {
+    mShards[i].map.clear();
+    mShards[i].lru_first = 0;
+    mShards[i].lru_last = 0;
+  }
+
+  mSize = 0;
+
+  if (keep) {
+    set(ks, keep_ino, keep);
+  }
+
+  for (size_t i = kShards; i > 0; --i) {
+    mShards[i - 1].UnLock();
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+size_t
+metad::pmap::cleanTS(std::function<bool(fuse_ino_t)> keep)
+{
+  size_t n_removed = 0;
+
+  for (size_t i = 0; i < kShards; ++i) {
+    shard& s = mShards[i];
+    std::vector<std::pair<fuse_ino_t, shared_md>> candidates;
+    {
+      XrdSysMutexHelper mLock(s);
+
+      for (auto it = s.map.begin(); it != s.map.end(); ++it) {
+        if (it->second) {
+          candidates.emplace_back(it->first, it->second);
+        }
+      }
+    }
+
+    // the parent lookup takes another shard lock, so this is done outside
+    // of the scanned shard lock and the entry is re-validated before removal
+    for (auto& c : candidates) {
+      const shared_md& md = c.second;
+      bool orphan = (!countTS(md->pid()) && (!S_ISDIR(md->mode()) ||
+                     md->deleted()));
+
+      if (!orphan && (!md->deleted() || keep(c.first))) {
+        continue;
+      }
+
+      XrdSysMutexHelper mLock(s);
+      auto it = s.map.find(c.first);
+
+      if ((it == s.map.end()) || (it->second != md)) {
+        continue;
+      }
+
+      if (orphan) {
+        eos_static_debug("removing orphaned inode from mdmap ino=%#lx path=%s",
+                         c.first, md->fullpath().c_str());
+      } else {
+        eos_static_debug("removing deleted inode from mdmap ino=%#lx path=%s",
+                         c.first, md->fullpath().c_str());
+      }
+
+      lru_remove(c.first);
+      s.map.erase(it);
+      mSize--;
+      n_removed++;
+    }
+  }
+
+  return n_removed;
+}
+
+/* -------------------------------------------------------------------------- */
+metad::pmap::swap_result
+metad::pmap::swap_out_lru()
+{
+  for (size_t n = 0; n < kShards; ++n) {
+    shard& s = mShards[mSwapCursor++ % kShards];
+    XrdSysMutexHelper mLock(s);
+    lru_dump(s);
+    uint64_t inode_to_swap = lru_oldest(s);
+
+    if (!inode_to_swap) {
+      // nothing in the lru list of this shard
+      continue;
+    }
+
+    auto it = s.map.find(inode_to_swap);
+
+    if (it == s.map.end()) {
+      lru_remove(inode_to_swap);
+      return SWAP_SKIPPED;
+    }
+
+    shared_md md = it->second;
+
+    if ((md.use_count() > 2) ||
+        (md && md->LockTable().size())) {
+      eos_static_info("swap-out skipping referenced ino=%#llx ref-count=%lu\n",
+                      inode_to_swap,
+                      md.use_count());
+
+      if (md) {
+        lru_update(inode_to_swap, md);
+      }
+
+      return SWAP_SKIPPED;
+    }
+
+    lru_remove(inode_to_swap);
+
+    if (md) {
+      eos_static_info("swap-out lru-removed ino=%#llx oldest=%#llx", inode_to_swap,
+                      lru_oldest(s));
+      it->second = 0;
+
+      if (swap_out(md)) {
+        eos_static_err("swap-out failed for ino=%#llx", inode_to_swap);
+      }
+    }
+
+    return SWAP_DONE;
+  }
+
+  return SWAP_EMPTY;
+}
+
 /* -------------------------------------------------------------------------- */
 uint64_t
-metad::pmap::lru_oldest() const
+metad::pmap::lru_oldest(const shard& s) const
 {
-  return lru_last;
+  return s.lru_last;
 }
 
 /* -------------------------------------------------------------------------- */
@@ -3323,28 +3413,30 @@ metad::pmap::lru_add(fuse_ino_t ino, shared_md md)
     return;
   }
 
-  md->set_lru_prev(lru_first);
+  shard& s = get_shard(ino);
+  md->set_lru_prev(s.lru_first);
   md->set_lru_next(0);
-
   // lru list insert with outside lock handling
-  if (this->count(lru_first)) {
-    if ((*this)[lru_first]) {
+  auto it = s.map.find(s.lru_first);
+
+  if (it != s.map.end()) {
+    if (it->second) {
       // connect the new inode to the head of the lru list
-      (*this)[lru_first]->set_lru_next(ino);
+      it->second->set_lru_next(ino);
     } else {
       // points to swapped-out entry
-      lru_last = ino;
+      s.lru_last = ino;
     }
   }
 
-  lru_first = ino;
+  s.lru_first = ino;
 
-  if (!lru_last) {
-    lru_last = ino;
+  if (!s.lru_last) {
+    s.lru_last = ino;
   }
 
   eos_static_info("ino=%#llx first=%#llx last=%#llx prev=%llx next=%#llx", ino,
-                  lru_first, lru_last, md->lru_prev(), md->lru_next());
+                  s.lru_first, s.lru_last, md->lru_prev(), md->lru_next());
 }
 
 /* -------------------------------------------------------------------------- */
@@ -3355,44 +3447,49 @@ metad::pmap::lru_remove(fuse_ino_t ino)
     return;
   }
 
+  shard& s = get_shard(ino);
   uint64_t prev = 0;
   uint64_t next = 0;
 
   if (EOS_LOGS_DEBUG)
     eos_static_debug("ino=%#llx first=%#llx last=%#llx", ino,
-                     lru_first, lru_last);
+                     s.lru_first, s.lru_last);
 
   // lru list handling with outside lock handling
-  if (this->count(ino)) {
-    shared_md smd = (*this)[ino];
+  auto it = s.map.find(ino);
+
+  if (it != s.map.end()) {
+    shared_md smd = it->second;
 
     if (smd) {
-      prev = (*this)[ino]->lru_prev();
-      next = (*this)[ino]->lru_next();
+      prev = smd->lru_prev();
+      next = smd->lru_next();
+      shared_md pmd = lru_entry(s, prev);
+      shared_md nmd = lru_entry(s, next);
 
-      if (this->count(prev) && (*this)[prev]) {
-        (*this)[prev]->set_lru_next(next);
+      if (pmd) {
+        pmd->set_lru_next(next);
       } else {
         // this is the tail of the LRU list
-        lru_last = next;
+        s.lru_last = next;
       }
 
-      if (this->count(next) && (*this)[next]) {
-        (*this)[next]->set_lru_prev(prev);
+      if (nmd) {
+        nmd->set_lru_prev(prev);
       } else {
         // this is the head of the LRU list
-        lru_first = prev;
+        s.lru_first = prev;
       }
     }
 
     if (EOS_LOGS_DEBUG) {
-      eos_static_debug("last:%#llx => %#llx (prev=%#llx)", lru_last, next, prev);
+      eos_static_debug("last:%#llx => %#llx (prev=%#llx)", s.lru_last, next, prev);
     }
   }
 
   if (EOS_LOGS_DEBUG)
     eos_static_debug("ino=%#llx first=%#llx last=%#llx prev=%#llx next=%#llx", ino,
-                     lru_first, lru_last, prev, next);
+                     s.lru_first, s.lru_last, prev, next);
 }
 
 /* -------------------------------------------------------------------------- */
@@ -3403,58 +3500,66 @@ metad::pmap::lru_update(fuse_ino_t ino, shared_md md)
     return;
   }
 
-  if (lru_first == ino) {
+  shard& s = get_shard(ino);
+
+  if (s.lru_first == ino) {
     return;
   }
 
   if (EOS_LOGS_DEBUG)
     eos_static_debug("ino=%#llx first=%#llx last=%#llx", ino,
-                     lru_first, lru_last);
+                     s.lru_first, s.lru_last);
 
   // move an lru item to the head of the list
   uint64_t prev = md->lru_prev();
   uint64_t next = md->lru_next();
+  shared_md pmd = lru_entry(s, prev);
+  shared_md nmd = lru_entry(s, next);
 
-  if (this->count(prev) && (*this)[prev]) {
-    (*this)[prev]->set_lru_next(next);
+  if (pmd) {
+    pmd->set_lru_next(next);
   } else {
     if (next) {
-      lru_last = next;
+      s.lru_last = next;
     } else {
-      lru_last = ino;
+      s.lru_last = ino;
     }
   }
 
-  if (this->count(next) && (*this)[next]) {
-    (*this)[next]->set_lru_prev(prev);
+  if (nmd) {
+    nmd->set_lru_prev(prev);
   }
 
-  if (this->count(lru_first) && (*this)[lru_first]) {
-    (*this)[lru_first]->set_lru_next(ino);
-    md->set_lru_prev(lru_first);
+  shared_md fmd = lru_entry(s, s.lru_first);
+
+  if (fmd) {
+    fmd->set_lru_next(ino);
+    md->set_lru_prev(s.lru_first);
     md->set_lru_next(0);
-    lru_first = ino;
+    s.lru_first = ino;
   }
 
   if (EOS_LOGS_DEBUG)
     eos_static_debug("ino=%#llx first=%#llx last=%#llx prev=%#llx next=%#llx", ino,
-                     lru_first, lru_last, prev, next);
+                     s.lru_first, s.lru_last, prev, next);
 }
 
 /* -------------------------------------------------------------------------- */
 void
-metad::pmap::lru_dump()
+metad::pmap::lru_dump(const shard& s)
 {
   if (!EOS_LOGS_DEBUG) {
     return;
   }
 
-  uint64_t start = lru_first;
+  uint64_t start = s.lru_first;
   std::stringstream ss;
 
   do {
-    if (this->count(start)) {
-      shared_md md = (*this)[start];
+    auto it = s.map.find(start);
+
+    if ((it != s.map.end()) && it->second) {
+      shared_md md = it->second;
       ss << start << "[" << md->lru_next() << ".." << md->lru_prev() << "]" <<
          std::endl;
 
@@ -3471,9 +3576,8 @@ metad::pmap::lru_dump()
 
   eos_static_debug("%s", ss.str().c_str());
   eos_static_debug("first=%#llx last=%#llx",
-                   lru_first, lru_last);
+                   s.lru_first, s.lru_last);
 }
-
 /* -------------------------------------------------------------------------- */
 int
 metad::mdx::state_serialize(std::string& mdsstream)
@@ -3643,29 +3747,31 @@ metad::pmap::swap_rm(fuse_ino_t ino)
 void
 metad::pmap::insertTS(fuse_ino_t ino, shared_md& md)
 {
-  XrdSysMutexHelper mLock(this);
-  bool exists = this->count(ino);
-  (*this)[ino] = md;
+  shard& s = get_shard(ino);
+  XrdSysMutexHelper mLock(s);
+  bool exists = s.map.count(ino);
+  set(s, ino, md);
   // lru list handling
 
   if (!exists) {
     lru_add(ino, md);
   }
 
-  lru_dump();
+  lru_dump(s);
 }
 
 /* -------------------------------------------------------------------------- */
 bool
 metad::pmap::eraseTS(fuse_ino_t ino)
 {
-  XrdSysMutexHelper mLock(this);
+  shard& s = get_shard(ino);
+  XrdSysMutexHelper mLock(s);
   // lru list handling
   lru_remove(ino);
   bool exists = false;
-  auto it = this->find(ino);
+  auto it = s.map.find(ino);
 
-  if ((it != this->end()) && it->first) {
+  if ((it != s.map.end()) && it->first) {
     exists = true;
   }
 
@@ -3675,7 +3781,8 @@ metad::pmap::eraseTS(fuse_ino_t ino)
   }
 
   if (exists) {
-    this->erase(it);
+    s.map.erase(it);
+    mSize--;
   }
 
   swap_rm(ino); // ignore return code
@@ -3688,12 +3795,12 @@ metad::pmap::retrieveWithParentTS(fuse_ino_t ino, shared_md& md, shared_md& pmd)
 {
   // Atomically retrieve md objects for an inode, and its parent.
   while (true) {
-    // In this particular case, we need to first lock mdmap, and then
+    // In this particular case, we need to first lock the shard, and then
     // md.. The following algorithm is meant to avoid deadlocks with code
-    // which locks md first, and then mdmap.
+    // which locks md first, and then the shard.
     md.reset();
     pmd.reset();
-    XrdSysMutexHelper mLock(this);
+    XrdSysMutexHelper mLock(get_shard(ino));
 
     if (!retrieve(ino, md)) {
       return; // ino not there, nothing to do
@@ -3701,13 +3808,15 @@ metad::pmap::retrieveWithParentTS(fuse_ino_t ino, shared_md& md, shared_md& pmd)
 
     // md has been found. Can we lock it?
     if (md->Locker().CondLock()) {
-      // Success!
-      retrieve(md->pid(), pmd);
+      // Success! The parent may live in a different shard, which we are
+      // allowed to lock while holding md.
+      mLock.UnLock();
+      retrieveTS(md->pid(), pmd);
       md->Locker().UnLock();
       return;
     }
 
-    // Nope, unlock mdmap and try again.
+    // Nope, unlock the shard and try again.
     mLock.UnLock();
     std::this_thread::sleep_for(std::chrono::milliseconds(1));
   }
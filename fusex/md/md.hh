@@ -39,6 +39,8 @@
 #include "XrdSys/XrdSysPthread.hh"
 #include <memory>
 #include <map>
+#include <unordered_map>
+#include <functional>
 #include <set>
 #include <deque>
 #include <vector>
@@ -405,17 +407,49 @@ public:
     XrdSysMutex mMutex;
   };
 
-  class pmap : public std::map<fuse_ino_t, shared_md>, public XrdSysMutex
   //----------------------------------------------------------------------------
+  //! Inode table of the meta data cache
+  //!
+  //! The table is split into a fixed number of shards selected by a hash of
+  //! the inode. Each shard owns its own mutex, hash map and intrusive LRU list
+  //! (linked through the lru_prev/lru_next fields of the md objects), so
+  //! lookups of different inodes don't serialize on a single lock. The LRU
+  //! ordering is per shard - swap-out walks the shards round-robin and evicts
+  //! the oldest entry of each one in turn.
+  //!
+  //! Lock order: md->Locker() before a shard lock. Only the bulk operations
+  //! (resetTS) hold more than one shard lock and take them in ascending order.
+  //----------------------------------------------------------------------------
+  class pmap
   {
   public:
+    static constexpr size_t kShardBits = 6;
+    static constexpr size_t kShards = (1ull << kShardBits);
 
-    pmap()
+    //--------------------------------------------------------------------------
+    //! One shard of the inode table - all members are protected by the shard
+    //! mutex
+    //--------------------------------------------------------------------------
+    class shard : public XrdSysMutex
     {
-      lru_first = 0;
-      lru_last = 0;
-      store = 0 ;
-    }
+    public:
+      shard() : lru_first(0), lru_last(0) { }
+
+      std::unordered_map<fuse_ino_t, shared_md> map;
+      uint64_t lru_first;
+      uint64_t lru_last;
+    };
+
+    //--------------------------------------------------------------------------
+    //! Result of a single swap-out attempt
+    //--------------------------------------------------------------------------
+    enum swap_result {
+      SWAP_EMPTY, ///< no LRU entry left in any shard
+      SWAP_SKIPPED, ///< oldest entry is still referenced, moved to the front
+      SWAP_DONE ///< oldest entry was written to the kv store
+    };
+
+    pmap() : store(0), mSize(0), mSwapCursor(0) { }
 
     void init(kv* _kv)
     {
@@ -426,29 +460,79 @@ public:
 
     // TS stands for "thread-safe"
 
-    size_t sizeTS();
+    size_t sizeTS() const
+    {
+      return mSize.load();
+    }
 
     bool retrieveOrCreateTS(fuse_ino_t ino, shared_md& ret);
     bool retrieveTS(fuse_ino_t ino, shared_md& ret);
-    bool retrieve(fuse_ino_t ino, shared_md& ret);
     void insertTS(fuse_ino_t ino, shared_md& md);
     bool eraseTS(fuse_ino_t ino);
+    bool countTS(fuse_ino_t ino);
     void retrieveWithParentTS(fuse_ino_t ino, shared_md& md, shared_md& pmd);
 
-    uint64_t lru_oldest() const;
+    //--------------------------------------------------------------------------
+    //! Drop all entries apart from the given inode
+    //--------------------------------------------------------------------------
+    void resetTS(fuse_ino_t keep_ino);
+
+    //--------------------------------------------------------------------------
+    //! Remove orphaned and deleted inodes which are no longer needed
+    //!
+    //! @param keep callback returning true if a deleted inode has to stay
+    //!
+    //! @return number of removed entries
+    //--------------------------------------------------------------------------
+    size_t cleanTS(std::function<bool(fuse_ino_t)> keep);
+
+    //--------------------------------------------------------------------------
+    //! Swap out the oldest LRU entry of the next shard in round-robin order.
+    //! Shards with an empty LRU list are skipped.
+    //--------------------------------------------------------------------------
+    swap_result swap_out_lru();
+
+    // the following calls expect the shard lock of ino to be held by the caller
+    bool retrieve(fuse_ino_t ino, shared_md& ret);
+
+    uint64_t lru_oldest(const shard& s) const;
     void lru_add(fuse_ino_t ino, shared_md md);
     void lru_remove(fuse_ino_t ino);
     void lru_update(fuse_ino_t ino, shared_md md);
-    void lru_dump();
+    void lru_dump(const shard& s);
 
     int swap_out(shared_md md);
     int swap_in(fuse_ino_t ino, shared_md md);
     int swap_rm(fuse_ino_t ino);
 
+    //--------------------------------------------------------------------------
+    //! Get the shard responsible for the given inode
+    //--------------------------------------------------------------------------
+    shard& get_shard(fuse_ino_t ino)
+    {
+      // spread sequential inode numbers over all shards
+      return mShards[((uint64_t) ino * 0x9e3779b97f4a7c15ull) >>
+                     (64 - kShardBits)];
+    }
+
   private:
-    uint64_t lru_first;
-    uint64_t lru_last;
     kv* store;
+    std::atomic<size_t> mSize; ///< number of entries including stacked ones
+    std::atomic<size_t> mSwapCursor; ///< next shard to visit for swap-out
+    shard mShards[kShards];
+
+    //--------------------------------------------------------------------------
+    //! Attach an md object, keeping the size counter consistent - the shard
+    //! lock needs to be held by the caller.
+    //--------------------------------------------------------------------------
+    void set(shard& s, fuse_ino_t ino, const shared_md& md)
+    {
+      if (s.map.emplace(ino, md).second) {
+        mSize++;
+      } else {
+        s.map[ino] = md;
+      }
+    }
   };
 
   //----------------------------------------------------------------------------
@@ -666,12 +750,11 @@ public:
   }
 
   void mdreset() {
-    XrdSysMutexHelper lock(mdmap);
-    shared_md md1 = mdmap[1];
+    shared_md md1;
+    mdmap.retrieveTS(1, md1);
     md1->set_type(md1->MD);
     md1->force_refresh();
-    mdmap.clear();
-    mdmap[1] = md1;
+    mdmap.resetTS(1);
     uint64_t i_root = inomap.backward(1);
     inomap.clear();
     inomap.insert(i_root,1);
@@ -0,0 +1,247 @@
+//------------------------------------------------------------------------------
+//! @file FsFileSampler.cc
+//------------------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2023 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+#include "mgm/FsFileSampler.hh"
+#include "mgm/XrdMgmOfs.hh"
+#include "namespace/interface/IFileMDSvc.hh"
+#include "namespace/interface/IView.hh"
+#include "namespace/Prefetcher.hh"
+#include "common/Logging.hh"
+#include <algorithm>
+
+EOSMGMNAMESPACE_BEGIN
+
+//------------------------------------------------------------------------------
+// Constructor
+//------------------------------------------------------------------------------
+FsFileSampler::FsFileSampler(ScannerT scanner, size_t batch_size,
+                             std::chrono::seconds max_age):
+  mScanner(std::move(scanner)), mBatchSize(batch_size), mMaxAge(max_age)
+{
+  mThread = std::thread(&FsFileSampler::RefreshLoop, this);
+}
+
+//------------------------------------------------------------------------------
+// Stop the refresh thread
+//------------------------------------------------------------------------------
+void
+FsFileSampler::Stop()
+{
+  {
+    std::unique_lock<std::mutex> lock(mMutex);
+    mStop = true;
+  }
+  mCondVar.notify_all();
+
+  if (mThread.joinable()) {
+    mThread.join();
+  }
+}
+
+//------------------------------------------------------------------------------
+// Take candidates from the batch of a file system
+//------------------------------------------------------------------------------
+std::vector<FsFileSampler::Candidate>
+FsFileSampler::Take(fsid_t fsid, size_t max_num,
+                    const std::function<bool(const Candidate&)>& accept)
+{
+  std::vector<Candidate> taken;
+  std::unique_lock<std::mutex> lock(mMutex);
+  auto it = mBatches.find(fsid);
+
+  if (it != mBatches.end()) {
+    auto& candidates = it->second.mCandidates;
+
+    // The batch is in random order, take from the back
+    while (!candidates.empty() && (taken.size() < max_num)) {
+      if (accept(candidates.back())) {
+        taken.push_back(candidates.back());
+      }
+
+      candidates.pop_back();
+    }
+  }
+
+  bool refresh = (it == mBatches.end());
+
+  if (!refresh) {
+    const Batch& batch = it->second;
+
+    if (std::chrono::steady_clock::now() - batch.mRefreshed > mMaxAge) {
+      refresh = true;
+    } else if (batch.mCandidates.size() < mBatchSize / 4) {
+      // Sampling a file list which fits in the batch again would return the
+      // same files
+      refresh = !batch.mComplete;
+    }
+  }
+
+  if (refresh && mPending.insert(fsid).second) {
+    mCondVar.notify_all();
+  }
+
+  return taken;
+}
+
+//------------------------------------------------------------------------------
+// Drop the batch of a file system
+//------------------------------------------------------------------------------
+void
+FsFileSampler::Forget(fsid_t fsid)
+{
+  std::unique_lock<std::mutex> lock(mMutex);
+  mBatches.erase(fsid);
+  mPending.erase(fsid);
+
+  if (mRefreshing == fsid) {
+    mDiscard = true;
+  }
+}
+
+//------------------------------------------------------------------------------
+// Wait until no refresh is pending or running
+//------------------------------------------------------------------------------
+void
+FsFileSampler::WaitIdle()
+{
+  std::unique_lock<std::mutex> lock(mMutex);
+  mCondVar.wait(lock, [&]() {
+    return mStop || (mPending.empty() && (mRefreshing == 0));
+  });
+}
+
+//------------------------------------------------------------------------------
+// Loop of the refresh thread
+//------------------------------------------------------------------------------
+void
+FsFileSampler::RefreshLoop()
+{
+  std::unique_lock<std::mutex> lock(mMutex);
+
+  while (true) {
+    mCondVar.wait(lock, [&]() {
+      return mStop || !mPending.empty();
+    });
+
+    if (mStop) {
+      break;
+    }
+
+    const fsid_t fsid = *mPending.begin();
+    mPending.erase(mPending.begin());
+    mRefreshing = fsid;
+    mDiscard = false;
+    // Scan without holding the lock, the balancers keep using the old batch
+    lock.unlock();
+    bool complete = false;
+    std::vector<Candidate> candidates = mScanner(fsid, mBatchSize, complete);
+    lock.lock();
+    mRefreshing = 0;
+
+    if (!mDiscard) {
+      Batch& batch = mBatches[fsid];
+      batch.mCandidates = std::move(candidates);
+      batch.mComplete = complete;
+      batch.mRefreshed = std::chrono::steady_clock::now();
+    }
+
+    mCondVar.notify_all();
+  }
+}
+
+//------------------------------------------------------------------------------
+// Draw a uniform sample of the given size from a file list
+//------------------------------------------------------------------------------
+std::vector<IFileMD::id_t>
+FsFileSampler::SampleFileList(ICollectionIterator<IFileMD::id_t>* it,
+                              size_t num, std::mt19937_64& rng)
+{
+  std::vector<IFileMD::id_t> sample;
+
+  if (num == 0) {
+    return sample;
+  }
+
+  sample.reserve(num);
+  uint64_t seen = 0;
+
+  for (; it && it->valid(); it->next(), ++seen) {
+    if (sample.size() < num) {
+      sample.push_back(it->getElement());
+    } else {
+      // Replace a random element with probability num / (seen + 1)
+      uint64_t pos = std::uniform_int_distribution<uint64_t>(0, seen)(rng);
+
+      if (pos < num) {
+        sample[pos] = it->getElement();
+      }
+    }
+  }
+
+  // The first entries keep their list order until replaced
+  std::shuffle(sample.begin(), sample.end(), rng);
+  return sample;
+}
+
+//------------------------------------------------------------------------------
+// Scanner sampling the file lists of the MGM namespace
+//------------------------------------------------------------------------------
+FsFileSampler::ScannerT
+FsFileSampler::NamespaceScanner()
+{
+  return [](fsid_t fsid, size_t num, bool & complete) {
+    std::vector<Candidate> candidates;
+    std::mt19937_64 rng(std::random_device{}());
+    // The streaming file list does not need the namespace lock
+    auto it = gOFS->eosFsView->getStreamingFileList(fsid);
+    std::vector<IFileMD::id_t> fids = SampleFileList(it.get(), num, rng);
+    complete = (fids.size() < num);
+    eos::Prefetcher prefetcher(gOFS->eosView);
+
+    for (const auto fid : fids) {
+      prefetcher.stageFileMD(fid);
+    }
+
+    prefetcher.wait();
+    eos::common::RWMutexReadLock ns_rd_lock(gOFS->eosViewRWMutex, __FUNCTION__,
+                                            __LINE__, __FILE__);
+
+    for (const auto fid : fids) {
+      try {
+        auto fmd = gOFS->eosFileService->getFileMD(fid);
+
+        if (fmd->getContainerId() != 0) {
+          candidates.push_back({fid, fmd->getSize()});
+        }
+      } catch (const eos::MDException&) {
+        // file gone in the meantime
+      }
+    }
+
+    eos_static_debug("msg=\"sampled file system\" fsid=%lu files=%lu "
+                     "candidates=%lu", (unsigned long) fsid, fids.size(),
+                     candidates.size());
+    return candidates;
+  };
+}
+
+EOSMGMNAMESPACE_END
@@ -0,0 +1,170 @@
+//------------------------------------------------------------------------------
+//! @file FsFileSampler.hh
+//! @brief Per filesystem samples of files used by the balancers to pick
+//!        candidates without holding the namespace lock
+//------------------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2023 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+#pragma once
+#include "mgm/Namespace.hh"
+#include "namespace/interface/IFsView.hh"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
+
+EOSMGMNAMESPACE_BEGIN
+
+//------------------------------------------------------------------------------
+//! Class FsFileSampler - keeps for every file system a batch of randomly
+//! chosen files together with their size. The batches are filled by a
+//! background thread, which draws a uniform sample (reservoir sampling) from
+//! the file list of the file system and looks up the sizes, so that the
+//! balancers can take many candidates per cycle without touching the
+//! namespace.
+//!
+//! A batch is refreshed when it runs low or gets older than the max age. A
+//! batch holding all the files of a (small) file system is only refreshed
+//! after the max age. The candidates
+//! are hints: the file may have been moved or deleted in the
+//! meantime, so the consumer still has to validate them.
+//------------------------------------------------------------------------------
+class FsFileSampler
+{
+public:
+  using fsid_t = IFileMD::location_t;
+
+  //! File candidate
+  struct Candidate {
+    IFileMD::id_t mFid;
+    uint64_t mSize;
+  };
+
+  //! Function sampling up to the given number of files of a file system,
+  //! the flag is set if the sample covers the whole file list
+  using ScannerT = std::function<std::vector<Candidate>(fsid_t, size_t,
+                   bool&)>;
+
+  //----------------------------------------------------------------------------
+  //! Constructor
+  //!
+  //! @param scanner function sampling the files of a file system
+  //! @param batch_size number of candidates sampled per file system
+  //! @param max_age age after which a batch is refreshed
+  //----------------------------------------------------------------------------
+  FsFileSampler(ScannerT scanner, size_t batch_size = 1024,
+                std::chrono::seconds max_age = std::chrono::seconds(600));
+
+  //----------------------------------------------------------------------------
+  //! Destructor
+  //----------------------------------------------------------------------------
+  ~FsFileSampler()
+  {
+    Stop();
+  }
+
+  //----------------------------------------------------------------------------
+  //! Don't allow copy or move of these objects
+  //----------------------------------------------------------------------------
+  FsFileSampler(const FsFileSampler&) = delete;
+  FsFileSampler& operator =(const FsFileSampler&) = delete;
+
+  //----------------------------------------------------------------------------
+  //! Stop the refresh thread
+  //----------------------------------------------------------------------------
+  void Stop();
+
+  //----------------------------------------------------------------------------
+  //! Take candidates from the batch of a file system. Candidates rejected by
+  //! the filter are dropped from the batch as well. Schedules a refresh of
+  //! the batch if needed, the first call for a file system returns nothing.
+  //!
+  //! @param fsid file system id
+  //! @param max_num max number of candidates to return
+  //! @param accept filter applied to the candidates
+  //!
+  //! @return candidates
+  //----------------------------------------------------------------------------
+  std::vector<Candidate>
+  Take(fsid_t fsid, size_t max_num,
+       const std::function<bool(const Candidate&)>& accept);
+
+  //----------------------------------------------------------------------------
+  //! Drop the batch of a file system once it was removed
+  //----------------------------------------------------------------------------
+  void Forget(fsid_t fsid);
+
+  //----------------------------------------------------------------------------
+  //! Wait until no refresh is pending or running
+  //----------------------------------------------------------------------------
+  void WaitIdle();
+
+  //----------------------------------------------------------------------------
+  //! Draw a uniform sample of the given size from a file list (algorithm R)
+  //!
+  //! @param it file list iterator
+  //! @param num sample size
+  //! @param rng random generator
+  //!
+  //! @return sampled file ids, all of them if the list has at most num entries
+  //!         in which case the size of the returned sample is below num
+  //----------------------------------------------------------------------------
+  static std::vector<IFileMD::id_t>
+  SampleFileList(ICollectionIterator<IFileMD::id_t>* it, size_t num,
+                 std::mt19937_64& rng);
+
+  //----------------------------------------------------------------------------
+  //! Scanner sampling the file lists of the MGM namespace
+  //----------------------------------------------------------------------------
+  static ScannerT NamespaceScanner();
+
+private:
+  //! Candidates of a file system
+  struct Batch {
+    std::vector<Candidate> mCandidates;
+    bool mComplete {false}; ///< Last sample covered the whole file list
+    std::chrono::steady_clock::time_point mRefreshed;
+  };
+
+  //----------------------------------------------------------------------------
+  //! Loop of the refresh thread
+  //----------------------------------------------------------------------------
+  void RefreshLoop();
+
+  ScannerT mScanner;
+  const size_t mBatchSize;
+  const std::chrono::seconds mMaxAge;
+  std::mutex mMutex; ///< Protects the members below
+  std::condition_variable mCondVar;
+  std::map<fsid_t, Batch> mBatches;
+  std::set<fsid_t> mPending; ///< File systems waiting for a refresh
+  fsid_t mRefreshing {0}; ///< File system being refreshed, 0 if none
+  bool mDiscard {false}; ///< Drop the result of the ongoing refresh
+  bool mStop {false};
+  std::thread mThread;
+};
+
+EOSMGMNAMESPACE_END
@@ -1649,6 +1649,8 @@ FsView::Register(FileSystem* fs, const common::FileSystemCoreParams& coreParams,
   eos::common::FileSystem::fs_snapshot_t snapshot;
 
   if (fs->SnapShotFileSystem(snapshot)) {
+    InvalidateSnapshot();
+
     // Check if this is already in the view
     if (mIdView.lookupByPtr(fs) != 0) {
       // This filesystem is already there, this might be an update
@@ -1785,6 +1787,7 @@ FsView::MoveGroup(FileSystem* fs, std::string group)
   eos::common::FileSystem::fs_snapshot_t snapshot;
 
   if (fs->SnapShotFileSystem(snapshot1)) {
+    InvalidateSnapshot();
     fs->SetString("schedgroup", group.c_str());
     FsGroup* oldgroup = mGroupView.count(snapshot1.mGroup) ?
                         mGroupView[snapshot1.mGroup] : NULL;
@@ -1924,6 +1927,7 @@ FsView::UnRegister(FileSystem* fs, bool unreg_from_geo_tree,
   eos::common::FileSystem::fs_snapshot_t snapshot;
 
   if (fs->SnapShotFileSystem(snapshot)) {
+    InvalidateSnapshot();
     // Remove view by filesystem object and filesystem id
     // Check if this is in the view
     if (!mIdView.eraseByPtr(fs)) {
@@ -1977,6 +1981,15 @@ FsView::UnRegister(FileSystem* fs, bool unreg_from_geo_tree,
     if (mSpaceView.count(snapshot.mSpace)) {
       FsSpace* space = mSpaceView[snapshot.mSpace];
       space->erase(snapshot.mId);
+
+      if (space->mGroupBalancer) {
+        space->mGroupBalancer->ForgetFileSystem(snapshot.mId);
+      }
+
+      if (space->mGeoBalancer) {
+        space->mGeoBalancer->ForgetFileSystem(snapshot.mId);
+      }
+
       eos_debug("msg=\"unregister space %s from space view\"",
                 space->GetMember("name").c_str());
 
@@ -2036,6 +2049,7 @@ FsView::RegisterNode(const char* nodename)
   } else {
     FsNode* node = new FsNode(nodequeue.c_str());
     mNodeView[nodequeue] = node;
+    InvalidateSnapshot();
     node->SetNodeConfigDefault();
     eos_debug("creating node view %s", nodequeue.c_str());
     return true;
@@ -2054,6 +2068,8 @@ FsView::UnRegisterNode(const char* nodename)
   bool has_fs = false;
 
   if (mNodeView.count(nodename)) {
+    InvalidateSnapshot();
+
     while (mNodeView.count(nodename) &&
            (mNodeView[nodename]->begin() != mNodeView[nodename]->end())) {
       eos::common::FileSystem::fsid_t fsid = *(mNodeView[nodename]->begin());
@@ -2091,6 +2107,7 @@ FsView::RegisterSpace(const char* spacename)
   } else {
     FsSpace* space = new FsSpace(spacequeue.c_str());
     mSpaceView[spacequeue] = space;
+    InvalidateSnapshot();
     eos_debug("creating space view %s", spacequeue.c_str());
     return true;
   }
@@ -2108,6 +2125,8 @@ FsView::UnRegisterSpace(const char* spacename)
   bool has_fs = false;
 
   if (mSpaceView.count(spacename)) {
+    InvalidateSnapshot();
+
     while (mSpaceView.count(spacename) && mSpaceView[spacename]->size()) {
       eos::common::FileSystem::fsid_t fsid = *(mSpaceView[spacename]->begin());
       FileSystem* fs = mIdView.lookupByID(fsid);
@@ -2151,6 +2170,7 @@ FsView::RegisterGroup(const char* groupname)
   } else {
     FsGroup* group = new FsGroup(groupqueue.c_str());
     mGroupView[groupqueue] = group;
+    InvalidateSnapshot();
     eos_debug("creating group view %s", groupqueue.c_str());
     return true;
   }
@@ -2168,6 +2188,8 @@ FsView::UnRegisterGroup(const char* groupname)
   bool has_fs = false;
 
   if (mGroupView.count(groupname)) {
+    InvalidateSnapshot();
+
     while (mGroupView.count(groupname) &&
            (mGroupView[groupname]->begin() != mGroupView[groupname]->end())) {
       eos::common::FileSystem::fsid_t fsid = *(mGroupView[groupname]->begin());
@@ -2387,6 +2409,121 @@ FsView::HeartBeatCheck(ThreadAssistant& assistant) noexcept
   }
 }
 
+//------------------------------------------------------------------------------
+// Thread loop function publishing the view snapshots
+//------------------------------------------------------------------------------
+void
+FsView::SnapshotUpdater(ThreadAssistant& assistant) noexcept
+{
+  time_t last_publish = 0;
+
+  while (!assistant.terminationRequested()) {
+    assistant.wait_for(std::chrono::milliseconds(sSnapshotPollMs));
+
+    if (assistant.terminationRequested()) {
+      break;
+    }
+
+    time_t now = time(NULL);
+
+    // Refresh the file system state only if somebody uses the snapshot
+    if (mSnapshotDirty ||
+        (mSnapshotRead && (now - last_publish >= sSnapshotRefreshSec))) {
+      PublishSnapshot();
+      last_publish = now;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// Build a new snapshot of the view and publish it atomically
+//------------------------------------------------------------------------------
+void
+FsView::PublishSnapshot(time_t max_age)
+{
+  std::unique_lock<std::mutex> build_lock(mSnapshotMutex);
+
+  if (max_age) {
+    // Somebody else may have rebuilt it while we waited for the lock
+    auto current = std::atomic_load(&mSnapshot);
+
+    if (current && !mSnapshotDirty &&
+        (time(NULL) - current->GetTimestamp() <= max_age)) {
+      return;
+    }
+  }
+
+  // Reset the flags before reading the view so that concurrent topology
+  // changes trigger a new snapshot
+  mSnapshotDirty = false;
+  mSnapshotRead = false;
+  auto snapshot = std::make_shared<FsViewSnapshot>(mSnapshotVersion + 1,
+                  time(NULL));
+  {
+    eos::common::RWMutexReadLock rd_lock(ViewMutex, __FUNCTION__, __LINE__,
+                                         __FILE__);
+
+    for (const auto& elem : mSpaceView) {
+      auto& entry = snapshot->AddSpace(elem.first,
+                                       elem.second->GetConfigMember("status"));
+      entry.mFsIds.assign(elem.second->begin(), elem.second->end());
+    }
+
+    for (const auto& elem : mSpaceGroupView) {
+      for (const auto* group : elem.second) {
+        snapshot->AddSpaceGroup(elem.first, group->mName);
+      }
+    }
+
+    for (const auto& elem : mGroupView) {
+      auto& entry = snapshot->AddGroup(elem.first,
+                                       elem.second->GetConfigMember("status"));
+      entry.mFsIds.assign(elem.second->begin(), elem.second->end());
+    }
+
+    for (const auto& elem : mNodeView) {
+      auto& entry = snapshot->AddNode(elem.first,
+                                      elem.second->GetConfigMember("status"));
+      entry.mFsIds.assign(elem.second->begin(), elem.second->end());
+    }
+
+    for (const auto& elem : mIdView) {
+      eos::common::FileSystem::fs_snapshot_t fs;
+
+      if (elem.second && elem.second->SnapShotFileSystem(fs)) {
+        snapshot->AddFileSystem(std::move(fs));
+      }
+    }
+  }
+  ++mSnapshotVersion;
+  std::atomic_store(&mSnapshot,
+                    std::shared_ptr<const FsViewSnapshot>(std::move(snapshot)));
+}
+
+//------------------------------------------------------------------------------
+// Get the latest published snapshot of the view
+//------------------------------------------------------------------------------
+std::shared_ptr<const FsViewSnapshot>
+FsView::GetSnapshot()
+{
+  auto snapshot = std::atomic_load(&mSnapshot);
+  const time_t max_age = 2 * sSnapshotRefreshSec;
+
+  if ((snapshot == nullptr) ||
+      (time(NULL) - snapshot->GetTimestamp() > max_age)) {
+    // Nothing published yet or not refreshed since nobody read it lately,
+    // build it synchronously
+    PublishSnapshot(max_age);
+    snapshot = std::atomic_load(&mSnapshot);
+  }
+
+  if (!mSnapshotRead.load(std::memory_order_relaxed)) {
+    mSnapshotRead = true;
+  }
+
+  return snapshot;
+}
+
 //------------------------------------------------------------------------------
 // Return a view member variable
 //------------------------------------------------------------------------------
@@ -2615,6 +2752,11 @@ BaseView::SetConfigMember(std::string key, std::string value,
   bool success = mq::SharedHashWrapper(gOFS->mMessagingRealm.get(),
                                        mLocator).set(key, value);
 
+  // The status of the views is part of the published snapshot
+  if (key == "status") {
+    FsView::gFsView.InvalidateSnapshot();
+  }
+
   if (key == "txgw") {
     eos::common::RWMutexWriteLock gwlock(FsView::gFsView.GwMutex);
 
@@ -3004,38 +3146,29 @@ FsView::BroadcastMasterId(const std::string master_id)
 std::set<std::string>
 FsView::CollectEndpoints(const std::string& queue) const
 {
-  int fst_port;
-  std::string fst_host;
   std::set<std::string> endpoints;
-  eos::common::RWMutexReadLock fs_rd_lock(FsView::gFsView.ViewMutex);
+  auto snapshot = FsView::gFsView.GetSnapshot();
 
-  for (const auto& elem : FsView::gFsView.mIdView) {
-    FileSystem* fs = elem.second;
-
-    if (fs == nullptr) {
-      eos_static_err("msg=\"file system null\" fsid=%u", elem.first);
-      continue;
-    }
+  for (const auto& elem : snapshot->GetFileSystems()) {
+    const auto& fs = elem.second;
 
     if (queue == "*") {
-      if (fs->GetActiveStatus() != eos::common::ActiveStatus::kOnline) {
+      if (fs.mActiveStatus != eos::common::ActiveStatus::kOnline) {
         eos_static_err("msg=\"file system not online\" fsid=%u", elem.first);
         continue;
       }
     } else {
-      if (queue != fs->GetQueue()) {
+      if (queue != fs.mQueue) {
         continue;
       } else {
-        if (fs->GetActiveStatus() != eos::common::ActiveStatus::kOnline) {
+        if (fs.mActiveStatus != eos::common::ActiveStatus::kOnline) {
           eos_static_err("msg=\"file system not online\" fsid=%u", elem.first);
           break;
         }
       }
     }
 
-    fst_host = fs->GetHost();
-    fst_port = fs->getCoreParams().getLocator().getPort();
-    endpoints.insert(SSTR(fst_host << ":" << fst_port));
+    endpoints.insert(SSTR(fs.mHost << ":" << fs.mPort));
   }
 
   return endpoints;
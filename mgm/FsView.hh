@@ -26,6 +26,7 @@
 
 #include "mgm/Namespace.hh"
 #include "mgm/FileSystem.hh"
+#include "mgm/FsViewSnapshot.hh"
 #include "mgm/utils/FilesystemUuidMapper.hh"
 #include "mgm/utils/FileSystemRegistry.hh"
 #include "common/RWMutex.hh"
@@ -40,6 +41,9 @@
 #include <sys/param.h>
 #include <sys/mount.h>
 #endif
+#include <atomic>
+#include <memory>
+#include <mutex>
 
 namespace eos::common
 {
@@ -703,9 +707,11 @@ public:
   //! @param start_heartbeat control whether heartbeat thread is started - for
   //!                        testing purposes
   //----------------------------------------------------------------------------
-  FsView() : mConfigEngine(nullptr)
+  FsView() : mConfigEngine(nullptr), mSnapshotVersion(0),
+    mSnapshotDirty(true), mSnapshotRead(false)
   {
     mHeartBeatThread.reset(&FsView::HeartBeatCheck, this);
+    mSnapshotThread.reset(&FsView::SnapshotUpdater, this);
   }
 
   //----------------------------------------------------------------------------
@@ -909,11 +915,47 @@ public:
   void HeartBeatCheck(ThreadAssistant& assistant) noexcept;
 
   //----------------------------------------------------------------------------
-  //! Stop the heartbeat thread
+  //! Thread loop function publishing the view snapshots
+  //----------------------------------------------------------------------------
+  void SnapshotUpdater(ThreadAssistant& assistant) noexcept;
+
+  //----------------------------------------------------------------------------
+  //! Stop the heartbeat and snapshot threads
   //----------------------------------------------------------------------------
   void StopHeartBeat()
   {
     mHeartBeatThread.join();
+    mSnapshotThread.join();
+  }
+
+  //----------------------------------------------------------------------------
+  //! Get the latest published snapshot of the view. The snapshot is
+  //! immutable and stays valid for as long as the caller holds the pointer,
+  //! no lock on the ViewMutex is needed to use it. Topology changes are
+  //! published within sSnapshotPollMs. The file system state is refreshed
+  //! every sSnapshotRefreshSec while the snapshot is being read, a snapshot
+  //! older than twice that is rebuilt by the caller.
+  //!
+  //! @note must not be called with the ViewMutex write-locked
+  //----------------------------------------------------------------------------
+  std::shared_ptr<const FsViewSnapshot> GetSnapshot();
+
+  //----------------------------------------------------------------------------
+  //! Build a new snapshot of the view and publish it atomically
+  //!
+  //! @param max_age if non-zero, skip the rebuild when the published snapshot
+  //!        is not older than max_age seconds
+  //!
+  //! @note must not be called with the ViewMutex write-locked
+  //----------------------------------------------------------------------------
+  void PublishSnapshot(time_t max_age = 0);
+
+  //----------------------------------------------------------------------------
+  //! Mark the published snapshot as outdated after a topology change
+  //----------------------------------------------------------------------------
+  inline void InvalidateSnapshot()
+  {
+    mSnapshotDirty = true;
   }
 
   //----------------------------------------------------------------------------
@@ -976,6 +1018,17 @@ public:
 private:
   IConfigEngine* mConfigEngine;
   AssistedThread mHeartBeatThread; ///< Thread monitoring heart-beats
+  AssistedThread mSnapshotThread; ///< Thread publishing the view snapshots
+  //! Interval at which the snapshot thread checks for topology changes
+  static constexpr unsigned int sSnapshotPollMs = 250;
+  //! Maximum age of a snapshot before the file system state is refreshed
+  static constexpr unsigned int sSnapshotRefreshSec = 2;
+  //! Latest published snapshot, only accessed with std::atomic_load/store
+  std::shared_ptr<const FsViewSnapshot> mSnapshot;
+  std::mutex mSnapshotMutex; ///< Serialize the snapshot builders
+  uint64_t mSnapshotVersion; ///< Version of the latest snapshot
+  std::atomic<bool> mSnapshotDirty; ///< Snapshot outdated by a topology change
+  std::atomic<bool> mSnapshotRead; ///< Snapshot read since it was published
   //! Object to map between fsid <-> uuid
   FilesystemUuidMapper mFilesystemMapper;
 
@@ -0,0 +1,159 @@
+//------------------------------------------------------------------------------
+//! @file FsViewSnapshot.cc
+//! @brief Immutable, versioned snapshot of the FsView topology and state
+//------------------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2023 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+#include "mgm/FsViewSnapshot.hh"
+
+EOSMGMNAMESPACE_BEGIN
+
+//------------------------------------------------------------------------------
+// Add an entry to one of the view maps
+//------------------------------------------------------------------------------
+FsViewSnapshot::ViewEntry&
+FsViewSnapshot::AddEntry(std::map<std::string, ViewEntry>& views,
+                         const std::string& name, const std::string& status)
+{
+  ViewEntry& entry = views[name];
+  entry.mName = name;
+  entry.mStatus = status;
+  return entry;
+}
+
+//------------------------------------------------------------------------------
+// Lookup an entry in one of the view maps
+//------------------------------------------------------------------------------
+const FsViewSnapshot::ViewEntry*
+FsViewSnapshot::FindEntry(const std::map<std::string, ViewEntry>& views,
+                          const std::string& name)
+{
+  auto it = views.find(name);
+  return (it == views.end()) ? nullptr : &it->second;
+}
+
+//------------------------------------------------------------------------------
+// Add a space, group or node
+//------------------------------------------------------------------------------
+FsViewSnapshot::ViewEntry&
+FsViewSnapshot::AddSpace(const std::string& name, const std::string& status)
+{
+  return AddEntry(mSpaces, name, status);
+}
+
+FsViewSnapshot::ViewEntry&
+FsViewSnapshot::AddGroup(const std::string& name, const std::string& status)
+{
+  return AddEntry(mGroups, name, status);
+}
+
+FsViewSnapshot::ViewEntry&
+FsViewSnapshot::AddNode(const std::string& name, const std::string& status)
+{
+  return AddEntry(mNodes, name, status);
+}
+
+//------------------------------------------------------------------------------
+// Attach a group to a space
+//------------------------------------------------------------------------------
+void
+FsViewSnapshot::AddSpaceGroup(const std::string& space,
+                              const std::string& group)
+{
+  mSpaceGroups[space].push_back(group);
+}
+
+//------------------------------------------------------------------------------
+// Add a file system
+//------------------------------------------------------------------------------
+void
+FsViewSnapshot::AddFileSystem(fs_snapshot_t&& fs)
+{
+  fsid_t fsid = fs.mId;
+  mFileSystems[fsid] = std::move(fs);
+}
+
+//------------------------------------------------------------------------------
+// Get a space, group or node
+//------------------------------------------------------------------------------
+const FsViewSnapshot::ViewEntry*
+FsViewSnapshot::GetSpace(const std::string& name) const
+{
+  return FindEntry(mSpaces, name);
+}
+
+const FsViewSnapshot::ViewEntry*
+FsViewSnapshot::GetGroup(const std::string& name) const
+{
+  return FindEntry(mGroups, name);
+}
+
+const FsViewSnapshot::ViewEntry*
+FsViewSnapshot::GetNode(const std::string& name) const
+{
+  return FindEntry(mNodes, name);
+}
+
+//------------------------------------------------------------------------------
+// Get the names of the groups of a space
+//------------------------------------------------------------------------------
+std::vector<std::string>
+FsViewSnapshot::GetSpaceGroups(const std::string& space) const
+{
+  auto it = mSpaceGroups.find(space);
+
+  if (it == mSpaceGroups.end()) {
+    return {};
+  }
+
+  return it->second;
+}
+
+//------------------------------------------------------------------------------
+// Get the state of a file system
+//------------------------------------------------------------------------------
+const FsViewSnapshot::fs_snapshot_t*
+FsViewSnapshot::GetFileSystem(fsid_t fsid) const
+{
+  auto it = mFileSystems.find(fsid);
+  return (it == mFileSystems.end()) ? nullptr : &it->second;
+}
+
+//------------------------------------------------------------------------------
+// Get the state of all the file systems of a view
+//------------------------------------------------------------------------------
+std::vector<const FsViewSnapshot::fs_snapshot_t*>
+FsViewSnapshot::GetFileSystems(const ViewEntry& entry) const
+{
+  std::vector<const fs_snapshot_t*> fss;
+  fss.reserve(entry.mFsIds.size());
+
+  for (auto fsid : entry.mFsIds) {
+    const fs_snapshot_t* fs = GetFileSystem(fsid);
+
+    if (fs) {
+      fss.push_back(fs);
+    }
+  }
+
+  return fss;
+}
+
+EOSMGMNAMESPACE_END
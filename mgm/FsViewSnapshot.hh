@@ -0,0 +1,185 @@
+//------------------------------------------------------------------------------
+//! @file FsViewSnapshot.hh
+//! @brief Immutable, versioned snapshot of the FsView topology and state
+//------------------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2023 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+#pragma once
+#include "mgm/Namespace.hh"
+#include "common/FileSystem.hh"
+#include <ctime>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+EOSMGMNAMESPACE_BEGIN
+
+//------------------------------------------------------------------------------
+//! Class FsViewSnapshot - copy of the spaces, groups, nodes and file systems
+//! registered in the FsView together with the state of every file system.
+//! A snapshot is filled once by FsView::PublishSnapshot and never modified
+//! after being published, therefore it can be used by any number of readers
+//! without holding the FsView::ViewMutex.
+//------------------------------------------------------------------------------
+class FsViewSnapshot
+{
+public:
+  using fsid_t = eos::common::FileSystem::fsid_t;
+  using fs_snapshot_t = eos::common::FileSystem::fs_snapshot_t;
+
+  //! Snapshot of a space, group or node
+  struct ViewEntry {
+    std::string mName; ///< Name of the view
+    std::string mStatus; ///< Value of the "status" config member
+    std::vector<fsid_t> mFsIds; ///< File systems attached to the view
+  };
+
+  //----------------------------------------------------------------------------
+  //! Constructor
+  //!
+  //! @param version version of the snapshot
+  //! @param timestamp creation time
+  //----------------------------------------------------------------------------
+  FsViewSnapshot(uint64_t version, time_t timestamp):
+    mVersion(version), mTimestamp(timestamp)
+  {}
+
+  //----------------------------------------------------------------------------
+  //! Get snapshot version, increasing with every published snapshot
+  //----------------------------------------------------------------------------
+  inline uint64_t GetVersion() const
+  {
+    return mVersion;
+  }
+
+  //----------------------------------------------------------------------------
+  //! Get creation time of the snapshot
+  //----------------------------------------------------------------------------
+  inline time_t GetTimestamp() const
+  {
+    return mTimestamp;
+  }
+
+  //----------------------------------------------------------------------------
+  //! Add a space, group or node - only used while building the snapshot
+  //!
+  //! @param name view name
+  //! @param status value of the "status" config member
+  //!
+  //! @return reference to the new entry
+  //----------------------------------------------------------------------------
+  ViewEntry& AddSpace(const std::string& name, const std::string& status);
+  ViewEntry& AddGroup(const std::string& name, const std::string& status);
+  ViewEntry& AddNode(const std::string& name, const std::string& status);
+
+  //----------------------------------------------------------------------------
+  //! Attach a group to a space - only used while building the snapshot
+  //----------------------------------------------------------------------------
+  void AddSpaceGroup(const std::string& space, const std::string& group);
+
+  //----------------------------------------------------------------------------
+  //! Add a file system - only used while building the snapshot
+  //----------------------------------------------------------------------------
+  void AddFileSystem(fs_snapshot_t&& fs);
+
+  //----------------------------------------------------------------------------
+  //! Get a space, group or node
+  //!
+  //! @param name view name
+  //!
+  //! @return entry or nullptr if not found
+  //----------------------------------------------------------------------------
+  const ViewEntry* GetSpace(const std::string& name) const;
+  const ViewEntry* GetGroup(const std::string& name) const;
+  const ViewEntry* GetNode(const std::string& name) const;
+
+  //----------------------------------------------------------------------------
+  //! Get the names of the groups of a space
+  //----------------------------------------------------------------------------
+  std::vector<std::string> GetSpaceGroups(const std::string& space) const;
+
+  //----------------------------------------------------------------------------
+  //! Get the state of a file system
+  //!
+  //! @param fsid file system id
+  //!
+  //! @return file system snapshot or nullptr if not found
+  //----------------------------------------------------------------------------
+  const fs_snapshot_t* GetFileSystem(fsid_t fsid) const;
+
+  //----------------------------------------------------------------------------
+  //! Get the state of all the file systems of a view
+  //!
+  //! @param entry space, group or node entry
+  //!
+  //! @return list of file system snapshots
+  //----------------------------------------------------------------------------
+  std::vector<const fs_snapshot_t*> GetFileSystems(const ViewEntry& entry) const;
+
+  //----------------------------------------------------------------------------
+  //! Get all the file systems
+  //----------------------------------------------------------------------------
+  inline const std::unordered_map<fsid_t, fs_snapshot_t>& GetFileSystems() const
+  {
+    return mFileSystems;
+  }
+
+  //----------------------------------------------------------------------------
+  //! Get all the spaces, groups or nodes
+  //----------------------------------------------------------------------------
+  inline const std::map<std::string, ViewEntry>& GetSpaces() const
+  {
+    return mSpaces;
+  }
+
+  inline const std::map<std::string, ViewEntry>& GetGroups() const
+  {
+    return mGroups;
+  }
+
+  inline const std::map<std::string, ViewEntry>& GetNodes() const
+  {
+    return mNodes;
+  }
+
+private:
+  uint64_t mVersion;
+  time_t mTimestamp;
+  std::map<std::string, ViewEntry> mSpaces;
+  std::map<std::string, ViewEntry> mGroups;
+  std::map<std::string, ViewEntry> mNodes;
+  std::map<std::string, std::vector<std::string>> mSpaceGroups;
+  std::unordered_map<fsid_t, fs_snapshot_t> mFileSystems;
+
+  //----------------------------------------------------------------------------
+  //! Add an entry to one of the view maps
+  //----------------------------------------------------------------------------
+  static ViewEntry& AddEntry(std::map<std::string, ViewEntry>& views,
+                             const std::string& name, const std::string& status);
+
+  //----------------------------------------------------------------------------
+  //! Lookup an entry in one of the view maps
+  //----------------------------------------------------------------------------
+  static const ViewEntry* FindEntry(const std::map<std::string, ViewEntry>&
+                                    views, const std::string& name);
+};
+
+EOSMGMNAMESPACE_END
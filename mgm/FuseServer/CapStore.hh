@@ -0,0 +1,585 @@
+//------------------------------------------------------------------------------
+//! @file CapStore.hh
+//! @brief Sharded store of the fusex capabilities with inode and client indices
+//------------------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2023 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+#pragma once
+#include "mgm/Namespace.hh"
+#include "common/RWMutex.hh"
+#include <algorithm>
+#include <ctime>
+#include <functional>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+EOSMGMNAMESPACE_BEGIN
+
+//------------------------------------------------------------------------------
+//! Class CapStore - capabilities indexed by authid, inode and client. Every
+//! index is split in shards with their own lock so that issuing, looking up
+//! and dropping caps of unrelated clients or inodes does not contend. The
+//! expiry is tracked by a timer wheel per authid shard.
+//!
+//! Modifications of a cap hold the write lock of its authid shard while
+//! updating the inode and client indices, the index locks are never held
+//! while taking an authid shard lock. Readers of an index get a copy of the
+//! authids and must tolerate caps which disappear in the meantime.
+//!
+//! @tparam CapT capability type providing authid(), id(), clientid(),
+//!         clientuuid() and vtime()
+//------------------------------------------------------------------------------
+template<typename CapT>
+class CapStore
+{
+public:
+  using shared_cap = std::shared_ptr<CapT>;
+  using authid_t = std::string;
+  using clientid_t = std::string;
+  using client_uuid_t = std::string;
+  using authid_set_t = std::set<authid_t>;
+
+  //! Number of slots of the expiry timer wheel, one per second
+  static constexpr size_t sWheelSlots = 512;
+
+  //----------------------------------------------------------------------------
+  //! Constructor
+  //!
+  //! @param num_shards number of shards of each index
+  //----------------------------------------------------------------------------
+  explicit CapStore(size_t num_shards = 64):
+    mNumShards(num_shards ? num_shards : 1),
+    mCapShards(new CapShard[mNumShards]),
+    mInodeShards(new InodeShard[mNumShards]),
+    mClientShards(new ClientShard[mNumShards]),
+    mUuidShards(new UuidShard[mNumShards])
+  {
+    for (size_t i = 0; i < mNumShards; ++i) {
+      mCapShards[i].mMutex.SetBlocking(true);
+      mInodeShards[i].mMutex.SetBlocking(true);
+      mClientShards[i].mMutex.SetBlocking(true);
+      mUuidShards[i].mMutex.SetBlocking(true);
+      mCapShards[i].mWheel.resize(sWheelSlots);
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  //! Add or replace a cap. If the authid was issued for a different inode
+  //! the previous cap is removed from the indices first.
+  //----------------------------------------------------------------------------
+  void Store(const shared_cap& cap)
+  {
+    CapShard& shard = GetCapShard(cap->authid());
+    eos::common::RWMutexWriteLock wr_lock(shard.mMutex);
+    auto it = shard.mCaps.find(cap->authid());
+
+    if (it != shard.mCaps.end()) {
+      if ((it->second->id() != cap->id()) ||
+          (it->second->clientid() != cap->clientid())) {
+        Unindex(it->second);
+        Index(cap);
+      }
+
+      // Every vtime gets its own wheel entry, the one of the previous vtime
+      // is skipped when it comes due
+      if (it->second->vtime() != cap->vtime()) {
+        Schedule(shard, cap->vtime(), cap->authid());
+      }
+
+      it->second = cap;
+    } else {
+      shard.mCaps.emplace(cap->authid(), cap);
+      Index(cap);
+      Schedule(shard, cap->vtime(), cap->authid());
+    }
+
+    // Register the client id to the client uuid
+    UuidShard& uuid_shard = GetUuidShard(cap->clientuuid());
+    eos::common::RWMutexWriteLock uuid_lock(uuid_shard.mMutex);
+    uuid_shard.mClientIds[cap->clientuuid()].insert(cap->clientid());
+  }
+
+  //----------------------------------------------------------------------------
+  //! Get cap by authid
+  //!
+  //! @return cap or nullptr if not found
+  //----------------------------------------------------------------------------
+  shared_cap Get(const authid_t& authid) const
+  {
+    const CapShard& shard = GetCapShard(authid);
+    eos::common::RWMutexReadLock rd_lock(shard.mMutex);
+    auto it = shard.mCaps.find(authid);
+    return ((it == shard.mCaps.end()) ? nullptr : it->second);
+  }
+
+  //----------------------------------------------------------------------------
+  //! Remove cap by authid
+  //!
+  //! @return removed cap or nullptr if not found
+  //----------------------------------------------------------------------------
+  shared_cap Remove(const authid_t& authid)
+  {
+    CapShard& shard = GetCapShard(authid);
+    eos::common::RWMutexWriteLock wr_lock(shard.mMutex);
+    return DoRemove(shard, authid);
+  }
+
+  //----------------------------------------------------------------------------
+  //! Remove all the caps of a client mount and forget its client ids, the
+  //! cost is proportional to the number of caps of the client.
+  //!
+  //! @return removed caps
+  //----------------------------------------------------------------------------
+  std::vector<shared_cap> RemoveClient(const client_uuid_t& uuid)
+  {
+    std::set<clientid_t> client_ids;
+    {
+      UuidShard& uuid_shard = GetUuidShard(uuid);
+      eos::common::RWMutexWriteLock uuid_lock(uuid_shard.mMutex);
+      auto it = uuid_shard.mClientIds.find(uuid);
+
+      if (it != uuid_shard.mClientIds.end()) {
+        client_ids.swap(it->second);
+        uuid_shard.mClientIds.erase(it);
+      }
+    }
+    std::vector<shared_cap> removed;
+
+    for (const auto& client_id : client_ids) {
+      for (const auto& authid : GetClientAuthIds(client_id)) {
+        CapShard& shard = GetCapShard(authid);
+        eos::common::RWMutexWriteLock wr_lock(shard.mMutex);
+        auto it = shard.mCaps.find(authid);
+
+        // The client id might have been reused by a different mount
+        if ((it != shard.mCaps.end()) && (it->second->clientuuid() == uuid)) {
+          removed.push_back(DoRemove(shard, authid));
+        }
+      }
+    }
+
+    return removed;
+  }
+
+  //----------------------------------------------------------------------------
+  //! Remove all the caps of an inode
+  //!
+  //! @return removed caps
+  //----------------------------------------------------------------------------
+  std::vector<shared_cap> RemoveInode(uint64_t ino)
+  {
+    std::vector<shared_cap> removed;
+
+    for (const auto& authid : GetInodeAuthIds(ino)) {
+      CapShard& shard = GetCapShard(authid);
+      eos::common::RWMutexWriteLock wr_lock(shard.mMutex);
+      auto it = shard.mCaps.find(authid);
+
+      if ((it != shard.mCaps.end()) && (it->second->id() == ino)) {
+        removed.push_back(DoRemove(shard, authid));
+      }
+    }
+
+    return removed;
+  }
+
+  //----------------------------------------------------------------------------
+  //! Get the authids of the caps of an inode
+  //----------------------------------------------------------------------------
+  std::vector<authid_t> GetInodeAuthIds(uint64_t ino) const
+  {
+    const InodeShard& shard = GetInodeShard(ino);
+    eos::common::RWMutexReadLock rd_lock(shard.mMutex);
+    auto it = shard.mCaps.find(ino);
+
+    if (it == shard.mCaps.end()) {
+      return {};
+    }
+
+    return std::vector<authid_t>(it->second.begin(), it->second.end());
+  }
+
+  //----------------------------------------------------------------------------
+  //! Get the authids of the caps a client holds for an inode
+  //----------------------------------------------------------------------------
+  std::vector<authid_t> GetClientInodeAuthIds(const clientid_t& client_id,
+      uint64_t ino) const
+  {
+    const ClientShard& shard = GetClientShard(client_id);
+    eos::common::RWMutexReadLock rd_lock(shard.mMutex);
+    auto it = shard.mCaps.find(client_id);
+
+    if (it != shard.mCaps.end()) {
+      auto it_ino = it->second.find(ino);
+
+      if (it_ino != it->second.end()) {
+        return std::vector<authid_t>(it_ino->second.begin(), it_ino->second.end());
+      }
+    }
+
+    return {};
+  }
+
+  //----------------------------------------------------------------------------
+  //! Get the authids of all the caps of a client
+  //----------------------------------------------------------------------------
+  std::vector<authid_t> GetClientAuthIds(const clientid_t& client_id) const
+  {
+    std::vector<authid_t> authids;
+    const ClientShard& shard = GetClientShard(client_id);
+    eos::common::RWMutexReadLock rd_lock(shard.mMutex);
+    auto it = shard.mCaps.find(client_id);
+
+    if (it != shard.mCaps.end()) {
+      for (const auto& elem : it->second) {
+        authids.insert(authids.end(), elem.second.begin(), elem.second.end());
+      }
+    }
+
+    return authids;
+  }
+
+  //----------------------------------------------------------------------------
+  //! Get all the caps of a client mount
+  //----------------------------------------------------------------------------
+  std::vector<shared_cap> GetClientCaps(const client_uuid_t& uuid) const
+  {
+    std::set<clientid_t> client_ids;
+    {
+      const UuidShard& uuid_shard = GetUuidShard(uuid);
+      eos::common::RWMutexReadLock uuid_lock(uuid_shard.mMutex);
+      auto it = uuid_shard.mClientIds.find(uuid);
+
+      if (it != uuid_shard.mClientIds.end()) {
+        client_ids = it->second;
+      }
+    }
+    std::vector<shared_cap> caps;
+
+    for (const auto& client_id : client_ids) {
+      for (const auto& authid : GetClientAuthIds(client_id)) {
+        shared_cap cap = Get(authid);
+
+        if (cap && (cap->clientuuid() == uuid)) {
+          caps.push_back(cap);
+        }
+      }
+    }
+
+    return caps;
+  }
+
+  //----------------------------------------------------------------------------
+  //! Get the inodes having caps together with their authids, sorted by inode
+  //----------------------------------------------------------------------------
+  std::map<uint64_t, authid_set_t> GetInodeIndex() const
+  {
+    std::map<uint64_t, authid_set_t> index;
+
+    for (size_t i = 0; i < mNumShards; ++i) {
+      eos::common::RWMutexReadLock rd_lock(mInodeShards[i].mMutex);
+      index.insert(mInodeShards[i].mCaps.begin(), mInodeShards[i].mCaps.end());
+    }
+
+    return index;
+  }
+
+  //----------------------------------------------------------------------------
+  //! Call a function for every cap, one shard at a time under its read lock
+  //----------------------------------------------------------------------------
+  void ForEach(const std::function<void(const shared_cap&)>& func) const
+  {
+    for (size_t i = 0; i < mNumShards; ++i) {
+      eos::common::RWMutexReadLock rd_lock(mCapShards[i].mMutex);
+
+      for (const auto& elem : mCapShards[i].mCaps) {
+        func(elem.second);
+      }
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  //! Remove the caps whose validity ended more than grace seconds ago. Caps
+  //! which were renewed in the meantime are scheduled again.
+  //!
+  //! @param now current time
+  //! @param grace seconds a cap is kept after the end of its validity
+  //!
+  //! @return number of removed caps
+  //----------------------------------------------------------------------------
+  size_t Expire(time_t now, time_t grace)
+  {
+    size_t num_removed = 0;
+    time_t until = now - grace;
+
+    for (size_t i = 0; i < mNumShards; ++i) {
+      CapShard& shard = mCapShards[i];
+      eos::common::RWMutexWriteLock wr_lock(shard.mMutex);
+
+      // The first run visits all the slots
+      if (!shard.mWheelTime) {
+        shard.mWheelTime = until - sWheelSlots;
+      }
+
+      // Visit every slot at most once per call
+      time_t first = shard.mWheelTime + 1;
+
+      if (until - first >= (time_t) sWheelSlots) {
+        first = until - sWheelSlots + 1;
+      }
+
+      std::vector<std::pair<time_t, authid_t>> due;
+
+      for (time_t t = first; t <= until; ++t) {
+        auto& slot = shard.mWheel[t % sWheelSlots];
+
+        for (size_t pos = 0; pos < slot.size();) {
+          if (slot[pos].first <= until) {
+            due.push_back(std::move(slot[pos]));
+            slot[pos] = std::move(slot.back());
+            slot.pop_back();
+          } else {
+            ++pos;
+          }
+        }
+      }
+
+      if (until > shard.mWheelTime) {
+        shard.mWheelTime = until;
+      }
+
+      for (auto& elem : due) {
+        auto it = shard.mCaps.find(elem.second);
+
+        if (it == shard.mCaps.end()) {
+          continue;
+        }
+
+        // Stale entry, the cap was stored again with another vtime
+        if ((time_t) it->second->vtime() != elem.first) {
+          continue;
+        }
+
+        DoRemove(shard, elem.second);
+        ++num_removed;
+      }
+    }
+
+    return num_removed;
+  }
+
+  //----------------------------------------------------------------------------
+  //! Number of caps
+  //----------------------------------------------------------------------------
+  size_t Size() const
+  {
+    size_t count = 0;
+
+    for (size_t i = 0; i < mNumShards; ++i) {
+      eos::common::RWMutexReadLock rd_lock(mCapShards[i].mMutex);
+      count += mCapShards[i].mCaps.size();
+    }
+
+    return count;
+  }
+
+  //----------------------------------------------------------------------------
+  //! Number of inodes and clients having caps
+  //----------------------------------------------------------------------------
+  size_t NumInodes() const
+  {
+    size_t count = 0;
+
+    for (size_t i = 0; i < mNumShards; ++i) {
+      eos::common::RWMutexReadLock rd_lock(mInodeShards[i].mMutex);
+      count += mInodeShards[i].mCaps.size();
+    }
+
+    return count;
+  }
+
+  size_t NumClients() const
+  {
+    size_t count = 0;
+
+    for (size_t i = 0; i < mNumShards; ++i) {
+      eos::common::RWMutexReadLock rd_lock(mClientShards[i].mMutex);
+      count += mClientShards[i].mCaps.size();
+    }
+
+    return count;
+  }
+
+  //----------------------------------------------------------------------------
+  //! Apply the blocked-for interval to all the shard mutexes
+  //----------------------------------------------------------------------------
+  void SetBlockedForMsInterval(int64_t blockedfor)
+  {
+    for (size_t i = 0; i < mNumShards; ++i) {
+      mCapShards[i].mMutex.SetBlockedForMsInterval(blockedfor);
+      mInodeShards[i].mMutex.SetBlockedForMsInterval(blockedfor);
+      mClientShards[i].mMutex.SetBlockedForMsInterval(blockedfor);
+      mUuidShards[i].mMutex.SetBlockedForMsInterval(blockedfor);
+    }
+  }
+
+private:
+  //! Caps by authid and their expiry timer wheel
+  struct CapShard {
+    mutable eos::common::RWMutex mMutex;
+    std::unordered_map<authid_t, shared_cap> mCaps;
+    //! Slot t % sWheelSlots holds the (vtime, authid) pairs of second t
+    std::vector<std::vector<std::pair<time_t, authid_t>>> mWheel;
+    time_t mWheelTime {0}; ///< Last second processed by the wheel
+  };
+
+  //! Authids by inode
+  struct InodeShard {
+    mutable eos::common::RWMutex mMutex;
+    std::unordered_map<uint64_t, authid_set_t> mCaps;
+  };
+
+  //! Authids by client id and inode
+  struct ClientShard {
+    mutable eos::common::RWMutex mMutex;
+    std::unordered_map<clientid_t,
+        std::unordered_map<uint64_t, authid_set_t>> mCaps;
+  };
+
+  //! Client ids by client uuid
+  struct UuidShard {
+    mutable eos::common::RWMutex mMutex;
+    std::unordered_map<client_uuid_t, std::set<clientid_t>> mClientIds;
+  };
+
+  const size_t mNumShards;
+  std::unique_ptr<CapShard[]> mCapShards;
+  std::unique_ptr<InodeShard[]> mInodeShards;
+  std::unique_ptr<ClientShard[]> mClientShards;
+  std::unique_ptr<UuidShard[]> mUuidShards;
+
+  CapShard& GetCapShard(const authid_t& authid) const
+  {
+    return mCapShards[std::hash<authid_t>()(authid) % mNumShards];
+  }
+
+  InodeShard& GetInodeShard(uint64_t ino) const
+  {
+    // Consecutive inodes are spread over the shards
+    return mInodeShards[(ino * 0x9e3779b97f4a7c15ull >> 32) % mNumShards];
+  }
+
+  ClientShard& GetClientShard(const clientid_t& client_id) const
+  {
+    return mClientShards[std::hash<clientid_t>()(client_id) % mNumShards];
+  }
+
+  UuidShard& GetUuidShard(const client_uuid_t& uuid) const
+  {
+    return mUuidShards[std::hash<client_uuid_t>()(uuid) % mNumShards];
+  }
+
+  //----------------------------------------------------------------------------
+  //! Add a cap to the inode and client indices
+  //----------------------------------------------------------------------------
+  void Index(const shared_cap& cap)
+  {
+    {
+      InodeShard& shard = GetInodeShard(cap->id());
+      eos::common::RWMutexWriteLock wr_lock(shard.mMutex);
+      shard.mCaps[cap->id()].insert(cap->authid());
+    }
+    ClientShard& shard = GetClientShard(cap->clientid());
+    eos::common::RWMutexWriteLock wr_lock(shard.mMutex);
+    shard.mCaps[cap->clientid()][cap->id()].insert(cap->authid());
+  }
+
+  //----------------------------------------------------------------------------
+  //! Remove a cap from the inode and client indices
+  //----------------------------------------------------------------------------
+  void Unindex(const shared_cap& cap)
+  {
+    {
+      InodeShard& shard = GetInodeShard(cap->id());
+      eos::common::RWMutexWriteLock wr_lock(shard.mMutex);
+      auto it = shard.mCaps.find(cap->id());
+
+      if (it != shard.mCaps.end()) {
+        it->second.erase(cap->authid());
+
+        if (it->second.empty()) {
+          shard.mCaps.erase(it);
+        }
+      }
+    }
+    ClientShard& shard = GetClientShard(cap->clientid());
+    eos::common::RWMutexWriteLock wr_lock(shard.mMutex);
+    auto it = shard.mCaps.find(cap->clientid());
+
+    if (it != shard.mCaps.end()) {
+      auto it_ino = it->second.find(cap->id());
+
+      if (it_ino != it->second.end()) {
+        it_ino->second.erase(cap->authid());
+
+        if (it_ino->second.empty()) {
+          it->second.erase(it_ino);
+        }
+      }
+
+      if (it->second.empty()) {
+        shard.mCaps.erase(it);
+      }
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  //! Remove a cap, the shard write lock must be held
+  //----------------------------------------------------------------------------
+  shared_cap DoRemove(CapShard& shard, const authid_t& authid)
+  {
+    auto it = shard.mCaps.find(authid);
+
+    if (it == shard.mCaps.end()) {
+      return nullptr;
+    }
+
+    shared_cap cap = it->second;
+    shard.mCaps.erase(it);
+    Unindex(cap);
+    return cap;
+  }
+
+  //----------------------------------------------------------------------------
+  //! Schedule the expiry check of a cap, the shard write lock must be held
+  //----------------------------------------------------------------------------
+  void Schedule(CapShard& shard, time_t vtime, const authid_t& authid)
+  {
+    // Entries already due are checked at the next expiry run
+    time_t slot_time = std::max(vtime, shard.mWheelTime + 1);
+    shard.mWheel[slot_time % sWheelSlots].emplace_back(vtime, authid);
+  }
+};
+
+EOSMGMNAMESPACE_END
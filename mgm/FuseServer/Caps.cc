@@ -27,6 +27,7 @@
 #include "mgm/FuseServer/Caps.hh"
 #include <thread>
 #include <regex>
+#include <algorithm>
 
 #include "common/Logging.hh"
 #include "common/Timing.hh"
@@ -48,41 +49,14 @@ FuseServer::Caps::Store(const eos::fusex::cap& ecap,
 {
   gOFS->MgmStats.Add("Eosxd::int::Store", 0, 0, 1);
   EXEC_TIMING_BEGIN("Eosxd::int::Store");
-  eos::common::RWMutexWriteLock lLock(*this);
   eos_static_info("id=%lx clientid=%s authid=%s",
                   ecap.id(),
                   ecap.clientid().c_str(),
                   ecap.authid().c_str());
-
-  // register this clientid to a given client uuid
-  ClientIds()[ecap.clientuuid()].insert(ecap.clientid());
-
-  // avoid to have multiple time entries for the same cap
-  auto kv = mCaps.find(ecap.authid());
-
-  if (kv == mCaps.end()) {
-    // fill the three views on caps
-    mTimeOrderedCap.insert(std::pair<time_t, authid_t>(ecap.vtime(),
-                           ecap.authid()));
-  } else {
-    shared_cap cap = kv->second;
-    if (cap->id() != ecap.id()) {
-      eos_static_info("got inode change for %s from %x to %x",
-		      ecap.authid().c_str(), cap->id(), ecap.id());
-      Remove(cap);
-      // fill the three views on caps
-      mTimeOrderedCap.insert(std::pair<time_t, authid_t>(ecap.vtime(),
-							 ecap.authid()));
-    }
-  }
-
-  mClientCaps[ecap.clientid()].insert(ecap.authid());
-  mClientInoCaps[ecap.clientid()][ecap.id()].insert(ecap.authid());
   shared_cap cap = std::make_shared<capx>();
   *cap = ecap;
   cap->set_vid(vid);
-  mCaps[ecap.authid()] = cap;
-  mInodeCaps[ecap.id()].insert(ecap.authid());
+  mStore.Store(cap);
   EXEC_TIMING_END("Eosxd::int::Store");
 }
 
@@ -117,32 +91,21 @@ FuseServer::Caps::Imply(uint64_t md_ino,
       eos::common::RWMutexReadLock lLock(gOFS->zMQ->gFuseServer.Client());
       leasetime = gOFS->zMQ->gFuseServer.Client().leasetime(cap->clientuuid());
     }
-    eos::common::RWMutexWriteLock lock(*this);
     implied_cap->set_vtime(ts.tv_sec + (leasetime ? leasetime : 300));
     implied_cap->set_vtime_ns(ts.tv_nsec);
-    // fill the three views on caps
-    mTimeOrderedCap.insert(std::pair<time_t, authid_t>(implied_cap->vtime(),
-                           implied_authid));
-    mClientCaps[cap->clientid()].insert(implied_authid);
-    mClientInoCaps[cap->clientid()][cap->id()].insert(implied_authid);
-    mCaps[implied_authid] = implied_cap;
-    mInodeCaps[md_ino].insert(implied_authid);
+    mStore.Store(implied_cap);
   }
   return true;
 }
 
 //------------------------------------------------------------------------------
-// Get shared capability - one needs to hold (at least) the read lock
+// Get shared capability or an empty one if not found
 //------------------------------------------------------------------------------
 FuseServer::Caps::shared_cap
 FuseServer::Caps::Get(FuseServer::Caps::authid_t id)
 {
-  if (auto kv = mCaps.find(id);
-      kv != mCaps.end()) {
-    return kv->second;
-  } else {
-    return std::make_shared<capx>();
-  }
+  shared_cap cap = mStore.Get(id);
+  return (cap ? cap : std::make_shared<capx>());
 }
 
 //------------------------------------------------------------------------------
@@ -151,7 +114,6 @@ FuseServer::Caps::Get(FuseServer::Caps::authid_t id)
 FuseServer::Caps::shared_cap
 FuseServer::Caps::GetTS(FuseServer::Caps::authid_t id)
 {
-  eos::common::RWMutexReadLock lLock(*this);
   return Get(id);
 }
 
@@ -166,21 +128,12 @@ FuseServer::Caps::GetBroadcastCapsTS(uint64_t id,
                                      std::string suppress_stat_tag)
 {
   std::vector<shared_cap> bccaps;
-  std::vector<authid_t> auth_ids;
+  std::vector<authid_t> auth_ids = mStore.GetInodeAuthIds(id);
   size_t n_suppressed {0};
   regex_t regex;
 
-  {
-    eos::common::RWMutexReadLock rlock(*this);
-    auto ids = mInodeCaps.find(id);
-    if (ids == mInodeCaps.end()) {
-      return bccaps;
-    }
-
-    auth_ids.reserve(ids->second.size());
-    std::copy(ids->second.begin(),
-              ids->second.end(),
-              std::back_inserter(auth_ids));
+  if (auth_ids.empty()) {
+    return bccaps;
   }
 
   if (suppress) {
@@ -256,11 +209,10 @@ FuseServer::Caps::BroadcastReleaseFromExternal(uint64_t id)
   auto bccaps = GetBroadcastCapsTS(id);
 
   for (auto it : bccaps) {
-    eos_static_debug("ReleaseCAP id %#lx clientid %s", it->clientid().c_str());
-    gOFS->zMQ->gFuseServer.Client().ReleaseCAP((uint64_t) it->id(),
-        it->clientuuid(),
-        it->clientid());
-    errno = 0 ; // seems that ZMQ function might set errno
+    eos_static_debug("ReleaseCAP id %#lx clientid %s", it->id(),
+                     it->clientid().c_str());
+    gOFS->zMQ->gFuseServer.CastQueue().Release(it->clientuuid(), it->clientid(),
+        (uint64_t) it->id());
   }
 
   EXEC_TIMING_END("Eosxd::int::BcReleaseExt");
@@ -279,10 +231,8 @@ FuseServer::Caps::BroadcastRefreshFromExternal(uint64_t id, uint64_t pid)
   auto bccaps = GetBroadcastCapsTS(pid, nullptr, nullptr, true, "Eosxd::int::BcRefreshExtSup");
 
   for (auto it : bccaps) {
-    gOFS->zMQ->gFuseServer.Client().RefreshEntry((uint64_t) id,
-        it->clientuuid(),
-        it->clientid());
-    errno = 0 ; // seems that ZMQ function might set errno
+    gOFS->zMQ->gFuseServer.CastQueue().Refresh(it->clientuuid(), it->clientid(),
+        (uint64_t) id);
   }
 
   EXEC_TIMING_END("Eosxd::int::BcRefreshExt");
@@ -310,10 +260,8 @@ FuseServer::Caps::BroadcastRelease(const eos::fusex::md& md)
   auto bccaps = GetBroadcastCapsTS(md_pino, refcap, &md);
 
   for (auto it : bccaps) {
-    gOFS->zMQ->gFuseServer.Client().ReleaseCAP((uint64_t) it->id(),
-        it->clientuuid(),
-        it->clientid());
-    errno = 0 ;
+    gOFS->zMQ->gFuseServer.CastQueue().Release(it->clientuuid(), it->clientid(),
+        (uint64_t) it->id());
   }
 
   EXEC_TIMING_END("Eosxd::int::BcRelease");
@@ -333,11 +281,8 @@ FuseServer::Caps::BroadcastDeletionFromExternal(uint64_t id,
   auto bccaps = GetBroadcastCapsTS(id);
 
   for (auto it : bccaps) {
-    gOFS->zMQ->gFuseServer.Client().DeleteEntry((uint64_t) it->id(),
-        it->clientuuid(),
-        it->clientid(),
-        name);
-    errno = 0 ; // seems that ZMQ function might set errno
+    gOFS->zMQ->gFuseServer.CastQueue().Deletion(it->clientuuid(), it->clientid(),
+        (uint64_t) it->id(), name);
   }
 
   EXEC_TIMING_END("Eosxd::int::BcDeletionExt");
@@ -357,11 +302,8 @@ FuseServer::Caps::BroadcastDeletion(uint64_t id, const eos::fusex::md& md,
   auto bccaps = GetBroadcastCapsTS(refcap->id(), refcap, &md);
 
   for (auto it : bccaps) {
-    gOFS->zMQ->gFuseServer.Client().DeleteEntry((uint64_t) it->id(),
-        it->clientuuid(),
-        it->clientid(),
-        name);
-    errno = 0;
+    gOFS->zMQ->gFuseServer.CastQueue().Deletion(it->clientuuid(), it->clientid(),
+        (uint64_t) it->id(), name);
   }
 
   EXEC_TIMING_END("Eosxd::int::BcDeletion");
@@ -380,22 +322,12 @@ FuseServer::Caps::BroadcastRefresh(uint64_t inode,
   eos_static_info("id=%lx parent=%lx", inode, parent_inode);
   size_t n_suppressed = 0;
   std::vector<authid_t> auth_ids;
-  FuseServer::Caps::shared_cap refcap {nullptr};
+  FuseServer::Caps::shared_cap refcap = Get(md.authid());
+  auth_ids = mStore.GetInodeAuthIds(parent_inode);
 
-  {
-    eos::common::RWMutexReadLock lLock(*this);
-    refcap = Get(md.authid());
-
-    auto kv = mInodeCaps.find(parent_inode);
-    if (kv == mInodeCaps.end()) {
-      EXEC_TIMING_END("Eosxd::int::BcRefresh");
-      return 0; // nothing to process here
-    }
-
-    auth_ids.reserve(kv->second.size());
-    std::copy(kv->second.begin(),
-              kv->second.end(),
-              std::back_inserter(auth_ids));
+  if (auth_ids.empty()) {
+    EXEC_TIMING_END("Eosxd::int::BcRefresh");
+    return 0; // nothing to process here
   }
 
 
@@ -441,11 +373,8 @@ FuseServer::Caps::BroadcastRefresh(uint64_t inode,
       }
     }
 
-    gOFS->zMQ->gFuseServer.Client().RefreshEntry((uint64_t) inode,
-                                                 cap->clientuuid(),
-                                                 cap->clientid()
-                                                 );
-    errno = 0;
+    gOFS->zMQ->gFuseServer.CastQueue().Refresh(cap->clientuuid(),
+        cap->clientid(), (uint64_t) inode);
   }
 
   if (n_suppressed) {
@@ -480,22 +409,12 @@ FuseServer::Caps::BroadcastMD(const eos::fusex::md& md,
   std::vector<shared_cap> bccaps;
   std::set<std::string> clients_sent;
   std::vector<authid_t> auth_ids;
-  FuseServer::Caps::shared_cap refcap {nullptr};
-
-  {
-    eos::common::RWMutexReadLock lLock(*this);
-    refcap = Get(md.authid());
+  FuseServer::Caps::shared_cap refcap = Get(md.authid());
+  auth_ids = mStore.GetInodeAuthIds(md_pino);
 
-    auto kv = mInodeCaps.find(md_pino);
-    if (kv == mInodeCaps.end()) {
-      EXEC_TIMING_END("Eosxd::int::BcRefresh");
-      return 0; // nothing to process here
-    }
-
-    auth_ids.reserve(kv->second.size());
-    std::copy(kv->second.begin(),
-              kv->second.end(),
-              std::back_inserter(auth_ids));
+  if (auth_ids.empty()) {
+    EXEC_TIMING_END("Eosxd::int::BcRefresh");
+    return 0; // nothing to process here
   }
   eos_static_info("id=%lx/%lx clientid=%s clientuuid=%s authid=%s",
                   refcap->id(), md_pino, refcap->clientid().c_str(),
@@ -552,6 +471,8 @@ FuseServer::Caps::BroadcastMD(const eos::fusex::md& md,
       // make sure we sent the update only once to each client, even if this
       // one has many caps
       clients_sent.insert(cap->clientuuid());
+      // queued invalidations must reach the client before this update
+      gOFS->zMQ->gFuseServer.CastQueue().Flush(cap->clientuuid());
       gOFS->zMQ->gFuseServer.Client().SendMD(md,
                                              cap->clientuuid(),
                                              cap->clientid(),
@@ -586,7 +507,6 @@ FuseServer::Caps::Print(std::string option, std::string filter)
     lock.Grab(gOFS->eosViewRWMutex, __FUNCTION__, __LINE__, __FILE__);
   }
 
-  eos::common::RWMutexReadLock lLock(*this);
   eos_static_info("option=%s string=%s", option.c_str(), filter.c_str());
   regex_t regex;
 
@@ -599,18 +519,18 @@ FuseServer::Caps::Print(std::string option, std::string filter)
   }
 
   if (option == "t") {
-    lLock.Release();
-    eos::common::RWMutexWriteLock wLock(*this);
-
     // print by time order
-    for (auto it = mTimeOrderedCap.begin(); it != mTimeOrderedCap.end();) {
-      if (!mCaps.count(it->second)) {
-        it = mTimeOrderedCap.erase(it);
-        continue;
-      }
-
+    std::vector<shared_cap> caps;
+    mStore.ForEach([&caps](const shared_cap & cap) {
+      caps.push_back(cap);
+    });
+    std::stable_sort(caps.begin(), caps.end(),
+    [](const shared_cap & a, const shared_cap & b) {
+      return a->vtime() < b->vtime();
+    });
+
+    for (const auto& cap : caps) {
       char ahex[256];
-      shared_cap cap = mCaps[it->second];
       snprintf(ahex, sizeof(ahex), "%016lx", (unsigned long) cap->id());
       std::string match = "";
       match += "# i:";
@@ -638,18 +558,22 @@ FuseServer::Caps::Print(std::string option, std::string filter)
 
       if (filter.size() &&
           (regexec(&regex, match.c_str(), 0, NULL, 0) == REG_NOMATCH)) {
-        it++;
         continue;
       }
 
       out += match.c_str();
-      ++it;
     }
   }
 
+  std::map<uint64_t, authid_set_t> inode_caps;
+
+  if ((option == "i") || (option == "p")) {
+    inode_caps = mStore.GetInodeIndex();
+  }
+
   if (option == "i") {
     // print by inode
-    for (auto it = mInodeCaps.begin(); it != mInodeCaps.end(); ++it) {
+    for (auto it = inode_caps.begin(); it != inode_caps.end(); ++it) {
       char ahex[256];
       snprintf(ahex, sizeof(ahex), "%016lx", (unsigned long) it->first);
 
@@ -665,10 +589,11 @@ FuseServer::Caps::Print(std::string option, std::string filter)
         out += "___ a:";
         out += *sit;
 
-        if (!mCaps.count(*sit)) {
+        shared_cap cap = mStore.Get(*sit);
+
+        if (!cap) {
           out += " c:<unfound> u:<unfound> m:<unfound> v:<unfound>\n";
         } else {
-          shared_cap cap = mCaps[*sit];
           out += " c:";
           out += cap->clientid();
           out += " u:";
@@ -687,7 +612,7 @@ FuseServer::Caps::Print(std::string option, std::string filter)
 
   if (option == "p") {
     // print by inode
-    for (auto it = mInodeCaps.begin(); it != mInodeCaps.end(); ++it) {
+    for (auto it = inode_caps.begin(); it != inode_caps.end(); ++it) {
       std::string spath;
 
       try {
@@ -721,10 +646,11 @@ FuseServer::Caps::Print(std::string option, std::string filter)
         out += "___ a:";
         out += *sit;
 
-        if (!mCaps.count(*sit)) {
+        shared_cap cap = mStore.Get(*sit);
+
+        if (!cap) {
           out += " c:<unfound> u:<unfound> m:<unfound> v:<unfound>\n";
         } else {
-          shared_cap cap = mCaps[*sit];
           out += " c:";
           out += cap->clientid();
           out += " u:";
@@ -751,61 +677,10 @@ FuseServer::Caps::Print(std::string option, std::string filter)
 int
 FuseServer::Caps::Delete(uint64_t md_ino)
 {
-  // Hash functor used for storing client_set_t::iterator objects in an
-  // unordered set
-  struct iter_client_set_hash {
-    size_t operator()(client_set_t::iterator it) const
-    {
-      return std::hash<std::string>()(it->first);
-    }
-  };
-  std::unordered_set<client_set_t::iterator, iter_client_set_hash>
-  to_del_client_caps;
-  eos::common::RWMutexWriteLock lLock(*this);
-  const auto it_inode_caps = mInodeCaps.find(md_ino);
-
-  if (it_inode_caps == mInodeCaps.end()) {
+  if (mStore.RemoveInode(md_ino).empty()) {
     return ENONET;
   }
 
-  const authid_set_t& set_authid = it_inode_caps->second;
-
-  for (auto it_client_caps = mClientCaps.begin();
-       it_client_caps != mClientCaps.end(); ++it_client_caps) {
-    for (const auto& authid : set_authid) {
-      // erase authid from the client set
-      it_client_caps->second.erase(authid);
-
-      if (it_client_caps->second.empty()) {
-        to_del_client_caps.insert(it_client_caps);
-      }
-    }
-  }
-
-  for (auto& it_elem : to_del_client_caps) {
-    mClientCaps.erase(it_elem);
-  }
-
-  for (const auto& authid : set_authid) {
-    const auto it_caps = mCaps.find(authid);
-
-    if (it_caps != mCaps.end()) {
-      const std::string client_id = it_caps->second->clientid();
-      auto it_cli_inocaps = mClientInoCaps.find(client_id);
-
-      if (it_cli_inocaps != mClientInoCaps.end()) {
-        it_cli_inocaps->second.erase(md_ino);
-
-        if (it_cli_inocaps->second.size() == 0) {
-          mClientInoCaps.erase(it_cli_inocaps);
-        }
-      }
-
-      mCaps.erase(it_caps);
-    }
-  }
-
-  mInodeCaps.erase(it_inode_caps);
   return 0;
 }
 
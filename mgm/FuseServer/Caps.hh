@@ -26,9 +26,11 @@
 
 #include <thread>
 #include <map>
+#include <functional>
 
 #include "mgm/Namespace.hh"
 #include "mgm/fusex.pb.h"
+#include "mgm/FuseServer/CapStore.hh"
 
 #include "common/Mapping.hh"
 #include "common/Timing.hh"
@@ -40,7 +42,7 @@ EOSFUSESERVERNAMESPACE_BEGIN
 //----------------------------------------------------------------------------
 //! Class Caps
 //----------------------------------------------------------------------------
-class Caps : public eos::common::RWMutex
+class Caps
 {
   friend class FuseServer;
 public:
@@ -74,73 +76,28 @@ public:
 
   typedef std::shared_ptr<capx> shared_cap;
 
-  Caps(): eos::common::RWMutex()
-  {
-    mBlocking = true;
-  }
+  Caps() = default;
 
   virtual ~Caps() = default;
 
   typedef std::string authid_t;
   typedef std::string clientid_t;
   typedef std::string client_uuid_t;
-  typedef std::set<clientid_t> clientid_set_t;
-  typedef std::map<client_uuid_t, clientid_set_t> client_ids_t;
-  typedef std::pair<uint64_t, authid_t> ino_authid_t;
   typedef std::set<authid_t> authid_set_t;
-  typedef std::map<uint64_t, authid_set_t> ino_map_t;
-  typedef std::set<uint64_t> ino_set_t;
-  typedef std::map<uint64_t, authid_set_t> notify_set_t; // inode=>set(authid_t)
-  typedef std::map<clientid_t, authid_set_t> client_set_t;
-  typedef std::map<clientid_t, ino_map_t> client_ino_map_t;
-
 
   ssize_t ncaps()
   {
-    eos::common::RWMutexReadLock lock(*this);
-    return mTimeOrderedCap.size();
+    return mStore.Size();
   }
 
-  void pop()
+  //----------------------------------------------------------------------------
+  //! Remove the caps which expired more than 10 seconds ago
+  //!
+  //! @return number of removed caps
+  //----------------------------------------------------------------------------
+  size_t Expire()
   {
-    eos::common::RWMutexWriteLock lock(*this);
-
-    if (!mTimeOrderedCap.empty()) {
-      mTimeOrderedCap.erase(mTimeOrderedCap.begin());
-    }
-  }
-
-  bool expire()
-  {
-    eos::common::RWMutexWriteLock lock(*this);
-    authid_t id;
-    time_t idtime = 0;
-
-    if (!mTimeOrderedCap.empty()) {
-      id = mTimeOrderedCap.begin()->second;
-      idtime = mTimeOrderedCap.begin()->first;
-    } else {
-      return false;
-    }
-
-    // TODO: C++17 - move initialization inside if
-    auto it = mCaps.find(id);
-    if (it != mCaps.end()) {
-      shared_cap cap = it->second;
-      uint64_t now = (uint64_t) time(NULL);
-
-      if ((cap->vtime() + 10) <= now) {
-        return Remove(cap);
-      } else {
-        if ((idtime + 10) <= now) {
-          return true;
-        } else {
-          return false;
-        }
-      }
-    }
-
-    return true;
+    return mStore.Expire(time(NULL), 10);
   }
 
   void Store(const eos::fusex::cap& cap,
@@ -154,66 +111,12 @@ public:
   void dropCaps(const std::string& uuid)
   {
     eos_static_info("drop client caps: %s", uuid.c_str());
-
-    std::vector<shared_cap> deleteme;
-    {
-      eos::common::RWMutexReadLock lock(*this);
-
-      for (auto it=mCaps.begin(); it!=mCaps.end(); ++it) {
-        if (it->second->clientuuid() == uuid) {
-          deleteme.push_back(it->second);
-        }
-      }
-    }
-    {
-      for (auto it=deleteme.begin(); it!=deleteme.end(); ++it) {
-	eos::common::RWMutexWriteLock lock(*this);
-        shared_cap cap = *it;
-        Remove(*it);
-      }
-    }
-
-    // cleanup by client ids
-    {
-      eos::common::RWMutexWriteLock lock(*this);
-      auto uuid_iter = mClientIds.find(uuid);
-      if (uuid_iter != mClientIds.end()) {
-        for (auto it = uuid_iter->second.begin(); it != uuid_iter->second.end(); ++it) {
-          mClientCaps.erase(*it);
-          mClientInoCaps.erase(*it);
-        }
-        mClientIds.erase(uuid_iter);
-      }
-    }
+    mStore.RemoveClient(uuid);
   }
 
   bool Remove(shared_cap cap)
   {
-    // you have to have a write lock for the caps
-    bool rc = mCaps.erase(cap->authid());
-
-    mInodeCaps[cap->id()].erase(cap->authid());
-
-    if (!mInodeCaps[cap->id()].size()) {
-      mInodeCaps.erase(cap->id());
-    }
-
-    mClientInoCaps[cap->clientid()][cap->id()].erase(cap->authid());
-
-    if (!mClientInoCaps[cap->clientid()][cap->id()].size()) {
-      mClientInoCaps[cap->clientid()].erase(cap->id());
-
-      if (!mClientInoCaps[cap->clientid()].size()) {
-	mClientInoCaps.erase(cap->clientid());
-      }
-    }
-
-    mClientCaps[cap->clientid()].erase(cap->authid());
-
-    if (mClientCaps[cap->clientid()].size() == 0) {
-      mClientCaps.erase(cap->clientid());
-    }
-    return rc;
+    return (mStore.Remove(cap->authid()) != nullptr);
   }
 
   int Delete(uint64_t id);
@@ -256,43 +159,46 @@ public:
                  ); // broad cast changed md around
   std::string Print(std::string option, std::string filter);
 
-  std::map<authid_t, shared_cap>& GetCaps()
+  //----------------------------------------------------------------------------
+  //! Get all the caps of a client mount
+  //----------------------------------------------------------------------------
+  std::vector<shared_cap> GetClientCaps(const client_uuid_t& uuid)
   {
-    return mCaps;
+    return mStore.GetClientCaps(uuid);
   }
 
-  bool HasCap(authid_t authid)
+  //----------------------------------------------------------------------------
+  //! Get the authids a client holds for an inode
+  //----------------------------------------------------------------------------
+  std::vector<authid_t> GetClientInodeAuthIds(const clientid_t& clientid,
+      uint64_t ino)
   {
-    return (this->mCaps.count(authid) ? true : false);
+    return mStore.GetClientInodeAuthIds(clientid, ino);
   }
 
-  notify_set_t& InodeCaps()
+  //----------------------------------------------------------------------------
+  //! Call a function for every cap
+  //----------------------------------------------------------------------------
+  void ForEach(const std::function<void(const shared_cap&)>& func)
   {
-    return mInodeCaps;
+    mStore.ForEach(func);
   }
 
-  client_set_t& ClientCaps()
+  std::string Dump()
   {
-    return mClientCaps;
+    // The client and client-inode indices are the same structure now
+    std::string ncaps = std::to_string(mStore.Size());
+    std::string nclients = std::to_string(mStore.NumClients());
+    return ncaps + " c: " + ncaps + " cc: " + nclients + " cic: " + nclients +
+           " ic: " + std::to_string(mStore.NumInodes());
   }
 
-  client_ino_map_t& ClientInoCaps()
+  //----------------------------------------------------------------------------
+  //! Apply the blocked-for interval to the locks of the cap store
+  //----------------------------------------------------------------------------
+  void SetBlockedForMsInterval(int64_t blockedfor)
   {
-    return mClientInoCaps;
-  }
-
-  client_ids_t& ClientIds()
-  {
-    return mClientIds;
-  }
-
-  std::string Dump() {
-    std::string s;
-    eos::common::RWMutexReadLock lock(*this);
-    s = std::to_string(mTimeOrderedCap.size()) + " c: " + std::to_string(mCaps.size()) + " cc: "
-      + std::to_string(mClientCaps.size()) + " cic: " + std::to_string(mClientInoCaps.size()) + " ic: "
-      + std::to_string(mInodeCaps.size());
-    return s;
+    mStore.SetBlockedForMsInterval(blockedfor);
   }
 
   // Given a pid, return a vector of shared caps matching this
@@ -306,18 +212,8 @@ public:
 
 
 protected:
-  // a time ordered multimap pointing to caps
-  std::multimap< time_t, authid_t > mTimeOrderedCap;
-  // authid=>cap lookup map
-  std::map<authid_t, shared_cap> mCaps;
-  // clientid=>list of authid
-  client_set_t mClientCaps;
-  // clientid=>list of inodes
-  client_ino_map_t mClientInoCaps;
-  // inode=>authid_t
-  notify_set_t mInodeCaps;
-  // uuid=>set of clientid
-  client_ids_t mClientIds;
+  //! Caps indexed by authid, inode and client
+  CapStore<capx> mStore;
 };
 
 EOSFUSESERVERNAMESPACE_END
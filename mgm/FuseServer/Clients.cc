@@ -152,7 +152,7 @@ FuseServer::Clients::MonitorHeartBeat()
     if (!evictversionmap.empty()) {
       for (auto it = evictversionmap.begin(); it != evictversionmap.end(); ++it) {
         std::string versionerror =
-          "Server supports PROTOCOLV4 and requires atleast PROTOCOLV2";
+          "Server supports PROTOCOLV5 and requires atleast PROTOCOLV2";
         std::string uuid = it->first;
         Evict(uuid, versionerror);
         eos::common::RWMutexWriteLock lLock(*this);
@@ -264,7 +264,6 @@ FuseServer::Clients::Dispatch(const std::string identity,
 
       // revoke LEASES by cap
       for (auto it = caps_to_revoke.begin(); it != caps_to_revoke.end(); ++it) {
-        eos::common::RWMutexWriteLock lLock(gOFS->zMQ->gFuseServer.Cap());
         gOFS->zMQ->gFuseServer.Cap().Remove(*it);
       }
 
@@ -323,20 +322,11 @@ FuseServer::Clients::Print(std::string& out, std::string options)
   struct timespec tsnow;
   eos::common::Timing::GetTimeSpec(tsnow);
   std::map<std::string, size_t> clientcaps;
-  {
-    eos::common::RWMutexReadLock lLock(gOFS->zMQ->gFuseServer.Cap());
-
-    // count caps per client uuid
-    for (auto it = gOFS->zMQ->gFuseServer.Cap().InodeCaps().begin();
-         it != gOFS->zMQ->gFuseServer.Cap().InodeCaps().end(); ++it) {
-      for (auto sit = it->second.begin(); sit != it->second.end(); ++sit) {
-        if (gOFS->zMQ->gFuseServer.Cap().GetCaps().count(*sit)) {
-          FuseServer::Caps::shared_cap cap = gOFS->zMQ->gFuseServer.Cap().GetCaps()[*sit];
-          clientcaps[cap->clientuuid()]++;
-        }
-      }
-    }
-  }
+  // count caps per client uuid
+  gOFS->zMQ->gFuseServer.Cap().ForEach([&clientcaps](const
+  FuseServer::Caps::shared_cap & cap) {
+    clientcaps[cap->clientuuid()]++;
+  });
   struct timespec now_time;
   eos::common::Timing::GetTimeSpec(now_time, true);
   eos::common::RWMutexReadLock lLock(*this);
@@ -776,29 +766,19 @@ FuseServer::Clients::Dropcaps(const std::string& uuid, std::string& out)
   out += " dropping caps of '";
   out += uuid;
   out += "' : ";
-  std::set<FuseServer::Caps::shared_cap> cap2delete;
-  eos::common::RWMutexWriteLock lLock(gOFS->zMQ->gFuseServer.Cap());
-
-  for (auto it = gOFS->zMQ->gFuseServer.Cap().InodeCaps().begin();
-       it != gOFS->zMQ->gFuseServer.Cap().InodeCaps().end(); ++it) {
-    for (auto sit = it->second.begin(); sit != it->second.end(); ++sit) {
-      if (gOFS->zMQ->gFuseServer.Cap().HasCap(*sit)) {
-        FuseServer::Caps::shared_cap cap = gOFS->zMQ->gFuseServer.Cap().GetCaps()[*sit];
-
-        if (cap->clientuuid() == uuid) {
-          cap2delete.insert(cap);
-          out += "\n ";
-          char ahex[20];
-          snprintf(ahex, sizeof(ahex), "%016lx", (unsigned long) cap->id());
-          std::string match = "";
-          match += "# i:";
-          match += ahex;
-          match += " a:";
-          match += cap->authid();
-          out += match;
-        }
-      }
-    }
+  std::vector<FuseServer::Caps::shared_cap> cap2delete =
+    gOFS->zMQ->gFuseServer.Cap().GetClientCaps(uuid);
+
+  for (const auto& cap : cap2delete) {
+    out += "\n ";
+    char ahex[20];
+    snprintf(ahex, sizeof(ahex), "%016lx", (unsigned long) cap->id());
+    std::string match = "";
+    match += "# i:";
+    match += ahex;
+    match += " a:";
+    match += cap->authid();
+    out += match;
   }
 
   for (auto scap = cap2delete.begin(); scap != cap2delete.end(); ++scap) {
@@ -925,6 +905,130 @@ FuseServer::Clients::RefreshEntry(uint64_t md_ino,
   return 0;
 }
 
+//------------------------------------------------------------------------------
+// Send a batch of notifications to a client
+//------------------------------------------------------------------------------
+int
+FuseServer::Clients::SendBatch(const FusexCastQueue::Batch& batch)
+{
+  std::string id;
+  bool merge = false;
+  bool refresh = true;
+  {
+    eos::common::RWMutexReadLock lLock(*this);
+    auto it_uuid = mUUIDView.find(batch.mUuid);
+
+    if (it_uuid == mUUIDView.end()) {
+      return ENOENT;
+    }
+
+    id = it_uuid->second;
+    auto it_client = mMap.find(id);
+
+    if (it_client != mMap.end()) {
+      eos::fusex::heartbeat& hb = it_client->second.heartbeat();
+      merge = (hb.protversion() >= hb.PROTOCOLV5);
+      refresh = !DeferClient(hb.version(), "4.4.18");
+    }
+  }
+
+  using Type = FusexCastQueue::Type;
+
+  if (!merge) {
+    // client can only handle one inode or name per message
+    for (const auto& entry : batch.mEntries) {
+      if (entry.mType == Type::kRelease) {
+        ReleaseCAP(entry.mIno, batch.mUuid, batch.mClientId);
+      } else if (entry.mType == Type::kDeletion) {
+        DeleteEntry(entry.mIno, batch.mUuid, batch.mClientId, entry.mName);
+      } else {
+        RefreshEntry(entry.mIno, batch.mUuid, batch.mClientId);
+      }
+    }
+
+    errno = 0; // avoid errno clobbering from ZMQ
+    return 0;
+  }
+
+  gOFS->MgmStats.Add("Eosxd::int::SendBatch", 0, 0, 1);
+  EXEC_TIMING_BEGIN("Eosxd::int::SendBatch");
+  std::string rspstream;
+  const auto& entries = batch.mEntries;
+
+  // Consecutive notifications of the same kind, and for deletions of the same
+  // parent, go into one message so that the enqueue order is kept
+  for (size_t pos = 0; pos < entries.size();) {
+    const auto& first = entries[pos];
+    size_t end = pos + 1;
+
+    while ((end < entries.size()) && (entries[end].mType == first.mType) &&
+           ((first.mType != Type::kDeletion) ||
+            (entries[end].mIno == first.mIno))) {
+      ++end;
+    }
+
+    const size_t num = end - pos;
+
+    if ((first.mType == Type::kRefresh) && !refresh) {
+      pos = end;
+      continue;
+    }
+
+    eos::fusex::response rsp;
+
+    if (first.mType == Type::kRelease) {
+      gOFS->MgmStats.Add("Eosxd::int::ReleaseCap", 0, 0, num);
+      rsp.set_type(rsp.LEASE);
+      rsp.mutable_lease_()->set_type(eos::fusex::lease::RELEASECAP);
+      rsp.mutable_lease_()->set_clientid(batch.mClientId);
+      rsp.mutable_lease_()->set_md_ino(first.mIno);
+
+      for (size_t i = pos + 1; i < end; ++i) {
+        rsp.mutable_lease_()->add_md_inos(entries[i].mIno);
+      }
+
+      eos_static_info("msg=\"asking cap release\" uuid=%s clientid=%s id=%lx "
+                      "n=%lu", batch.mUuid.c_str(), batch.mClientId.c_str(),
+                      first.mIno, num);
+    } else if (first.mType == Type::kDeletion) {
+      gOFS->MgmStats.Add("Eosxd::int::DeleteEntry", 0, 0, num);
+      rsp.set_type(rsp.DENTRY);
+      rsp.mutable_dentry_()->set_type(eos::fusex::dentry::REMOVE);
+      rsp.mutable_dentry_()->set_md_ino(first.mIno);
+      rsp.mutable_dentry_()->set_clientid(batch.mClientId);
+      rsp.mutable_dentry_()->set_name(first.mName);
+
+      for (size_t i = pos + 1; i < end; ++i) {
+        rsp.mutable_dentry_()->add_names(entries[i].mName);
+      }
+
+      eos_static_info("msg=\"asking dentry deletion\" uuid=%s clientid=%s "
+                      "id=%lx n=%lu", batch.mUuid.c_str(),
+                      batch.mClientId.c_str(), first.mIno, num);
+    } else {
+      gOFS->MgmStats.Add("Eosxd::int::RefreshEntry", 0, 0, num);
+      rsp.set_type(rsp.REFRESH);
+      rsp.mutable_refresh_()->set_md_ino(first.mIno);
+
+      for (size_t i = pos + 1; i < end; ++i) {
+        rsp.mutable_refresh_()->add_md_inos(entries[i].mIno);
+      }
+
+      eos_static_info("msg=\"asking dentry refresh\" uuid=%s clientid=%s "
+                      "id=%lx n=%lu", batch.mUuid.c_str(),
+                      batch.mClientId.c_str(), first.mIno, num);
+    }
+
+    pos = end;
+    rsp.SerializeToString(&rspstream);
+    gOFS->zMQ->mTask->reply(id, rspstream);
+  }
+
+  EXEC_TIMING_END("Eosxd::int::SendBatch");
+  errno = 0; // avoid errno clobbering from ZMQ
+  return 0;
+}
+
 //------------------------------------------------------------------------------
 //
 //------------------------------------------------------------------------------
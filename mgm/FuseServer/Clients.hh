@@ -29,6 +29,7 @@
 
 #include "mgm/Namespace.hh"
 #include "mgm/FuseServer/Caps.hh"
+#include "mgm/FuseServer/FusexCastQueue.hh"
 #include "mgm/fusex.pb.h"
 #include "common/Timing.hh"
 #include "common/Logging.hh"
@@ -199,6 +200,10 @@ public:
                    const std::string& uuid,
                    const std::string& clientid);
 
+  // send a batch of cap releases, dentry deletions and refreshes - clients
+  // speaking PROTOCOLV5 get one message per type
+  int SendBatch(const FusexCastQueue::Batch& batch);
+
   // send MD after update
   int SendMD(const eos::fusex::md& md,
              const std::string& uuid,
@@ -29,7 +29,9 @@
 EOSMGMNAMESPACE_BEGIN
 
 //------------------------------------------------------------------------------
-//! Class FusexCastBatch
+//! Class FusexCastBatch - defers the fusex broadcasts of a namespace operation
+//! until the namespace locks are released. The broadcasts themselves only
+//! queue the messages to the FusexCastQueue which sends them asynchronously.
 //------------------------------------------------------------------------------
 class FusexCastBatch
 {
@@ -0,0 +1,432 @@
+//------------------------------------------------------------------------------
+//! @file FusexCastQueue.cc
+//! @brief Asynchronous, coalescing queue of fusex invalidation messages
+//------------------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2023 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+#include "mgm/FuseServer/FusexCastQueue.hh"
+#include <algorithm>
+
+EOSMGMNAMESPACE_BEGIN
+
+//------------------------------------------------------------------------------
+// Start the flusher and the sender threads
+//------------------------------------------------------------------------------
+void
+FusexCastQueue::Start(SenderT sender, unsigned int window_ms,
+                      unsigned int num_threads)
+{
+  std::unique_lock<std::mutex> lock(mMutex);
+
+  if (mRunning || mFlusher.joinable()) {
+    return;
+  }
+
+  mSender = std::move(sender);
+
+  if (!window_ms) {
+    return;
+  }
+
+  mWindow = std::chrono::milliseconds(window_ms);
+
+  for (unsigned int i = 0; i < std::max(num_threads, 1u); ++i) {
+    mWorkers.emplace_back(new Worker());
+    Worker* worker = mWorkers.back().get();
+    worker->mThread = std::thread(&FusexCastQueue::WorkerLoop, this, worker);
+  }
+
+  mRunning = true;
+  mFlusher = std::thread(&FusexCastQueue::FlusherLoop, this);
+}
+
+//------------------------------------------------------------------------------
+// Send all the pending notifications and stop the threads
+//------------------------------------------------------------------------------
+void
+FusexCastQueue::Stop()
+{
+  {
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    if (!mRunning) {
+      return;
+    }
+
+    // New notifications are sent inline from now on
+    mRunning = false;
+    mStopping = true;
+  }
+  mCondVar.notify_all();
+  mFlusher.join();
+
+  for (auto& worker : mWorkers) {
+    {
+      std::unique_lock<std::mutex> lock(worker->mMutex);
+      worker->mStop = true;
+    }
+    worker->mCondVar.notify_all();
+    worker->mThread.join();
+  }
+}
+
+//------------------------------------------------------------------------------
+// Queue a notification
+//------------------------------------------------------------------------------
+void
+FusexCastQueue::Enqueue(const std::string& uuid, const std::string& clientid,
+                        Type type, uint64_t ino, const std::string& name)
+{
+  {
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    if (mRunning) {
+      if (mPending.empty()) {
+        mCondVar.notify_all();
+      }
+
+      auto& seqs = mPending[uuid][clientid].mSeq;
+      auto ret = seqs.emplace(std::make_tuple(type, ino, name), mSeq);
+
+      if (!ret.second) {
+        // Already pending, keep only the latest position
+        ret.first->second = mSeq;
+        ++mNumCoalesced;
+      }
+
+      ++mSeq;
+      ++mNumQueued;
+      return;
+    }
+  }
+
+  if (mSender) {
+    Batch batch {uuid, clientid};
+    batch.mEntries.push_back({type, ino, name});
+    mSender(batch);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Queue a cap release
+//------------------------------------------------------------------------------
+void
+FusexCastQueue::Release(const std::string& uuid, const std::string& clientid,
+                        uint64_t ino)
+{
+  Enqueue(uuid, clientid, Type::kRelease, ino, "");
+}
+
+//------------------------------------------------------------------------------
+// Queue a refresh
+//------------------------------------------------------------------------------
+void
+FusexCastQueue::Refresh(const std::string& uuid, const std::string& clientid,
+                        uint64_t ino)
+{
+  Enqueue(uuid, clientid, Type::kRefresh, ino, "");
+}
+
+//------------------------------------------------------------------------------
+// Queue a dentry deletion
+//------------------------------------------------------------------------------
+void
+FusexCastQueue::Deletion(const std::string& uuid, const std::string& clientid,
+                         uint64_t ino, const std::string& name)
+{
+  Enqueue(uuid, clientid, Type::kDeletion, ino, name);
+}
+
+//------------------------------------------------------------------------------
+// Build the batch to send out of the pending notifications
+//------------------------------------------------------------------------------
+FusexCastQueue::Batch
+FusexCastQueue::MakeBatch(const std::string& uuid, const std::string& clientid,
+                          const PendingBatch& pending)
+{
+  std::vector<std::pair<uint64_t, const std::tuple<Type, uint64_t, std::string>*>>
+      order;
+  order.reserve(pending.mSeq.size());
+
+  for (const auto& elem : pending.mSeq) {
+    order.emplace_back(elem.second, &elem.first);
+  }
+
+  std::sort(order.begin(), order.end());
+  Batch batch {uuid, clientid};
+  batch.mEntries.reserve(order.size());
+
+  for (const auto& elem : order) {
+    batch.mEntries.push_back({std::get<0>(*elem.second),
+                              std::get<1>(*elem.second),
+                              std::get<2>(*elem.second)});
+  }
+
+  return batch;
+}
+
+//------------------------------------------------------------------------------
+// Take pending batches out of mPending and mark them in flight
+//------------------------------------------------------------------------------
+FusexCastQueue::PendingT
+FusexCastQueue::TakePending(const std::string& uuid)
+{
+  PendingT pending;
+
+  if (uuid.empty()) {
+    pending.swap(mPending);
+  } else {
+    auto it = mPending.find(uuid);
+
+    if (it != mPending.end()) {
+      pending.emplace(uuid, std::move(it->second));
+      mPending.erase(it);
+    }
+  }
+
+  for (const auto& client : pending) {
+    ++mInFlight[client.first];
+  }
+
+  return pending;
+}
+
+//------------------------------------------------------------------------------
+// Clear the in flight mark of dispatched batches
+//------------------------------------------------------------------------------
+void
+FusexCastQueue::DoneInFlight(const std::vector<std::string>& uuids)
+{
+  if (uuids.empty()) {
+    return;
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    for (const auto& uuid : uuids) {
+      auto it = mInFlight.find(uuid);
+
+      if ((it != mInFlight.end()) && (--it->second == 0)) {
+        mInFlight.erase(it);
+      }
+    }
+  }
+  mInFlightCondVar.notify_all();
+}
+
+//------------------------------------------------------------------------------
+// Hand over pending batches to their sender threads
+//------------------------------------------------------------------------------
+std::vector<std::pair<FusexCastQueue::Worker*, uint64_t>>
+FusexCastQueue::Dispatch(PendingT&& pending)
+{
+  std::vector<std::pair<Worker*, uint64_t>> dispatched;
+  std::vector<std::string> uuids;
+
+  for (auto& client : pending) {
+    uuids.push_back(client.first);
+    std::vector<Batch> batches;
+
+    for (const auto& batch : client.second) {
+      batches.push_back(MakeBatch(client.first, batch.first, batch.second));
+    }
+
+    Worker* worker = GetWorker(client.first);
+    std::unique_lock<std::mutex> lock(worker->mMutex);
+
+    if (worker->mStop) {
+      // Only possible while racing with Stop
+      lock.unlock();
+
+      for (const auto& batch : batches) {
+        mSender(batch);
+      }
+
+      continue;
+    }
+
+    for (auto& batch : batches) {
+      worker->mQueue.push_back(std::move(batch));
+      ++worker->mEnqueued;
+    }
+
+    worker->mLastEnqueued[client.first] = worker->mEnqueued;
+    dispatched.emplace_back(worker, worker->mEnqueued);
+    worker->mCondVar.notify_all();
+  }
+
+  DoneInFlight(uuids);
+  return dispatched;
+}
+
+//------------------------------------------------------------------------------
+// Wait until a worker processed the given number of batches
+//------------------------------------------------------------------------------
+void
+FusexCastQueue::WaitProcessed(Worker* worker, uint64_t target)
+{
+  std::unique_lock<std::mutex> lock(worker->mMutex);
+  worker->mCondVar.wait(lock, [&]() {
+    return (worker->mProcessed >= target);
+  });
+}
+
+//------------------------------------------------------------------------------
+// Send the pending notifications of a client mount
+//------------------------------------------------------------------------------
+void
+FusexCastQueue::Flush(const std::string& uuid)
+{
+  PendingT pending;
+  {
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    if (!mRunning) {
+      return;
+    }
+
+    // Batches taken by the flusher or another flush must reach the sender
+    // queue first, otherwise they could be sent after the caller's message
+    mInFlightCondVar.wait(lock, [&]() {
+      return (mInFlight.find(uuid) == mInFlight.end());
+    });
+    pending = TakePending(uuid);
+  }
+
+  if (!pending.empty()) {
+    Dispatch(std::move(pending));
+  }
+
+  // Wait only for the last batch of this client, not for the batches of the
+  // other clients sharing the sender thread
+  Worker* worker = GetWorker(uuid);
+  std::unique_lock<std::mutex> lock(worker->mMutex);
+  auto it = worker->mLastEnqueued.find(uuid);
+
+  if (it == worker->mLastEnqueued.end()) {
+    return;
+  }
+
+  const uint64_t target = it->second;
+  worker->mCondVar.wait(lock, [&]() {
+    return (worker->mProcessed >= target);
+  });
+}
+
+//------------------------------------------------------------------------------
+// Send all the pending notifications
+//------------------------------------------------------------------------------
+void
+FusexCastQueue::Flush()
+{
+  PendingT pending;
+  {
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    if (!mRunning) {
+      return;
+    }
+
+    mInFlightCondVar.wait(lock, [&]() {
+      return mInFlight.empty();
+    });
+    pending = TakePending("");
+  }
+  Dispatch(std::move(pending));
+
+  for (auto& worker : mWorkers) {
+    uint64_t target;
+    {
+      std::unique_lock<std::mutex> lock(worker->mMutex);
+      target = worker->mEnqueued;
+    }
+    WaitProcessed(worker.get(), target);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Loop of the flusher thread - once notifications are pending, wait for the
+// coalescing window and hand them over to the sender threads
+//------------------------------------------------------------------------------
+void
+FusexCastQueue::FlusherLoop()
+{
+  std::unique_lock<std::mutex> lock(mMutex);
+
+  while (true) {
+    mCondVar.wait(lock, [this]() {
+      return (mStopping || !mPending.empty());
+    });
+
+    if (!mStopping) {
+      mCondVar.wait_for(lock, mWindow, [this]() {
+        return mStopping;
+      });
+    }
+
+    bool stop = mStopping;
+    PendingT pending = TakePending("");
+    lock.unlock();
+    Dispatch(std::move(pending));
+
+    if (stop) {
+      break;
+    }
+
+    lock.lock();
+  }
+}
+
+//------------------------------------------------------------------------------
+// Loop of a sender thread
+//------------------------------------------------------------------------------
+void
+FusexCastQueue::WorkerLoop(Worker* worker)
+{
+  std::unique_lock<std::mutex> lock(worker->mMutex);
+
+  while (true) {
+    worker->mCondVar.wait(lock, [worker]() {
+      return (worker->mStop || !worker->mQueue.empty());
+    });
+
+    if (worker->mQueue.empty()) {
+      break;
+    }
+
+    Batch batch = std::move(worker->mQueue.front());
+    worker->mQueue.pop_front();
+    lock.unlock();
+    mSender(batch);
+    lock.lock();
+    ++worker->mProcessed;
+    auto it = worker->mLastEnqueued.find(batch.mUuid);
+
+    if ((it != worker->mLastEnqueued.end()) &&
+        (it->second <= worker->mProcessed)) {
+      worker->mLastEnqueued.erase(it);
+    }
+
+    worker->mCondVar.notify_all();
+  }
+}
+
+EOSMGMNAMESPACE_END
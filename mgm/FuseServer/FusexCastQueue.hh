@@ -0,0 +1,253 @@
+//------------------------------------------------------------------------------
+//! @file FusexCastQueue.hh
+//! @brief Asynchronous, coalescing queue of fusex invalidation messages
+//------------------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2023 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+#pragma once
+#include "mgm/Namespace.hh"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+EOSMGMNAMESPACE_BEGIN
+
+//------------------------------------------------------------------------------
+//! Class FusexCastQueue - collects the cap release, dentry deletion and
+//! refresh notifications produced by namespace changes. Notifications for the
+//! same client mount are merged during a short window and handed over as one
+//! batch to a pool of sender threads, so that the thread doing the namespace
+//! change does not pay for the messaging.
+//!
+//! The notifications of a batch keep their enqueue order and the batches of a
+//! client mount are always sent by the same sender thread, hence in order.
+//! Flush(uuid) must be called before sending any other message to a client
+//! which has to be ordered after the pending notifications.
+//------------------------------------------------------------------------------
+class FusexCastQueue
+{
+public:
+  //! Kind of notification
+  enum class Type { kRelease, kRefresh, kDeletion };
+
+  //----------------------------------------------------------------------------
+  //! Notifications for one client mount
+  //----------------------------------------------------------------------------
+  struct Batch {
+    //! Notification, the name is set only for deletions
+    struct Entry {
+      Type mType;
+      uint64_t mIno;
+      std::string mName;
+    };
+
+    std::string mUuid;
+    std::string mClientId;
+    std::vector<Entry> mEntries; ///< Notifications in enqueue order
+
+    //--------------------------------------------------------------------------
+    //! Number of notifications in the batch
+    //--------------------------------------------------------------------------
+    size_t Size() const
+    {
+      return mEntries.size();
+    }
+  };
+
+  using SenderT = std::function<void(const Batch&)>;
+
+  //----------------------------------------------------------------------------
+  //! Constructor
+  //----------------------------------------------------------------------------
+  FusexCastQueue() = default;
+
+  //----------------------------------------------------------------------------
+  //! Destructor
+  //----------------------------------------------------------------------------
+  ~FusexCastQueue()
+  {
+    Stop();
+  }
+
+  //----------------------------------------------------------------------------
+  //! Don't allow copy or move of these objects
+  //----------------------------------------------------------------------------
+  FusexCastQueue(const FusexCastQueue&) = delete;
+  FusexCastQueue& operator =(const FusexCastQueue&) = delete;
+
+  //----------------------------------------------------------------------------
+  //! Start the flusher and the sender threads. Without calling this, or with
+  //! a zero window, every notification is sent in the calling thread.
+  //!
+  //! @param sender function sending a batch to its client
+  //! @param window_ms coalescing window in milliseconds
+  //! @param num_threads number of sender threads
+  //----------------------------------------------------------------------------
+  void Start(SenderT sender, unsigned int window_ms, unsigned int num_threads);
+
+  //----------------------------------------------------------------------------
+  //! Send all the pending notifications and stop the threads
+  //----------------------------------------------------------------------------
+  void Stop();
+
+  //----------------------------------------------------------------------------
+  //! Queue notifications
+  //----------------------------------------------------------------------------
+  void Release(const std::string& uuid, const std::string& clientid,
+               uint64_t ino);
+  void Refresh(const std::string& uuid, const std::string& clientid,
+               uint64_t ino);
+  void Deletion(const std::string& uuid, const std::string& clientid,
+                uint64_t ino, const std::string& name);
+
+  //----------------------------------------------------------------------------
+  //! Send the pending notifications of a client mount and wait until all its
+  //! queued batches are sent. Returns immediately if nothing is queued for it.
+  //----------------------------------------------------------------------------
+  void Flush(const std::string& uuid);
+
+  //----------------------------------------------------------------------------
+  //! Send all the pending notifications and wait until they are sent
+  //----------------------------------------------------------------------------
+  void Flush();
+
+  //----------------------------------------------------------------------------
+  //! Statistics: number of queued notifications and number of notifications
+  //! dropped because an identical one was already pending
+  //----------------------------------------------------------------------------
+  uint64_t GetNumQueued() const
+  {
+    return mNumQueued.load();
+  }
+
+  uint64_t GetNumCoalesced() const
+  {
+    return mNumCoalesced.load();
+  }
+
+private:
+  //! Sender thread with its own queue of batches
+  struct Worker {
+    std::mutex mMutex;
+    std::condition_variable mCondVar;
+    std::deque<Batch> mQueue;
+    uint64_t mEnqueued {0}; ///< Number of batches ever enqueued
+    uint64_t mProcessed {0}; ///< Number of batches ever sent
+    //! Value of mEnqueued after the last batch of a client mount was queued,
+    //! dropped once that batch is sent
+    std::map<std::string, uint64_t> mLastEnqueued;
+    bool mStop {false};
+    std::thread mThread;
+  };
+
+  //! Pending notifications of a client, an identical notification enqueued
+  //! again only moves to the later position
+  struct PendingBatch {
+    std::map<std::tuple<Type, uint64_t, std::string>, uint64_t> mSeq;
+  };
+
+  //! Pending batches by client uuid and client id
+  using PendingT = std::map<std::string, std::map<std::string, PendingBatch>>;
+
+  SenderT mSender;
+  std::chrono::milliseconds mWindow {0};
+  std::mutex mMutex; ///< Protects mPending, mInFlight and mRunning
+  std::condition_variable mCondVar;
+  PendingT mPending;
+  uint64_t mSeq {0}; ///< Enqueue sequence number
+  //! Number of dispatches in progress by client uuid, taken out of mPending
+  //! but not yet handed over to the sender threads
+  std::map<std::string, size_t> mInFlight;
+  std::condition_variable mInFlightCondVar;
+  bool mRunning {false};
+  bool mStopping {false};
+  std::thread mFlusher;
+  std::vector<std::unique_ptr<Worker>> mWorkers;
+  std::atomic<uint64_t> mNumQueued {0};
+  std::atomic<uint64_t> mNumCoalesced {0};
+
+  //----------------------------------------------------------------------------
+  //! Queue a notification or send it inline if the queue is not running
+  //----------------------------------------------------------------------------
+  void Enqueue(const std::string& uuid, const std::string& clientid,
+               Type type, uint64_t ino, const std::string& name);
+
+  //----------------------------------------------------------------------------
+  //! Take pending batches out of mPending and mark them in flight, mMutex must
+  //! be held
+  //!
+  //! @param uuid client mount, all of them if empty
+  //----------------------------------------------------------------------------
+  PendingT TakePending(const std::string& uuid);
+
+  //----------------------------------------------------------------------------
+  //! Clear the in flight mark of dispatched batches
+  //----------------------------------------------------------------------------
+  void DoneInFlight(const std::vector<std::string>& uuids);
+
+  //----------------------------------------------------------------------------
+  //! Hand over pending batches to their sender threads
+  //!
+  //! @return workers which got a batch and the number of enqueued batches
+  //!         after the handover
+  //----------------------------------------------------------------------------
+  std::vector<std::pair<Worker*, uint64_t>> Dispatch(PendingT&& pending);
+
+  //----------------------------------------------------------------------------
+  //! Build the batch to send out of the pending notifications
+  //----------------------------------------------------------------------------
+  static Batch MakeBatch(const std::string& uuid, const std::string& clientid,
+                         const PendingBatch& pending);
+
+  //----------------------------------------------------------------------------
+  //! Wait until a worker processed the given number of batches
+  //----------------------------------------------------------------------------
+  static void WaitProcessed(Worker* worker, uint64_t target);
+
+  //----------------------------------------------------------------------------
+  //! Get the worker of a client mount
+  //----------------------------------------------------------------------------
+  Worker* GetWorker(const std::string& uuid) const
+  {
+    return mWorkers[std::hash<std::string>()(uuid) % mWorkers.size()].get();
+  }
+
+  //----------------------------------------------------------------------------
+  //! Loop of the flusher thread
+  //----------------------------------------------------------------------------
+  void FlusherLoop();
+
+  //----------------------------------------------------------------------------
+  //! Loop of a sender thread
+  //----------------------------------------------------------------------------
+  void WorkerLoop(Worker* worker);
+};
+
+EOSMGMNAMESPACE_END
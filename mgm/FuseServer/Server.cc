@@ -105,6 +105,16 @@ Server::start()
   monitorthread.detach();
   std::thread capthread(&Server::MonitorCaps, this);
   capthread.detach();
+  // coalescing window and sender threads of the invalidation messages
+  unsigned int cast_window_ms = getenv("EOS_MGM_FUSEX_CAST_WINDOW_MS") ?
+                                strtoul(getenv("EOS_MGM_FUSEX_CAST_WINDOW_MS"), 0, 10) : 10;
+  unsigned int cast_threads = getenv("EOS_MGM_FUSEX_CAST_THREADS") ?
+                              strtoul(getenv("EOS_MGM_FUSEX_CAST_THREADS"), 0, 10) : 4;
+  eos_static_info("msg=\"starting fusex broadcaster\" window_ms=%u threads=%u",
+                  cast_window_ms, cast_threads);
+  mCastQueue.Start([this](const FusexCastQueue::Batch & batch) {
+    mClients.SendBatch(batch);
+  }, cast_window_ms, cast_threads);
 }
 
 //------------------------------------------------------------------------------
@@ -114,6 +124,8 @@ Server::start()
 void
 Server::shutdown()
 {
+  // Send the queued notifications while the clients are still reachable
+  mCastQueue.Stop();
   Clients().terminate();
   terminate();
 }
@@ -150,13 +162,7 @@ Server::MonitorCaps() noexcept
     EXEC_TIMING_BEGIN("Eosxd::int::MonitorCaps");
 
     // expire caps
-    do {
-      if (Cap().expire()) {
-        Cap().pop();
-      } else {
-        break;
-      }
-    } while (1);
+    Cap().Expire();
 
     time_t now = time(NULL);
 
@@ -185,40 +191,32 @@ Server::MonitorCaps() noexcept
         }
       } quotainfo_t;
       std::map<std::string, quotainfo_t> qmap;
-      {
-        eos::common::RWMutexReadLock lLock(Cap());
+      if (EOS_LOGS_DEBUG) {
+        eos_static_debug("looping over caps n=%d", Cap().ncaps());
+      }
 
+      Cap().ForEach([&](const FuseServer::Caps::shared_cap & cap) {
         if (EOS_LOGS_DEBUG) {
-          eos_static_debug("looping over caps n=%d", Cap().GetCaps().size());
+          eos_static_debug("cap q-node %lx", cap->_quota().quota_inode());
         }
 
-        std::map<FuseServer::Caps::authid_t, FuseServer::Caps::shared_cap>& allcaps =
-          Cap().GetCaps();
-
-        for (auto it = allcaps.begin(); it != allcaps.end(); ++it) {
-          if (EOS_LOGS_DEBUG) {
-            eos_static_debug("cap q-node %lx", it->second->_quota().quota_inode());
-          }
-
-          // if we find a cap with 'noquota' contents, we just ignore this one
-          if (it->second->_quota().inode_quota() == noquota) {
-            continue;
-          }
+        // if we find a cap with 'noquota' contents, we just ignore this one
+        if (cap->_quota().inode_quota() == noquota) {
+          return;
+        }
 
-          if (it->second->_quota().quota_inode()) {
-            quotainfo_t qi(it->second->uid(), it->second->gid(),
-                           it->second->_quota().quota_inode());
+        if (cap->_quota().quota_inode()) {
+          quotainfo_t qi(cap->uid(), cap->gid(), cap->_quota().quota_inode());
 
-            // skip if we did this already ...
-            if (qmap.count(qi.id())) {
-              qmap[qi.id()].authids.push_back(it->second->authid());
-            } else {
-              qmap[qi.id()] = qi;
-              qmap[qi.id()].authids.push_back(it->second->authid());
-            }
+          // skip if we did this already ...
+          if (qmap.count(qi.id())) {
+            qmap[qi.id()].authids.push_back(cap->authid());
+          } else {
+            qmap[qi.id()] = qi;
+            qmap[qi.id()].authids.push_back(cap->authid());
           }
         }
-      }
+      });
 
       for (auto it = qmap.begin(); it != qmap.end(); ++it) {
         eos::IContainerMD::id_t qino_id = it->second.qid;
@@ -243,17 +241,9 @@ Server::MonitorCaps() noexcept
                 ((avail_files && avail_bytes) &&
                  (outofquota.count(*auit)))) { // first time back to quota
               // send the changed quota information via a cap update
-              FuseServer::Caps::shared_cap cap;
-              {
-                eos::common::RWMutexReadLock lLock(Cap());
-
-                if (auto kv = Cap().GetCaps().find(*auit);
-                    kv != Cap().GetCaps().end()) {
-                  cap = kv->second;
-                }
-              }
+              FuseServer::Caps::shared_cap cap = Cap().Get(*auit);
 
-              if (cap) {
+              if (cap->id()) {
                 cap->mutable__quota()->set_inode_quota(avail_files);
                 cap->mutable__quota()->set_volume_quota(avail_bytes);
                 // send this cap (again)
@@ -576,25 +566,14 @@ Server::FillContainerCAP(uint64_t id,
 
     // check if the client has already a cap, in case yes, we don't return a new
     // one
-    eos::common::RWMutexReadLock lLock(Cap());
-
-    if (Cap().ClientInoCaps().count(dir.clientid())) {
-      if (Cap().ClientInoCaps()[dir.clientid()].count(id)) {
-        return true;
-      }
+    if (!Cap().GetClientInodeAuthIds(dir.clientid(), id).empty()) {
+      return true;
     }
   } else {
     // avoid to pile-up caps for the same client, delete previous ones
-    eos::common::RWMutexReadLock lLock(Cap());
-
-    if (Cap().ClientInoCaps().count(dir.clientid())) {
-      if (Cap().ClientInoCaps()[dir.clientid()].count(id)) {
-        for (auto it = Cap().ClientInoCaps()[dir.clientid()][id].begin();
-             it != Cap().ClientInoCaps()[dir.clientid()][id].end(); ++it) {
-          if (*it != reuse_uuid) {
-            duplicated_caps.insert(*it);
-          }
-        }
+    for (const auto& authid : Cap().GetClientInodeAuthIds(dir.clientid(), id)) {
+      if (authid != reuse_uuid) {
+        duplicated_caps.insert(authid);
       }
     }
   }
@@ -851,8 +830,6 @@ Server::FillContainerCAP(uint64_t id,
   Cap().Store(dir.capability(), &vid);
 
   if (duplicated_caps.size()) {
-    eos::common::RWMutexWriteLock lLock(Cap());
-
     for (auto it = duplicated_caps.begin(); it != duplicated_caps.end(); ++it) {
       eos_static_debug("removing duplicated cap %s\n", it->c_str());
       Caps::shared_cap cap = Cap().Get(*it);
@@ -34,6 +34,7 @@
 #include "mgm/FuseServer/Caps.hh"
 #include "mgm/FuseServer/Clients.hh"
 #include "mgm/FuseServer/Flush.hh"
+#include "mgm/FuseServer/FusexCastQueue.hh"
 #include "mgm/FuseServer/Locks.hh"
 
 #include "namespace/interface/IFileMD.hh"
@@ -76,6 +77,11 @@ public:
     return mFlushs;
   }
 
+  FusexCastQueue& CastQueue()
+  {
+    return mCastQueue;
+  }
+
   void Print(std::string& out, std::string options = "");
 
   int FillContainerMD(uint64_t id, eos::fusex::md& dir,
@@ -216,6 +222,7 @@ protected:
   Caps mCaps;
   Lock mLocks;
   Flush mFlushs;
+  FusexCastQueue mCastQueue; ///< Sends via mClients, keep it declared after
 
 private:
   std::atomic<bool> terminate_;
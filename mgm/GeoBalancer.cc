@@ -34,6 +34,7 @@
 #include "XrdSys/XrdSysError.hh"
 #include "XrdOuc/XrdOucTrace.hh"
 #include "Xrd/XrdScheduler.hh"
+#include <algorithm>
 #include <random>
 #include <cmath>
 
@@ -177,26 +178,21 @@ GeoBalancer::populateGeotagsInfo()
 {
   clearCachedSizes();
   const char* spaceName = mSpaceName.c_str();
-  eos::common::RWMutexReadLock lock(FsView::gFsView.ViewMutex);
-  const FsSpace* spaceView = FsView::gFsView.mSpaceView[spaceName];
+  // The file systems are taken from the view snapshot, no need to lock the view
+  auto view = FsView::gFsView.GetSnapshot();
+  const FsViewSnapshot::ViewEntry* spaceView = view->GetSpace(mSpaceName);
 
-  if (spaceView->size() == 0) {
+  if (!spaceView || spaceView->mFsIds.empty()) {
     eos_static_info("No filesystems in space=%s", spaceName);
     return;
   }
 
-  //std::set<eos::common::FileSystem::fsid_t>::const_iterator it;
-  eos::mgm::BaseView::const_iterator it;
-
-  for (it = spaceView->cbegin(); it != spaceView->cend(); it++) {
-    FileSystem* fs = FsView::gFsView.mIdView.lookupByID(*it);
-
-    if (!fs || fs->GetActiveStatus() != eos::common::ActiveStatus::kOnline) {
+  for (const auto* fs : view->GetFileSystems(*spaceView)) {
+    if (fs->mActiveStatus != eos::common::ActiveStatus::kOnline) {
       continue;
     }
 
-    eos::common::FileSystem::fs_snapshot_t snapshot;
-    fs->SnapShotFileSystem(snapshot, false);
+    const eos::common::FileSystem::fs_snapshot_t& snapshot = *fs;
 
     if (snapshot.mStatus != eos::common::BootStatus::kBooted ||
         snapshot.mConfigStatus < eos::common::ConfigStatus::kRO ||
@@ -204,8 +200,8 @@ GeoBalancer::populateGeotagsInfo()
       continue;
     }
 
-    mGeotagFs[snapshot.mGeoTag].push_back(*it);
-    mFsGeotag[*it] = snapshot.mGeoTag;
+    mGeotagFs[snapshot.mGeoTag].push_back(snapshot.mId);
+    mFsGeotag[snapshot.mId] = snapshot.mGeoTag;
     uint64_t capacity = snapshot.mDiskCapacity;
     uint64_t usedBytes = (uint64_t)(capacity - snapshot.mDiskFreeBytes);
 
@@ -403,24 +399,25 @@ GeoBalancer::scheduleTransfer(eos::common::FileId::fileid_t fid,
 }
 
 /*----------------------------------------------------------------------------*/
-eos::common::FileId::fileid_t
-GeoBalancer::chooseFidFromGeotag(const std::string& geotag)
+std::vector<eos::common::FileId::fileid_t>
+GeoBalancer::chooseFidsFromGeotag(const std::string& geotag, size_t num,
+                                  uint64_t max_size)
 /*----------------------------------------------------------------------------*/
 /**
- * @brief Chooses a random file ID from a random filesystem in the given geotag
- * @param geotag the location's name from which the file id will be chosen
- * @return the chosen file ID
+ * @brief Chooses random file IDs from a random filesystem in the given geotag
+ * @param geotag the location's name from which the file ids will be chosen
+ * @param num max number of file ids to choose
+ * @param max_size max size of the chosen files, if known
+ * @return the chosen file IDs
  */
 /*----------------------------------------------------------------------------*/
 {
+  std::vector<eos::common::FileId::fileid_t> fids;
   int rndIndex;
   bool found = false;
   uint64_t fsid_size = 0ull;
   eos::common::FileSystem::fsid_t fsid = 0;
-  eos::common::RWMutexReadLock vlock(FsView::gFsView.ViewMutex);
-  eos::common::RWMutexReadLock lock(gOFS->eosViewRWMutex, __FUNCTION__, __LINE__, __FILE__);
   std::vector<eos::common::FileSystem::fsid_t>& validFs = mGeotagFs[geotag];
-  // TODO(gbitzes): Add prefetching here.
 
   while (validFs.size() > 0) {
     rndIndex = getRandom(validFs.size() - 1);
@@ -442,9 +439,25 @@ GeoBalancer::chooseFidFromGeotag(const std::string& geotag)
   }
 
   if (!found) {
-    return -1;
+    return fids;
   }
 
+  auto candidates = mSampler.Take(fsid, num,
+  [&](const FsFileSampler::Candidate & candidate) {
+    return (candidate.mSize != 0) && (candidate.mSize <= max_size) &&
+           (mTransfers.count(candidate.mFid) == 0);
+  });
+
+  for (const auto& candidate : candidates) {
+    fids.push_back(candidate.mFid);
+  }
+
+  if (!fids.empty()) {
+    return fids;
+  }
+
+  // No sample of this file system yet
+  eos::common::RWMutexReadLock lock(gOFS->eosViewRWMutex, __FUNCTION__, __LINE__, __FILE__);
   int attempts = 10;
 
   while (attempts-- > 0) {
@@ -452,47 +465,77 @@ GeoBalancer::chooseFidFromGeotag(const std::string& geotag)
 
     if (gOFS->eosFsView->getApproximatelyRandomFileInFs(fsid, randomPick) &&
         mTransfers.count(randomPick) == 0) {
-      return randomPick;
+      fids.push_back(randomPick);
+      break;
     }
   }
 
-  return -1;
+  return fids;
 }
 
 /*----------------------------------------------------------------------------*/
-void
-GeoBalancer::prepareTransfer()
+size_t
+GeoBalancer::prepareTransfer(size_t max_num)
 /*----------------------------------------------------------------------------*/
 /**
- * @brief Picks a geotag randomly and schedule a file ID to be transferred
+ * @brief Picks a geotag randomly and schedule file IDs to be transferred
+ * @param max_num max number of transfers to schedule
+ * @return number of scheduled transfers
  */
 /*----------------------------------------------------------------------------*/
 {
   if (mGeotagsOverAvg.size() == 0) {
     eos_static_debug("No geotags over the average!");
-    return;
+    return 0;
   }
 
   int attempts = 10;
 
   while (attempts-- > 0) {
     int rndIndex = getRandom(mGeotagsOverAvg.size() - 1);
-    std::vector<std::string>::const_iterator over_it = mGeotagsOverAvg.cbegin();
-    std::advance(over_it, rndIndex);
-    // TODO: this loop should be improved not to request the file list too
-    // many times in a tight loop
-    eos::common::FileId::fileid_t fid = chooseFidFromGeotag(*over_it);
-
-    if ((int) fid == -1) {
+    // Copy, scheduling a transfer refills mGeotagsOverAvg
+    const std::string geotag = mGeotagsOverAvg[rndIndex];
+    const GeotagSize* geotagSize = mGeotagSizes[geotag];
+    // Bytes to move until the geotag reaches the average
+    const double excess = (double) geotagSize->usedBytes() -
+                          mAvgUsedSize * geotagSize->capacity();
+    auto fids = chooseFidsFromGeotag(geotag, max_num,
+                                     (uint64_t) std::max(0.0, excess));
+
+    if (fids.empty()) {
       eos_static_debug("Couldn't choose any FID to schedule: failedgeotag=%s",
-                       (*over_it).c_str());
+                       geotag.c_str());
+
+      if (mGeotagsOverAvg.empty()) {
+        return 0;
+      }
+
       continue;
     }
 
-    if (scheduleTransfer(fid, *over_it)) {
-      break;
+    size_t num_scheduled = 0;
+
+    for (const auto fid : fids) {
+      if (scheduleTransfer(fid, geotag)) {
+        ++num_scheduled;
+      }
+
+      if (std::find(mGeotagsOverAvg.begin(), mGeotagsOverAvg.end(),
+                    geotag) == mGeotagsOverAvg.end()) {
+        break;
+      }
+    }
+
+    if (num_scheduled) {
+      return num_scheduled;
+    }
+
+    if (mGeotagsOverAvg.empty()) {
+      return 0;
     }
   }
+
+  return 0;
 }
 
 /*----------------------------------------------------------------------------*/
@@ -526,9 +569,10 @@ GeoBalancer::prepareTransfers(int nrTransfers)
 /*--------------------------------------------------------------------------*/
 {
   int allowedTransfers = nrTransfers - mTransfers.size();
+  int remaining = allowedTransfers;
 
-  for (int i = 0; i < allowedTransfers; i++) {
-    prepareTransfer();
+  for (int i = 0; (i < allowedTransfers) && (remaining > 0); i++) {
+    remaining -= prepareTransfer(remaining);
   }
 
   if (allowedTransfers > 0) {
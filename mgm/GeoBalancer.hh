@@ -35,6 +35,7 @@
 #include "common/FileId.hh"
 #include "common/FileSystem.hh"
 #include "common/AssistedThread.hh"
+#include "mgm/FsFileSampler.hh"
 /* -------------------------------------------------------------------------- */
 #include "XrdSys/XrdSysPthread.hh"
 /* -------------------------------------------------------------------------- */
@@ -132,10 +133,15 @@ private:
   /// transfers scheduled (maps files' ids with their path in proc)
   std::map<eos::common::FileId::fileid_t, std::string> mTransfers;
 
+  /// sampled transfer candidates of the file systems
+  FsFileSampler mSampler {FsFileSampler::NamespaceScanner()};
+
   std::string getFileProcTransferNameAndSize(eos::common::FileId::fileid_t fid,
       uint64_t* size);
 
-  eos::common::FileId::fileid_t chooseFidFromGeotag(const std::string& geotag);
+  std::vector<eos::common::FileId::fileid_t>
+  chooseFidsFromGeotag(const std::string& geotag, size_t num,
+                       uint64_t max_size);
 
   void populateGeotagsInfo(void);
 
@@ -145,7 +151,7 @@ private:
 
   void prepareTransfers(int nrTransfers);
 
-  void prepareTransfer(void);
+  size_t prepareTransfer(size_t max_num);
 
   bool scheduleTransfer(eos::common::FileId::fileid_t fid,
                         const std::string& sourceGeotag);
@@ -175,6 +181,14 @@ public:
   // ---------------------------------------------------------------------------
   void Stop();
 
+  // ---------------------------------------------------------------------------
+  // Drop the sampled candidates of a removed file system
+  // ---------------------------------------------------------------------------
+  void ForgetFileSystem(FsFileSampler::fsid_t fsid)
+  {
+    mSampler.Forget(fsid);
+  }
+
   // ---------------------------------------------------------------------------
   // Service implementation e.g. eternal conversion loop running third-party
   // conversion
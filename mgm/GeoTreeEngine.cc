@@ -1167,7 +1167,6 @@ GeoTreeEngine::placeNewReplicasOneGroup(FsGroup* group,
 {
   assert(nNewReplicas);
   assert(newReplicas);
-  std::vector<SchedTME*> entries;
   // find the entry in the map
   SchedTME* entry;
   {
@@ -1183,6 +1182,82 @@ GeoTreeEngine::placeNewReplicasOneGroup(FsGroup* group,
   }
   // readlock the original fast structure
   entry->doubleBufferMutex.LockRead();
+  bool success = placeNewReplicasLocked(entry, nNewReplicas, newReplicas, inode,
+                                        dataProxys, firewallEntryPoint, type,
+                                        existingReplicas, fsidsgeotags,
+                                        bookingSize, startFromGeoTag,
+                                        clientGeoTag, nCollocatedReplicas,
+                                        excludeFs, excludeGeoTags);
+  entry->doubleBufferMutex.UnLockRead();
+  AtomicDec(entry->fastStructLockWaitersCount);
+  return success;
+}
+
+size_t
+GeoTreeEngine::placeNewReplicasOneGroup(FsGroup* group,
+                                        std::vector<PlacementRequest>& requests,
+                                        SchedType type)
+{
+  if (requests.empty()) {
+    return 0;
+  }
+
+  // find the entry in the map
+  SchedTME* entry;
+  {
+    RWMutexReadLock lock(this->pTreeMapMutex);
+
+    if (!pGroup2SchedTME.count(group)) {
+      eos_err("could not find the requested placement group in the map");
+
+      for (auto& req : requests) {
+        req.mNewReplicas.clear();
+      }
+
+      return 0;
+    }
+
+    entry = pGroup2SchedTME[group];
+    AtomicInc(entry->fastStructLockWaitersCount);
+  }
+  // readlock the original fast structure once for the whole batch
+  entry->doubleBufferMutex.LockRead();
+  size_t num_placed = 0;
+
+  for (auto& req : requests) {
+    assert(req.mNumReplicas);
+
+    if (placeNewReplicasLocked(entry, req.mNumReplicas, &req.mNewReplicas,
+                               req.mInode, NULL, NULL, type,
+                               &req.mExistingReplicas, &req.mExistingGeotags,
+                               req.mBookingSize, "", "", 0, &req.mExcludeFs,
+                               &req.mExcludeGeoTags)) {
+      ++num_placed;
+    }
+  }
+
+  entry->doubleBufferMutex.UnLockRead();
+  AtomicDec(entry->fastStructLockWaitersCount);
+  return num_placed;
+}
+
+bool
+GeoTreeEngine::placeNewReplicasLocked(SchedTME* entry,
+                                      const size_t& nNewReplicas,
+                                      vector<FileSystem::fsid_t>* newReplicas,
+                                      ino64_t inode, std::vector<std::string>* dataProxys,
+                                      std::vector<std::string>* firewallEntryPoint,
+                                      SchedType type,
+                                      vector<FileSystem::fsid_t>* existingReplicas,
+                                      std::vector<std::string>* fsidsgeotags,
+                                      unsigned long long bookingSize,
+                                      const std::string& startFromGeoTag,
+                                      const std::string& clientGeoTag,
+                                      const size_t& nCollocatedReplicas,
+                                      vector<FileSystem::fsid_t>* excludeFs,
+                                      vector<string>* excludeGeoTags)
+{
+  std::vector<SchedTME*> entries;
   // locate the existing replicas and the excluded fs in the tree
   vector<SchedTreeBase::tFastTreeIdx> newReplicasIdx(nNewReplicas),
          *existingReplicasIdx = NULL, *excludeFsIdx = NULL;
@@ -1394,16 +1469,13 @@ GeoTreeEngine::placeNewReplicasOneGroup(FsGroup* group,
     }
   }
 
-  // Unlock, cleanup
+  // cleanup
 cleanup:
 
   if (!success) {
     newReplicas->clear();
   }
 
-  entry->doubleBufferMutex.UnLockRead();
-  AtomicDec(entry->fastStructLockWaitersCount);
-
   if (existingReplicasIdx) {
     delete existingReplicasIdx;
   }
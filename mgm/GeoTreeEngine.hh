@@ -1652,7 +1652,44 @@ protected:
   bool accessReqFwEP(const std::string& targetGeotag,
                      const std::string& accesserGeotag) const ;
   std::string accessGetProxygroup(const std::string& geotag) const ;
+
+  // ---------------------------------------------------------------------------
+  //! Place replicas in the fast structures of a scheduling group which the
+  //! caller already holds read locked. Same parameters as
+  //! placeNewReplicasOneGroup.
+  // ---------------------------------------------------------------------------
+  bool placeNewReplicasLocked(SchedTME* entry, const size_t& nNewReplicas,
+                              std::vector<eos::common::FileSystem::fsid_t>* newReplicas,
+                              ino64_t inode,
+                              std::vector<std::string>* dataProxys,
+                              std::vector<std::string>* firewallEntryPoints,
+                              SchedType type,
+                              std::vector<eos::common::FileSystem::fsid_t>* existingReplicas,
+                              std::vector<std::string>* fsidsgeotags,
+                              unsigned long long bookingSize,
+                              const std::string& startFromGeoTag,
+                              const std::string& clientGeoTag,
+                              const size_t& nCollocatedReplicas,
+                              std::vector<eos::common::FileSystem::fsid_t>* excludeFs,
+                              std::vector<std::string>* excludeGeoTags);
 public:
+  //----------------------------------------------------------------------------
+  //! Placement of new replicas for one file as part of a batch, see
+  //! placeNewReplicasOneGroup for the meaning of the fields
+  //----------------------------------------------------------------------------
+  struct PlacementRequest {
+    ino64_t mInode {0};
+    size_t mNumReplicas {1};
+    unsigned long long mBookingSize {0};
+    std::vector<eos::common::FileSystem::fsid_t> mExistingReplicas;
+    //! Geotags of the existing replicas, same order as mExistingReplicas
+    std::vector<std::string> mExistingGeotags;
+    std::vector<eos::common::FileSystem::fsid_t> mExcludeFs;
+    std::vector<std::string> mExcludeGeoTags;
+    //! Result: fsids of the new replicas, empty if the placement failed
+    std::vector<eos::common::FileSystem::fsid_t> mNewReplicas;
+  };
+
   //----------------------------------------------------------------------------
   //! Constructor
   //----------------------------------------------------------------------------
@@ -1789,6 +1826,24 @@ public:
                                 std::vector<eos::common::FileSystem::fsid_t>* excludeFs = NULL,
                                 std::vector<std::string>* excludeGeoTags = NULL);
 
+  // ---------------------------------------------------------------------------
+  //! Place the new replicas of several files in one scheduling group. The
+  //! group lookup and the read lock on its fast structures are taken once for
+  //! the whole batch, and the score penalties of each placement are visible
+  //! to the next one just like for consecutive single placements.
+  // @param group
+  //   the group to place the replicas in
+  // @param requests
+  //   placement requests, the mNewReplicas of each one are filled in
+  // @param type
+  //   type of placement to be performed, see placeNewReplicasOneGroup
+  // @return
+  //   number of requests that were successfully placed
+  // ---------------------------------------------------------------------------
+  size_t placeNewReplicasOneGroup(FsGroup* group,
+                                  std::vector<PlacementRequest>& requests,
+                                  SchedType type);
+
   // this function to access replica spread across multiple scheduling group is a BACKCOMPATIBILITY artifact
   // the new scheduler doesn't try to place files across multiple scheduling groups.
   //  bool accessReplicasMultipleGroup(const size_t &nAccessReplicas,
@@ -34,6 +34,7 @@
 #include "XrdSys/XrdSysError.hh"
 #include "XrdOuc/XrdOucTrace.hh"
 #include "Xrd/XrdScheduler.hh"
+#include <algorithm>
 #include <random>
 #include <cmath>
 
@@ -136,7 +137,7 @@ GroupBalancer::clearCachedSizes()
 // than or less than the current mAvgUsedSize, respectively.
 //------------------------------------------------------------------------------
 void
-GroupBalancer::updateGroupAvgCache(FsGroup* group)
+GroupBalancer::updateGroupAvgCache(const GroupEntry* group)
 
 {
   if (mGroupSizes.count(group->mName) == 0) {
@@ -184,9 +185,11 @@ GroupBalancer::fillGroupsByAvg()
 
   for (auto size_it = mGroupSizes.cbegin(); size_it != mGroupSizes.cend();
        ++size_it) {
-    const std::string& name = (*size_it).first;
-    FsGroup* group = FsView::gFsView.mGroupView[name];
-    updateGroupAvgCache(group);
+    const GroupEntry* group = mSnapshot->GetGroup((*size_it).first);
+
+    if (group) {
+      updateGroupAvgCache(group);
+    }
   }
 }
 
@@ -198,31 +201,52 @@ void
 GroupBalancer::populateGroupsInfo()
 {
   const char* spaceName = mSpaceName.c_str();
-  eos::common::RWMutexReadLock lock(FsView::gFsView.ViewMutex);
   mAvgUsedSize = 0;
   clearCachedSizes();
+  // The groups are taken from the view snapshot, no need to lock the view
+  mSnapshot = FsView::gFsView.GetSnapshot();
 
-  if (FsView::gFsView.mSpaceGroupView.count(spaceName) == 0) {
+  if (mSnapshot->GetSpace(mSpaceName) == nullptr) {
     eos_static_err("No such space %s", spaceName);
     return;
   }
 
-  auto set_fsgrp = FsView::gFsView.mSpaceGroupView[spaceName];
+  for (const auto& name : mSnapshot->GetSpaceGroups(mSpaceName)) {
+    const GroupEntry* group = mSnapshot->GetGroup(name);
+
+    if (!group || (group->mStatus != "on")) {
+      continue;
+    }
+
+    // Average over the file systems counted in the group statistics
+    double sum_size = 0, sum_capacity = 0;
+    size_t cnt = 0;
+
+    for (const auto* fs : mSnapshot->GetFileSystems(*group)) {
+      if ((fs->mConfigStatus < eos::common::ConfigStatus::kRO) ||
+          (fs->mStatus != eos::common::BootStatus::kBooted) ||
+          (fs->mActiveStatus == eos::common::ActiveStatus::kOffline)) {
+        continue;
+      }
+
+      sum_capacity += fs->mDiskCapacity;
+      sum_size += fs->mDiskCapacity - fs->mDiskFreeBytes;
+      ++cnt;
+    }
 
-  for (auto it = set_fsgrp.cbegin(); it != set_fsgrp.cend(); it++) {
-    if ((*it)->GetConfigMember("status") != "on") {
+    if (cnt == 0) {
       continue;
     }
 
-    uint64_t size = (*it)->AverageDouble("stat.statfs.usedbytes", false);
-    uint64_t capacity = (*it)->AverageDouble("stat.statfs.capacity", false);
+    uint64_t size = sum_size / cnt;
+    uint64_t capacity = sum_capacity / cnt;
 
     if (capacity == 0) {
       continue;
     }
 
-    mGroupSizes[(*it)->mName] = new GroupSize(size, capacity);
-    mAvgUsedSize += mGroupSizes[(*it)->mName]->filled();
+    mGroupSizes[name] = new GroupSize(size, capacity);
+    mAvgUsedSize += mGroupSizes[name]->filled();
   }
 
   if (mGroupSizes.size() == 0) {
@@ -242,7 +266,7 @@ GroupBalancer::populateGroupsInfo()
 //------------------------------------------------------------------------------
 std::string
 GroupBalancer::getFileProcTransferNameAndSize(eos::common::FileId::fileid_t fid,
-    FsGroup* group, uint64_t* size)
+    const GroupEntry* group, uint64_t* size)
 
 {
   char fileName[1024];
@@ -322,15 +346,16 @@ GroupBalancer::UpdateTransferList()
 // Creates the conversion file in proc for the file ID, from the given
 // sourceGroup, to the targetGroup (and updates the cache structures)
 //------------------------------------------------------------------------------
-void
+bool
 GroupBalancer::scheduleTransfer(eos::common::FileId::fileid_t fid,
-                                FsGroup* sourceGroup, FsGroup* targetGroup)
+                                const GroupEntry* sourceGroup,
+                                const GroupEntry* targetGroup)
 {
   if ((mGroupSizes.count(sourceGroup->mName) == 0) ||
       (mGroupSizes.count(targetGroup->mName) == 0)) {
     eos_static_err("msg=\"no src/trg group in map\" src_group=%s trg_group=%s",
                    sourceGroup->mName.c_str(), targetGroup->mName.c_str());
-    return;
+    return false;
   }
 
   eos::common::VirtualIdentity rootvid = eos::common::VirtualIdentity::Root();
@@ -339,7 +364,7 @@ GroupBalancer::scheduleTransfer(eos::common::FileId::fileid_t fid,
   std::string fileName = getFileProcTransferNameAndSize(fid, targetGroup, &size);
 
   if (fileName == "") {
-    return;
+    return false;
   }
 
   // Use new converter if available
@@ -366,7 +391,7 @@ GroupBalancer::scheduleTransfer(eos::common::FileId::fileid_t fid,
     } else {
       eos_static_err("msg=\"failed to schedule transfer\" schedulingfile=\"%s\"",
                      fileName.c_str());
-      return;
+      return false;
     }
   }
 
@@ -375,38 +400,34 @@ GroupBalancer::scheduleTransfer(eos::common::FileId::fileid_t fid,
       size);
   updateGroupAvgCache(sourceGroup);
   updateGroupAvgCache(targetGroup);
+  return true;
 }
 
 //------------------------------------------------------------------------------
-// Chooses a random file ID from a random filesystem in the given group
+// Chooses random file IDs from a random filesystem in the given group
 //------------------------------------------------------------------------------
-eos::common::FileId::fileid_t
-GroupBalancer::chooseFidFromGroup(FsGroup* group)
+std::vector<eos::common::FileId::fileid_t>
+GroupBalancer::chooseFidsFromGroup(const GroupEntry* group, size_t num,
+                                   uint64_t max_size)
 {
+  std::vector<eos::common::FileId::fileid_t> fids;
   int rndIndex;
   bool found = false;
   uint64_t fsid_size = 0ull;
   eos::common::FileSystem::fsid_t fsid = 0;
-  eos::common::RWMutexReadLock vlock(FsView::gFsView.ViewMutex);
-  eos::common::RWMutexReadLock lock(gOFS->eosViewRWMutex, __FUNCTION__, __LINE__, __FILE__);
-  // TODO(gbitzes): Add prefetching, make more efficient.
-  std::vector<int> validFsIndexes(group->size());
+  std::vector<int> validFsIndexes(group->mFsIds.size());
 
-  for (size_t i = 0; i < group->size(); i++) {
+  for (size_t i = 0; i < group->mFsIds.size(); i++) {
     validFsIndexes[i] = (int) i;
   }
 
-  eos::mgm::BaseView::const_iterator fs_it;
-
   while (validFsIndexes.size() > 0) {
-    fs_it = group->begin();
     rndIndex = getRandom(validFsIndexes.size() - 1);
-    std::advance(fs_it, validFsIndexes[rndIndex]);
-    fsid = *fs_it;
+    fsid = group->mFsIds[validFsIndexes[rndIndex]];
     // Accept only active file systems
-    FileSystem* target = FsView::gFsView.mIdView.lookupByID(fsid);
+    const auto* target = mSnapshot->GetFileSystem(fsid);
 
-    if (target && target->GetActiveStatus() == eos::common::ActiveStatus::kOnline) {
+    if (target && target->mActiveStatus == eos::common::ActiveStatus::kOnline) {
       fsid_size = gOFS->eosFsView->getNumFilesOnFs(fsid);
 
       if (fsid_size) {
@@ -420,9 +441,27 @@ GroupBalancer::chooseFidFromGroup(FsGroup* group)
 
   // Check if we have any files to transfer
   if (!found) {
-    return -1;
+    return fids;
   }
 
+  // Empty files don't change the balance, files bigger than the imbalance
+  // would just move it to the target group
+  auto candidates = mSampler.Take(fsid, num,
+  [&](const FsFileSampler::Candidate & candidate) {
+    return (candidate.mSize != 0) && (candidate.mSize <= max_size) &&
+           (mTransfers.count(candidate.mFid) == 0);
+  });
+
+  for (const auto& candidate : candidates) {
+    fids.push_back(candidate.mFid);
+  }
+
+  if (!fids.empty()) {
+    return fids;
+  }
+
+  // No sample of this file system yet
+  eos::common::RWMutexReadLock lock(gOFS->eosViewRWMutex, __FUNCTION__, __LINE__, __FILE__);
   int attempts = 10;
 
   while (attempts-- > 0) {
@@ -430,11 +469,12 @@ GroupBalancer::chooseFidFromGroup(FsGroup* group)
 
     if (gOFS->eosFsView->getApproximatelyRandomFileInFs(fsid, randomPick) &&
         mTransfers.count(randomPick) == 0) {
-      return randomPick;
+      fids.push_back(randomPick);
+      break;
     }
   }
 
-  return -1;
+  return fids;
 }
 
 //------------------------------------------------------------------------------
@@ -451,14 +491,14 @@ printSizes(const std::map<std::string, GroupSize*>* sizes)
 }
 
 //------------------------------------------------------------------------------
-// Picks two groups (source and target) randomly and schedule a file ID
-// to be transferred
+// Picks two groups (source and target) randomly and schedule file IDs to be
+// transferred between them
 //------------------------------------------------------------------------------
-void
-GroupBalancer::prepareTransfer()
+size_t
+GroupBalancer::prepareTransfer(size_t max_num)
 {
-  FsGroup* fromGroup, *toGroup;
-  std::map<std::string, FsGroup*>::iterator over_it, under_it;
+  const GroupEntry* fromGroup, *toGroup;
+  std::map<std::string, const GroupEntry*>::iterator over_it, under_it;
   eos::mgm::BaseView::const_iterator fsid_it;
 
   if (mGroupsUnderAvg.size() == 0 || mGroupsOverAvg.size() == 0) {
@@ -471,7 +511,7 @@ GroupBalancer::prepareTransfer()
     }
 
     recalculateAvg();
-    return;
+    return 0;
   }
 
   over_it = mGroupsOverAvg.begin();
@@ -483,19 +523,44 @@ GroupBalancer::prepareTransfer()
   fromGroup = (*over_it).second;
   toGroup = (*under_it).second;
 
-  if (fromGroup->size() == 0) {
-    return;
+  if ((fromGroup->mFsIds.size() == 0) || (mGroupSizes.count(fromGroup->mName) == 0) ||
+      (mGroupSizes.count(toGroup->mName) == 0)) {
+    return 0;
   }
 
-  eos::common::FileId::fileid_t fid = chooseFidFromGroup(fromGroup);
-
-  if ((int) fid == -1) {
+  // Bytes to move until one of the groups reaches the average
+  const GroupSize* fromSize = mGroupSizes[fromGroup->mName];
+  const GroupSize* toSize = mGroupSizes[toGroup->mName];
+  const double excess = (double) fromSize->usedBytes() -
+                        mAvgUsedSize * fromSize->capacity();
+  const double deficit = mAvgUsedSize * toSize->capacity() -
+                         (double) toSize->usedBytes();
+  const uint64_t max_size = (uint64_t) std::max(0.0, std::min(excess,
+                            deficit));
+  auto fids = chooseFidsFromGroup(fromGroup, max_num, max_size);
+
+  if (fids.empty()) {
     eos_static_info("Couldn't choose any FID to schedule: failedgroup=%s",
                     fromGroup->mName.c_str());
-    return;
+    return 0;
+  }
+
+  size_t num_scheduled = 0;
+
+  for (const auto fid : fids) {
+    if (scheduleTransfer(fid, fromGroup, toGroup)) {
+      ++num_scheduled;
+    }
+
+    // Stop once the pair is balanced, the other candidates go back to waiting
+    // in the next cycles
+    if ((mGroupsOverAvg.count(fromGroup->mName) == 0) ||
+        (mGroupsUnderAvg.count(toGroup->mName) == 0)) {
+      break;
+    }
   }
 
-  scheduleTransfer(fid, fromGroup, toGroup);
+  return num_scheduled;
 }
 
 //------------------------------------------------------------------------------
@@ -522,9 +587,11 @@ void
 GroupBalancer::prepareTransfers(int nrTransfers)
 {
   int allowedTransfers = nrTransfers - mTransfers.size();
+  int remaining = allowedTransfers;
 
-  for (int i = 0; i < allowedTransfers; i++) {
-    prepareTransfer();
+  // Every attempt picks another random pair of groups
+  for (int i = 0; (i < allowedTransfers) && (remaining > 0); i++) {
+    remaining -= prepareTransfer(remaining);
   }
 
   if (allowedTransfers > 0) {
@@ -25,6 +25,9 @@
 #include "mgm/Namespace.hh"
 #include "common/FileId.hh"
 #include "common/AssistedThread.hh"
+#include "mgm/FsFileSampler.hh"
+#include "mgm/FsViewSnapshot.hh"
+#include <memory>
 #include <vector>
 #include <string>
 #include <cstring>
@@ -33,8 +36,6 @@
 
 EOSMGMNAMESPACE_BEGIN
 
-class FsGroup;
-
 //------------------------------------------------------------------------------
 //! @brief Class representing a group's size
 //! It holds the capacity and the current used space of a group.
@@ -102,6 +103,14 @@ public:
   //----------------------------------------------------------------------------
   void Stop();
 
+  //----------------------------------------------------------------------------
+  //! Drop the sampled candidates of a removed file system
+  //----------------------------------------------------------------------------
+  void ForgetFileSystem(FsFileSampler::fsid_t fsid)
+  {
+    mSampler.Forget(fsid);
+  }
+
   //----------------------------------------------------------------------------
   // Service implementation e.g. eternal conversion loop running third-party
   // conversion
@@ -112,11 +121,14 @@ private:
   AssistedThread mThread; ///< Thread scheduling jobs
   std::string mSpaceName; ///< Attached space name
   double mThreshold; ///< Threshold for group balancing
+  using GroupEntry = FsViewSnapshot::ViewEntry;
+  //! View snapshot the group entries below point into
+  std::shared_ptr<const FsViewSnapshot> mSnapshot;
 
   /// groups whose size is over the average size of the groups
-  std::map<std::string, FsGroup*> mGroupsOverAvg;
+  std::map<std::string, const GroupEntry*> mGroupsOverAvg;
   /// groups whose size is under the average size of the groups
-  std::map<std::string, FsGroup*> mGroupsUnderAvg;
+  std::map<std::string, const GroupEntry*> mGroupsUnderAvg;
   /// groups' sizes cache
   std::map<std::string, GroupSize*> mGroupSizes;
   /// average filled percentage in groups
@@ -125,6 +137,8 @@ private:
   time_t mLastCheck;
   //! Scheduled transfers (maps fid to path in proc)
   std::map<eos::common::FileId::fileid_t, std::string> mTransfers;
+  //! Sampled transfer candidates of the file systems
+  FsFileSampler mSampler {FsFileSampler::NamespaceScanner()};
 
   //----------------------------------------------------------------------------
   //! Produces a file conversion path to be placed in the proc directory taking
@@ -137,16 +151,20 @@ private:
   //! @return name of the proc transfer file
   //----------------------------------------------------------------------------
   std::string getFileProcTransferNameAndSize(eos::common::FileId::fileid_t fid,
-      FsGroup* group, uint64_t* size);
+      const GroupEntry* group, uint64_t* size);
 
   //----------------------------------------------------------------------------
-  //! Chooses a random file ID from a random filesystem in the given group
+  //! Chooses random file IDs from a random filesystem in the given group
   //!
-  //! @param group the group from which the file id will be chosen
+  //! @param group the group from which the file ids will be chosen
+  //! @param num max number of file ids to choose
+  //! @param max_size max size of the chosen files, if known
   //!
-  //! @return the chosen file ID
+  //! @return the chosen file IDs
   //----------------------------------------------------------------------------
-  eos::common::FileId::fileid_t chooseFidFromGroup(FsGroup* group);
+  std::vector<eos::common::FileId::fileid_t>
+  chooseFidsFromGroup(const GroupEntry* group, size_t num,
+                      uint64_t max_size);
 
   //----------------------------------------------------------------------------
   // Fills mGroupSizes, calculates the mAvgUsedSize and fills mGroupsUnderAvg
@@ -163,7 +181,7 @@ private:
   //! Places group in mGroupsOverAvg or mGroupsUnderAvg in case they're greater
   //! than or less than the current mAvgUsedSize, respectively.
   //----------------------------------------------------------------------------
-  void updateGroupAvgCache(FsGroup* group);
+  void updateGroupAvgCache(const GroupEntry* group);
 
   //----------------------------------------------------------------------------
   //! Fills mGroupsOverAvg and mGroupsUnderAvg with the objects in mGroupSizes,
@@ -180,10 +198,14 @@ private:
   void prepareTransfers(int nrTransfers);
 
   //----------------------------------------------------------------------------
-  //! Picks two groups (source and target) randomly and schedule a file ID
-  //! to be transferred
+  //! Picks two groups (source and target) randomly and schedule file IDs to be
+  //! transferred between them
+  //!
+  //! @param max_num max number of transfers to schedule
+  //!
+  //! @return number of scheduled transfers
   //----------------------------------------------------------------------------
-  void prepareTransfer(void);
+  size_t prepareTransfer(size_t max_num);
 
   //----------------------------------------------------------------------------
   //! Creates the conversion file in proc for the file ID, from the given
@@ -192,9 +214,12 @@ private:
   //! @param fid the id of the file to be transferred
   //! @param sourceGroup the group where the file is currently located
   //! @param targetGroup the group to which the file is will be transferred
+  //!
+  //! @return true if the transfer was scheduled, otherwise false
   //----------------------------------------------------------------------------
-  void scheduleTransfer(eos::common::FileId::fileid_t fid,
-                        FsGroup* sourceGroup, FsGroup* targetGroup);
+  bool scheduleTransfer(eos::common::FileId::fileid_t fid,
+                        const GroupEntry* sourceGroup,
+                        const GroupEntry* targetGroup);
 
   //----------------------------------------------------------------------------
   //! Gets a random int between 0 and a given maximum
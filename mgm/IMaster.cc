@@ -48,8 +48,18 @@ void IMaster::fillNamespaceCacheConfig(IConfigEngine *configEngine,
     }
   }
 
+  std::string ndentriesStr;
+  uint64_t ndentries = 1'000'000;
+
+  if(configEngine->get("ns", "cache-size-ndentries", ndentriesStr)) {
+    if(!common::ParseUInt64(ndentriesStr, ndentries)) {
+      eos_static_crit("Could not parse 'cache-size-ndentries' configuration value");
+    }
+  }
+
   namespaceConfig[constants::sMaxNumCacheFiles] = std::to_string(nfiles);
   namespaceConfig[constants::sMaxNumCacheDirs] = std::to_string(ndirs);
+  namespaceConfig[constants::sMaxNumCacheDentries] = std::to_string(ndentries);
 }
 
 EOSMGMNAMESPACE_END
@@ -191,6 +191,42 @@ void
 Iostat::Receive(ThreadAssistant& assistant) noexcept
 {
   mq::ReportListener listener(gOFS->MgmOfsBroker.c_str(), gOFS->HostName);
+  // The reports always carry the same measurements, intern their tags once
+  const uint32_t tag_rb = mStore.Intern("bytes_read");
+  const uint32_t tag_wb = mStore.Intern("bytes_written");
+  const uint32_t tag_nrc = mStore.Intern("read_calls");
+  const uint32_t tag_rv_op = mStore.Intern("readv_calls");
+  const uint32_t tag_nwc = mStore.Intern("write_calls");
+  const uint32_t tag_nfwds = mStore.Intern("fwd_seeks");
+  const uint32_t tag_nbwds = mStore.Intern("bwd_seeks");
+  const uint32_t tag_nxlfwds = mStore.Intern("xl_fwd_seeks");
+  const uint32_t tag_nxlbwds = mStore.Intern("xl_bwd_seeks");
+  const uint32_t tag_sfwdb = mStore.Intern("bytes_fwd_seek");
+  const uint32_t tag_sbwdb = mStore.Intern("bytes_bwd_wseek");
+  const uint32_t tag_sxlfwdb = mStore.Intern("bytes_xl_fwd_seek");
+  const uint32_t tag_sxlbwdb = mStore.Intern("bytes_xl_bwd_wseek");
+  const uint32_t tag_rt = mStore.Intern("disk_time_read");
+  const uint32_t tag_wt = mStore.Intern("disk_time_write");
+  const uint32_t tag_dsize = mStore.Intern("bytes_deleted");
+  const uint32_t tag_ndel = mStore.Intern("files_deleted");
+  const uint32_t tag_eos = mStore.Intern("eos");
+  const uint32_t tag_other = mStore.Intern("other");
+  // Samples are accumulated and pushed to the store in batches
+  const size_t max_batch = 4096;
+  std::vector<IostatStore::Sample> batch;
+  batch.reserve(max_batch + 64);
+  auto add_io = [&batch](IostatStore::Kind out, IostatStore::Kind in,
+  uint32_t tag, const eos::common::Report & report) {
+    if (report.rb) {
+      batch.push_back({out, tag, 0, report.rb, (time_t) report.ots,
+                       (time_t) report.cts});
+    }
+
+    if (report.wb) {
+      batch.push_back({in, tag, 0, report.wb, (time_t) report.ots,
+                       (time_t) report.cts});
+    }
+  };
 
   while (!assistant.terminationRequested()) {
     std::string newmessage;
@@ -207,43 +243,31 @@ Iostat::Receive(ThreadAssistant& assistant) noexcept
 
       XrdOucEnv ioreport(body.c_str());
       std::unique_ptr<eos::common::Report> report(new eos::common::Report(ioreport));
-      Add("bytes_read", report->uid, report->gid, report->rb, report->ots,
-          report->cts);
-      Add("bytes_read", report->uid, report->gid, report->rvb_sum, report->ots,
-          report->cts);
-      Add("bytes_written", report->uid, report->gid, report->wb, report->ots,
-          report->cts);
-      Add("read_calls", report->uid, report->gid, report->nrc, report->ots,
-          report->cts);
-      Add("readv_calls", report->uid, report->gid, report->rv_op, report->ots,
-          report->cts);
-      Add("write_calls", report->uid, report->gid, report->nwc, report->ots,
-          report->cts);
-      Add("fwd_seeks", report->uid, report->gid, report->nfwds, report->ots,
-          report->cts);
-      Add("bwd_seeks", report->uid, report->gid, report->nbwds, report->ots,
-          report->cts);
-      Add("xl_fwd_seeks", report->uid, report->gid, report->nxlfwds, report->ots,
-          report->cts);
-      Add("xl_bwd_seeks", report->uid, report->gid, report->nxlbwds, report->ots,
-          report->cts);
-      Add("bytes_fwd_seek", report->uid, report->gid, report->sfwdb, report->ots,
-          report->cts);
-      Add("bytes_bwd_wseek", report->uid, report->gid, report->sbwdb, report->ots,
-          report->cts);
-      Add("bytes_xl_fwd_seek", report->uid, report->gid, report->sxlfwdb, report->ots,
-          report->cts);
-      Add("bytes_xl_bwd_wseek", report->uid, report->gid, report->sxlbwdb,
-          report->ots, report->cts);
-      Add("disk_time_read", report->uid, report->gid, report->rt,
-          report->ots, report->cts);
-      Add("disk_time_write", report->uid, report->gid,
-          report->wt, report->ots, report->cts);
+      const uid_t uid = report->uid;
+      const gid_t gid = report->gid;
+      const time_t ots = report->ots;
+      const time_t cts = report->cts;
+      Add(batch, tag_rb, uid, gid, report->rb, ots, cts);
+      Add(batch, tag_rb, uid, gid, report->rvb_sum, ots, cts);
+      Add(batch, tag_wb, uid, gid, report->wb, ots, cts);
+      Add(batch, tag_nrc, uid, gid, report->nrc, ots, cts);
+      Add(batch, tag_rv_op, uid, gid, report->rv_op, ots, cts);
+      Add(batch, tag_nwc, uid, gid, report->nwc, ots, cts);
+      Add(batch, tag_nfwds, uid, gid, report->nfwds, ots, cts);
+      Add(batch, tag_nbwds, uid, gid, report->nbwds, ots, cts);
+      Add(batch, tag_nxlfwds, uid, gid, report->nxlfwds, ots, cts);
+      Add(batch, tag_nxlbwds, uid, gid, report->nxlbwds, ots, cts);
+      Add(batch, tag_sfwdb, uid, gid, report->sfwdb, ots, cts);
+      Add(batch, tag_sbwdb, uid, gid, report->sbwdb, ots, cts);
+      Add(batch, tag_sxlfwdb, uid, gid, report->sxlfwdb, ots, cts);
+      Add(batch, tag_sxlbwdb, uid, gid, report->sxlbwdb, ots, cts);
+      Add(batch, tag_rt, uid, gid, report->rt, ots, cts);
+      Add(batch, tag_wt, uid, gid, report->wt, ots, cts);
       {
         // track deletions
         time_t now = time(NULL);
-        Add("bytes_deleted", 0, 0, report->dsize, now - 30, now);
-        Add("files_deleted", 0, 0, 1, now - 30, now);
+        Add(batch, tag_dsize, 0, 0, report->dsize, now - 30, now);
+        Add(batch, tag_ndel, 0, 0, 1, now - 30, now);
       }
       {
         // Do the UDP broadcasting here
@@ -258,17 +282,8 @@ Iostat::Receive(ThreadAssistant& assistant) noexcept
       if (report->path.substr(0, 11) == "/replicate:") {
         // check if this is a replication path
         // push into the 'eos' domain
-        Mutex.Lock();
-
-        if (report->rb) {
-          IostatAvgDomainIOrb["eos"].Add(report->rb, report->ots, report->cts);
-        }
-
-        if (report->wb) {
-          IostatAvgDomainIOwb["eos"].Add(report->wb, report->ots, report->cts);
-        }
-
-        Mutex.UnLock();
+        add_io(IostatStore::Kind::DomainOut, IostatStore::Kind::DomainIn,
+               tag_eos, *report);
       } else {
         bool dfound = false;
 
@@ -284,17 +299,8 @@ Iostat::Receive(ThreadAssistant& assistant) noexcept
           std::string sdomain = report->sec_domain.substr(pos);
 
           if (IoDomains.find(sdomain) != IoDomains.end()) {
-            Mutex.Lock();
-
-            if (report->rb) {
-              IostatAvgDomainIOrb[sdomain].Add(report->rb, report->ots, report->cts);
-            }
-
-            if (report->wb) {
-              IostatAvgDomainIOwb[sdomain].Add(report->wb, report->ots, report->cts);
-            }
-
-            Mutex.UnLock();
+            add_io(IostatStore::Kind::DomainOut, IostatStore::Kind::DomainIn,
+                   mStore.Intern(sdomain), *report);
             dfound = true;
           }
         }
@@ -304,57 +310,29 @@ Iostat::Receive(ThreadAssistant& assistant) noexcept
 
         for (nit = IoNodes.begin(); nit != IoNodes.end(); nit++) {
           if (*nit == report->sec_host.substr(0, nit->length())) {
-            Mutex.Lock();
-
-            if (report->rb) {
-              IostatAvgDomainIOrb[*nit].Add(report->rb, report->ots, report->cts);
-            }
-
-            if (report->wb) {
-              IostatAvgDomainIOwb[*nit].Add(report->wb, report->ots, report->cts);
-            }
-
-            Mutex.UnLock();
+            add_io(IostatStore::Kind::DomainOut, IostatStore::Kind::DomainIn,
+                   mStore.Intern(*nit), *report);
             dfound = true;
           }
         }
 
         if (!dfound) {
           // push into the 'other' domain
-          Mutex.Lock();
-
-          if (report->rb) {
-            IostatAvgDomainIOrb["other"].Add(report->rb, report->ots, report->cts);
-          }
-
-          if (report->wb) {
-            IostatAvgDomainIOwb["other"].Add(report->wb, report->ots, report->cts);
-          }
-
-          Mutex.UnLock();
+          add_io(IostatStore::Kind::DomainOut, IostatStore::Kind::DomainIn,
+                 tag_other, *report);
         }
       }
 
       // do the application accounting here
-      std::string apptag = "other";
-
-      if (report->sec_app.length()) {
-        apptag = report->sec_app;
-      }
-
-      // Push into app accounting
-      Mutex.Lock();
-
-      if (report->rb) {
-        IostatAvgAppIOrb[apptag].Add(report->rb, report->ots, report->cts);
-      }
+      add_io(IostatStore::Kind::AppOut, IostatStore::Kind::AppIn,
+             report->sec_app.length() ? mStore.Intern(report->sec_app) : tag_other,
+             *report);
 
-      if (report->wb) {
-        IostatAvgAppIOwb[apptag].Add(report->wb, report->ots, report->cts);
+      if (batch.size() >= max_batch) {
+        mStore.AddBatch(batch, time(NULL));
+        batch.clear();
       }
 
-      Mutex.UnLock();
-
       if (mReport) {
         // add the record to a daily report log file
         static XrdOucString openreportfile = "";
@@ -422,6 +400,9 @@ Iostat::Receive(ThreadAssistant& assistant) noexcept
       }
     }
 
+    // Publish whatever was collected before waiting for new reports
+    mStore.AddBatch(batch, time(NULL));
+    batch.clear();
     assistant.wait_for(std::chrono::seconds(1));
   }
 
@@ -449,18 +430,52 @@ Iostat::PrintOut(XrdOucString& out, bool summary, bool details,
                  bool monitoring, bool numerical, bool top,
                  bool domain, bool apps, XrdOucString option)
 {
-  Mutex.Lock();
   std::string format_s = (!monitoring ? "s" : "os");
   std::string format_ss = (!monitoring ? "-s" : "os");
   std::string format_l = (!monitoring ? "+l" : "ol");
   std::string format_ll = (!monitoring ? "l." : "ol");
+  // Work on a snapshot, the receiver thread keeps ingesting meanwhile
+  const std::vector<IostatStore::Entry> entries = mStore.GetSnapshot();
+  std::vector<const IostatStore::Entry*> uid_entries, gid_entries;
+  std::vector<const IostatStore::Entry*> domain_entries, app_entries;
   std::vector<std::string> tags;
 
-  for (auto tit = IostatUid.begin(); tit != IostatUid.end(); ++tit) {
-    tags.push_back(tit->first);
+  for (const auto& entry : entries) {
+    switch (entry.mKind) {
+    case IostatStore::Kind::Uid:
+      uid_entries.push_back(&entry);
+      tags.push_back(entry.mTag);
+      break;
+
+    case IostatStore::Kind::Gid:
+      gid_entries.push_back(&entry);
+      break;
+
+    case IostatStore::Kind::DomainOut:
+    case IostatStore::Kind::DomainIn:
+      domain_entries.push_back(&entry);
+      break;
+
+    case IostatStore::Kind::AppOut:
+    case IostatStore::Kind::AppIn:
+      app_entries.push_back(&entry);
+      break;
+    }
   }
 
   std::sort(tags.begin(), tags.end());
+  tags.erase(std::unique(tags.begin(), tags.end()), tags.end());
+  // Entries ordered by kind (out before in) and then by name
+  auto by_kind_and_name = [](const IostatStore::Entry * lhs,
+  const IostatStore::Entry * rhs) {
+    if (lhs->mKind != rhs->mKind) {
+      return lhs->mKind < rhs->mKind;
+    }
+
+    return lhs->mTag < rhs->mTag;
+  };
+  std::sort(domain_entries.begin(), domain_entries.end(), by_kind_and_name);
+  std::sort(app_entries.begin(), app_entries.end(), by_kind_and_name);
 
   if (summary) {
     TableFormatterBase table;
@@ -489,8 +504,25 @@ Iostat::PrintOut(XrdOucString& out, bool summary, bool details,
       });
     }
 
-    for (const auto& elem : tags) {
-      const char* tag = elem.c_str();
+    // Sum up the per uid entries of each tag
+    std::map<std::string, IostatStore::Entry> sums;
+
+    for (const auto* entry : uid_entries) {
+      auto it = sums.find(entry->mTag);
+
+      if (it == sums.end()) {
+        sums.emplace(entry->mTag, *entry);
+      } else {
+        it->second.mTotal += entry->mTotal;
+        it->second.mAvg60 += entry->mAvg60;
+        it->second.mAvg300 += entry->mAvg300;
+        it->second.mAvg3600 += entry->mAvg3600;
+        it->second.mAvg86400 += entry->mAvg86400;
+      }
+    }
+
+    for (const auto& elem : sums) {
+      const IostatStore::Entry& sum = elem.second;
       table_data.emplace_back();
       TableRow& row = table_data.back();
       row.emplace_back("all", format_ss);
@@ -499,12 +531,12 @@ Iostat::PrintOut(XrdOucString& out, bool summary, bool details,
         row.emplace_back("all", format_s);
       }
 
-      row.emplace_back(tag, format_s);
-      row.emplace_back(GetTotal(tag), format_ll);
-      row.emplace_back(GetTotalAvg60(tag), format_ll);
-      row.emplace_back(GetTotalAvg300(tag), format_ll);
-      row.emplace_back(GetTotalAvg3600(tag), format_ll);
-      row.emplace_back(GetTotalAvg86400(tag), format_ll);
+      row.emplace_back(elem.first.c_str(), format_s);
+      row.emplace_back(sum.mTotal, format_ll);
+      row.emplace_back(sum.mAvg60, format_ll);
+      row.emplace_back(sum.mAvg300, format_ll);
+      row.emplace_back(sum.mAvg3600, format_ll);
+      row.emplace_back(sum.mAvg86400, format_ll);
     }
 
     table.AddRows(table_data);
@@ -565,22 +597,19 @@ Iostat::PrintOut(XrdOucString& out, bool summary, bool details,
       });
     }
 
-    for (auto tuit = IostatAvgUid.begin(); tuit != IostatAvgUid.end(); tuit++) {
-      for (auto it = tuit->second.begin(); it != tuit->second.end(); ++it) {
-        std::string username;
+    for (const auto* entry : uid_entries) {
+      std::string username;
 
-        if (numerical) {
-          username = std::to_string(it->first);
-        } else {
-          int terrc = 0;
-          username = eos::common::Mapping::UidToUserName(it->first, terrc);
-        }
-
-        uidout.emplace_back(std::make_tuple(username, tuit->first.c_str(),
-                                            IostatUid[tuit->first][it->first],
-                                            it->second.GetAvg60(), it->second.GetAvg300(),
-                                            it->second.GetAvg3600(), it->second.GetAvg86400()));
+      if (numerical) {
+        username = std::to_string(entry->mId);
+      } else {
+        int terrc = 0;
+        username = eos::common::Mapping::UidToUserName(entry->mId, terrc);
       }
+
+      uidout.emplace_back(std::make_tuple(username, entry->mTag, entry->mTotal,
+                                          entry->mAvg60, entry->mAvg300,
+                                          entry->mAvg3600, entry->mAvg86400));
     }
 
     std::sort(uidout.begin(), uidout.end());
@@ -625,22 +654,19 @@ Iostat::PrintOut(XrdOucString& out, bool summary, bool details,
       });
     }
 
-    for (auto tgit = IostatAvgGid.begin(); tgit != IostatAvgGid.end(); tgit++) {
-      for (auto it = tgit->second.begin(); it != tgit->second.end(); ++it) {
-        std::string groupname;
+    for (const auto* entry : gid_entries) {
+      std::string groupname;
 
-        if (numerical) {
-          groupname = std::to_string(it->first);
-        } else {
-          int terrc = 0;
-          groupname = eos::common::Mapping::GidToGroupName(it->first, terrc);
-        }
-
-        gidout.emplace_back(std::make_tuple(groupname, tgit->first.c_str(),
-                                            IostatGid[tgit->first][it->first],
-                                            it->second.GetAvg60(), it->second.GetAvg300(),
-                                            it->second.GetAvg3600(), it->second.GetAvg86400()));
+      if (numerical) {
+        groupname = std::to_string(entry->mId);
+      } else {
+        int terrc = 0;
+        groupname = eos::common::Mapping::GidToGroupName(entry->mId, terrc);
       }
+
+      gidout.emplace_back(std::make_tuple(groupname, entry->mTag, entry->mTotal,
+                                          entry->mAvg60, entry->mAvg300,
+                                          entry->mAvg3600, entry->mAvg86400));
     }
 
     std::sort(gidout.begin(), gidout.end());
@@ -688,8 +714,10 @@ Iostat::PrintOut(XrdOucString& out, bool summary, bool details,
       table.AddSeparator();
 
       // by uid name
-      for (auto sit : IostatUid[*it]) {
-        uidout.push_back(std::make_tuple(sit.second, sit.first));
+      for (const auto* entry : uid_entries) {
+        if (entry->mTag == *it) {
+          uidout.push_back(std::make_tuple(entry->mTotal, entry->mId));
+        }
       }
 
       std::sort(uidout.begin(), uidout.end());
@@ -728,8 +756,10 @@ Iostat::PrintOut(XrdOucString& out, bool summary, bool details,
       }
 
       // by gid name
-      for (auto sit : IostatGid[*it]) {
-        gidout.push_back(std::make_tuple(sit.second, sit.first));
+      for (const auto* entry : gid_entries) {
+        if (entry->mTag == *it) {
+          gidout.push_back(std::make_tuple(entry->mTotal, entry->mId));
+        }
       }
 
       std::sort(gidout.begin(), gidout.end());
@@ -796,32 +826,24 @@ Iostat::PrintOut(XrdOucString& out, bool summary, bool details,
       });
     }
 
-    // IO out bytes
-    for (auto it = IostatAvgDomainIOrb.begin(); it != IostatAvgDomainIOrb.end();
-         ++it) {
+    // IO out bytes followed by IO in bytes
+    for (const auto* entry : domain_entries) {
       table_data.emplace_back();
       TableRow& row = table_data.back();
-      std::string name = !monitoring ? "out" : "domain_io_out";
-      row.emplace_back(name, format_ss);
-      row.emplace_back(it->first.c_str(), format_s);
-      row.emplace_back(it->second.GetAvg60(), format_l);
-      row.emplace_back(it->second.GetAvg300(), format_l);
-      row.emplace_back(it->second.GetAvg3600(), format_l);
-      row.emplace_back(it->second.GetAvg86400(), format_l);
-    }
+      std::string name;
+
+      if (entry->mKind == IostatStore::Kind::DomainOut) {
+        name = !monitoring ? "out" : "domain_io_out";
+      } else {
+        name = !monitoring ? "in" : "domain_io_in";
+      }
 
-    // IO in bytes
-    for (auto it = IostatAvgDomainIOwb.begin(); it != IostatAvgDomainIOwb.end();
-         ++it) {
-      table_data.emplace_back();
-      TableRow& row = table_data.back();
-      std::string name = !monitoring ? "in" : "domain_io_in";
       row.emplace_back(name, format_ss);
-      row.emplace_back(it->first.c_str(), format_s);
-      row.emplace_back(it->second.GetAvg60(), format_l);
-      row.emplace_back(it->second.GetAvg300(), format_l);
-      row.emplace_back(it->second.GetAvg3600(), format_l);
-      row.emplace_back(it->second.GetAvg86400(), format_l);
+      row.emplace_back(entry->mTag, format_s);
+      row.emplace_back(entry->mAvg60, format_l);
+      row.emplace_back(entry->mAvg300, format_l);
+      row.emplace_back(entry->mAvg3600, format_l);
+      row.emplace_back(entry->mAvg86400, format_l);
     }
 
     table.AddRows(table_data);
@@ -852,37 +874,29 @@ Iostat::PrintOut(XrdOucString& out, bool summary, bool details,
       });
     }
 
-    // IO out bytes
-    for (auto it = IostatAvgAppIOrb.begin(); it != IostatAvgAppIOrb.end(); ++it) {
+    // IO out bytes followed by IO in bytes
+    for (const auto* entry : app_entries) {
       table_data.emplace_back();
       TableRow& row = table_data.back();
-      std::string name = (!monitoring ? "out" : "app_io_out");
-      row.emplace_back(name, format_ss);
-      row.emplace_back(it->first.c_str(), format_s);
-      row.emplace_back(it->second.GetAvg60(), format_l);
-      row.emplace_back(it->second.GetAvg300(), format_l);
-      row.emplace_back(it->second.GetAvg3600(), format_l);
-      row.emplace_back(it->second.GetAvg86400(), format_l);
-    }
+      std::string name;
+
+      if (entry->mKind == IostatStore::Kind::AppOut) {
+        name = (!monitoring ? "out" : "app_io_out");
+      } else {
+        name = (!monitoring ? "in" : "app_io_in");
+      }
 
-    // IO in bytes
-    for (auto it = IostatAvgAppIOwb.begin(); it != IostatAvgAppIOwb.end(); ++it) {
-      table_data.emplace_back();
-      TableRow& row = table_data.back();
-      std::string name = (!monitoring ? "in" : "app_io_in");
       row.emplace_back(name, format_ss);
-      row.emplace_back(it->first.c_str(), format_s);
-      row.emplace_back(it->second.GetAvg60(), format_l);
-      row.emplace_back(it->second.GetAvg300(), format_l);
-      row.emplace_back(it->second.GetAvg3600(), format_l);
-      row.emplace_back(it->second.GetAvg86400(), format_l);
+      row.emplace_back(entry->mTag, format_s);
+      row.emplace_back(entry->mAvg60, format_l);
+      row.emplace_back(entry->mAvg300, format_l);
+      row.emplace_back(entry->mAvg3600, format_l);
+      row.emplace_back(entry->mAvg86400, format_l);
     }
 
     table.AddRows(table_data);
     out += table.GenerateTable(HEADER).c_str();
   }
-
-  Mutex.UnLock();
 }
 
 /* ------------------------------------------------------------------------- */
@@ -1299,29 +1313,25 @@ Iostat::Store()
     return false;
   }
 
-  google::sparse_hash_map<std::string, google::sparse_hash_map<uid_t, unsigned long long> >::iterator
-  tuit;
-  google::sparse_hash_map<std::string, google::sparse_hash_map<uid_t, unsigned long long> >::iterator
-  tgit;
-  Mutex.Lock();
+  const auto entries = mStore.GetSnapshot({IostatStore::Kind::Uid,
+                                           IostatStore::Kind::Gid
+                                          });
 
-  // store user counters
-  for (tuit = IostatUid.begin(); tuit != IostatUid.end(); tuit++) {
-    for (auto it = tuit->second.begin(); it != tuit->second.end(); ++it) {
-      fprintf(fout, "tag=%s&uid=%u&val=%llu\n", tuit->first.c_str(), it->first,
-              (unsigned long long)it->second);
+  // store user counters followed by the group counters
+  for (const auto& entry : entries) {
+    if (entry.mKind == IostatStore::Kind::Uid) {
+      fprintf(fout, "tag=%s&uid=%u&val=%llu\n", entry.mTag.c_str(), entry.mId,
+              entry.mTotal);
     }
   }
 
-  // store group counter
-  for (tgit = IostatGid.begin(); tgit != IostatGid.end(); tgit++) {
-    for (auto it = tgit->second.begin(); it != tgit->second.end(); ++it) {
-      fprintf(fout, "tag=%s&gid=%u&val=%llu\n", tgit->first.c_str(), it->first,
-              (unsigned long long)it->second);
+  for (const auto& entry : entries) {
+    if (entry.mKind == IostatStore::Kind::Gid) {
+      fprintf(fout, "tag=%s&gid=%u&val=%llu\n", entry.mTag.c_str(), entry.mId,
+              entry.mTotal);
     }
   }
 
-  Mutex.UnLock();
   fclose(fout);
   return rename(tmpname.c_str(), mStoreFileName.c_str()) == 0;
 }
@@ -1343,7 +1353,6 @@ Iostat::Restore()
     return false;
   }
 
-  Mutex.Lock();
   int item = 0;
   char line[16384];
 
@@ -1354,18 +1363,17 @@ Iostat::Restore()
       std::string tag = env.Get("tag");
       uid_t uid = atoi(env.Get("uid"));
       unsigned long long val = strtoull(env.Get("val"), 0, 10);
-      IostatUid[tag][uid] = val;
+      mStore.SetTotal(IostatStore::Kind::Uid, tag, uid, val);
     }
 
     if (env.Get("tag") && env.Get("gid") && env.Get("val")) {
       std::string tag = env.Get("tag");
       gid_t gid = atoi(env.Get("gid"));
       unsigned long long val = strtoull(env.Get("val"), 0, 10);
-      IostatGid[tag][gid] = val;
+      mStore.SetTotal(IostatStore::Kind::Gid, tag, gid, val);
     }
   }
 
-  Mutex.UnLock();
   fclose(fin);
   return true;
 }
@@ -1446,52 +1454,7 @@ Iostat::Circulate(ThreadAssistant& assistant) noexcept
 
     sc++;
     assistant.wait_for(std::chrono::milliseconds(512));
-    Mutex.Lock();
-    google::sparse_hash_map<std::string, google::sparse_hash_map<uid_t, IostatAvg> >::iterator
-    tit;
-    google::sparse_hash_map<std::string, IostatAvg >::iterator dit;
-    time_t now = time(NULL);
-
-    // loop over tags
-    for (tit = IostatAvgUid.begin(); tit != IostatAvgUid.end(); ++tit) {
-      // loop over vids
-      google::sparse_hash_map<uid_t, IostatAvg>::iterator it;
-
-      for (it = tit->second.begin(); it != tit->second.end(); ++it) {
-        it->second.StampZero(now);
-      }
-    }
-
-    for (tit = IostatAvgGid.begin(); tit != IostatAvgGid.end(); ++tit) {
-      // loop over vids
-      google::sparse_hash_map<uid_t, IostatAvg>::iterator it;
-
-      for (it = tit->second.begin(); it != tit->second.end(); ++it) {
-        it->second.StampZero(now);
-      }
-    }
-
-    // loop over domain accounting
-    for (dit = IostatAvgDomainIOrb.begin(); dit != IostatAvgDomainIOrb.end();
-         dit++) {
-      dit->second.StampZero(now);
-    }
-
-    for (dit = IostatAvgDomainIOwb.begin(); dit != IostatAvgDomainIOwb.end();
-         dit++) {
-      dit->second.StampZero(now);
-    }
-
-    // loop over app accounting
-    for (dit = IostatAvgAppIOrb.begin(); dit != IostatAvgAppIOrb.end(); dit++) {
-      dit->second.StampZero(now);
-    }
-
-    for (dit = IostatAvgAppIOwb.begin(); dit != IostatAvgAppIOwb.end(); dit++) {
-      dit->second.StampZero(now);
-    }
-
-    Mutex.UnLock();
+    mStore.StampZero(time(NULL));
     size_t popularitybin = (((time(NULL))) % (IOSTAT_POPULARITY_DAY *
                             IOSTAT_POPULARITY_HISTORY_DAYS)) / IOSTAT_POPULARITY_DAY;
 
@@ -2008,79 +1971,6 @@ Iostat::AddToPopularity(std::string path, unsigned long long rb,
   }
 }
 
-/* ------------------------------------------------------------------------- */
-void
-IostatAvg::Add(unsigned long long val, time_t starttime, time_t stoptime)
-{
-  time_t now = time(0);
-  size_t tdiff = stoptime - starttime;
-  size_t toff = now - stoptime;
-
-  if (toff < 86400) {
-    // if the measurements was done in the last 86400 seconds
-    unsigned int mbins = tdiff / 1440; // number of bins the measurement was hitting
-
-    if (mbins == 0) {
-      mbins = 1;
-    }
-
-    unsigned long long norm_val = (1.0 * val / mbins);
-
-    for (size_t bins = 0; bins < mbins; bins++) {
-      unsigned int bin86400 = (((stoptime - (bins * 1440)) / 1440) % 60);
-      avg86400[bin86400] += norm_val;
-    }
-  }
-
-  if (toff < 3600) {
-    // if the measurements was done in the last 3600 seconds
-    unsigned int mbins = tdiff / 60; // number of bins the measurement was hitting
-
-    if (mbins == 0) {
-      mbins = 1;
-    }
-
-    unsigned long long norm_val = 1.0 * val / mbins;
-
-    for (size_t bins = 0; bins < mbins; bins++) {
-      unsigned int bin3600 = (((stoptime - (bins * 60)) / 60) % 60);
-      avg3600[bin3600] += norm_val;
-    }
-  }
-
-  if (toff < 300) {
-    // if the measurements was done in the last 300 seconds
-    unsigned int mbins = tdiff / 5; // number of bins the measurement was hitting
-
-    if (mbins == 0) {
-      mbins = 1;
-    }
-
-    unsigned long long norm_val = 1.0 * val / mbins;
-
-    for (size_t bins = 0; bins < mbins; bins++) {
-      unsigned int bin300 = (((stoptime - (bins * 5)) / 5) % 60);
-      avg300[bin300] += norm_val;
-    }
-  }
-
-  if (toff < 60) {
-    // if the measurements was done in the last 60 seconds
-    unsigned int mbins = tdiff / 1; // number of bins the measurement was hitting
-
-    if (mbins == 0) {
-      mbins = 1;
-    }
-
-    unsigned long long norm_val = 1.0 * val / mbins;
-
-    for (size_t bins = 0; bins < mbins; ++bins) {
-      unsigned int bin60 = (((stoptime - (bins * 1)) / 1) % 60);
-      avg60[bin60] += norm_val;
-    }
-  }
-}
-
 //------------------------------------------------------------------------------
 // Encode the UDP popularity targets to a string using the provided separator
 //------------------------------------------------------------------------------
@@ -2103,68 +1993,4 @@ Iostat::EncodeUdpPopularityTargets() const
   return out;
 }
 
-//------------------------------------------------------------------------------
-// Reset all the bins
-//------------------------------------------------------------------------------
-void
-IostatAvg::StampZero(time_t& now)
-{
-  unsigned int bin86400 = (now / 1440);
-  unsigned int bin3600 = (now / 60);
-  unsigned int bin300 = (now / 5);
-  unsigned int bin60 = (now / 1);
-  avg86400[(bin86400 + 1) % 60] = 0;
-  avg3600[(bin3600 + 1) % 60] = 0;
-  avg300[(bin300 + 1) % 60] = 0;
-  avg60[(bin60 + 1) % 60] = 0;
-}
-
-double
-IostatAvg::GetAvg86400()
-{
-  double sum = 0;
-
-  for (int i = 0; i < 60; i++) {
-    sum += avg86400[i];
-  }
-
-  return sum;
-}
-
-double
-IostatAvg::GetAvg3600()
-{
-  double sum = 0;
-
-  for (int i = 0; i < 60; i++) {
-    sum += avg3600[i];
-  }
-
-  return sum;
-}
-
-double
-IostatAvg::GetAvg300()
-{
-  double sum = 0;
-
-  for (int i = 0; i < 60; i++) {
-    sum += avg300[i];
-  }
-
-  return sum;
-}
-
-double
-IostatAvg::GetAvg60()
-{
-  double sum = 0;
-
-  for (int i = 0; i < 60; i++) {
-    sum += avg60[i];
-  }
-
-  return sum;
-}
-
 EOSMGMNAMESPACE_END
@@ -26,10 +26,12 @@
 
 #include "mgm/Namespace.hh"
 #include "common/AssistedThread.hh"
+#include "mgm/IostatStore.hh"
 #include <google/sparse_hash_map>
 #include <sys/types.h>
 #include <string>
 #include <set>
+#include <vector>
 #include <atomic>
 #include <sys/socket.h>
 #include <netinet/in.h>
@@ -49,43 +51,6 @@ EOSMGMNAMESPACE_BEGIN
 #define IOSTAT_POPULARITY_HISTORY_DAYS 7
 #define IOSTAT_POPULARITY_DAY 86400
 
-class IostatAvg
-{
-public:
-  unsigned long long avg86400[60];
-  unsigned long long avg3600[60];
-  unsigned long long avg300[60];
-  unsigned long long avg60[60];
-
-  IostatAvg()
-  {
-    memset(avg86400, 0, sizeof(avg86400));
-    memset(avg3600, 0, sizeof(avg3600));
-    memset(avg300, 0, sizeof(avg300));
-    memset(avg60, 0, sizeof(avg60));
-  }
-
-  ~IostatAvg() { };
-
-  void
-  Add(unsigned long long val, time_t starttime, time_t stoptime);
-
-  void
-  StampZero(time_t& now);
-
-  double
-  GetAvg86400();
-
-  double
-  GetAvg3600();
-
-  double
-  GetAvg300();
-
-  double
-  GetAvg60();
-};
-
 class Iostat
 {
   // -------------------------------------------------------------
@@ -93,21 +58,10 @@ class Iostat
   // -------------------------------------------------------------
 private:
 
+  //! Mutex protecting the report file and the collection state
   XrdSysMutex Mutex;
-  google::sparse_hash_map<std::string, google::sparse_hash_map<uid_t, unsigned long long> >
-  IostatUid;
-  google::sparse_hash_map<std::string, google::sparse_hash_map<gid_t, unsigned long long> >
-  IostatGid;
-  google::sparse_hash_map<std::string, google::sparse_hash_map<uid_t, IostatAvg> >
-  IostatAvgUid;
-  google::sparse_hash_map<std::string, google::sparse_hash_map<gid_t, IostatAvg> >
-  IostatAvgGid;
-
-  google::sparse_hash_map<std::string, IostatAvg> IostatAvgDomainIOrb;
-  google::sparse_hash_map<std::string, IostatAvg> IostatAvgDomainIOwb;
-
-  google::sparse_hash_map<std::string, IostatAvg> IostatAvgAppIOrb;
-  google::sparse_hash_map<std::string, IostatAvg> IostatAvgAppIOwb;
+  //! Counters and rate windows per uid/gid, domain and application
+  IostatStore mStore;
 
   std::set<std::string> IoDomains;
   std::set<std::string> IoNodes;
@@ -259,111 +213,23 @@ public:
 
 
 
-  // Stats collection
-  void
-  Add(const char* tag, uid_t uid, gid_t gid, unsigned long long val,
-      time_t starttime,
-      time_t stoptime)
-  {
-    Mutex.Lock();
-    IostatUid[tag][uid] += val;
-    IostatGid[tag][gid] += val;
-    IostatAvgUid[tag][uid].Add(val, starttime, stoptime);
-    IostatAvgGid[tag][gid].Add(val, starttime, stoptime);
-    Mutex.UnLock();
-  }
-
-  unsigned long long
-  GetTotal(const char* tag)
-  {
-    google::sparse_hash_map<uid_t, unsigned long long>::const_iterator it;
-    unsigned long long val = 0;
-
-    if (!IostatUid.count(tag)) {
-      return 0;
-    }
-
-    for (it = IostatUid[tag].begin(); it != IostatUid[tag].end(); ++it) {
-      val += it->second;
-    }
-
-    return val;
-  }
-
-  // warning: you have to lock the mutex if directly used
-
-  double
-  GetTotalAvg86400(const char* tag)
-  {
-    google::sparse_hash_map<uid_t, IostatAvg>::iterator it;
-    double val = 0;
-
-    if (!IostatAvgUid.count(tag)) {
-      return 0;
-    }
-
-    for (it = IostatAvgUid[tag].begin(); it != IostatAvgUid[tag].end(); ++it) {
-      val += it->second.GetAvg86400();
-    }
-
-    return val;
-  }
-
-  // warning: you have to lock the mutex if directly used
-
-  double
-  GetTotalAvg3600(const char* tag)
-  {
-    google::sparse_hash_map<uid_t, IostatAvg>::iterator it;
-    double val = 0;
-
-    if (!IostatAvgUid.count(tag)) {
-      return 0;
-    }
-
-    for (it = IostatAvgUid[tag].begin(); it != IostatAvgUid[tag].end(); ++it) {
-      val += it->second.GetAvg3600();
-    }
-
-    return val;
-  }
-
-  // warning: you have to lock the mutex if directly used
-
-  double
-  GetTotalAvg300(const char* tag)
-  {
-    google::sparse_hash_map<uid_t, IostatAvg>::iterator it;
-    double val = 0;
-
-    if (!IostatAvgUid.count(tag)) {
-      return 0;
-    }
-
-    for (it = IostatAvgUid[tag].begin(); it != IostatAvgUid[tag].end(); ++it) {
-      val += it->second.GetAvg300();
-    }
-
-    return val;
-  }
-
-  // warning: you have to lock the mutex if directly used
-
-  double
-  GetTotalAvg60(const char* tag)
+  //----------------------------------------------------------------------------
+  //! Append the uid and gid samples of a measurement to an ingestion batch
+  //!
+  //! @param batch ingestion batch
+  //! @param tag interned measurement tag
+  //! @param uid user id
+  //! @param gid group id
+  //! @param val measured value
+  //! @param starttime start of the measurement
+  //! @param stoptime end of the measurement
+  //----------------------------------------------------------------------------
+  static void
+  Add(std::vector<IostatStore::Sample>& batch, uint32_t tag, uid_t uid,
+      gid_t gid, unsigned long long val, time_t starttime, time_t stoptime)
   {
-    google::sparse_hash_map<uid_t, IostatAvg>::iterator it;
-    double val = 0;
-
-    if (!IostatAvgUid.count(tag)) {
-      return 0;
-    }
-
-    for (it = IostatAvgUid[tag].begin(); it != IostatAvgUid[tag].end(); ++it) {
-      val += it->second.GetAvg60();
-    }
-
-    return val;
+    batch.push_back({IostatStore::Kind::Uid, tag, uid, val, starttime, stoptime});
+    batch.push_back({IostatStore::Kind::Gid, tag, gid, val, starttime, stoptime});
   }
 
 private:
@@ -0,0 +1,322 @@
+//------------------------------------------------------------------------------
+//! @file IostatStore.cc
+//! @brief Sharded store for the io statistics counters and rate windows
+//------------------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2023 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+#include "mgm/IostatStore.hh"
+#include <algorithm>
+
+EOSMGMNAMESPACE_BEGIN
+
+//------------------------------------------------------------------------------
+// Spread a measurement over the buckets covered by [starttime, stoptime]
+//------------------------------------------------------------------------------
+void
+IostatAvg::Add(unsigned long long val, time_t starttime, time_t stoptime,
+               time_t now)
+{
+  size_t tdiff = stoptime - starttime;
+  size_t toff = now - stoptime;
+
+  if (toff < 86400) {
+    // if the measurements was done in the last 86400 seconds
+    unsigned int mbins = tdiff / 1440; // number of bins the measurement was hitting
+
+    if (mbins == 0) {
+      mbins = 1;
+    }
+
+    unsigned long long norm_val = (1.0 * val / mbins);
+
+    for (size_t bins = 0; bins < mbins; bins++) {
+      unsigned int bin86400 = (((stoptime - (bins * 1440)) / 1440) % 60);
+      avg86400[bin86400] += norm_val;
+    }
+  }
+
+  if (toff < 3600) {
+    // if the measurements was done in the last 3600 seconds
+    unsigned int mbins = tdiff / 60; // number of bins the measurement was hitting
+
+    if (mbins == 0) {
+      mbins = 1;
+    }
+
+    unsigned long long norm_val = 1.0 * val / mbins;
+
+    for (size_t bins = 0; bins < mbins; bins++) {
+      unsigned int bin3600 = (((stoptime - (bins * 60)) / 60) % 60);
+      avg3600[bin3600] += norm_val;
+    }
+  }
+
+  if (toff < 300) {
+    // if the measurements was done in the last 300 seconds
+    unsigned int mbins = tdiff / 5; // number of bins the measurement was hitting
+
+    if (mbins == 0) {
+      mbins = 1;
+    }
+
+    unsigned long long norm_val = 1.0 * val / mbins;
+
+    for (size_t bins = 0; bins < mbins; bins++) {
+      unsigned int bin300 = (((stoptime - (bins * 5)) / 5) % 60);
+      avg300[bin300] += norm_val;
+    }
+  }
+
+  if (toff < 60) {
+    // if the measurements was done in the last 60 seconds
+    unsigned int mbins = tdiff / 1; // number of bins the measurement was hitting
+
+    if (mbins == 0) {
+      mbins = 1;
+    }
+
+    unsigned long long norm_val = 1.0 * val / mbins;
+
+    for (size_t bins = 0; bins < mbins; ++bins) {
+      unsigned int bin60 = (((stoptime - (bins * 1)) / 1) % 60);
+      avg60[bin60] += norm_val;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// Reset all the bins
+//------------------------------------------------------------------------------
+void
+IostatAvg::StampZero(time_t now)
+{
+  unsigned int bin86400 = (now / 1440);
+  unsigned int bin3600 = (now / 60);
+  unsigned int bin300 = (now / 5);
+  unsigned int bin60 = (now / 1);
+  avg86400[(bin86400 + 1) % 60] = 0;
+  avg3600[(bin3600 + 1) % 60] = 0;
+  avg300[(bin300 + 1) % 60] = 0;
+  avg60[(bin60 + 1) % 60] = 0;
+}
+
+double
+IostatAvg::GetAvg86400() const
+{
+  double sum = 0;
+
+  for (int i = 0; i < 60; i++) {
+    sum += avg86400[i];
+  }
+
+  return sum;
+}
+
+double
+IostatAvg::GetAvg3600() const
+{
+  double sum = 0;
+
+  for (int i = 0; i < 60; i++) {
+    sum += avg3600[i];
+  }
+
+  return sum;
+}
+
+double
+IostatAvg::GetAvg300() const
+{
+  double sum = 0;
+
+  for (int i = 0; i < 60; i++) {
+    sum += avg300[i];
+  }
+
+  return sum;
+}
+
+double
+IostatAvg::GetAvg60() const
+{
+  double sum = 0;
+
+  for (int i = 0; i < 60; i++) {
+    sum += avg60[i];
+  }
+
+  return sum;
+}
+
+//------------------------------------------------------------------------------
+// Get the id of a tag, registering it if needed
+//------------------------------------------------------------------------------
+uint32_t
+IostatStore::Intern(const std::string& tag)
+{
+  std::lock_guard<std::mutex> lock(mTagsMutex);
+  auto it = mTagIds.find(tag);
+
+  if (it != mTagIds.end()) {
+    return it->second;
+  }
+
+  uint32_t id = mTags.size();
+  mTags.push_back(tag);
+  mTagIds.emplace(tag, id);
+  return id;
+}
+
+//------------------------------------------------------------------------------
+// Get the name of an interned tag
+//------------------------------------------------------------------------------
+std::string
+IostatStore::GetTag(uint32_t id) const
+{
+  std::lock_guard<std::mutex> lock(mTagsMutex);
+  return (id < mTags.size()) ? mTags[id] : std::string();
+}
+
+//------------------------------------------------------------------------------
+// Account a batch of samples
+//------------------------------------------------------------------------------
+void
+IostatStore::AddBatch(const std::vector<Sample>& samples, time_t now)
+{
+  if (samples.empty()) {
+    return;
+  }
+
+  // Group the samples by shard so that every shard is locked only once
+  std::vector<std::pair<uint64_t, const Sample*>> keyed;
+  keyed.reserve(samples.size());
+
+  for (const auto& sample : samples) {
+    keyed.emplace_back(MakeKey(sample.mKind, sample.mTag, sample.mId), &sample);
+  }
+
+  std::stable_sort(keyed.begin(), keyed.end(),
+  [](const std::pair<uint64_t, const Sample*>& lhs,
+     const std::pair<uint64_t, const Sample*>& rhs) {
+    return GetShardIndex(lhs.first) < GetShardIndex(rhs.first);
+  });
+  auto it = keyed.begin();
+
+  while (it != keyed.end()) {
+    Shard& shard = mShards[GetShardIndex(it->first)];
+    std::lock_guard<std::mutex> lock(shard.mMutex);
+    const size_t index = GetShardIndex(it->first);
+
+    for (; (it != keyed.end()) && (GetShardIndex(it->first) == index); ++it) {
+      const Sample* sample = it->second;
+      Counter& counter = shard.mCounters[it->first];
+      counter.mTotal += sample->mVal;
+      counter.mAvg.Add(sample->mVal, sample->mStart, sample->mStop, now);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// Overwrite the total counter of an entry
+//------------------------------------------------------------------------------
+void
+IostatStore::SetTotal(Kind kind, const std::string& tag, uint32_t id,
+                      unsigned long long val)
+{
+  uint64_t key = MakeKey(kind, Intern(tag), id);
+  Shard& shard = mShards[GetShardIndex(key)];
+  std::lock_guard<std::mutex> lock(shard.mMutex);
+  shard.mCounters[key].mTotal = val;
+}
+
+//------------------------------------------------------------------------------
+// Get a snapshot of the entries of the given kinds
+//------------------------------------------------------------------------------
+std::vector<IostatStore::Entry>
+IostatStore::GetSnapshot(const std::vector<Kind>& kinds) const
+{
+  std::vector<Entry> entries;
+  std::vector<std::pair<uint64_t, Counter>> copy;
+
+  for (const auto& shard : mShards) {
+    copy.clear();
+    {
+      // Only copy under the lock, the window sums are computed afterwards
+      std::lock_guard<std::mutex> lock(shard.mMutex);
+
+      for (const auto& elem : shard.mCounters) {
+        Kind kind = static_cast<Kind>(elem.first >> 56);
+
+        if (kinds.empty() ||
+            (std::find(kinds.begin(), kinds.end(), kind) != kinds.end())) {
+          copy.emplace_back(elem);
+        }
+      }
+    }
+
+    for (const auto& elem : copy) {
+      entries.emplace_back();
+      Entry& entry = entries.back();
+      entry.mKind = static_cast<Kind>(elem.first >> 56);
+      entry.mTag = GetTag((elem.first >> 32) & 0xffffff);
+      entry.mId = (uint32_t) elem.first;
+      entry.mTotal = elem.second.mTotal;
+      entry.mAvg60 = elem.second.mAvg.GetAvg60();
+      entry.mAvg300 = elem.second.mAvg.GetAvg300();
+      entry.mAvg3600 = elem.second.mAvg.GetAvg3600();
+      entry.mAvg86400 = elem.second.mAvg.GetAvg86400();
+    }
+  }
+
+  return entries;
+}
+
+//------------------------------------------------------------------------------
+// Reset the buckets about to be reused by the sliding windows
+//------------------------------------------------------------------------------
+void
+IostatStore::StampZero(time_t now)
+{
+  for (auto& shard : mShards) {
+    std::lock_guard<std::mutex> lock(shard.mMutex);
+
+    for (auto& elem : shard.mCounters) {
+      elem.second.mAvg.StampZero(now);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// Get number of entries
+//------------------------------------------------------------------------------
+size_t
+IostatStore::GetSize() const
+{
+  size_t size = 0;
+
+  for (const auto& shard : mShards) {
+    std::lock_guard<std::mutex> lock(shard.mMutex);
+    size += shard.mCounters.size();
+  }
+
+  return size;
+}
+
+EOSMGMNAMESPACE_END
@@ -0,0 +1,223 @@
+//------------------------------------------------------------------------------
+//! @file IostatStore.hh
+//! @brief Sharded store for the io statistics counters and rate windows
+//------------------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2023 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+#pragma once
+#include "mgm/Namespace.hh"
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+EOSMGMNAMESPACE_BEGIN
+
+//------------------------------------------------------------------------------
+//! Class IostatAvg - sliding window sums over the last 60s, 300s, 3600s and
+//! 86400s, each kept as a ring of 60 buckets
+//------------------------------------------------------------------------------
+class IostatAvg
+{
+public:
+  unsigned long long avg86400[60];
+  unsigned long long avg3600[60];
+  unsigned long long avg300[60];
+  unsigned long long avg60[60];
+
+  IostatAvg()
+  {
+    memset(avg86400, 0, sizeof(avg86400));
+    memset(avg3600, 0, sizeof(avg3600));
+    memset(avg300, 0, sizeof(avg300));
+    memset(avg60, 0, sizeof(avg60));
+  }
+
+  ~IostatAvg() { };
+
+  //----------------------------------------------------------------------------
+  //! Spread a measurement over the buckets covered by [starttime, stoptime]
+  //!
+  //! @param val measured value
+  //! @param starttime start of the measurement
+  //! @param stoptime end of the measurement
+  //! @param now current time
+  //----------------------------------------------------------------------------
+  void
+  Add(unsigned long long val, time_t starttime, time_t stoptime, time_t now);
+
+  void
+  StampZero(time_t now);
+
+  double
+  GetAvg86400() const;
+
+  double
+  GetAvg3600() const;
+
+  double
+  GetAvg300() const;
+
+  double
+  GetAvg60() const;
+};
+
+//------------------------------------------------------------------------------
+//! Class IostatStore - io statistics counters indexed by (kind, tag, id).
+//! Tags and names are interned to integer ids, the entries are spread over
+//! independently locked shards and updates are applied in batches so that
+//! every shard lock is taken at most once per batch. Readers work on
+//! snapshots and never block the ingestion for longer than the copy of a
+//! single shard.
+//------------------------------------------------------------------------------
+class IostatStore
+{
+public:
+  //----------------------------------------------------------------------------
+  //! Kind of accounting an entry belongs to. For the Uid and Gid kinds the
+  //! tag is the measurement and the id the uid/gid, for the other kinds the
+  //! tag is the domain/application name and the id is unused.
+  //----------------------------------------------------------------------------
+  enum class Kind : uint8_t {
+    Uid, Gid, DomainOut, DomainIn, AppOut, AppIn
+  };
+
+  //! Single measurement to be accounted
+  struct Sample {
+    Kind mKind;
+    uint32_t mTag;
+    uint32_t mId;
+    unsigned long long mVal;
+    time_t mStart;
+    time_t mStop;
+  };
+
+  //! Snapshot of an entry
+  struct Entry {
+    Kind mKind;
+    std::string mTag;
+    uint32_t mId;
+    unsigned long long mTotal;
+    double mAvg60;
+    double mAvg300;
+    double mAvg3600;
+    double mAvg86400;
+  };
+
+  //----------------------------------------------------------------------------
+  //! Get the id of a tag, registering it if needed
+  //!
+  //! @param tag tag name
+  //!
+  //! @return interned id
+  //----------------------------------------------------------------------------
+  uint32_t Intern(const std::string& tag);
+
+  //----------------------------------------------------------------------------
+  //! Get the name of an interned tag
+  //!
+  //! @param id interned id
+  //!
+  //! @return tag name or empty string if unknown
+  //----------------------------------------------------------------------------
+  std::string GetTag(uint32_t id) const;
+
+  //----------------------------------------------------------------------------
+  //! Account a batch of samples
+  //!
+  //! @param samples list of samples
+  //! @param now current time
+  //----------------------------------------------------------------------------
+  void AddBatch(const std::vector<Sample>& samples, time_t now);
+
+  //----------------------------------------------------------------------------
+  //! Overwrite the total counter of an entry, used when restoring a dump
+  //!
+  //! @param kind entry kind
+  //! @param tag tag name
+  //! @param id entry id
+  //! @param val counter value
+  //----------------------------------------------------------------------------
+  void SetTotal(Kind kind, const std::string& tag, uint32_t id,
+                unsigned long long val);
+
+  //----------------------------------------------------------------------------
+  //! Get a snapshot of the entries of the given kinds
+  //!
+  //! @param kinds kinds to include, all if empty
+  //!
+  //! @return list of entries, in no particular order
+  //----------------------------------------------------------------------------
+  std::vector<Entry> GetSnapshot(const std::vector<Kind>& kinds = {}) const;
+
+  //----------------------------------------------------------------------------
+  //! Reset the buckets about to be reused by the sliding windows
+  //!
+  //! @param now current time
+  //----------------------------------------------------------------------------
+  void StampZero(time_t now);
+
+  //----------------------------------------------------------------------------
+  //! Get number of entries
+  //----------------------------------------------------------------------------
+  size_t GetSize() const;
+
+private:
+  static constexpr unsigned int sShardBits = 4;
+  static constexpr size_t sNumShards = (1ull << sShardBits);
+
+  //! Counter and sliding windows of an entry
+  struct Counter {
+    unsigned long long mTotal {0};
+    IostatAvg mAvg;
+  };
+
+  struct Shard {
+    mutable std::mutex mMutex;
+    std::unordered_map<uint64_t, Counter> mCounters;
+  };
+
+  Shard mShards[sNumShards];
+  mutable std::mutex mTagsMutex; ///< Mutex protecting the interned tags
+  std::unordered_map<std::string, uint32_t> mTagIds;
+  std::vector<std::string> mTags;
+
+  //----------------------------------------------------------------------------
+  //! Build the key of an entry
+  //----------------------------------------------------------------------------
+  static inline uint64_t MakeKey(Kind kind, uint32_t tag, uint32_t id)
+  {
+    return ((uint64_t)kind << 56) | ((uint64_t)(tag & 0xffffff) << 32) | id;
+  }
+
+  //----------------------------------------------------------------------------
+  //! Get the shard index of a key
+  //----------------------------------------------------------------------------
+  static inline size_t GetShardIndex(uint64_t key)
+  {
+    key *= 0x9e3779b97f4a7c15ull;
+    return key >> (64 - sShardBits);
+  }
+};
+
+EOSMGMNAMESPACE_END
@@ -35,8 +35,9 @@
 #include "namespace/interface/IView.hh"
 #include "namespace/interface/ContainerIterators.hh"
 #include "namespace/Prefetcher.hh"
-#include "namespace/ns_quarkdb/explorer/NamespaceExplorer.hh"
+#include "namespace/ns_quarkdb/explorer/ParallelNamespaceExplorer.hh"
 #include "namespace/ns_quarkdb/NamespaceGroup.hh"
+#include "namespace/ns_quarkdb/accounting/PolicyIndex.hh"
 #include <qclient/QClient.hh>
 
 //! Attribute name defining any LRU policy
@@ -217,22 +218,39 @@ void LRU::performCycleInMem(ThreadAssistant& assistant) noexcept
 //------------------------------------------------------------------------------
 void LRU::performCycleQDB(ThreadAssistant& assistant) noexcept
 {
-  eos_static_info("%s", "msg=\"start LRU scan on QDB\"");
-  // Build exploration options..
-  ExplorationOptions opts;
-  opts.populateLinkedAttributes = true;
-  opts.view = gOFS->eosView;
-  opts.ignoreFiles = true;
-
   // Initialize qclient..
   if (!mQcl) {
     mQcl.reset(new qclient::QClient(gOFS->mQdbContactDetails.members,
                                     gOFS->mQdbContactDetails.constructOptions()));
   }
 
-  // Start exploring
-  NamespaceExplorer
-  explorer("/", opts, *(mQcl.get()),
+  if (QuarkPolicyIndex::IsReady(*mQcl)) {
+    // Pick up the containers indexed by a rebuild while we were running
+    QuarkPolicyIndex* index = static_cast<QuarkNamespaceGroup*>
+                              (gOFS->namespaceGroup.get())->getPolicyIndex();
+
+    if (index) {
+      index->ReloadIfRebuilt(*mQcl);
+    }
+
+    performCycleIndexed(assistant);
+    return;
+  }
+
+  eos_static_info("%s", "msg=\"start LRU scan on QDB, policy index not "
+                  "built - run eos-ns-inspect rebuild-policy-index to avoid "
+                  "full namespace scans\"");
+  // Build exploration options..
+  ExplorationOptions opts;
+  opts.populateLinkedAttributes = true;
+  opts.view = gOFS->eosView;
+  opts.ignoreFiles = true;
+  // Start exploring, directories are processed independently hence there is
+  // no need for ordered output
+  ParallelExplorationOptions parallel_opts;
+  parallel_opts.ordered = false;
+  ParallelNamespaceExplorer
+  explorer("/", opts, parallel_opts, *(mQcl.get()),
            static_cast<QuarkNamespaceGroup*>(gOFS->namespaceGroup.get())->getExecutor());
   NamespaceItem item;
   int64_t processed = 0;
@@ -257,6 +275,63 @@ void LRU::performCycleQDB(ThreadAssistant& assistant) noexcept
   eos_static_info("msg=\"LRU scan done\" num_scanned_dirs=%lli", processed);
 }
 
+//------------------------------------------------------------------------------
+// Perform a single LRU cycle, QDB namespace with policy index
+//------------------------------------------------------------------------------
+void LRU::performCycleIndexed(ThreadAssistant& assistant) noexcept
+{
+  std::set<eos::IContainerMD::id_t> ids;
+
+  for (const auto& prefix : QuarkPolicyIndex::sDefaultPrefixes) {
+    if (!QuarkPolicyIndex::GetContainers(*mQcl, prefix, ids)) {
+      eos_static_err("msg=\"failed to read LRU policy index\" prefix=\"%s\"",
+                     prefix.c_str());
+      return;
+    }
+  }
+
+  eos_static_info("msg=\"start LRU scan on policy index\" ndir=%llu",
+                  ids.size());
+  gOFS->MgmStats.Add("LRUFind", 0, 0, 1);
+  EXEC_TIMING_BEGIN("LRUFind");
+  std::set<std::string> lrudirs;
+
+  for (auto id : ids) {
+    eos::Prefetcher::prefetchContainerMDWithParentsAndWait(gOFS->eosView, id);
+    eos::common::RWMutexReadLock ns_rd_lock(gOFS->eosViewRWMutex, __FUNCTION__,
+                                            __LINE__, __FILE__);
+
+    try {
+      auto cmd = gOFS->eosDirectoryService->getContainerMD(id);
+      lrudirs.insert(gOFS->eosView->getUri(cmd.get()));
+    } catch (const eos::MDException& e) {
+      eos_static_debug("msg=\"skip stale LRU policy index entry\" cid=%llu",
+                       id);
+    }
+  }
+
+  EXEC_TIMING_END("LRUFind");
+  int64_t processed = 0;
+
+  // Scan backwards ... in this way we get rid of empty directories in one go
+  for (auto it = lrudirs.rbegin(); it != lrudirs.rend(); ++it) {
+    eos::IContainerMD::XAttrMap map;
+
+    if (!gOFS->_attr_ls(it->c_str(), mError, mRootVid, (const char*) 0, map,
+                        true, true)) {
+      eos_static_debug("lru-dir-qdb=\"%s\" attrs=%d", it->c_str(), map.size());
+      processDirectory(*it, 0, map);
+    }
+
+    if ((++processed % 1000 == 0) && assistant.terminationRequested()) {
+      eos_static_info("%s", "msg=\"termination requested, quit LRU\"");
+      break;
+    }
+  }
+
+  eos_static_info("msg=\"LRU scan done\" num_scanned_dirs=%lli", processed);
+}
+
 //------------------------------------------------------------------------------
 // LRU method doing the actual policy scrubbing
 //
@@ -178,6 +178,12 @@ private:
   //----------------------------------------------------------------------------
   void performCycleQDB(ThreadAssistant& assistant) noexcept;
 
+  //----------------------------------------------------------------------------
+  // Perform a single LRU cycle, QDB namespace, visiting only the directories
+  // of the policy index
+  //----------------------------------------------------------------------------
+  void performCycleIndexed(ThreadAssistant& assistant) noexcept;
+
   std::unique_ptr<qclient::QClient> mQcl; ///< Internal QCl object
   AssistedThread mThread; ///< thread id of the LRU thread
   eos::common::VirtualIdentity mRootVid; ///< Uses the root vid
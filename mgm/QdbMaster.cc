@@ -623,6 +623,7 @@ QdbMaster::DisableNsCaching()
   std::map<std::string, std::string> map_cfg;
   map_cfg[constants::sMaxNumCacheFiles] = "0";
   map_cfg[constants::sMaxNumCacheDirs] = "0";
+  map_cfg[constants::sMaxNumCacheDentries] = "0";
   gOFS->eosFileService->configure(map_cfg);
   gOFS->eosDirectoryService->configure(map_cfg);
 }
@@ -37,6 +37,7 @@ bool
 Vid::Set(const char* value, bool storeConfig)
 {
   eos::common::RWMutexWriteLock lock(eos::common::Mapping::gMapMutex);
+  eos::common::Mapping::InvalidateVidCache();
   XrdOucEnv env(value);
   XrdOucString skey = env.Get("mgm.vid.key");
   XrdOucString svalue = value;
@@ -352,6 +353,7 @@ Vid::Rm(XrdOucEnv& env,
         bool storeConfig)
 {
   eos::common::RWMutexWriteLock lock(eos::common::Mapping::gMapMutex);
+  eos::common::Mapping::InvalidateVidCache();
   XrdOucString skey = env.Get("mgm.vid.key");
   XrdOucString vidcmd = env.Get("mgm.vid.cmd");
   int envlen = 0;
@@ -50,6 +50,12 @@
  * filesystem/node/group/space configuration. The second mutex is protecting
  * the quota configuration and scheduling. The last mutex is protecting the
  * namespace.
+ * With the QuarkDB namespace the operations changing only a few containers or
+ * files (attribute set/remove, utimes, mkdir) take eosViewRWMutex for read and
+ * lock the changed objects through an eos::NsObjectLock on eosViewObjectLocks,
+ * see namespace/utils/ObjectLocks.hh. A mkdir locks the parent before creating
+ * the new container and adds the new container to its locks. The in-memory
+ * namespace and the other operations take eosViewRWMutex for write.
  * The implementation uses a bunch of convenience macros to cut the code short.
  * These macro's filter/map path names, apply redirection, stalling rules and
  * require certain authentication credentials to be able to run some function.
@@ -118,6 +124,7 @@
 #include "namespace/interface/IFileMD.hh"
 #include "namespace/interface/INamespaceGroup.hh"
 #include "namespace/ns_quarkdb/QdbContactDetails.hh"
+#include "namespace/utils/ObjectLocks.hh"
 #include "mgm/InFlightTracker.hh"
 #include "XrdAcc/XrdAccPrivs.hh"
 #include <google/sparse_hash_map>
@@ -1606,6 +1613,8 @@ public:
   //! Subtree mtime propagation
   eos::IContainerMDChangeListener* eosSyncTimeAccounting;
   eos::common::RWMutex eosViewRWMutex; ///< RW namespace mutex
+  //! Per container and per file locks taken under eosViewRWMutex read lock
+  eos::ObjectLockTable eosViewObjectLocks;
   XrdOucString
   MgmMetaLogDir; ///<  Directory containing the meta data (change) log files
   eos::common::MutexLatencyWatcher mViewMutexWatcher;
@@ -2017,6 +2026,16 @@ private:
            eos::common::VirtualIdentity& vid,
            const XrdSecEntity* client);
 
+  //----------------------------------------------------------------------------
+  //! Drop the replica of a file on the given file system and remove the file
+  //! from the namespace once no replica is left
+  //!
+  //! @param fid file id
+  //! @param fsid file system id
+  //! @param drop_all if true drop all the replicas of the file
+  //----------------------------------------------------------------------------
+  void DropReplica(eos::IFileMD::id_t fid, unsigned long fsid, bool drop_all);
+
   //----------------------------------------------------------------------------
   //! Trigger an event
   //----------------------------------------------------------------------------
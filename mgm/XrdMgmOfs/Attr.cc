@@ -149,11 +149,13 @@ XrdMgmOfs::_attr_set(const char* path, XrdOucErrInfo& error,
   }
 
   std::shared_ptr<eos::IContainerMD> dh;
-  eos::common::RWMutexWriteLock ns_wr_lock;
+  eos::NsObjectLock ns_lock;
   eos::Prefetcher::prefetchContainerMDAndWait(gOFS->eosView, path);
 
+  // Without take_lock the caller holds the namespace write lock
   if (take_lock) {
-    ns_wr_lock.Grab(gOFS->eosViewRWMutex, __FUNCTION__, __LINE__, __FILE__);
+    ns_lock.Grab(gOFS->eosViewRWMutex, gOFS->eosViewObjectLocks, gOFS->NsInQDB,
+                 __FUNCTION__, __LINE__, __FILE__);
   }
 
   try {
@@ -186,6 +188,7 @@ XrdMgmOfs::_attr_set(const char* path, XrdOucErrInfo& error,
         }
       }
 
+      ns_lock.Lock({{eos::ObjectLockTable::Type::kContainer, dh->getId()}});
       dh->setAttribute(key, val.c_str());
 
       if (Key != "sys.tmp.etag") {
@@ -196,9 +199,7 @@ XrdMgmOfs::_attr_set(const char* path, XrdOucErrInfo& error,
       eos::ContainerIdentifier d_id = dh->getIdentifier();
       eos::ContainerIdentifier d_pid = dh->getParentIdentifier();
 
-      if (take_lock) {
-        ns_wr_lock.Release();
-      }
+      ns_lock.Release();
 
       gOFS->FuseXCastContainer(d_id);
       gOFS->FuseXCastRefresh(d_id, d_pid);
@@ -225,6 +226,7 @@ XrdMgmOfs::_attr_set(const char* path, XrdOucErrInfo& error,
         XrdOucString val64 = value;
         XrdOucString val;
         eos::common::SymKey::DeBase64(val64, val);
+        ns_lock.Lock({{eos::ObjectLockTable::Type::kFile, fmd->getId()}});
         fmd->setAttribute(key, val.c_str());
 
         if (Key != "sys.tmp.etag") {
@@ -234,9 +236,7 @@ XrdMgmOfs::_attr_set(const char* path, XrdOucErrInfo& error,
         eosView->updateFileStore(fmd.get());
         eos::FileIdentifier f_id = fmd->getIdentifier();
 
-        if (take_lock) {
-          ns_wr_lock.Release();
-        }
+        ns_lock.Release();
 
         gOFS->FuseXCastFile(f_id);
         errno = 0;
@@ -497,7 +497,8 @@ XrdMgmOfs::_attr_rem(const char* path, XrdOucErrInfo& error,
   }
 
   eos::Prefetcher::prefetchContainerMDAndWait(gOFS->eosView, path);
-  eos::common::RWMutexWriteLock lock(gOFS->eosViewRWMutex, __FUNCTION__, __LINE__, __FILE__);
+  eos::NsObjectLock lock(gOFS->eosViewRWMutex, gOFS->eosViewObjectLocks,
+                         gOFS->NsInQDB, __FUNCTION__, __LINE__, __FILE__);
 
   try {
     dh = gOFS->eosView->getContainer(path);
@@ -510,6 +511,8 @@ XrdMgmOfs::_attr_rem(const char* path, XrdOucErrInfo& error,
       if (dh && (!dh->access(vid.uid, vid.gid, X_OK | W_OK))) {
         errno = EPERM;
       } else {
+        lock.Lock({{eos::ObjectLockTable::Type::kContainer, dh->getId()}});
+
         if (dh->hasAttribute(key)) {
           dh->removeAttribute(key);
           eosView->updateContainerStore(dh.get());
@@ -543,6 +546,8 @@ XrdMgmOfs::_attr_rem(const char* path, XrdOucErrInfo& error,
           // TODO: REVIEW: only owner can set file attributes
           errno = EPERM;
         } else {
+          lock.Lock({{eos::ObjectLockTable::Type::kFile, fmd->getId()}});
+
           if (fmd->hasAttribute(key)) {
             fmd->removeAttribute(key);
             eosView->updateFileStore(fmd.get());
@@ -334,15 +334,17 @@ XrdMgmOfs::_mkdir(const char* path,
       eos::common::Path tmp_path("");
 
       for (j = i + 1; j < (int) cPath.GetSubPathSize(); ++j) {
-        eos::common::RWMutexWriteLock lock(gOFS->eosViewRWMutex, __FUNCTION__, __LINE__,
-                                           __FILE__);
+        eos::NsObjectLock lock(gOFS->eosViewRWMutex, gOFS->eosViewObjectLocks,
+                               gOFS->NsInQDB, __FUNCTION__, __LINE__, __FILE__);
 
         try {
           errno = 0;
           eos_debug("creating path %s", cPath.GetSubPath(j));
           tmp_path.Init(cPath.GetSubPath(j));
           dir = eosView->getContainer(tmp_path.GetParentPath());
+          lock.Lock({{eos::ObjectLockTable::Type::kContainer, dir->getId()}});
           newdir = eosView->createContainer(cPath.GetSubPath(j), recurse);
+          lock.Add(eos::ObjectLockTable::Type::kContainer, newdir->getId());
           newdir->setCUid(vid.uid);
           newdir->setCGid(vid.gid);
           newdir->setMode(dir->getMode());
@@ -399,13 +401,15 @@ XrdMgmOfs::_mkdir(const char* path,
     return Emsg(epname, error, errno, "mkdir", path);
   }
 
-  eos::common::RWMutexWriteLock lock(gOFS->eosViewRWMutex, __FUNCTION__, __LINE__,
-                                     __FILE__);
+  eos::NsObjectLock lock(gOFS->eosViewRWMutex, gOFS->eosViewObjectLocks,
+                         gOFS->NsInQDB, __FUNCTION__, __LINE__, __FILE__);
 
   try {
     errno = 0;
     dir = eosView->getContainer(cPath.GetParentPath());
+    lock.Lock({{eos::ObjectLockTable::Type::kContainer, dir->getId()}});
     newdir = eosView->createContainer(path);
+    lock.Add(eos::ObjectLockTable::Type::kContainer, newdir->getId());
     newdir->setCUid(vid.uid);
     newdir->setCGid(vid.gid);
     // @note: we always inherit the mode of the parent directory. So far nobody
@@ -97,7 +97,8 @@ XrdMgmOfs::_utimes(const char* path,
   gOFS->MgmStats.Add("Utimes", vid.uid, vid.gid, 1);
   eos_info("calling utimes for path=%s, uid=%i, gid=%i", path, vid.uid, vid.gid);
   // ---------------------------------------------------------------------------
-  eos::common::RWMutexWriteLock lock(gOFS->eosViewRWMutex, __FUNCTION__, __LINE__, __FILE__);
+  eos::NsObjectLock ns_lock(gOFS->eosViewRWMutex, gOFS->eosViewObjectLocks,
+                            gOFS->NsInQDB, __FUNCTION__, __LINE__, __FILE__);
 
   if (gOFS->_access(path,
 		    W_OK,
@@ -111,7 +112,7 @@ XrdMgmOfs::_utimes(const char* path,
 
   try {
     cmd = gOFS->eosView->getContainer(path, false);
-
+    ns_lock.Lock({{eos::ObjectLockTable::Type::kContainer, cmd->getId()}});
     cmd->setMTime(tvp[1]);
     cmd->notifyMTimeChange(gOFS->eosDirectoryService);
     eosView->updateContainerStore(cmd.get());
@@ -129,6 +130,7 @@ XrdMgmOfs::_utimes(const char* path,
       // Check permissions on the directory
       eos::common::Path cont_path(path);
       cmd = gOFS->eosView->getContainer(cont_path.GetParentPath(), false);
+      ns_lock.Lock({{eos::ObjectLockTable::Type::kFile, fmd->getId()}});
 
       // Set the ctime only if different from 0.0
       if (tvp[0].tv_sec != 0 || tvp[0].tv_nsec != 0) {
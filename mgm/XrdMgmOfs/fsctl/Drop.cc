@@ -56,107 +56,54 @@ XrdMgmOfs::Drop(const char* path,
   int envlen;
   eos_thread_info("drop request for %s", env.Env(envlen));
   char* afid = env.Get("mgm.fid");
+  char* afids = env.Get("mgm.fids");
   char* afsid = env.Get("mgm.fsid");
+  size_t num_dropped = 0;
 
   if (afid && afsid) {
     eos::IFileMD::id_t fid = eos::common::FileId::Hex2Fid(afid);
     unsigned long fsid = strtoul(afsid, 0, 10);
-    std::shared_ptr<eos::IContainerMD> container;
-    std::shared_ptr<eos::IFileMD> fmd;
-    eos::IQuotaNode* ns_quota = nullptr;
     eos::Prefetcher::prefetchFileMDWithParentsAndWait(gOFS->eosView, fid);
-    eos::common::RWMutexWriteLock wlock(gOFS->eosViewRWMutex, __FUNCTION__,
-                                        __LINE__, __FILE__);
+    // If mgm.dropall flag is set then it means we got a deleteOnClose
+    // at the gateway node and we need to delete all replicas
+    DropReplica(fid, fsid, env.Get("mgm.dropall") != nullptr);
+    num_dropped = 1;
+  } else if (afids && afsid) {
+    // Bulk drop sent by the FST deletion pipeline, comma separated hex fids
+    unsigned long fsid = strtoul(afsid, 0, 10);
+    std::vector<eos::IFileMD::id_t> fids;
+    std::string sfids = afids;
+    size_t pos = 0;
 
-    try {
-      fmd = eosFileService->getFileMD(fid);
-    } catch (...) {
-      eos_thread_warning("msg=\"no meta record exists anymore\" fxid=%s", afid);
-      // Nevertheless drop the file identifier from the file system view
-      gOFS->eosFsView->eraseEntry(fsid, fid);
-    }
+    while (pos < sfids.length()) {
+      size_t end = sfids.find(',', pos);
 
-    if (fmd) {
-      try {
-        container =
-          gOFS->eosDirectoryService->getContainerMD(fmd->getContainerId());
-      } catch (eos::MDException& e) {}
-
-      if (container) {
-        try {
-          ns_quota = gOFS->eosView->getQuotaNode(container.get());
-        } catch (eos::MDException& e) {
-          ns_quota = nullptr;
-        }
+      if (end == std::string::npos) {
+        end = sfids.length();
       }
 
-      try {
-        std::vector<unsigned int> drop_fsid;
-        bool updatestore = false;
-        // If mgm.dropall flag is set then it means we got a deleteOnClose
-        // at the gateway node and we need to delete all replicas
-        char* drop_all = env.Get("mgm.dropall");
-
-        if (drop_all) {
-          for (unsigned int i = 0; i < fmd->getNumLocation(); i++) {
-            drop_fsid.push_back(fmd->getLocation(i));
-          }
-        } else {
-          drop_fsid.push_back(fsid);
-        }
+      if (end > pos) {
+        fids.push_back(eos::common::FileId::Hex2Fid
+                       (sfids.substr(pos, end - pos).c_str()));
+      }
 
-        // Drop the selected replicas
-        for (const auto& id : drop_fsid) {
-          eos_thread_debug("msg=\"remove location\" fxid=%s fsid=%lu", afid, id);
-          updatestore = false;
-
-          if (fmd->hasLocation(id)) {
-            fmd->unlinkLocation(id);
-            updatestore = true;
-          }
-
-          if (fmd->hasUnlinkedLocation(id)) {
-            fmd->removeLocation(id);
-            updatestore = true;
-          }
-
-          if (updatestore) {
-            gOFS->eosView->updateFileStore(fmd.get());
-            // After update we might have to get the new address
-            fmd = eosFileService->getFileMD(eos::common::FileId::Hex2Fid(afid));
-          }
-        }
+      pos = end + 1;
+    }
 
-        // Delete the record only if all replicas are dropped
-        if ((!fmd->getNumUnlinkedLocation()) && (!fmd->getNumLocation())
-            && (drop_all || updatestore)) {
-          // However we should only remove the file from the namespace, if
-          // there was indeed a replica to be dropped, otherwise we get
-          // unlinked files if the secondary replica fails to write but
-          // the machine can call the MGM
-          if (ns_quota) {
-            // If we were still attached to a container, we can now detach
-            // and count the file as removed
-            ns_quota->removeFile(fmd.get());
-          }
-
-          gOFS->eosView->removeFile(fmd.get());
-
-          if (container) {
-            container->setMTimeNow();
-            gOFS->eosView->updateContainerStore(container.get());
-            container->notifyMTimeChange(gOFS->eosDirectoryService);
-            eos::ContainerIdentifier container_id = container->getIdentifier();
-            eos::ContainerIdentifier container_pid = container->getParentIdentifier();
-            wlock.Release();
-            gOFS->FuseXCastContainer(container_id);
-            gOFS->FuseXCastRefresh(container_id, container_pid);
-          }
-        }
-      } catch (...) {
-        eos_thread_warning("no meta record exists anymore for fxid=%s", afid);
-      }
+    eos::Prefetcher prefetcher(gOFS->eosView);
+
+    for (const auto fid : fids) {
+      prefetcher.stageFileMDWithParents(fid);
+    }
+
+    prefetcher.wait();
+
+    // One namespace lock per file, a big batch must not block everybody else
+    for (const auto fid : fids) {
+      DropReplica(fid, fsid, false);
     }
+
+    num_dropped = fids.size();
   } else {
     eos_thread_err("drop message does not contain all meta information: %s",
                    env.Env(envlen));
@@ -164,9 +111,113 @@ XrdMgmOfs::Drop(const char* path,
                 "missing meta information");
   }
 
-  gOFS->MgmStats.Add("Drop", vid.uid, vid.gid, 1);
+  gOFS->MgmStats.Add("Drop", vid.uid, vid.gid, num_dropped);
   const char* ok = "OK";
   error.setErrInfo(strlen(ok) + 1, ok);
   EXEC_TIMING_END("Drop");
   return SFS_DATA;
 }
+
+//----------------------------------------------------------------------------
+// Drop the replica of a file on the given file system
+//----------------------------------------------------------------------------
+void
+XrdMgmOfs::DropReplica(eos::IFileMD::id_t fid, unsigned long fsid,
+                       bool drop_all)
+{
+  std::shared_ptr<eos::IContainerMD> container;
+  std::shared_ptr<eos::IFileMD> fmd;
+  eos::IQuotaNode* ns_quota = nullptr;
+  eos::common::RWMutexWriteLock wlock(gOFS->eosViewRWMutex, __FUNCTION__,
+                                      __LINE__, __FILE__);
+
+  try {
+    fmd = eosFileService->getFileMD(fid);
+  } catch (...) {
+    eos_thread_warning("msg=\"no meta record exists anymore\" fxid=%s",
+                       eos::common::FileId::Fid2Hex(fid).c_str());
+    // Nevertheless drop the file identifier from the file system view
+    gOFS->eosFsView->eraseEntry(fsid, fid);
+  }
+
+  if (fmd) {
+    try {
+      container =
+        gOFS->eosDirectoryService->getContainerMD(fmd->getContainerId());
+    } catch (eos::MDException& e) {}
+
+    if (container) {
+      try {
+        ns_quota = gOFS->eosView->getQuotaNode(container.get());
+      } catch (eos::MDException& e) {
+        ns_quota = nullptr;
+      }
+    }
+
+    try {
+      std::vector<unsigned int> drop_fsid;
+      bool updatestore = false;
+
+      if (drop_all) {
+        for (unsigned int i = 0; i < fmd->getNumLocation(); i++) {
+          drop_fsid.push_back(fmd->getLocation(i));
+        }
+      } else {
+        drop_fsid.push_back(fsid);
+      }
+
+      // Drop the selected replicas
+      for (const auto& id : drop_fsid) {
+        eos_thread_debug("msg=\"remove location\" fxid=%s fsid=%lu",
+                         eos::common::FileId::Fid2Hex(fid).c_str(), id);
+        updatestore = false;
+
+        if (fmd->hasLocation(id)) {
+          fmd->unlinkLocation(id);
+          updatestore = true;
+        }
+
+        if (fmd->hasUnlinkedLocation(id)) {
+          fmd->removeLocation(id);
+          updatestore = true;
+        }
+
+        if (updatestore) {
+          gOFS->eosView->updateFileStore(fmd.get());
+          // After update we might have to get the new address
+          fmd = eosFileService->getFileMD(fid);
+        }
+      }
+
+      // Delete the record only if all replicas are dropped
+      if ((!fmd->getNumUnlinkedLocation()) && (!fmd->getNumLocation())
+          && (drop_all || updatestore)) {
+        // However we should only remove the file from the namespace, if
+        // there was indeed a replica to be dropped, otherwise we get
+        // unlinked files if the secondary replica fails to write but
+        // the machine can call the MGM
+        if (ns_quota) {
+          // If we were still attached to a container, we can now detach
+          // and count the file as removed
+          ns_quota->removeFile(fmd.get());
+        }
+
+        gOFS->eosView->removeFile(fmd.get());
+
+        if (container) {
+          container->setMTimeNow();
+          gOFS->eosView->updateContainerStore(container.get());
+          container->notifyMTimeChange(gOFS->eosDirectoryService);
+          eos::ContainerIdentifier container_id = container->getIdentifier();
+          eos::ContainerIdentifier container_pid = container->getParentIdentifier();
+          wlock.Release();
+          gOFS->FuseXCastContainer(container_id);
+          gOFS->FuseXCastRefresh(container_id, container_pid);
+        }
+      }
+    } catch (...) {
+      eos_thread_warning("no meta record exists anymore for fxid=%s",
+                         eos::common::FileId::Fid2Hex(fid).c_str());
+    }
+  }
+}
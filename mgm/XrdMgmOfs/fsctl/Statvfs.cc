@@ -79,18 +79,18 @@ XrdMgmOfs::Statvfs(const char* path,
       // Use caching to avoid often expensive space recomputations
       if ((now - laststat) > (10 + rand() / RAND_MAX)) {
         // Take the sums from all file systems in 'default' space
-        if (FsView::gFsView.mSpaceView.count("default")) {
-          eos::common::RWMutexReadLock vlock(FsView::gFsView.ViewMutex);
-          freebytes =
-            FsView::gFsView.mSpaceView["default"]->SumLongLong("stat.statfs.freebytes",
-                false);
-          freefiles =
-            FsView::gFsView.mSpaceView["default"]->SumLongLong("stat.statfs.ffree", false);
-          maxbytes =
-            FsView::gFsView.mSpaceView["default"]->SumLongLong("stat.statfs.capacity",
-                false);
-          maxfiles =
-            FsView::gFsView.mSpaceView["default"]->SumLongLong("stat.statfs.files", false);
+        auto snapshot = FsView::gFsView.GetSnapshot();
+        const auto* default_space = snapshot->GetSpace("default");
+
+        if (default_space) {
+          freebytes = freefiles = maxbytes = maxfiles = 0;
+
+          for (const auto* fs : snapshot->GetFileSystems(*default_space)) {
+            freebytes += fs->mDiskFreeBytes;
+            freefiles += fs->mDiskFfree;
+            maxbytes += fs->mDiskCapacity;
+            maxfiles += fs->mDiskFiles;
+          }
         }
 
         laststat = now;
@@ -117,24 +117,39 @@ DrainFs::DoIt()
 
     for (auto it_fid = mNsFsView->getStreamingFileList(mFsId);
          it_fid && it_fid->valid(); /* no progress */) {
-      if (NumRunningJobs() <= mMaxJobs) {
-        std::shared_ptr<DrainTransferJob> job {
-          new DrainTransferJob(it_fid->getElement(), mFsId, mTargetFsId)};
+      uint64_t num_running = NumRunningJobs();
+
+      if (num_running <= mMaxJobs) {
+        // Fill all the free job slots at once so that the destinations of
+        // the new jobs are selected with a single scheduler call
+        std::vector<std::shared_ptr<DrainTransferJob>> batch;
+
+        while (it_fid->valid() &&
+               (num_running + batch.size() <= mMaxJobs)) {
+          std::shared_ptr<DrainTransferJob> job {
+            new DrainTransferJob(it_fid->getElement(), mFsId, mTargetFsId)};
+
+          if (!gOFS->mFidTracker.AddEntry(it_fid->getElement(), TrackerType::Drain)) {
+            job->ReportError(SSTR("msg=\"skip currently scheduled drain\" "
+                                  "fxid=" << std::hex << it_fid->getElement()));
+            eos::common::RWMutexWriteLock wr_lock(mJobsMutex);
+            mJobsFailed.insert(job);
+          } else {
+            batch.push_back(job);
+          }
+
+          // Advance to the next file id to be drained
+          it_fid->next();
+          --mPending;
+        }
 
-        if (!gOFS->mFidTracker.AddEntry(it_fid->getElement(), TrackerType::Drain)) {
-          job->ReportError(SSTR("msg=\"skip currently scheduled drain\" "
-                                "fxid=" << std::hex << it_fid->getElement()));
-          eos::common::RWMutexWriteLock wr_lock(mJobsMutex);
-          mJobsFailed.insert(job);
-        } else {
+        DrainTransferJob::SelectDstFs(batch);
+
+        for (const auto& job : batch) {
           mThreadPool.PushTask<void>([job] {return job->DoIt();});
           eos::common::RWMutexWriteLock wr_lock(mJobsMutex);
           mJobsRunning.push_back(job);
         }
-
-        // Advance to the next file id to be drained
-        it_fid->next();
-        --mPending;
       } else {
         std::this_thread::sleep_for(seconds(1));
       }
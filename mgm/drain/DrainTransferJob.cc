@@ -69,7 +69,12 @@ DrainTransferJob::DoIt() noexcept
   FileDrainInfo fdrain;
 
   try {
-    fdrain = GetFileInfo();
+    if (mFileInfo) {
+      fdrain = std::move(*mFileInfo);
+      mFileInfo.reset();
+    } else {
+      fdrain = GetFileInfo();
+    }
   } catch (const eos::MDException& e) {
     // This could be a ghost fid entry still present in the file system map
     // and we need to also drop it from there
@@ -84,7 +89,11 @@ DrainTransferJob::DoIt() noexcept
   }
 
   while (true) {
-    if (!SelectDstFs(fdrain)) {
+    // A destination selected as part of a batch is used only for the first
+    // attempt, the retries select a new one
+    if (mDstSelected) {
+      mDstSelected = false;
+    } else if (!SelectDstFs(fdrain)) {
       ReportError(SSTR("msg=\"failed to select destination file system\" fxid="
                        << eos::common::FileId::Fid2Hex(mFileId)));
       UpdateMgmStats();
@@ -561,6 +570,98 @@ DrainTransferJob::SelectDstFs(const FileDrainInfo& fdrain)
   return true;
 }
 
+//------------------------------------------------------------------------------
+// Fetch file metadata and select the destination for a batch of jobs
+//------------------------------------------------------------------------------
+void
+DrainTransferJob::SelectDstFs(const
+                              std::vector<std::shared_ptr<DrainTransferJob>>& jobs)
+{
+  if (jobs.empty()) {
+    return;
+  }
+
+  eos::Prefetcher prefetcher(gOFS->eosView);
+
+  for (const auto& job : jobs) {
+    prefetcher.stageFileMDWithParents(job->mFileId);
+  }
+
+  prefetcher.wait();
+
+  for (const auto& job : jobs) {
+    try {
+      job->mFileInfo.reset(new FileDrainInfo(job->GetFileInfo()));
+    } catch (const eos::MDException& e) {
+      // Ghost entries are handled when the job runs
+    }
+  }
+
+  // Group the placement requests by the scheduling group of the source
+  std::map<FsGroup*, std::vector<DrainTransferJob*>> group_jobs;
+  std::map<FsGroup*, std::vector<GeoTreeEngine::PlacementRequest>> group_reqs;
+  eos::common::RWMutexReadLock fs_rd_lock(FsView::gFsView.ViewMutex);
+
+  for (const auto& job : jobs) {
+    if (!job->mFileInfo) {
+      continue;
+    }
+
+    eos::common::FileSystem* source_fs =
+      FsView::gFsView.mIdView.lookupByID(job->mFsIdSource);
+
+    if (source_fs == nullptr) {
+      continue;
+    }
+
+    eos::common::FileSystem::fs_snapshot_t source_snapshot;
+    source_fs->SnapShotFileSystem(source_snapshot);
+    auto it_group = FsView::gFsView.mGroupView.find(source_snapshot.mGroup);
+
+    if (it_group == FsView::gFsView.mGroupView.end()) {
+      continue;
+    }
+
+    FsGroup* group = it_group->second;
+    const eos::ns::FileMdProto& proto = job->mFileInfo->mProto;
+    GeoTreeEngine::PlacementRequest req;
+    req.mInode = (ino64_t) proto.id();
+    req.mBookingSize = proto.size();
+    req.mExistingReplicas.assign(proto.locations().begin(),
+                                 proto.locations().end());
+
+    if (!gOFS->mGeoTreeEngine->getInfosFromFsIds(req.mExistingReplicas,
+        &req.mExistingGeotags, 0, 0)) {
+      continue;
+    }
+
+    req.mExcludeFs = job->mExcludeDsts;
+    req.mExcludeGeoTags = req.mExistingGeotags;
+    group_jobs[group].push_back(job.get());
+    group_reqs[group].push_back(std::move(req));
+  }
+
+  for (auto& elem : group_reqs) {
+    auto& reqs = elem.second;
+    auto& grp_jobs = group_jobs[elem.first];
+    size_t num_placed = gOFS->mGeoTreeEngine->placeNewReplicasOneGroup
+                        (elem.first, reqs, GeoTreeEngine::draining);
+    eos_static_debug("msg=\"batch placement\" group=%s placed=%lu total=%lu",
+                     elem.first->mName.c_str(),
+                     num_placed, reqs.size());
+
+    for (size_t i = 0; i < reqs.size(); ++i) {
+      if (reqs[i].mNewReplicas.empty()) {
+        continue;
+      }
+
+      grp_jobs[i]->mFsIdTarget = reqs[i].mNewReplicas[0];
+      grp_jobs[i]->mExcludeDsts.push_back(reqs[i].mNewReplicas[0]);
+      grp_jobs[i]->mDstSelected = true;
+    }
+  }
+}
+
 //------------------------------------------------------------------------------
 // Drain 0-size file
 //------------------------------------------------------------------------------
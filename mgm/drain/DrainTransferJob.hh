@@ -28,6 +28,8 @@
 #include "common/FileSystem.hh"
 #include "proto/FileMd.pb.h"
 #include "XrdCl/XrdClCopyProcess.hh"
+#include <memory>
+#include <vector>
 
 EOSMGMNAMESPACE_BEGIN
 
@@ -202,6 +204,17 @@ public:
   std::list<std::string>
   GetInfo(const std::list<std::string>& tags) const;
 
+  //----------------------------------------------------------------------------
+  //! Fetch the file metadata and select the destination file system for a
+  //! batch of jobs before they are started. The placement is done with one
+  //! call to the scheduler per scheduling group. Jobs for which this fails
+  //! fall back to doing the lookup and the placement themselves.
+  //!
+  //! @param jobs jobs that are not yet started
+  //----------------------------------------------------------------------------
+  static void
+  SelectDstFs(const std::vector<std::shared_ptr<DrainTransferJob>>& jobs);
+
 #ifdef IN_TEST_HARNESS
 public:
 #else
@@ -286,6 +299,10 @@ private:
   std::vector<eos::common::FileSystem::fsid_t> mExcludeDsts; ///< Excluded dest.
   bool mRainReconstruct; ///< Mark rain reconstruction
   bool mDropSrc; ///< Mark if source replicas should be dropped
+  //! File metadata fetched when the job was prepared as part of a batch
+  std::unique_ptr<FileDrainInfo> mFileInfo;
+  //! Mark if mFsIdTarget was already selected as part of a batch
+  bool mDstSelected {false};
   DrainProgressHandler mProgressHandler; ///< TPC progress handler
 };
 
@@ -794,22 +794,15 @@ Fsck::ResetErrorMaps()
 void
 Fsck::AccountOfflineReplicas()
 {
-  // Grab all files which are damaged because filesystems are down
-  eos::common::RWMutexReadLock fs_rd_lock(FsView::gFsView.ViewMutex);
-
-  for (auto it = FsView::gFsView.mIdView.cbegin();
-       it != FsView::gFsView.mIdView.cend(); ++it) {
-    // protect against illegal 0 filesystem pointer
-    if (!it->second) {
-      eos_crit("msg=\"found illegal pointer in filesystem view\" fsid=%lu",
-               it->first);
-      continue;
-    }
-
-    eos::common::FileSystem::fsid_t fsid = it->first;
-    eos::common::ActiveStatus fsactive = it->second->GetActiveStatus();
-    eos::common::ConfigStatus fsconfig = it->second->GetConfigStatus();
-    eos::common::BootStatus fsstatus = it->second->GetStatus();
+  // Grab all files which are damaged because filesystems are down. Work on
+  // a snapshot of the view as the namespace traversal can take a long time.
+  auto snapshot = FsView::gFsView.GetSnapshot();
+
+  for (const auto& elem : snapshot->GetFileSystems()) {
+    eos::common::FileSystem::fsid_t fsid = elem.first;
+    eos::common::ActiveStatus fsactive = elem.second.mActiveStatus;
+    eos::common::ConfigStatus fsconfig = elem.second.mConfigStatus;
+    eos::common::BootStatus fsstatus = elem.second.mStatus;
 
     if ((fsstatus == eos::common::BootStatus::kBooted) &&
         (fsconfig >= eos::common::ConfigStatus::kDrain) &&
@@ -109,7 +109,6 @@ NsCmd::MutexSubcmd(const eos::console::NsProto_MutexProto& mutex,
     eos::common::RWMutex* quota_mtx = &Quota::pMapMutex;
     eos::common::RWMutex* ns_mtx = &gOFS->eosViewRWMutex;
     eos::common::RWMutex* fusex_client_mtx = &gOFS->zMQ->gFuseServer.Client();
-    eos::common::RWMutex* fusex_cap_mtx = &gOFS->zMQ->gFuseServer.Cap();
 
 
     if (no_option) {
@@ -193,7 +192,7 @@ NsCmd::MutexSubcmd(const eos::console::NsProto_MutexProto& mutex,
       ns_mtx->SetBlockedForMsInterval(mutex.blockedtime());
       quota_mtx->SetBlockedForMsInterval(mutex.blockedtime());
       fusex_client_mtx->SetBlockedForMsInterval(mutex.blockedtime());
-      fusex_cap_mtx->SetBlockedForMsInterval(mutex.blockedtime());
+      gOFS->zMQ->gFuseServer.Cap().SetBlockedForMsInterval(mutex.blockedtime());
       oss << "blockedtiming set to " << ns_mtx->BlockedForMsInterval() << " ms" <<
           std::endl;
     }
@@ -334,6 +333,8 @@ NsCmd::StatSubcmd(const eos::console::NsProto_StatProto& stat,
   CacheStatistics fileCacheStats = gOFS->eosFileService->getCacheStatistics();
   CacheStatistics containerCacheStats =
     gOFS->eosDirectoryService->getCacheStatistics();
+  CacheStatistics dentryCacheStats =
+    gOFS->eosDirectoryService->getDentryCacheStatistics();
   common::MutexLatencyWatcher::LatencySpikes viewLatency =
     gOFS->mViewMutexWatcher.getLatencySpikes();
 
@@ -353,6 +354,14 @@ NsCmd::StatSubcmd(const eos::console::NsProto_StatProto& stat,
         << std::endl
         << "uid=all gid=all ns.cache.containers.occupancy=" <<
         containerCacheStats.occupancy << std::endl
+        << "uid=all gid=all ns.cache.dentries.maxsize=" << dentryCacheStats.maxNum
+        << std::endl
+        << "uid=all gid=all ns.cache.dentries.occupancy=" <<
+        dentryCacheStats.occupancy << std::endl
+        << "uid=all gid=all ns.cache.dentries.hits=" << dentryCacheStats.hits
+        << std::endl
+        << "uid=all gid=all ns.cache.dentries.misses=" << dentryCacheStats.misses
+        << std::endl
         << "uid=all gid=all ns.total.files.changelog.size="
         << StringConversion::GetSizeString(clfsize, (unsigned long long) statf.st_size)
         << std::endl
@@ -548,6 +557,20 @@ NsCmd::StatSubcmd(const eos::console::NsProto_StatProto& stat,
           << line << std::endl;
     }
 
+    if (dentryCacheStats.enabled) {
+      uint64_t lookups = dentryCacheStats.hits + dentryCacheStats.misses;
+      char hit_rate[16];
+      snprintf(hit_rate, sizeof(hit_rate), "%.02f %%",
+               lookups ? 100.0 * dentryCacheStats.hits / lookups : 0.0);
+      oss << "ALL      Dentry cache max num             " << dentryCacheStats.maxNum
+          << std::endl
+          << "ALL      Dentry cache occupancy           " << dentryCacheStats.occupancy
+          << std::endl
+          << "ALL      Dentry cache hit rate            " << hit_rate
+          << std::endl
+          << line << std::endl;
+    }
+
     oss << "ALL      eosViewRWMutex peak-latency      " << viewLatency.last.count()
         << "ms (last) "
         << viewLatency.lastMinute.count() << "ms (1 min) " <<
@@ -1018,12 +1041,14 @@ NsCmd::CacheSubcmd(const eos::console::NsProto_CacheProto& cache,
   } else if (cache.op() == NsProto_CacheProto::DROP_DIR) {
     map_cfg[sMaxNumCacheDirs] = std::to_string(UINT64_MAX);
     map_cfg[sMaxSizeCacheDirs] = std::to_string(UINT64_MAX);
+    map_cfg[sMaxNumCacheDentries] = std::to_string(UINT64_MAX);
     gOFS->eosDirectoryService->configure(map_cfg);
   } else if (cache.op() == NsProto_CacheProto::DROP_ALL) {
     map_cfg[sMaxNumCacheFiles] = std::to_string(UINT64_MAX);
     map_cfg[sMaxSizeCacheFiles] = std::to_string(UINT64_MAX);
     map_cfg[sMaxNumCacheDirs] = std::to_string(UINT64_MAX);
     map_cfg[sMaxSizeCacheDirs] = std::to_string(UINT64_MAX);
+    map_cfg[sMaxNumCacheDentries] = std::to_string(UINT64_MAX);
     gOFS->eosFileService->configure(map_cfg);
     gOFS->eosDirectoryService->configure(map_cfg);
   } else if (cache.op() == NsProto_CacheProto::DROP_SINGLE_FILE) {
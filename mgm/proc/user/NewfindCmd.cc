@@ -36,7 +36,7 @@
 #include "namespace/ns_quarkdb/ContainerMD.hh"
 #include "namespace/ns_quarkdb/FileMD.hh"
 #include "namespace/ns_quarkdb/NamespaceGroup.hh"
-#include "namespace/ns_quarkdb/explorer/NamespaceExplorer.hh"
+#include "namespace/ns_quarkdb/explorer/ParallelNamespaceExplorer.hh"
 #include "namespace/utils/BalanceCalculator.hh"
 #include "namespace/utils/Checksum.hh"
 #include "namespace/utils/Stat.hh"
@@ -675,8 +675,9 @@ public:
       options.view = gOFS->eosView;
       options.depthLimit = depthlimit;
       options.ignoreFiles = ignore_files;
-      explorer.reset(new NamespaceExplorer(path, options, *qcl,
-                                           static_cast<QuarkNamespaceGroup*>(gOFS->namespaceGroup.get())->getExecutor()));
+      explorer.reset(new ParallelNamespaceExplorer(path, options,
+                                                   ParallelExplorationOptions(), *qcl,
+                                                   static_cast<QuarkNamespaceGroup*>(gOFS->namespaceGroup.get())->getExecutor()));
     }
   }
 
@@ -811,7 +812,7 @@ private:
   std::string path;
   uint32_t depthlimit;
   bool ignore_files;
-  std::unique_ptr<NamespaceExplorer> explorer;
+  std::unique_ptr<ParallelNamespaceExplorer> explorer;
   eos::common::VirtualIdentity vid;
 };
 
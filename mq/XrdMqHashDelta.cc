@@ -0,0 +1,390 @@
+//------------------------------------------------------------------------------
+//! @file XrdMqHashDelta.cc
+//! @brief Compact binary encoding of shared hash updates
+//------------------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2023 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+#include "mq/XrdMqHashDelta.hh"
+#include <cstring>
+#include <unordered_map>
+#include <zlib.h>
+
+namespace
+{
+//------------------------------------------------------------------------------
+//! Interned keys of the encoding version 1 - these are the keys published
+//! periodically by every FST file system. Entries must never be reordered or
+//! removed and adding new ones requires a new encoding version.
+//------------------------------------------------------------------------------
+const char* const sInternedKeys[] = {
+  "id", "uuid", "configstatus", "schedgroup", "headroom", "bootsenttime",
+  "stat.active", "stat.boot", "stat.bootdonetime", "stat.errc", "stat.errmsg",
+  "stat.geotag", "stat.publishtimestamp", "stat.ropen", "stat.wopen",
+  "stat.ropen.hotfiles", "stat.wopen.hotfiles", "stat.usedfiles",
+  "stat.balancer.running", "stat.http.port", "stat.nominal.filled",
+  "stat.disk.bw", "stat.disk.iops", "stat.disk.load", "stat.disk.readratemb",
+  "stat.disk.writeratemb", "stat.net.ethratemib", "stat.net.inratemib",
+  "stat.net.outratemib", "stat.statfs.bavail", "stat.statfs.bfree",
+  "stat.statfs.blocks", "stat.statfs.bsize", "stat.statfs.bused",
+  "stat.statfs.capacity", "stat.statfs.ffree", "stat.statfs.files",
+  "stat.statfs.filled", "stat.statfs.freebytes", "stat.statfs.fused",
+  "stat.statfs.namelen", "stat.statfs.type", "stat.statfs.usedbytes",
+  "stat.health", "stat.health.indicator", "stat.health.drives_total",
+  "stat.health.drives_failed", "stat.health.redundancy_factor",
+  "stat.fsck.mem_n", "stat.fsck.d_sync_n", "stat.fsck.m_sync_n",
+  "stat.fsck.d_mem_sz_diff", "stat.fsck.m_mem_sz_diff", "stat.fsck.d_cx_diff",
+  "stat.fsck.m_cx_diff", "stat.fsck.orphans_n", "stat.fsck.unreg_n",
+  "stat.fsck.rep_diff_n", "stat.fsck.rep_missing_n", "stat.fsck.blockxs_err",
+  "stat.sys.kernel", "stat.sys.vsize", "stat.sys.rss", "stat.sys.threads",
+  "stat.sys.eos.version", "stat.sys.xrootd.version", "stat.sys.keytab",
+  "stat.sys.uptime", "stat.sys.sockets", "stat.sys.eos.start",
+  "stat.fmd.commit.queued", "stat.fmd.commit.flushms",
+  "stat.fmd.commit.maxflushms"
+};
+
+constexpr size_t sNumInternedKeys = sizeof(sInternedKeys) /
+                                    sizeof(sInternedKeys[0]);
+
+//------------------------------------------------------------------------------
+//! Append a varint
+//------------------------------------------------------------------------------
+inline void
+PutVarint(std::string& out, uint64_t val)
+{
+  while (val >= 0x80) {
+    out.push_back((char)((val & 0x7f) | 0x80));
+    val >>= 7;
+  }
+
+  out.push_back((char) val);
+}
+
+//------------------------------------------------------------------------------
+//! Read a varint
+//!
+//! @return true if successful, false if the input is truncated or malformed
+//------------------------------------------------------------------------------
+inline bool
+GetVarint(const char*& ptr, const char* end, uint64_t& val)
+{
+  val = 0;
+
+  for (int shift = 0; (shift < 64) && (ptr < end); shift += 7) {
+    uint8_t byte = (uint8_t) * ptr++;
+    val |= (uint64_t)(byte & 0x7f) << shift;
+
+    if (!(byte & 0x80)) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+//------------------------------------------------------------------------------
+//! Base64 encoding without line breaks, table driven to avoid the BIO setup
+//! cost for these small messages
+//------------------------------------------------------------------------------
+const char sBase64Chars[] =
+  "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+void
+Base64Encode(const std::string& in, std::string& out)
+{
+  const uint8_t* ptr = (const uint8_t*) in.data();
+  size_t len = in.length();
+  out.clear();
+  out.reserve(((len + 2) / 3) * 4);
+
+  for (; len >= 3; len -= 3, ptr += 3) {
+    uint32_t val = (ptr[0] << 16) | (ptr[1] << 8) | ptr[2];
+    out.push_back(sBase64Chars[(val >> 18) & 0x3f]);
+    out.push_back(sBase64Chars[(val >> 12) & 0x3f]);
+    out.push_back(sBase64Chars[(val >> 6) & 0x3f]);
+    out.push_back(sBase64Chars[val & 0x3f]);
+  }
+
+  if (len) {
+    uint32_t val = (ptr[0] << 16) | ((len == 2) ? (ptr[1] << 8) : 0);
+    out.push_back(sBase64Chars[(val >> 18) & 0x3f]);
+    out.push_back(sBase64Chars[(val >> 12) & 0x3f]);
+    out.push_back((len == 2) ? sBase64Chars[(val >> 6) & 0x3f] : '=');
+    out.push_back('=');
+  }
+}
+
+bool
+Base64Decode(const char* in, std::string& out)
+{
+  static const std::vector<int8_t> sValues = []() {
+    std::vector<int8_t> values(256, -1);
+
+    for (int i = 0; i < 64; ++i) {
+      values[(uint8_t) sBase64Chars[i]] = i;
+    }
+
+    return values;
+  }();
+  size_t len = strlen(in);
+
+  if (len % 4) {
+    return false;
+  }
+
+  out.clear();
+  out.reserve((len / 4) * 3);
+
+  for (size_t i = 0; i < len; i += 4) {
+    uint32_t val = 0;
+    int npad = 0;
+
+    for (size_t j = i; j < i + 4; ++j) {
+      int8_t digit = sValues[(uint8_t) in[j]];
+
+      if (digit < 0) {
+        // Padding is only allowed in the last two positions
+        if ((in[j] != '=') || (i + 4 != len) || (j < i + 2)) {
+          return false;
+        }
+
+        digit = 0;
+        ++npad;
+      } else if (npad) {
+        return false;
+      }
+
+      val = (val << 6) | digit;
+    }
+
+    out.push_back((char)(val >> 16));
+
+    if (npad < 2) {
+      out.push_back((char)(val >> 8));
+    }
+
+    if (npad < 1) {
+      out.push_back((char) val);
+    }
+  }
+
+  return true;
+}
+
+//------------------------------------------------------------------------------
+//! Read a length prefixed string
+//------------------------------------------------------------------------------
+inline bool
+GetString(const char*& ptr, const char* end, std::string& out)
+{
+  uint64_t len;
+
+  if (!GetVarint(ptr, end, len) || (len > (uint64_t)(end - ptr))) {
+    return false;
+  }
+
+  out.assign(ptr, len);
+  ptr += len;
+  return true;
+}
+}
+
+//------------------------------------------------------------------------------
+// Constructor
+//------------------------------------------------------------------------------
+XrdMqHashDelta::XrdMqHashDelta():
+  mNumEntries(0)
+{}
+
+//------------------------------------------------------------------------------
+// Get the id of an interned key
+//------------------------------------------------------------------------------
+int
+XrdMqHashDelta::GetKeyId(const std::string& key)
+{
+  static const std::unordered_map<std::string, int> sKeyIds = []() {
+    std::unordered_map<std::string, int> ids;
+
+    for (size_t i = 0; i < sNumInternedKeys; ++i) {
+      ids.emplace(sInternedKeys[i], (int) i);
+    }
+
+    return ids;
+  }();
+  auto it = sKeyIds.find(key);
+  return ((it == sKeyIds.end()) ? -1 : it->second);
+}
+
+//------------------------------------------------------------------------------
+// Append an update
+//------------------------------------------------------------------------------
+void
+XrdMqHashDelta::Add(const std::string& key, const char* value,
+                    unsigned long long change_id, int subject)
+{
+  PutVarint(mEntries, subject + 1);
+  int key_id = GetKeyId(key);
+
+  if (key_id >= 0) {
+    PutVarint(mEntries, key_id + 1);
+  } else {
+    PutVarint(mEntries, 0);
+    PutVarint(mEntries, key.length());
+    mEntries += key;
+  }
+
+  size_t value_len = strlen(value);
+  PutVarint(mEntries, value_len);
+  mEntries.append(value, value_len);
+  PutVarint(mEntries, change_id);
+  ++mNumEntries;
+}
+
+//------------------------------------------------------------------------------
+// Produce the base64 encoded delta
+//------------------------------------------------------------------------------
+bool
+XrdMqHashDelta::Encode(std::string& out, bool compress) const
+{
+  std::string raw;
+  raw.push_back((char) sVersion);
+
+  if (compress && (mEntries.length() >= sMinCompressSize)) {
+    uLongf comp_len = compressBound(mEntries.length());
+    std::string comp(comp_len, '\0');
+
+    if (compress2((Bytef*) &comp[0], &comp_len, (const Bytef*) mEntries.data(),
+                  mEntries.length(), Z_BEST_SPEED) != Z_OK) {
+      return false;
+    }
+
+    raw.push_back((char) kCompressed);
+    PutVarint(raw, mEntries.length());
+    raw.append(comp.data(), comp_len);
+  } else {
+    raw.push_back((char) 0);
+    raw += mEntries;
+  }
+
+  Base64Encode(raw, out);
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// Decode a base64 encoded delta
+//------------------------------------------------------------------------------
+bool
+XrdMqHashDelta::Decode(const char* in, std::vector<Entry>& entries,
+                       std::string& error)
+{
+  std::string raw;
+
+  if (!in || !Base64Decode(in, raw) ||
+      (raw.length() < 2)) {
+    error = "delta: base64 decoding failed";
+    return false;
+  }
+
+  if ((uint8_t) raw[0] != sVersion) {
+    error = "delta: unsupported version ";
+    error += std::to_string((int)(uint8_t) raw[0]);
+    return false;
+  }
+
+  const char* ptr = raw.data() + 2;
+  const char* end = raw.data() + raw.length();
+  std::string inflated;
+
+  if ((uint8_t) raw[1] & kCompressed) {
+    uint64_t len;
+
+    if (!GetVarint(ptr, end, len) || (len > sMaxDeltaSize)) {
+      error = "delta: bad uncompressed length";
+      return false;
+    }
+
+    inflated.resize(len);
+    uLongf out_len = len;
+
+    if ((uncompress((Bytef*) &inflated[0], &out_len, (const Bytef*) ptr,
+                    end - ptr) != Z_OK) || (out_len != len)) {
+      error = "delta: decompression failed";
+      return false;
+    }
+
+    ptr = inflated.data();
+    end = inflated.data() + inflated.length();
+  }
+
+  // Reuse the entries of a previous decoding to avoid allocations
+  size_t num_entries = 0;
+
+  while (ptr < end) {
+    if (num_entries == entries.size()) {
+      entries.emplace_back();
+    }
+
+    Entry& entry = entries[num_entries];
+    entry.mKey.clear();
+    uint64_t subject, key_ref;
+
+    if (!GetVarint(ptr, end, subject) || !GetVarint(ptr, end, key_ref)) {
+      error = "delta: truncated entry";
+      return false;
+    }
+
+    if (subject) {
+      entry.mKey = "#";
+      entry.mKey += std::to_string(subject - 1);
+      entry.mKey += "#";
+    }
+
+    if (key_ref) {
+      if (key_ref > sNumInternedKeys) {
+        error = "delta: unknown key id";
+        return false;
+      }
+
+      entry.mKey += sInternedKeys[key_ref - 1];
+    } else {
+      std::string key;
+
+      if (!GetString(ptr, end, key)) {
+        error = "delta: truncated key";
+        return false;
+      }
+
+      entry.mKey += key;
+    }
+
+    uint64_t change_id;
+
+    if (!GetString(ptr, end, entry.mValue) ||
+        !GetVarint(ptr, end, change_id)) {
+      error = "delta: truncated value";
+      return false;
+    }
+
+    entry.mChangeId = change_id;
+    ++num_entries;
+  }
+
+  entries.resize(num_entries);
+  return true;
+}
@@ -0,0 +1,124 @@
+//------------------------------------------------------------------------------
+//! @file XrdMqHashDelta.hh
+//! @brief Compact binary encoding of shared hash updates
+//------------------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2023 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//! Env tag carrying the base64 encoded binary delta, used instead of the
+//! XRDMQSHAREDHASH_PAIRS tag
+#define XRDMQSHAREDHASH_BINPAIRS  "mqsh.bin"
+
+//------------------------------------------------------------------------------
+//! Class XrdMqHashDelta - binary alternative to the "|key~value%changeid"
+//! encoding of the shared hash updates. The delta is a version byte, a flags
+//! byte and a sequence of entries:
+//!
+//!   varint subject index + 1 (0 for non-multiplexed updates)
+//!   varint key id + 1 for interned keys or 0 followed by varint length and
+//!          the key characters
+//!   varint value length followed by the value characters
+//!   varint change id
+//!
+//! If the kCompressed flag is set the entries are deflated and preceded by
+//! their varint uncompressed length. The result is base64 encoded so that it
+//! can be carried in the env message body.
+//------------------------------------------------------------------------------
+class XrdMqHashDelta
+{
+public:
+  //! Current version of the encoding, the interned key table is part of it
+  static constexpr uint8_t sVersion = 1;
+  //! Flags of the encoded delta
+  static constexpr uint8_t kCompressed = 0x1;
+  //! Deltas smaller than this are not worth compressing
+  static constexpr size_t sMinCompressSize = 512;
+  //! Maximum accepted size of an uncompressed delta
+  static constexpr size_t sMaxDeltaSize = 64 * 1024 * 1024;
+
+  //! Decoded update, multiplexed keys have the "#<subject-index>#" prefix
+  //! same as in the env encoding
+  struct Entry {
+    std::string mKey;
+    std::string mValue;
+    unsigned long long mChangeId;
+  };
+
+  //----------------------------------------------------------------------------
+  //! Constructor
+  //----------------------------------------------------------------------------
+  XrdMqHashDelta();
+
+  //----------------------------------------------------------------------------
+  //! Append an update
+  //!
+  //! @param key hash key
+  //! @param value key value
+  //! @param change_id change id of the key
+  //! @param subject index of the subject for multiplexed updates, -1 otherwise
+  //----------------------------------------------------------------------------
+  void Add(const std::string& key, const char* value,
+           unsigned long long change_id, int subject = -1);
+
+  //----------------------------------------------------------------------------
+  //! Number of updates added so far
+  //----------------------------------------------------------------------------
+  inline size_t Size() const
+  {
+    return mNumEntries;
+  }
+
+  //----------------------------------------------------------------------------
+  //! Produce the base64 encoded delta
+  //!
+  //! @param out encoded delta
+  //! @param compress if true deflate the entries if large enough
+  //!
+  //! @return true if successful, otherwise false
+  //----------------------------------------------------------------------------
+  bool Encode(std::string& out, bool compress) const;
+
+  //----------------------------------------------------------------------------
+  //! Decode a base64 encoded delta
+  //!
+  //! @param in encoded delta
+  //! @param entries decoded updates in the order they were added
+  //! @param error error message if decoding fails
+  //!
+  //! @return true if successful, otherwise false
+  //----------------------------------------------------------------------------
+  static bool Decode(const char* in, std::vector<Entry>& entries,
+                     std::string& error);
+
+  //----------------------------------------------------------------------------
+  //! Get the id of an interned key
+  //!
+  //! @return key id or -1 if not interned
+  //----------------------------------------------------------------------------
+  static int GetKeyId(const std::string& key);
+
+private:
+  std::string mEntries; ///< Encoded entries
+  size_t mNumEntries; ///< Number of encoded entries
+};
@@ -104,14 +104,14 @@ XrdMqOfsFile::open(const char* queuename, XrdSfsFileOpenMode openMode,
                        "connect queue - the broker does not serve the requested queue");
   }
 
-  if (gMqFS->mQueueOut.count(mQueueName)) {
+  if (gMqFS->mQueueOut.Get(mQueueName)) {
     fprintf(stderr, "EBUSY: Queue %s is busy\n", mQueueName.c_str());
     // this is already open by 'someone'
     return gMqFS->Emsg(epname, error, EBUSY, "connect queue - already connected",
                        queuename);
   }
 
-  mMsgOut = new XrdMqMessageOut(queuename);
+  mMsgOut = std::make_shared<XrdMqMessageOut>(queuename);
   // check if advisory messages are requested
   XrdOucEnv queueenv((opaque) ? opaque : "");
   bool advisorystatus = false;
@@ -135,7 +135,7 @@ XrdMqOfsFile::open(const char* queuename, XrdSfsFileOpenMode openMode,
   mMsgOut->AdvisoryQuery  = advisoryquery;
   mMsgOut->AdvisoryFlushBackLog = advisoryflushbacklog;
   mMsgOut->BrokenByFlush = false;
-  gMqFS->mQueueOut.insert(std::make_pair(mQueueName, mMsgOut));
+  gMqFS->mQueueOut.Add(mQueueName, mMsgOut, advisorystatus, advisoryquery);
   eos_info("connected queue: %s", mQueueName.c_str());
   mIsOpen = true;
   return SFS_OK;
@@ -257,14 +257,12 @@ XrdMqOfsFile::close()
   {
     XrdSysMutexHelper scope_lock(gMqFS->mQueueOutMutex);
 
-    if ((gMqFS->mQueueOut.count(mQueueName)) &&
-        (mMsgOut = gMqFS->mQueueOut[mQueueName])) {
+    if ((mMsgOut = gMqFS->mQueueOut.Remove(mQueueName))) {
       // hmm this could create a dead lock
       //      mMsgOut->DeletionSem.Wait();
-      // Take away all pending messages
+      // Take away all pending messages, the object is deleted once the
+      // deliveries still holding a reference are done
       mMsgOut->RetrieveMessages();
-      gMqFS->mQueueOut.erase(mQueueName);
-      delete mMsgOut;
     }
 
     mMsgOut = nullptr;
@@ -605,15 +603,14 @@ XrdMqOfs::stat(const char* queuename, struct stat* buf, XrdOucErrInfo& error,
   }
 
   MAYREDIRECT;
-  XrdMqMessageOut* msg_out = nullptr;
+  std::shared_ptr<XrdMqMessageOut> msg_out;
   Statistics();
   ZTRACE(stat, "stat by buf: " << queuename);
   std::string squeue = queuename;
   {
     XrdSysMutexHelper scope_lock(mQueueOutMutex);
 
-    if ((!gMqFS->mQueueOut.count(squeue)) ||
-        (!(msg_out = gMqFS->mQueueOut[squeue]))) {
+    if (!(msg_out = gMqFS->mQueueOut.Get(squeue))) {
       return gMqFS->Emsg(epname, error, EINVAL, "check queue - no such queue");
     }
 
@@ -748,7 +745,7 @@ XrdMqOfs::Statistics()
       rc = write(fd, line, strlen(line));
       sprintf(line, "mq.queued                 %d\n", (int)Messages.size());
       rc = write(fd, line, strlen(line));
-      sprintf(line, "mq.nqueues                %d\n", (int)mQueueOut.size());
+      sprintf(line, "mq.nqueues                %d\n", (int)mQueueOut.Size());
       rc = write(fd, line, strlen(line));
       sprintf(line, "mq.backloghits            %lld\n", QueueBacklogHits);
       rc = write(fd, line, strlen(line));
@@ -794,7 +791,7 @@ XrdMqOfs::Statistics()
            DiscardedMonitoringMessages);
     ZTRACE(getstats, "No        Messages            : " << NoMessages);
     ZTRACE(getstats, "Queue     Messages            : " << Messages.size());
-    ZTRACE(getstats, "#Queues                       : " << mQueueOut.size());
+    ZTRACE(getstats, "#Queues                       : " << mQueueOut.Size());
     ZTRACE(getstats, "Deferred  Messages (backlog)  : " << BacklogDeferred);
     ZTRACE(getstats, "Backlog   Messages Hits       : " << QueueBacklogHits);
     char rates[4096];
@@ -1289,73 +1286,25 @@ bool
 XrdMqOfs::Deliver(XrdMqOfsMatches& Matches)
 {
   EPNAME("Deliver");
-  XrdSysMutexHelper scope_lock(mQueueOutMutex);
   const char* tident = Matches.mTident;
-  std::string sendername = Matches.sendername.c_str();
+  const std::string sendername = Matches.sendername.c_str();
   // Store all the queues where we need to deliver this message
-  std::vector<XrdMqMessageOut*> matched_out_queues;
-  Matches.message->procmutex.Lock();
-
-  // If we have a status message we have to do a complete loop
-  if (((Matches.messagetype) == XrdMqMessageHeader::kStatusMessage) ||
-      ((Matches.messagetype) == XrdMqMessageHeader::kQueryMessage)) {
-    for (auto it = mQueueOut.begin(); it != mQueueOut.end(); ++it) {
-      XrdMqMessageOut* msg_out = it->second;
-
-      // If this is be a loop back message we continue
-      if (sendername == it->first) {
-        // avoid feedback to the same queue
-        continue;
-      }
-
-      // If this queue does not take advisory status messages we continue
-      if ((Matches.messagetype == XrdMqMessageHeader::kStatusMessage) &&
-          (!msg_out->AdvisoryStatus)) {
-        continue;
-      }
-
-      // if this queue does not take advisory query messages we continue
-      if ((Matches.messagetype == XrdMqMessageHeader::kQueryMessage)  &&
-          (!msg_out->AdvisoryQuery)) {
-        continue;
-      } else {
-        matched_out_queues.push_back(msg_out);
-      }
-    }
-  } else {
-    // If we have a wildcard match we have to do a complete loop
-    if ((Matches.queuename.find("*") != STR_NPOS)) {
-      for (auto it = mQueueOut.begin(); it != mQueueOut.end(); ++it) {
-        XrdMqMessageOut* msg_out = it->second;
-
-        // fprintf(stderr,"current queue name: %s <=> sender :%s\n",
-        //        it->first.c_str(), sendername.c_str());
-        // If this would be a loop back message we continue
-        if (sendername == it->first) {
-          // avoid feedback to the same queue
-          continue;
-        }
-
-        XrdOucString Key = it->first.c_str();
-        XrdOucString nowildcard = Matches.queuename;
-        nowildcard.replace("*", "");
-        int nmatch = Key.matches(Matches.queuename.c_str(), '*');
+  std::vector<std::shared_ptr<XrdMqMessageOut>> matched_out_queues;
+  XrdMqQueueIndex<XrdMqMessageOut>::EntryListPtr candidates;
+  {
+    // Only the lookup is done under the global lock, the fan-out works on
+    // the snapshot of the matching queues
+    XrdSysMutexHelper scope_lock(mQueueOutMutex);
 
-        if (nmatch == nowildcard.length()) {
-          // this is a match
-          ZTRACE(fsctl, "Adding Wildcard matched Message to Queuename: "
-                 << msg_out->QueueName.c_str());
-          matched_out_queues.push_back(msg_out);
-        }
-      }
+    if ((Matches.messagetype) == XrdMqMessageHeader::kStatusMessage) {
+      candidates = mQueueOut.GetAdvisoryStatus();
+    } else if ((Matches.messagetype) == XrdMqMessageHeader::kQueryMessage) {
+      candidates = mQueueOut.GetAdvisoryQuery();
+    } else if ((Matches.queuename.find("*") != STR_NPOS)) {
+      candidates = mQueueOut.Match(Matches.queuename.c_str());
     } else {
       // We have just to find one named queue
-      std::string queuename = Matches.queuename.c_str();
-      XrdMqMessageOut* msg_out = 0;
-
-      if (mQueueOut.count(queuename)) {
-        msg_out = mQueueOut[queuename];
-      }
+      auto msg_out = mQueueOut.Get(Matches.queuename.c_str());
 
       if (msg_out) {
         ZTRACE(fsctl, "Adding full matched Message to Queuename: " <<
@@ -1365,17 +1314,33 @@ XrdMqOfs::Deliver(XrdMqOfsMatches& Matches)
     }
   }
 
+  if (candidates) {
+    matched_out_queues.reserve(candidates->size());
+
+    for (const auto& entry : *candidates) {
+      // If this would be a loop back message we continue
+      if (sendername == entry.mName) {
+        continue;
+      }
+
+      matched_out_queues.push_back(entry.mQueue);
+    }
+  }
+
+  Matches.message->procmutex.Lock();
+
   // This is a match
   if (matched_out_queues.size()) {
     Matches.backlog = false;
     Matches.backlogrejected = false;
 
-    // Lock all matched queues at once
-    for (auto msg_out : matched_out_queues) {
+    // Lock all matched queues at once - the lists of the index are sorted by
+    // queue name so concurrent deliveries lock them in the same order
+    for (const auto& msg_out : matched_out_queues) {
       msg_out->Lock();
     }
 
-    for (auto msg_out : matched_out_queues) {
+    for (const auto& msg_out : matched_out_queues) {
       // check for backlog on this queue and set a warning flag
       if (msg_out->mMsgQueue.size() > mMaxQueueBacklog) {
         // Only set the backlog flag if the queue has not set the advisory
@@ -1453,7 +1418,7 @@ XrdMqOfs::Deliver(XrdMqOfsMatches& Matches)
     }
 
     // Unlock all matched queues at once
-    for (auto msg_out : matched_out_queues) {
+    for (const auto& msg_out : matched_out_queues) {
       msg_out->UnLock();
     }
   }
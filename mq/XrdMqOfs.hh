@@ -32,6 +32,7 @@
 #include "XrdSys/XrdSysPthread.hh"
 #include "XrdSys/XrdSysSemWait.hh"
 #include "common/Logging.hh"
+#include "mq/XrdMqQueueIndex.hh"
 #include "namespace/ns_quarkdb/QdbContactDetails.hh"
 #include <sys/types.h>
 #include <unistd.h>
@@ -282,7 +283,7 @@ public:
   }
 
 private:
-  XrdMqMessageOut* mMsgOut;
+  std::shared_ptr<XrdMqMessageOut> mMsgOut;
   std::string mQueueName;
   bool mIsOpen;
   const char* tident;
@@ -406,8 +407,8 @@ public:
 private:
   static XrdSysError* eDest;
   static std::string sLeaseKey;
-  //! Hash of all output's connected
-  std::map<std::string, XrdMqMessageOut*> mQueueOut;
+  //! Index of all output's connected
+  XrdMqQueueIndex<XrdMqMessageOut> mQueueOut;
   XrdSysMutex mQueueOutMutex;  ///< Mutex protecting the output hash
   std::string mQdbCluster; ///< Quarkdb cluster info host1:port1 host2:port2 ..
   std::string mQdbPassword; ///< Quarkdb cluster password
@@ -0,0 +1,274 @@
+//------------------------------------------------------------------------------
+//! @file XrdMqQueueIndex.hh
+//! @brief Index of the output queues used to match the message receivers
+//------------------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2023 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+#pragma once
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//------------------------------------------------------------------------------
+//! Class XrdMqQueueIndex - output queues indexed by name. Besides the lookup
+//! by name it keeps the lists of queues subscribed to advisory status and
+//! query messages and caches the list of queues matching a wildcard queue
+//! name. The lists are shared, immutable snapshots which can be used after
+//! releasing the lock protecting the index. Any change of the registered
+//! queues invalidates the lists.
+//!
+//! @note the index is not thread-safe, it must be protected by the caller
+//------------------------------------------------------------------------------
+template<typename T>
+class XrdMqQueueIndex
+{
+public:
+  using QueuePtr = std::shared_ptr<T>;
+
+  //! Queue matching a lookup
+  struct Entry {
+    std::string mName;
+    QueuePtr mQueue;
+  };
+
+  using EntryList = std::vector<Entry>;
+  using EntryListPtr = std::shared_ptr<const EntryList>;
+
+  //! Maximum number of cached wildcard lookups
+  static constexpr size_t sMaxCachedMatches = 1024;
+
+  //----------------------------------------------------------------------------
+  //! Check if a name matches a pattern where '*' stands for any sequence of
+  //! characters, same as XrdOucString::matches
+  //----------------------------------------------------------------------------
+  static bool WildcardMatch(const char* pattern, const char* name)
+  {
+    const char* wild = strchr(pattern, '*');
+
+    if (!wild) {
+      return (strcmp(pattern, name) == 0);
+    }
+
+    // Literal head before the first and tail after the last wildcard
+    size_t head_len = wild - pattern;
+    const char* tail = strrchr(pattern, '*') + 1;
+    size_t tail_len = strlen(tail);
+    size_t name_len = strlen(name);
+
+    if ((head_len + tail_len > name_len) ||
+        strncmp(pattern, name, head_len) ||
+        strcmp(tail, name + name_len - tail_len)) {
+      return false;
+    }
+
+    // The middle segments must appear in order in the rest of the name
+    const char* pos = name + head_len;
+    const char* end = name + name_len - tail_len;
+    const char* seg = wild + 1;
+
+    while (seg < tail) {
+      const char* seg_end = strchr(seg, '*');
+      size_t seg_len = seg_end - seg;
+
+      if (seg_len) {
+        const char* found = nullptr;
+
+        for (const char* p = pos; p + seg_len <= end; ++p) {
+          if (!strncmp(p, seg, seg_len)) {
+            found = p;
+            break;
+          }
+        }
+
+        if (!found) {
+          return false;
+        }
+
+        pos = found + seg_len;
+      }
+
+      seg = seg_end + 1;
+    }
+
+    return true;
+  }
+
+  //----------------------------------------------------------------------------
+  //! Add a queue
+  //!
+  //! @param name queue name
+  //! @param queue queue object
+  //! @param advisory_status queue subscribes to advisory status messages
+  //! @param advisory_query queue subscribes to advisory query messages
+  //!
+  //! @return true if added, false if a queue with the same name exists
+  //----------------------------------------------------------------------------
+  bool Add(const std::string& name, const QueuePtr& queue,
+           bool advisory_status, bool advisory_query)
+  {
+    if (!mQueues.emplace(name, Item {queue, advisory_status,
+                                     advisory_query}).second) {
+      return false;
+    }
+
+    Invalidate();
+    return true;
+  }
+
+  //----------------------------------------------------------------------------
+  //! Remove a queue
+  //!
+  //! @param name queue name
+  //!
+  //! @return removed queue or nullptr if not found
+  //----------------------------------------------------------------------------
+  QueuePtr Remove(const std::string& name)
+  {
+    auto it = mQueues.find(name);
+
+    if (it == mQueues.end()) {
+      return nullptr;
+    }
+
+    QueuePtr queue = it->second.mQueue;
+    mQueues.erase(it);
+    Invalidate();
+    return queue;
+  }
+
+  //----------------------------------------------------------------------------
+  //! Get a queue by name
+  //!
+  //! @return queue or nullptr if not found
+  //----------------------------------------------------------------------------
+  QueuePtr Get(const std::string& name) const
+  {
+    auto it = mQueues.find(name);
+    return (it == mQueues.end()) ? nullptr : it->second.mQueue;
+  }
+
+  //----------------------------------------------------------------------------
+  //! Number of queues
+  //----------------------------------------------------------------------------
+  size_t Size() const
+  {
+    return mQueues.size();
+  }
+
+  //----------------------------------------------------------------------------
+  //! Get the queues subscribed to advisory status or query messages
+  //----------------------------------------------------------------------------
+  EntryListPtr GetAdvisoryStatus()
+  {
+    if (!mAdvisoryStatus) {
+      mAdvisoryStatus = BuildList(&Item::mAdvisoryStatus);
+    }
+
+    return mAdvisoryStatus;
+  }
+
+  EntryListPtr GetAdvisoryQuery()
+  {
+    if (!mAdvisoryQuery) {
+      mAdvisoryQuery = BuildList(&Item::mAdvisoryQuery);
+    }
+
+    return mAdvisoryQuery;
+  }
+
+  //----------------------------------------------------------------------------
+  //! Get the queues matching a wildcard queue name. Only the queues sharing
+  //! the literal prefix of the pattern are checked and the result is cached
+  //! until the registered queues change.
+  //!
+  //! @param pattern queue name containing '*' wildcards
+  //!
+  //! @return list of matching queues
+  //----------------------------------------------------------------------------
+  EntryListPtr Match(const std::string& pattern)
+  {
+    auto it_cache = mMatches.find(pattern);
+
+    if (it_cache != mMatches.end()) {
+      return it_cache->second;
+    }
+
+    auto matches = std::make_shared<EntryList>();
+    std::string prefix = pattern.substr(0, pattern.find('*'));
+
+    for (auto it = mQueues.lower_bound(prefix);
+         (it != mQueues.end()) && !it->first.compare(0, prefix.length(), prefix);
+         ++it) {
+      if (WildcardMatch(pattern.c_str(), it->first.c_str())) {
+        matches->push_back(Entry {it->first, it->second.mQueue});
+      }
+    }
+
+    if (mMatches.size() >= sMaxCachedMatches) {
+      mMatches.clear();
+    }
+
+    mMatches.emplace(pattern, matches);
+    return matches;
+  }
+
+private:
+  //! Registered queue
+  struct Item {
+    QueuePtr mQueue;
+    bool mAdvisoryStatus;
+    bool mAdvisoryQuery;
+  };
+
+  std::map<std::string, Item> mQueues; ///< Queues sorted by name
+  EntryListPtr mAdvisoryStatus; ///< Advisory status subscribers, null if stale
+  EntryListPtr mAdvisoryQuery; ///< Advisory query subscribers, null if stale
+  //! Cached wildcard lookups
+  std::unordered_map<std::string, EntryListPtr> mMatches;
+
+  //----------------------------------------------------------------------------
+  //! Drop all the lists derived from the registered queues
+  //----------------------------------------------------------------------------
+  void Invalidate()
+  {
+    mAdvisoryStatus.reset();
+    mAdvisoryQuery.reset();
+    mMatches.clear();
+  }
+
+  //----------------------------------------------------------------------------
+  //! Build the list of queues having the given subscription flag set
+  //----------------------------------------------------------------------------
+  EntryListPtr BuildList(bool Item::* flag) const
+  {
+    auto list = std::make_shared<EntryList>();
+
+    for (const auto& elem : mQueues) {
+      if (elem.second.*flag) {
+        list->push_back(Entry {elem.first, elem.second.mQueue});
+      }
+    }
+
+    return list;
+  }
+};
@@ -23,6 +23,7 @@
 
 #include "mq/XrdMqSharedObject.hh"
 #include "mq/XrdMqMessaging.hh"
+#include "mq/XrdMqHashDelta.hh"
 #include "common/Logging.hh"
 #include "common/StringConversion.hh"
 #include "common/ParseUtils.hh"
@@ -537,12 +538,40 @@ XrdMqSharedHash::BroadCastEnvString(const char* receiver)
 void
 XrdMqSharedHash::AddTransactionsToEnvString(XrdOucString& out, bool clear_after)
 {
+  RWMutexReadLock rd_lock(*mStoreMutex);
+
+  if (mSOM->mBinaryDelta) {
+    XrdMqHashDelta delta;
+    std::string encoded;
+
+    for (auto it = mTransactions.begin(); it != mTransactions.end(); ++it) {
+      auto it_store = mStore.find(*it);
+
+      if (it_store != mStore.end()) {
+        delta.Add(*it, it_store->second.GetValue(),
+                  it_store->second.GetChangeId());
+      }
+    }
+
+    if (delta.Encode(encoded, mSOM->mCompressDelta)) {
+      out += "&";
+      out += XRDMQSHAREDHASH_BINPAIRS;
+      out += "=";
+      out += encoded.c_str();
+
+      if (clear_after) {
+        mTransactions.clear();
+      }
+
+      return;
+    }
+  }
+
   // Encode transactions as
   // "mysh.pairs=|<key1>~<value1>%<changeid1>|<key2>~<value2>%<changeid2 ..."
   out += "&";
   out += XRDMQSHAREDHASH_PAIRS;
   out += "=";
-  RWMutexReadLock rd_lock(*mStoreMutex);
 
   for (auto it = mTransactions.begin(); it != mTransactions.end(); ++it) {
     if ((mStore.count(it->c_str()))) {
@@ -2627,6 +2656,48 @@ XrdMqSharedObjectManager::FileDumper(ThreadAssistant& assistant) noexcept
 }
 
 
+//------------------------------------------------------------------------------
+// Split the env encoded pairs "|<key1>~<value1>%<changeid1>|<key2>~..."
+//------------------------------------------------------------------------------
+static bool
+ParseEnvPairs(const std::string& val,
+              std::vector<XrdMqHashDelta::Entry>& pairs)
+{
+  std::vector<int> keystart;
+  std::vector<int> valuestart;
+  std::vector<int> cidstart;
+
+  for (unsigned int i = 0; i < val.length(); i++) {
+    if (val.c_str()[i] == '|') {
+      keystart.push_back(i);
+    }
+
+    if (val.c_str()[i] == '~') {
+      valuestart.push_back(i);
+    }
+
+    if (val.c_str()[i] == '%') {
+      cidstart.push_back(i);
+    }
+  }
+
+  if ((keystart.size() != valuestart.size()) ||
+      (keystart.size() != cidstart.size())) {
+    return false;
+  }
+
+  pairs.resize(keystart.size());
+
+  for (unsigned int i = 0; i < keystart.size(); i++) {
+    XrdMqHashDelta::Entry& pair = pairs[i];
+    pair.mKey.assign(val, keystart[i] + 1, valuestart[i] - 1 - (keystart[i]));
+    pair.mValue.assign(val, valuestart[i] + 1, cidstart[i] - 1 - (valuestart[i]));
+    pair.mChangeId = strtoull(val.c_str() + cidstart[i] + 1, 0, 10);
+  }
+
+  return true;
+}
+
 //------------------------------------------------------------------------------
 //
 //------------------------------------------------------------------------------
@@ -2829,50 +2900,38 @@ XrdMqSharedObjectManager::ParseEnvMessage(XrdMqMessage* message,
       // from here on we have a read lock on 'sh'
 
       if ((ftag == XRDMQSHAREDHASH_UPDATE) || (ftag == XRDMQSHAREDHASH_BCREPLY)) {
-        std::string val = (env.Get(XRDMQSHAREDHASH_PAIRS) ? env.Get(
-                             XRDMQSHAREDHASH_PAIRS) : "");
+        std::vector<XrdMqHashDelta::Entry> pairs;
 
-        if (val.length() == 0) {
-          error = "no pairs in message body";
-          return false;
-        }
+        if (env.Get(XRDMQSHAREDHASH_BINPAIRS)) {
+          std::string delta_error;
 
-        if ((ftag == XRDMQSHAREDHASH_BCREPLY) && sh) {
-          // Don't broadcast this one ... is a broadcast reply
-          sh->Clear(false);
-        }
-
-        std::string key;
-        std::string value;
-        std::string cid;
-        std::vector<int> keystart;
-        std::vector<int> valuestart;
-        std::vector<int> cidstart;
-
-        for (unsigned int i = 0; i < val.length(); i++) {
-          if (val.c_str()[i] == '|') {
-            keystart.push_back(i);
-          }
-
-          if (val.c_str()[i] == '~') {
-            valuestart.push_back(i);
+          if (!XrdMqHashDelta::Decode(env.Get(XRDMQSHAREDHASH_BINPAIRS), pairs,
+                                      delta_error)) {
+            error = "update: ";
+            error += delta_error.c_str();
+            return false;
           }
+        } else {
+          std::string val = (env.Get(XRDMQSHAREDHASH_PAIRS) ? env.Get(
+                               XRDMQSHAREDHASH_PAIRS) : "");
 
-          if (val.c_str()[i] == '%') {
-            cidstart.push_back(i);
+          if (val.length() && !ParseEnvPairs(val, pairs)) {
+            error = "update: parsing error in pairs tag";
+            return false;
           }
         }
 
-        if (keystart.size() != valuestart.size()) {
-          error = "update: parsing error in pairs tag";
+        if (pairs.empty()) {
+          error = "no pairs in message body";
           return false;
         }
 
-        if (keystart.size() != cidstart.size()) {
-          error = "update: parsing error in pairs tag";
-          return false;
+        if ((ftag == XRDMQSHAREDHASH_BCREPLY) && sh) {
+          // Don't broadcast this one ... is a broadcast reply
+          sh->Clear(false);
         }
 
+        std::string key;
         int parseindex = 0;
 
         for (size_t s = 0; s < subjectlist.size(); s++) {
@@ -2887,15 +2946,8 @@ XrdMqSharedObjectManager::ParseEnvMessage(XrdMqMessage* message,
 
           std::string sstr;
 
-          for (unsigned int i = parseindex; i < keystart.size(); i++) {
-            key.assign(val, keystart[i] + 1, valuestart[i] - 1 - (keystart[i]));
-            value.assign(val, valuestart[i] + 1, cidstart[i] - 1 - (valuestart[i]));
-
-            if (i == (keystart.size() - 1)) {
-              cid.assign(val, cidstart[i] + 1, val.length() - cidstart[i] - 1);
-            } else {
-              cid.assign(val, cidstart[i] + 1, keystart[i + 1] - 1 - (cidstart[i]));
-            }
+          for (unsigned int i = parseindex; i < pairs.size(); i++) {
+            key = pairs[i].mKey;
 
             // eos_info("got bcreply subject=%s, key=%s, val=%s obj_ptr=%p",
             //          subject.c_str(), key.c_str(), value.c_str(), (void *)sh);
@@ -2929,7 +2981,7 @@ XrdMqSharedObjectManager::ParseEnvMessage(XrdMqMessage* message,
             }
 
             // Set entry without broadcast
-            sh->Set(key.c_str(), value.c_str(), false);
+            sh->Set(key.c_str(), pairs[i].mValue.c_str(), false);
           }
         }
 
@@ -3088,6 +3140,39 @@ XrdMqSharedObjectManager::MakeMuxUpdateEnvHeader(XrdOucString& out)
 void
 XrdMqSharedObjectManager::AddMuxTransactionEnvString(XrdOucString& out)
 {
+  if (mBinaryDelta) {
+    XrdMqHashDelta delta;
+    std::string encoded;
+    int index = 0;
+
+    for (auto it_subj = MuxTransactions.begin(); it_subj != MuxTransactions.end();
+         ++it_subj, ++index) {
+      XrdMqSharedHash* hash = GetObject(it_subj->first.c_str(),
+                                        MuxTransactionType.c_str());
+
+      if (hash) {
+        RWMutexReadLock lock(*(hash->mStoreMutex));
+
+        for (auto it = it_subj->second.begin(); it != it_subj->second.end(); ++it) {
+          auto it_store = hash->mStore.find(*it);
+
+          if (it_store != hash->mStore.end()) {
+            delta.Add(*it, it_store->second.GetValue(),
+                      it_store->second.GetChangeId(), index);
+          }
+        }
+      }
+    }
+
+    if (delta.Encode(encoded, mCompressDelta)) {
+      out += "&";
+      out += XRDMQSHAREDHASH_BINPAIRS;
+      out += "=";
+      out += encoded.c_str();
+      return;
+    }
+  }
+
   // Encoding has the following format
   // "mysh.pairs=|<key1>~<value1>%<changeid1>|<key2>~<value2>%<changeid2 ...."
   out += "&";
@@ -642,6 +642,21 @@ public:
     return mBroadcast;
   }
 
+  //----------------------------------------------------------------------------
+  //! Switch the hash updates sent through this manager to the binary delta
+  //! encoding. Only enable it if all the receivers understand the encoding,
+  //! incoming updates are accepted in both formats.
+  //!
+  //! @param enable if true send binary deltas, otherwise env pairs - default
+  //!        disabled
+  //! @param compress if true deflate large deltas
+  //----------------------------------------------------------------------------
+  inline void EnableBinaryDelta(bool enable, bool compress = false)
+  {
+    mCompressDelta = compress;
+    mBinaryDelta = enable;
+  }
+
   //----------------------------------------------------------------------------
   //!
   //----------------------------------------------------------------------------
@@ -811,6 +826,8 @@ protected:
 
 private:
   std::atomic<bool> mBroadcast {true}; ///< Broadcast mode, default on
+  std::atomic<bool> mBinaryDelta {false}; ///< Send updates as binary deltas
+  std::atomic<bool> mCompressDelta {false}; ///< Compress the binary deltas
   AssistedThread mDumperTid; ///< Dumper thread tid
   ///! Map of subjects to shared hash objects
   std::map<std::string, XrdMqSharedHash*> mHashSubjects;
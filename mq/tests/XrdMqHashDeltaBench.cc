@@ -0,0 +1,218 @@
+//------------------------------------------------------------------------------
+//! @file XrdMqHashDeltaBench.cc
+//! @brief Compare the env and binary delta encoding of shared hash updates
+//------------------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2023 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+//------------------------------------------------------------------------------
+// Every update mimics the statistics an FST publishes for one file system.
+// The env mode builds the "|key~value%changeid" pairs and splits them again
+// after the XrdOucEnv parsing, the delta modes use XrdMqHashDelta with and
+// without compression.
+//
+// Usage: eos-mq-delta-bench [nupdates] [nfilesystems]
+//------------------------------------------------------------------------------
+#include "mq/XrdMqHashDelta.hh"
+#include "mq/XrdMqSharedObject.hh"
+#include "XrdOuc/XrdOucEnv.hh"
+#include <chrono>
+#include <iostream>
+#include <map>
+
+//------------------------------------------------------------------------------
+// Build the statistics of a file system
+//------------------------------------------------------------------------------
+static std::map<std::string, std::string>
+MakeStats(int fs)
+{
+  std::map<std::string, std::string> stats;
+  const char* keys[] = {
+    "stat.statfs.bavail", "stat.statfs.bfree", "stat.statfs.blocks",
+    "stat.statfs.bsize", "stat.statfs.capacity", "stat.statfs.ffree",
+    "stat.statfs.files", "stat.statfs.filled", "stat.statfs.freebytes",
+    "stat.statfs.fused", "stat.statfs.usedbytes", "stat.disk.load",
+    "stat.disk.readratemb", "stat.disk.writeratemb", "stat.disk.iops",
+    "stat.disk.bw", "stat.ropen", "stat.wopen", "stat.usedfiles",
+    "stat.publishtimestamp", "stat.balancer.running", "stat.health",
+    "stat.health.indicator", "stat.boot", "stat.geotag", "stat.http.port",
+    "stat.fsck.mem_n", "stat.fsck.orphans_n", "stat.fsck.d_sync_n",
+    "stat.fsck.m_sync_n", "stat.ropen.hotfiles", "stat.wopen.hotfiles"
+  };
+  long long val = 1000003ll * (fs + 1);
+
+  for (auto key : keys) {
+    val = (val * 7919) % 1000000007ll;
+    stats[key] = std::to_string(val);
+  }
+
+  stats["stat.geotag"] = "site::room::rack";
+  stats["stat.boot"] = "booted";
+  return stats;
+}
+
+//------------------------------------------------------------------------------
+// Env encoding of the updates as done by AddTransactionsToEnvString
+//------------------------------------------------------------------------------
+static std::string
+EncodeEnv(const std::map<std::string, std::string>& stats)
+{
+  std::string out = XRDMQSHAREDHASH_UPDATE;
+  out += "&" XRDMQSHAREDHASH_SUBJECT "=/eos/host:1095/fst/data01&"
+         XRDMQSHAREDHASH_TYPE "=hash&" XRDMQSHAREDHASH_PAIRS "=";
+  unsigned long long cid = 0;
+
+  for (const auto& elem : stats) {
+    out += "|";
+    out += elem.first;
+    out += "~";
+    out += elem.second;
+    out += "%";
+    out += std::to_string(++cid);
+  }
+
+  return out;
+}
+
+//------------------------------------------------------------------------------
+// Env decoding of the updates as done by ParseEnvMessage
+//------------------------------------------------------------------------------
+static size_t
+DecodeEnv(const std::string& msg, std::vector<XrdMqHashDelta::Entry>& entries)
+{
+  XrdOucEnv env(msg.c_str());
+  std::string val = env.Get(XRDMQSHAREDHASH_PAIRS);
+  std::vector<int> keystart, valuestart, cidstart;
+
+  for (unsigned int i = 0; i < val.length(); i++) {
+    if (val[i] == '|') {
+      keystart.push_back(i);
+    } else if (val[i] == '~') {
+      valuestart.push_back(i);
+    } else if (val[i] == '%') {
+      cidstart.push_back(i);
+    }
+  }
+
+  entries.resize(keystart.size());
+
+  for (unsigned int i = 0; i < keystart.size(); i++) {
+    entries[i].mKey.assign(val, keystart[i] + 1, valuestart[i] - 1 - keystart[i]);
+    entries[i].mValue.assign(val, valuestart[i] + 1,
+                             cidstart[i] - 1 - valuestart[i]);
+    entries[i].mChangeId = strtoull(val.c_str() + cidstart[i] + 1, 0, 10);
+  }
+
+  return entries.size();
+}
+
+//------------------------------------------------------------------------------
+// Binary encoding of the updates
+//------------------------------------------------------------------------------
+static std::string
+EncodeDelta(const std::map<std::string, std::string>& stats, bool compress)
+{
+  XrdMqHashDelta delta;
+  unsigned long long cid = 0;
+
+  for (const auto& elem : stats) {
+    delta.Add(elem.first, elem.second.c_str(), ++cid);
+  }
+
+  std::string encoded;
+  delta.Encode(encoded, compress);
+  std::string out = XRDMQSHAREDHASH_UPDATE;
+  out += "&" XRDMQSHAREDHASH_SUBJECT "=/eos/host:1095/fst/data01&"
+         XRDMQSHAREDHASH_TYPE "=hash&" XRDMQSHAREDHASH_BINPAIRS "=";
+  out += encoded;
+  return out;
+}
+
+//------------------------------------------------------------------------------
+// Binary decoding of the updates
+//------------------------------------------------------------------------------
+static size_t
+DecodeDelta(const std::string& msg, std::vector<XrdMqHashDelta::Entry>& entries)
+{
+  XrdOucEnv env(msg.c_str());
+  std::string error;
+
+  if (!XrdMqHashDelta::Decode(env.Get(XRDMQSHAREDHASH_BINPAIRS), entries,
+                              error)) {
+    std::cerr << "error: " << error << std::endl;
+    exit(1);
+  }
+
+  return entries.size();
+}
+
+int main(int argc, char* argv[])
+{
+  size_t nupdates = (argc > 1) ? strtoul(argv[1], 0, 10) : 100000;
+  size_t nfs = (argc > 2) ? strtoul(argv[2], 0, 10) : 64;
+
+  if (!nupdates || !nfs) {
+    std::cerr << "usage: " << argv[0] << " [nupdates] [nfilesystems]"
+              << std::endl;
+    return 1;
+  }
+
+  std::vector<std::map<std::string, std::string>> stats;
+
+  for (size_t i = 0; i < nfs; ++i) {
+    stats.push_back(MakeStats(i));
+  }
+
+  const char* modes[] = {"env  ", "delta", "zlib "};
+
+  for (int mode = 0; mode < 3; ++mode) {
+    std::vector<std::string> msgs;
+    size_t bytes = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < nupdates; ++i) {
+      const auto& fs_stats = stats[i % nfs];
+      msgs.push_back((mode == 0) ? EncodeEnv(fs_stats) :
+                     EncodeDelta(fs_stats, mode == 2));
+      bytes += msgs.back().length();
+    }
+
+    double encode_sec = std::chrono::duration<double>
+                        (std::chrono::steady_clock::now() - start).count();
+    std::vector<XrdMqHashDelta::Entry> entries;
+    size_t nentries = 0;
+    start = std::chrono::steady_clock::now();
+
+    for (const auto& msg : msgs) {
+      nentries += (mode == 0) ? DecodeEnv(msg, entries) :
+                  DecodeDelta(msg, entries);
+    }
+
+    double decode_sec = std::chrono::duration<double>
+                        (std::chrono::steady_clock::now() - start).count();
+    std::cout << modes[mode]
+              << " bytes/update: " << bytes / nupdates
+              << " encode updates/s: " << (size_t)(nupdates / encode_sec)
+              << " decode updates/s: " << (size_t)(nupdates / decode_sec)
+              << " decode keys/s: " << (size_t)(nentries / decode_sec)
+              << std::endl;
+  }
+
+  return 0;
+}
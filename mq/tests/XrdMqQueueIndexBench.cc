@@ -0,0 +1,217 @@
+//------------------------------------------------------------------------------
+//! @file XrdMqQueueIndexBench.cc
+//! @brief Compare the message fan-out with and without the queue index
+//------------------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2023 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+//------------------------------------------------------------------------------
+// The attached queues are half FST and half client queues. Every sender
+// delivers a mix of messages like the broker sees them: broadcasts to all
+// the FSTs, advisory status messages and messages to a single queue. The
+// "scan" mode matches every message against all the queues while holding
+// the global lock, as XrdMqOfs::Deliver did before using the index, the
+// "index" mode uses XrdMqQueueIndex and appends to the queues outside of
+// the global lock.
+//
+// Usage: eos-mq-index-bench [nqueues] [nmessages] [nthreads]
+//------------------------------------------------------------------------------
+#include "mq/XrdMqQueueIndex.hh"
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+//------------------------------------------------------------------------------
+// Output queue
+//------------------------------------------------------------------------------
+struct BenchQueue {
+  std::mutex mMutex;
+  std::deque<int> mMsgs;
+  bool mAdvisoryStatus {false};
+};
+
+using Index = XrdMqQueueIndex<BenchQueue>;
+
+//------------------------------------------------------------------------------
+// Message to be delivered
+//------------------------------------------------------------------------------
+struct BenchMessage {
+  std::string mQueue;
+  bool mIsStatus;
+};
+
+//------------------------------------------------------------------------------
+// Append a message to the matched queues
+//------------------------------------------------------------------------------
+static size_t
+FanOut(const std::vector<BenchQueue*>& queues)
+{
+  for (auto queue : queues) {
+    std::lock_guard<std::mutex> lock(queue->mMutex);
+    queue->mMsgs.push_back(1);
+
+    // Keep the memory usage bounded, consumers drain the queues
+    if (queue->mMsgs.size() > 64) {
+      queue->mMsgs.clear();
+    }
+  }
+
+  return queues.size();
+}
+
+//------------------------------------------------------------------------------
+// Deliver scanning all the queues under the global lock
+//------------------------------------------------------------------------------
+static size_t
+DeliverScan(std::mutex& global, std::map<std::string, BenchQueue*>& queues,
+            const BenchMessage& msg)
+{
+  std::lock_guard<std::mutex> lock(global);
+  std::vector<BenchQueue*> matched;
+
+  if (msg.mIsStatus) {
+    for (auto& elem : queues) {
+      if (elem.second->mAdvisoryStatus) {
+        matched.push_back(elem.second);
+      }
+    }
+  } else if (msg.mQueue.find('*') != std::string::npos) {
+    for (auto& elem : queues) {
+      // Mimic the per queue string copies of the previous implementation
+      std::string key = elem.first;
+      std::string pattern = msg.mQueue;
+
+      if (Index::WildcardMatch(pattern.c_str(), key.c_str())) {
+        matched.push_back(elem.second);
+      }
+    }
+  } else {
+    auto it = queues.find(msg.mQueue);
+
+    if (it != queues.end()) {
+      matched.push_back(it->second);
+    }
+  }
+
+  return FanOut(matched);
+}
+
+//------------------------------------------------------------------------------
+// Deliver using the index, fan-out outside the global lock
+//------------------------------------------------------------------------------
+static size_t
+DeliverIndex(std::mutex& global, Index& index, const BenchMessage& msg)
+{
+  Index::EntryListPtr candidates;
+  std::vector<BenchQueue*> matched;
+  {
+    std::lock_guard<std::mutex> lock(global);
+
+    if (msg.mIsStatus) {
+      candidates = index.GetAdvisoryStatus();
+    } else if (msg.mQueue.find('*') != std::string::npos) {
+      candidates = index.Match(msg.mQueue);
+    } else {
+      auto queue = index.Get(msg.mQueue);
+
+      if (queue) {
+        matched.push_back(queue.get());
+      }
+    }
+  }
+
+  if (candidates) {
+    matched.reserve(candidates->size());
+
+    for (const auto& entry : *candidates) {
+      matched.push_back(entry.mQueue.get());
+    }
+  }
+
+  return FanOut(matched);
+}
+
+int main(int argc, char* argv[])
+{
+  size_t nqueues = (argc > 1) ? strtoul(argv[1], 0, 10) : 5000;
+  size_t nmessages = (argc > 2) ? strtoul(argv[2], 0, 10) : 20000;
+  size_t nthreads = (argc > 3) ? strtoul(argv[3], 0, 10) : 4;
+
+  if (!nqueues || !nmessages || !nthreads) {
+    std::cerr << "usage: " << argv[0] << " [nqueues] [nmessages] [nthreads]"
+              << std::endl;
+    return 1;
+  }
+
+  std::vector<std::shared_ptr<BenchQueue>> storage;
+  std::map<std::string, BenchQueue*> queues;
+  Index index;
+
+  for (size_t i = 0; i < nqueues; ++i) {
+    std::string name = "/eos/host" + std::to_string(i) +
+                       ((i % 2) ? ":1095/fst" : "/fusex-client");
+    storage.push_back(std::make_shared<BenchQueue>());
+    storage.back()->mAdvisoryStatus = (i % 100 == 0);
+    queues[name] = storage.back().get();
+    index.Add(name, storage.back(), storage.back()->mAdvisoryStatus, false);
+  }
+
+  std::vector<BenchMessage> msgs {
+    {"/eos/*/fst", false}, {"/eos/*/mgm", true},
+    {"/eos/host1:1095/fst", false}, {"/eos/host42/fusex-client", false}
+  };
+
+  for (int mode = 0; mode < 2; ++mode) {
+    std::mutex global;
+    std::vector<std::thread> threads;
+    std::vector<size_t> delivered(nthreads, 0);
+    auto start = std::chrono::steady_clock::now();
+
+    for (size_t t = 0; t < nthreads; ++t) {
+      threads.emplace_back([&, t]() {
+        for (size_t i = 0; i < nmessages / nthreads; ++i) {
+          const BenchMessage& msg = msgs[i % msgs.size()];
+          delivered[t] += (mode == 0) ? DeliverScan(global, queues, msg) :
+                          DeliverIndex(global, index, msg);
+        }
+      });
+    }
+
+    for (auto& th : threads) {
+      th.join();
+    }
+
+    double elapsed = std::chrono::duration<double>
+                     (std::chrono::steady_clock::now() - start).count();
+    size_t total = 0;
+
+    for (auto count : delivered) {
+      total += count;
+    }
+
+    std::cout << ((mode == 0) ? "scan " : "index") << " queues: " << nqueues
+              << " messages/s: " << (size_t)(nmessages / elapsed)
+              << " deliveries/s: " << (size_t)(total / elapsed) << std::endl;
+  }
+
+  return 0;
+}
@@ -46,11 +46,20 @@ public:
     Updated = 0,
     Deleted,
     Created,
-    MTimeChange
+    MTimeChange,
+    AttributeChange
   };
 
   virtual ~IContainerMDChangeListener() {}
   virtual void containerMDChanged(IContainerMD* obj, Action type) = 0;
+
+  //--------------------------------------------------------------------------
+  //! Notification about the entry with the given name being added to or
+  //! removed from the container. An empty name means that any of the entries
+  //! might have changed, eg. when the cached container is dropped.
+  //--------------------------------------------------------------------------
+  virtual void containerMDChildChanged(ContainerIdentifier parent,
+                                       const std::string& name) {}
 };
 
 //----------------------------------------------------------------------------
@@ -146,6 +155,13 @@ public:
   virtual void notifyListeners(IContainerMD* obj,
                                IContainerMDChangeListener::Action a) = 0;
 
+  //----------------------------------------------------------------------------
+  //! Notify all subscribed listeners about a change of the entry with the
+  //! given name in the container
+  //----------------------------------------------------------------------------
+  virtual void notifyListeners(ContainerIdentifier parent,
+                               const std::string& name) = 0;
+
   //----------------------------------------------------------------------------
   //! Get the orphans container
   //----------------------------------------------------------------------------
@@ -179,6 +195,11 @@ public:
   //----------------------------------------------------------------------------
   virtual CacheStatistics getCacheStatistics() = 0;
 
+  //----------------------------------------------------------------------------
+  //! Retrieve path lookup (dentry) cache statistics
+  //----------------------------------------------------------------------------
+  virtual CacheStatistics getDentryCacheStatistics() = 0;
+
   //----------------------------------------------------------------------------
   //! Blacklist IDs below the given threshold
   //----------------------------------------------------------------------------
@@ -1371,4 +1371,18 @@ ChangeLogContainerMDSvc::notifyListeners(IContainerMD* obj,
     (*it)->containerMDChanged(obj, a);
   }
 }
+
+//----------------------------------------------------------------------------
+// Notify the listeners about the change of an entry in the container
+//----------------------------------------------------------------------------
+void
+ChangeLogContainerMDSvc::notifyListeners(ContainerIdentifier parent,
+    const std::string& name)
+{
+  ListenerList::iterator it;
+
+  for (it = pListeners.begin(); it != pListeners.end(); ++it) {
+    (*it)->containerMDChildChanged(parent, name);
+  }
+}
 }
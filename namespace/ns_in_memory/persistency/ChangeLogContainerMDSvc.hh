@@ -358,6 +358,14 @@ public:
     return {};
   }
 
+  //----------------------------------------------------------------------------
+  //! Retrieve dentry cache statistics - no caching, everything in memory
+  //----------------------------------------------------------------------------
+  virtual CacheStatistics getDentryCacheStatistics() override
+  {
+    return {};
+  }
+
   //----------------------------------------------------------------------------
   //! Blacklist IDs below the given threshold - no-op for in-memory namespace
   //----------------------------------------------------------------------------
@@ -412,6 +420,12 @@ private:
   void notifyListeners(IContainerMD* obj, IContainerMDChangeListener::Action a)
   override;
 
+  //--------------------------------------------------------------------------
+  //! Notify the listeners about the change of an entry in the container
+  //--------------------------------------------------------------------------
+  void notifyListeners(ContainerIdentifier parent, const std::string& name)
+  override;
+
   //--------------------------------------------------------------------------
   //! Load the container
   //--------------------------------------------------------------------------
@@ -18,6 +18,7 @@
 
 #include "namespace/ns_quarkdb/CacheRefreshListener.hh"
 #include "namespace/interface/Identifiers.hh"
+#include "namespace/interface/IContainerMDSvc.hh"
 #include "namespace/ns_quarkdb/persistency/MetadataProvider.hh"
 #include "namespace/ns_quarkdb/Constants.hh"
 #include "common/ParseUtils.hh"
@@ -31,8 +32,9 @@ EOSNSNAMESPACE_BEGIN
 //------------------------------------------------------------------------------
 // Constructor
 //------------------------------------------------------------------------------
-CacheRefreshListener::CacheRefreshListener(const QdbContactDetails &cd, MetadataProvider *provider)
-: mContactDetails(cd), mMetadataProvider(provider),
+CacheRefreshListener::CacheRefreshListener(const QdbContactDetails &cd, MetadataProvider *provider,
+  IContainerMDSvc *contsvc)
+: mContactDetails(cd), mMetadataProvider(provider), mContainerSvc(contsvc),
   mSubscriber(cd.members, cd.constructSubscriptionOptions()) {
 
   mFidSubscription = mSubscriber.subscribe(constants::sCacheInvalidationFidChannel);
@@ -72,7 +74,8 @@ void CacheRefreshListener::processIncomingCidInvalidation(qclient::Message &&msg
   uint64_t cid;
 
   if(common::ParseUInt64(msg.getPayload(), cid)) {
-    mMetadataProvider->dropCachedContainerID(ContainerIdentifier(cid));
+    // Through the container service, which also drops the cached lookups
+    mContainerSvc->dropCachedContainerMD(ContainerIdentifier(cid));
   }
 }
 
@@ -65,6 +65,8 @@ static const std::string sMaxSizeCacheFiles {"max_size_cache_files"};
 static const std::string sMaxNumCacheDirs {"max_num_cache_dirs"};
 //! Tag for max size (bytes) of dir/container entries cached at the MGM
 static const std::string sMaxSizeCacheDirs {"max_size_cache_dirs"};
+//! Tag for max num of path lookup (dentry) entries cached at the MGM
+static const std::string sMaxNumCacheDentries {"max_num_cache_dentries"};
 
 //! Channel for incoming fid cache invalidation notifications
 static const std::string sCacheInvalidationFidChannel {"eos-md-cache-invalidation-fid"};
@@ -107,6 +109,17 @@ static const std::string sUnlinkedSuffix = "unlinked";
 static const std::string sNoReplicaPrefix = "fsview_noreplicas";
 }
 
+// Variables associated with the PolicyIndex
+namespace policyindex
+{
+//! Prefix for sets storing the ids of containers holding policy attributes
+static const std::string sPrefix = "policy-index:";
+//! Field in the meta info map marking the policy index as complete
+static const std::string sReadyField = "policy_index_ready";
+//! Field in the meta info map counting the rebuilds of the policy index
+static const std::string sGenerationField = "policy_index_generation";
+}
+
 EOSNSNAMESPACE_END
 
 #endif // __EOS_NS_REDIS_CONSTANTS_HH__
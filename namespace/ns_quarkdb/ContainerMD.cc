@@ -230,6 +230,8 @@ QuarkContainerMD::removeContainer(const std::string& name)
   // mSubcontainers->resize(0);
   // Delete container also from KV backend
   pFlusher->hdel(pDirsKey, name);
+  lock.unlock();
+  notifyChildChange(name);
 }
 
 //------------------------------------------------------------------------------
@@ -271,6 +273,8 @@ QuarkContainerMD::addContainer(IContainerMD* container)
                                 container->getId()));
   // Add to new container to KV backend
   pFlusher->hset(pDirsKey, container->getName(), stringify(container->getId()));
+  lock.unlock();
+  notifyChildChange(container->getName());
 }
 
 //------------------------------------------------------------------------------
@@ -346,6 +350,7 @@ QuarkContainerMD::addFile(IFileMD* file)
   (void)mFiles->insert(std::make_pair(file->getName(), file->getId()));
   pFlusher->hset(pFilesKey, file->getName(), std::to_string(file->getId()));
   lock.unlock();
+  notifyChildChange(file->getName());
 
   if (file->getSize() != 0u) {
     IFileMDChangeListener::Event e(file, IFileMDChangeListener::SizeChange, 0,
@@ -368,9 +373,10 @@ QuarkContainerMD::removeFile(const std::string& name)
     mFiles->erase(iter);
     // mFiles->resize(0);
     pFlusher->hdel(pFilesKey, name);
+    lock.unlock();
+    notifyChildChange(name);
 
     try {
-      lock.unlock();
       std::shared_ptr<IFileMD> file = pFileSvc->getFileMD(id);
       // NOTE: This is an ugly hack. The file object has no reference to the
       // container id, therefore we hijack the "location" member of the Event
@@ -672,18 +678,54 @@ QuarkContainerMD::getAttribute(const std::string& name) const
   return it->second;
 }
 
+//------------------------------------------------------------------------------
+// Add extended attribute
+//------------------------------------------------------------------------------
+void
+QuarkContainerMD::setAttribute(const std::string& name,
+                               const std::string& value)
+{
+  {
+    std::unique_lock<std::shared_timed_mutex> lock(mMutex);
+    (*mCont.mutable_xattrs())[name] = value;
+  }
+
+  if (pContSvc) {
+    pContSvc->notifyListeners(this, IContainerMDChangeListener::AttributeChange);
+  }
+}
+
 //------------------------------------------------------------------------------
 // Remove attribute
 //------------------------------------------------------------------------------
 void
 QuarkContainerMD::removeAttribute(const std::string& name)
 {
-  std::unique_lock<std::shared_timed_mutex> lock(mMutex);
-  auto it = mCont.xattrs().find(name);
+  {
+    std::unique_lock<std::shared_timed_mutex> lock(mMutex);
+    auto it = mCont.xattrs().find(name);
+
+    if (it == mCont.xattrs().end()) {
+      return;
+    }
 
-  if (it != mCont.xattrs().end()) {
     mCont.mutable_xattrs()->erase(it->first);
   }
+
+  if (pContSvc) {
+    pContSvc->notifyListeners(this, IContainerMDChangeListener::AttributeChange);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Notify the listeners about a change of the entry with the given name
+//------------------------------------------------------------------------------
+void
+QuarkContainerMD::notifyChildChange(const std::string& name)
+{
+  if (pContSvc) {
+    pContSvc->notifyListeners(ContainerIdentifier(getId()), name);
+  }
 }
 
 //------------------------------------------------------------------------------
@@ -389,12 +389,7 @@ public:
   //----------------------------------------------------------------------------
   //! Add extended attribute
   //----------------------------------------------------------------------------
-  void
-  setAttribute(const std::string& name, const std::string& value) override
-  {
-    std::unique_lock<std::shared_timed_mutex> lock(mMutex);
-    (*mCont.mutable_xattrs())[name] = value;
-  }
+  void setAttribute(const std::string& name, const std::string& value) override;
 
   //----------------------------------------------------------------------------
   //! Remove attribute
@@ -511,6 +506,12 @@ private:
   //----------------------------------------------------------------------------
   void getMTimeNoLock(mtime_t& mtime) const;
 
+  //----------------------------------------------------------------------------
+  //! Notify the listeners about a change of the entry with the given name,
+  //! must be called without holding the lock
+  //----------------------------------------------------------------------------
+  void notifyChildChange(const std::string& name);
+
   //----------------------------------------------------------------------------
   //! Get iterator to the begining of the subcontainers map
   //----------------------------------------------------------------------------
@@ -19,7 +19,10 @@
 //------------------------------------------------------------------------------
 //! @author Elvin-Alin Sindrilaru <esindril@cern.ch>
 //! @brief LRU cache for namespace objects making sure we never evict an entry
-//!        which is still referenced in other parts of the program.
+//!        which is still referenced in other parts of the program. The
+//!        replacement policy is CLOCK (second chance) over a number of
+//!        independently locked shards, so that cache hits only take a shared
+//!        lock on one shard and set the reference bit of the entry.
 //------------------------------------------------------------------------------
 
 #ifndef __EOS_NS_LRU_HH__
@@ -30,11 +33,14 @@
 #include "common/Murmur3.hh"
 #include "namespace/Namespace.hh"
 #include <google/dense_hash_map>
+#include <atomic>
 #include <cstdint>
-#include <list>
+#include <deque>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <shared_mutex>
+#include <vector>
 
 EOSNSNAMESPACE_BEGIN
 
@@ -122,8 +128,7 @@ public:
   inline std::uint64_t
   size() const
   {
-    std::unique_lock<std::mutex> lock(mMutex);
-    return mMap.size();
+    return mSize.load();
   }
 
   //----------------------------------------------------------------------------
@@ -134,8 +139,7 @@ public:
   inline std::uint64_t
   get_max_num() const
   {
-    std::unique_lock<std::mutex> lock(mMutex);
-    return mMaxNum;
+    return mMaxNum.load();
   }
 
   //----------------------------------------------------------------------------
@@ -147,8 +151,6 @@ public:
   inline void
   set_max_num(const std::uint64_t max_num)
   {
-    std::unique_lock<std::mutex> lock(mMutex);
-
     if (max_num == 0ull) {
       // Flush and disable cache
       Purge(0.0);
@@ -169,6 +171,39 @@ public:
   LRU& operator=(LRU&& other) = delete;
 
 private:
+  //----------------------------------------------------------------------------
+  //! Cache entry - object and its CLOCK reference bit
+  //----------------------------------------------------------------------------
+  struct Node {
+    std::shared_ptr<EntryT> mObj;
+    std::atomic<bool> mRef {false}; ///< Set on access, cleared by the clock
+  };
+
+  using MapT = google::dense_hash_map<IdT, std::uint32_t,
+        Murmur3::MurmurHasher<IdT>>;
+  using ObjBatchT = std::vector<std::shared_ptr<EntryT>>;
+
+  //----------------------------------------------------------------------------
+  //! Shard of the cache - map from id to the position of the entry in the
+  //! clock ring. Slots of evicted entries are reused by new entries.
+  //----------------------------------------------------------------------------
+  struct Shard {
+    mutable std::shared_timed_mutex mMutex; ///< Protects the members below
+    MapT mMap; ///< Map from id to position in the clock ring
+    std::deque<Node> mRing; ///< Clock ring of entries
+    std::vector<std::uint32_t> mFreeSlots; ///< Unused positions in the ring
+    std::uint32_t mHand {0}; ///< Position of the clock hand
+  };
+
+  //----------------------------------------------------------------------------
+  //! Get shard responsible for the given id
+  //----------------------------------------------------------------------------
+  inline Shard&
+  GetShard(IdT id)
+  {
+    // Top bits of the hash, the dense_hash_map buckets use the bottom ones
+    return mShards[Murmur3::MurmurHasher<IdT>()(id) >> (64 - sShardBits)];
+  }
 
   //----------------------------------------------------------------------------
   //! Cleaner job taking care of deallocating entries that are passed through
@@ -177,28 +212,40 @@ private:
   void CleanerJob(ThreadAssistant& assistant);
 
   //----------------------------------------------------------------------------
-  //! Purge entries until stop ratio is achieved
+  //! Purge entries until stop ratio is achieved. Shards are visited round
+  //! robin, each of them evicting a batch of entries under its own lock.
   //!
   //! @param stop_ratio stop purge ratio
-  //! @note This method must be called with the mutex protecting the map and
-  //! the list locked.
   //----------------------------------------------------------------------------
   void Purge(double stop_ratio);
 
+  //----------------------------------------------------------------------------
+  //! Advance the clock hand of the given shard and evict entries which were
+  //! not accessed since the last pass and are not referenced elsewhere.
+  //!
+  //! @param shard shard to clean
+  //! @param max_evict maximum number of entries to evict
+  //! @param target stop once the total size drops to this value
+  //! @param evicted_objs evicted objects to be deallocated
+  //!
+  //! @return number of evicted entries
+  //! @note This method must be called with the shard mutex locked
+  //----------------------------------------------------------------------------
+  std::uint64_t Evict(Shard& shard, std::uint64_t max_evict,
+                      std::uint64_t target, ObjBatchT& evicted_objs);
+
   //! Percentage at which the cache purging stops
   static constexpr double sPurgeStopRatio = 0.9;
-  using ListT = std::list<std::shared_ptr<EntryT>>;
-  typename std::list<std::shared_ptr<EntryT>>::iterator ListIterT;
-  //using MapT = std::map<IdT, decltype(ListIterT)>;
-  using MapT = google::dense_hash_map<IdT, decltype(ListIterT),
-        Murmur3::MurmurHasher<IdT>>;
-  MapT mMap;   ///< Internal map pointing to obj in list
-  ListT mList; ///< Internal list of objects where new/used objects are at the
-  ///< end of the list
-  //! Mutext to protect access to the map and list
-  mutable std::mutex mMutex;
-  std::uint64_t mMaxNum; ///< Maximum number of entries
-  eos::common::ConcurrentQueue< std::shared_ptr<EntryT> > mToDelete;
+  static constexpr std::uint32_t sShardBits = 6;
+  static constexpr std::uint32_t sNumShards = 1 << sShardBits;
+  Shard mShards[sNumShards];
+  std::atomic<std::uint64_t> mSize; ///< Number of entries in all shards
+  std::atomic<std::uint64_t> mMaxNum; ///< Maximum number of entries
+  //! Mutex serializing the purging, taken before any shard mutex
+  std::mutex mPurgeMutex;
+  std::uint32_t mPurgeShard; ///< Next shard to purge, protected by mPurgeMutex
+  //! Batches of evicted objects to be deallocated, empty batch stops cleaner
+  eos::common::ConcurrentQueue<ObjBatchT> mToDelete;
   AssistedThread mCleanerThread; ///< Thread doing the deallocations
 };
 
@@ -211,10 +258,13 @@ constexpr double LRU<IdT, EntryT>::sPurgeStopRatio;
 //------------------------------------------------------------------------------
 template <typename IdT, typename EntryT>
 LRU<IdT, EntryT>::LRU(std::uint64_t max_num) :
-  mMap(), mList(), mMutex(), mMaxNum(max_num), mToDelete()
+  mSize(0ull), mMaxNum(max_num), mPurgeShard(0), mToDelete()
 {
-  mMap.set_empty_key(IdT(UINT64_MAX - 1));
-  mMap.set_deleted_key(IdT(UINT64_MAX));
+  for (auto& shard : mShards) {
+    shard.mMap.set_empty_key(IdT(UINT64_MAX - 1));
+    shard.mMap.set_deleted_key(IdT(UINT64_MAX));
+  }
+
   mCleanerThread.reset(&LRU::CleanerJob, this);
 }
 
@@ -224,13 +274,17 @@ LRU<IdT, EntryT>::LRU(std::uint64_t max_num) :
 template <typename IdT, typename EntryT>
 LRU<IdT, EntryT>::~LRU()
 {
-  std::shared_ptr<EntryT> sentinel(nullptr);
+  ObjBatchT sentinel;
   mCleanerThread.stop();
   mToDelete.push(sentinel);
   mCleanerThread.join();
-  std::unique_lock<std::mutex> lock(mMutex);
-  mMap.clear();
-  mList.clear();
+
+  for (auto& shard : mShards) {
+    std::unique_lock<std::shared_timed_mutex> lock(shard.mMutex);
+    shard.mMap.clear();
+    shard.mRing.clear();
+    shard.mFreeSlots.clear();
+  }
 }
 
 //------------------------------------------------------------------------------
@@ -240,18 +294,22 @@ template <typename IdT, typename EntryT>
 std::shared_ptr<EntryT>
 LRU<IdT, EntryT>::get(IdT id)
 {
-  std::unique_lock<std::mutex> lock(mMutex);
-  auto iter_map = mMap.find(id);
+  Shard& shard = GetShard(id);
+  std::shared_lock<std::shared_timed_mutex> lock(shard.mMutex);
+  auto iter_map = shard.mMap.find(id);
 
-  if (iter_map == mMap.end()) {
+  if (iter_map == shard.mMap.end()) {
     return nullptr;
   }
 
-  // Move object to the end of the list i.e. recently accessed
-  auto iter_new = mList.insert(mList.end(), *iter_map->second);
-  mList.erase(iter_map->second);
-  iter_map->second = iter_new;
-  return *iter_new;
+  Node& node = shard.mRing[iter_map->second];
+
+  // Mark as recently accessed, avoid dirtying the cache line if already set
+  if (!node.mRef.load(std::memory_order_relaxed)) {
+    node.mRef.store(true, std::memory_order_relaxed);
+  }
+
+  return node.mObj;
 }
 
 //------------------------------------------------------------------------------
@@ -261,27 +319,48 @@ template <typename IdT, typename EntryT>
 typename std::enable_if<hasGetId<EntryT>::value, std::shared_ptr<EntryT>>::type
     LRU<IdT, EntryT>::put(IdT id, std::shared_ptr<EntryT> obj)
 {
-  std::unique_lock<std::mutex> lock(mMutex);
-
   if (mMaxNum == 0ull) {
     return obj;
   }
 
-  auto iter_map = mMap.find(id);
+  Shard& shard = GetShard(id);
+  {
+    std::shared_lock<std::shared_timed_mutex> lock(shard.mMutex);
+    auto iter_map = shard.mMap.find(id);
 
-  if (iter_map != mMap.end()) {
-    return *(iter_map->second);
+    if (iter_map != shard.mMap.end()) {
+      return shard.mRing[iter_map->second].mObj;
+    }
   }
 
-  // Check if map full and purge some entries if necessary 10% of max size
-  if (mMap.size() >= mMaxNum) {
+  // Check if cache full and purge some entries if necessary 10% of max size
+  if (mSize >= mMaxNum) {
     Purge(sPurgeStopRatio);
   }
 
-  // @todo (esindril): add time based and for a fixed number of entries purging
-  auto iter = mList.insert(mList.end(), obj);
-  mMap[id] = iter;
-  return *iter;
+  std::unique_lock<std::shared_timed_mutex> lock(shard.mMutex);
+  auto iter_map = shard.mMap.find(id);
+
+  if (iter_map != shard.mMap.end()) {
+    return shard.mRing[iter_map->second].mObj;
+  }
+
+  std::uint32_t pos;
+
+  if (shard.mFreeSlots.empty()) {
+    pos = shard.mRing.size();
+    shard.mRing.emplace_back();
+  } else {
+    pos = shard.mFreeSlots.back();
+    shard.mFreeSlots.pop_back();
+  }
+
+  Node& node = shard.mRing[pos];
+  node.mObj = obj;
+  node.mRef.store(false, std::memory_order_relaxed);
+  shard.mMap[id] = pos;
+  ++mSize;
+  return obj;
 }
 
 //------------------------------------------------------------------------------
@@ -291,15 +370,18 @@ template <typename IdT, typename EntryT>
 bool
 LRU<IdT, EntryT>::remove(IdT id)
 {
-  std::unique_lock<std::mutex> lock(mMutex);
-  auto iter_map = mMap.find(id);
+  Shard& shard = GetShard(id);
+  std::unique_lock<std::shared_timed_mutex> lock(shard.mMutex);
+  auto iter_map = shard.mMap.find(id);
 
-  if (iter_map == mMap.end()) {
+  if (iter_map == shard.mMap.end()) {
     return false;
   }
 
-  (void)mList.erase(iter_map->second);
-  mMap.erase(iter_map);
+  shard.mRing[iter_map->second].mObj.reset();
+  shard.mFreeSlots.push_back(iter_map->second);
+  shard.mMap.erase(iter_map);
+  --mSize;
   return true;
 }
 
@@ -311,16 +393,16 @@ template <typename IdT, typename EntryT>
 void
 LRU<IdT, EntryT>::CleanerJob(ThreadAssistant& assistant)
 {
-  std::shared_ptr<EntryT> tmp;
+  ObjBatchT tmp;
 
   while (!assistant.terminationRequested()) {
     while (true) {
       mToDelete.wait_pop(tmp);
 
-      if (tmp == nullptr) {
+      if (tmp.empty()) {
         break;
       } else {
-        tmp.reset();
+        tmp.clear();
       }
     }
   }
@@ -333,22 +415,72 @@ template <typename IdT, typename EntryT>
 void
 LRU<IdT, EntryT>::Purge(double stop_ratio)
 {
-  auto iter = mList.begin();
+  std::unique_lock<std::mutex> purge_lock(mPurgeMutex);
+  const std::uint64_t target = stop_ratio * mMaxNum;
+  // Number of consecutive shards which could not evict anything
+  std::uint32_t num_idle = 0;
+  ObjBatchT evicted_objs;
+
+  while ((mSize > target) && (num_idle < sNumShards)) {
+    Shard& shard = mShards[mPurgeShard];
+    mPurgeShard = (mPurgeShard + 1) % sNumShards;
+    // Spread the eviction evenly over the shards
+    std::uint64_t batch = (mSize - target + sNumShards - 1) / sNumShards;
+    std::unique_lock<std::shared_timed_mutex> lock(shard.mMutex);
+
+    if (Evict(shard, batch, target, evicted_objs)) {
+      num_idle = 0;
+    } else {
+      ++num_idle;
+    }
+  }
+
+  purge_lock.unlock();
+
+  // Hand over the objects to the cleaner thread in one go
+  if (!evicted_objs.empty()) {
+    mToDelete.push(evicted_objs);
+  }
+}
 
-  while ((iter != mList.end()) &&
-         (mMap.size() > stop_ratio * mMaxNum)) {
-    // If object is referenced also by someone else then skip it
-    if (iter->use_count() > 1) {
-      ++iter;
+//------------------------------------------------------------------------------
+// Evict entries from the given shard using the clock hand
+//------------------------------------------------------------------------------
+template <typename IdT, typename EntryT>
+std::uint64_t
+LRU<IdT, EntryT>::Evict(Shard& shard, std::uint64_t max_evict,
+                        std::uint64_t target, ObjBatchT& evicted_objs)
+{
+  const std::uint64_t ring_sz = shard.mRing.size();
+  std::uint64_t evicted = 0ull;
+
+  // Two rounds are enough to clear all the reference bits and come back
+  for (std::uint64_t scanned = 0ull; (scanned < 2 * ring_sz) &&
+       (evicted < max_evict) && (mSize > target); ++scanned) {
+    const std::uint32_t pos = shard.mHand;
+    Node& node = shard.mRing[pos];
+    shard.mHand = (pos + 1) % ring_sz;
+
+    // Skip free slots, give a second chance to recently accessed entries and
+    // never evict objects which are still referenced by someone else
+    if ((node.mObj == nullptr) ||
+        node.mRef.exchange(false, std::memory_order_relaxed) ||
+        (node.mObj.use_count() > 1)) {
       continue;
     }
 
-    mMap.erase(IdT((*iter)->getId()));
-    mToDelete.push(*iter);
-    iter = mList.erase(iter);
+    shard.mMap.erase(IdT(node.mObj->getId()));
+    evicted_objs.push_back(std::move(node.mObj));
+    shard.mFreeSlots.push_back(pos);
+    --mSize;
+    ++evicted;
+  }
+
+  if (evicted) {
+    shard.mMap.resize(0); // compact after deletion
   }
 
-  mMap.resize(0); // compact after deletion
+  return evicted;
 }
 
 EOSNSNAMESPACE_END
@@ -28,6 +28,7 @@
 #include "namespace/ns_quarkdb/views/HierarchicalView.hh"
 #include "namespace/ns_quarkdb/accounting/FileSystemView.hh"
 #include "namespace/ns_quarkdb/accounting/SyncTimeAccounting.hh"
+#include "namespace/ns_quarkdb/accounting/PolicyIndex.hh"
 #include "namespace/ns_quarkdb/accounting/QuotaStats.hh"
 #include "namespace/ns_quarkdb/accounting/ContainerAccounting.hh"
 #include "namespace/ns_quarkdb/CacheRefreshListener.hh"
@@ -51,6 +52,7 @@ QuarkNamespaceGroup::~QuarkNamespaceGroup()
 {
   mCacheRefreshListener.reset();
   mSyncAccounting.reset();
+  mPolicyIndex.reset();
   mContainerAccounting.reset();
   mFilesystemView.reset();
   mHierarchicalView.reset();
@@ -146,6 +148,9 @@ void QuarkNamespaceGroup::initializeFileAndContainerServices()
   if (!mContainerService) {
     mContainerService.reset(new QuarkContainerMDSvc(getQClient(),
                             getMetadataFlusher()));
+    mPolicyIndex.reset(new QuarkPolicyIndex(*getQClient(),
+                                            getMetadataFlusher()));
+    mContainerService->addChangeListener(mPolicyIndex.get());
   }
 
   mContainerService->setFileMDService(mFileService.get());
@@ -192,6 +197,7 @@ IView* QuarkNamespaceGroup::getHierarchicalView()
                             getQuotaFlusher()));
     mHierarchicalView->setFileMDSvc(getFileService());
     mHierarchicalView->setContainerMDSvc(getContainerService());
+    mHierarchicalView->setDentryCache(mContainerService->getDentryCache());
   }
 
   return mHierarchicalView.get();
@@ -310,6 +316,15 @@ folly::Executor* QuarkNamespaceGroup::getExecutor()
   return mExecutor.get();
 }
 
+//------------------------------------------------------------------------------
+// Get policy index
+//------------------------------------------------------------------------------
+QuarkPolicyIndex* QuarkNamespaceGroup::getPolicyIndex()
+{
+  std::lock_guard<std::recursive_mutex> lock(mMutex);
+  return mPolicyIndex.get();
+}
+
 //------------------------------------------------------------------------------
 // Start cache refresh listener
 //------------------------------------------------------------------------------
@@ -319,7 +334,8 @@ void QuarkNamespaceGroup::startCacheRefreshListener()
 
   if (!mCacheRefreshListener) {
     mCacheRefreshListener.reset(new CacheRefreshListener(contactDetails,
-                                mFileService->getMetadataProvider()));
+                                mFileService->getMetadataProvider(),
+                                mContainerService.get()));
   }
 }
 
@@ -47,6 +47,7 @@ class QuarkHierarchicalView;
 class QuarkFileSystemView;
 class QuarkContainerAccounting;
 class QuarkSyncTimeAccounting;
+class QuarkPolicyIndex;
 class QuarkQuotaStats;
 class MetadataFlusher;
 class CacheRefreshListener;
@@ -145,6 +146,11 @@ public:
   //----------------------------------------------------------------------------
   folly::Executor* getExecutor();
 
+  //----------------------------------------------------------------------------
+  //! Get policy index
+  //----------------------------------------------------------------------------
+  QuarkPolicyIndex* getPolicyIndex();
+
   //----------------------------------------------------------------------------
   //! Start cache refresh listener
   //----------------------------------------------------------------------------
@@ -189,6 +195,7 @@ private:
   std::unique_ptr<QuarkFileSystemView> mFilesystemView;
   std::unique_ptr<QuarkContainerAccounting> mContainerAccounting;
   std::unique_ptr<QuarkSyncTimeAccounting> mSyncAccounting;
+  std::unique_ptr<QuarkPolicyIndex> mPolicyIndex;
   std::unique_ptr<CacheRefreshListener> mCacheRefreshListener;
   std::shared_ptr<QClPerfMonitor> mPerfMonitor; ///< QCl performance monitor
 };
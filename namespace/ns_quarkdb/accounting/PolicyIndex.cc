@@ -0,0 +1,223 @@
+//------------------------------------------------------------------------------
+//! @file PolicyIndex.cc
+//! @brief Persisted index of containers holding policy attributes
+//------------------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2023 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+#include "namespace/ns_quarkdb/accounting/PolicyIndex.hh"
+#include "namespace/ns_quarkdb/Constants.hh"
+#include "namespace/ns_quarkdb/flusher/MetadataFlusher.hh"
+#include "namespace/ns_quarkdb/persistency/RequestBuilder.hh"
+#include "qclient/QClient.hh"
+#include "qclient/structures/QHash.hh"
+#include "qclient/structures/QSet.hh"
+
+EOSNSNAMESPACE_BEGIN
+
+const std::vector<std::string> QuarkPolicyIndex::sDefaultPrefixes {
+  "sys.lru.", "sys.attr.link"
+};
+
+//------------------------------------------------------------------------------
+// Constructor
+//------------------------------------------------------------------------------
+QuarkPolicyIndex::QuarkPolicyIndex(qclient::QClient& qcl,
+                                   MetadataFlusher* flusher,
+                                   const std::vector<std::string>& prefixes):
+  mFlusher(flusher), mPrefixes(prefixes)
+{
+  for (const auto& prefix : mPrefixes) {
+    mIndexed[prefix];
+  }
+
+  mGeneration = GetGeneration(qcl);
+  (void) Load(qcl);
+}
+
+//------------------------------------------------------------------------------
+// Reload the indexed containers if the index was rebuilt
+//------------------------------------------------------------------------------
+void
+QuarkPolicyIndex::ReloadIfRebuilt(qclient::QClient& qcl)
+{
+  // Read the generation first, a rebuild finishing during the load is then
+  // picked up by the next call
+  const std::string generation = GetGeneration(qcl);
+
+  if (generation.empty() || (generation == mGeneration)) {
+    return;
+  }
+
+  eos_static_info("msg=\"reload policy index after rebuild\" generation=%s",
+                  generation.c_str());
+
+  if (Load(qcl)) {
+    mGeneration = generation;
+  }
+}
+
+//------------------------------------------------------------------------------
+// Add the containers currently in the QuarkDB sets to mIndexed
+//------------------------------------------------------------------------------
+bool
+QuarkPolicyIndex::Load(qclient::QClient& qcl)
+{
+  bool ok = true;
+  std::map<std::string, std::set<IContainerMD::id_t>> loaded;
+
+  for (const auto& prefix : mPrefixes) {
+    if (!GetContainers(qcl, prefix, loaded[prefix])) {
+      eos_static_err("msg=\"failed to load policy index\" prefix=\"%s\"",
+                     prefix.c_str());
+      ok = false;
+    }
+  }
+
+  // Merge instead of replacing: entries indexed while loading might not be
+  // flushed to QuarkDB yet. A container in mIndexed but not in QuarkDB only
+  // costs a redundant removal.
+  std::unique_lock<std::mutex> lock(mMutex);
+
+  for (const auto& elem : loaded) {
+    mIndexed[elem.first].insert(elem.second.begin(), elem.second.end());
+  }
+
+  return ok;
+}
+
+//------------------------------------------------------------------------------
+// Get the generation of the index
+//------------------------------------------------------------------------------
+std::string
+QuarkPolicyIndex::GetGeneration(qclient::QClient& qcl)
+{
+  try {
+    qclient::QHash meta_map(qcl, constants::sMapMetaInfoKey);
+    return meta_map.hget(policyindex::sGenerationField);
+  } catch (const std::exception& e) {
+    eos_static_err("msg=\"failed to query policy index generation\" "
+                   "error=\"%s\"", e.what());
+  }
+
+  return "";
+}
+
+//------------------------------------------------------------------------------
+// Notify me about the changes in the main view
+//------------------------------------------------------------------------------
+void
+QuarkPolicyIndex::containerMDChanged(IContainerMD* obj, Action type)
+{
+  IContainerMD::XAttrMap xattrs;
+
+  switch (type) {
+  case IContainerMDChangeListener::Deleted:
+    break;
+
+  case IContainerMDChangeListener::AttributeChange:
+    xattrs = obj->getAttributes();
+    break;
+
+  default:
+    return;
+  }
+
+  const IContainerMD::id_t id = obj->getId();
+  const std::string sid = std::to_string(id);
+  std::unique_lock<std::mutex> lock(mMutex);
+
+  // Updates are only issued when the indexed state changes, since attributes
+  // are set one at a time. Containers added by a rebuild of the index are
+  // known once ReloadIfRebuilt ran.
+  for (auto& elem : mIndexed) {
+    bool indexed = (elem.second.find(id) != elem.second.end());
+
+    if (HasPrefix(xattrs, elem.first)) {
+      if (!indexed) {
+        elem.second.insert(id);
+        mFlusher->sadd(RequestBuilder::keyPolicyIndex(elem.first), sid);
+      }
+    } else if (indexed) {
+      elem.second.erase(id);
+      mFlusher->srem(RequestBuilder::keyPolicyIndex(elem.first), sid);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// Check if any of the attributes starts with the given prefix
+//------------------------------------------------------------------------------
+bool
+QuarkPolicyIndex::HasPrefix(const IContainerMD::XAttrMap& xattrs,
+                            const std::string& prefix)
+{
+  // The map is ordered, the first key not smaller than the prefix is the only
+  // candidate
+  auto it = xattrs.lower_bound(prefix);
+  return ((it != xattrs.end()) &&
+          (it->first.compare(0, prefix.length(), prefix) == 0));
+}
+
+//------------------------------------------------------------------------------
+// Check if the index was built for the existing containers
+//------------------------------------------------------------------------------
+bool
+QuarkPolicyIndex::IsReady(qclient::QClient& qcl)
+{
+  try {
+    qclient::QHash meta_map(qcl, constants::sMapMetaInfoKey);
+    return (meta_map.hget(policyindex::sReadyField) == "1");
+  } catch (const std::exception& e) {
+    eos_static_err("msg=\"failed to query policy index state\" error=\"%s\"",
+                   e.what());
+  }
+
+  return false;
+}
+
+//------------------------------------------------------------------------------
+// Get the ids of the containers indexed for the given prefix
+//------------------------------------------------------------------------------
+bool
+QuarkPolicyIndex::GetContainers(qclient::QClient& qcl,
+                                const std::string& prefix,
+                                std::set<IContainerMD::id_t>& ids)
+{
+  qclient::QSet qset(qcl, RequestBuilder::keyPolicyIndex(prefix));
+
+  try {
+    for (auto it = qset.getIterator(); it.valid(); it.next()) {
+      try {
+        ids.insert(std::stoull(it.getElement()));
+      } catch (...) {
+        eos_static_err("msg=\"skip malformed policy index entry\" prefix=\"%s\" "
+                       "data=\"%s\"", prefix.c_str(), it.getElement().c_str());
+      }
+    }
+  } catch (const std::exception& e) {
+    eos_static_err("msg=\"failed to scan policy index\" prefix=\"%s\" "
+                   "error=\"%s\"", prefix.c_str(), e.what());
+    return false;
+  }
+
+  return true;
+}
+
+EOSNSNAMESPACE_END
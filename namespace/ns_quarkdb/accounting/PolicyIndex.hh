@@ -0,0 +1,153 @@
+//------------------------------------------------------------------------------
+//! @file PolicyIndex.hh
+//! @brief Persisted index of containers holding policy attributes
+//------------------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2023 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+#pragma once
+#include "namespace/Namespace.hh"
+#include "namespace/interface/IContainerMD.hh"
+#include "namespace/interface/IContainerMDSvc.hh"
+#include "common/Logging.hh"
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace qclient
+{
+class QClient;
+}
+
+EOSNSNAMESPACE_BEGIN
+
+class MetadataFlusher;
+
+//------------------------------------------------------------------------------
+//! Listener keeping, for every configured attribute prefix, a QuarkDB set
+//! with the ids of the containers holding at least one attribute with that
+//! prefix. Policy engines like the LRU can then visit only these containers
+//! instead of exploring the whole namespace.
+//!
+//! Containers pointing to another one through sys.attr.link are indexed
+//! separately, since the policy attributes they inherit are not stored on
+//! the container itself.
+//!
+//! The index is only complete once it was built for the existing containers
+//! using "eos-ns-inspect rebuild-policy-index", which marks it as ready. Each
+//! rebuild also bumps a generation counter, the containers it added are
+//! picked up by ReloadIfRebuilt.
+//------------------------------------------------------------------------------
+class QuarkPolicyIndex : public IContainerMDChangeListener,
+  public eos::common::LogId
+{
+public:
+  //! Attribute prefixes indexed by default
+  static const std::vector<std::string> sDefaultPrefixes;
+
+  //----------------------------------------------------------------------------
+  //! Constructor - loads the current contents of the index
+  //!
+  //! @param qcl qclient object
+  //! @param flusher metadata flusher used to update the index
+  //! @param prefixes attribute prefixes to index
+  //----------------------------------------------------------------------------
+  QuarkPolicyIndex(qclient::QClient& qcl, MetadataFlusher* flusher,
+                   const std::vector<std::string>& prefixes = sDefaultPrefixes);
+
+  //----------------------------------------------------------------------------
+  //! Destructor
+  //----------------------------------------------------------------------------
+  virtual ~QuarkPolicyIndex() = default;
+
+  //----------------------------------------------------------------------------
+  //! Delete copy constructor and assignment operator
+  //----------------------------------------------------------------------------
+  QuarkPolicyIndex(const QuarkPolicyIndex& other) = delete;
+  QuarkPolicyIndex& operator=(const QuarkPolicyIndex& other) = delete;
+
+  //----------------------------------------------------------------------------
+  //! Notify me about the changes in the main view
+  //!
+  //! @param obj container object pointer
+  //! @param type action type
+  //----------------------------------------------------------------------------
+  void containerMDChanged(IContainerMD* obj, Action type) override;
+
+  //----------------------------------------------------------------------------
+  //! Reload the indexed containers from QuarkDB if the index was rebuilt
+  //! since it was last loaded
+  //!
+  //! @param qcl qclient object
+  //----------------------------------------------------------------------------
+  void ReloadIfRebuilt(qclient::QClient& qcl);
+
+  //----------------------------------------------------------------------------
+  //! Check if any of the attributes starts with the given prefix
+  //----------------------------------------------------------------------------
+  static bool HasPrefix(const IContainerMD::XAttrMap& xattrs,
+                        const std::string& prefix);
+
+  //----------------------------------------------------------------------------
+  //! Check if the index was built for the existing containers
+  //!
+  //! @param qcl qclient object
+  //!
+  //! @return true if ready, false if not built or QuarkDB is unreachable
+  //----------------------------------------------------------------------------
+  static bool IsReady(qclient::QClient& qcl);
+
+  //----------------------------------------------------------------------------
+  //! Get the ids of the containers indexed for the given prefix
+  //!
+  //! @param qcl qclient object
+  //! @param prefix attribute prefix
+  //! @param ids set filled with the container ids
+  //!
+  //! @return true if successful, otherwise false
+  //----------------------------------------------------------------------------
+  static bool GetContainers(qclient::QClient& qcl, const std::string& prefix,
+                            std::set<IContainerMD::id_t>& ids);
+
+private:
+  //----------------------------------------------------------------------------
+  //! Get the generation of the index, empty if it was never rebuilt
+  //----------------------------------------------------------------------------
+  static std::string GetGeneration(qclient::QClient& qcl);
+
+  //----------------------------------------------------------------------------
+  //! Add the containers currently in the QuarkDB sets to mIndexed
+  //!
+  //! @return true if successful, otherwise false
+  //----------------------------------------------------------------------------
+  bool Load(qclient::QClient& qcl);
+
+  MetadataFlusher* mFlusher;
+  const std::vector<std::string> mPrefixes; ///< Indexed attribute prefixes
+  std::mutex mMutex; ///< Protects mIndexed
+  //! Container ids indexed by attribute prefix, a superset of the contents
+  //! of the QuarkDB sets as of the last load
+  std::map<std::string, std::unordered_set<IContainerMD::id_t>> mIndexed;
+  std::string mGeneration; ///< Generation of the index as of the last load
+};
+
+EOSNSNAMESPACE_END
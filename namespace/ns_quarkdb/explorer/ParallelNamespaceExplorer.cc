@@ -0,0 +1,386 @@
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2023 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+#include "namespace/ns_quarkdb/explorer/ParallelNamespaceExplorer.hh"
+#include "namespace/ns_quarkdb/persistency/MetadataFetcher.hh"
+#include "namespace/interface/IView.hh"
+#include "namespace/utils/PathProcessor.hh"
+#include "namespace/utils/Attributes.hh"
+#include <algorithm>
+#include <iostream>
+
+EOSNSNAMESPACE_BEGIN
+
+//------------------------------------------------------------------------------
+// Constructor
+//------------------------------------------------------------------------------
+ParallelNamespaceExplorer::ParallelNamespaceExplorer(const std::string& path,
+    const ExplorationOptions& opts,
+    const ParallelExplorationOptions& parallelOpts,
+    qclient::QClient& qclient, folly::Executor* exec)
+  : options(opts), parallelOptions(parallelOpts), qcl(qclient),
+    executor(exec)
+{
+  if (options.populateLinkedAttributes && !opts.view) {
+    throw_mdexception(EINVAL,
+                      "ParallelNamespaceExplorer: asked to populate linked attrs, but view not provided");
+  }
+
+  if (parallelOptions.numWorkers == 0) {
+    parallelOptions.numWorkers = 1;
+  }
+
+  if (parallelOptions.maxLookahead == 0) {
+    parallelOptions.maxLookahead = 1;
+  }
+
+  if (parallelOptions.maxBufferedItems == 0) {
+    parallelOptions.maxBufferedItems = 1;
+  }
+
+  // Resolve the starting container synchronously, as the NamespaceExplorer
+  std::vector<std::string> pathParts;
+  eos::PathProcessor::splitPath(pathParts, path);
+  Task start {ContainerIdentifier(1), ContainerIdentifier(1), "/"};
+
+  for (size_t i = 0; i < pathParts.size(); i++) {
+    ContainerIdentifier parentId = start.id;
+
+    try {
+      start.id = MetadataFetcher::getContainerIDFromName(qcl, parentId,
+                 pathParts[i]).get();
+      start.expectedParent = parentId;
+      start.fullPath += pathParts[i] + "/";
+    } catch (const MDException& exc) {
+      // Maybe the last chunk is a file - search on a single file
+      if ((i != pathParts.size() - 1) || (exc.getErrno() != ENOENT)) {
+        throw;
+      }
+
+      // This may throw again, propagate to caller if so
+      FileIdentifier fileId = MetadataFetcher::getFileIDFromName(qcl, parentId,
+                              pathParts[i]).get();
+      NamespaceItem item;
+      item.isFile = true;
+      item.expansionFilteredOut = false;
+      item.fileMd = MetadataFetcher::getFileFromId(qcl, fileId).get();
+      item.fullPath = start.fullPath + item.fileMd.name();
+      current.emplace_back(std::move(item));
+      finished = true;
+      return;
+    }
+  }
+
+  pending.emplace(TaskKey(), std::move(start));
+
+  for (size_t i = 0; i < parallelOptions.numWorkers; ++i) {
+    workers.emplace_back(&ParallelNamespaceExplorer::workerLoop, this);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Destructor
+//------------------------------------------------------------------------------
+ParallelNamespaceExplorer::~ParallelNamespaceExplorer()
+{
+  {
+    std::unique_lock<std::mutex> lock(mtx);
+    stop = true;
+  }
+  cv.notify_all();
+
+  for (auto& worker : workers) {
+    worker.join();
+  }
+}
+
+//------------------------------------------------------------------------------
+// Worker thread loop
+//------------------------------------------------------------------------------
+void ParallelNamespaceExplorer::workerLoop()
+{
+  std::unique_lock<std::mutex> lock(mtx);
+
+  while (true) {
+    // Respect the look-ahead and the buffered items, unless the consumer
+    // waits for the next task
+    cv.wait(lock, [this]() {
+      return stop || (!pending.empty() &&
+                      (((inFlight + ready.size() < parallelOptions.maxLookahead) &&
+                        (buffered < parallelOptions.maxBufferedItems)) ||
+                       (parallelOptions.ordered && pending.begin()->first == awaited)));
+    });
+
+    if (stop) {
+      break;
+    }
+
+    // Smallest key first, the exploration follows the consumer
+    TaskKey key = pending.begin()->first;
+    Task task = std::move(pending.begin()->second);
+    pending.erase(pending.begin());
+    ++inFlight;
+    lock.unlock();
+    std::vector<Task> children;
+    Result result = explore(task, children);
+    result.numChildren = children.size();
+    lock.lock();
+    --inFlight;
+
+    for (size_t i = 0; i < children.size(); ++i) {
+      TaskKey childKey = key;
+      childKey.push_back(i);
+      pending.emplace(std::move(childKey), std::move(children[i]));
+    }
+
+    buffered += result.items.size();
+    peakBuffered = std::max(peakBuffered, buffered);
+    ready.emplace(std::move(key), std::move(result));
+    cv.notify_all();
+  }
+}
+
+//------------------------------------------------------------------------------
+// Explore a single container
+//------------------------------------------------------------------------------
+ParallelNamespaceExplorer::Result
+ParallelNamespaceExplorer::explore(const Task& task,
+                                   std::vector<Task>& children)
+{
+  Result result;
+  // Send off all the requests of this container at once
+  auto containerMd = MetadataFetcher::getContainerFromId(qcl, task.id);
+  auto containerMap = MetadataFetcher::getContainerMap(qcl, task.id);
+  FutureVectorIterator<eos::ns::FileMdProto> fileMds;
+
+  if (!options.ignoreFiles) {
+    fileMds = MetadataFetcher::getFileMDsInContainer(qcl, task.id, executor);
+  }
+
+  NamespaceItem item;
+  IContainerMD::ContainerMap subcontainers;
+
+  try {
+    item.containerMd = std::move(containerMd).get();
+    subcontainers = std::move(containerMap).get();
+  } catch (...) {
+    // Skipped, as done by the NamespaceExplorer
+    return result;
+  }
+
+  if (item.containerMd.parent_id() != task.expectedParent.getUnderlyingUInt64()) {
+    std::cerr << "WARNING: Container #" << item.containerMd.id() <<
+              " was expected to have #" <<
+              task.expectedParent.getUnderlyingUInt64() <<
+              " as parent; instead it has #" << item.containerMd.parent_id()
+              << std::endl;
+  }
+
+  item.isFile = false;
+  item.fullPath = task.fullPath;
+
+  try {
+    item.numFiles = fileMds.size();
+  } catch (...) {
+    item.numFiles = 0;
+  }
+
+  item.numContainers = subcontainers.size();
+  handleLinkedAttrs(item);
+
+  if (!options.expansionDecider) {
+    item.expansionFilteredOut = false;
+  } else {
+    item.expansionFilteredOut = !options.expansionDecider->shouldExpandContainer(
+                                  item.containerMd, item.attrs);
+  }
+
+  bool expand = !item.expansionFilteredOut;
+  result.items.emplace_back(std::move(item));
+
+  if (!expand) {
+    return result;
+  }
+
+  while (true) {
+    NamespaceItem fileItem;
+
+    try {
+      if (!fileMds.fetchNext(fileItem.fileMd)) {
+        break;
+      }
+    } catch (const MDException& exc) {
+      continue;
+    } catch (...) {
+      // File list could not be retrieved
+      break;
+    }
+
+    fileItem.isFile = true;
+    fileItem.fullPath = task.fullPath + fileItem.fileMd.name();
+    fileItem.expansionFilteredOut = false;
+    handleLinkedAttrs(fileItem);
+    result.items.emplace_back(std::move(fileItem));
+  }
+
+  std::vector<std::pair<std::string, IContainerMD::id_t>> sorted(
+    subcontainers.begin(), subcontainers.end());
+  std::sort(sorted.begin(), sorted.end());
+
+  for (const auto& elem : sorted) {
+    children.push_back(Task {task.id, ContainerIdentifier(elem.second),
+                             task.fullPath + elem.first + "/"});
+  }
+
+  return result;
+}
+
+//------------------------------------------------------------------------------
+// Move the awaited key to the next container in depth-first order
+//------------------------------------------------------------------------------
+void ParallelNamespaceExplorer::advance(uint32_t numChildren)
+{
+  if (numChildren > 0) {
+    awaited.push_back(0);
+    awaitedSiblings.push_back(numChildren);
+    return;
+  }
+
+  while (!awaited.empty()) {
+    if (awaited.back() + 1 < awaitedSiblings.back()) {
+      ++awaited.back();
+      return;
+    }
+
+    awaited.pop_back();
+    awaitedSiblings.pop_back();
+  }
+
+  finished = true;
+}
+
+//------------------------------------------------------------------------------
+// Fetch next item
+//------------------------------------------------------------------------------
+bool ParallelNamespaceExplorer::fetch(NamespaceItem& item)
+{
+  std::unique_lock<std::mutex> lock(mtx);
+
+  while (true) {
+    if (!current.empty()) {
+      item = std::move(current.front());
+      current.pop_front();
+      return true;
+    }
+
+    if (finished) {
+      return false;
+    }
+
+    std::map<TaskKey, Result>::iterator it;
+
+    if (parallelOptions.ordered) {
+      cv.wait(lock, [&]() {
+        it = ready.find(awaited);
+        return (it != ready.end());
+      });
+    } else {
+      cv.wait(lock, [this]() {
+        return (!ready.empty() || (pending.empty() && !inFlight));
+      });
+
+      if (ready.empty()) {
+        finished = true;
+        continue;
+      }
+
+      it = ready.begin();
+    }
+
+    current = std::move(it->second.items);
+    buffered -= current.size();
+    uint32_t numChildren = it->second.numChildren;
+    ready.erase(it);
+
+    if (parallelOptions.ordered) {
+      advance(numChildren);
+    }
+
+    // Room for more look-ahead
+    cv.notify_all();
+  }
+}
+
+//------------------------------------------------------------------------------
+// Get the peak number of items which were waiting to be consumed
+//------------------------------------------------------------------------------
+size_t ParallelNamespaceExplorer::getPeakBufferedItems()
+{
+  std::unique_lock<std::mutex> lock(mtx);
+  return peakBuffered;
+}
+
+//------------------------------------------------------------------------------
+// Handle linked attributes
+//------------------------------------------------------------------------------
+void ParallelNamespaceExplorer::handleLinkedAttrs(NamespaceItem& result)
+{
+  const google::protobuf::Map<std::string, std::string>& attrMap =
+    (result.isFile ? result.fileMd.xattrs() : result.containerMd.xattrs());
+  result.attrs = {attrMap.begin(), attrMap.end()};
+
+  if (!options.populateLinkedAttributes) {
+    return;
+  }
+
+  auto link = attrMap.find("sys.attr.link");
+
+  if (link == attrMap.end()) {
+    return;
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(attrsMtx);
+    auto cached = cachedAttrs.find(link->second);
+
+    if (cached != cachedAttrs.end()) {
+      populateLinkedAttributes(cached->second, result.attrs, options.prefixLinks);
+      return;
+    }
+  }
+
+  eos::IContainerMD::XAttrMap toStoreIntoCache;
+
+  try {
+    FileOrContainerMD linked = options.view->getItem(link->second, true).get();
+
+    if (linked.file) {
+      toStoreIntoCache = linked.file->getAttributes();
+    } else {
+      toStoreIntoCache = linked.container->getAttributes();
+    }
+  } catch (eos::MDException& e) {
+    // toStoreIntoCache remains empty
+  }
+
+  populateLinkedAttributes(toStoreIntoCache, result.attrs, options.prefixLinks);
+  std::unique_lock<std::mutex> lock(attrsMtx);
+  cachedAttrs.emplace(link->second, std::move(toStoreIntoCache));
+}
+
+EOSNSNAMESPACE_END
@@ -0,0 +1,172 @@
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2023 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+//------------------------------------------------------------------------------
+//! @file ParallelNamespaceExplorer.hh
+//! @brief Class for exploring the namespace using multiple workers
+//------------------------------------------------------------------------------
+
+#pragma once
+#include "namespace/ns_quarkdb/explorer/NamespaceExplorer.hh"
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+
+EOSNSNAMESPACE_BEGIN
+
+struct ParallelExplorationOptions {
+  //----------------------------------------------------------------------------
+  // Number of worker threads, each one exploring a container at a time
+  //----------------------------------------------------------------------------
+  size_t numWorkers = 8;
+
+  //----------------------------------------------------------------------------
+  // Max number of containers being explored or waiting to be consumed, the
+  // workers pause when the consumer falls behind
+  //----------------------------------------------------------------------------
+  size_t maxLookahead = 1024;
+
+  //----------------------------------------------------------------------------
+  // Max number of items (containers and files) of the explored containers
+  // waiting to be consumed. No new container is explored above it, so the
+  // buffer can exceed it by the size of the containers being explored.
+  //----------------------------------------------------------------------------
+  size_t maxBufferedItems = 100000;
+
+  //----------------------------------------------------------------------------
+  // Return the items in the same order as the NamespaceExplorer (depth-first,
+  // children sorted by name), otherwise in the order they become available
+  //----------------------------------------------------------------------------
+  bool ordered = true;
+};
+
+//------------------------------------------------------------------------------
+//! Class to recursively explore the QuarkDB namespace, starting from some
+//! path, with the same semantics as the NamespaceExplorer. Containers are
+//! explored by a pool of workers, each one fetching the metadata, file
+//! metadata and children of one container at a time, and the results are
+//! handed over to the consumer through a bounded buffer.
+//!
+//! Every worker is a separate QuarkDB round-trip pipeline, hence the speedup
+//! for deep or wide trees. The ExpansionDecider is called concurrently by the
+//! workers and has to be thread safe.
+//------------------------------------------------------------------------------
+class ParallelNamespaceExplorer
+{
+public:
+  //----------------------------------------------------------------------------
+  //! Inject the QClient to use directly in the constructor. No ownership of
+  //! underlying object.
+  //----------------------------------------------------------------------------
+  ParallelNamespaceExplorer(const std::string& path,
+                            const ExplorationOptions& options,
+                            const ParallelExplorationOptions& parallelOptions,
+                            qclient::QClient& qcl, folly::Executor* exec);
+
+  //----------------------------------------------------------------------------
+  //! Destructor - stops the workers, even if the search is not over
+  //----------------------------------------------------------------------------
+  ~ParallelNamespaceExplorer();
+
+  //----------------------------------------------------------------------------
+  //! Don't allow copy or move of these objects
+  //----------------------------------------------------------------------------
+  ParallelNamespaceExplorer(const ParallelNamespaceExplorer&) = delete;
+  ParallelNamespaceExplorer& operator=(const ParallelNamespaceExplorer&) =
+    delete;
+
+  //----------------------------------------------------------------------------
+  //! Fetch next item.
+  //----------------------------------------------------------------------------
+  bool fetch(NamespaceItem& result);
+
+  //----------------------------------------------------------------------------
+  //! Get the peak number of items which were waiting to be consumed
+  //----------------------------------------------------------------------------
+  size_t getPeakBufferedItems();
+
+private:
+  //! Position of a container in the depth-first order: index of the container
+  //! among its siblings, for every level below the starting container. The
+  //! lexicographic order of the keys is the depth-first order.
+  using TaskKey = std::vector<uint32_t>;
+
+  //! Container to explore
+  struct Task {
+    ContainerIdentifier expectedParent;
+    ContainerIdentifier id;
+    std::string fullPath;
+  };
+
+  //! Items found by exploring a container
+  struct Result {
+    std::deque<NamespaceItem> items;
+    uint32_t numChildren = 0;
+  };
+
+  ExplorationOptions options;
+  ParallelExplorationOptions parallelOptions;
+  qclient::QClient& qcl;
+  folly::Executor* executor;
+
+  std::mutex mtx; ///< Protects all the members below
+  std::condition_variable cv;
+  std::map<TaskKey, Task> pending; ///< Containers waiting for a worker
+  std::map<TaskKey, Result> ready; ///< Results waiting for the consumer
+  size_t inFlight = 0;
+  size_t buffered = 0; ///< Number of items in ready
+  size_t peakBuffered = 0;
+  bool stop = false;
+  bool finished = false;
+  TaskKey awaited; ///< Next key in ordered mode
+  std::vector<uint32_t> awaitedSiblings; ///< Number of siblings at each level
+  std::deque<NamespaceItem> current; ///< Items being handed to the consumer
+  std::vector<std::thread> workers;
+
+  std::mutex attrsMtx; ///< Protects cachedAttrs
+  std::map<std::string, eos::IContainerMD::XAttrMap> cachedAttrs;
+
+  //----------------------------------------------------------------------------
+  //! Worker thread loop
+  //----------------------------------------------------------------------------
+  void workerLoop();
+
+  //----------------------------------------------------------------------------
+  //! Explore a single container
+  //!
+  //! @param task container to explore
+  //! @param children filled with the child containers, sorted by name
+  //!
+  //! @return container item followed by its file items, nothing if the
+  //!         container could not be fetched
+  //----------------------------------------------------------------------------
+  Result explore(const Task& task, std::vector<Task>& children);
+
+  //----------------------------------------------------------------------------
+  //! Move the awaited key to the next container in depth-first order
+  //----------------------------------------------------------------------------
+  void advance(uint32_t numChildren);
+
+  //----------------------------------------------------------------------------
+  //! Handle linked attributes, same as NamespaceExplorer::handleLinkedAttrs
+  //----------------------------------------------------------------------------
+  void handleLinkedAttrs(NamespaceItem& result);
+};
+
+EOSNSNAMESPACE_END
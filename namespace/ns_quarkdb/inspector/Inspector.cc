@@ -29,6 +29,7 @@
 #include "namespace/ns_quarkdb/persistency/RequestBuilder.hh"
 #include "namespace/ns_quarkdb/persistency/FileSystemIterator.hh"
 #include "namespace/ns_quarkdb/accounting/FileSystemHandler.hh"
+#include "namespace/ns_quarkdb/accounting/PolicyIndex.hh"
 #include "namespace/ns_quarkdb/Constants.hh"
 #include "namespace/utils/Checksum.hh"
 #include "namespace/Constants.hh"
@@ -2091,6 +2092,111 @@ int Inspector::renameFid(bool dryRun, uint64_t fid, uint64_t newParent,
   return 0;
 }
 
+//------------------------------------------------------------------------------
+// Rebuild the index of containers holding policy attributes
+//------------------------------------------------------------------------------
+int Inspector::rebuildPolicyIndex(bool dryRun, std::ostream& out,
+                                  std::ostream& err)
+{
+  const size_t kMaxItemsPerRequest = 10000;
+  std::map<std::string, std::set<IContainerMD::id_t>> expected;
+  ContainerScanner containerScanner(mQcl);
+
+  while (containerScanner.valid()) {
+    eos::ns::ContainerMdProto proto;
+
+    if (!containerScanner.getItem(proto)) {
+      break;
+    }
+
+    IContainerMD::XAttrMap xattrs(proto.xattrs().begin(), proto.xattrs().end());
+
+    for (const auto& prefix : QuarkPolicyIndex::sDefaultPrefixes) {
+      if (QuarkPolicyIndex::HasPrefix(xattrs, prefix)) {
+        expected[prefix].insert(proto.id());
+      }
+    }
+
+    containerScanner.next();
+  }
+
+  std::string errorString;
+
+  if (containerScanner.hasError(errorString)) {
+    err << errorString << std::endl;
+    return 1;
+  }
+
+  std::vector<RedisRequest> requests;
+
+  for (const auto& prefix : QuarkPolicyIndex::sDefaultPrefixes) {
+    std::set<IContainerMD::id_t> current;
+
+    if (!QuarkPolicyIndex::GetContainers(mQcl, prefix, current)) {
+      err << "Could not scan the current policy index for prefix " << prefix
+          << std::endl;
+      return 1;
+    }
+
+    const std::string key = RequestBuilder::keyPolicyIndex(prefix);
+    const auto& target = expected[prefix];
+    out << "Prefix " << prefix << ": " << target.size()
+        << " containers, currently indexed " << current.size() << std::endl;
+    RedisRequest sadd { "SADD", key };
+
+    for (auto id : target) {
+      if (current.find(id) == current.end()) {
+        sadd.emplace_back(std::to_string(id));
+
+        if (sadd.size() - 2 >= kMaxItemsPerRequest) {
+          requests.emplace_back(std::move(sadd));
+          sadd = { "SADD", key };
+        }
+      }
+    }
+
+    if (sadd.size() > 2) {
+      requests.emplace_back(std::move(sadd));
+    }
+
+    RedisRequest srem { "SREM", key };
+
+    for (auto id : current) {
+      if (target.find(id) != target.end()) {
+        continue;
+      }
+
+      // The MGM might have indexed the container while we were scanning,
+      // check again before dropping it
+      try {
+        eos::ns::ContainerMdProto proto = MetadataFetcher::getContainerFromId(
+                                            mQcl, ContainerIdentifier(id)).get();
+        IContainerMD::XAttrMap xattrs(proto.xattrs().begin(), proto.xattrs().end());
+
+        if (QuarkPolicyIndex::HasPrefix(xattrs, prefix)) {
+          continue;
+        }
+      } catch (const MDException& e) {
+        // Container is gone
+      }
+
+      srem.emplace_back(std::to_string(id));
+    }
+
+    if (srem.size() > 2) {
+      requests.emplace_back(std::move(srem));
+    }
+  }
+
+  requests.emplace_back(RedisRequest { "HSET", constants::sMapMetaInfoKey,
+                                       policyindex::sReadyField, "1" });
+  // Tells the running MGM to reload its view of the index
+  requests.emplace_back(RedisRequest { "HINCRBY", constants::sMapMetaInfoKey,
+                                       policyindex::sGenerationField, "1" });
+  executeRequestBatch(requests, {}, dryRun, out, err);
+  return 0;
+}
+
 //------------------------------------------------------------------------------
 // Run the given write batch towards QDB - print the requests, as well as the
 // output.
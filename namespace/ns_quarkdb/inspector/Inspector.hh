@@ -177,6 +177,12 @@ public:
   //------------------------------------------------------------------------------
   int dropEmptyCid(bool dryRun, uint64_t cid);
 
+  //----------------------------------------------------------------------------
+  //! Rebuild the index of containers holding policy attributes, used by the
+  //! LRU to avoid scanning the whole namespace, and mark it as ready
+  //----------------------------------------------------------------------------
+  int rebuildPolicyIndex(bool dryRun, std::ostream& out, std::ostream& err);
+
   //----------------------------------------------------------------------------
   //! Change the given fid - USE WITH CAUTION
   //----------------------------------------------------------------------------
@@ -40,7 +40,11 @@ EOSNSNAMESPACE_BEGIN
 QuarkContainerMDSvc::QuarkContainerMDSvc(qclient::QClient* qcl,
     MetadataFlusher* flusher)
   : pQuotaStats(nullptr), pFileSvc(nullptr), pQcl(qcl), pFlusher(flusher),
-    mMetaMap(), mMetadataProvider(nullptr), mNumConts(0ull) {}
+    mMetaMap(), mMetadataProvider(nullptr), mNumConts(0ull),
+    mDentryCache(new DentryCache())
+{
+  addChangeListener(mDentryCache.get());
+}
 
 //------------------------------------------------------------------------------
 // Destructor
@@ -69,6 +73,11 @@ QuarkContainerMDSvc::configure(const std::map<std::string, std::string>& config)
       mMetadataProvider->setContainerMDCacheNum(std::stoull(mCacheNum));
     }
   }
+
+  if (config.find(constants::sMaxNumCacheDentries) != config.end()) {
+    mDentryCache->setMaxNum(std::stoull(config.at(
+                              constants::sMaxNumCacheDentries)));
+  }
 }
 
 //------------------------------------------------------------------------------
@@ -191,6 +200,8 @@ QuarkContainerMDSvc::getContainerMD(IContainerMD::id_t id, uint64_t* clock)
 bool
 QuarkContainerMDSvc::dropCachedContainerMD(ContainerIdentifier id)
 {
+  // Cached lookups might go through any entry of the dropped container
+  notifyListeners(id, "");
   return mMetadataProvider->dropCachedContainerID(id);
 }
 
@@ -256,6 +267,7 @@ QuarkContainerMDSvc::removeContainer(IContainerMD* obj)
   }
 
   obj->setDeleted();
+  notifyListeners(obj, IContainerMDChangeListener::Deleted);
 
   if (mNumConts) {
     --mNumConts;
@@ -355,6 +367,18 @@ QuarkContainerMDSvc::notifyListeners(IContainerMD* obj,
   }
 }
 
+//------------------------------------------------------------------------------
+// Notify the listeners about the change of an entry in the container
+//------------------------------------------------------------------------------
+void
+QuarkContainerMDSvc::notifyListeners(ContainerIdentifier parent,
+                                     const std::string& name)
+{
+  for (const auto& elem : pListeners) {
+    elem->containerMDChildChanged(parent, name);
+  }
+}
+
 //------------------------------------------------------------------------------
 // Get first free container id
 //------------------------------------------------------------------------------
@@ -373,6 +397,15 @@ QuarkContainerMDSvc::getCacheStatistics()
   return mMetadataProvider->getContainerMDCacheStats();
 }
 
+//------------------------------------------------------------------------------
+// Retrieve dentry cache statistics
+//------------------------------------------------------------------------------
+CacheStatistics
+QuarkContainerMDSvc::getDentryCacheStatistics()
+{
+  return mDentryCache->getStatistics();
+}
+
 //------------------------------------------------------------------------------
 // Blacklist IDs below the given threshold
 //------------------------------------------------------------------------------
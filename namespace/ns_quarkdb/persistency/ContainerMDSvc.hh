@@ -27,6 +27,7 @@
 #include "namespace/interface/IContainerMD.hh"
 #include "namespace/interface/IContainerMDSvc.hh"
 #include "namespace/ns_quarkdb/Constants.hh"
+#include "namespace/ns_quarkdb/persistency/DentryCache.hh"
 #include "namespace/ns_quarkdb/persistency/NextInodeProvider.hh"
 #include "namespace/ns_quarkdb/persistency/UnifiedInodeProvider.hh"
 #include "namespace/ns_quarkdb/accounting/QuotaStats.hh"
@@ -196,6 +197,20 @@ public:
   //----------------------------------------------------------------------------
   virtual CacheStatistics getCacheStatistics() override;
 
+  //----------------------------------------------------------------------------
+  //! Retrieve dentry cache statistics
+  //----------------------------------------------------------------------------
+  virtual CacheStatistics getDentryCacheStatistics() override;
+
+  //----------------------------------------------------------------------------
+  //! Get the path lookup cache, kept up to date by this service
+  //----------------------------------------------------------------------------
+  DentryCache*
+  getDentryCache()
+  {
+    return mDentryCache.get();
+  }
+
   //----------------------------------------------------------------------------
   //! Blacklist IDs below the given threshold
   //----------------------------------------------------------------------------
@@ -220,6 +235,12 @@ private:
   void notifyListeners(IContainerMD* obj, IContainerMDChangeListener::Action a)
   override;
 
+  //----------------------------------------------------------------------------
+  //! Notify the listeners about the change of an entry in the container
+  //----------------------------------------------------------------------------
+  void notifyListeners(ContainerIdentifier parent, const std::string& name)
+  override;
+
   //----------------------------------------------------------------------------
   //! Safety check to make sure there are no container entries in the backend
   //! with ids bigger than the max container id. If there is any problem this
@@ -239,6 +260,7 @@ private:
   std::atomic<uint64_t> mNumConts;      ///< Total number of containers
   std::string
   mCacheNum;                ///< Temporary workaround to store cache size
+  std::unique_ptr<DentryCache> mDentryCache; ///< Path lookup cache
 };
 
 EOSNSNAMESPACE_END
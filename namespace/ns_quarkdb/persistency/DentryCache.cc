@@ -0,0 +1,334 @@
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2023 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+#include "namespace/ns_quarkdb/persistency/DentryCache.hh"
+#include "namespace/interface/IContainerMD.hh"
+
+EOSNSNAMESPACE_BEGIN
+
+//------------------------------------------------------------------------------
+// Constructor
+//------------------------------------------------------------------------------
+DentryCache::DentryCache(uint64_t max_num):
+  mMaxNum(max_num)
+{}
+
+//------------------------------------------------------------------------------
+// Set max number of entries
+//------------------------------------------------------------------------------
+void
+DentryCache::setMaxNum(uint64_t max_num)
+{
+  std::unique_lock<std::shared_timed_mutex> lock(mMutex);
+
+  if ((max_num == 0ull) || (max_num == UINT64_MAX)) {
+    clear();
+    mChildEpochs.fill(++mEpoch);
+
+    if (max_num == 0ull) {
+      mMaxNum = 0ull;
+    }
+
+    return;
+  }
+
+  mMaxNum = max_num;
+  evict();
+}
+
+//------------------------------------------------------------------------------
+// Find the longest cached prefix of the given path
+//------------------------------------------------------------------------------
+size_t
+DentryCache::lookup(const std::deque<std::string>& chunks, Entry& entry,
+                    Tracker& tracker)
+{
+  tracker = Tracker();
+
+  if (chunks.empty()) {
+    return 0;
+  }
+
+  std::string path;
+
+  for (const auto& chunk : chunks) {
+    path += "/";
+    path += chunk;
+  }
+
+  std::shared_lock<std::shared_timed_mutex> lock(mMutex);
+
+  if (mMaxNum == 0ull) {
+    return 0;
+  }
+
+  tracker.active = true;
+  tracker.epoch = mEpoch;
+
+  for (size_t depth = chunks.size(); depth > 0; --depth) {
+    auto it = mEntries.find(path);
+
+    if (it != mEntries.end()) {
+      entry = it->second.entry;
+
+      if (!it->second.referenced.load(std::memory_order_relaxed)) {
+        it->second.referenced.store(true, std::memory_order_relaxed);
+      }
+
+      // A negative prefix resolves the whole lookup as well
+      ++(((depth == chunks.size()) || (entry.kind == Kind::Negative)) ?
+         mHits : mMisses);
+      tracker.path = std::move(path);
+      return depth;
+    }
+
+    path.resize(path.rfind('/'));
+  }
+
+  ++mMisses;
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+// Insert the result of a lookup
+//------------------------------------------------------------------------------
+void
+DentryCache::insert(const Tracker& tracker, const Entry& entry)
+{
+  // The root itself is never cached
+  if (!tracker.active || tracker.path.empty()) {
+    return;
+  }
+
+  std::unique_lock<std::shared_timed_mutex> lock(mMutex);
+
+  if (mMaxNum == 0ull) {
+    return;
+  }
+
+  auto it = mEntries.find(tracker.path);
+
+  if (it != mEntries.end()) {
+    if ((it->second.entry.kind == entry.kind) &&
+        (it->second.entry.id == entry.id)) {
+      it->second.referenced = true;
+      return;
+    }
+
+    dropSubtree(tracker.path, true);
+  }
+
+  if (entry.kind == Kind::Container) {
+    // A container can only be in one place, drop any outdated location
+    auto cit = mContainerPaths.find(entry.id);
+
+    if (cit != mContainerPaths.end()) {
+      dropSubtree(std::string(cit->second), true);
+    }
+  }
+
+  // Invalidations find the cached entries through their parent container
+  const std::string parent = tracker.path.substr(0, tracker.path.rfind('/'));
+  Node* parent_node = nullptr;
+  uint64_t parent_id = 1;
+
+  if (!parent.empty()) {
+    auto pit = mEntries.find(parent);
+
+    if ((pit == mEntries.end()) ||
+        (pit->second.entry.kind != Kind::Container)) {
+      return;
+    }
+
+    parent_node = &pit->second;
+    parent_id = parent_node->entry.id;
+  }
+
+  if (mChildEpochs[parent_id % mChildEpochs.size()] > tracker.epoch) {
+    return;
+  }
+
+  it = mEntries.try_emplace(tracker.path).first;
+  Node& node = it->second;
+  node.entry = entry;
+  node.parent = parent_node;
+  mLru.push_front(&it->first);
+  node.lruPos = mLru.begin();
+
+  if (parent_node) {
+    ++parent_node->numChildren;
+  }
+
+  if (entry.kind == Kind::Container) {
+    mContainerPaths[entry.id] = tracker.path;
+  }
+
+  evict();
+}
+
+//------------------------------------------------------------------------------
+// Evict entries until the cache is within its limit
+//------------------------------------------------------------------------------
+void
+DentryCache::evict()
+{
+  // Every full pass clears the referenced flags, so a leaf is evicted at the
+  // latest during the second pass
+  while (mEntries.size() > mMaxNum) {
+    auto it = mEntries.find(*mLru.back());
+    Node& node = it->second;
+
+    if (node.numChildren || node.referenced) {
+      node.referenced = false;
+      mLru.splice(mLru.begin(), mLru, node.lruPos);
+      continue;
+    }
+
+    erase(it);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Container notifications - drop deleted containers
+//------------------------------------------------------------------------------
+void
+DentryCache::containerMDChanged(IContainerMD* obj, Action type)
+{
+  if (type != IContainerMDChangeListener::Deleted) {
+    return;
+  }
+
+  std::unique_lock<std::shared_timed_mutex> lock(mMutex);
+  invalidate(obj->getId());
+  auto it = mContainerPaths.find(obj->getId());
+
+  if (it != mContainerPaths.end()) {
+    dropSubtree(std::string(it->second), true);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Container notifications - drop the changed entry
+//------------------------------------------------------------------------------
+void
+DentryCache::containerMDChildChanged(ContainerIdentifier parent,
+                                     const std::string& name)
+{
+  std::unique_lock<std::shared_timed_mutex> lock(mMutex);
+  invalidate(parent.getUnderlyingUInt64());
+  std::string path;
+
+  if (parent.getUnderlyingUInt64() != 1) {
+    auto it = mContainerPaths.find(parent.getUnderlyingUInt64());
+
+    if (it == mContainerPaths.end()) {
+      // Nothing cached below this container
+      return;
+    }
+
+    path = it->second;
+  }
+
+  if (name.empty()) {
+    dropSubtree(path, false);
+  } else {
+    dropSubtree(path + "/" + name, true);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Get cache statistics
+//------------------------------------------------------------------------------
+CacheStatistics
+DentryCache::getStatistics()
+{
+  CacheStatistics stats;
+  std::shared_lock<std::shared_timed_mutex> lock(mMutex);
+  stats.enabled = (mMaxNum != 0ull);
+  stats.maxNum = mMaxNum;
+  stats.occupancy = mEntries.size();
+  stats.hits = mHits;
+  stats.misses = mMisses;
+  return stats;
+}
+
+//------------------------------------------------------------------------------
+// Drop the given path and everything cached below it
+//------------------------------------------------------------------------------
+void
+DentryCache::dropSubtree(const std::string& path, bool self)
+{
+  // Entries below the path are contiguous in the map, with every entry after
+  // its parent. Erase them backwards so that children go before parents.
+  const std::string prefix = path + "/";
+  auto last = mEntries.lower_bound(prefix);
+  size_t count = 0;
+
+  while ((last != mEntries.end()) &&
+         (last->first.compare(0, prefix.length(), prefix) == 0)) {
+    ++last;
+    ++count;
+  }
+
+  for (; count > 0; --count) {
+    erase(std::prev(last));
+  }
+
+  if (self) {
+    auto it = mEntries.find(path);
+
+    if (it != mEntries.end()) {
+      erase(it);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// Remove a single entry
+//------------------------------------------------------------------------------
+void
+DentryCache::erase(Map::iterator it)
+{
+  if (it->second.entry.kind == Kind::Container) {
+    auto cit = mContainerPaths.find(it->second.entry.id);
+
+    if ((cit != mContainerPaths.end()) && (cit->second == it->first)) {
+      mContainerPaths.erase(cit);
+    }
+  }
+
+  if (it->second.parent) {
+    --it->second.parent->numChildren;
+  }
+
+  mLru.erase(it->second.lruPos);
+  mEntries.erase(it);
+}
+
+//------------------------------------------------------------------------------
+// Drop all entries
+//------------------------------------------------------------------------------
+void
+DentryCache::clear()
+{
+  mEntries.clear();
+  mLru.clear();
+  mContainerPaths.clear();
+}
+
+EOSNSNAMESPACE_END
@@ -0,0 +1,220 @@
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2023 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+//------------------------------------------------------------------------------
+//! @file DentryCache.hh
+//! @brief Cache of path to file / container id lookups, including negative
+//!        entries for paths which do not exist
+//------------------------------------------------------------------------------
+
+#pragma once
+#include "namespace/Namespace.hh"
+#include "namespace/interface/IContainerMDSvc.hh"
+#include "namespace/interface/Misc.hh"
+#include <array>
+#include <atomic>
+#include <deque>
+#include <list>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+EOSNSNAMESPACE_BEGIN
+
+//------------------------------------------------------------------------------
+//! Bounded LRU cache mapping absolute paths to the id of the file or container
+//! found there, or to the knowledge that nothing exists there.
+//!
+//! Entries are invalidated through the container change listener interface:
+//! adding or removing an entry with a given name in a container drops the
+//! cached path and everything cached below it, which covers create, unlink
+//! and rename (remove + add). To be able to map a container id to a path,
+//! the parent container of every cached entry is itself cached - evicting a
+//! container drops its cached subtree.
+//!
+//! Lookups which miss the cache record the invalidation epoch when they
+//! start. Their results are only inserted if the entries of the parent
+//! container were not invalidated in the meantime, otherwise a negative entry
+//! could be cached for a file that was created concurrently. The epoch of the
+//! last invalidation is kept per container id in a fixed size table, so that
+//! it also covers containers which are not cached, and changes in unrelated
+//! directories only collide on the same table slot.
+//!
+//! Lookups only take a shared lock and mark the entry they hit as referenced.
+//! Eviction follows the CLOCK algorithm on the insertion order list: a
+//! referenced entry gets a second chance and only entries without cached
+//! children are evicted, so that the ancestors of hot entries stay cached.
+//------------------------------------------------------------------------------
+class DentryCache : public IContainerMDChangeListener
+{
+public:
+  //! Type of cached entry
+  enum class Kind : uint8_t {
+    Negative,
+    File,
+    Container
+  };
+
+  //! Cached lookup result
+  struct Entry {
+    Kind kind = Kind::Negative;
+    uint64_t id = 0;
+  };
+
+  //----------------------------------------------------------------------------
+  //! Path of an ongoing lookup, used to insert its intermediate results
+  //----------------------------------------------------------------------------
+  struct Tracker {
+    bool active = false;
+    std::string path; ///< Path of the current lookup state, "" for root
+    uint64_t epoch = 0; ///< Invalidation epoch when the lookup started
+    bool fresh = false; ///< State of the path not inserted into the cache yet
+
+    //--------------------------------------------------------------------------
+    //! Move to the given child of the current path
+    //--------------------------------------------------------------------------
+    void descend(const std::string& name)
+    {
+      path += "/";
+      path += name;
+      fresh = true;
+    }
+  };
+
+  //----------------------------------------------------------------------------
+  //! Constructor
+  //!
+  //! @param max_num max number of cached entries, 0 disables the cache
+  //----------------------------------------------------------------------------
+  DentryCache(uint64_t max_num = 1'000'000);
+
+  //----------------------------------------------------------------------------
+  //! Destructor
+  //----------------------------------------------------------------------------
+  virtual ~DentryCache() = default;
+
+  //----------------------------------------------------------------------------
+  //! Set max number of entries
+  //!
+  //! @param max_num new maximum number of entries, if 0 then drop the cache
+  //!        and disable it, if UINT64_MAX then just drop the current cache
+  //----------------------------------------------------------------------------
+  void setMaxNum(uint64_t max_num);
+
+  //----------------------------------------------------------------------------
+  //! Find the longest cached prefix of the given path
+  //!
+  //! @param chunks path components, without "." or ".."
+  //! @param entry filled with the entry of the longest cached prefix
+  //! @param tracker set up to continue the lookup after that prefix
+  //!
+  //! @return number of path components covered by the cached entry, 0 if
+  //!         nothing cached (the lookup starts from the root)
+  //----------------------------------------------------------------------------
+  size_t lookup(const std::deque<std::string>& chunks, Entry& entry,
+                Tracker& tracker);
+
+  //----------------------------------------------------------------------------
+  //! Insert the result of a lookup, ignored if the tracker is not active, if
+  //! the entries of the parent container were invalidated since the lookup
+  //! started or if the parent path is not cached
+  //!
+  //! @param tracker path of the lookup state
+  //! @param entry lookup result
+  //----------------------------------------------------------------------------
+  void insert(const Tracker& tracker, const Entry& entry);
+
+  //----------------------------------------------------------------------------
+  //! Container notifications - drop deleted containers
+  //----------------------------------------------------------------------------
+  void containerMDChanged(IContainerMD* obj, Action type) override;
+
+  //----------------------------------------------------------------------------
+  //! Container notifications - drop the changed entry
+  //----------------------------------------------------------------------------
+  void containerMDChildChanged(ContainerIdentifier parent,
+                               const std::string& name) override;
+
+  //----------------------------------------------------------------------------
+  //! Get cache statistics
+  //----------------------------------------------------------------------------
+  CacheStatistics getStatistics();
+
+private:
+  //! CLOCK list of the cached paths, pointing to the keys of the map
+  using LruList = std::list<const std::string*>;
+
+  struct Node {
+    Entry entry;
+    LruList::iterator lruPos;
+    Node* parent = nullptr; ///< Node of the parent path, null at top level
+    uint64_t numChildren = 0; ///< Number of cached entries directly below
+    std::atomic<bool> referenced {false}; ///< Hit since the last CLOCK pass
+  };
+
+  using Map = std::map<std::string, Node>;
+
+  //----------------------------------------------------------------------------
+  //! Drop the given path and everything cached below it, lock must be held
+  //!
+  //! @param path path to drop
+  //! @param self if false, only drop the entries below the given path
+  //----------------------------------------------------------------------------
+  void dropSubtree(const std::string& path, bool self);
+
+  //----------------------------------------------------------------------------
+  //! Remove a single entry without cached children, lock must be held
+  //----------------------------------------------------------------------------
+  void erase(Map::iterator it);
+
+  //----------------------------------------------------------------------------
+  //! Evict entries until the cache is within its limit, lock must be held
+  //----------------------------------------------------------------------------
+  void evict();
+
+  //----------------------------------------------------------------------------
+  //! Drop all entries, lock must be held
+  //----------------------------------------------------------------------------
+  void clear();
+
+  //----------------------------------------------------------------------------
+  //! Record an invalidation of the entries of the given container, lock must
+  //! be held
+  //----------------------------------------------------------------------------
+  void invalidate(uint64_t container_id)
+  {
+    mChildEpochs[container_id % mChildEpochs.size()] = ++mEpoch;
+  }
+
+  //! Protects all members below, lookups take it shared
+  std::shared_timed_mutex mMutex;
+  uint64_t mMaxNum;
+  uint64_t mEpoch = 0; ///< Incremented on every invalidation
+  //! Epoch of the last invalidation of the entries of a container, by id
+  std::array<uint64_t, 4096> mChildEpochs {};
+  Map mEntries; ///< Cached entries, ordered so that subtrees are contiguous
+  LruList mLru; ///< Most recently inserted or spared entries first
+  //! Container id to path of the cached containers, root is ""
+  std::unordered_map<uint64_t, std::string> mContainerPaths;
+  std::atomic<uint64_t> mHits {0};
+  std::atomic<uint64_t> mMisses {0};
+};
+
+EOSNSNAMESPACE_END
@@ -161,6 +161,15 @@ std::string RequestBuilder::keyFilesystemUnlinked(IFileMD::location_t location)
   return fsview::sPrefix + std::to_string(location) + ":" + fsview::sUnlinkedSuffix;
 }
 
+//------------------------------------------------------------------------------
+//! Get key for the ids of containers holding attributes with the given
+//! policy prefix.
+//------------------------------------------------------------------------------
+std::string RequestBuilder::keyPolicyIndex(const std::string& attr_prefix)
+{
+  return policyindex::sPrefix + attr_prefix;
+}
+
 //------------------------------------------------------------------------------
 // Get container bucket
 //------------------------------------------------------------------------------
@@ -110,6 +110,12 @@ public:
   //----------------------------------------------------------------------------
   static std::string keyFilesystemUnlinked(IFileMD::location_t location);
 
+  //----------------------------------------------------------------------------
+  //! Get key for the ids of containers holding attributes with the given
+  //! policy prefix.
+  //----------------------------------------------------------------------------
+  static std::string keyPolicyIndex(const std::string& attr_prefix);
+
   //----------------------------------------------------------------------------
   //! Get container bucket which is computed as the id of the container modulo
   //! the number of container buckets.
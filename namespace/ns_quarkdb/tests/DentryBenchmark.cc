@@ -0,0 +1,132 @@
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2023 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+//------------------------------------------------------------------------------
+//! @brief Measure path lookups per second through the QuarkHierarchicalView
+//! for a deep path, with and without the dentry cache.
+//!
+//! Usage: eos-ns-dentry-benchmark <qdb_cluster> [depth] [iterations]
+//!
+//! The path is created below /dentry-benchmark/ if it does not exist yet.
+//! Use a QuarkDB instance dedicated to testing.
+//------------------------------------------------------------------------------
+
+#include "namespace/ns_quarkdb/flusher/MetadataFlusher.hh"
+#include "namespace/ns_quarkdb/NamespaceGroup.hh"
+#include "namespace/ns_quarkdb/Constants.hh"
+#include "namespace/interface/IContainerMDSvc.hh"
+#include "namespace/interface/IFileMDSvc.hh"
+#include "namespace/interface/IFsView.hh"
+#include "namespace/interface/IView.hh"
+#include "common/RWMutex.hh"
+#include <chrono>
+#include <iostream>
+
+namespace
+{
+//------------------------------------------------------------------------------
+// Look up the given path repeatedly and report the rate
+//------------------------------------------------------------------------------
+void Report(const std::string& label, eos::IView* view,
+            const std::string& path, size_t iterations)
+{
+  size_t nfound = 0;
+  auto start = std::chrono::steady_clock::now();
+
+  for (size_t i = 0; i < iterations; ++i) {
+    try {
+      view->getFile(path);
+      ++nfound;
+    } catch (const eos::MDException& e) {
+      // Expected for the missing path
+    }
+  }
+
+  double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() -
+               start).count();
+  std::cout << label << " lookups: " << iterations << " found: " << nfound
+            << " time: " << sec << "s lookups/s: " << (size_t)(iterations / sec)
+            << std::endl;
+}
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc < 2) {
+    std::cerr << "usage: " << argv[0] << " <qdb_cluster> [depth] [iterations]"
+              << std::endl;
+    return 1;
+  }
+
+  size_t depth = (argc > 2) ? strtoul(argv[2], 0, 10) : 32;
+  size_t iterations = (argc > 3) ? strtoul(argv[3], 0, 10) : 100000;
+  eos::common::RWMutex ns_mutex;
+  std::map<std::string, std::string> config = {
+    {"queue_path", "/tmp/eos-ns-dentry-benchmark/"},
+    {"qdb_cluster", argv[1]},
+    {"qdb_flusher_md", "dentry_benchmark_md"},
+    {"qdb_flusher_quota", "dentry_benchmark_quota"}
+  };
+  eos::QuarkNamespaceGroup group;
+  std::string err;
+
+  if (!group.initialize(&ns_mutex, config, err)) {
+    std::cerr << "error: " << err << std::endl;
+    return 1;
+  }
+
+  group.getFileService()->configure(config);
+  group.getContainerService()->configure(config);
+  group.getFilesystemView()->configure(config);
+  group.getHierarchicalView()->configure(config);
+  group.getHierarchicalView()->initialize();
+  eos::IView* view = group.getHierarchicalView();
+  std::string dir = "/dentry-benchmark/";
+
+  for (size_t i = 0; i < depth; ++i) {
+    dir += "level-" + std::to_string(i) + "/";
+  }
+
+  const std::string existing = dir + "file";
+  const std::string missing = dir + "missing";
+
+  try {
+    view->getFile(existing);
+  } catch (const eos::MDException& e) {
+    std::cout << "creating path depth=" << depth << std::endl;
+    view->createContainer(dir, true);
+    view->createFile(existing, true);
+    group.getMetadataFlusher()->synchronize();
+  }
+
+  for (const std::string max_num : {"1000000", "0"}) {
+    std::map<std::string, std::string> cache_config = {
+      {eos::constants::sMaxNumCacheDentries, max_num}
+    };
+    group.getContainerService()->configure(cache_config);
+    const std::string label = (max_num == "0" ? "no-cache" : "cache");
+    Report(label + " existing", view, existing, iterations);
+    Report(label + " missing", view, missing, iterations);
+    eos::CacheStatistics stats =
+      group.getContainerService()->getDentryCacheStatistics();
+    std::cout << label << " dentry cache hits: " << stats.hits << " misses: "
+              << stats.misses << std::endl;
+  }
+
+  return 0;
+}
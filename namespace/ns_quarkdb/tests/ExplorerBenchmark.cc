@@ -0,0 +1,156 @@
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2023 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+//------------------------------------------------------------------------------
+//! @brief Compare the NamespaceExplorer and the ParallelNamespaceExplorer on
+//! a synthetic tree stored in QuarkDB, reporting directories per second.
+//!
+//! Usage: eos-ns-explorer-benchmark <qdb_cluster> [depth] [fanout] [files]
+//!
+//! The tree is created below /explorer-benchmark/ if it does not exist yet,
+//! with "fanout" subdirectories and "files" files per directory down to the
+//! given depth. Use a QuarkDB instance dedicated to testing.
+//------------------------------------------------------------------------------
+
+#include "namespace/ns_quarkdb/explorer/ParallelNamespaceExplorer.hh"
+#include "namespace/ns_quarkdb/flusher/MetadataFlusher.hh"
+#include "namespace/ns_quarkdb/NamespaceGroup.hh"
+#include "namespace/interface/IContainerMDSvc.hh"
+#include "namespace/interface/IFileMDSvc.hh"
+#include "namespace/interface/IFsView.hh"
+#include "namespace/interface/IView.hh"
+#include "common/RWMutex.hh"
+#include <folly/executors/IOThreadPoolExecutor.h>
+#include <chrono>
+#include <iostream>
+
+namespace
+{
+const std::string sBenchRoot = "/explorer-benchmark/";
+
+//------------------------------------------------------------------------------
+// Create the synthetic tree
+//------------------------------------------------------------------------------
+void Populate(eos::IView* view, const std::string& path, size_t depth,
+              size_t fanout, size_t files)
+{
+  for (size_t i = 0; i < files; ++i) {
+    view->createFile(path + "file-" + std::to_string(i), true);
+  }
+
+  if (depth == 0) {
+    return;
+  }
+
+  for (size_t i = 0; i < fanout; ++i) {
+    std::string child = path + "dir-" + std::to_string(i) + "/";
+    view->createContainer(child, true);
+    Populate(view, child, depth - 1, fanout, files);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Drain an explorer and report the rates
+//------------------------------------------------------------------------------
+template<typename ExplorerT>
+void Report(const std::string& label, ExplorerT& explorer,
+            std::chrono::steady_clock::time_point start)
+{
+  eos::NamespaceItem item;
+  size_t ndirs = 0, nfiles = 0;
+
+  while (explorer.fetch(item)) {
+    ++(item.isFile ? nfiles : ndirs);
+  }
+
+  double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() -
+               start).count();
+  std::cout << label << " dirs: " << ndirs << " files: " << nfiles
+            << " time: " << sec << "s dirs/s: " << (size_t)(ndirs / sec)
+            << " entries/s: " << (size_t)((ndirs + nfiles) / sec) << std::endl;
+}
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc < 2) {
+    std::cerr << "usage: " << argv[0] << " <qdb_cluster> [depth] [fanout] [files]"
+              << std::endl;
+    return 1;
+  }
+
+  size_t depth = (argc > 2) ? strtoul(argv[2], 0, 10) : 4;
+  size_t fanout = (argc > 3) ? strtoul(argv[3], 0, 10) : 10;
+  size_t files = (argc > 4) ? strtoul(argv[4], 0, 10) : 10;
+  eos::common::RWMutex ns_mutex;
+  std::map<std::string, std::string> config = {
+    {"queue_path", "/tmp/eos-ns-explorer-benchmark/"},
+    {"qdb_cluster", argv[1]},
+    {"qdb_flusher_md", "explorer_benchmark_md"},
+    {"qdb_flusher_quota", "explorer_benchmark_quota"}
+  };
+  eos::QuarkNamespaceGroup group;
+  std::string err;
+
+  if (!group.initialize(&ns_mutex, config, err)) {
+    std::cerr << "error: " << err << std::endl;
+    return 1;
+  }
+
+  group.getFileService()->configure(config);
+  group.getContainerService()->configure(config);
+  group.getFilesystemView()->configure(config);
+  group.getHierarchicalView()->configure(config);
+  group.getHierarchicalView()->initialize();
+  eos::IView* view = group.getHierarchicalView();
+
+  try {
+    view->getContainer(sBenchRoot);
+  } catch (const eos::MDException& e) {
+    std::cout << "creating synthetic tree depth=" << depth << " fanout="
+              << fanout << " files=" << files << std::endl;
+    view->createContainer(sBenchRoot, true);
+    Populate(view, sBenchRoot, depth, fanout, files);
+    group.getMetadataFlusher()->synchronize();
+  }
+
+  folly::IOThreadPoolExecutor executor(16);
+  eos::ExplorationOptions options;
+  options.depthLimit = 1024;
+  {
+    auto start = std::chrono::steady_clock::now();
+    eos::NamespaceExplorer explorer(sBenchRoot, options, *group.getQClient(),
+                                    &executor);
+    Report("serial", explorer, start);
+  }
+
+  for (bool ordered : {true, false}) {
+    for (size_t workers = 1; workers <= 32; workers *= 2) {
+      eos::ParallelExplorationOptions parallel;
+      parallel.numWorkers = workers;
+      parallel.ordered = ordered;
+      auto start = std::chrono::steady_clock::now();
+      eos::ParallelNamespaceExplorer explorer(sBenchRoot, options, parallel,
+                                              *group.getQClient(), &executor);
+      Report(std::string(ordered ? "ordered" : "unordered") + " workers=" +
+             std::to_string(workers), explorer, start);
+    }
+  }
+
+  return 0;
+}
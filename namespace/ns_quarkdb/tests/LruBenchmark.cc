@@ -24,11 +24,13 @@
 #include "common/CLI11.hpp"
 #include "namespace/ns_quarkdb/LRU.hh"
 #include <experimental/random>
+#include <list>
 
 //! Global synchronization primitives
 std::mutex gMutex;
 std::condition_variable gCondVar;
 std::atomic<unsigned long> gDoneWork {0};
+std::atomic<unsigned long> gNumMisses {0};
 
 
 //------------------------------------------------------------------------------
@@ -59,25 +61,41 @@ void Populate(eos::LRU<std::uint64_t, Entry>& lru, uint64_t size)
 }
 
 //------------------------------------------------------------------------------
-//! Work done by each individual thread
+//! Work done by each individual thread. A miss_percent share of the requests
+//! targets ids which are not cached and, like the metadata provider, inserts
+//! them after the lookup which eventually triggers evictions.
 //------------------------------------------------------------------------------
 void WokerThread(eos::LRU<std::uint64_t, Entry>& lru, std::uint64_t num_req,
-                 std::uint64_t max_size)
+                 std::uint64_t max_size, std::uint32_t miss_percent,
+                 std::uint64_t miss_base)
 {
   // Pick a random start location between [1, max_size]
   unsigned long long random_start =
     std::experimental::randint(1ull, (unsigned long long) max_size);
+  std::uint64_t num_misses = 0ull;
   // Wait for notification from the main thread
   std::unique_lock<std::mutex> lock(gMutex);
   gCondVar.wait(lock);
   lock.unlock();
 
   while (num_req) {
-    lru.get(random_start);
+    std::uint64_t id = random_start;
+
+    if (miss_percent &&
+        ((std::uint32_t)std::experimental::randint(1, 100) <= miss_percent)) {
+      id = miss_base + num_req;
+    }
+
+    if (lru.get(id) == nullptr) {
+      lru.put(id, std::make_shared<Entry>(id));
+      ++num_misses;
+    }
+
     random_start = (random_start + 1) % max_size + 1;
     --num_req;
   }
 
+  gNumMisses += num_misses;
   ++gDoneWork;
   gCondVar.notify_one();
 }
@@ -91,18 +109,23 @@ int main(int argc, char* argv[])
   std::uint64_t max_size = 1000000;
   std::uint32_t num_threads = 1;
   std::uint64_t num_requests = max_size / 10;
+  std::uint32_t miss_percent = 0;
   app.add_option("-s,--size", max_size, "max size of the LRU");
   app.add_option("-t,--num_threads", num_threads,
                  "number of threads for access operations");
   app.add_option("-r,--num_requests", num_requests,
                  "number of requests per thread");
+  app.add_option("-m,--miss_percent", miss_percent,
+                 "percentage of requests for entries which are not cached");
   CLI11_PARSE(app, argc, argv);
   eos::LRU<std::uint64_t, Entry> lru{max_size + 10};
   Populate(lru, max_size);
   std::list<std::thread> workers;
 
   for (auto i = 0ull; i < num_threads; ++i) {
-    workers.emplace_back(WokerThread, std::ref(lru), num_requests, max_size);
+    // Every thread misses on its own range of ids
+    workers.emplace_back(WokerThread, std::ref(lru), num_requests, max_size,
+                         miss_percent, (i + 1) * (max_size + num_requests));
   }
 
   // Sleep a bit to allow all threads to start
@@ -120,6 +143,8 @@ int main(int argc, char* argv[])
   std::uint64_t total_req = num_threads * num_requests;
   std::cout << "Rate : " << ((total_req * 1000000) / duration.count()) / 100 <<
             " kHz\n";
+  std::cout << "Misses : " << gNumMisses << "/" << total_req
+            << " cache size: " << lru.size() << "\n";
 
   for (auto& thread : workers) {
     thread.join();
@@ -0,0 +1,188 @@
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2023 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+//------------------------------------------------------------------------------
+//! @brief Measure the throughput of a mix of file creations, mkdirs, stats,
+//! renames, attribute and mtime updates as the number of threads grows. The
+//! file creations and renames always take the global namespace mutex for
+//! write, as in the MGM. The mkdirs, attribute and mtime updates take it
+//! either for write or for read plus the locks of the changed objects, which
+//! is what the MGM does with the QuarkDB namespace.
+//!
+//! Usage: eos-ns-locking-benchmark <qdb_cluster> [max_threads] [ops_per_thread]
+//!
+//! Every thread works in its own directory below /ns-locking-benchmark/.
+//! Use a QuarkDB instance dedicated to testing.
+//------------------------------------------------------------------------------
+
+#include "namespace/ns_quarkdb/flusher/MetadataFlusher.hh"
+#include "namespace/ns_quarkdb/NamespaceGroup.hh"
+#include "namespace/interface/IContainerMDSvc.hh"
+#include "namespace/interface/IFileMDSvc.hh"
+#include "namespace/interface/IFsView.hh"
+#include "namespace/interface/IView.hh"
+#include "namespace/utils/ObjectLocks.hh"
+#include "common/RWMutex.hh"
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <thread>
+
+namespace
+{
+using Type = eos::ObjectLockTable::Type;
+
+//------------------------------------------------------------------------------
+// Run the operations of one thread in its own directory, out of 10 operations
+// 1 is a file creation, 1 a rename, 2 are attribute updates, 1 is an mtime
+// update, 1 a mkdir and the rest are stats
+//------------------------------------------------------------------------------
+void
+RunThread(eos::IView* view, eos::common::RWMutex& ns_mutex,
+          eos::ObjectLockTable& table, bool fine_grained,
+          const std::string& dir, size_t num_ops, std::atomic<size_t>& nerrors)
+{
+  std::mt19937_64 rng(std::hash<std::string>()(dir));
+  std::vector<std::string> names;
+  size_t next_name = 0;
+  size_t next_dir = 0;
+
+  for (size_t i = 0; i < num_ops; ++i) {
+    const size_t op = i % 10;
+
+    try {
+      if (names.empty() || (op == 0)) {
+        const std::string name = "file-" + std::to_string(next_name++);
+        eos::common::RWMutexWriteLock wr_lock(ns_mutex);
+        view->createFile(dir + name);
+        names.push_back(name);
+      } else if (op == 1) {
+        std::string& name = names[rng() % names.size()];
+        const std::string new_name = "file-" + std::to_string(next_name++);
+        eos::common::RWMutexWriteLock wr_lock(ns_mutex);
+        std::shared_ptr<eos::IFileMD> fmd = view->getFile(dir + name);
+        view->renameFile(fmd.get(), new_name);
+        name = new_name;
+      } else if (op <= 4) {
+        eos::NsObjectLock lock(ns_mutex, table, fine_grained);
+        std::shared_ptr<eos::IFileMD> fmd =
+          view->getFile(dir + names[rng() % names.size()]);
+        lock.Lock({{Type::kFile, fmd->getId()}});
+
+        if (op == 4) {
+          fmd->setMTimeNow();
+        } else {
+          fmd->setAttribute("user.benchmark", std::to_string(i));
+        }
+
+        view->updateFileStore(fmd.get());
+      } else if (op == 5) {
+        eos::NsObjectLock lock(ns_mutex, table, fine_grained);
+        std::shared_ptr<eos::IContainerMD> parent = view->getContainer(dir);
+        lock.Lock({{Type::kContainer, parent->getId()}});
+        std::shared_ptr<eos::IContainerMD> cont = view->createContainer(
+              dir + "dir-" + std::to_string(next_dir++));
+        lock.Add(Type::kContainer, cont->getId());
+        cont->setMode(parent->getMode());
+        parent->setMTimeNow();
+        view->updateContainerStore(cont.get());
+        view->updateContainerStore(parent.get());
+      } else {
+        eos::common::RWMutexReadLock rd_lock(ns_mutex);
+        view->getFile(dir + names[rng() % names.size()]);
+      }
+    } catch (const eos::MDException& e) {
+      ++nerrors;
+    }
+  }
+}
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc < 2) {
+    std::cerr << "usage: " << argv[0] << " <qdb_cluster> [max_threads] "
+              << "[ops_per_thread]" << std::endl;
+    return 1;
+  }
+
+  size_t max_threads = (argc > 2) ? strtoul(argv[2], 0, 10) : 32;
+  size_t num_ops = (argc > 3) ? strtoul(argv[3], 0, 10) : 10000;
+  eos::common::RWMutex ns_mutex;
+  eos::ObjectLockTable table;
+  std::map<std::string, std::string> config = {
+    {"queue_path", "/tmp/eos-ns-locking-benchmark/"},
+    {"qdb_cluster", argv[1]},
+    {"qdb_flusher_md", "locking_benchmark_md"},
+    {"qdb_flusher_quota", "locking_benchmark_quota"}
+  };
+  eos::QuarkNamespaceGroup group;
+  std::string err;
+
+  if (!group.initialize(&ns_mutex, config, err)) {
+    std::cerr << "error: " << err << std::endl;
+    return 1;
+  }
+
+  group.getFileService()->configure(config);
+  group.getContainerService()->configure(config);
+  group.getFilesystemView()->configure(config);
+  group.getHierarchicalView()->configure(config);
+  group.getHierarchicalView()->initialize();
+  eos::IView* view = group.getHierarchicalView();
+  const std::string base = "/ns-locking-benchmark/run-" +
+                           std::to_string(time(nullptr)) + "/";
+  size_t run = 0;
+
+  for (const bool fine_grained : {false, true}) {
+    for (size_t nthreads = 1; nthreads <= max_threads; nthreads *= 2) {
+      std::vector<std::string> dirs;
+
+      for (size_t i = 0; i < nthreads; ++i) {
+        dirs.push_back(base + std::to_string(run) + "-" + std::to_string(i) + "/");
+        view->createContainer(dirs.back(), true);
+      }
+
+      ++run;
+      std::atomic<size_t> nerrors {0};
+      std::vector<std::thread> threads;
+      auto start = std::chrono::steady_clock::now();
+
+      for (const auto& dir : dirs) {
+        threads.emplace_back(RunThread, view, std::ref(ns_mutex),
+                             std::ref(table), fine_grained, dir, num_ops,
+                             std::ref(nerrors));
+      }
+
+      for (auto& th : threads) {
+        th.join();
+      }
+
+      double sec = std::chrono::duration<double>
+                   (std::chrono::steady_clock::now() - start).count();
+      std::cout << (fine_grained ? "object" : "global") << " locking threads: "
+                << nthreads << " ops: " << nthreads * num_ops << " errors: "
+                << nerrors << " time: " << sec << "s ops/s: "
+                << (size_t)(nthreads * num_ops / sec) << std::endl;
+    }
+  }
+
+  group.getMetadataFlusher()->synchronize();
+  return 0;
+}
@@ -0,0 +1,242 @@
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2023 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+//------------------------------------------------------------------------------
+//! @brief Per object namespace lock tests
+//------------------------------------------------------------------------------
+
+#include "namespace/utils/ObjectLocks.hh"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <set>
+#include <thread>
+
+using eos::ObjectLock;
+using eos::ObjectLockTable;
+using Type = eos::ObjectLockTable::Type;
+using Mode = eos::ObjectLock::Mode;
+
+namespace
+{
+//------------------------------------------------------------------------------
+// Check from another thread if the stripe can be locked in the given mode
+//------------------------------------------------------------------------------
+bool
+CanLock(ObjectLockTable& table, size_t stripe, bool exclusive)
+{
+  bool locked = false;
+  std::thread th([&]() {
+    std::shared_mutex& mutex = table.GetMutex(stripe);
+    locked = (exclusive ? mutex.try_lock() : mutex.try_lock_shared());
+
+    if (locked) {
+      exclusive ? mutex.unlock() : mutex.unlock_shared();
+    }
+  });
+  th.join();
+  return locked;
+}
+}
+
+//------------------------------------------------------------------------------
+// Objects are spread over the stripes
+//------------------------------------------------------------------------------
+TEST(ObjectLocks, Stripes)
+{
+  ObjectLockTable table(1000);
+  ASSERT_EQ(1024u, table.GetNumStripes());
+  std::set<size_t> stripes;
+  size_t num_same = 0;
+
+  for (uint64_t id = 1; id <= 1024; ++id) {
+    size_t stripe = table.GetStripe(Type::kFile, id);
+    ASSERT_LT(stripe, table.GetNumStripes());
+    ASSERT_EQ(stripe, table.GetStripe(Type::kFile, id));
+    stripes.insert(stripe);
+
+    if (stripe == table.GetStripe(Type::kContainer, id)) {
+      ++num_same;
+    }
+  }
+
+  ASSERT_GT(stripes.size(), 512u);
+  ASSERT_LT(num_same, 16u);
+}
+
+//------------------------------------------------------------------------------
+// Objects sharing a stripe lock it once, for write if any of them wants it
+//------------------------------------------------------------------------------
+TEST(ObjectLocks, SharedStripe)
+{
+  ObjectLockTable table(1);
+  {
+    ObjectLock lock(table, {{Type::kContainer, 1, Mode::kRead},
+      {Type::kFile, 2, Mode::kRead}
+    });
+    ASSERT_EQ(1u, lock.GetNumLocked());
+    ASSERT_TRUE(CanLock(table, 0, false));
+    ASSERT_FALSE(CanLock(table, 0, true));
+    lock.Lock({{Type::kContainer, 1, Mode::kRead},
+      {Type::kFile, 2, Mode::kWrite}
+    });
+    ASSERT_EQ(1u, lock.GetNumLocked());
+    ASSERT_FALSE(CanLock(table, 0, false));
+    lock.Release();
+    ASSERT_EQ(0u, lock.GetNumLocked());
+    ASSERT_TRUE(CanLock(table, 0, true));
+    lock.Lock(std::vector<ObjectLock::Request> {{Type::kFile, 3, Mode::kWrite}});
+    ASSERT_FALSE(CanLock(table, 0, false));
+  }
+  ASSERT_TRUE(CanLock(table, 0, true));
+}
+
+//------------------------------------------------------------------------------
+// Objects requested in opposite orders by concurrent threads do not deadlock
+//------------------------------------------------------------------------------
+TEST(ObjectLocks, OrderedLocking)
+{
+  ObjectLockTable table(64);
+  const uint64_t num_ids = 8;
+  std::vector<uint64_t> counters(num_ids, 0);
+  std::vector<std::thread> threads;
+
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&, t]() {
+      ObjectLock lock(table);
+
+      for (uint64_t i = 0; i < 10000; ++i) {
+        uint64_t first = (i + t) % num_ids;
+        uint64_t second = (num_ids - 1) - first;
+
+        if (t % 2) {
+          std::swap(first, second);
+        }
+
+        lock.Lock({{Type::kContainer, first, Mode::kWrite},
+          {Type::kContainer, second, Mode::kWrite}
+        });
+        ++counters[first];
+        ++counters[second];
+        lock.Release();
+      }
+    });
+  }
+
+  for (auto& th : threads) {
+    th.join();
+  }
+
+  uint64_t total = 0;
+
+  for (const auto& counter : counters) {
+    total += counter;
+  }
+
+  ASSERT_EQ(4u * 10000u * 2u, total);
+}
+
+//------------------------------------------------------------------------------
+// An object added after the others is tried when out of the stripe order
+//------------------------------------------------------------------------------
+TEST(ObjectLocks, TryAdd)
+{
+  ObjectLockTable table(64);
+  // Find containers on a middle, a higher and a lower stripe
+  uint64_t mid = 0, high = 0, low = 0;
+
+  for (uint64_t id = 1; !high || !low; ++id) {
+    size_t stripe = table.GetStripe(Type::kContainer, id);
+
+    if (!mid && (stripe > 16) && (stripe < 48)) {
+      mid = id;
+    } else if (mid && (stripe > table.GetStripe(Type::kContainer, mid))) {
+      high = high ? high : id;
+    } else if (mid && (stripe < table.GetStripe(Type::kContainer, mid))) {
+      low = low ? low : id;
+    }
+  }
+
+  const size_t low_stripe = table.GetStripe(Type::kContainer, low);
+  // Another thread holds the lower stripe for read until released
+  std::atomic<int> state {0};
+  std::thread reader([&]() {
+    table.GetMutex(low_stripe).lock_shared();
+    state = 1;
+
+    while (state != 2) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    table.GetMutex(low_stripe).unlock_shared();
+  });
+
+  while (state != 1) {
+    std::this_thread::yield();
+  }
+
+  ObjectLock lock(table, {{Type::kContainer, mid, Mode::kRead}});
+  // Same stripe, can not be upgraded to write
+  ASSERT_TRUE(lock.TryAdd({Type::kContainer, mid, Mode::kRead}));
+  ASSERT_FALSE(lock.TryAdd({Type::kContainer, mid, Mode::kWrite}));
+  // Higher stripe, always locked
+  ASSERT_TRUE(lock.TryAdd({Type::kContainer, high, Mode::kWrite}));
+  ASSERT_EQ(2u, lock.GetNumLocked());
+  ASSERT_FALSE(CanLock(table, table.GetStripe(Type::kContainer, high), false));
+  // Lower stripe, only tried
+  ASSERT_FALSE(lock.TryAdd({Type::kContainer, low, Mode::kWrite}));
+  ASSERT_TRUE(lock.TryAdd({Type::kContainer, low, Mode::kRead}));
+  ASSERT_EQ(3u, lock.GetNumLocked());
+  lock.Release();
+  // NsObjectLock falls back to locking everything again once released
+  eos::common::RWMutex ns_mutex;
+  eos::NsObjectLock ns_lock(ns_mutex, table, true);
+  ns_lock.Lock({{Type::kContainer, mid}});
+  state = 2;
+  ns_lock.Add(Type::kContainer, low);
+  reader.join();
+  ASSERT_FALSE(CanLock(table, low_stripe, false));
+  ASSERT_FALSE(CanLock(table, table.GetStripe(Type::kContainer, mid), false));
+  ns_lock.Release();
+  ASSERT_TRUE(CanLock(table, low_stripe, true));
+}
+
+//------------------------------------------------------------------------------
+// Objects locked only in fine grained mode
+//------------------------------------------------------------------------------
+TEST(ObjectLocks, NsObjectLock)
+{
+  eos::common::RWMutex ns_mutex;
+  ObjectLockTable table(1);
+  {
+    eos::NsObjectLock lock(ns_mutex, table, false);
+    ASSERT_FALSE(lock.IsFineGrained());
+    lock.Lock({{Type::kFile, 1}});
+    ASSERT_TRUE(CanLock(table, 0, true));
+  }
+  {
+    eos::NsObjectLock lock(ns_mutex, table, true);
+    ASSERT_TRUE(lock.IsFineGrained());
+    lock.Lock({{Type::kContainer, 1}, {Type::kFile, 1}});
+    ASSERT_FALSE(CanLock(table, 0, false));
+    lock.Release();
+    ASSERT_FALSE(lock.IsFineGrained());
+    ASSERT_TRUE(CanLock(table, 0, true));
+  }
+  // Global mutex released
+  eos::common::RWMutexWriteLock wr_lock(ns_mutex);
+}
@@ -25,10 +25,13 @@
 #include "namespace/ns_quarkdb/ConfigurationParser.hh"
 #include "namespace/ns_quarkdb/QdbContactDetails.hh"
 #include "namespace/ns_quarkdb/LRU.hh"
+#include "namespace/ns_quarkdb/accounting/PolicyIndex.hh"
+#include "namespace/ns_quarkdb/persistency/DentryCache.hh"
 #include "namespace/utils/PathProcessor.hh"
 #include "namespace/utils/TestHelpers.hh"
 #include <gtest/gtest.h>
 #include <sstream>
+#include <thread>
 
 //------------------------------------------------------------------------------
 // Check the path
@@ -78,6 +81,225 @@ TEST(PathSplitter, BasicSanity)
   ASSERT_TRUE(elements.empty());
 }
 
+TEST(PolicyIndex, HasPrefix)
+{
+  eos::IContainerMD::XAttrMap xattrs;
+  ASSERT_FALSE(eos::QuarkPolicyIndex::HasPrefix(xattrs, "sys.lru."));
+  xattrs["sys.forced.space"] = "default";
+  xattrs["sys.lru"] = "no-trailing-dot";
+  xattrs["user.sys.lru.expire"] = "1d";
+  ASSERT_FALSE(eos::QuarkPolicyIndex::HasPrefix(xattrs, "sys.lru."));
+  ASSERT_FALSE(eos::QuarkPolicyIndex::HasPrefix(xattrs, "sys.attr.link"));
+  xattrs["sys.lru.watermark"] = "default:90";
+  xattrs["sys.attr.link"] = "/eos/dir";
+  ASSERT_TRUE(eos::QuarkPolicyIndex::HasPrefix(xattrs, "sys.lru."));
+  ASSERT_TRUE(eos::QuarkPolicyIndex::HasPrefix(xattrs, "sys.attr.link"));
+  ASSERT_TRUE(eos::QuarkPolicyIndex::HasPrefix(xattrs, "sys."));
+}
+
+TEST(DentryCache, BasicSanity)
+{
+  using eos::DentryCache;
+  DentryCache cache(100);
+  DentryCache::Entry entry;
+  DentryCache::Tracker tracker;
+  std::deque<std::string> chunks {"eos", "dir", "file"};
+  ASSERT_EQ(cache.lookup(chunks, entry, tracker), 0u);
+  ASSERT_TRUE(tracker.active);
+  ASSERT_EQ(tracker.path, "");
+  // Results of a lookup starting from the root
+  tracker.descend("eos");
+  cache.insert(tracker, {DentryCache::Kind::Container, 2});
+  tracker.descend("dir");
+  cache.insert(tracker, {DentryCache::Kind::Container, 3});
+  tracker.descend("file");
+  cache.insert(tracker, {DentryCache::Kind::File, 10});
+  ASSERT_EQ(cache.lookup(chunks, entry, tracker), 3u);
+  ASSERT_EQ(entry.kind, DentryCache::Kind::File);
+  ASSERT_EQ(entry.id, 10u);
+  // Missing entry, resumed from the longest cached prefix
+  std::deque<std::string> missing {"eos", "dir", "missing", "x"};
+  ASSERT_EQ(cache.lookup(missing, entry, tracker), 2u);
+  ASSERT_EQ(entry.kind, DentryCache::Kind::Container);
+  ASSERT_EQ(tracker.path, "/eos/dir");
+  tracker.descend("missing");
+  cache.insert(tracker, {DentryCache::Kind::Negative, 0});
+  ASSERT_EQ(cache.lookup(missing, entry, tracker), 3u);
+  ASSERT_EQ(entry.kind, DentryCache::Kind::Negative);
+  // Creating the entry drops the negative entry
+  cache.containerMDChildChanged(eos::ContainerIdentifier(3), "missing");
+  ASSERT_EQ(cache.lookup(missing, entry, tracker), 2u);
+  // Results of a lookup which started before an invalidation are ignored
+  tracker.descend("missing");
+  cache.containerMDChildChanged(eos::ContainerIdentifier(3), "missing");
+  cache.insert(tracker, {DentryCache::Kind::Negative, 0});
+  ASSERT_EQ(cache.lookup(missing, entry, tracker), 2u);
+  // Entries whose parent is not cached are ignored
+  ASSERT_EQ(cache.lookup({"other", "x"}, entry, tracker), 0u);
+  tracker.descend("other");
+  tracker.descend("x");
+  cache.insert(tracker, {DentryCache::Kind::File, 11});
+  ASSERT_EQ(cache.lookup({"other", "x"}, entry, tracker), 0u);
+  // Renaming a container drops everything below it
+  cache.containerMDChildChanged(eos::ContainerIdentifier(2), "dir");
+  ASSERT_EQ(cache.lookup(chunks, entry, tracker), 1u);
+  ASSERT_EQ(entry.id, 2u);
+  // Dropping a cached container drops its entries, but not itself
+  tracker.descend("dir");
+  cache.insert(tracker, {DentryCache::Kind::Container, 3});
+  tracker.descend("file");
+  cache.insert(tracker, {DentryCache::Kind::File, 10});
+  cache.containerMDChildChanged(eos::ContainerIdentifier(3), "");
+  ASSERT_EQ(cache.lookup(chunks, entry, tracker), 2u);
+  eos::CacheStatistics stats = cache.getStatistics();
+  ASSERT_TRUE(stats.enabled);
+  ASSERT_EQ(stats.occupancy, 2u);
+  ASSERT_EQ(stats.hits, 2u);
+  ASSERT_EQ(stats.misses, 8u);
+}
+
+TEST(DentryCache, Eviction)
+{
+  using eos::DentryCache;
+  DentryCache cache(3);
+  DentryCache::Entry entry;
+  DentryCache::Tracker tracker;
+  cache.lookup({"x"}, entry, tracker);
+  tracker.descend("x");
+  cache.insert(tracker, {DentryCache::Kind::File, 9});
+  cache.lookup({"a", "b"}, entry, tracker);
+  tracker.descend("a");
+  cache.insert(tracker, {DentryCache::Kind::Container, 2});
+  tracker.descend("b");
+  cache.insert(tracker, {DentryCache::Kind::Container, 3});
+  ASSERT_EQ(cache.getStatistics().occupancy, 3u);
+  cache.lookup({"a", "c"}, entry, tracker);
+  tracker.descend("c");
+  cache.insert(tracker, {DentryCache::Kind::Negative, 0});
+  ASSERT_EQ(cache.getStatistics().occupancy, 3u);
+  ASSERT_EQ(cache.lookup({"x"}, entry, tracker), 0u);
+  ASSERT_EQ(cache.lookup({"a", "b"}, entry, tracker), 2u);
+  // Containers with cached children and referenced entries are spared, "/a/c"
+  // is the only unreferenced leaf
+  cache.lookup({"y"}, entry, tracker);
+  tracker.descend("y");
+  cache.insert(tracker, {DentryCache::Kind::File, 12});
+  ASSERT_EQ(cache.getStatistics().occupancy, 3u);
+  ASSERT_EQ(cache.lookup({"a", "c"}, entry, tracker), 1u);
+  ASSERT_EQ(cache.lookup({"a", "b"}, entry, tracker), 2u);
+  ASSERT_EQ(cache.lookup({"y"}, entry, tracker), 1u);
+  // Flush, then disable
+  cache.setMaxNum(UINT64_MAX);
+  ASSERT_EQ(cache.getStatistics().occupancy, 0u);
+  ASSERT_TRUE(cache.getStatistics().enabled);
+  cache.setMaxNum(0);
+  cache.lookup({"y"}, entry, tracker);
+  ASSERT_FALSE(tracker.active);
+  ASSERT_FALSE(cache.getStatistics().enabled);
+}
+
+TEST(DentryCache, ConcurrentInvalidations)
+{
+  using eos::DentryCache;
+  DentryCache cache(100);
+  DentryCache::Entry entry;
+  DentryCache::Tracker tracker;
+  cache.lookup({"eos", "dir"}, entry, tracker);
+  tracker.descend("eos");
+  cache.insert(tracker, {DentryCache::Kind::Container, 2});
+  tracker.descend("dir");
+  cache.insert(tracker, {DentryCache::Kind::Container, 3});
+  // Creates in other containers do not discard concurrent lookups
+  ASSERT_EQ(cache.lookup({"eos", "dir", "missing"}, entry, tracker), 2u);
+  tracker.descend("missing");
+  cache.containerMDChildChanged(eos::ContainerIdentifier(4), "other");
+  cache.containerMDChildChanged(eos::ContainerIdentifier(2), "other");
+  cache.insert(tracker, {DentryCache::Kind::Negative, 0});
+  ASSERT_EQ(cache.lookup({"eos", "dir", "missing"}, entry, tracker), 3u);
+  ASSERT_EQ(entry.kind, DentryCache::Kind::Negative);
+  // A create in an uncached container discards a lookup which goes through it
+  cache.lookup({"eos", "sub", "file"}, entry, tracker);
+  tracker.descend("sub");
+  cache.containerMDChildChanged(eos::ContainerIdentifier(5), "file");
+  cache.insert(tracker, {DentryCache::Kind::Container, 5});
+  tracker.descend("file");
+  cache.insert(tracker, {DentryCache::Kind::Negative, 0});
+  ASSERT_EQ(cache.lookup({"eos", "sub", "file"}, entry, tracker), 2u);
+  ASSERT_EQ(entry.id, 5u);
+}
+
+TEST(DentryCache, HotDeepEntries)
+{
+  using eos::DentryCache;
+  DentryCache cache(20);
+  DentryCache::Entry entry;
+  DentryCache::Tracker tracker;
+  const std::deque<std::string> hot {"eos", "a", "b", "c", "file"};
+  cache.lookup(hot, entry, tracker);
+
+  for (size_t i = 0; i < hot.size(); ++i) {
+    tracker.descend(hot[i]);
+    cache.insert(tracker, {(i + 1 < hot.size()) ? DentryCache::Kind::Container :
+                           DentryCache::Kind::File, 100 + i});
+  }
+
+  // The cache stays full of cold entries while the hot one keeps being used
+  for (uint64_t i = 0; i < 1000; ++i) {
+    ASSERT_EQ(cache.lookup(hot, entry, tracker), hot.size());
+    ASSERT_EQ(entry.id, 104u);
+    const std::string name = "cold" + std::to_string(i);
+    ASSERT_EQ(cache.lookup({"eos", name}, entry, tracker), 1u);
+    tracker.descend(name);
+    cache.insert(tracker, {DentryCache::Kind::Negative, 0});
+    ASSERT_LE(cache.getStatistics().occupancy, 20u);
+  }
+
+  ASSERT_EQ(cache.getStatistics().occupancy, 20u);
+  ASSERT_EQ(cache.lookup(hot, entry, tracker), hot.size());
+  // The most recent cold entries are still there
+  ASSERT_EQ(cache.lookup({"eos", "cold999"}, entry, tracker), 2u);
+  ASSERT_EQ(entry.kind, DentryCache::Kind::Negative);
+}
+
+TEST(DentryCache, ConcurrentLookups)
+{
+  using eos::DentryCache;
+  DentryCache cache(50);
+  std::vector<std::thread> threads;
+
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&cache, t]() {
+      DentryCache::Entry entry;
+      DentryCache::Tracker tracker;
+
+      for (uint64_t i = 0; i < 5000; ++i) {
+        const std::string name = std::to_string((i * 7 + t) % 200);
+        cache.lookup({"eos", name}, entry, tracker);
+
+        if (tracker.path.empty()) {
+          tracker.descend("eos");
+          cache.insert(tracker, {DentryCache::Kind::Container, 2});
+        }
+
+        if (tracker.path == "/eos") {
+          tracker.descend(name);
+          cache.insert(tracker, {DentryCache::Kind::File, 10 + i});
+        }
+
+        if (i % 1000 == 0) {
+          cache.containerMDChildChanged(eos::ContainerIdentifier(2), name);
+        }
+      }
+    });
+  }
+
+  for (auto& th : threads) {
+    th.join();
+  }
+
+  ASSERT_LE(cache.getStatistics().occupancy, 50u);
+}
+
 TEST(LRU, BasicSanity)
 {
   struct Entry {
@@ -128,6 +350,67 @@ TEST(LRU, BasicSanity)
   ASSERT_TRUE(!cache.get(100));
 }
 
+TEST(LRU, ConcurrentAccess)
+{
+  struct Entry {
+    explicit Entry(std::uint64_t id) : id_(id) {}
+
+    std::uint64_t
+    getId() const
+    {
+      return id_;
+    }
+
+    std::uint64_t id_;
+  };
+  std::uint64_t max_size = 10000;
+  eos::LRU<std::uint64_t, Entry> cache{max_size};
+  // Entries referenced outside the cache must survive all the evictions
+  std::vector<std::shared_ptr<Entry>> pinned;
+
+  for (std::uint64_t id = 0; id < 100; ++id) {
+    pinned.push_back(cache.put(id, std::make_shared<Entry>(id)));
+  }
+
+  std::vector<std::thread> workers;
+
+  for (std::uint64_t t = 0; t < 8; ++t) {
+    workers.emplace_back([&cache, t]() {
+      for (std::uint64_t i = 0; i < 50000; ++i) {
+        std::uint64_t id = 100 + (t * 50000 + i) % 30000;
+        auto entry = cache.get(id);
+
+        if (entry == nullptr) {
+          entry = cache.put(id, std::make_shared<Entry>(id));
+        }
+
+        ASSERT_EQ(id, entry->getId());
+
+        if (i % 7 == 0) {
+          (void) cache.remove(id);
+        }
+      }
+    });
+  }
+
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  ASSERT_LE(cache.size(), max_size);
+
+  for (std::uint64_t id = 0; id < 100; ++id) {
+    ASSERT_EQ(pinned[id], cache.get(id));
+  }
+
+  cache.set_max_num(UINT64_MAX);
+  ASSERT_EQ(100u, cache.size());
+  pinned.clear();
+  cache.set_max_num(0);
+  ASSERT_EQ(0u, cache.size());
+  ASSERT_EQ(0u, cache.get_max_num());
+}
+
 TEST(PathProcessor, AbsPathTest)
 {
   std::string path = "/a/b/c/d/";
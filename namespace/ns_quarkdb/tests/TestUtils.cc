@@ -165,6 +165,12 @@ eos::MetadataFlusher* NsTestsFixture::mdFlusher()
   return namespaceGroupPtr->getMetadataFlusher();
 }
 
+eos::QuarkPolicyIndex* NsTestsFixture::policyIndex()
+{
+  initServices();
+  return namespaceGroupPtr->getPolicyIndex();
+}
+
 eos::MetadataFlusher* NsTestsFixture::quotaFlusher()
 {
   initServices();
@@ -43,6 +43,7 @@ class IFileMDSvc;
 class IView;
 class IFsView;
 class MetadataFlusher;
+class QuarkPolicyIndex;
 class IFileMD;
 }
 
@@ -155,6 +156,9 @@ public:
   eos::MetadataFlusher* mdFlusher();
   eos::MetadataFlusher* quotaFlusher();
 
+  // Return policy index
+  eos::QuarkPolicyIndex* policyIndex();
+
   // Register size mapper
   void setSizeMapper(SizeMapper sizeMapper);
 
@@ -26,12 +26,14 @@
 
 #include "namespace/interface/ContainerIterators.hh"
 #include "namespace/ns_quarkdb/explorer/NamespaceExplorer.hh"
+#include "namespace/ns_quarkdb/explorer/ParallelNamespaceExplorer.hh"
 #include "namespace/ns_quarkdb/persistency/ContainerMDSvc.hh"
 #include "namespace/ns_quarkdb/persistency/FileMDSvc.hh"
 #include "namespace/ns_quarkdb/persistency/MetadataFetcher.hh"
 #include "namespace/ns_quarkdb/persistency/RequestBuilder.hh"
 #include "namespace/ns_quarkdb/views/HierarchicalView.hh"
 #include "namespace/ns_quarkdb/accounting/FileSystemView.hh"
+#include "namespace/ns_quarkdb/accounting/PolicyIndex.hh"
 #include "namespace/ns_quarkdb/flusher/MetadataFlusher.hh"
 #include "namespace/ns_quarkdb/FileMD.hh"
 #include "namespace/ns_quarkdb/ContainerMD.hh"
@@ -213,6 +215,69 @@ TEST_F(VariousTests, ReconstructContainerPath)
                eos::MDException);
 }
 
+TEST_F(VariousTests, PolicyIndex)
+{
+  std::shared_ptr<eos::IContainerMD> cont1 =
+    view()->createContainer("/eos/lru/a", true);
+  std::shared_ptr<eos::IContainerMD> cont2 =
+    view()->createContainer("/eos/lru/b", true);
+  std::shared_ptr<eos::IContainerMD> cont3 =
+    view()->createContainer("/eos/lru/c", true);
+  cont1->setAttribute("sys.lru.expire.match", "*:1d");
+  cont1->setAttribute("sys.forced.space", "default");
+  cont2->setAttribute("sys.attr.link", "/eos/lru/a");
+  cont3->setAttribute("sys.forced.layout", "replica");
+  mdFlusher()->synchronize();
+  ASSERT_FALSE(eos::QuarkPolicyIndex::IsReady(qcl()));
+  std::set<eos::IContainerMD::id_t> lru_ids, link_ids;
+  ASSERT_TRUE(eos::QuarkPolicyIndex::GetContainers(qcl(), "sys.lru.",
+              lru_ids));
+  ASSERT_TRUE(eos::QuarkPolicyIndex::GetContainers(qcl(), "sys.attr.link",
+              link_ids));
+  ASSERT_EQ(lru_ids, std::set<eos::IContainerMD::id_t> {cont1->getId()});
+  ASSERT_EQ(link_ids, std::set<eos::IContainerMD::id_t> {cont2->getId()});
+  // Other attributes keep the container indexed until the last policy one
+  // goes away
+  cont1->setAttribute("sys.lru.watermark", "default:90");
+  cont1->removeAttribute("sys.lru.expire.match");
+  cont1->removeAttribute("sys.forced.space");
+  mdFlusher()->synchronize();
+  lru_ids.clear();
+  ASSERT_TRUE(eos::QuarkPolicyIndex::GetContainers(qcl(), "sys.lru.",
+              lru_ids));
+  ASSERT_EQ(lru_ids, std::set<eos::IContainerMD::id_t> {cont1->getId()});
+  cont1->removeAttribute("sys.lru.watermark");
+  // Removed containers are dropped from the index
+  view()->removeContainer("/eos/lru/b");
+  mdFlusher()->synchronize();
+  lru_ids.clear();
+  link_ids.clear();
+  ASSERT_TRUE(eos::QuarkPolicyIndex::GetContainers(qcl(), "sys.lru.",
+              lru_ids));
+  ASSERT_TRUE(eos::QuarkPolicyIndex::GetContainers(qcl(), "sys.attr.link",
+              link_ids));
+  ASSERT_TRUE(lru_ids.empty());
+  ASSERT_TRUE(link_ids.empty());
+  // Entries added by a rebuild are only removed once the rebuild is noticed
+  const std::string sid = std::to_string(cont3->getId());
+  qcl().exec("SADD", RequestBuilder::keyPolicyIndex("sys.lru."), sid).get();
+  cont3->setAttribute("sys.forced.space", "default");
+  mdFlusher()->synchronize();
+  lru_ids.clear();
+  ASSERT_TRUE(eos::QuarkPolicyIndex::GetContainers(qcl(), "sys.lru.",
+              lru_ids));
+  ASSERT_EQ(lru_ids, std::set<eos::IContainerMD::id_t> {cont3->getId()});
+  qcl().exec("HINCRBY", constants::sMapMetaInfoKey,
+             policyindex::sGenerationField, "1").get();
+  policyIndex()->ReloadIfRebuilt(qcl());
+  cont3->removeAttribute("sys.forced.space");
+  mdFlusher()->synchronize();
+  lru_ids.clear();
+  ASSERT_TRUE(eos::QuarkPolicyIndex::GetContainers(qcl(), "sys.lru.",
+              lru_ids));
+  ASSERT_TRUE(lru_ids.empty());
+}
+
 TEST_F(VariousTests, BasicSanity)
 {
   std::shared_ptr<eos::IContainerMD> root = view()->getContainer("/");
@@ -1134,6 +1199,124 @@ TEST_F(NamespaceExplorerF, ExpansionDecider)
   ASSERT_FALSE(explorer.fetch(item));
 }
 
+TEST_F(NamespaceExplorerF, ParallelSameAsSerial)
+{
+  populateDummyData1();
+
+  for (bool ignoreFiles : {false, true}) {
+    ExplorationOptions options;
+    options.depthLimit = 999;
+    options.ignoreFiles = ignoreFiles;
+    std::vector<std::string> expected;
+    NamespaceExplorer explorer("/eos", options, qcl(), executor());
+    NamespaceItem item;
+
+    while (explorer.fetch(item)) {
+      expected.push_back(item.fullPath);
+    }
+
+    ASSERT_FALSE(expected.empty());
+
+    for (size_t workers : {1, 4}) {
+      for (size_t lookahead : {1, 1024}) {
+        for (bool ordered : {true, false}) {
+          ParallelExplorationOptions parallel;
+          parallel.numWorkers = workers;
+          parallel.maxLookahead = lookahead;
+          parallel.ordered = ordered;
+          ParallelNamespaceExplorer pexplorer("/eos", options, parallel, qcl(),
+                                              executor());
+          std::vector<std::string> found;
+
+          while (pexplorer.fetch(item)) {
+            found.push_back(item.fullPath);
+          }
+
+          ASSERT_FALSE(pexplorer.fetch(item));
+
+          if (ordered) {
+            ASSERT_EQ(found, expected);
+          } else {
+            ASSERT_EQ(std::set<std::string>(found.begin(), found.end()),
+                      std::set<std::string>(expected.begin(), expected.end()));
+            ASSERT_EQ(found.size(), expected.size());
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST_F(NamespaceExplorerF, ParallelBasicSanity)
+{
+  populateDummyData1();
+  ExplorationOptions options;
+  options.depthLimit = 999;
+  ParallelExplorationOptions parallel;
+  // Invalid path
+  ASSERT_THROW(eos::ParallelNamespaceExplorer("/eos/invalid/path", options,
+               parallel, qcl(), executor()), eos::MDException);
+  // Find on single file
+  ParallelNamespaceExplorer explorer("/eos/d2/d3-2/my-file", options, parallel,
+                                     qcl(), executor());
+  NamespaceItem item;
+  ASSERT_TRUE(explorer.fetch(item));
+  ASSERT_TRUE(item.isFile);
+  ASSERT_EQ(item.fullPath, "/eos/d2/d3-2/my-file");
+  ASSERT_FALSE(explorer.fetch(item));
+  // Expansion decider applies to the parallel explorer as well
+  options.expansionDecider.reset(new ContainerFilter());
+  ParallelNamespaceExplorer explorer2("/eos/d2", options, parallel, qcl(),
+                                      executor());
+  std::vector<std::string> found;
+
+  while (explorer2.fetch(item)) {
+    found.push_back(item.fullPath);
+
+    if (item.fullPath == "/eos/d2/d4/") {
+      ASSERT_TRUE(item.expansionFilteredOut);
+    }
+  }
+
+  ASSERT_EQ(found.back(), "/eos/d2/d4/");
+  ASSERT_EQ(found.size(), 15u);
+}
+
+TEST_F(NamespaceExplorerF, ParallelBufferedItems)
+{
+  // Wide directories, a few of them fill up the buffer
+  for (size_t i = 0; i < 20; i++) {
+    view()->createContainer(SSTR("/eos/wide/d" << i << "/"), true);
+
+    for (size_t j = 0; j < 100; j++) {
+      view()->createFile(SSTR("/eos/wide/d" << i << "/f" << j), true);
+    }
+  }
+
+  mdFlusher()->synchronize();
+  ExplorationOptions options;
+  options.depthLimit = 999;
+  ParallelExplorationOptions parallel;
+  parallel.numWorkers = 2;
+  parallel.maxBufferedItems = 100;
+  ParallelNamespaceExplorer explorer("/eos/wide", options, parallel, qcl(),
+                                     executor());
+  NamespaceItem item;
+  ASSERT_TRUE(explorer.fetch(item));
+  ASSERT_EQ(item.fullPath, "/eos/wide/");
+  // Give the workers time to run ahead of the slow consumer
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  size_t count = 1;
+
+  while (explorer.fetch(item)) {
+    count++;
+  }
+
+  ASSERT_EQ(count, 1u + 20 * 101);
+  // Every worker may complete one directory above the limit
+  ASSERT_LE(explorer.getPeakBufferedItems(), 100u + 2 * 101);
+}
+
 TEST_F(VariousTests, LinkedExtendedAttributes)
 {
   IContainerMDPtr cont1 = view()->createContainer("/eos/dir1", true);
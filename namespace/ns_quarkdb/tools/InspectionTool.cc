@@ -266,6 +266,14 @@ int main(int argc, char* argv[])
   addClusterOptions(checkOrphansSubcommand, membersStr, memberValidator, password,
                     passwordFile);
   //----------------------------------------------------------------------------
+  // Set-up rebuild-policy-index subcommand..
+  //----------------------------------------------------------------------------
+  auto rebuildPolicyIndexSubcommand = app.add_subcommand("rebuild-policy-index",
+                                      "Rebuild the index of directories holding policy attributes (LRU), safe to run while the MGM is online");
+  addClusterOptions(rebuildPolicyIndexSubcommand, membersStr, memberValidator,
+                    password, passwordFile);
+  addDryRun(rebuildPolicyIndexSubcommand, noDryRun);
+  //----------------------------------------------------------------------------
   // Set-up check-fsview-missing subcommand..
   //----------------------------------------------------------------------------
   auto checkFsViewMissingSubcommand = app.add_subcommand("check-fsview-missing",
@@ -542,6 +550,10 @@ int main(int argc, char* argv[])
     return inspector.checkOrphans(std::cout, std::cerr);
   }
 
+  if (rebuildPolicyIndexSubcommand->parsed()) {
+    return inspector.rebuildPolicyIndex(dryRun, std::cout, std::cerr);
+  }
+
   if (checkFsViewMissingSubcommand->parsed()) {
     return inspector.checkFsViewMissing(std::cout, std::cerr);
   }
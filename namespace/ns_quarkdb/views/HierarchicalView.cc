@@ -184,11 +184,7 @@ QuarkHierarchicalView::getItem(const std::string& uri, bool follow)
   //----------------------------------------------------------------------------
   std::deque<std::string> pendingChunks;
   eos::PathProcessor::insertChunksIntoDeque(pendingChunks, uri);
-  //----------------------------------------------------------------------------
-  // Initial state: We're at "/", and have to look up all chunks.
-  //----------------------------------------------------------------------------
-  FileOrContainerMD initialState {nullptr, pRoot};
-  return getPathInternal(initialState, pendingChunks, follow, 0);
+  return lookupPath(pendingChunks, follow);
 }
 
 //------------------------------------------------------------------------------
@@ -199,13 +195,102 @@ static FileOrContainerMD toFileOrContainerMD(IContainerMDPtr ptr)
   return {nullptr, ptr};
 }
 
+//------------------------------------------------------------------------------
+// Convert a FileMDPtr to FileOrContainerMD.
+//------------------------------------------------------------------------------
+static FileOrContainerMD fileToFileOrContainerMD(IFileMDPtr ptr)
+{
+  return {ptr, nullptr};
+}
+
+//------------------------------------------------------------------------------
+// Convert a FileOrContainerMD to a dentry cache entry.
+//------------------------------------------------------------------------------
+static DentryCache::Entry toDentry(const FileOrContainerMD& item)
+{
+  if (item.container) {
+    return {DentryCache::Kind::Container, item.container->getId()};
+  } else if (item.file) {
+    return {DentryCache::Kind::File, item.file->getId()};
+  }
+
+  return {DentryCache::Kind::Negative, 0};
+}
+
+//------------------------------------------------------------------------------
+// Lookup a given absolute path, starting from the longest cached prefix.
+//------------------------------------------------------------------------------
+folly::Future<FileOrContainerMD>
+QuarkHierarchicalView::lookupPath(const std::deque<std::string>& chunks,
+                                  bool follow)
+{
+  //----------------------------------------------------------------------------
+  // Initial state: We're at "/", and have to look up all chunks. Paths with
+  // "." or ".." are not cached, they don't map to a single entry.
+  //----------------------------------------------------------------------------
+  FileOrContainerMD initialState {nullptr, pRoot};
+  DentryCache::Tracker tracker;
+  bool cacheable = (pDentryCache != nullptr);
+
+  for (const auto& chunk : chunks) {
+    if (chunk == "." || chunk == "..") {
+      cacheable = false;
+      break;
+    }
+  }
+
+  if (!cacheable) {
+    return getPathInternal(initialState, chunks, follow, 0, tracker);
+  }
+
+  DentryCache::Entry entry;
+  size_t depth = pDentryCache->lookup(chunks, entry, tracker);
+
+  if (depth == 0) {
+    return getPathInternal(initialState, chunks, follow, 0, tracker);
+  }
+
+  if (entry.kind == DentryCache::Kind::Negative) {
+    return folly::makeFuture<FileOrContainerMD>(make_mdexception(ENOENT,
+           "No such file or directory"));
+  }
+
+  if (entry.kind == DentryCache::Kind::File && depth < chunks.size()) {
+    //--------------------------------------------------------------------------
+    // A symlink or a file in the middle of the path, do the full lookup.
+    //--------------------------------------------------------------------------
+    tracker.path.clear();
+    return getPathInternal(initialState, chunks, follow, 0, tracker);
+  }
+
+  std::deque<std::string> pendingChunks(chunks.begin() + depth, chunks.end());
+  folly::Future<FileOrContainerMD> fut = (entry.kind ==
+                                          DentryCache::Kind::Container) ?
+    pContainerSvc->getContainerMDFut(entry.id).thenValue(toFileOrContainerMD) :
+    pFileSvc->getFileMDFut(entry.id).thenValue(fileToFileOrContainerMD);
+  fut = std::move(fut).thenError([entry](const folly::exception_wrapper & e) {
+    // Should not happen, the entry is dropped once its parent changes
+    eos_static_crit("Exception occurred while looking up cached dentry "
+                    "with id %llu: %s", entry.id, e.what().c_str());
+    return FileOrContainerMD {};
+  });
+
+  if (fut.isReady()) {
+    return getPathInternal(std::move(fut).get(), pendingChunks, follow, 0,
+                           tracker);
+  }
+
+  return getPathDeferred(std::move(fut), pendingChunks, follow, 0, tracker);
+}
+
 //------------------------------------------------------------------------------
 // Lookup a given path - deferred function.
 //------------------------------------------------------------------------------
 folly::Future<FileOrContainerMD>
 QuarkHierarchicalView::getPathDeferred(folly::Future<FileOrContainerMD> fut,
                                   std::deque<std::string> pendingChunks,
-                                  bool follow, size_t expendedEffort)
+                                  bool follow, size_t expendedEffort,
+                                  DentryCache::Tracker tracker)
 {
   //----------------------------------------------------------------------------
   // We're blocked on a network request. "Pause" execution of getPathInternal
@@ -216,7 +301,7 @@ QuarkHierarchicalView::getPathDeferred(folly::Future<FileOrContainerMD> fut,
   //----------------------------------------------------------------------------
   return fut.via(pExecutor.get())
          .thenValue(std::bind(&QuarkHierarchicalView::getPathInternal, this, _1, pendingChunks,
-                         follow, expendedEffort));
+                         follow, expendedEffort, tracker));
 }
 
 //------------------------------------------------------------------------------
@@ -225,7 +310,8 @@ QuarkHierarchicalView::getPathDeferred(folly::Future<FileOrContainerMD> fut,
 folly::Future<FileOrContainerMD>
 QuarkHierarchicalView::getPathDeferred(folly::Future<IContainerMDPtr> fut,
                                   std::deque<std::string> pendingChunks,
-                                  bool follow, size_t expendedEffort)
+                                  bool follow, size_t expendedEffort,
+                                  DentryCache::Tracker tracker)
 {
   //----------------------------------------------------------------------------
   // Same as getPathDeferred taking FileOrContainerMD.
@@ -233,7 +319,7 @@ QuarkHierarchicalView::getPathDeferred(folly::Future<IContainerMDPtr> fut,
   return fut.via(pExecutor.get())
          .thenValue(toFileOrContainerMD)
          .thenValue(std::bind(&QuarkHierarchicalView::getPathInternal, this, _1, pendingChunks,
-                         follow, expendedEffort));
+                         follow, expendedEffort, tracker));
 }
 
 //------------------------------------------------------------------------------
@@ -242,7 +328,8 @@ QuarkHierarchicalView::getPathDeferred(folly::Future<IContainerMDPtr> fut,
 folly::Future<FileOrContainerMD>
 QuarkHierarchicalView::getPathInternal(FileOrContainerMD state,
                                   std::deque<std::string> pendingChunks,
-                                  bool follow, size_t expendedEffort)
+                                  bool follow, size_t expendedEffort,
+                                  DentryCache::Tracker tracker)
 {
   //----------------------------------------------------------------------------
   // Our goal is to consume pendingChunks until it's empty.
@@ -263,6 +350,14 @@ QuarkHierarchicalView::getPathInternal(FileOrContainerMD state,
                ELOOP, "Too many symbolic links were encountered in translating the pathname"));
     }
 
+    //--------------------------------------------------------------------------
+    // Remember the result of the previous chunk, including non-existence.
+    //--------------------------------------------------------------------------
+    if (tracker.active && tracker.fresh) {
+      pDentryCache->insert(tracker, toDentry(state));
+      tracker.fresh = false;
+    }
+
     if (!state.container && !state.file) {
       //------------------------------------------------------------------------
       // The previous iteration of the loop resulted in an empty state: Only one
@@ -296,6 +391,7 @@ QuarkHierarchicalView::getPathInternal(FileOrContainerMD state,
 
       if (pendingChunks.front() == "..") {
         pendingChunks.pop_front();
+        tracker.active = false;
         folly::Future<IContainerMDPtr> fut = pContainerSvc->getContainerMDFut(
                                                state.container->getParentId());
 
@@ -303,7 +399,8 @@ QuarkHierarchicalView::getPathInternal(FileOrContainerMD state,
           //--------------------------------------------------------------------
           // We're blocked, "pause" execution, unblock caller.
           //--------------------------------------------------------------------
-          return getPathDeferred(std::move(fut), pendingChunks, follow, expendedEffort);
+          return getPathDeferred(std::move(fut), pendingChunks, follow, expendedEffort,
+                                 tracker);
         }
 
         state.container = std::move(fut).get();
@@ -316,6 +413,11 @@ QuarkHierarchicalView::getPathInternal(FileOrContainerMD state,
       //------------------------------------------------------------------------
       folly::Future<FileOrContainerMD> next = state.container->findItem(
           pendingChunks.front());
+
+      if (tracker.active) {
+        tracker.descend(pendingChunks.front());
+      }
+
       pendingChunks.pop_front();
 
       //------------------------------------------------------------------------
@@ -329,7 +431,8 @@ QuarkHierarchicalView::getPathInternal(FileOrContainerMD state,
         //----------------------------------------------------------------------
         // We're blocked, "pause" execution, unblock caller.
         //----------------------------------------------------------------------
-        return getPathDeferred(std::move(next), pendingChunks, follow, expendedEffort);
+        return getPathDeferred(std::move(next), pendingChunks, follow, expendedEffort,
+                               tracker);
       }
     }
 
@@ -360,6 +463,7 @@ QuarkHierarchicalView::getPathInternal(FileOrContainerMD state,
       // Populate our pendingChunks with the updated target.
       //------------------------------------------------------------------------
       const std::string& symlinkTarget = state.file->getLink();
+      tracker.active = false;
       eos::PathProcessor::insertChunksIntoDeque(pendingChunks, symlinkTarget);
 
       if (!symlinkTarget.empty() && symlinkTarget[0] == '/') {
@@ -378,7 +482,8 @@ QuarkHierarchicalView::getPathInternal(FileOrContainerMD state,
           //--------------------------------------------------------------------
           // We're blocked, "pause" execution, unblock caller.
           //--------------------------------------------------------------------
-          return getPathDeferred(std::move(fut), pendingChunks, follow, expendedEffort);
+          return getPathDeferred(std::move(fut), pendingChunks, follow, expendedEffort,
+                                 tracker);
         }
 
         state.container = std::move(fut).get();
@@ -429,8 +534,7 @@ QuarkHierarchicalView::createFile(const std::string& uri, uid_t uid, gid_t gid,
 
   std::string lastChunk = chunks.back();
   chunks.pop_back();
-  FileOrContainerMD item = getPathInternal(FileOrContainerMD {nullptr, pRoot},
-                           chunks, true, 0).get();
+  FileOrContainerMD item = lookupPath(chunks, true).get();
 
   if (item.file) {
     throw_mdexception(ENOTDIR, "Not a directory");
@@ -641,7 +745,8 @@ QuarkHierarchicalView::createContainer(const std::string& uri, bool createParent
 
     // Lookup next chunk ..
     try {
-      state = getPathInternal(state, nextChunkDeque, true, 0).get();
+      state = getPathInternal(state, nextChunkDeque, true, 0,
+                              DentryCache::Tracker()).get();
     } catch (const eos::MDException& e) {
       if (e.getErrno() != ENOENT) {
         // Something's wrong, rethrow
@@ -682,8 +787,7 @@ QuarkHierarchicalView::getPathExpectContainer(const std::deque<std::string>& chu
     return pRoot;
   }
 
-  return getPathInternal(FileOrContainerMD {nullptr, pRoot}, chunks, true, 0)
-         .thenValue(extractContainerMD);
+  return lookupPath(chunks, true).thenValue(extractContainerMD);
 }
 
 //------------------------------------------------------------------------------
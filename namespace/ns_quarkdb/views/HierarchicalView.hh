@@ -29,6 +29,7 @@
 #include "namespace/interface/IFileMDSvc.hh"
 #include "namespace/interface/IView.hh"
 #include "namespace/ns_quarkdb/accounting/QuotaStats.hh"
+#include "namespace/ns_quarkdb/persistency/DentryCache.hh"
 
 #ifdef __clang__
 #pragma clang diagnostic ignored "-Wunused-private-field"
@@ -72,6 +73,16 @@ public:
     return pContainerSvc;
   }
 
+  //----------------------------------------------------------------------------
+  //! Specify the path lookup cache, kept up to date by the container service.
+  //! No ownership, nullptr disables it.
+  //----------------------------------------------------------------------------
+  void
+  setDentryCache(DentryCache* cache)
+  {
+    pDentryCache = cache;
+  }
+
   //----------------------------------------------------------------------------
   //! Specify a pointer to the underlying file service that alocates the
   //! actual files
@@ -302,24 +313,33 @@ public:
 private:
   //----------------------------------------------------------------------------
   //! Lookup a given path - internal function.
+  //!
+  //! @param tracker path of the state, used to cache the lookup results
   //----------------------------------------------------------------------------
   folly::Future<FileOrContainerMD>
   getPathInternal(FileOrContainerMD state, std::deque<std::string> pendingChunks,
-    bool follow, size_t expendedEffort);
+    bool follow, size_t expendedEffort, DentryCache::Tracker tracker);
 
   //----------------------------------------------------------------------------
   //! Lookup a given path - deferred function.
   //----------------------------------------------------------------------------
   folly::Future<FileOrContainerMD>
   getPathDeferred(folly::Future<FileOrContainerMD> fut, std::deque<std::string> pendingChunks,
-    bool follow, size_t expendedEffort);
+    bool follow, size_t expendedEffort, DentryCache::Tracker tracker);
 
   //----------------------------------------------------------------------------
   //! Lookup a given path - deferred function.
   //----------------------------------------------------------------------------
   folly::Future<FileOrContainerMD>
   getPathDeferred(folly::Future<IContainerMDPtr> fut, std::deque<std::string> pendingChunks,
-    bool follow, size_t expendedEffort);
+    bool follow, size_t expendedEffort, DentryCache::Tracker tracker);
+
+  //----------------------------------------------------------------------------
+  //! Lookup a given absolute path, starting from the longest prefix found in
+  //! the dentry cache.
+  //----------------------------------------------------------------------------
+  folly::Future<FileOrContainerMD>
+  lookupPath(const std::deque<std::string>& chunks, bool follow);
 
   //----------------------------------------------------------------------------
   //! Lookup a given path, expect a container there.
@@ -368,6 +388,7 @@ private:
   IQuotaStats* pQuotaStats;
   std::shared_ptr<IContainerMD> pRoot;
   std::unique_ptr<folly::Executor> pExecutor;
+  DentryCache* pDentryCache = nullptr;
 };
 
 EOSNSNAMESPACE_END
@@ -0,0 +1,208 @@
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2023 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+#include "namespace/utils/ObjectLocks.hh"
+#include <algorithm>
+
+EOSNSNAMESPACE_BEGIN
+
+//------------------------------------------------------------------------------
+// Constructor
+//------------------------------------------------------------------------------
+ObjectLockTable::ObjectLockTable(size_t num_stripes)
+{
+  size_t size = 1;
+
+  while (size < num_stripes) {
+    size <<= 1;
+  }
+
+  mMask = size - 1;
+  mStripes.reset(new Stripe[size]);
+}
+
+//------------------------------------------------------------------------------
+// Get the index of the mutex protecting the given object
+//------------------------------------------------------------------------------
+size_t
+ObjectLockTable::GetStripe(Type type, uint64_t id) const
+{
+  // Consecutive ids, e.g. the files created in a directory, are spread over
+  // the stripes and a container does not share the stripe of the file with
+  // the same id
+  uint64_t key = (id << 1) | (type == Type::kFile ? 1 : 0);
+  key *= 0x9e3779b97f4a7c15ull;
+  return (key >> 32) & mMask;
+}
+
+//------------------------------------------------------------------------------
+// Lock the given objects
+//------------------------------------------------------------------------------
+void
+ObjectLock::Lock(const Request* begin, const Request* end)
+{
+  Release();
+
+  for (auto it = begin; it != end; ++it) {
+    mLocked.emplace_back(mTable.GetStripe(it->mType, it->mId),
+                         it->mMode == Mode::kWrite);
+  }
+
+  // Lock in increasing stripe order, each stripe once and for write if any of
+  // its objects is requested for write
+  std::sort(mLocked.begin(), mLocked.end(),
+  [](const std::pair<size_t, bool>& a, const std::pair<size_t, bool>& b) {
+    return (a.first < b.first) || ((a.first == b.first) && (a.second > b.second));
+  });
+  mLocked.erase(std::unique(mLocked.begin(), mLocked.end(),
+                            [](const std::pair<size_t, bool>& a,
+  const std::pair<size_t, bool>& b) {
+    return a.first == b.first;
+  }), mLocked.end());
+
+  for (const auto& elem : mLocked) {
+    if (elem.second) {
+      mTable.GetMutex(elem.first).lock();
+    } else {
+      mTable.GetMutex(elem.first).lock_shared();
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// Lock one more object keeping the ones locked before
+//------------------------------------------------------------------------------
+bool
+ObjectLock::TryAdd(const Request& request)
+{
+  const size_t stripe = mTable.GetStripe(request.mType, request.mId);
+  const bool write = (request.mMode == Mode::kWrite);
+  auto it = std::lower_bound(mLocked.begin(), mLocked.end(),
+                             std::make_pair(stripe, true),
+  [](const std::pair<size_t, bool>& a, const std::pair<size_t, bool>& b) {
+    return a.first < b.first;
+  });
+
+  if ((it != mLocked.end()) && (it->first == stripe)) {
+    // Already held, a read lock can not be upgraded
+    return (it->second || !write);
+  }
+
+  std::shared_mutex& mutex = mTable.GetMutex(stripe);
+
+  if (it == mLocked.end()) {
+    // Beyond the mutexes held, the order is respected
+    if (write) {
+      mutex.lock();
+    } else {
+      mutex.lock_shared();
+    }
+  } else if (!(write ? mutex.try_lock() : mutex.try_lock_shared())) {
+    return false;
+  }
+
+  mLocked.emplace(it, stripe, write);
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// Release the locks
+//------------------------------------------------------------------------------
+void
+ObjectLock::Release()
+{
+  for (auto it = mLocked.rbegin(); it != mLocked.rend(); ++it) {
+    if (it->second) {
+      mTable.GetMutex(it->first).unlock();
+    } else {
+      mTable.GetMutex(it->first).unlock_shared();
+    }
+  }
+
+  mLocked.clear();
+}
+
+//------------------------------------------------------------------------------
+// Grab the global mutex
+//------------------------------------------------------------------------------
+void
+NsObjectLock::Grab(eos::common::RWMutex& ns_mutex, ObjectLockTable& table,
+                   bool fine_grained, const char* function, int line,
+                   const char* file)
+{
+  Release();
+
+  if (fine_grained) {
+    mRequests.clear();
+    mRdLock.Grab(ns_mutex, function, line, file);
+    mObjLock.reset(new ObjectLock(table));
+  } else {
+    mWrLock.Grab(ns_mutex, function, line, file);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Lock the given objects for write
+//------------------------------------------------------------------------------
+void
+NsObjectLock::Lock(std::initializer_list
+                   <std::pair<ObjectLockTable::Type, uint64_t>> objects)
+{
+  if (!mObjLock) {
+    return;
+  }
+
+  mRequests.clear();
+  mRequests.reserve(objects.size());
+
+  for (const auto& obj : objects) {
+    mRequests.push_back({obj.first, obj.second, ObjectLock::Mode::kWrite});
+  }
+
+  mObjLock->Lock(mRequests);
+}
+
+//------------------------------------------------------------------------------
+// Lock one more object for write
+//------------------------------------------------------------------------------
+void
+NsObjectLock::Add(ObjectLockTable::Type type, uint64_t id)
+{
+  if (!mObjLock) {
+    return;
+  }
+
+  mRequests.push_back({type, id, ObjectLock::Mode::kWrite});
+
+  if (!mObjLock->TryAdd(mRequests.back())) {
+    mObjLock->Lock(mRequests);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Release the object locks and the global mutex
+//------------------------------------------------------------------------------
+void
+NsObjectLock::Release()
+{
+  mObjLock.reset();
+  mRdLock.Release();
+  mWrLock.Release();
+}
+
+EOSNSNAMESPACE_END
@@ -0,0 +1,287 @@
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2023 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+//------------------------------------------------------------------------------
+//! @brief Per container and per file locks of the namespace
+//------------------------------------------------------------------------------
+
+#pragma once
+#include "namespace/Namespace.hh"
+#include "common/RWMutex.hh"
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <shared_mutex>
+#include <utility>
+#include <vector>
+
+EOSNSNAMESPACE_BEGIN
+
+//------------------------------------------------------------------------------
+//! Class ObjectLockTable - read-write locks of the individual containers and
+//! files of the namespace. The locks are striped i.e. an object maps to one of
+//! a fixed number of mutexes, two objects sharing a mutex only contend with
+//! each other.
+//!
+//! The locking is hierarchical:
+//! 1. the global namespace mutex is taken for write by the operations which
+//!    change more than a handful of objects and by the code which was not
+//!    migrated, for read by everybody else
+//! 2. the object locks are taken while holding the global mutex for read,
+//!    all of them at once through an ObjectLock which orders them
+//! 3. the mutexes internal to the metadata objects
+//!
+//! An operation holding the global mutex for write does not need any object
+//! lock. A thread holds at most one ObjectLock and does not take the global
+//! mutex again while holding it.
+//------------------------------------------------------------------------------
+class ObjectLockTable
+{
+public:
+  //! Type of the locked object, containers and files have separate ids
+  enum class Type { kContainer, kFile };
+
+  //----------------------------------------------------------------------------
+  //! Constructor
+  //!
+  //! @param num_stripes number of mutexes, rounded up to a power of 2
+  //----------------------------------------------------------------------------
+  explicit ObjectLockTable(size_t num_stripes = 4096);
+
+  //----------------------------------------------------------------------------
+  //! Get the index of the mutex protecting the given object
+  //----------------------------------------------------------------------------
+  size_t GetStripe(Type type, uint64_t id) const;
+
+  //----------------------------------------------------------------------------
+  //! Get the mutex with the given index
+  //----------------------------------------------------------------------------
+  std::shared_mutex& GetMutex(size_t stripe)
+  {
+    return mStripes[stripe].mMutex;
+  }
+
+  //----------------------------------------------------------------------------
+  //! Get the number of mutexes
+  //----------------------------------------------------------------------------
+  size_t GetNumStripes() const
+  {
+    return mMask + 1;
+  }
+
+private:
+  //! Mutex alone on its cache line
+  struct alignas(64) Stripe {
+    std::shared_mutex mMutex;
+  };
+
+  size_t mMask; ///< Number of stripes - 1
+  std::unique_ptr<Stripe[]> mStripes;
+};
+
+//------------------------------------------------------------------------------
+//! Class ObjectLock - holds the locks of a set of namespace objects, taken in
+//! the order of their mutexes so that operations locking several objects e.g.
+//! the source and destination containers of a rename can not deadlock.
+//------------------------------------------------------------------------------
+class ObjectLock
+{
+public:
+  enum class Mode { kRead, kWrite };
+
+  //! Object to lock
+  struct Request {
+    ObjectLockTable::Type mType;
+    uint64_t mId;
+    Mode mMode;
+  };
+
+  //----------------------------------------------------------------------------
+  //! Constructor - nothing locked yet
+  //!
+  //! @param table lock table
+  //----------------------------------------------------------------------------
+  explicit ObjectLock(ObjectLockTable& table):
+    mTable(table)
+  {}
+
+  //----------------------------------------------------------------------------
+  //! Constructor locking the given objects
+  //!
+  //! @param table lock table
+  //! @param requests objects to lock
+  //----------------------------------------------------------------------------
+  ObjectLock(ObjectLockTable& table, std::initializer_list<Request> requests):
+    mTable(table)
+  {
+    Lock(requests);
+  }
+
+  //----------------------------------------------------------------------------
+  //! Destructor - releases the locks
+  //----------------------------------------------------------------------------
+  ~ObjectLock()
+  {
+    Release();
+  }
+
+  //----------------------------------------------------------------------------
+  //! Don't allow copy or move of these objects
+  //----------------------------------------------------------------------------
+  ObjectLock(const ObjectLock&) = delete;
+  ObjectLock& operator =(const ObjectLock&) = delete;
+
+  //----------------------------------------------------------------------------
+  //! Lock the given objects, releasing the ones locked before. An object
+  //! requested in both modes is locked for write.
+  //!
+  //! @param requests objects to lock
+  //----------------------------------------------------------------------------
+  void Lock(std::initializer_list<Request> requests)
+  {
+    Lock(requests.begin(), requests.end());
+  }
+
+  void Lock(const std::vector<Request>& requests)
+  {
+    Lock(requests.data(), requests.data() + requests.size());
+  }
+
+  //----------------------------------------------------------------------------
+  //! Lock one more object keeping the ones locked before. Out of the stripe
+  //! order the mutex is only tried, so that this can not deadlock.
+  //!
+  //! @param request object to lock
+  //!
+  //! @return true if locked, false if the caller has to lock all its objects
+  //!         again with Lock
+  //----------------------------------------------------------------------------
+  bool TryAdd(const Request& request);
+
+  //----------------------------------------------------------------------------
+  //! Release the locks
+  //----------------------------------------------------------------------------
+  void Release();
+
+  //----------------------------------------------------------------------------
+  //! Get the number of mutexes held
+  //----------------------------------------------------------------------------
+  size_t GetNumLocked() const
+  {
+    return mLocked.size();
+  }
+
+private:
+  void Lock(const Request* begin, const Request* end);
+
+  ObjectLockTable& mTable;
+  //! Indexes of the mutexes held, in locking order, and if held for write
+  std::vector<std::pair<size_t, bool>> mLocked;
+};
+
+//------------------------------------------------------------------------------
+//! Class NsObjectLock - namespace locking of an operation which changes only a
+//! few objects. With fine grained locking the global mutex is taken for read
+//! and the objects given to Lock are locked for write, otherwise the global
+//! mutex is taken for write and Lock does nothing. The objects are resolved
+//! after grabbing the global mutex and locked before being changed.
+//------------------------------------------------------------------------------
+class NsObjectLock
+{
+public:
+  //----------------------------------------------------------------------------
+  //! Constructor - nothing locked yet
+  //----------------------------------------------------------------------------
+  NsObjectLock() = default;
+
+  //----------------------------------------------------------------------------
+  //! Constructor grabbing the global mutex
+  //!
+  //! @param ns_mutex global namespace mutex
+  //! @param table object lock table
+  //! @param fine_grained if true use the object locks
+  //----------------------------------------------------------------------------
+  NsObjectLock(eos::common::RWMutex& ns_mutex, ObjectLockTable& table,
+               bool fine_grained, const char* function = "unknown",
+               int line = 0, const char* file = "unknown")
+  {
+    Grab(ns_mutex, table, fine_grained, function, line, file);
+  }
+
+  //----------------------------------------------------------------------------
+  //! Destructor - releases the object locks then the global mutex
+  //----------------------------------------------------------------------------
+  ~NsObjectLock()
+  {
+    Release();
+  }
+
+  //----------------------------------------------------------------------------
+  //! Don't allow copy or move of these objects
+  //----------------------------------------------------------------------------
+  NsObjectLock(const NsObjectLock&) = delete;
+  NsObjectLock& operator =(const NsObjectLock&) = delete;
+
+  //----------------------------------------------------------------------------
+  //! Grab the global mutex, for read if fine_grained otherwise for write
+  //----------------------------------------------------------------------------
+  void Grab(eos::common::RWMutex& ns_mutex, ObjectLockTable& table,
+            bool fine_grained, const char* function = "unknown",
+            int line = 0, const char* file = "unknown");
+
+  //----------------------------------------------------------------------------
+  //! Lock the given objects for write, releasing the ones locked before.
+  //! Nothing to do if the global mutex is held for write.
+  //!
+  //! @param objects type and id of the objects about to be changed
+  //----------------------------------------------------------------------------
+  void Lock(std::initializer_list<std::pair<ObjectLockTable::Type, uint64_t>>
+            objects);
+
+  //----------------------------------------------------------------------------
+  //! Lock one more object for write e.g. an entry just created in a locked
+  //! container. The objects locked before stay locked, unless the locking
+  //! order forces to release and lock all of them again. Nothing to do if the
+  //! global mutex is held for write.
+  //!
+  //! @param type object type
+  //! @param id object id
+  //----------------------------------------------------------------------------
+  void Add(ObjectLockTable::Type type, uint64_t id);
+
+  //----------------------------------------------------------------------------
+  //! Release the object locks and the global mutex
+  //----------------------------------------------------------------------------
+  void Release();
+
+  //----------------------------------------------------------------------------
+  //! Check if the object locks are used
+  //----------------------------------------------------------------------------
+  bool IsFineGrained() const
+  {
+    return (mObjLock != nullptr);
+  }
+
+private:
+  eos::common::RWMutexReadLock mRdLock;
+  eos::common::RWMutexWriteLock mWrLock;
+  std::unique_ptr<ObjectLock> mObjLock;
+  std::vector<ObjectLock::Request> mRequests; ///< Objects currently locked
+};
+
+EOSNSNAMESPACE_END
@@ -0,0 +1,144 @@
+//------------------------------------------------------------------------------
+// File: EosBufferBenchmark.cc
+//------------------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2023 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+//------------------------------------------------------------------------------
+//! Measure the cost of obtaining and filling buffers of the sizes used by the
+//! RAIN blocks and the readahead blocks: zero-initialised std::vector (the
+//! previous Buffer implementation) versus uninitialised buffers backed by
+//! normal, transparent huge or hugetlbfs pages, with and without recycling
+//! through the BufferManager. Reports time and minor page faults per buffer.
+//!
+//! Usage: eos-buffer-benchmark [iterations] [threads]
+//------------------------------------------------------------------------------
+#include "common/BufferManager.hh"
+#include "common/StringConversion.hh"
+#include <sys/resource.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <thread>
+#include <vector>
+
+using eos::common::Buffer;
+using eos::common::BufferManager;
+
+//------------------------------------------------------------------------------
+// Get number of minor page faults of the process so far
+//------------------------------------------------------------------------------
+long
+GetMinorFaults()
+{
+  struct rusage usage;
+  (void) getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_minflt;
+}
+
+//------------------------------------------------------------------------------
+// Run the given function from multiple threads and print time and minor page
+// faults per iteration
+//------------------------------------------------------------------------------
+void
+Measure(const char* name, size_t iterations, size_t threads,
+        std::function<void()> func)
+{
+  long faults = GetMinorFaults();
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> workers;
+
+  for (size_t t = 0; t < threads; ++t) {
+    workers.emplace_back([&]() {
+      for (size_t i = 0; i < iterations; ++i) {
+        func();
+      }
+    });
+  }
+
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  std::chrono::duration<double, std::micro> elapsed =
+    std::chrono::steady_clock::now() - start;
+  double total = 1.0 * iterations * threads;
+  fprintf(stdout, "  %-24s %10.1f us/buffer %10.1f faults/buffer\n", name,
+          elapsed.count() * threads / total,
+          (GetMinorFaults() - faults) / total);
+}
+
+int main(int argc, char* argv[])
+{
+  size_t iterations = (argc > 1) ? atoi(argv[1]) : 100;
+  size_t threads = (argc > 2) ? atoi(argv[2]) : 4;
+  const std::vector<uint64_t> sizes {
+    64 * eos::common::KB, 1 * eos::common::MB, 4 * eos::common::MB,
+    16 * eos::common::MB, 64 * eos::common::MB
+  };
+  fprintf(stdout, "iterations=%zu threads=%zu\n", iterations, threads);
+
+  for (auto size : sizes) {
+    fprintf(stdout, "buffer_size=%s\n",
+            eos::common::StringConversion::GetPrettySize(size).c_str());
+    // Buffer is written once, like a RAIN or readahead block. The barrier
+    // prevents the compiler from dropping the writes to a buffer which is
+    // freed right after.
+    auto fill = [size](char * ptr) {
+      (void) memset(ptr, 'a', size);
+      asm volatile("" : : "r"(ptr) : "memory");
+    };
+    Measure("vector", iterations, threads, [&]() {
+      std::vector<char> data(size, '\0');
+      fill(data.data());
+    });
+    Measure("pages", iterations, threads, [&]() {
+      Buffer buffer(size, Buffer::Backing::Pages);
+      fill(buffer.GetDataPtr());
+    });
+    Measure("thp", iterations, threads, [&]() {
+      Buffer buffer(size, Buffer::Backing::Thp);
+      fill(buffer.GetDataPtr());
+    });
+    Measure("hugetlb", iterations, threads, [&]() {
+      Buffer buffer(size, Buffer::Backing::HugeTlb);
+      fill(buffer.GetDataPtr());
+    });
+
+    for (auto backing : {
+           Buffer::Backing::Pages, Buffer::Backing::Thp
+         }) {
+      BufferManager buff_mgr(threads * size * 2, 0, size, backing);
+      Measure(backing == Buffer::Backing::Pages ? "manager pages" :
+              "manager thp", iterations, threads, [&]() {
+        auto buffer = buff_mgr.GetBuffer(size);
+        fill(buffer->GetDataPtr());
+        buff_mgr.Recycle(buffer);
+      });
+      auto stats = buff_mgr.GetStats();
+      fprintf(stdout, "  %-24s allocated=%llu reused=%llu\n", "",
+              (unsigned long long) stats.mAllocated,
+              (unsigned long long) stats.mReused);
+    }
+  }
+
+  return 0;
+}
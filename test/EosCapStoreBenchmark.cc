@@ -0,0 +1,257 @@
+//------------------------------------------------------------------------------
+// File: EosCapStoreBenchmark.cc
+//------------------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2023 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+//------------------------------------------------------------------------------
+//! Simulate the fusex capability traffic of many clients working on shared
+//! directories: every thread issues caps, looks up the caps of an inode as
+//! done for the broadcasts and periodically drops all the caps of a client.
+//! The previous layout, maps under a single mutex, is compared with the
+//! sharded CapStore.
+//!
+//! Usage: eos-capstore-benchmark [clients] [inodes] [ops/thread] [threads]
+//------------------------------------------------------------------------------
+#include "mgm/FuseServer/CapStore.hh"
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <thread>
+
+namespace
+{
+struct BenchCap {
+  std::string mAuthId;
+  uint64_t mId;
+  std::string mClientId;
+  std::string mClientUuid;
+  uint64_t mVtime;
+
+  const std::string& authid() const
+  {
+    return mAuthId;
+  }
+
+  uint64_t id() const
+  {
+    return mId;
+  }
+
+  const std::string& clientid() const
+  {
+    return mClientId;
+  }
+
+  const std::string& clientuuid() const
+  {
+    return mClientUuid;
+  }
+
+  uint64_t vtime() const
+  {
+    return mVtime;
+  }
+};
+
+using shared_cap = std::shared_ptr<BenchCap>;
+
+//------------------------------------------------------------------------------
+//! Single mutex store with the previous map layout
+//------------------------------------------------------------------------------
+class LegacyStore
+{
+public:
+  LegacyStore()
+  {
+    mMutex.SetBlocking(true);
+  }
+
+  void Store(const shared_cap& cap)
+  {
+    eos::common::RWMutexWriteLock wr_lock(mMutex);
+    auto it = mCaps.find(cap->authid());
+
+    if (it == mCaps.end()) {
+      mTimeOrdered.emplace(cap->vtime(), cap->authid());
+    }
+
+    mClientIds[cap->clientuuid()].insert(cap->clientid());
+    mClientInoCaps[cap->clientid()][cap->id()].insert(cap->authid());
+    mInodeCaps[cap->id()].insert(cap->authid());
+    mCaps[cap->authid()] = cap;
+  }
+
+  std::vector<std::string> GetInodeAuthIds(uint64_t ino)
+  {
+    eos::common::RWMutexReadLock rd_lock(mMutex);
+    auto it = mInodeCaps.find(ino);
+
+    if (it == mInodeCaps.end()) {
+      return {};
+    }
+
+    return std::vector<std::string>(it->second.begin(), it->second.end());
+  }
+
+  shared_cap Get(const std::string& authid)
+  {
+    eos::common::RWMutexReadLock rd_lock(mMutex);
+    auto it = mCaps.find(authid);
+    return ((it == mCaps.end()) ? nullptr : it->second);
+  }
+
+  void RemoveClient(const std::string& uuid)
+  {
+    // Full scan as done by the previous dropCaps
+    std::vector<shared_cap> caps;
+    {
+      eos::common::RWMutexReadLock rd_lock(mMutex);
+
+      for (const auto& elem : mCaps) {
+        if (elem.second->clientuuid() == uuid) {
+          caps.push_back(elem.second);
+        }
+      }
+    }
+    eos::common::RWMutexWriteLock wr_lock(mMutex);
+
+    for (const auto& cap : caps) {
+      mCaps.erase(cap->authid());
+      mInodeCaps[cap->id()].erase(cap->authid());
+
+      if (mInodeCaps[cap->id()].empty()) {
+        mInodeCaps.erase(cap->id());
+      }
+    }
+
+    auto it = mClientIds.find(uuid);
+
+    if (it != mClientIds.end()) {
+      for (const auto& client_id : it->second) {
+        mClientInoCaps.erase(client_id);
+      }
+
+      mClientIds.erase(it);
+    }
+  }
+
+  size_t Size()
+  {
+    eos::common::RWMutexReadLock rd_lock(mMutex);
+    return mCaps.size();
+  }
+
+private:
+  eos::common::RWMutex mMutex;
+  std::multimap<time_t, std::string> mTimeOrdered;
+  std::map<std::string, shared_cap> mCaps;
+  std::map<uint64_t, std::set<std::string>> mInodeCaps;
+  std::map<std::string, std::map<uint64_t, std::set<std::string>>>
+      mClientInoCaps;
+  std::map<std::string, std::set<std::string>> mClientIds;
+};
+
+//------------------------------------------------------------------------------
+//! Run the workload against a store
+//------------------------------------------------------------------------------
+template<typename StoreT>
+double
+Run(StoreT& store, size_t nclients, size_t ninodes, size_t nops,
+    size_t nthreads, size_t& nfound)
+{
+  std::vector<std::thread> workers;
+  std::vector<size_t> found(nthreads, 0);
+  auto start = std::chrono::steady_clock::now();
+
+  for (size_t t = 0; t < nthreads; ++t) {
+    workers.emplace_back([&, t]() {
+      uint64_t seed = 0x9e3779b97f4a7c15ull * (t + 1);
+
+      for (size_t i = 0; i < nops; ++i) {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        size_t client = seed % nclients;
+        uint64_t ino = 1 + (seed >> 20) % ninodes;
+        std::string sclient = std::to_string(client);
+
+        if (i % 1000 == 999) {
+          store.RemoveClient("uuid-" + sclient);
+        } else if (i % 4 == 0) {
+          auto cap = std::make_shared<BenchCap>(BenchCap{
+            sclient + ":" + std::to_string(ino), ino, "client-" + sclient,
+            "uuid-" + sclient, 1000 + i});
+          store.Store(cap);
+        } else {
+          for (const auto& authid : store.GetInodeAuthIds(ino)) {
+            if (store.Get(authid)) {
+              ++found[t];
+            }
+          }
+        }
+      }
+    });
+  }
+
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  nfound = 0;
+
+  for (auto count : found) {
+    nfound += count;
+  }
+
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start).count();
+}
+}
+
+int main(int argc, char* argv[])
+{
+  size_t nclients = (argc > 1) ? strtoul(argv[1], 0, 10) : 1000;
+  size_t ninodes = (argc > 2) ? strtoul(argv[2], 0, 10) : 10000;
+  size_t nops = (argc > 3) ? strtoul(argv[3], 0, 10) : 200000;
+  size_t max_threads = (argc > 4) ? strtoul(argv[4], 0, 10) : 16;
+
+  if (!nclients || !ninodes || !nops || !max_threads) {
+    std::cerr << "usage: " << argv[0]
+              << " [clients] [inodes] [ops/thread] [threads]" << std::endl;
+    return 1;
+  }
+
+  for (size_t nthreads = 1; nthreads <= max_threads; nthreads *= 2) {
+    size_t legacy_found, sharded_found;
+    LegacyStore legacy;
+    double legacy_sec = Run(legacy, nclients, ninodes, nops, nthreads,
+                            legacy_found);
+    eos::mgm::CapStore<BenchCap> sharded;
+    double sharded_sec = Run(sharded, nclients, ninodes, nops, nthreads,
+                             sharded_found);
+    std::cout << "threads: " << nthreads
+              << " legacy ops/s: " << (size_t)(nops * nthreads / legacy_sec)
+              << " (caps " << legacy.Size() << ")"
+              << " sharded ops/s: " << (size_t)(nops * nthreads / sharded_sec)
+              << " (caps " << sharded.Size() << ")" << std::endl;
+  }
+
+  return 0;
+}
@@ -33,6 +33,7 @@
 #include <string>
 #include <iostream>
 #include <thread>
+#include <algorithm>
 #include <stdio.h>
 /*-----------------------------------------------------------------------------*/
 
@@ -75,13 +76,19 @@ int main(int argc, char* argv[])
   g_logging.gShortFormat = true;
   g_logging.SetLogPriority(LOG_DEBUG);
 
-  if (argc==1) {
-    fprintf(stdout, "#running in saturation mode\n");
-  } else {
-    nosaturation = true;
-    fprintf(stdout, "#running in non-saturation mode\n");
+  // usage: eoslogbench [--deferred] [nosaturation]
+  for (int i = 1; i < argc; i++) {
+    if (std::string(argv[i]) == "--deferred") {
+      g_logging.SetDeferred(true);
+    } else {
+      nosaturation = true;
+    }
   }
 
+  fprintf(stdout, "#running in %s mode with %s formatting\n",
+          nosaturation ? "non-saturation" : "saturation",
+          g_logging.gDeferred ? "deferred" : "synchronous");
+
   FILE* fp = fopen("/var/tmp/eoslogbench.fan.log", "a+");
 
   if (fp) {
@@ -112,6 +119,8 @@ int main(int argc, char* argv[])
     delete threads[i];
   }
 
+  COMMONTIMING("STOP", &tm);
+
   double min, max, avg;
   min = 1000000;
   max = 0;
@@ -130,9 +139,13 @@ int main(int argc, char* argv[])
   }
   avg /= (NTHREADS*NMESSAGES);
 
-  COMMONTIMING("STOP", &tm);
+  // 99th percentile of the latency seen by the logging threads
+  std::vector<double> latencies(&realtimes[0][0],
+                                &realtimes[0][0] + NTHREADS * NMESSAGES);
+  auto p99 = latencies.begin() + (latencies.size() * 99) / 100;
+  std::nth_element(latencies.begin(), p99, latencies.end());
 
-  fprintf(stdout,"duration: %.02f [s] min: %.04f [ms] max: %.04f [ms] avg: %.04f [ms] nmsg: %d rate: %.02f [Hz] \n", tm.RealTime()/1000.0, min, max, avg, NTHREADS*NMESSAGES, NTHREADS*NMESSAGES / tm.RealTime()*1000);
+  fprintf(stdout,"duration: %.02f [s] min: %.04f [ms] max: %.04f [ms] avg: %.04f [ms] p99: %.04f [ms] nmsg: %d rate: %.02f [Hz] \n", tm.RealTime()/1000.0, min, max, avg, *p99, NTHREADS*NMESSAGES, NTHREADS*NMESSAGES / tm.RealTime()*1000);
 
   g_logging.shutDown(true);        /* gracefully, while files are still open */
   fclose(fstderr);
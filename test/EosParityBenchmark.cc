@@ -0,0 +1,185 @@
+//------------------------------------------------------------------------------
+// File: EosParityBenchmark.cc
+//------------------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2023 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+//------------------------------------------------------------------------------
+//! Compare the RAIN parity computation done by Jerasure with the vectorised
+//! ParityEngine for the different instruction sets.
+//!
+//! Usage: eos-parity-benchmark [stripe width in KB] [iterations]
+//------------------------------------------------------------------------------
+#include "fst/layout/ParityEngine.hh"
+#include "fst/layout/jerasure/include/jerasure.h"
+#include "fst/layout/jerasure/include/cauchy.h"
+#include "fst/layout/jerasure/include/galois.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+using eos::fst::ParityEngine;
+using eos::fst::BitmatrixCode;
+
+//------------------------------------------------------------------------------
+// Run the given function and return the throughput in MB/s with respect to
+// the amount of data processed
+//------------------------------------------------------------------------------
+double
+Measure(size_t iterations, size_t bytes, std::function<void()> func)
+{
+  auto start = std::chrono::steady_clock::now();
+
+  for (size_t i = 0; i < iterations; ++i) {
+    func();
+  }
+
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() -
+                                          start;
+  return (1.0 * iterations * bytes) / (1024 * 1024) / elapsed.count();
+}
+
+int main(int argc, char* argv[])
+{
+  size_t stripe_width = ((argc > 1) ? atoi(argv[1]) : 1024) * 1024;
+  size_t iterations = (argc > 2) ? atoi(argv[2]) : 100;
+  const int w = 8;
+  const size_t packet_sz = stripe_width / (w * sizeof(int));
+  const ParityEngine::Isa all_isa[] = {
+    ParityEngine::Isa::Scalar, ParityEngine::Isa::Avx2,
+    ParityEngine::Isa::Avx512
+  };
+  fprintf(stdout, "stripe_width=%zu iterations=%zu\n", stripe_width,
+          iterations);
+
+  for (auto km : std::vector<std::pair<int, int>> {{4, 2}, {10, 2}, {12, 4}}) {
+    int k = km.first;
+    int m = km.second;
+    int* matrix = cauchy_good_general_coding_matrix(k, m, w);
+    int* bitmatrix = jerasure_matrix_to_bitmatrix(k, m, w, matrix);
+    int** schedule = jerasure_smart_bitmatrix_to_schedule(k, m, w, bitmatrix);
+    BitmatrixCode code(k, m, w, bitmatrix);
+    std::vector<char*> data, coding;
+
+    for (int i = 0; i < k; ++i) {
+      data.push_back((char*) aligned_alloc(4096, stripe_width));
+
+      for (size_t j = 0; j < stripe_width; ++j) {
+        data.back()[j] = (char) random();
+      }
+    }
+
+    for (int i = 0; i < m; ++i) {
+      coding.push_back((char*) aligned_alloc(4096, stripe_width));
+    }
+
+    double rate = Measure(iterations, k * stripe_width, [&]() {
+      jerasure_schedule_encode(k, m, w, schedule, data.data(), coding.data(),
+                               stripe_width, packet_sz);
+    });
+    fprintf(stdout, "[reeds %02i+%i] encode jerasure       : %10.2f MB/s\n",
+            k, m, rate);
+
+    for (auto isa : all_isa) {
+      ParityEngine::SetIsa(isa);
+      rate = Measure(iterations, k * stripe_width, [&]() {
+        code.Encode(data.data(), coding.data(), stripe_width, packet_sz);
+      });
+      fprintf(stdout, "[reeds %02i+%i] encode engine %-7s : %10.2f MB/s\n",
+              k, m, ParityEngine::GetIsaName(), rate);
+    }
+
+    std::set<unsigned int> erasures;
+
+    for (int i = 0; i < m; ++i) {
+      erasures.insert(i);
+    }
+
+    std::vector<int> jerasures(erasures.begin(), erasures.end());
+    jerasures.push_back(-1);
+    rate = Measure(iterations, k * stripe_width, [&]() {
+      jerasure_schedule_decode_lazy(k, m, w, bitmatrix, jerasures.data(),
+                                    data.data(), coding.data(), stripe_width,
+                                    packet_sz, 1);
+    });
+    fprintf(stdout, "[reeds %02i+%i] decode jerasure       : %10.2f MB/s\n",
+            k, m, rate);
+
+    for (auto isa : all_isa) {
+      ParityEngine::SetIsa(isa);
+      rate = Measure(iterations, k * stripe_width, [&]() {
+        code.Decode(erasures, data.data(), coding.data(), stripe_width,
+                    packet_sz);
+      });
+      fprintf(stdout, "[reeds %02i+%i] decode engine %-7s : %10.2f MB/s\n",
+              k, m, ParityEngine::GetIsaName(), rate);
+    }
+
+    // Simple parity of the k data blocks as done by the RAID-DP layout
+    std::vector<const char*> srcs(data.begin(), data.end());
+    rate = Measure(iterations, k * stripe_width, [&]() {
+      jerasure_do_parity(k, data.data(), coding[0], stripe_width);
+    });
+    fprintf(stdout, "[xor   %02i  ] jerasure             : %10.2f MB/s\n",
+            k, rate);
+
+    for (auto isa : all_isa) {
+      ParityEngine::SetIsa(isa);
+      rate = Measure(iterations, k * stripe_width, [&]() {
+        ParityEngine::Xor(coding[0], srcs.data(), srcs.size(), stripe_width);
+      });
+      fprintf(stdout, "[xor   %02i  ] engine %-7s       : %10.2f MB/s\n",
+              k, ParityEngine::GetIsaName(), rate);
+    }
+
+    jerasure_free_schedule(schedule);
+    free(bitmatrix);
+    free(matrix);
+
+    for (auto ptr : data) {
+      free(ptr);
+    }
+
+    for (auto ptr : coding) {
+      free(ptr);
+    }
+  }
+
+  // GF(2^8) multiply-accumulate
+  std::vector<char> src(stripe_width, 'a');
+  std::vector<char> dst(stripe_width, 'b');
+  double rate = Measure(iterations, stripe_width, [&]() {
+    galois_w08_region_multiply(src.data(), 0x53, stripe_width, dst.data(), 1);
+  });
+  fprintf(stdout, "[gf-mac      ] jerasure             : %10.2f MB/s\n", rate);
+
+  for (auto isa : all_isa) {
+    ParityEngine::SetIsa(isa);
+    rate = Measure(iterations, stripe_width, [&]() {
+      ParityEngine::GfMulAdd(0x53, src.data(), dst.data(), stripe_width);
+    });
+    fprintf(stdout, "[gf-mac      ] engine %-7s       : %10.2f MB/s\n",
+            ParityEngine::GetIsaName(), rate);
+  }
+
+  return 0;
+}
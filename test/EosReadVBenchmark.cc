@@ -0,0 +1,260 @@
+//------------------------------------------------------------------------------
+// File: EosReadVBenchmark.cc
+//------------------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2023 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+//------------------------------------------------------------------------------
+//! Compare serving vector reads the way XrdFstOssFile::ReadV used to (one
+//! pread per chunk) with merging nearby chunks into extents read by a single
+//! preadv each. The chunk lists mimic a ROOT TTreeCache: baskets of many
+//! branches stored one after the other, of which only some branches are read.
+//! Both the page cache and the cold cache (after dropping the file pages)
+//! cases are measured.
+//!
+//! Usage: eos-readv-benchmark [file size MB] [chunks per readv]
+//!                            [read branch fraction %] [iterations]
+//------------------------------------------------------------------------------
+#include "fst/utils/ReadVExtents.hh"
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <vector>
+
+using eos::fst::MergeReadV;
+using eos::fst::ReadVExtent;
+
+//! Same limits as used by XrdFstOssFile::ReadV
+static const size_t sMaxGap = 16 * 1024;
+static const size_t sMaxExtent = 1024 * 1024;
+
+//------------------------------------------------------------------------------
+//! Build a TTreeCache like chunk list starting at a random offset
+//------------------------------------------------------------------------------
+std::vector<XrdOucIOVec>
+MakeChunks(std::mt19937_64& rng, off_t file_size, int nchunks, double fraction,
+           std::vector<char>& buffer)
+{
+  // Basket sizes spread around 16KB
+  std::lognormal_distribution<double> basket_size(std::log(16 * 1024.0), 0.8);
+  std::bernoulli_distribution read_basket(fraction);
+  std::vector<XrdOucIOVec> chunks;
+  size_t total = 0;
+  off_t offset = std::uniform_int_distribution<off_t>(0, file_size / 2)(rng);
+
+  while ((int) chunks.size() < nchunks) {
+    int size = std::clamp((int) basket_size(rng), 300, 512 * 1024);
+
+    if (offset + size > file_size) {
+      break;
+    }
+
+    if (read_basket(rng)) {
+      chunks.push_back({(long long) offset, size, 0, nullptr});
+      total += size;
+    }
+
+    offset += size;
+  }
+
+  buffer.resize(total);
+  total = 0;
+
+  for (auto& chunk : chunks) {
+    chunk.data = buffer.data() + total;
+    total += chunk.size;
+  }
+
+  return chunks;
+}
+
+//------------------------------------------------------------------------------
+//! One pread per chunk
+//------------------------------------------------------------------------------
+bool
+ReadChunks(int fd, std::vector<XrdOucIOVec>& chunks, size_t& nsyscalls)
+{
+  for (auto& chunk : chunks) {
+    ++nsyscalls;
+
+    if (pread(fd, chunk.data, chunk.size, chunk.offset) != chunk.size) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+//------------------------------------------------------------------------------
+//! One preadv per merged extent, the gaps are read into a scratch buffer
+//------------------------------------------------------------------------------
+bool
+ReadExtents(int fd, std::vector<XrdOucIOVec>& chunks, size_t& nsyscalls)
+{
+  static std::vector<char> scratch(sMaxGap);
+  std::vector<ReadVExtent> extents = MergeReadV(chunks.data(), chunks.size(),
+                                     sMaxGap, sMaxExtent, IOV_MAX / 2);
+
+  for (const auto& extent : extents) {
+    std::vector<struct iovec> iov;
+    off_t pos = extent.mOffset;
+
+    for (int idx : extent.mChunks) {
+      if (chunks[idx].offset > pos) {
+        iov.push_back({scratch.data(), (size_t)(chunks[idx].offset - pos)});
+      }
+
+      iov.push_back({chunks[idx].data, (size_t) chunks[idx].size});
+      pos = chunks[idx].offset + chunks[idx].size;
+    }
+
+    ++nsyscalls;
+
+    if (preadv(fd, iov.data(), iov.size(), extent.mOffset) !=
+        (ssize_t) extent.mLength) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+//------------------------------------------------------------------------------
+//! Run one mode and print the results
+//------------------------------------------------------------------------------
+void
+Run(const char* name,
+    std::function<bool(int, std::vector<XrdOucIOVec>&, size_t&)> read_fn,
+    int fd, off_t file_size, int nchunks, double fraction, int iterations,
+    bool cold)
+{
+  std::mt19937_64 rng(42); // same chunk lists for every mode
+  std::vector<double> latencies;
+  std::vector<char> buffer;
+  size_t nsyscalls = 0;
+  size_t nbytes = 0;
+  double elapsed = 0;
+
+  for (int i = 0; i < iterations; ++i) {
+    std::vector<XrdOucIOVec> chunks = MakeChunks(rng, file_size, nchunks,
+                                      fraction, buffer);
+
+    if (cold) {
+      posix_fadvise(fd, 0, file_size, POSIX_FADV_DONTNEED);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    if (!read_fn(fd, chunks, nsyscalls)) {
+      fprintf(stderr, "error: %s failed\n", name);
+      exit(1);
+    }
+
+    double took = std::chrono::duration<double>
+                  (std::chrono::steady_clock::now() - start).count();
+    elapsed += took;
+    latencies.push_back(took * 1000);
+    nbytes += buffer.size();
+
+    // Every byte of the file holds the low bits of its offset
+    for (const auto& chunk : chunks) {
+      for (int pos = 0; pos < chunk.size; pos += 997) {
+        if (chunk.data[pos] != (char)((chunk.offset + pos) % 251)) {
+          fprintf(stderr, "error: %s returned wrong data\n", name);
+          exit(1);
+        }
+      }
+    }
+  }
+
+  std::sort(latencies.begin(), latencies.end());
+  fprintf(stdout, "%-5s %-7s %8.01f readv/s %8.02f MB/s %7.01f syscalls/readv "
+          "p50: %.03f ms p99: %.03f ms\n", cold ? "cold" : "warm", name,
+          iterations / elapsed, nbytes / elapsed / (1024 * 1024),
+          (double) nsyscalls / iterations, latencies[latencies.size() / 2],
+          latencies[(latencies.size() * 99) / 100]);
+}
+
+int main(int argc, char* argv[])
+{
+  off_t size = ((argc > 1) ? atoll(argv[1]) : 1024) * 1024 * 1024;
+  int nchunks = (argc > 2) ? atoi(argv[2]) : 500;
+  double fraction = ((argc > 3) ? atof(argv[3]) : 30) / 100.0;
+  int iterations = (argc > 4) ? atoi(argv[4]) : 200;
+
+  if ((size <= 0) || (nchunks <= 0) || (fraction <= 0) || (fraction > 1) ||
+      (iterations <= 0)) {
+    fprintf(stderr, "usage: %s [file size MB] [chunks per readv] "
+            "[read branch fraction %%] [iterations]\n", argv[0]);
+    return 1;
+  }
+
+  char path[] = "/var/tmp/eos-readv-benchmark.XXXXXX";
+  int fd = mkstemp(path);
+
+  if (fd < 0) {
+    perror("mkstemp");
+    return 1;
+  }
+
+  unlink(path);
+  std::vector<char> data(251 * 4096);
+
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = (char)(i % 251);
+  }
+
+  for (off_t written = 0; written < size;) {
+    ssize_t nwrite = write(fd, data.data(), std::min((off_t) data.size(),
+                           size - written));
+
+    if (nwrite <= 0) {
+      perror("write");
+      return 1;
+    }
+
+    written += nwrite;
+  }
+
+  // Clean pages can be dropped for the cold cache runs
+  fsync(fd);
+  fprintf(stdout, "file size: %lld MB chunks/readv: %i branch fraction: %.0f%% "
+          "iterations: %i\n", (long long) size / (1024 * 1024), nchunks,
+          fraction * 100, iterations);
+
+  for (bool cold : {
+         false, true
+       }) {
+    Run("pread", ReadChunks, fd, size, nchunks, fraction, iterations, cold);
+    Run("preadv", ReadExtents, fd, size, nchunks, fraction, iterations, cold);
+  }
+
+  close(fd);
+  return 0;
+}
@@ -0,0 +1,189 @@
+//------------------------------------------------------------------------------
+// File: EosSendfileBenchmark.cc
+//------------------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2023 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+//------------------------------------------------------------------------------
+//! Compare the throughput of serving a file to a socket the way the FST does
+//! for regular reads (pread into a user space buffer followed by a send) and
+//! with sendfile, as done by XrdFstOfsFile::SendData for plain layout reads.
+//! A consumer thread drains the other end of a local socket pair.
+//!
+//! Usage: eos-sendfile-benchmark [file size MB] [block size KB] [iterations]
+//------------------------------------------------------------------------------
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <thread>
+#include <vector>
+
+//------------------------------------------------------------------------------
+// Read everything from the socket until the peer closes it
+//------------------------------------------------------------------------------
+void
+Drain(int sock, size_t& total)
+{
+  std::vector<char> buffer(1024 * 1024);
+  ssize_t nread;
+
+  while ((nread = read(sock, buffer.data(), buffer.size())) > 0) {
+    total += nread;
+  }
+}
+
+//------------------------------------------------------------------------------
+// Send the file with pread and write through a user space buffer
+//------------------------------------------------------------------------------
+bool
+SendCopy(int fd, int sock, off_t size, size_t block)
+{
+  std::vector<char> buffer(block);
+
+  for (off_t offset = 0; offset < size;) {
+    ssize_t nread = pread(fd, buffer.data(), block, offset);
+
+    if (nread <= 0) {
+      return false;
+    }
+
+    for (ssize_t nsent = 0; nsent < nread;) {
+      ssize_t nwrite = write(sock, buffer.data() + nsent, nread - nsent);
+
+      if (nwrite <= 0) {
+        return false;
+      }
+
+      nsent += nwrite;
+    }
+
+    offset += nread;
+  }
+
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// Send the file with sendfile without copying it to user space
+//------------------------------------------------------------------------------
+bool
+SendZeroCopy(int fd, int sock, off_t size, size_t block)
+{
+  off_t offset = 0;
+
+  while (offset < size) {
+    size_t length = std::min((off_t) block, size - offset);
+
+    if (sendfile(sock, fd, &offset, length) <= 0) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// Run one mode and print the throughput
+//------------------------------------------------------------------------------
+void
+Run(const char* name, std::function<bool(int, int, off_t, size_t)> send_fn,
+    int fd, off_t size, size_t block, int iterations)
+{
+  double elapsed = 0;
+  size_t total = 0;
+
+  for (int i = 0; i < iterations; ++i) {
+    int socks[2];
+
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, socks)) {
+      perror("socketpair");
+      exit(1);
+    }
+
+    size_t received = 0;
+    auto start = std::chrono::steady_clock::now();
+    std::thread consumer(Drain, socks[1], std::ref(received));
+
+    if (!send_fn(fd, socks[0], size, block)) {
+      fprintf(stderr, "error: %s failed\n", name);
+      exit(1);
+    }
+
+    close(socks[0]);
+    consumer.join();
+    elapsed += std::chrono::duration<double>
+               (std::chrono::steady_clock::now() - start).count();
+    close(socks[1]);
+    total += received;
+  }
+
+  fprintf(stdout, "%-10s %8.02f MB/s (%zu bytes in %.03f s)\n", name,
+          total / elapsed / (1024 * 1024), total, elapsed);
+}
+
+int main(int argc, char* argv[])
+{
+  off_t size = ((argc > 1) ? atoll(argv[1]) : 1024) * 1024 * 1024;
+  size_t block = ((argc > 2) ? atoll(argv[2]) : 1024) * 1024;
+  int iterations = (argc > 3) ? atoi(argv[3]) : 5;
+
+  if ((size <= 0) || !block || (iterations <= 0)) {
+    fprintf(stderr, "usage: %s [file size MB] [block size KB] [iterations]\n",
+            argv[0]);
+    return 1;
+  }
+
+  char path[] = "/tmp/eos-sendfile-benchmark.XXXXXX";
+  int fd = mkstemp(path);
+
+  if (fd < 0) {
+    perror("mkstemp");
+    return 1;
+  }
+
+  unlink(path);
+  std::vector<char> data(1024 * 1024, 'e');
+
+  for (off_t written = 0; written < size;) {
+    ssize_t nwrite = write(fd, data.data(), std::min((off_t) data.size(),
+                           size - written));
+
+    if (nwrite <= 0) {
+      perror("write");
+      return 1;
+    }
+
+    written += nwrite;
+  }
+
+  // The file is served from the page cache in both cases
+  fprintf(stdout, "file size: %lld MB block size: %zu KB iterations: %i\n",
+          (long long) size / (1024 * 1024), block / 1024, iterations);
+  Run("pread", SendCopy, fd, size, block, iterations);
+  Run("sendfile", SendZeroCopy, fd, size, block, iterations);
+  close(fd);
+  return 0;
+}
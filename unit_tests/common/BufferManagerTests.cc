@@ -188,3 +188,54 @@ TEST(BufferManager, MultipleThreads)
     ASSERT_EQ(sorted_slots.rbegin()->first, slot);
   }
 }
+
+TEST(BufferManager, SmallSlotBaseSize)
+{
+  using namespace eos::common;
+  eos::common::BufferManager buff_mgr(1 * MB, 2, 4 * KB);
+  auto buffer = buff_mgr.GetBuffer(5 * KB);
+  ASSERT_NE(buffer, nullptr);
+  ASSERT_EQ(buffer->mCapacity, 8 * KB);
+  ASSERT_EQ(0ull, (uintptr_t)buffer->GetDataPtr() % Buffer::sPageSize);
+  ASSERT_EQ(buff_mgr.GetBuffer(16 * KB + 1), nullptr);
+
+  for (int i = 0; i < 100; ++i) {
+    buff_mgr.Recycle(buffer);
+    buffer = buff_mgr.GetBuffer(5 * KB);
+  }
+
+  buff_mgr.Recycle(buffer);
+  auto stats = buff_mgr.GetStats();
+  ASSERT_EQ(stats.mAllocated, 1ull);
+  ASSERT_EQ(stats.mReused, 100);
+  ASSERT_EQ(stats.mRecycled, 101);
+  ASSERT_EQ(stats.mInUseBytes, 0);
+  ASSERT_EQ(stats.mCachedBytes, 8 * KB);
+}
+
+TEST(BufferManager, HugePageBacking)
+{
+  using namespace eos::common;
+  eos::common::BufferManager buff_mgr(64 * MB, 2, 1 * MB,
+                                      Buffer::Backing::Thp);
+  // Blocks smaller than a huge page fall back to normal pages
+  auto small = buff_mgr.GetBuffer(1 * MB);
+  auto large = buff_mgr.GetBuffer(4 * MB);
+  ASSERT_NE(small, nullptr);
+  ASSERT_NE(large, nullptr);
+  ASSERT_EQ(0ull, (uintptr_t)small->GetDataPtr() % Buffer::sPageSize);
+  ASSERT_EQ(0ull, (uintptr_t)large->GetDataPtr() % Buffer::sPageSize);
+  memset(large->GetDataPtr(), 'a', large->mCapacity);
+  ASSERT_EQ('a', large->GetDataPtr()[large->mCapacity - 1]);
+  auto stats = buff_mgr.GetStats();
+  ASSERT_EQ(stats.mInUseBytes, 5 * MB);
+  buff_mgr.Recycle(small);
+  buff_mgr.Recycle(large);
+  stats = buff_mgr.GetStats();
+  ASSERT_EQ(stats.mInUseBytes, 0);
+  ASSERT_EQ(stats.mCachedBytes, 5 * MB);
+  // Explicit huge pages may not be available but allocation must succeed
+  Buffer tlb(2 * MB, Buffer::Backing::HugeTlb);
+  memset(tlb.GetDataPtr(), 'b', tlb.mCapacity);
+  ASSERT_EQ('b', tlb.GetDataPtr()[tlb.mCapacity - 1]);
+}
@@ -24,6 +24,7 @@
 #include "common/Logging.hh"
 #include "Namespace.hh"
 #include "gtest/gtest.h"
+#include <thread>
 
 //------------------------------------------------------------------------------
 // Test the proper static allocation and destruction of the global logging
@@ -42,4 +43,85 @@ TEST(Logging, Log)
   function_using_logging();
 }
 
+//------------------------------------------------------------------------------
+// Messages captured in deferred mode are formatted by the background thread
+//------------------------------------------------------------------------------
+TEST(Logging, Deferred)
+{
+  using namespace eos::common;
+  gLogging.SetLogPriority(LOG_INFO);
+  gLogging.SetDeferred(true);
+  std::string value = "deferred value";
+  eos_static_info("msg=\"%s\" num=%d", value.c_str(), 42);
+  // The string must have been copied when the message was captured
+  value = "overwritten";
+  gLogging.StopDeferred();
+  ASSERT_FALSE(gLogging.gDeferred);
+  XrdSysMutexHelper scope_lock(gLogging.gMutex);
+  const unsigned long index = gLogging.gLogCircularIndex[LOG_INFO] - 1;
+  const XrdOucString& line =
+    gLogging.gLogMemory[LOG_INFO][index % gLogging.gCircularIndexSize];
+  ASSERT_NE(STR_NPOS, line.find("msg=\"deferred value\" num=42"));
+}
+
+//------------------------------------------------------------------------------
+// Deferred mode can be enabled again after being stopped
+//------------------------------------------------------------------------------
+TEST(Logging, DeferredRestart)
+{
+  using namespace eos::common;
+  gLogging.SetLogPriority(LOG_INFO);
+
+  for (int round = 0; round < 2; ++round) {
+    gLogging.SetDeferred(true);
+    ASSERT_TRUE(gLogging.gDeferred);
+    eos_static_info("msg=\"deferred restart\" round=%d", round);
+    gLogging.StopDeferred();
+    XrdSysMutexHelper scope_lock(gLogging.gMutex);
+    const unsigned long index = gLogging.gLogCircularIndex[LOG_INFO] - 1;
+    const XrdOucString& line =
+      gLogging.gLogMemory[LOG_INFO][index % gLogging.gCircularIndexSize];
+    const std::string expected = "msg=\"deferred restart\" round=" +
+                                 std::to_string(round);
+    ASSERT_NE(STR_NPOS, line.find(expected.c_str()));
+  }
+}
+
+//------------------------------------------------------------------------------
+// No message is lost when the deferred mode is stopped while threads log
+//------------------------------------------------------------------------------
+TEST(Logging, DeferredConcurrentStop)
+{
+  using namespace eos::common;
+  gLogging.SetLogPriority(LOG_INFO);
+  gLogging.SetDeferred(true);
+  const int num_threads = 4;
+  const int num_msgs = 2000;
+  unsigned long start;
+  {
+    XrdSysMutexHelper scope_lock(gLogging.gMutex);
+    start = gLogging.gLogCircularIndex[LOG_INFO];
+  }
+  std::vector<std::thread> threads;
+
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([t]() {
+      for (int i = 0; i < num_msgs; ++i) {
+        eos_static_info("msg=\"deferred concurrent\" thread=%d i=%d", t, i);
+      }
+    });
+  }
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  gLogging.StopDeferred();
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  XrdSysMutexHelper scope_lock(gLogging.gMutex);
+  ASSERT_EQ(start + num_threads * num_msgs,
+            gLogging.gLogCircularIndex[LOG_INFO]);
+}
+
 EOSCOMMONTESTING_END
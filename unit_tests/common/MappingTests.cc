@@ -24,6 +24,7 @@
 #include "gtest/gtest.h"
 #include "Namespace.hh"
 #include "common/Mapping.hh"
+#include "XrdSec/XrdSecEntity.hh"
 
 EOSCOMMONTESTING_BEGIN
 
@@ -95,4 +96,54 @@ TEST(VirtualIdentity, IsLocalhost)
   ASSERT_FALSE(vid.isLocalhost());
 }
 
+TEST(Mapping, VidCache)
+{
+  using namespace eos::common;
+  XrdSecEntity client("unix");
+  client.name = (char*)"vidcache";
+  client.host = (char*)"vidcache.cern.ch";
+  client.tident = (char*)"vidcache.1:2@vidcache";
+  const char* tident = "vidcache.1:2@vidcache";
+  const std::string rule = "unix:\"<pwd>\":uid";
+  {
+    RWMutexWriteLock lock(Mapping::gMapMutex);
+    Mapping::InvalidateVidCache();
+    Mapping::gVirtualUidMap[rule] = 1234;
+  }
+  uint64_t hits, misses, new_hits, new_misses;
+  Mapping::GetVidCacheStats(hits, misses);
+  VirtualIdentity vid;
+  Mapping::IdMap(&client, "", tident, vid, false);
+  ASSERT_EQ(1234u, vid.uid);
+  Mapping::IdMap(&client, "", tident, vid, false);
+  ASSERT_EQ(1234u, vid.uid);
+  ASSERT_TRUE(vid.hasUid(99));
+  Mapping::GetVidCacheStats(new_hits, new_misses);
+  ASSERT_EQ(hits + 1, new_hits);
+  ASSERT_EQ(misses + 1, new_misses);
+  // Different role selection is a different identity
+  Mapping::IdMap(&client, "eos.ruid=99", tident, vid, false);
+  ASSERT_EQ(99u, vid.uid);
+  // Mapping changes invalidate the cached identities
+  {
+    RWMutexWriteLock lock(Mapping::gMapMutex);
+    Mapping::InvalidateVidCache();
+    Mapping::gVirtualUidMap[rule] = 2345;
+  }
+  Mapping::IdMap(&client, "", tident, vid, false);
+  ASSERT_EQ(2345u, vid.uid);
+  // Token based identities are never cached
+  Mapping::GetVidCacheStats(hits, misses);
+  Mapping::IdMap(&client, "authz=dummy", tident, vid, false);
+  Mapping::IdMap(&client, "authz=dummy", tident, vid, false);
+  Mapping::GetVidCacheStats(new_hits, new_misses);
+  ASSERT_EQ(hits, new_hits);
+  ASSERT_EQ(misses, new_misses);
+  {
+    RWMutexWriteLock lock(Mapping::gMapMutex);
+    Mapping::InvalidateVidCache();
+    Mapping::gVirtualUidMap.erase(rule);
+  }
+}
+
 EOSCOMMONTESTING_END
@@ -0,0 +1,184 @@
+//------------------------------------------------------------------------------
+// File: ChecksumTests.cc
+//------------------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2023 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+#include "fst/checksum/Adler.hh"
+#include "fst/checksum/CRC32.hh"
+#include "fst/checksum/CRC32C.hh"
+#include "fst/checksum/CRC64.hh"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace eos::fst;
+
+namespace
+{
+//------------------------------------------------------------------------------
+//! Split the buffer into pieces of random size
+//------------------------------------------------------------------------------
+std::vector<std::pair<off_t, size_t>>
+SplitBuffer(size_t size, std::mt19937_64& rng)
+{
+  std::vector<std::pair<off_t, size_t>> pieces;
+  std::uniform_int_distribution<size_t> piece_size(1, 128 * 1024);
+
+  for (size_t offset = 0; offset < size;) {
+    size_t len = std::min(piece_size(rng), size - offset);
+    pieces.emplace_back(offset, len);
+    offset += len;
+  }
+
+  return pieces;
+}
+
+std::vector<std::unique_ptr<CheckSum>>
+MakeChecksums()
+{
+  std::vector<std::unique_ptr<CheckSum>> xs;
+  xs.emplace_back(new Adler());
+  xs.emplace_back(new CRC32());
+  xs.emplace_back(new CRC32C());
+  xs.emplace_back(new CRC64());
+  return xs;
+}
+}
+
+//------------------------------------------------------------------------------
+// Adding the pieces of a file in any order gives the sequential checksum
+//------------------------------------------------------------------------------
+TEST(Checksum, OutOfOrder)
+{
+  std::mt19937_64 rng(1234);
+  std::string data(1024 * 1024 + 17, '\0');
+
+  for (auto& c : data) {
+    c = (char) rng();
+  }
+
+  for (auto& xs : MakeChecksums()) {
+    xs->Add(data.data(), data.size(), 0);
+    xs->Finalize();
+    ASSERT_FALSE(xs->NeedsRecalculation());
+    const std::string ref = xs->GetHexChecksum();
+
+    for (int round = 0; round < 5; ++round) {
+      auto pieces = SplitBuffer(data.size(), rng);
+      std::shuffle(pieces.begin(), pieces.end(), rng);
+      xs->Reset();
+      off_t added = 0;
+      off_t max_end = 0;
+
+      for (const auto& piece : pieces) {
+        ASSERT_TRUE(xs->Add(data.data() + piece.first, piece.second,
+                            piece.first));
+        added += piece.second;
+        max_end = std::max(max_end, (off_t)(piece.first + piece.second));
+        // The pieces are disjoint, there are holes unless they form a prefix
+        ASSERT_EQ(max_end != added, xs->NeedsRecalculation());
+      }
+
+      xs->Finalize();
+      ASSERT_FALSE(xs->NeedsRecalculation()) << xs->GetName();
+      ASSERT_EQ((off_t) data.size(), xs->GetMaxOffset());
+      ASSERT_EQ(ref, xs->GetHexChecksum()) << xs->GetName();
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// Holes and overwrites still require a rescan
+//------------------------------------------------------------------------------
+TEST(Checksum, HolesAndOverlaps)
+{
+  std::string data(4096, 'x');
+
+  for (auto& xs : MakeChecksums()) {
+    // Hole at the beginning
+    xs->Add(data.data(), 1024, 1024);
+    xs->Finalize();
+    ASSERT_TRUE(xs->NeedsRecalculation()) << xs->GetName();
+    // Filling it combines the pieces, adding after finalizing is allowed
+    xs->Add(data.data(), 1024, 0);
+    xs->Finalize();
+    ASSERT_FALSE(xs->NeedsRecalculation()) << xs->GetName();
+    // Overwrite can not be combined and stays dirty
+    ASSERT_FALSE(xs->Add(data.data(), 512, 512));
+    xs->Add(data.data(), 2048, 2048);
+    xs->Finalize();
+    ASSERT_TRUE(xs->NeedsRecalculation()) << xs->GetName();
+    // Marking the checksum dirty sticks until the next reset
+    xs->Reset();
+    xs->SetDirty();
+    xs->Add(data.data(), data.size(), 0);
+    xs->Finalize();
+    ASSERT_TRUE(xs->NeedsRecalculation()) << xs->GetName();
+    xs->Reset();
+    xs->Add(data.data(), data.size(), 0);
+    xs->Finalize();
+    ASSERT_FALSE(xs->NeedsRecalculation()) << xs->GetName();
+  }
+}
+
+//------------------------------------------------------------------------------
+// Regions are merged as soon as they become contiguous
+//------------------------------------------------------------------------------
+TEST(ChecksumIntervals, Merge)
+{
+  ChecksumIntervals<uint64_t> intervals([](uint64_t a, uint64_t b, uint64_t) {
+    return a + b;
+  });
+  auto add = [&](off_t offset, uint64_t length) {
+    return intervals.Add(offset, length, [&](const uint64_t* prev) {
+      return (prev ? *prev : 0) + length;
+    });
+  };
+  uint64_t value = 0;
+  ASSERT_TRUE(add(100, 50));
+  ASSERT_TRUE(add(300, 100));
+  ASSERT_TRUE(add(0, 10));
+  ASSERT_EQ(3u, intervals.Size());
+  ASSERT_TRUE(intervals.HasHoles());
+  ASSERT_EQ(400, intervals.GetMaxOffset());
+  ASSERT_FALSE(add(140, 20));
+  ASSERT_FALSE(add(90, 20));
+  ASSERT_FALSE(add(0, 400));
+  ASSERT_TRUE(add(0, 0));
+  // Extends the first region and joins the second one
+  ASSERT_TRUE(add(10, 90));
+  ASSERT_EQ(2u, intervals.Size());
+  ASSERT_FALSE(intervals.Get(value));
+  ASSERT_TRUE(add(150, 150));
+  ASSERT_EQ(1u, intervals.Size());
+  ASSERT_FALSE(intervals.HasHoles());
+  ASSERT_TRUE(intervals.Get(value));
+  ASSERT_EQ(400u, value);
+  intervals.Clear();
+  ASSERT_EQ(0u, intervals.Size());
+  ASSERT_FALSE(intervals.Get(value));
+  ASSERT_TRUE(add(0, 10));
+  ASSERT_TRUE(intervals.Get(value));
+  ASSERT_EQ(10u, value);
+}
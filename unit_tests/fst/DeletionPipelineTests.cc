@@ -0,0 +1,149 @@
+//------------------------------------------------------------------------------
+// File: DeletionPipelineTests.cc
+//------------------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2023 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+#include "fst/utils/DeletionPipeline.hh"
+#include "fst/Deletion.hh"
+#include "gtest/gtest.h"
+#include <atomic>
+#include <map>
+#include <set>
+#include <thread>
+
+using eos::fst::Deletion;
+using eos::fst::DeletionPipeline;
+
+//------------------------------------------------------------------------------
+// Records the unlinked and dropped files
+//------------------------------------------------------------------------------
+struct MockStorage {
+  std::mutex mMutex;
+  std::map<unsigned long, std::set<unsigned long long>> mUnlinked;
+  std::map<unsigned long, std::set<unsigned long long>> mDropped;
+  std::map<unsigned long, std::set<std::thread::id>> mThreads;
+  std::vector<size_t> mBatchSizes;
+
+  bool Unlink(const Deletion& del, unsigned long long fid)
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mUnlinked[del.mFsid].insert(fid);
+    mThreads[del.mFsid].insert(std::this_thread::get_id());
+    // Odd file ids are missing on disk
+    return (fid % 2 == 0);
+  }
+
+  bool Drop(unsigned long fsid, const std::vector<unsigned long long>& fids)
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mBatchSizes.push_back(fids.size());
+
+    for (const auto fid : fids) {
+      // Only files already unlinked are confirmed
+      EXPECT_EQ(1u, mUnlinked[fsid].count(fid));
+      mDropped[fsid].insert(fid);
+    }
+
+    return true;
+  }
+};
+
+//------------------------------------------------------------------------------
+// Build a deletion with the given range of file ids
+//------------------------------------------------------------------------------
+std::unique_ptr<Deletion>
+MakeDeletion(unsigned long fsid, unsigned long long first, size_t count)
+{
+  std::vector<unsigned long long> fids;
+
+  for (size_t i = 0; i < count; ++i) {
+    fids.push_back(first + i);
+  }
+
+  return std::make_unique<Deletion>(fids, fsid, "/data/");
+}
+
+//------------------------------------------------------------------------------
+// All the files are unlinked and confirmed in batches
+//------------------------------------------------------------------------------
+TEST(DeletionPipeline, Batching)
+{
+  MockStorage storage;
+  {
+    DeletionPipeline pipeline([&](const Deletion & del, unsigned long long fid) {
+      return storage.Unlink(del, fid);
+    }, [&](unsigned long fsid, const std::vector<unsigned long long>& fids) {
+      return storage.Drop(fsid, fids);
+    }, 3, 10);
+
+    for (unsigned long fsid = 1; fsid <= 6; ++fsid) {
+      for (int i = 0; i < 5; ++i) {
+        pipeline.Push(MakeDeletion(fsid, i * 7, 7));
+      }
+    }
+
+    pipeline.Push(MakeDeletion(7, 0, 0));
+    pipeline.WaitIdle();
+    DeletionPipeline::Stats stats = pipeline.GetStats();
+    ASSERT_EQ(0u, stats.mQueued);
+    ASSERT_EQ(0u, stats.mPending);
+    ASSERT_EQ(6u * 35, stats.mUnlinked + stats.mFailed);
+    ASSERT_EQ(6u * 17, stats.mFailed);
+    ASSERT_EQ(6u * 35, stats.mDropped);
+    ASSERT_EQ(0u, stats.mDropFailed);
+    // At least 4 calls per file system for 35 files in batches of 10
+    ASSERT_GE(stats.mDropCalls, 6u * 4);
+    ASSERT_LT(stats.mDropCalls, 6u * 35);
+    ASSERT_EQ(storage.mBatchSizes.size(), stats.mDropCalls);
+  }
+
+  for (unsigned long fsid = 1; fsid <= 6; ++fsid) {
+    ASSERT_EQ(35u, storage.mUnlinked[fsid].size());
+    ASSERT_EQ(35u, storage.mDropped[fsid].size());
+    // A file system is handled by a single worker
+    ASSERT_EQ(1u, storage.mThreads[fsid].size());
+  }
+
+  ASSERT_EQ(0u, storage.mUnlinked.count(7));
+
+  for (auto size : storage.mBatchSizes) {
+    ASSERT_LE(size, 10u);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Failed confirmations are accounted and don't block the pipeline
+//------------------------------------------------------------------------------
+TEST(DeletionPipeline, DropFailure)
+{
+  std::atomic<size_t> num_calls {0};
+  DeletionPipeline pipeline([](const Deletion&, unsigned long long) {
+    return true;
+  }, [&](unsigned long, const std::vector<unsigned long long>&) {
+    return (++num_calls % 2 == 0);
+  }, 1, 4);
+  pipeline.Push(MakeDeletion(1, 0, 16));
+  pipeline.WaitIdle();
+  DeletionPipeline::Stats stats = pipeline.GetStats();
+  ASSERT_EQ(4u, stats.mDropCalls);
+  ASSERT_EQ(8u, stats.mDropped);
+  ASSERT_EQ(8u, stats.mDropFailed);
+  ASSERT_EQ(0u, stats.mPending);
+}
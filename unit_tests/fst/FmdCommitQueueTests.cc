@@ -0,0 +1,206 @@
+//------------------------------------------------------------------------------
+//! @file FmdCommitQueueTests.cc
+//------------------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2023 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+#include "fst/utils/FmdCommitQueue.hh"
+#include "gtest/gtest.h"
+#include <thread>
+
+using eos::fst::FmdCommitQueue;
+
+//------------------------------------------------------------------------------
+// In-memory database used as flush target
+//------------------------------------------------------------------------------
+struct MockDb {
+  std::mutex mMutex;
+  std::map<std::pair<uint32_t, uint64_t>, std::string> mRecords;
+  size_t mNumBatches {0};
+  bool mFail {false};
+
+  bool Write(FmdCommitQueue::fsid_t fsid, const FmdCommitQueue::Batch& batch)
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    ++mNumBatches;
+
+    if (mFail) {
+      return false;
+    }
+
+    for (const auto& elem : batch) {
+      if (elem.second.mDeleted) {
+        mRecords.erase({fsid, elem.first});
+      } else {
+        mRecords[ {fsid, elem.first}] = elem.second.mValue;
+      }
+    }
+
+    return true;
+  }
+
+  size_t Count(uint32_t fsid, uint64_t fid)
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mRecords.count({fsid, fid});
+  }
+
+  std::string Value(uint32_t fsid, uint64_t fid)
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mRecords[ {fsid, fid}];
+  }
+};
+
+//------------------------------------------------------------------------------
+// Test coalescing and read-your-writes before the flush
+//------------------------------------------------------------------------------
+TEST(FmdCommitQueue, CoalesceAndOverlay)
+{
+  MockDb db;
+  FmdCommitQueue queue([&db](FmdCommitQueue::fsid_t fsid,
+  const FmdCommitQueue::Batch & batch) {
+    return db.Write(fsid, batch);
+  }, std::chrono::seconds(3600), 1000000);
+  FmdCommitQueue::Update update;
+  ASSERT_FALSE(queue.Get(1, 10, update));
+  queue.Put(1, 10, "v1");
+  queue.Put(1, 10, "v2");
+  queue.Put(2, 10, "other");
+  queue.Delete(1, 11);
+  ASSERT_TRUE(queue.Get(1, 10, update));
+  ASSERT_FALSE(update.mDeleted);
+  ASSERT_EQ("v2", update.mValue);
+  ASSERT_TRUE(queue.Get(1, 11, update));
+  ASSERT_TRUE(update.mDeleted);
+  ASSERT_EQ(3u, queue.GetStats().mQueued);
+  ASSERT_EQ(0u, db.Count(1, 10));
+  queue.Flush(1);
+  ASSERT_EQ(1u, db.Count(1, 10));
+  ASSERT_EQ("v2", db.Value(1, 10));
+  ASSERT_EQ(0u, db.Count(2, 10));
+  ASSERT_FALSE(queue.Get(1, 10, update));
+  ASSERT_TRUE(queue.Get(2, 10, update));
+  queue.FlushAll();
+  ASSERT_EQ(1u, db.Count(2, 10));
+  FmdCommitQueue::Stats stats = queue.GetStats();
+  ASSERT_EQ(0u, stats.mQueued);
+  ASSERT_EQ(2u, stats.mFlushes);
+  ASSERT_EQ(3u, stats.mFlushed);
+}
+
+//------------------------------------------------------------------------------
+// Test the writer thread flushes after the delay and coalesces the updates
+// of concurrent writers in batches
+//------------------------------------------------------------------------------
+TEST(FmdCommitQueue, BackgroundFlush)
+{
+  MockDb db;
+  {
+    FmdCommitQueue queue([&db](FmdCommitQueue::fsid_t fsid,
+    const FmdCommitQueue::Batch & batch) {
+      return db.Write(fsid, batch);
+    }, std::chrono::milliseconds(5), 64);
+    std::vector<std::thread> threads;
+
+    for (uint32_t fsid = 1; fsid <= 4; ++fsid) {
+      threads.emplace_back([&queue, fsid]() {
+        for (uint64_t fid = 1; fid <= 1000; ++fid) {
+          queue.Put(fsid, fid, std::to_string(fid));
+        }
+      });
+    }
+
+    for (auto& th : threads) {
+      th.join();
+    }
+
+    // Wait for the writer thread to drain the queue
+    for (int i = 0; (i < 1000) && queue.GetStats().mQueued; ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+
+    ASSERT_EQ(0u, queue.GetStats().mQueued);
+    queue.Put(5, 1, "pending");
+  }
+  // The destructor writes the remaining updates
+  ASSERT_EQ(4001u, db.mRecords.size());
+  ASSERT_LT(db.mNumBatches, 4001u);
+}
+
+//------------------------------------------------------------------------------
+// Test the records of a failed flush are retried without overwriting the
+// updates queued in the meantime
+//------------------------------------------------------------------------------
+TEST(FmdCommitQueue, RetryFailedFlush)
+{
+  MockDb db;
+  FmdCommitQueue* queue_ptr = nullptr;
+  FmdCommitQueue queue([&](FmdCommitQueue::fsid_t fsid,
+  const FmdCommitQueue::Batch & batch) {
+    if (db.mFail) {
+      // Update arriving while the batch is being written
+      queue_ptr->Put(1, 10, "v2");
+    }
+
+    return db.Write(fsid, batch);
+  }, std::chrono::seconds(3600), 1000000);
+  queue_ptr = &queue;
+  queue.Put(1, 10, "v1");
+  queue.Put(1, 11, "other");
+  db.mFail = true;
+  queue.Flush(1);
+  ASSERT_EQ(0u, db.Count(1, 10));
+  ASSERT_EQ(2u, queue.GetStats().mQueued);
+  ASSERT_EQ(2u, queue.GetStats().mFailed);
+  FmdCommitQueue::Update update;
+  ASSERT_TRUE(queue.Get(1, 10, update));
+  ASSERT_EQ("v2", update.mValue);
+  ASSERT_TRUE(queue.Get(1, 11, update));
+  db.mFail = false;
+  queue.Flush(1);
+  ASSERT_EQ("v2", db.Value(1, 10));
+  ASSERT_EQ("other", db.Value(1, 11));
+  ASSERT_EQ(0u, queue.GetStats().mQueued);
+}
+
+//------------------------------------------------------------------------------
+// Test flushing with the caller's lock held bypasses the flush function
+//------------------------------------------------------------------------------
+TEST(FmdCommitQueue, FlushLocked)
+{
+  MockDb db;
+  MockDb other_db;
+  FmdCommitQueue queue([&db](FmdCommitQueue::fsid_t fsid,
+  const FmdCommitQueue::Batch & batch) {
+    return db.Write(fsid, batch);
+  }, std::chrono::seconds(3600), 1000000);
+  queue.Put(1, 10, "v1");
+  queue.Put(2, 10, "v1");
+  ASSERT_TRUE(queue.FlushLocked(1, [&other_db](FmdCommitQueue::fsid_t fsid,
+  const FmdCommitQueue::Batch & batch) {
+    return other_db.Write(fsid, batch);
+  }));
+  ASSERT_EQ("v1", other_db.Value(1, 10));
+  ASSERT_EQ(0u, db.mNumBatches);
+  FmdCommitQueue::Update update;
+  ASSERT_FALSE(queue.Get(1, 10, update));
+  ASSERT_TRUE(queue.Get(2, 10, update));
+  ASSERT_EQ(1u, queue.GetStats().mQueued);
+}
@@ -0,0 +1,213 @@
+//------------------------------------------------------------------------------
+// File: ParityEngineTests.cc
+//------------------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2023 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+#include "fst/layout/ParityEngine.hh"
+#include "fst/layout/jerasure/include/jerasure.h"
+#include "fst/layout/jerasure/include/cauchy.h"
+#include "fst/layout/jerasure/include/galois.h"
+#include "gtest/gtest.h"
+#include <cstdlib>
+#include <cstring>
+
+using eos::fst::ParityEngine;
+using eos::fst::BitmatrixCode;
+
+namespace
+{
+const ParityEngine::Isa sAllIsa[] = {
+  ParityEngine::Isa::Scalar, ParityEngine::Isa::Avx2, ParityEngine::Isa::Avx512
+};
+
+std::vector<char>
+RandomBuffer(size_t len)
+{
+  std::vector<char> buff(len);
+
+  for (auto& elem : buff) {
+    elem = (char) random();
+  }
+
+  return buff;
+}
+}
+
+TEST(ParityEngine, XorMultipleSources)
+{
+  const size_t max_len = 4099;
+  std::vector<std::vector<char>> blocks;
+
+  for (int i = 0; i < 7; ++i) {
+    blocks.push_back(RandomBuffer(max_len));
+  }
+
+  std::vector<const char*> srcs;
+
+  for (auto& block : blocks) {
+    srcs.push_back(block.data());
+  }
+
+  for (auto isa : sAllIsa) {
+    ParityEngine::SetIsa(isa);
+
+    for (size_t len : {
+           0, 1, 31, 33, 255, 257, 1024, 4099
+         }) {
+      for (size_t nsrc = 1; nsrc <= srcs.size(); ++nsrc) {
+        std::vector<char> dst(len + 1, 'x');
+        ParityEngine::Xor(dst.data(), srcs.data(), nsrc, len);
+
+        for (size_t i = 0; i < len; ++i) {
+          char expected = 0;
+
+          for (size_t s = 0; s < nsrc; ++s) {
+            expected ^= srcs[s][i];
+          }
+
+          ASSERT_EQ(expected, dst[i]) << "isa=" << ParityEngine::GetIsaName()
+                                      << " len=" << len << " nsrc=" << nsrc;
+        }
+
+        // nothing written past the end
+        ASSERT_EQ('x', dst[len]);
+      }
+    }
+  }
+
+  // in-place operation
+  std::vector<char> acc = blocks[0];
+  std::vector<char> ref = blocks[0];
+  srcs[0] = acc.data();
+  ParityEngine::Xor(acc.data(), srcs.data(), 2, max_len);
+
+  for (size_t i = 0; i < max_len; ++i) {
+    ASSERT_EQ((char)(ref[i] ^ blocks[1][i]), acc[i]);
+  }
+}
+
+TEST(ParityEngine, GfMulAdd)
+{
+  const size_t len = 1000;
+  std::vector<char> src = RandomBuffer(len);
+  std::vector<char> dst = RandomBuffer(len);
+
+  for (int a = 0; a < 256; ++a) {
+    for (int b = 0; b < 256; ++b) {
+      ASSERT_EQ(galois_single_multiply(a, b, 8), ParityEngine::GfMul(a, b));
+    }
+  }
+
+  for (auto isa : sAllIsa) {
+    ParityEngine::SetIsa(isa);
+
+    for (int coeff : {
+           0, 1, 2, 0x53, 0xff
+         }) {
+      std::vector<char> out = dst;
+      ParityEngine::GfMulAdd(coeff, src.data(), out.data(), len);
+
+      for (size_t i = 0; i < len; ++i) {
+        ASSERT_EQ((uint8_t) dst[i] ^ ParityEngine::GfMul(coeff, src[i]),
+                  (uint8_t) out[i]);
+      }
+    }
+  }
+}
+
+TEST(ParityEngine, BitmatrixCodeMatchesJerasure)
+{
+  const int w = 8;
+  const size_t stripe_width = 64 * 1024;
+  const size_t packet_sz = stripe_width / (w * sizeof(int));
+
+  for (auto km : std::vector<std::pair<int, int>> {{4, 2}, {10, 2}, {12, 4}}) {
+    int k = km.first;
+    int m = km.second;
+    int* matrix = cauchy_good_general_coding_matrix(k, m, w);
+    int* bitmatrix = jerasure_matrix_to_bitmatrix(k, m, w, matrix);
+    int** schedule = jerasure_smart_bitmatrix_to_schedule(k, m, w, bitmatrix);
+    std::vector<std::vector<char>> blocks;
+    std::vector<std::vector<char>> ref_coding;
+
+    for (int i = 0; i < k + m; ++i) {
+      blocks.push_back(RandomBuffer(stripe_width));
+    }
+
+    for (int i = 0; i < m; ++i) {
+      ref_coding.push_back(std::vector<char>(stripe_width));
+    }
+
+    std::vector<char*> data, coding, ref;
+
+    for (int i = 0; i < k; ++i) {
+      data.push_back(blocks[i].data());
+    }
+
+    for (int i = 0; i < m; ++i) {
+      coding.push_back(blocks[k + i].data());
+      ref.push_back(ref_coding[i].data());
+    }
+
+    jerasure_schedule_encode(k, m, w, schedule, data.data(), ref.data(),
+                             stripe_width, packet_sz);
+    BitmatrixCode code(k, m, w, bitmatrix);
+    code.Encode(data.data(), coding.data(), stripe_width, packet_sz);
+
+    for (int i = 0; i < m; ++i) {
+      ASSERT_EQ(ref_coding[i], blocks[k + i]) << "k=" << k << " m=" << m;
+    }
+
+    // Erase one data and up to (m - 1) coding blocks and rebuild them
+    auto orig = blocks;
+    std::set<unsigned int> erasures {1};
+
+    for (int i = 1; i < m; ++i) {
+      erasures.insert(k + i);
+    }
+
+    for (auto id : erasures) {
+      memset(blocks[id].data(), 0, stripe_width);
+    }
+
+    ASSERT_TRUE(code.Decode(erasures, data.data(), coding.data(), stripe_width,
+                            packet_sz));
+    ASSERT_EQ(orig, blocks);
+
+    // Erase m data blocks
+    erasures.clear();
+
+    for (int i = 0; i < m; ++i) {
+      erasures.insert(k - 1 - i);
+      memset(blocks[k - 1 - i].data(), 0, stripe_width);
+    }
+
+    ASSERT_TRUE(code.Decode(erasures, data.data(), coding.data(), stripe_width,
+                            packet_sz));
+    ASSERT_EQ(orig, blocks);
+    // Too many erasures
+    erasures.insert(0);
+    ASSERT_FALSE(code.Decode(erasures, data.data(), coding.data(), stripe_width,
+                             packet_sz));
+    jerasure_free_schedule(schedule);
+    free(bitmatrix);
+    free(matrix);
+  }
+}
@@ -0,0 +1,186 @@
+//------------------------------------------------------------------------------
+// File: ProcMetricsTests.cc
+//------------------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2023 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+#include "fst/utils/ProcMetrics.hh"
+#include "gtest/gtest.h"
+#include <sys/stat.h>
+#include <unistd.h>
+#include <fstream>
+
+using eos::fst::ProcFile;
+using eos::fst::ProcMetrics;
+
+namespace
+{
+//------------------------------------------------------------------------------
+//! Write a file with the given content
+//------------------------------------------------------------------------------
+void
+WriteFile(const std::string& path, const std::string& content)
+{
+  std::ofstream file(path, std::ios::trunc);
+  file << content;
+}
+}
+
+//------------------------------------------------------------------------------
+// Line and field splitting
+//------------------------------------------------------------------------------
+TEST(ProcFile, Parse)
+{
+  std::vector<std::string_view> fields;
+  std::string_view content = "  8  0 sda 10 20\n\nlast\tline";
+  std::string_view line;
+  size_t pos = 0;
+  ASSERT_TRUE(ProcFile::NextLine(content, pos, line));
+  ProcFile::SplitFields(line, fields);
+  ASSERT_EQ(5u, fields.size());
+  ASSERT_EQ("sda", fields[2]);
+  ASSERT_EQ(20u, ProcFile::ToUInt(fields[4]));
+  ASSERT_TRUE(ProcFile::NextLine(content, pos, line));
+  ProcFile::SplitFields(line, fields);
+  ASSERT_TRUE(fields.empty());
+  ASSERT_TRUE(ProcFile::NextLine(content, pos, line));
+  ProcFile::SplitFields(line, fields);
+  ASSERT_EQ(2u, fields.size());
+  ASSERT_EQ("line", fields[1]);
+  ASSERT_FALSE(ProcFile::NextLine(content, pos, line));
+  ASSERT_EQ(0u, ProcFile::ToUInt("-1"));
+}
+
+//------------------------------------------------------------------------------
+// Files larger than the initial buffer are read completely
+//------------------------------------------------------------------------------
+TEST(ProcFile, ReadFile)
+{
+  char tmp_path[] = "/tmp/eos.procfile.XXXXXX";
+  int fd = mkstemp(tmp_path);
+  ASSERT_NE(-1, fd);
+  close(fd);
+  std::string content;
+
+  for (int i = 0; i < 10000; ++i) {
+    content += std::to_string(i) + "\n";
+  }
+
+  WriteFile(tmp_path, content);
+  ProcFile file(tmp_path, std::chrono::seconds(60));
+  ASSERT_TRUE(file.Refresh());
+  ASSERT_EQ(content, file.GetContent());
+  // Not read again within the refresh interval unless forced
+  WriteFile(tmp_path, "1\n");
+  ASSERT_TRUE(file.Refresh());
+  ASSERT_EQ(content, file.GetContent());
+  ASSERT_TRUE(file.Refresh(true));
+  ASSERT_EQ("1\n", file.GetContent());
+  unlink(tmp_path);
+  ASSERT_FALSE(file.Refresh(true));
+  ASSERT_FALSE(ProcFile::ReadFile("/tmp/eos.procfile.missing", content));
+}
+
+//------------------------------------------------------------------------------
+// Uptime formatted like the uptime command
+//------------------------------------------------------------------------------
+TEST(ProcMetrics, FormatUptime)
+{
+  const std::string loadavg = "0.00 0.01 0.05 1/1024 12345\n";
+  struct tm tm_now {};
+  tm_now.tm_year = 123;
+  tm_now.tm_mday = 1;
+  tm_now.tm_hour = 21;
+  tm_now.tm_min = 54;
+  tm_now.tm_sec = 52;
+  tm_now.tm_isdst = -1;
+  time_t now = mktime(&tm_now);
+  ASSERT_EQ(" 21:54:52 up 12:20,  load average: 0.00, 0.01, 0.05",
+            ProcMetrics::FormatUptime("44400.51 80000.00\n", loadavg, now));
+  ASSERT_EQ(" 21:54:52 up 1 day,  3:05,  load average: 0.00, 0.01, 0.05",
+            ProcMetrics::FormatUptime("97500.00 1.00\n", loadavg, now));
+  ASSERT_EQ(" 21:54:52 up 3 days, 7 min,  load average: 0.00, 0.01, 0.05",
+            ProcMetrics::FormatUptime("259620.10 1.00\n", loadavg, now));
+  ASSERT_EQ("", ProcMetrics::FormatUptime("", loadavg, now));
+  ASSERT_EQ("", ProcMetrics::FormatUptime("100.0 1.0\n", "0.1\n", now));
+}
+
+//------------------------------------------------------------------------------
+// Socket count and default route
+//------------------------------------------------------------------------------
+TEST(ProcMetrics, ParseNet)
+{
+  ASSERT_EQ(30u, ProcMetrics::ParseTcpSockets(
+              "sockets: used 452\n"
+              "TCP: inuse 27 orphan 0 tw 3 alloc 30 mem 2\n"
+              "UDP: inuse 5 mem 4\n"));
+  ASSERT_EQ(0u, ProcMetrics::ParseTcpSockets("UDP: inuse 5 mem 4\n"));
+  const std::string route =
+    "Iface\tDestination\tGateway \tFlags\tRefCnt\tUse\tMetric\tMask\t\tMTU\t"
+    "Window\tIRTT\n"
+    "eth1\t00000000\t0101A8C0\t0003\t0\t0\t200\t00000000\t0\t0\t0\n"
+    "eth0\t0001A8C0\t00000000\t0001\t0\t0\t0\t00FFFFFF\t0\t0\t0\n"
+    "bond0\t00000000\t0100000A\t0003\t0\t0\t100\t00000000\t0\t0\t0\n";
+  ASSERT_EQ("bond0", ProcMetrics::ParseDefaultInterface(route));
+  ASSERT_EQ("", ProcMetrics::ParseDefaultInterface(""));
+}
+
+//------------------------------------------------------------------------------
+// Metrics read from a fake proc and sys tree
+//------------------------------------------------------------------------------
+TEST(ProcMetrics, Collect)
+{
+  char tmp_dir[] = "/tmp/eos.procmetrics.XXXXXX";
+  ASSERT_NE(nullptr, mkdtemp(tmp_dir));
+  const std::string root = tmp_dir;
+  ASSERT_EQ(0, mkdir((root + "/net").c_str(), 0755));
+  ASSERT_EQ(0, mkdir((root + "/class").c_str(), 0755));
+  ASSERT_EQ(0, mkdir((root + "/class/net").c_str(), 0755));
+  ASSERT_EQ(0, mkdir((root + "/class/net/eth0").c_str(), 0755));
+  WriteFile(root + "/uptime", "120.00 200.00\n");
+  WriteFile(root + "/loadavg", "1.50 1.00 0.50 2/300 400\n");
+  WriteFile(root + "/net/sockstat", "TCP: inuse 100 orphan 0 tw 20 alloc 1\n");
+  WriteFile(root + "/net/route", "Iface Destination Gateway Flags RefCnt Use "
+            "Metric Mask\neth0 00000000 0100000A 0003 0 0 0 00000000\n");
+  WriteFile(root + "/class/net/eth0/speed", "25000\n");
+  ProcMetrics metrics(root, root);
+  std::string uptime = metrics.GetUptime();
+  ASSERT_NE(std::string::npos,
+            uptime.find("up 2 min,  load average: 1.50, 1.00, 0.50"));
+  ASSERT_EQ(120u, metrics.GetTcpSockets());
+  // Cached until the refresh interval elapses
+  WriteFile(root + "/net/sockstat", "TCP: inuse 1 orphan 0 tw 0 alloc 1\n");
+  ASSERT_EQ(120u, metrics.GetTcpSockets());
+  ASSERT_EQ("eth0", metrics.GetDefaultInterface());
+  ASSERT_EQ(25000000000ull, metrics.GetLinkSpeed("eth0"));
+  ASSERT_EQ(0u, metrics.GetLinkSpeed("eth1"));
+  ASSERT_EQ(0u, metrics.GetLinkSpeed("../eth0"));
+  ProcMetrics missing(root + "/none", root + "/none");
+  ASSERT_EQ("N/A", missing.GetUptime());
+  ASSERT_EQ(0u, missing.GetTcpSockets());
+  ASSERT_EQ("", missing.GetDefaultInterface());
+
+  for (const auto& path : {
+         "/uptime", "/loadavg", "/net/sockstat", "/net/route",
+         "/class/net/eth0/speed", "/class/net/eth0", "/class/net", "/class",
+         "/net", ""
+       }) {
+    ASSERT_EQ(0, remove((root + path).c_str())) << path;
+  }
+}
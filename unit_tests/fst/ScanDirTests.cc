@@ -27,7 +27,10 @@
 #include "fst/ScanDir.hh"
 #undef IN_TEST_HARNESS
 #include "fst/Load.hh"
+#include "fst/checksum/ChecksumPlugins.hh"
+#include "fst/io/local/FsIo.hh"
 #include "common/Constants.hh"
+#include <random>
 
 //------------------------------------------------------------------------------
 // Helper method to convert current timestamp to string microseconds
@@ -126,3 +129,53 @@ TEST(ScanDir, AdjustScanRate)
 
   ASSERT_LE(rate, 5);
 }
+
+TEST(ScanDir, ScanFileMultipleBlocks)
+{
+  std::string tmp_path = "/tmp/eos.scandir.XXXXXX";
+  int fd = mkstemp((char*)tmp_path.c_str());
+  ASSERT_NE(-1, fd);
+  // Span several read blocks and end with a partial one
+  std::vector<char> data(2 * eos::fst::ScanDir::sReadBlockSize + 12345);
+  std::mt19937 gen(42);
+
+  for (auto& elem : data) {
+    elem = (char) gen();
+  }
+
+  ASSERT_EQ((ssize_t)data.size(), write(fd, data.data(), data.size()));
+  ASSERT_EQ(0, close(fd));
+  auto xs = eos::fst::ChecksumPlugins::GetXsObj("crc64");
+  ASSERT_NE(nullptr, xs);
+  xs->Add(data.data(), data.size(), 0);
+  xs->Finalize();
+  std::unique_ptr<eos::fst::FileIo> io(new eos::fst::FsIo(tmp_path));
+  ASSERT_EQ(0, io->fileOpen(O_RDWR, 0));
+  int xs_len = 0;
+  const char* xs_val = xs->GetBinChecksum(xs_len);
+  bool has_xattr = ((io->attrSet("user.eos.checksumtype", "crc64") == 0) &&
+                    (io->attrSet("user.eos.checksum", xs_val, xs_len) == 0));
+  eos::fst::ScanDir sd("/tmp", 1, nullptr, false, 0, 0, true);
+  unsigned long long scan_size = 0ull;
+  std::string scan_xs_hex;
+  bool filexs_err = true;
+  bool blockxs_err = true;
+  ASSERT_TRUE(sd.ScanFileLoadAware(io, scan_size, scan_xs_hex, filexs_err,
+                                   blockxs_err));
+  ASSERT_EQ(data.size(), scan_size);
+  ASSERT_FALSE(filexs_err);
+  ASSERT_FALSE(blockxs_err);
+
+  if (has_xattr) {
+    ASSERT_STREQ(xs->GetHexChecksum(), scan_xs_hex.c_str());
+    // Corrupt one byte in the last block
+    data[data.size() - 10] ^= 0x1;
+    ASSERT_EQ(1, io->fileWrite(data.size() - 10, &data[data.size() - 10], 1));
+    ASSERT_TRUE(sd.ScanFileLoadAware(io, scan_size, scan_xs_hex, filexs_err,
+                                     blockxs_err));
+    ASSERT_TRUE(filexs_err);
+  }
+
+  ASSERT_EQ(0, io->fileClose());
+  ASSERT_EQ(0, unlink(tmp_path.c_str()));
+}
@@ -23,6 +23,7 @@
 
 #include "TestEnv.hh"
 #include "fst/utils/OpenFileTracker.hh"
+#include "fst/utils/ReadVExtents.hh"
 #include "gtest/gtest.h"
 
 TEST(OpenFileTracker, BasicSanity)
@@ -179,3 +180,45 @@ TEST(OpenFileTracker, SortedByUseCount)
   auto hotFiles3 = oft.getHotFiles(3, 0);
   ASSERT_TRUE(hotFiles3.empty());
 }
+
+TEST(ReadVExtents, MergeReadV)
+{
+  using eos::fst::MergeReadV;
+  char buff[1];
+  // Unsorted chunks, one empty and one overlapping its predecessor
+  XrdOucIOVec readV[] = {
+    {1000, 100, 0, buff},
+    {0, 100, 0, buff},
+    {150, 50, 0, buff},
+    {5000, 0, 0, buff},
+    {180, 40, 0, buff},
+    {100000, 10, 0, buff}
+  };
+  auto extents = MergeReadV(readV, 6, 1024, 1024 * 1024, 512);
+  ASSERT_EQ(3u, extents.size());
+  ASSERT_EQ(0, extents[0].mOffset);
+  ASSERT_EQ(200u, extents[0].mLength);
+  ASSERT_EQ((std::vector<int> {1, 2}), extents[0].mChunks);
+  ASSERT_EQ(180, extents[1].mOffset);
+  ASSERT_EQ(920u, extents[1].mLength);
+  ASSERT_EQ((std::vector<int> {4, 0}), extents[1].mChunks);
+  ASSERT_EQ(100000, extents[2].mOffset);
+  ASSERT_EQ(10u, extents[2].mLength);
+  // Gap limit
+  extents = MergeReadV(readV, 3, 10, 1024 * 1024, 512);
+  ASSERT_EQ(3u, extents.size());
+  // Length and chunk number limits
+  extents = MergeReadV(readV, 3, 1024, 200, 512);
+  ASSERT_EQ(2u, extents.size());
+  extents = MergeReadV(readV, 3, 1024, 1024 * 1024, 1);
+  ASSERT_EQ(3u, extents.size());
+  // Block aligned extents
+  extents = MergeReadV(readV, 6, 1024, 1024 * 1024, 512, 4096);
+  ASSERT_EQ(3u, extents.size());
+  ASSERT_EQ(0, extents[0].mOffset);
+  ASSERT_EQ(4096u, extents[0].mLength);
+  ASSERT_EQ((std::vector<int> {1, 2}), extents[0].mChunks);
+  ASSERT_EQ((std::vector<int> {4, 0}), extents[1].mChunks);
+  ASSERT_EQ(98304, extents[2].mOffset);
+  ASSERT_EQ(4096u, extents[2].mLength);
+}
@@ -24,7 +24,11 @@
 #include "fst/XrdFstOfsFile.hh"
 #include "fst/XrdFstOfs.hh"
 #undef IN_TEST_HARNESS
+#include "fst/checksum/Adler.hh"
+#include "fst/checksum/CRC32C.hh"
+#include "fst/checksum/CRC64.hh"
 #include <memory>
+#include <vector>
 #include "gtest/gtest.h"
 
 using namespace eos::fst;
@@ -74,3 +78,42 @@ TEST(XrdFstOfsFileTest, GetHostFromTident)
   ASSERT_FALSE(XrdFstOfsFile::GetHostFromTident(tident, hostname));
   ASSERT_STREQ(hostname.c_str(), "");
 }
+
+TEST(XrdFstOfsFileTest, ChecksumCoversFile)
+{
+  // Existing file of 1MB opened for update, the checksum objects are not
+  // seeded with its content
+  const off_t open_size = 1024 * 1024;
+  std::string data(2 * open_size, 'e');
+  std::vector<std::unique_ptr<CheckSum>> checksums;
+  checksums.emplace_back(new Adler());
+  checksums.emplace_back(new CRC32C());
+  checksums.emplace_back(new CRC64());
+
+  for (auto& xs : checksums) {
+    // In-place overwrite of a prefix, written out of order
+    xs->Reset();
+    xs->Add(data.data() + 4096, 4096, 4096);
+    xs->Add(data.data(), 4096, 0);
+    xs->Finalize();
+    // A single region from 0, the checksum alone looks complete
+    ASSERT_FALSE(xs->NeedsRecalculation()) << xs->GetName();
+    ASSERT_FALSE(XrdFstOfsFile::ChecksumCoversFile(*xs, open_size, 8192))
+        << xs->GetName();
+    // Overwrite of the whole file
+    xs->Reset();
+    xs->Add(data.data(), open_size, 0);
+    xs->Finalize();
+    ASSERT_TRUE(XrdFstOfsFile::ChecksumCoversFile(*xs, open_size, open_size))
+        << xs->GetName();
+    // Overwrite extending the file
+    xs->Reset();
+    xs->Add(data.data(), 2 * open_size, 0);
+    xs->Finalize();
+    ASSERT_TRUE(XrdFstOfsFile::ChecksumCoversFile(*xs, open_size, 2 * open_size))
+        << xs->GetName();
+    // Write not extending the file after reading it
+    ASSERT_FALSE(XrdFstOfsFile::ChecksumCoversFile(*xs, open_size, open_size))
+        << xs->GetName();
+  }
+}
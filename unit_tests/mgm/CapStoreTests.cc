@@ -0,0 +1,144 @@
+//------------------------------------------------------------------------------
+// File: CapStoreTests.cc
+//------------------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2023 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+#include "gtest/gtest.h"
+#include "mgm/FuseServer/CapStore.hh"
+#include <algorithm>
+
+namespace
+{
+//------------------------------------------------------------------------------
+//! Minimal capability providing the accessors used by the store
+//------------------------------------------------------------------------------
+struct MockCap {
+  std::string mAuthId;
+  uint64_t mId;
+  std::string mClientId;
+  std::string mClientUuid;
+  uint64_t mVtime;
+
+  const std::string& authid() const
+  {
+    return mAuthId;
+  }
+
+  uint64_t id() const
+  {
+    return mId;
+  }
+
+  const std::string& clientid() const
+  {
+    return mClientId;
+  }
+
+  const std::string& clientuuid() const
+  {
+    return mClientUuid;
+  }
+
+  uint64_t vtime() const
+  {
+    return mVtime;
+  }
+};
+
+using Store = eos::mgm::CapStore<MockCap>;
+
+std::shared_ptr<MockCap>
+MakeCap(const std::string& authid, uint64_t ino, const std::string& client,
+        uint64_t vtime)
+{
+  return std::make_shared<MockCap>(MockCap{authid, ino, client + "-id",
+                                   client + "-uuid", vtime});
+}
+}
+
+//------------------------------------------------------------------------------
+// Test the inode and client indices follow stores and removals
+//------------------------------------------------------------------------------
+TEST(CapStore, Indices)
+{
+  Store store(4);
+  store.Store(MakeCap("a1", 1, "c1", 100));
+  store.Store(MakeCap("a2", 1, "c2", 100));
+  store.Store(MakeCap("a3", 2, "c1", 100));
+  ASSERT_EQ(3u, store.Size());
+  ASSERT_EQ(2u, store.NumInodes());
+  ASSERT_EQ(2u, store.NumClients());
+  auto authids = store.GetInodeAuthIds(1);
+  std::sort(authids.begin(), authids.end());
+  ASSERT_EQ((std::vector<std::string> {"a1", "a2"}), authids);
+  ASSERT_EQ(std::vector<std::string> {"a3"},
+            store.GetClientInodeAuthIds("c1-id", 2));
+  ASSERT_EQ(2u, store.GetClientCaps("c1-uuid").size());
+  // Re-issuing an authid for another inode moves it in the indices
+  store.Store(MakeCap("a1", 3, "c1", 100));
+  ASSERT_EQ(std::vector<std::string> {"a2"}, store.GetInodeAuthIds(1));
+  ASSERT_EQ(std::vector<std::string> {"a1"}, store.GetInodeAuthIds(3));
+  ASSERT_TRUE(store.GetClientInodeAuthIds("c1-id", 1).empty());
+  // Removal by inode
+  ASSERT_EQ(1u, store.RemoveInode(3).size());
+  ASSERT_EQ(nullptr, store.Get("a1"));
+  ASSERT_TRUE(store.GetInodeAuthIds(3).empty());
+  // Removal by client
+  ASSERT_EQ(1u, store.RemoveClient("c1-uuid").size());
+  ASSERT_TRUE(store.GetClientCaps("c1-uuid").empty());
+  ASSERT_EQ(1u, store.Size());
+  ASSERT_NE(nullptr, store.Remove("a2"));
+  ASSERT_EQ(nullptr, store.Remove("a2"));
+  ASSERT_EQ(0u, store.Size());
+  ASSERT_EQ(0u, store.NumInodes());
+  ASSERT_EQ(0u, store.NumClients());
+  ASSERT_TRUE(store.GetInodeIndex().empty());
+}
+
+//------------------------------------------------------------------------------
+// Test expired caps are removed and renewed ones are kept
+//------------------------------------------------------------------------------
+TEST(CapStore, Expire)
+{
+  Store store(2);
+  time_t now = 1000;
+
+  for (int i = 0; i < 100; ++i) {
+    store.Store(MakeCap("a" + std::to_string(i), i, "c1", now + i));
+  }
+
+  ASSERT_EQ(0u, store.Expire(now + 5, 10));
+  ASSERT_EQ(11u, store.Expire(now + 20, 10));
+  ASSERT_EQ(89u, store.Size());
+  // Renew a cap which is about to expire
+  store.Store(MakeCap("a11", 11, "c1", now + 60));
+  ASSERT_EQ(9u, store.Expire(now + 30, 10));
+  ASSERT_NE(nullptr, store.Get("a11"));
+  ASSERT_EQ(nullptr, store.Get("a12"));
+  // A cap stored again with an earlier vtime expires at the earlier vtime
+  store.Store(MakeCap("a50", 50, "c1", now + 20));
+  ASSERT_EQ(2u, store.Expire(now + 31, 10));
+  ASSERT_EQ(nullptr, store.Get("a50"));
+  ASSERT_EQ(nullptr, store.Get("a21"));
+  // A long pause does not leave caps behind
+  ASSERT_EQ(78u, store.Expire(now + 5000, 10));
+  ASSERT_EQ(0u, store.Size());
+  ASSERT_EQ(0u, store.NumClients());
+}
@@ -0,0 +1,168 @@
+//------------------------------------------------------------------------------
+//! @file FsFileSamplerTests.cc
+//------------------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2023 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+#include "gtest/gtest.h"
+#include "mgm/FsFileSampler.hh"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+using eos::mgm::FsFileSampler;
+
+//------------------------------------------------------------------------------
+//! Iterator over the ids [0, num)
+//------------------------------------------------------------------------------
+class RangeIterator : public eos::ICollectionIterator<eos::IFileMD::id_t>
+{
+public:
+  RangeIterator(uint64_t num): mNum(num) {}
+
+  eos::IFileMD::id_t getElement() override
+  {
+    return mPos;
+  }
+
+  bool valid() override
+  {
+    return mPos < mNum;
+  }
+
+  void next() override
+  {
+    ++mPos;
+  }
+
+private:
+  uint64_t mNum;
+  uint64_t mPos = 0;
+};
+
+TEST(FsFileSampler, SampleFileList)
+{
+  std::mt19937_64 rng(42);
+  // Short lists are returned entirely
+  RangeIterator short_it(10);
+  auto sample = FsFileSampler::SampleFileList(&short_it, 100, rng);
+  std::sort(sample.begin(), sample.end());
+  ASSERT_EQ(10u, sample.size());
+
+  for (uint64_t i = 0; i < 10; ++i) {
+    ASSERT_EQ(i, sample[i]);
+  }
+
+  // Every element of a long list has the same chance to be sampled
+  std::vector<uint64_t> hits(100);
+
+  for (int round = 0; round < 2000; ++round) {
+    RangeIterator it(100);
+    sample = FsFileSampler::SampleFileList(&it, 10, rng);
+    ASSERT_EQ(10u, sample.size());
+    ASSERT_EQ(10u, std::set<eos::IFileMD::id_t>(sample.begin(),
+              sample.end()).size());
+
+    for (auto fid : sample) {
+      ++hits[fid];
+    }
+  }
+
+  // Expected 200 hits per element
+  for (auto num : hits) {
+    ASSERT_GT(num, 120u);
+    ASSERT_LT(num, 280u);
+  }
+}
+
+TEST(FsFileSampler, Take)
+{
+  std::atomic<int> num_scans {0};
+  FsFileSampler sampler([&](FsFileSampler::fsid_t fsid, size_t num,
+  bool & complete) {
+    ++num_scans;
+    std::vector<FsFileSampler::Candidate> candidates;
+
+    for (uint64_t i = 0; i < num; ++i) {
+      candidates.push_back({fsid * 1000 + i, i % 2});
+    }
+
+    return candidates;
+  }, 8);
+  auto accept_all = [](const FsFileSampler::Candidate&) {
+    return true;
+  };
+  // Nothing sampled yet, the first call schedules a refresh
+  ASSERT_TRUE(sampler.Take(1, 4, accept_all).empty());
+  sampler.WaitIdle();
+  ASSERT_EQ(1, num_scans);
+  // Rejected candidates are dropped
+  auto candidates = sampler.Take(1, 2,
+  [](const FsFileSampler::Candidate & candidate) {
+    return candidate.mSize != 0;
+  });
+  ASSERT_EQ(2u, candidates.size());
+
+  for (const auto& candidate : candidates) {
+    ASSERT_EQ(1u, candidate.mSize);
+    ASSERT_EQ(1000u, candidate.mFid - candidate.mFid % 1000);
+  }
+
+  // Running low triggers a refresh
+  candidates = sampler.Take(1, 10, accept_all);
+  ASSERT_EQ(5u, candidates.size());
+  sampler.WaitIdle();
+  ASSERT_EQ(2, num_scans);
+  ASSERT_EQ(8u, sampler.Take(1, 10, accept_all).size());
+  sampler.WaitIdle();
+  sampler.Forget(1);
+  ASSERT_TRUE(sampler.Take(1, 10, accept_all).empty());
+  sampler.Stop();
+}
+
+TEST(FsFileSampler, SmallFileSystem)
+{
+  std::atomic<int> num_scans {0};
+  auto scanner = [&](FsFileSampler::fsid_t fsid, size_t num, bool & complete) {
+    ++num_scans;
+    complete = true;
+    return std::vector<FsFileSampler::Candidate> {{1, 1}, {2, 1}, {3, 1}};
+  };
+  auto accept_all = [](const FsFileSampler::Candidate&) {
+    return true;
+  };
+  FsFileSampler sampler(scanner, 16);
+  ASSERT_TRUE(sampler.Take(1, 4, accept_all).empty());
+  sampler.WaitIdle();
+  ASSERT_EQ(3u, sampler.Take(1, 4, accept_all).size());
+  // The whole file list was sampled, no rescan before the max age
+  ASSERT_TRUE(sampler.Take(1, 4, accept_all).empty());
+  sampler.WaitIdle();
+  ASSERT_EQ(1, num_scans);
+  sampler.Stop();
+  num_scans = 0;
+  FsFileSampler expiring(scanner, 16, std::chrono::seconds(0));
+  ASSERT_TRUE(expiring.Take(1, 4, accept_all).empty());
+  expiring.WaitIdle();
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  ASSERT_EQ(3u, expiring.Take(1, 4, accept_all).size());
+  expiring.WaitIdle();
+  ASSERT_EQ(2, num_scans);
+  expiring.Stop();
+}
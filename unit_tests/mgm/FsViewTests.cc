@@ -205,3 +205,53 @@ TEST(ConfigParsing, RelocateFilesystem) {
 
 }
 
+
+//------------------------------------------------------------------------------
+// Test FsViewSnapshot lookups
+//------------------------------------------------------------------------------
+TEST(FsViewSnapshot, Lookups)
+{
+  using eos::mgm::FsViewSnapshot;
+  FsViewSnapshot snapshot(3, 1000);
+  ASSERT_EQ(3u, snapshot.GetVersion());
+  ASSERT_EQ(1000, snapshot.GetTimestamp());
+  auto& space = snapshot.AddSpace("default", "on");
+  auto& group = snapshot.AddGroup("default.0", "off");
+  snapshot.AddSpaceGroup("default", "default.0");
+
+  for (eos::common::FileSystem::fsid_t fsid = 1; fsid <= 4; ++fsid) {
+    eos::common::FileSystem::fs_snapshot_t fs;
+    fs.mId = fsid;
+    fs.mHost = "example.cern.ch";
+    fs.mDiskCapacity = 100 * fsid;
+    snapshot.AddFileSystem(std::move(fs));
+    space.mFsIds.push_back(fsid);
+
+    if (fsid % 2) {
+      group.mFsIds.push_back(fsid);
+    }
+  }
+
+  // Unknown file systems attached to a view are skipped
+  group.mFsIds.push_back(42);
+  ASSERT_EQ(4u, snapshot.GetFileSystems().size());
+  ASSERT_EQ(nullptr, snapshot.GetFileSystem(42));
+  ASSERT_EQ(300, snapshot.GetFileSystem(3)->mDiskCapacity);
+  ASSERT_EQ(nullptr, snapshot.GetSpace("spare"));
+  ASSERT_EQ(nullptr, snapshot.GetNode("default.0"));
+  ASSERT_EQ("off", snapshot.GetGroup("default.0")->mStatus);
+  ASSERT_EQ(std::vector<std::string> {"default.0"},
+            snapshot.GetSpaceGroups("default"));
+  ASSERT_TRUE(snapshot.GetSpaceGroups("spare").empty());
+  long long capacity = 0;
+
+  for (const auto* fs : snapshot.GetFileSystems(*snapshot.GetSpace("default"))) {
+    capacity += fs->mDiskCapacity;
+  }
+
+  ASSERT_EQ(1000, capacity);
+  auto fss = snapshot.GetFileSystems(*snapshot.GetGroup("default.0"));
+  ASSERT_EQ(2u, fss.size());
+  ASSERT_EQ(1u, fss[0]->mId);
+  ASSERT_EQ(3u, fss[1]->mId);
+}
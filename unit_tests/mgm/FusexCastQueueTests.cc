@@ -0,0 +1,260 @@
+//------------------------------------------------------------------------------
+// File: FusexCastQueueTests.cc
+//------------------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2023 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+#include "gtest/gtest.h"
+#include "mgm/FuseServer/FusexCastQueue.hh"
+#include <atomic>
+#include <set>
+#include <thread>
+
+using eos::mgm::FusexCastQueue;
+using Type = eos::mgm::FusexCastQueue::Type;
+
+namespace
+{
+//------------------------------------------------------------------------------
+// Count the distinct notifications of a kind
+//------------------------------------------------------------------------------
+size_t
+CountDistinct(const std::vector<FusexCastQueue::Batch::Entry>& entries,
+              Type type)
+{
+  std::set<std::pair<uint64_t, std::string>> distinct;
+
+  for (const auto& entry : entries) {
+    if (entry.mType == type) {
+      distinct.emplace(entry.mIno, entry.mName);
+    }
+  }
+
+  return distinct.size();
+}
+}
+
+//------------------------------------------------------------------------------
+// Test notifications are sent inline when the queue is not running
+//------------------------------------------------------------------------------
+TEST(FusexCastQueue, Inline)
+{
+  FusexCastQueue queue;
+  std::vector<FusexCastQueue::Batch> sent;
+  queue.Start([&](const FusexCastQueue::Batch & batch) {
+    sent.push_back(batch);
+  }, 0, 1);
+  queue.Release("u1", "c1", 1);
+  queue.Release("u1", "c1", 1);
+  queue.Deletion("u1", "c1", 2, "name");
+  ASSERT_EQ(3u, sent.size());
+  ASSERT_EQ("u1", sent[0].mUuid);
+  ASSERT_EQ("c1", sent[0].mClientId);
+  ASSERT_EQ(1u, sent[2].Size());
+  ASSERT_EQ(Type::kDeletion, sent[2].mEntries[0].mType);
+  ASSERT_EQ(2u, sent[2].mEntries[0].mIno);
+  ASSERT_EQ("name", sent[2].mEntries[0].mName);
+}
+
+//------------------------------------------------------------------------------
+// Test notifications are merged per client mount
+//------------------------------------------------------------------------------
+TEST(FusexCastQueue, Coalesce)
+{
+  FusexCastQueue queue;
+  std::mutex mutex;
+  std::map<std::string, std::vector<FusexCastQueue::Batch::Entry>> sent;
+  size_t num_batches = 0;
+  // Long window, only the explicit flushes send
+  queue.Start([&](const FusexCastQueue::Batch & batch) {
+    std::unique_lock<std::mutex> lock(mutex);
+    ++num_batches;
+    auto& merged = sent[batch.mUuid];
+    merged.insert(merged.end(), batch.mEntries.begin(), batch.mEntries.end());
+  }, 60000, 4);
+
+  for (uint64_t ino = 1; ino <= 100; ++ino) {
+    for (const auto& uuid : {
+           "u1", "u2", "u3"
+         }) {
+      queue.Release(uuid, "c", ino % 10);
+      queue.Refresh(uuid, "c", 1000);
+      queue.Deletion(uuid, "c", 1000, "f" + std::to_string(ino));
+    }
+  }
+
+  ASSERT_EQ(900u, queue.GetNumQueued());
+  ASSERT_EQ(3u * (90 + 99), queue.GetNumCoalesced());
+  queue.Flush("u1");
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    ASSERT_EQ(1u, num_batches);
+    ASSERT_EQ(111u, sent["u1"].size());
+    ASSERT_EQ(10u, CountDistinct(sent["u1"], Type::kRelease));
+    ASSERT_EQ(1u, CountDistinct(sent["u1"], Type::kRefresh));
+    ASSERT_EQ(100u, CountDistinct(sent["u1"], Type::kDeletion));
+  }
+  queue.Flush();
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    ASSERT_EQ(3u, num_batches);
+    ASSERT_EQ(3u, sent.size());
+  }
+  queue.Refresh("u4", "c", 1);
+  queue.Stop();
+  ASSERT_EQ(4u, num_batches);
+  ASSERT_EQ(1u, CountDistinct(sent["u4"], Type::kRefresh));
+}
+
+//------------------------------------------------------------------------------
+// Test the flusher sends pending notifications after the window
+//------------------------------------------------------------------------------
+TEST(FusexCastQueue, Window)
+{
+  FusexCastQueue queue;
+  std::atomic<size_t> num_sent {0};
+  queue.Start([&](const FusexCastQueue::Batch & batch) {
+    num_sent += batch.Size();
+  }, 5, 2);
+
+  for (uint64_t ino = 0; ino < 1000; ++ino) {
+    queue.Release("u" + std::to_string(ino % 7), "c", ino);
+  }
+
+  for (int i = 0; (i < 1000) && (num_sent < 1000); ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+
+  ASSERT_EQ(1000u, num_sent);
+}
+
+//------------------------------------------------------------------------------
+// Test notifications are sent in enqueue order, a repeated one at the position
+// of its last enqueue
+//------------------------------------------------------------------------------
+TEST(FusexCastQueue, Order)
+{
+  FusexCastQueue queue;
+  std::vector<FusexCastQueue::Batch> sent;
+  queue.Start([&](const FusexCastQueue::Batch & batch) {
+    sent.push_back(batch);
+  }, 60000, 1);
+  queue.Release("u1", "c", 1);
+  queue.Deletion("u1", "c", 2, "name");
+  queue.Refresh("u1", "c", 3);
+  queue.Release("u1", "c", 1);
+  queue.Refresh("u1", "c", 4);
+  queue.Flush("u1");
+  ASSERT_EQ(1u, sent.size());
+  const auto& entries = sent[0].mEntries;
+  ASSERT_EQ(4u, entries.size());
+  ASSERT_EQ(Type::kDeletion, entries[0].mType);
+  ASSERT_EQ(Type::kRefresh, entries[1].mType);
+  ASSERT_EQ(3u, entries[1].mIno);
+  ASSERT_EQ(Type::kRelease, entries[2].mType);
+  ASSERT_EQ(1u, entries[2].mIno);
+  ASSERT_EQ(Type::kRefresh, entries[3].mType);
+  ASSERT_EQ(4u, entries[3].mIno);
+}
+
+//------------------------------------------------------------------------------
+// Test a flush racing with the flusher thread waits for the batches the
+// flusher already took, so that a message sent after the flush can not
+// overtake them. Large batches keep the flusher busy building them.
+//------------------------------------------------------------------------------
+TEST(FusexCastQueue, FlushRacingDispatch)
+{
+  FusexCastQueue queue;
+  std::mutex mutex;
+  std::set<uint64_t> sent;
+  queue.Start([&](const FusexCastQueue::Batch & batch) {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    for (const auto& entry : batch.mEntries) {
+      sent.insert(entry.mIno);
+    }
+  }, 2, 1);
+  size_t num_missing = 0;
+  uint64_t ino = 0;
+
+  for (int trial = 0; trial < 50; ++trial) {
+    for (int i = 0; i < 20000; ++i) {
+      queue.Refresh("u1", "c", ++ino);
+    }
+
+    std::this_thread::sleep_for(std::chrono::microseconds(100 * (trial % 40)));
+    queue.Flush("u1");
+    std::unique_lock<std::mutex> lock(mutex);
+    num_missing += ino - sent.size();
+  }
+
+  queue.Stop();
+  ASSERT_EQ(0u, num_missing);
+}
+
+//------------------------------------------------------------------------------
+// Test a flush does not wait for the batches of other clients handled by the
+// same sender thread
+//------------------------------------------------------------------------------
+TEST(FusexCastQueue, FlushOtherClient)
+{
+  FusexCastQueue queue;
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool blocked = false;
+  bool release = false;
+  std::set<std::string> sent;
+  queue.Start([&](const FusexCastQueue::Batch & batch) {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    if (batch.mUuid == "u1") {
+      blocked = true;
+      cv.notify_all();
+      cv.wait(lock, [&]() {
+        return release;
+      });
+    }
+
+    sent.insert(batch.mUuid);
+  }, 60000, 1);
+  queue.Release("u1", "c", 1);
+  std::thread flusher([&]() {
+    queue.Flush("u1");
+  });
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [&]() {
+      return blocked;
+    });
+  }
+  // Nothing queued for u2, returns although u1 is stuck in the sender
+  queue.Flush("u2");
+  queue.Refresh("u2", "c", 2);
+  queue.Flush("u3");
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    EXPECT_TRUE(sent.empty());
+    release = true;
+    cv.notify_all();
+  }
+  flusher.join();
+  queue.Flush("u2");
+  std::unique_lock<std::mutex> lock(mutex);
+  ASSERT_EQ((std::set<std::string> {"u1", "u2"}), sent);
+}
@@ -0,0 +1,158 @@
+//------------------------------------------------------------------------------
+//! @file IostatStoreTests.cc
+//------------------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2023 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+#include "gtest/gtest.h"
+#include "mgm/IostatStore.hh"
+#include <thread>
+
+using eos::mgm::IostatStore;
+
+//------------------------------------------------------------------------------
+// Test interning, batch accounting and snapshots
+//------------------------------------------------------------------------------
+TEST(IostatStore, BatchAndSnapshot)
+{
+  IostatStore store;
+  uint32_t tag_rb = store.Intern("bytes_read");
+  uint32_t tag_wb = store.Intern("bytes_written");
+  ASSERT_EQ(tag_rb, store.Intern("bytes_read"));
+  ASSERT_NE(tag_rb, tag_wb);
+  ASSERT_EQ("bytes_written", store.GetTag(tag_wb));
+  ASSERT_EQ("", store.GetTag(1000));
+  time_t now = time(NULL);
+  std::vector<IostatStore::Sample> batch;
+
+  for (uint32_t uid = 0; uid < 100; ++uid) {
+    batch.push_back({IostatStore::Kind::Uid, tag_rb, uid, 10, now - 10, now});
+    batch.push_back({IostatStore::Kind::Uid, tag_rb, uid, 5, now, now});
+    batch.push_back({IostatStore::Kind::Gid, tag_wb, uid % 10, 1, now, now});
+  }
+
+  store.AddBatch(batch, now);
+  ASSERT_EQ(110u, store.GetSize());
+  auto entries = store.GetSnapshot({IostatStore::Kind::Uid});
+  ASSERT_EQ(100u, entries.size());
+
+  for (const auto& entry : entries) {
+    ASSERT_EQ(IostatStore::Kind::Uid, entry.mKind);
+    ASSERT_EQ("bytes_read", entry.mTag);
+    ASSERT_EQ(15u, entry.mTotal);
+    ASSERT_EQ(15, entry.mAvg86400);
+  }
+
+  entries = store.GetSnapshot({IostatStore::Kind::Gid});
+  ASSERT_EQ(10u, entries.size());
+
+  for (const auto& entry : entries) {
+    ASSERT_EQ("bytes_written", entry.mTag);
+    ASSERT_EQ(10u, entry.mTotal);
+    ASSERT_EQ(10, entry.mAvg60);
+  }
+
+  // Restoring a counter only overwrites the total
+  store.SetTotal(IostatStore::Kind::Gid, "bytes_written", 3, 1000);
+  store.SetTotal(IostatStore::Kind::AppIn, "xrootd", 0, 7);
+  entries = store.GetSnapshot({IostatStore::Kind::Gid, IostatStore::Kind::AppIn});
+  ASSERT_EQ(11u, entries.size());
+
+  for (const auto& entry : entries) {
+    if (entry.mKind == IostatStore::Kind::AppIn) {
+      ASSERT_EQ("xrootd", entry.mTag);
+      ASSERT_EQ(7u, entry.mTotal);
+      ASSERT_EQ(0, entry.mAvg60);
+    } else if (entry.mId == 3) {
+      ASSERT_EQ(1000u, entry.mTotal);
+      ASSERT_EQ(10, entry.mAvg60);
+    }
+  }
+
+  ASSERT_EQ(111u, store.GetSnapshot().size());
+}
+
+//------------------------------------------------------------------------------
+// Test the sliding windows are expired by StampZero
+//------------------------------------------------------------------------------
+TEST(IostatStore, StampZero)
+{
+  IostatStore store;
+  uint32_t tag = store.Intern("read_calls");
+  time_t now = time(NULL);
+  store.AddBatch({{IostatStore::Kind::Uid, tag, 1, 100, now, now}}, now);
+  auto entries = store.GetSnapshot();
+  ASSERT_EQ(1u, entries.size());
+  ASSERT_EQ(100, entries[0].mAvg60);
+
+  // Circulating over the following minute clears the 60s window
+  for (time_t t = now; t < now + 60; ++t) {
+    store.StampZero(t);
+  }
+
+  entries = store.GetSnapshot();
+  ASSERT_EQ(0, entries[0].mAvg60);
+  ASSERT_EQ(100, entries[0].mAvg3600);
+  ASSERT_EQ(100u, entries[0].mTotal);
+}
+
+//------------------------------------------------------------------------------
+// Test concurrent ingestion and snapshots
+//------------------------------------------------------------------------------
+TEST(IostatStore, ConcurrentAccess)
+{
+  IostatStore store;
+  uint32_t tag = store.Intern("bytes_read");
+  const int num_threads = 4;
+  const int num_batches = 200;
+  std::vector<std::thread> threads;
+
+  for (int i = 0; i < num_threads; ++i) {
+    threads.emplace_back([&store, tag]() {
+      time_t now = time(NULL);
+      std::vector<IostatStore::Sample> batch;
+
+      for (uint32_t uid = 0; uid < 64; ++uid) {
+        batch.push_back({IostatStore::Kind::Uid, tag, uid, 1, now, now});
+      }
+
+      for (int j = 0; j < num_batches; ++j) {
+        store.AddBatch(batch, now);
+      }
+    });
+  }
+
+  threads.emplace_back([&store]() {
+    for (int j = 0; j < 100; ++j) {
+      (void) store.GetSnapshot();
+      store.StampZero(time(NULL));
+    }
+  });
+
+  for (auto& th : threads) {
+    th.join();
+  }
+
+  auto entries = store.GetSnapshot();
+  ASSERT_EQ(64u, entries.size());
+
+  for (const auto& entry : entries) {
+    ASSERT_EQ((unsigned long long)(num_threads * num_batches), entry.mTotal);
+  }
+}
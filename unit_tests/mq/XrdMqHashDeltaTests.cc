@@ -0,0 +1,86 @@
+//------------------------------------------------------------------------------
+//! @file XrdMqHashDeltaTests.cc
+//------------------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2023 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+#include "gtest/gtest.h"
+#include "mq/XrdMqHashDelta.hh"
+
+//------------------------------------------------------------------------------
+// Test encoding and decoding of plain and multiplexed updates
+//------------------------------------------------------------------------------
+TEST(XrdMqHashDelta, EncodeDecode)
+{
+  ASSERT_LE(0, XrdMqHashDelta::GetKeyId("stat.statfs.usedbytes"));
+  ASSERT_EQ(-1, XrdMqHashDelta::GetKeyId("some.custom.key"));
+
+  for (bool compress : {
+         false, true
+       }) {
+    XrdMqHashDelta delta;
+    delta.Add("stat.statfs.usedbytes", "123456789", 7);
+    delta.Add("some.custom.key", "a|b~c%d&e", 1ull << 40);
+    delta.Add("stat.geotag", "", 0, 3);
+
+    for (int i = 0; i < 100; ++i) {
+      delta.Add("stat.ropen", std::to_string(i).c_str(), i, 12);
+    }
+
+    ASSERT_EQ(103u, delta.Size());
+    std::string encoded, error;
+    ASSERT_TRUE(delta.Encode(encoded, compress));
+    ASSERT_EQ(std::string::npos, encoded.find('&'));
+    std::vector<XrdMqHashDelta::Entry> entries;
+    ASSERT_TRUE(XrdMqHashDelta::Decode(encoded.c_str(), entries, error));
+    ASSERT_EQ(103u, entries.size());
+    ASSERT_EQ("stat.statfs.usedbytes", entries[0].mKey);
+    ASSERT_EQ("123456789", entries[0].mValue);
+    ASSERT_EQ(7u, entries[0].mChangeId);
+    ASSERT_EQ("some.custom.key", entries[1].mKey);
+    ASSERT_EQ("a|b~c%d&e", entries[1].mValue);
+    ASSERT_EQ(1ull << 40, entries[1].mChangeId);
+    ASSERT_EQ("#3#stat.geotag", entries[2].mKey);
+    ASSERT_EQ("", entries[2].mValue);
+    ASSERT_EQ("#12#stat.ropen", entries[102].mKey);
+    ASSERT_EQ("99", entries[102].mValue);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Test malformed input is rejected
+//------------------------------------------------------------------------------
+TEST(XrdMqHashDelta, Malformed)
+{
+  std::vector<XrdMqHashDelta::Entry> entries;
+  std::string error;
+  ASSERT_FALSE(XrdMqHashDelta::Decode(nullptr, entries, error));
+  ASSERT_FALSE(XrdMqHashDelta::Decode("", entries, error));
+  XrdMqHashDelta delta;
+  delta.Add("some.custom.key", "value", 1);
+  std::string encoded;
+  ASSERT_TRUE(delta.Encode(encoded, false));
+  // Unknown version
+  ASSERT_FALSE(XrdMqHashDelta::Decode(("/" + encoded.substr(1)).c_str(),
+                                      entries, error));
+  // Truncated entries
+  encoded.resize(encoded.length() - 8);
+  ASSERT_FALSE(XrdMqHashDelta::Decode(encoded.c_str(), entries, error));
+  ASSERT_FALSE(error.empty());
+}
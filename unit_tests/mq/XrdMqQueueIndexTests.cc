@@ -0,0 +1,78 @@
+//------------------------------------------------------------------------------
+//! @file XrdMqQueueIndexTests.cc
+//------------------------------------------------------------------------------
+
+/************************************************************************
+ * EOS - the CERN Disk Storage System                                   *
+ * Copyright (C) 2023 CERN/Switzerland                                  *
+ *                                                                      *
+ * This program is free software: you can redistribute it and/or modify *
+ * it under the terms of the GNU General Public License as published by *
+ * the Free Software Foundation, either version 3 of the License, or    *
+ * (at your option) any later version.                                  *
+ *                                                                      *
+ * This program is distributed in the hope that it will be useful,      *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of       *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        *
+ * GNU General Public License for more details.                         *
+ *                                                                      *
+ * You should have received a copy of the GNU General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.*
+ ************************************************************************/
+
+#include "gtest/gtest.h"
+#include "mq/XrdMqQueueIndex.hh"
+
+using QueueIndex = XrdMqQueueIndex<int>;
+
+//------------------------------------------------------------------------------
+// Test wildcard matching
+//------------------------------------------------------------------------------
+TEST(XrdMqQueueIndex, WildcardMatch)
+{
+  ASSERT_TRUE(QueueIndex::WildcardMatch("/eos/host1/fst", "/eos/host1/fst"));
+  ASSERT_FALSE(QueueIndex::WildcardMatch("/eos/host1/fst", "/eos/host1/fst1"));
+  ASSERT_TRUE(QueueIndex::WildcardMatch("/eos/*", "/eos/host1/fst"));
+  ASSERT_TRUE(QueueIndex::WildcardMatch("/eos/*/fst", "/eos/host1:1095/fst"));
+  ASSERT_FALSE(QueueIndex::WildcardMatch("/eos/*/fst", "/eos/host1/mgm"));
+  ASSERT_TRUE(QueueIndex::WildcardMatch("*/mgm", "/eos/host1/mgm"));
+  ASSERT_TRUE(QueueIndex::WildcardMatch("/eos/*/*/fst", "/eos/a/b/fst"));
+  ASSERT_FALSE(QueueIndex::WildcardMatch("/eos/*/b/*", "/eos/a/c/fst"));
+  ASSERT_TRUE(QueueIndex::WildcardMatch("/eos/*", "/eos/"));
+  ASSERT_FALSE(QueueIndex::WildcardMatch("/eos/*os/", "/eos/"));
+  ASSERT_TRUE(QueueIndex::WildcardMatch("*", ""));
+}
+
+//------------------------------------------------------------------------------
+// Test lookups, advisory lists and cache invalidation
+//------------------------------------------------------------------------------
+TEST(XrdMqQueueIndex, Lookups)
+{
+  QueueIndex index;
+  ASSERT_TRUE(index.Add("/eos/host1/fst", std::make_shared<int>(1), true, false));
+  ASSERT_TRUE(index.Add("/eos/host2/fst", std::make_shared<int>(2), false, false));
+  ASSERT_TRUE(index.Add("/eos/host1/mgm", std::make_shared<int>(3), true, true));
+  ASSERT_FALSE(index.Add("/eos/host1/fst", std::make_shared<int>(4), true, true));
+  ASSERT_EQ(3u, index.Size());
+  ASSERT_EQ(2, *index.Get("/eos/host2/fst"));
+  ASSERT_EQ(nullptr, index.Get("/eos/host3/fst"));
+  auto status = index.GetAdvisoryStatus();
+  ASSERT_EQ(2u, status->size());
+  ASSERT_EQ("/eos/host1/fst", (*status)[0].mName);
+  ASSERT_EQ("/eos/host1/mgm", (*status)[1].mName);
+  ASSERT_EQ(1u, index.GetAdvisoryQuery()->size());
+  auto fsts = index.Match("/eos/*/fst");
+  ASSERT_EQ(2u, fsts->size());
+  ASSERT_EQ(fsts, index.Match("/eos/*/fst"));
+  ASSERT_EQ(2u, index.Match("/eos/host1/*")->size());
+  // Changes invalidate the cached lists, old snapshots stay valid
+  auto queue = index.Remove("/eos/host1/fst");
+  ASSERT_EQ(1, *queue);
+  ASSERT_EQ(nullptr, index.Remove("/eos/host1/fst"));
+  ASSERT_EQ(2u, fsts->size());
+  ASSERT_EQ(1u, index.Match("/eos/*/fst")->size());
+  ASSERT_EQ(1u, index.GetAdvisoryStatus()->size());
+  ASSERT_TRUE(index.Add("/eos/host3/fst", std::make_shared<int>(5), false, true));
+  ASSERT_EQ(2u, index.Match("/eos/*/fst")->size());
+  ASSERT_EQ(2u, index.GetAdvisoryQuery()->size());
+}